@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_updates.h"
 #include "apiwrap.h"
 #include "base/random.h"
+#include "core/application.h"
 #include "data/data_changes.h"
 #include "data/data_histories.h"
 #include "data/data_poll.h"
@@ -22,6 +23,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Api {
 namespace {
 
+// Spread visible polls results reloading instead of a burst of requests.
+constexpr auto kReloadResultsSpacing = crl::time(200);
+
 [[nodiscard]] TimeId UnixtimeFromMsgId(mtpMsgId msgId) {
 	return TimeId(msgId >> 32);
 }
@@ -30,7 +34,17 @@ namespace {
 
 Polls::Polls(not_null<ApiWrap*> api)
 : _session(&api->session())
-, _api(&api->instance()) {
+, _api(&api->instance())
+, _pollReloadTimer([=] { sendReloadResults(); }) {
+	Core::App().appDeactivatedValue(
+	) | rpl::start_with_next([=](bool deactivated) {
+		_appDeactivated = deactivated;
+		if (deactivated) {
+			_pollReloadTimer.cancel();
+		} else {
+			scheduleReloadResults();
+		}
+	}, _lifetime);
 }
 
 void Polls::create(
@@ -183,9 +197,41 @@ void Polls::close(not_null<HistoryItem*> item) {
 void Polls::reloadResults(not_null<HistoryItem*> item) {
 	const auto itemId = item->fullId();
 	if (!IsServerMsgId(item->id)
-		|| _pollReloadRequestIds.contains(itemId)) {
+		|| _pollReloadRequestIds.contains(itemId)
+		|| ranges::contains(_pollReloadQueue, itemId)) {
+		return;
+	}
+	_pollReloadQueue.push_back(itemId);
+	scheduleReloadResults();
+}
+
+void Polls::scheduleReloadResults() {
+	if (_appDeactivated
+		|| _pollReloadQueue.empty()
+		|| _pollReloadTimer.isActive()) {
+		return;
+	}
+	const auto left = _pollReloadSentAt + kReloadResultsSpacing - crl::now();
+	_pollReloadTimer.callOnce(std::max(left, crl::time(0)));
+}
+
+void Polls::sendReloadResults() {
+	// There is no batched getPollResults, so we send one at a time.
+	const auto item = [&]() -> HistoryItem* {
+		while (!_pollReloadQueue.empty()) {
+			const auto itemId = _pollReloadQueue.front();
+			_pollReloadQueue.pop_front();
+			if (const auto result = _session->data().message(itemId)) {
+				return result;
+			}
+		}
+		return nullptr;
+	}();
+	if (!item) {
 		return;
 	}
+	const auto itemId = item->fullId();
+	_pollReloadSentAt = crl::now();
 	const auto requestId = _api.request(MTPmessages_GetPollResults(
 		item->history()->peer->input,
 		MTP_int(item->id)
@@ -196,6 +242,7 @@ void Polls::reloadResults(not_null<HistoryItem*> item) {
 		_pollReloadRequestIds.erase(itemId);
 	}).send();
 	_pollReloadRequestIds.emplace(itemId, requestId);
+	scheduleReloadResults();
 }
 
 } // namespace Api
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "mtproto/sender.h"
+#include "base/timer.h"
 
 class ApiWrap;
 class HistoryItem;
@@ -37,12 +38,21 @@ public:
 	void reloadResults(not_null<HistoryItem*> item);
 
 private:
+	void scheduleReloadResults();
+	void sendReloadResults();
+
 	const not_null<Main::Session*> _session;
 	MTP::Sender _api;
 
 	base::flat_map<FullMsgId, mtpRequestId> _pollVotesRequestIds;
 	base::flat_map<FullMsgId, mtpRequestId> _pollCloseRequestIds;
 	base::flat_map<FullMsgId, mtpRequestId> _pollReloadRequestIds;
+	std::deque<FullMsgId> _pollReloadQueue;
+	base::Timer _pollReloadTimer;
+	crl::time _pollReloadSentAt = 0;
+	bool _appDeactivated = false;
+
+	rpl::lifetime _lifetime;
 
 };
 
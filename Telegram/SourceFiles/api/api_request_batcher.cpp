@@ -0,0 +1,60 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "api/api_request_batcher.h"
+
+namespace Api {
+namespace {
+
+constexpr auto kMaxWindow = crl::time(50);
+constexpr auto kIdleInterval = crl::time(100);
+
+// Exponential moving averages with 1/4 weight of the new sample.
+[[nodiscard]] crl::time Average(crl::time was, crl::time sample) {
+	return was ? ((was * 3 + sample) / 4) : sample;
+}
+
+} // namespace
+
+RequestBatcher::RequestBatcher(Fn<void()> flush, int cap)
+: _flush(std::move(flush))
+, _cap(cap)
+, _timer([=] { this->flush(); }) {
+	Expects(_cap > 0);
+}
+
+void RequestBatcher::add() {
+	const auto now = crl::now();
+	_addInterval = _lastAdded
+		? Average(_addInterval, std::min(now - _lastAdded, kIdleInterval))
+		: kIdleInterval;
+	_lastAdded = now;
+	if (++_pending >= _cap) {
+		flush();
+	} else if (!_timer.isActive()) {
+		_timer.callOnce(window());
+	}
+}
+
+void RequestBatcher::requestFinished(crl::time sent) {
+	_duration = Average(_duration, std::max(crl::now() - sent, crl::time(0)));
+}
+
+crl::time RequestBatcher::window() const {
+	if (_addInterval >= kIdleInterval / 2) {
+		return 0;
+	}
+	return std::min(_duration / 4, kMaxWindow);
+}
+
+void RequestBatcher::flush() {
+	_timer.cancel();
+	_pending = 0;
+	_flush();
+}
+
+} // namespace Api
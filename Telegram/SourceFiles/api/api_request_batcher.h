@@ -0,0 +1,42 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+
+namespace Api {
+
+// Collects lookups that are resolved by one batched request.
+//
+// When lookups come rarely the batch is sent on the next event loop
+// iteration, like with SingleQueuedInvokation. When they come in bursts
+// the batch waits a little longer, up to a quarter of the observed
+// request duration, but never gets larger than the cap.
+class RequestBatcher final {
+public:
+	RequestBatcher(Fn<void()> flush, int cap);
+
+	void add();
+	void requestFinished(crl::time sent);
+
+	[[nodiscard]] crl::time window() const;
+
+private:
+	void flush();
+
+	const Fn<void()> _flush;
+	const int _cap = 0;
+	base::Timer _timer;
+	int _pending = 0;
+	crl::time _lastAdded = 0;
+	crl::time _addInterval = 0;
+	crl::time _duration = 0;
+
+};
+
+} // namespace Api
@@ -0,0 +1,101 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Api {
+
+// Keeps one request per key in flight and remembers when each key was
+// loaded, so that the same data asked by several widgets at once, or
+// asked again right after it was loaded, is requested only once.
+//
+// The results are shared through the data layer, so the waiters only
+// need the usual update notifications, not a callback per request.
+template <typename Key>
+class SharedRequests final {
+public:
+	struct Stats {
+		int sent = 0;
+		int shared = 0; // Joined the request that was already in flight.
+		int cached = 0; // Skipped, because the data was loaded recently.
+	};
+
+	explicit SharedRequests(crl::time ttl = 0) : _ttl(ttl) {
+	}
+
+	// Returns false if the key should not be requested right now.
+	[[nodiscard]] bool start(const Key &key) {
+		if (_inFlight.contains(key)) {
+			++_stats.shared;
+			return false;
+		} else if (_ttl > 0) {
+			const auto i = _loaded.find(key);
+			if (i != end(_loaded)) {
+				if (crl::now() - i->second < _ttl) {
+					++_stats.cached;
+					return false;
+				}
+				_loaded.erase(i);
+			}
+		}
+		++_stats.sent;
+		return true;
+	}
+	void sent(const Key &key, mtpRequestId requestId) {
+		_inFlight[key] = requestId;
+	}
+
+	// Zero requestId means the data came without our request.
+	void loaded(const Key &key, mtpRequestId requestId = 0) {
+		if (requestId) {
+			const auto i = _inFlight.find(key);
+			if (i != end(_inFlight) && i->second == requestId) {
+				_inFlight.erase(i);
+			}
+		}
+		if (_ttl > 0) {
+			_loaded[key] = crl::now();
+			if (_loaded.size() >= _pruneLoadedAt) {
+				pruneLoaded();
+			}
+		}
+	}
+	void failed(const Key &key) {
+		_inFlight.remove(key);
+	}
+
+	[[nodiscard]] bool contains(const Key &key) const {
+		return _inFlight.contains(key);
+	}
+	[[nodiscard]] const Stats &stats() const {
+		return _stats;
+	}
+
+private:
+	static constexpr auto kMinPruneLoadedAt = size_t(256);
+
+	void pruneLoaded() {
+		const auto now = crl::now();
+		for (auto i = begin(_loaded); i != end(_loaded);) {
+			if (now - i->second >= _ttl) {
+				i = _loaded.erase(i);
+			} else {
+				++i;
+			}
+		}
+		_pruneLoadedAt = std::max(kMinPruneLoadedAt, _loaded.size() * 2);
+	}
+
+	const crl::time _ttl = 0;
+	base::flat_map<Key, mtpRequestId> _inFlight;
+	base::flat_map<Key, crl::time> _loaded;
+	size_t _pruneLoadedAt = kMinPruneLoadedAt;
+	Stats _stats;
+
+};
+
+} // namespace Api
@@ -52,6 +52,13 @@ namespace {
 
 constexpr auto kChannelGetDifferenceLimit = 100;
 
+// Difference messages are applied by batches until the slice time is over.
+constexpr auto kDifferenceBatch = 50;
+constexpr auto kDifferenceSliceDuration = crl::time(12);
+
+// Updates from one vector are fed until the slice time is over.
+constexpr auto kUpdatesSliceDuration = crl::time(8);
+
 // 1s wait after show channel history before sending getChannelDifference.
 constexpr auto kWaitForChannelGetDifference = crl::time(1000);
 
@@ -61,6 +68,9 @@ constexpr auto kNoUpdatesTimeout = 60 * 1000;
 // If nothing is received in 1 min when was a sleepmode we ping.
 constexpr auto kNoUpdatesAfterSleepTimeout = 60 * crl::time(1000);
 
+// While idle with an active window we check if user input was resumed.
+constexpr auto kIdleFinishCheckTimeout = crl::time(900);
+
 enum class DataIsLoadedResult {
 	NotLoaded = 0,
 	FromNotLoaded = 1,
@@ -220,6 +230,12 @@ Updates::Updates(not_null<Main::Session*> session)
 , _bySeqTimer([=] { getDifference(); })
 , _byMinChannelTimer([=] { getDifference(); })
 , _failDifferenceTimer([=] { getDifferenceAfterFail(); })
+, _pendingDifferencesTimer([=] { applyPendingDifferences(); })
+, _pendingUpdatesTimer([=] {
+	if (_pendingUpdates) {
+		applyPendingUpdates();
+	}
+})
 , _idleFinishTimer([=] { checkIdleFinish(); }) {
 	_ptsWaiter.setRequesting(true);
 
@@ -280,9 +296,9 @@ void Updates::checkLastUpdate(bool afterSleep) {
 	}
 }
 
-void Updates::feedUpdateVector(
+QVector<MTPUpdate> Updates::prepareUpdateVector(
 		const MTPVector<MTPUpdate> &updates,
-		SkipUpdatePolicy policy) {
+		SkipUpdatePolicy policy) const {
 	auto list = updates.v;
 	const auto hasGroupCallParticipantUpdates = ranges::contains(
 		list,
@@ -297,21 +313,102 @@ void Updates::feedUpdateVector(
 			}
 		});
 	} else if (policy == SkipUpdatePolicy::SkipExceptGroupCallParticipants) {
+		return {};
+	}
+	if (policy != SkipUpdatePolicy::SkipNone) {
+		list.erase(ranges::remove_if(list, [&](const MTPUpdate &entry) {
+			const auto type = entry.type();
+			return (policy == SkipUpdatePolicy::SkipMessageIds
+				&& type == mtpc_updateMessageID)
+				|| (policy == SkipUpdatePolicy::SkipExceptGroupCallParticipants
+					&& type != mtpc_updateGroupCallParticipants);
+		}), list.end());
+	}
+	return list;
+}
+
+void Updates::feedUpdateVector(
+		const MTPVector<MTPUpdate> &updates,
+		SkipUpdatePolicy policy) {
+	const auto list = prepareUpdateVector(updates, policy);
+	if (list.isEmpty()
+		&& policy == SkipUpdatePolicy::SkipExceptGroupCallParticipants) {
 		return;
 	}
-	for (const auto &entry : std::as_const(list)) {
-		const auto type = entry.type();
-		if ((policy == SkipUpdatePolicy::SkipMessageIds
-			&& type == mtpc_updateMessageID)
-			|| (policy == SkipUpdatePolicy::SkipExceptGroupCallParticipants
-				&& type != mtpc_updateGroupCallParticipants)) {
-			continue;
-		}
+	for (const auto &entry : list) {
 		feedUpdate(entry);
 	}
 	session().data().sendHistoryChangeNotifications();
 }
 
+void Updates::feedUpdateVectorSliced(
+		const MTPVector<MTPUpdate> &updates,
+		FnMut<void()> done) {
+	if (!_applyingReceivedUpdates
+		|| _applyingPendingUpdates
+		|| _pendingUpdates) {
+		feedUpdateVector(updates);
+		done();
+		return;
+	}
+	_pendingUpdates = PendingUpdates{
+		.list = prepareUpdateVector(updates, SkipUpdatePolicy::SkipNone),
+		.done = std::move(done),
+	};
+	session().changes().suspendNotifications();
+	applyPendingUpdates();
+}
+
+void Updates::applyPendingUpdates() {
+	Expects(_pendingUpdates.has_value());
+
+	const auto started = crl::now();
+	auto &pending = *_pendingUpdates;
+	const auto count = int(pending.list.size());
+	_applyingPendingUpdates = true;
+	while (pending.applied < count) {
+		feedUpdate(pending.list[pending.applied++]);
+		if (!_flushingUpdates
+			&& pending.applied < count
+			&& crl::now() - started >= kUpdatesSliceDuration) {
+			_applyingPendingUpdates = false;
+			_pendingUpdatesTimer.callOnce(0);
+			return;
+		}
+	}
+	_applyingPendingUpdates = false;
+	session().data().sendHistoryChangeNotifications();
+
+	auto done = std::move(pending.done);
+	_pendingUpdates = std::nullopt;
+	session().changes().resumeNotifications();
+	done();
+
+	if (!_flushingUpdates) {
+		applyQueuedUpdates();
+	}
+}
+
+void Updates::applyQueuedUpdates() {
+	while (!_pendingUpdates && !_queuedUpdates.empty()) {
+		const auto updates = std::move(_queuedUpdates.front());
+		_queuedUpdates.pop_front();
+		applyReceivedUpdates(updates);
+	}
+}
+
+void Updates::finishPendingUpdates() {
+	_pendingUpdatesTimer.cancel();
+	_flushingUpdates = true;
+	while (_pendingUpdates || !_queuedUpdates.empty()) {
+		if (_pendingUpdates) {
+			applyPendingUpdates();
+		}
+		applyQueuedUpdates();
+	}
+	_flushingUpdates = false;
+}
+
 void Updates::feedMessageIds(const MTPVector<MTPUpdate> &updates) {
 	for (const auto &update : updates.v) {
 		if (update.type() == mtpc_updateMessageID) {
@@ -386,10 +483,21 @@ void Updates::channelDifferenceDone(
 			QVector<MTPDialog>(1, data.vdialog()));
 		session().data().channelDifferenceTooLong(channel);
 	}, [&](const MTPDupdates_channelDifference &data) {
-		feedChannelDifference(data);
-		channel->ptsInit(data.vpts().v);
+		const auto pts = data.vpts().v;
+		feedChannelDifference(data, [=] {
+			channel->ptsInit(pts);
+			channelDifferenceApplied(channel, isFinal, timeout);
+		});
 	});
+	if (difference.type() != mtpc_updates_channelDifference) {
+		channelDifferenceApplied(channel, isFinal, timeout);
+	}
+}
 
+void Updates::channelDifferenceApplied(
+		not_null<ChannelData*> channel,
+		bool isFinal,
+		int32 timeout) {
 	channel->ptsSetRequesting(false);
 
 	if (!isFinal) {
@@ -408,19 +516,76 @@ void Updates::channelDifferenceDone(
 }
 
 void Updates::feedChannelDifference(
-		const MTPDupdates_channelDifference &data) {
+		const MTPDupdates_channelDifference &data,
+		FnMut<void()> done) {
 	session().data().processUsers(data.vusers());
 	session().data().processChats(data.vchats());
 
-	_handlingChannelDifference = true;
-	feedMessageIds(data.vother_updates());
-	session().data().processMessages(
+	queueDifference(
 		data.vnew_messages(),
-		NewMessageType::Unread);
-	feedUpdateVector(
 		data.vother_updates(),
-		SkipUpdatePolicy::SkipMessageIds);
-	_handlingChannelDifference = false;
+		true,
+		std::move(done));
+}
+
+void Updates::queueDifference(
+		const MTPVector<MTPMessage> &msgs,
+		const MTPVector<MTPUpdate> &other,
+		bool channel,
+		FnMut<void()> done) {
+	// Session::processMessages applies messages in the order of ids,
+	// keep that order between the batches as well.
+	auto messages = msgs.v;
+	ranges::stable_sort(messages, ranges::less(), [](const MTPMessage &m) {
+		return uint32(IdFromMessage(m).bare);
+	});
+	_pendingDifferences.push_back({
+		.messages = std::move(messages),
+		.other = other,
+		.channel = channel,
+		.done = std::move(done),
+	});
+	if (_pendingDifferences.size() == 1) {
+		applyPendingDifferences();
+	}
+}
+
+void Updates::applyPendingDifferences() {
+	const auto started = crl::now();
+	while (!_pendingDifferences.empty()) {
+		auto &pending = _pendingDifferences.front();
+		_handlingChannelDifference = pending.channel;
+		if (!pending.messageIdsFed) {
+			pending.messageIdsFed = true;
+			feedMessageIds(pending.other);
+		}
+		const auto count = int(pending.messages.size());
+		while (pending.applied < count) {
+			const auto batch = std::min(
+				count - pending.applied,
+				kDifferenceBatch);
+			session().data().processMessages(
+				pending.messages.mid(pending.applied, batch),
+				NewMessageType::Unread);
+			pending.applied += batch;
+
+			if (pending.applied < count
+				&& crl::now() - started >= kDifferenceSliceDuration) {
+				_handlingChannelDifference = false;
+				session().data().sendHistoryChangeNotifications();
+				_pendingDifferencesTimer.callOnce(0);
+				return;
+			}
+		}
+		feedUpdateVector(pending.other, SkipUpdatePolicy::SkipMessageIds);
+		_handlingChannelDifference = false;
+
+		auto done = std::move(pending.done);
+		_pendingDifferences.pop_front();
+		if (done) {
+			done();
+		}
+	}
 }
 
 void Updates::channelDifferenceFail(
@@ -460,23 +625,25 @@ void Updates::differenceDone(const MTPupdates_Difference &result) {
 	} break;
 	case mtpc_updates_differenceSlice: {
 		auto &d = result.c_updates_differenceSlice();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		auto &s = d.vintermediate_state().c_updates_state();
-		setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
+		const auto state = d.vintermediate_state();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			auto &s = state.c_updates_state();
+			setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
 
-		_ptsWaiter.setRequesting(false);
+			_ptsWaiter.setRequesting(false);
 
-		MTP_LOG(0, ("getDifference "
-			"{ good - after a slice of difference was received }%1"
-			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
-		getDifference();
+			MTP_LOG(0, ("getDifference "
+				"{ good - after a slice of difference was received }%1"
+				).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
+			getDifference();
+		});
 	} break;
 	case mtpc_updates_difference: {
 		auto &d = result.c_updates_difference();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		stateDone(d.vstate());
+		const auto state = d.vstate();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			stateDone(state);
+		});
 	} break;
 	case mtpc_updates_differenceTooLong: {
 		LOG(("API Error: updates.differenceTooLong is not supported by Telegram Desktop!"));
@@ -573,13 +740,12 @@ void Updates::feedDifference(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other) {
+		const MTPVector<MTPUpdate> &other,
+		FnMut<void()> done) {
 	Core::App().checkAutoLock();
 	session().data().processUsers(users);
 	session().data().processChats(chats);
-	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
-	feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+	queueDifference(msgs, other, false, std::move(done));
 }
 
 void Updates::differenceFail(const MTP::Error &error) {
@@ -805,19 +971,26 @@ void Updates::channelRangeDifferenceDone(
 	case mtpc_updates_channelDifference: {
 		const auto &d = result.c_updates_channelDifference();
 
-		feedChannelDifference(d);
-
 		nextRequestPts = d.vpts().v;
 		isFinal = d.is_final();
 	} break;
 	}
 
-	if (!isFinal && nextRequestPts) {
+	const auto requestNext = [=] {
 		MTP_LOG(0, ("getChannelDifference "
 			"{ good - after not final channelDifference was received, "
 			"validating history part }%1"
 			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
 		channelRangeDifferenceSend(channel, range, nextRequestPts);
+	};
+	if (result.type() == mtpc_updates_channelDifference) {
+		feedChannelDifference(result.c_updates_channelDifference(), [=] {
+			if (!isFinal && nextRequestPts) {
+				requestNext();
+			}
+		});
+	} else if (!isFinal && nextRequestPts) {
+		requestNext();
 	}
 }
 
@@ -833,9 +1006,21 @@ void Updates::mtpUpdateReceived(const MTPUpdates &updates) {
 	Core::App().checkAutoLock();
 	_lastUpdateTime = crl::now();
 	_noUpdatesTimer.callOnce(kNoUpdatesTimeout);
+	if (_pendingUpdates) {
+		// Keep the order, apply them after the current vector is done.
+		_queuedUpdates.push_back(updates);
+		return;
+	}
+	applyReceivedUpdates(updates);
+}
+
+void Updates::applyReceivedUpdates(const MTPUpdates &updates) {
 	if (!requestingDifference()
 		|| HasForceLogoutNotification(updates)) {
+		// Responses to our requests are still applied synchronously.
+		_applyingReceivedUpdates = true;
 		applyUpdates(updates);
+		_applyingReceivedUpdates = false;
 	} else {
 		applyGroupCallParticipantUpdates(updates);
 	}
@@ -896,9 +1081,14 @@ void Updates::updateOnline(crl::time lastNonIdleTime, bool gotOtherOffline) {
 			isOnline = false;
 			if (!isIdle()) {
 				_isIdle = true;
-				_idleFinishTimer.callOnce(900);
+				_idleFinishTimer.callOnce(kIdleFinishCheckTimeout);
 			}
 		} else {
+			if (isIdle()) {
+				// Non-idle time came from outside of updateNonIdle().
+				_idleFinishTimer.cancel();
+				_isIdle = false;
+			}
 			updateIn = qMin(updateIn, int(config.offlineIdleTimeout - idle));
 			Assert(updateIn >= 0);
 		}
@@ -951,8 +1141,12 @@ void Updates::checkIdleFinish(crl::time lastNonIdleTime) {
 		updateOnline(lastNonIdleTime);
 		_idleFinishTimer.cancel();
 		_isIdle = false;
+	} else if (Core::App().hasActiveWindow(&session())) {
+		_idleFinishTimer.callOnce(kIdleFinishCheckTimeout);
 	} else {
-		_idleFinishTimer.callOnce(900);
+		// Don't poll the system input time in background, activating
+		// the window calls updateNonIdle() that finishes the idle state.
+		_idleFinishTimer.cancel();
 	}
 }
 
@@ -1320,6 +1514,11 @@ void Updates::applyUpdates(
 		uint64 sentMessageRandomId) {
 	const auto randomId = sentMessageRandomId;
 
+	if (_pendingUpdates && !_applyingPendingUpdates) {
+		// The caller expects the updates to be applied right away.
+		finishPendingUpdates();
+	}
+
 	switch (updates.type()) {
 	case mtpc_updates: {
 		auto &d = updates.c_updates();
@@ -1336,9 +1535,11 @@ void Updates::applyUpdates(
 
 		session().data().processUsers(d.vusers());
 		session().data().processChats(d.vchats());
-		feedUpdateVector(d.vupdates());
-
-		setState(0, d.vdate().v, _updatesQts, d.vseq().v);
+		const auto date = d.vdate().v;
+		const auto seq = d.vseq().v;
+		feedUpdateVectorSliced(d.vupdates(), [=] {
+			setState(0, date, _updatesQts, seq);
+		});
 	} break;
 
 	case mtpc_updatesCombined: {
@@ -1356,9 +1557,11 @@ void Updates::applyUpdates(
 
 		session().data().processUsers(d.vusers());
 		session().data().processChats(d.vchats());
-		feedUpdateVector(d.vupdates());
-
-		setState(0, d.vdate().v, _updatesQts, d.vseq().v);
+		const auto date = d.vdate().v;
+		const auto seq = d.vseq().v;
+		feedUpdateVectorSliced(d.vupdates(), [=] {
+			setState(0, date, _updatesQts, seq);
+		});
 	} break;
 
 	case mtpc_updateShort: {
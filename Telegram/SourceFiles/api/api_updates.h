@@ -81,6 +81,19 @@ private:
 		PeerData *peer = nullptr;
 		rpl::lifetime lifetime;
 	};
+	struct PendingUpdates {
+		QVector<MTPUpdate> list;
+		int applied = 0;
+		FnMut<void()> done;
+	};
+	struct PendingDifference {
+		QVector<MTPMessage> messages;
+		MTPVector<MTPUpdate> other;
+		int applied = 0;
+		bool messageIdsFed = false;
+		bool channel = false;
+		FnMut<void()> done;
+	};
 
 	void channelRangeDifferenceSend(
 		not_null<ChannelData*> channel,
@@ -108,23 +121,53 @@ private:
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other);
+		const MTPVector<MTPUpdate> &other,
+		FnMut<void()> done);
 	void stateDone(const MTPupdates_State &state);
 	void setState(int32 pts, int32 date, int32 qts, int32 seq);
 	void channelDifferenceDone(
 		not_null<ChannelData*> channel,
 		const MTPupdates_ChannelDifference &diff);
+	void channelDifferenceApplied(
+		not_null<ChannelData*> channel,
+		bool isFinal,
+		int32 timeout);
 	void channelDifferenceFail(
 		not_null<ChannelData*> channel,
 		const MTP::Error &error);
 	void failDifferenceStartTimerFor(ChannelData *channel);
-	void feedChannelDifference(const MTPDupdates_channelDifference &data);
+	void feedChannelDifference(
+		const MTPDupdates_channelDifference &data,
+		FnMut<void()> done);
+
+	// Large differences are applied in time-limited slices, so that the
+	// UI stays responsive. The pts is not advanced until 'done' is called.
+	void queueDifference(
+		const MTPVector<MTPMessage> &msgs,
+		const MTPVector<MTPUpdate> &other,
+		bool channel,
+		FnMut<void()> done);
+	void applyPendingDifferences();
 
 	void mtpUpdateReceived(const MTPUpdates &updates);
 	void mtpNewSessionCreated();
+	void applyReceivedUpdates(const MTPUpdates &updates);
+	[[nodiscard]] QVector<MTPUpdate> prepareUpdateVector(
+		const MTPVector<MTPUpdate> &updates,
+		SkipUpdatePolicy policy) const;
 	void feedUpdateVector(
 		const MTPVector<MTPUpdate> &updates,
 		SkipUpdatePolicy policy = SkipUpdatePolicy::SkipNone);
+
+	// Long update vectors pushed by the server are fed in time-limited
+	// slices. Updates received meanwhile are queued, direct applyUpdates()
+	// calls with request results finish them first.
+	void feedUpdateVectorSliced(
+		const MTPVector<MTPUpdate> &updates,
+		FnMut<void()> done);
+	void applyPendingUpdates();
+	void applyQueuedUpdates();
+	void finishPendingUpdates();
 	// Doesn't call sendHistoryChangeNotifications itself.
 	void feedMessageIds(const MTPVector<MTPUpdate> &updates);
 	// Doesn't call sendHistoryChangeNotifications itself.
@@ -196,6 +239,16 @@ private:
 	crl::time _lastUpdateTime = 0;
 	bool _handlingChannelDifference = false;
 
+	std::deque<PendingDifference> _pendingDifferences;
+	base::Timer _pendingDifferencesTimer;
+
+	std::optional<PendingUpdates> _pendingUpdates;
+	std::deque<MTPUpdates> _queuedUpdates;
+	base::Timer _pendingUpdatesTimer;
+	bool _applyingReceivedUpdates = false;
+	bool _applyingPendingUpdates = false;
+	bool _flushingUpdates = false;
+
 	base::flat_map<int, ActiveChatTracker> _activeChats;
 	base::flat_map<
 		not_null<PeerData*>,
@@ -21,6 +21,9 @@ namespace {
 // Send channel views each second.
 constexpr auto kSendViewsTimeout = crl::time(1000);
 
+// But not more often than once in three seconds for the same peer.
+constexpr auto kSendViewsPeerTimeout = 3 * crl::time(1000);
+
 } // namespace
 
 ViewsManager::ViewsManager(not_null<ApiWrap*> api)
@@ -50,14 +53,27 @@ void ViewsManager::scheduleIncrement(not_null<HistoryItem*> item) {
 
 void ViewsManager::removeIncremented(not_null<PeerData*> peer) {
 	_incremented.remove(peer);
+	_incrementSentAt.remove(peer);
 }
 
 void ViewsManager::viewsIncrement() {
+	const auto now = crl::now();
+	auto wait = crl::time(0);
 	for (auto i = _toIncrement.begin(); i != _toIncrement.cend();) {
 		if (_incrementRequests.contains(i->first)) {
 			++i;
 			continue;
 		}
+		const auto sent = _incrementSentAt.find(i->first);
+		if (sent != end(_incrementSentAt)) {
+			// Fast-moving feeds collect ids for a while longer.
+			const auto left = sent->second + kSendViewsPeerTimeout - now;
+			if (left > 0) {
+				wait = wait ? std::min(wait, left) : left;
+				++i;
+				continue;
+			}
+		}
 
 		QVector<MTPint> ids;
 		ids.reserve(i->second.size());
@@ -77,8 +93,19 @@ void ViewsManager::viewsIncrement() {
 		}).afterDelay(5).send();
 
 		_incrementRequests.emplace(i->first, requestId);
+		_incrementByRequest.emplace(requestId, i->first);
+		_incrementSentAt[i->first] = now;
 		i = _toIncrement.erase(i);
 	}
+	if (wait > 0) {
+		_incrementTimer.callOnce(std::max(wait, kSendViewsTimeout));
+	}
+}
+
+void ViewsManager::scheduleViewsIncrement() {
+	if (!_toIncrement.empty() && !_incrementTimer.isActive()) {
+		_incrementTimer.callOnce(kSendViewsTimeout);
+	}
 }
 
 void ViewsManager::done(
@@ -90,47 +117,37 @@ void ViewsManager::done(
 	owner.processUsers(data.vusers());
 	owner.processChats(data.vchats());
 	auto &v = data.vviews().v;
-	if (ids.size() == v.size()) {
-		for (const auto &[peer, id] : _incrementRequests) {
-			if (id != requestId) {
-				continue;
-			}
-			const auto channel = peerToChannel(peer->id);
-			for (auto j = 0, l = int(ids.size()); j < l; ++j) {
-				if (const auto item = owner.message(channel, ids[j].v)) {
-					v[j].match([&](const MTPDmessageViews &data) {
-						if (const auto views = data.vviews()) {
-							item->setViewsCount(views->v);
-						}
-						if (const auto forwards = data.vforwards()) {
-							item->setForwardsCount(forwards->v);
-						}
-						if (const auto replies = data.vreplies()) {
-							item->setReplies(
-								HistoryMessageRepliesData(replies));
-						}
-					});
-				}
+	const auto peer = _incrementByRequest.take(requestId);
+	if (peer) {
+		_incrementRequests.remove(*peer);
+	}
+	if (peer && ids.size() == v.size()) {
+		const auto channel = peerToChannel((*peer)->id);
+		for (auto j = 0, l = int(ids.size()); j < l; ++j) {
+			if (const auto item = owner.message(channel, ids[j].v)) {
+				v[j].match([&](const MTPDmessageViews &data) {
+					if (const auto views = data.vviews()) {
+						item->setViewsCount(views->v);
+					}
+					if (const auto forwards = data.vforwards()) {
+						item->setForwardsCount(forwards->v);
+					}
+					if (const auto replies = data.vreplies()) {
+						item->setReplies(
+							HistoryMessageRepliesData(replies));
+					}
+				});
 			}
-			_incrementRequests.erase(peer);
-			break;
 		}
 	}
-	if (!_toIncrement.empty() && !_incrementTimer.isActive()) {
-		_incrementTimer.callOnce(kSendViewsTimeout);
-	}
+	scheduleViewsIncrement();
 }
 
 void ViewsManager::fail(const MTP::Error &error, mtpRequestId requestId) {
-	for (const auto &[peer, id] : _incrementRequests) {
-		if (id == requestId) {
-			_incrementRequests.erase(peer);
-			break;
-		}
-	}
-	if (!_toIncrement.empty() && !_incrementTimer.isActive()) {
-		_incrementTimer.callOnce(kSendViewsTimeout);
+	if (const auto peer = _incrementByRequest.take(requestId)) {
+		_incrementRequests.remove(*peer);
 	}
+	scheduleViewsIncrement();
 }
 
 } // namespace Api
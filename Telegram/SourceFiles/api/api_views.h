@@ -28,6 +28,7 @@ public:
 
 private:
 	void viewsIncrement();
+	void scheduleViewsIncrement();
 
 	void done(
 		QVector<MTPint> ids,
@@ -42,6 +43,7 @@ private:
 	base::flat_map<not_null<PeerData*>, base::flat_set<MsgId>> _toIncrement;
 	base::flat_map<not_null<PeerData*>, mtpRequestId> _incrementRequests;
 	base::flat_map<mtpRequestId, not_null<PeerData*>> _incrementByRequest;
+	base::flat_map<not_null<PeerData*>, crl::time> _incrementSentAt;
 	base::Timer _incrementTimer;
 
 };
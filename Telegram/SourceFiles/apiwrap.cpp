@@ -27,6 +27,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_confirm_phone.h"
 #include "data/stickers/data_stickers.h"
 #include "data/data_drafts.h"
+#include "data/data_full_peer_cache.h"
 #include "data/data_changes.h"
 #include "data/data_photo.h"
 #include "data/data_web_page.h"
@@ -111,11 +112,15 @@ constexpr auto kUnreadMentionsNextRequestLimit = 100;
 constexpr auto kSharedMediaLimit = 100;
 constexpr auto kReadFeaturedSetsTimeout = crl::time(1000);
 constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
+constexpr auto kFileLoaderParallelTasks = 4;
 constexpr auto kStickersByEmojiInvalidateTimeout = crl::time(6 * 1000);
 constexpr auto kNotifySettingSaveTimeout = crl::time(1000);
 constexpr auto kDialogsFirstLoad = 20;
 constexpr auto kDialogsPerPage = 500;
 constexpr auto kJoinErrorDuration = 5 * crl::time(1000);
+constexpr auto kFullPeerCacheTimeout = crl::time(1000);
+constexpr auto kPeerCacheTimeout = crl::time(1000);
+constexpr auto kMessageDataBatchCap = 100;
 
 using PhotoFileLocationId = Data::PhotoFileLocationId;
 using DocumentFileLocationId = Data::DocumentFileLocationId;
@@ -130,12 +135,18 @@ using UpdatedFileReferences = Data::UpdatedFileReferences;
 ApiWrap::ApiWrap(not_null<Main::Session*> session)
 : MTP::Sender(&session->account().mtp())
 , _session(session)
-, _messageDataResolveDelayed([=] { resolveMessageDatas(); })
+, _messageDataResolveBatcher(
+	[=] { resolveMessageDatas(); },
+	kMessageDataBatchCap)
+, _fullPeerRequests(kFullPeerCacheTimeout)
+, _peerRequests(kPeerCacheTimeout)
 , _webPagesTimer([=] { resolveWebPages(); })
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
 , _dialogsLoadState(std::make_unique<DialogsLoadState>())
-, _fileLoader(std::make_unique<TaskQueue>(kFileLoaderQueueStopTimeout))
+, _fileLoader(std::make_unique<TaskQueue>(
+	kFileLoaderQueueStopTimeout,
+	kFileLoaderParallelTasks))
 , _topPromotionTimer([=] { refreshTopPromotion(); })
 , _updateNotifySettingsTimer([=] { sendNotifySettingsUpdates(); })
 , _authorizations(std::make_unique<Api::Authorizations>(this))
@@ -523,7 +534,7 @@ void ApiWrap::requestMessageData(
 		requests.callbacks.push_back(callback);
 	}
 	if (!requests.requestId) {
-		_messageDataResolveDelayed.call();
+		_messageDataResolveBatcher.add();
 	}
 }
 
@@ -562,6 +573,7 @@ void ApiWrap::resolveMessageDatas() {
 		return;
 	}
 
+	const auto sent = crl::now();
 	const auto ids = collectMessageIds(_messageDataRequests);
 	if (!ids.isEmpty()) {
 		const auto requestId = request(MTPmessages_GetMessages(
@@ -569,6 +581,7 @@ void ApiWrap::resolveMessageDatas() {
 		)).done([=](
 				const MTPmessages_Messages &result,
 				mtpRequestId requestId) {
+			_messageDataResolveBatcher.requestFinished(sent);
 			_session->data().processExistingMessages(nullptr, result);
 			finalizeMessageDataRequest(nullptr, requestId);
 		}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
@@ -596,6 +609,7 @@ void ApiWrap::resolveMessageDatas() {
 			)).done([=](
 					const MTPmessages_Messages &result,
 					mtpRequestId requestId) {
+				_messageDataResolveBatcher.requestFinished(sent);
 				_session->data().processExistingMessages(channel, result);
 				finalizeMessageDataRequest(channel, requestId);
 			}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
@@ -842,18 +856,23 @@ void ApiWrap::requestMoreDialogsIfNeeded() {
 		|| _dialogsLoadState->listReceived;
 	if (_session->data().chatsFilters().loadNextExceptions(dialogsReady)) {
 		return;
-	} else if (_dialogsLoadState && !_dialogsLoadState->listReceived) {
-		if (_dialogsLoadState->requestId) {
-			return;
-		}
+	}
+	const auto mainListRequested = !dialogsReady
+		&& _dialogsLoadState->requestId;
+	if (!dialogsReady && !mainListRequested) {
 		requestDialogs(nullptr);
-	} else if (const auto folder = _session->data().folderLoaded(
+	}
+
+	// The archive is paged in parallel with the main list, not after it.
+	if (const auto folder = _session->data().folderLoaded(
 			Data::Folder::kId)) {
 		if (_session->data().chatsFilters().archiveNeeded()) {
 			requestMoreDialogs(folder);
 		}
 	}
-	requestContacts();
+	if (!mainListRequested) {
+		requestContacts();
+	}
 }
 
 void ApiWrap::updateDialogsOffset(
@@ -1020,13 +1039,18 @@ void ApiWrap::requestWallPaper(
 }
 
 void ApiWrap::requestFullPeer(not_null<PeerData*> peer) {
-	if (_fullPeerRequests.contains(peer)) {
+	if (!peer->wasFullUpdated() && !_fullPeerCacheRead.contains(peer)) {
+		// Show what we had last time until the server answers.
+		_fullPeerCacheRead.emplace(peer);
+		Data::ReadCachedFullPeer(peer);
+	}
+	if (!_fullPeerRequests.start(peer)) {
 		return;
 	}
 
 	const auto requestId = [&] {
 		const auto failHandler = [=](const MTP::Error &error) {
-			_fullPeerRequests.remove(peer);
+			_fullPeerRequests.failed(peer);
 			migrateFail(peer, error);
 		};
 		if (const auto user = peer->asUser()) {
@@ -1058,7 +1082,15 @@ void ApiWrap::requestFullPeer(not_null<PeerData*> peer) {
 		}
 		Unexpected("Peer type in requestFullPeer.");
 	}();
-	_fullPeerRequests.insert(peer, requestId);
+	_fullPeerRequests.sent(peer, requestId);
+}
+
+auto ApiWrap::fullPeerRequestsStats() const -> const PeerRequestsStats& {
+	return _fullPeerRequests.stats();
+}
+
+auto ApiWrap::peerRequestsStats() const -> const PeerRequestsStats& {
+	return _peerRequests.stats();
 }
 
 void ApiWrap::processFullPeer(
@@ -1099,12 +1131,9 @@ void ApiWrap::gotChatFull(
 		}
 	});
 
-	if (req) {
-		const auto i = _fullPeerRequests.find(peer);
-		if (i != _fullPeerRequests.cend() && i.value() == req) {
-			_fullPeerRequests.erase(i);
-		}
-	}
+	Data::CacheFullChat(peer, d.vfull_chat());
+
+	_fullPeerRequests.loaded(peer, req);
 	_session->changes().peerUpdated(
 		peer,
 		Data::PeerUpdate::Flag::FullInfo);
@@ -1123,29 +1152,27 @@ void ApiWrap::gotUserFull(
 		return;
 	}
 	Data::ApplyUserUpdate(user, d);
+	Data::CacheFullUser(user, result);
 
-	if (req) {
-		const auto i = _fullPeerRequests.find(user);
-		if (i != _fullPeerRequests.cend() && i.value() == req) {
-			_fullPeerRequests.erase(i);
-		}
-	}
+	_fullPeerRequests.loaded(user, req);
 	_session->changes().peerUpdated(
 		user,
 		Data::PeerUpdate::Flag::FullInfo);
 }
 
 void ApiWrap::requestPeer(not_null<PeerData*> peer) {
-	if (_fullPeerRequests.contains(peer) || _peerRequests.contains(peer)) {
+	if (_fullPeerRequests.contains(peer) || !_peerRequests.start(peer)) {
 		return;
 	}
 
 	const auto requestId = [&] {
 		const auto failHandler = [=](const MTP::Error &error) {
-			_peerRequests.remove(peer);
+			_peerRequests.failed(peer);
 		};
-		const auto chatHandler = [=](const MTPmessages_Chats &result) {
-			_peerRequests.remove(peer);
+		const auto chatHandler = [=](
+				const MTPmessages_Chats &result,
+				mtpRequestId requestId) {
+			_peerRequests.loaded(peer, requestId);
 			const auto &chats = result.match([](const auto &data) {
 				return data.vchats();
 			});
@@ -1155,8 +1182,10 @@ void ApiWrap::requestPeer(not_null<PeerData*> peer) {
 		if (const auto user = peer->asUser()) {
 			return request(MTPusers_GetUsers(
 				MTP_vector<MTPInputUser>(1, user->inputUser)
-			)).done([=](const MTPVector<MTPUser> &result) {
-				_peerRequests.remove(user);
+			)).done([=](
+					const MTPVector<MTPUser> &result,
+					mtpRequestId requestId) {
+				_peerRequests.loaded(user, requestId);
 				_session->data().processUsers(result);
 			}).fail(failHandler).send();
 		} else if (const auto chat = peer->asChat()) {
@@ -1170,7 +1199,7 @@ void ApiWrap::requestPeer(not_null<PeerData*> peer) {
 		}
 		Unexpected("Peer type in requestPeer.");
 	}();
-	_peerRequests.insert(peer, requestId);
+	_peerRequests.sent(peer, requestId);
 }
 
 void ApiWrap::requestPeerSettings(not_null<PeerData*> peer) {
@@ -2224,7 +2253,13 @@ void ApiWrap::sendNotifySettingsUpdates() {
 }
 
 void ApiWrap::saveDraftToCloudDelayed(not_null<History*> history) {
-	_draftsSaveRequestIds.emplace(history, 0);
+	const auto [i, ok] = _draftsSaveRequestIds.emplace(history, 0);
+	if (!ok && i->second) {
+		// Keep only one request for a chat, the latest draft will be
+		// sent when it finishes and all the states in between dropped.
+		_draftsSaveAgain.emplace(history);
+		return;
+	}
 	if (!_draftsSaveTimer.isActive()) {
 		_draftsSaveTimer.callOnce(kSaveCloudDraftTimeout);
 	}
@@ -2477,12 +2512,7 @@ void ApiWrap::saveDraftsToCloud() {
 					history->draftSavedToCloud();
 				}
 			}
-			auto i = _draftsSaveRequestIds.find(history);
-			if (i != _draftsSaveRequestIds.cend()
-				&& i->second == response.requestId) {
-				_draftsSaveRequestIds.erase(history);
-				checkQuitPreventFinished();
-			}
+			draftSaveFinished(history, response.requestId);
 		}).fail([=](const MTP::Error &error, const MTP::Response &response) {
 			history->finishSavingCloudDraft(
 				UnixtimeFromMsgId(response.outerMsgId));
@@ -2492,18 +2522,36 @@ void ApiWrap::saveDraftsToCloud() {
 					history->clearCloudDraft();
 				}
 			}
-			auto i = _draftsSaveRequestIds.find(history);
-			if (i != _draftsSaveRequestIds.cend()
-				&& i->second == response.requestId) {
-				_draftsSaveRequestIds.erase(history);
-				checkQuitPreventFinished();
-			}
+			draftSaveFinished(history, response.requestId);
 		}).send();
 
 		i->second = cloudDraft->saveRequestId;
 	}
 }
 
+void ApiWrap::draftSaveFinished(
+		not_null<History*> history,
+		mtpRequestId requestId) {
+	const auto i = _draftsSaveRequestIds.find(history);
+	if (i == _draftsSaveRequestIds.cend() || i->second != requestId) {
+		return;
+	}
+	_draftsSaveRequestIds.erase(i);
+	if (_draftsSaveAgain.remove(history)) {
+		const auto localDraft = history->localDraft();
+		const auto cloudDraft = history->cloudDraft();
+		if (_session->supportMode()
+			|| !Data::draftsAreEqual(localDraft, cloudDraft)) {
+			saveDraftToCloudDelayed(history);
+			if (App::quitting()) {
+				saveDraftsToCloud();
+			}
+			return;
+		}
+	}
+	checkQuitPreventFinished();
+}
+
 bool ApiWrap::isQuitPrevent() {
 	if (_draftsSaveRequestIds.empty()) {
 		return false;
@@ -8,6 +8,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "api/api_common.h"
+#include "api/api_request_batcher.h"
+#include "api/api_shared_requests.h"
 #include "base/timer.h"
 #include "base/flat_map.h"
 #include "base/flat_set.h"
@@ -170,6 +172,11 @@ public:
 
 	void requestFullPeer(not_null<PeerData*> peer);
 	void requestPeer(not_null<PeerData*> peer);
+
+	using PeerRequestsStats = Api::SharedRequests<
+		not_null<PeerData*>>::Stats;
+	[[nodiscard]] const PeerRequestsStats &fullPeerRequestsStats() const;
+	[[nodiscard]] const PeerRequestsStats &peerRequestsStats() const;
 	void requestPeers(const QList<PeerData*> &peers);
 	void requestPeerSettings(not_null<PeerData*> peer);
 	void requestLastParticipants(not_null<ChannelData*> channel);
@@ -444,6 +451,9 @@ private:
 	void checkQuitPreventFinished();
 
 	void saveDraftsToCloud();
+	void draftSaveFinished(
+		not_null<History*> history,
+		mtpRequestId requestId);
 
 	void resolveMessageDatas();
 	void finalizeMessageDataRequest(
@@ -575,11 +585,12 @@ private:
 	base::flat_map<
 		ChannelData*,
 		MessageDataRequests> _channelMessageDataRequests;
-	SingleQueuedInvokation _messageDataResolveDelayed;
+	Api::RequestBatcher _messageDataResolveBatcher;
 
+	Api::SharedRequests<not_null<PeerData*>> _fullPeerRequests;
+	base::flat_set<not_null<PeerData*>> _fullPeerCacheRead;
+	Api::SharedRequests<not_null<PeerData*>> _peerRequests;
 	using PeerRequests = QMap<PeerData*, mtpRequestId>;
-	PeerRequests _fullPeerRequests;
-	PeerRequests _peerRequests;
 	base::flat_set<not_null<PeerData*>> _requestedPeerSettings;
 
 	PeerRequests _participantsRequests;
@@ -610,6 +621,7 @@ private:
 	QMap<ChannelData*, mtpRequestId> _channelAmInRequests;
 	base::flat_map<PeerId, mtpRequestId> _notifySettingRequests;
 	base::flat_map<not_null<History*>, mtpRequestId> _draftsSaveRequestIds;
+	base::flat_set<not_null<History*>> _draftsSaveAgain;
 	base::Timer _draftsSaveTimer;
 
 	base::flat_set<mtpRequestId> _stickerSetDisenableRequests;
@@ -32,6 +32,33 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <rpl/range.h>
 
+namespace {
+
+constexpr auto kKeepUserpicsHeightsCount = 10;
+
+// Moves *position so that [begin, end) becomes sorted, if all the other
+// elements are sorted already. Returns the range of moved elements.
+template <typename Iterator, typename Less>
+std::pair<Iterator, Iterator> RepositionSorted(
+		Iterator begin,
+		Iterator end,
+		Iterator position,
+		Less &&less) {
+	const auto after = position + 1;
+	if (position != begin && less(*position, *(position - 1))) {
+		const auto to = std::upper_bound(begin, position, *position, less);
+		std::rotate(to, position, after);
+		return { to, after };
+	} else if (after != end && less(*after, *position)) {
+		const auto to = std::lower_bound(after, end, *position, less);
+		std::rotate(position, after, to);
+		return { position, to };
+	}
+	return { position, position };
+}
+
+} // namespace
+
 PaintRoundImageCallback PaintUserpicCallback(
 		not_null<PeerData*> peer,
 		bool respectSavedMessagesChat) {
@@ -595,6 +622,10 @@ std::shared_ptr<Data::CloudImageView> &PeerListRow::ensureUserpicView() {
 	return _userpic;
 }
 
+void PeerListRow::releaseUserpicView() {
+	_userpic = nullptr;
+}
+
 PaintRoundImageCallback PeerListRow::generatePaintUserpicCallback() {
 	const auto saved = _isSavedMessagesChat;
 	const auto replies = _isRepliesMessagesChat;
@@ -1006,6 +1037,53 @@ PeerListRow *PeerListContent::findRow(PeerListRowId id) {
 	return (it == _rowsById.cend()) ? nullptr : it->second.get();
 }
 
+void PeerListContent::repositionRow(
+		not_null<PeerListRow*> row,
+		Fn<bool(const PeerListRow &a, const PeerListRow &b)> compare) {
+	if (row->isSearchResult()) {
+		return;
+	}
+	const auto less = [&](const auto &a, const auto &b) {
+		return compare(*a, *b);
+	};
+	const auto reposition = [&](auto &list) {
+		const auto i = ranges::find(list, row);
+		return (i != end(list))
+			? RepositionSorted(begin(list), end(list), i, less)
+			: std::pair{ end(list), end(list) };
+	};
+	const auto index = row->absoluteIndex();
+	Assert(index >= 0 && index < _rows.size());
+	Assert(_rows[index].get() == row);
+
+	const auto [from, till] = RepositionSorted(
+		begin(_rows),
+		end(_rows),
+		begin(_rows) + index,
+		less);
+	if (from == till) {
+		return;
+	}
+	for (auto i = from; i != till; ++i) {
+		(*i)->setAbsoluteIndex(i - begin(_rows));
+	}
+	for (const auto ch : row->nameFirstLetters()) {
+		if (const auto i = _searchIndex.find(ch); i != end(_searchIndex)) {
+			reposition(i->second);
+		}
+	}
+	if (!_hiddenRows.empty()) {
+		reposition(_filterResults);
+	}
+	if (showingSearch()) {
+		update();
+	} else {
+		const auto top = getRowTop(RowIndex(from - begin(_rows)));
+		const auto bottom = getRowTop(RowIndex(till - begin(_rows)));
+		update(0, top, width(), bottom - top);
+	}
+}
+
 void PeerListContent::removeRow(not_null<PeerListRow*> row) {
 	auto index = row->absoluteIndex();
 	auto isSearchResult = row->isSearchResult();
@@ -1704,6 +1782,31 @@ void PeerListContent::loadProfilePhotos() {
 			}
 		}
 	}
+	const auto keep = (_visibleBottom - _visibleTop)
+		* kKeepUserpicsHeightsCount
+		/ _rowHeight;
+	releaseFarUserpics(
+		std::max(yFrom / _rowHeight - keep, 0),
+		std::min(yTo / _rowHeight + 1 + keep, rowsCount));
+}
+
+void PeerListContent::releaseFarUserpics(int from, int till) {
+	// Rows of huge lists are not destroyed while scrolling,
+	// but the userpic images of the far ones can be freed.
+	const auto count = shownRowsCount();
+	const auto release = [&](int index) {
+		if (index < count && (index < from || index >= till)) {
+			getRow(RowIndex(index))->releaseUserpicView();
+		}
+	};
+	for (auto i = _userpicsFrom; i < std::min(_userpicsTill, from); ++i) {
+		release(i);
+	}
+	for (auto i = std::max(_userpicsFrom, till); i < _userpicsTill; ++i) {
+		release(i);
+	}
+	_userpicsFrom = from;
+	_userpicsTill = till;
 }
 
 void PeerListContent::checkScrollForPreload() {
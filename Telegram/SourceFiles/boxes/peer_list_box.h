@@ -84,6 +84,7 @@ public:
 	}
 
 	[[nodiscard]] std::shared_ptr<Data::CloudImageView> &ensureUserpicView();
+	void releaseUserpicView();
 
 	[[nodiscard]] virtual QString generateName();
 	[[nodiscard]] virtual QString generateShortName();
@@ -314,6 +315,11 @@ public:
 	virtual void peerListSortRows(Fn<bool(const PeerListRow &a, const PeerListRow &b)> compare) = 0;
 	virtual int peerListPartitionRows(Fn<bool(const PeerListRow &a)> border) = 0;
 
+	// Moves a single row to its place, other rows must be sorted already.
+	virtual void peerListRepositionRow(
+		not_null<PeerListRow*> row,
+		Fn<bool(const PeerListRow &a, const PeerListRow &b)> compare) = 0;
+
 	template <typename PeerDataRange>
 	void peerListAddSelectedPeers(PeerDataRange &&range) {
 		for (const auto peer : range) {
@@ -595,6 +601,9 @@ public:
 		updateRow(row, RowIndex());
 	}
 	void removeRow(not_null<PeerListRow*> row);
+	void repositionRow(
+		not_null<PeerListRow*> row,
+		Fn<bool(const PeerListRow &a, const PeerListRow &b)> compare);
 	void convertRowToSearchResult(not_null<PeerListRow*> row);
 	int fullRowsCount() const;
 	not_null<PeerListRow*> rowAt(int index) const;
@@ -718,6 +727,7 @@ private:
 
 	void selectByMouse(QPoint globalPosition);
 	void loadProfilePhotos();
+	void releaseFarUserpics(int from, int till);
 	void checkScrollForPreload();
 
 	void updateRow(not_null<PeerListRow*> row, RowIndex hint);
@@ -773,6 +783,8 @@ private:
 	int _rowHeight = 0;
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
+	int _userpicsFrom = 0;
+	int _userpicsTill = 0;
 
 	Selected _selected;
 	Selected _pressed;
@@ -925,6 +937,11 @@ public:
 		});
 		return result;
 	}
+	void peerListRepositionRow(
+			not_null<PeerListRow*> row,
+			Fn<bool(const PeerListRow &a, const PeerListRow &b)> compare) override {
+		_content->repositionRow(row, std::move(compare));
+	}
 	std::unique_ptr<PeerListState> peerListSaveState() const override {
 		return _content->saveState();
 	}
@@ -41,6 +41,7 @@ constexpr auto kForwardMessagesOnAdd = 100;
 constexpr auto kParticipantsFirstPageCount = 16;
 constexpr auto kParticipantsPerPage = 200;
 constexpr auto kSortByOnlineDelay = crl::time(1000);
+constexpr auto kRepositionRowsMax = 64;
 
 void RemoveAdmin(
 		not_null<ChannelData*> channel,
@@ -720,32 +721,43 @@ ParticipantsOnlineSorter::ParticipantsOnlineSorter(
 	not_null<PeerListDelegate*> delegate)
 : _peer(peer)
 , _delegate(delegate)
-, _sortByOnlineTimer([=] { sort(); }) {
+, _sortByOnlineTimer([=] { sortChanged(); }) {
 	peer->session().changes().peerUpdates(
 		Data::PeerUpdate::Flag::OnlineStatus
 	) | rpl::start_with_next([=](const Data::PeerUpdate &update) {
 		const auto peerId = update.peer->id;
 		if (const auto row = _delegate->peerListFindRow(peerId.value)) {
 			row->refreshStatus();
-			sortDelayed();
+			_delegate->peerListUpdateRow(row);
+			sortDelayed(row->id());
 		}
 	}, _lifetime);
 	sort();
 }
 
-void ParticipantsOnlineSorter::sortDelayed() {
+void ParticipantsOnlineSorter::sortDelayed(PeerListRowId changed) {
+	_changedRows.emplace(changed);
 	if (!_sortByOnlineTimer.isActive()) {
 		_sortByOnlineTimer.callOnce(kSortByOnlineDelay);
 	}
 }
 
-void ParticipantsOnlineSorter::sort() {
+bool ParticipantsOnlineSorter::sortAllowed() {
 	const auto channel = _peer->asChannel();
 	if (channel
 		&& (!channel->isMegagroup()
 			|| (channel->membersCount()
 				> channel->session().serverConfig().chatSizeMax))) {
 		_onlineCount = 0;
+		return false;
+	}
+	return true;
+}
+
+void ParticipantsOnlineSorter::sort() {
+	_changedRows.clear();
+	_sortByOnlineTimer.cancel();
+	if (!sortAllowed()) {
 		return;
 	}
 	const auto now = base::unixtime::now();
@@ -758,6 +770,28 @@ void ParticipantsOnlineSorter::sort() {
 	refreshOnlineCount();
 }
 
+void ParticipantsOnlineSorter::sortChanged() {
+	if (_changedRows.size() > kRepositionRowsMax) {
+		sort();
+		return;
+	}
+	const auto changed = base::take(_changedRows);
+	if (!sortAllowed()) {
+		return;
+	}
+	const auto now = base::unixtime::now();
+	const auto compare = [=](const PeerListRow &a, const PeerListRow &b) {
+		return Data::SortByOnlineValue(a.peer()->asUser(), now) >
+			Data::SortByOnlineValue(b.peer()->asUser(), now);
+	};
+	for (const auto id : changed) {
+		if (const auto row = _delegate->peerListFindRow(id)) {
+			_delegate->peerListRepositionRow(row, compare);
+		}
+	}
+	refreshOnlineCount();
+}
+
 rpl::producer<int> ParticipantsOnlineSorter::onlineCountValue() const {
 	return _onlineCount.value();
 }
@@ -63,11 +63,14 @@ public:
 	rpl::producer<int> onlineCountValue() const;
 
 private:
-	void sortDelayed();
+	[[nodiscard]] bool sortAllowed();
+	void sortDelayed(PeerListRowId changed);
+	void sortChanged();
 	void refreshOnlineCount();
 
 	const not_null<PeerData*> _peer;
 	const not_null<PeerListDelegate*> _delegate;
+	base::flat_set<PeerListRowId> _changedRows;
 	base::Timer _sortByOnlineTimer;
 	rpl::variable<int> _onlineCount = 0;
 	rpl::lifetime _lifetime;
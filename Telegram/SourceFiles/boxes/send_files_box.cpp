@@ -35,6 +35,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/chat/attach/attach_prepare.h"
 #include "ui/chat/attach/attach_send_files_way.h"
 #include "ui/chat/attach/attach_album_preview.h"
+#include "ui/chat/attach/attach_album_thumbnail.h"
 #include "ui/chat/attach/attach_single_file_preview.h"
 #include "ui/chat/attach/attach_single_media_preview.h"
 #include "ui/text/format_values.h"
@@ -102,7 +103,8 @@ SendFilesBox::Block::Block(
 	int from,
 	int till,
 	Fn<bool()> gifPaused,
-	SendFilesWay way)
+	SendFilesWay way,
+	std::shared_ptr<Ui::AlbumThumbnailCache> thumbnailCache)
 : _items(items)
 , _from(from)
 , _till(till) {
@@ -118,7 +120,8 @@ SendFilesBox::Block::Block(
 		const auto preview = Ui::CreateChild<Ui::AlbumPreview>(
 			parent.get(),
 			my,
-			way);
+			way,
+			std::move(thumbnailCache));
 		_preview.reset(preview);
 	} else {
 		const auto media = Ui::SingleMediaPreview::Create(
@@ -247,6 +250,7 @@ SendFilesBox::SendFilesBox(
 , _sendType(sendType)
 , _titleHeight(st::boxTitleHeight)
 , _list(std::move(list))
+, _thumbnailCache(std::make_shared<Ui::AlbumThumbnailCache>())
 , _sendLimit(limit)
 , _sendMenuType(sendMenuType)
 , _caption(
@@ -542,7 +546,8 @@ void SendFilesBox::pushBlock(int from, int till) {
 		from,
 		till,
 		gifPaused,
-		_sendWay.current());
+		_sendWay.current(),
+		_thumbnailCache);
 	auto &block = _blocks.back();
 	const auto widget = _inner->add(
 		block.takeWidget(),
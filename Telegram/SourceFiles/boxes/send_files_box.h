@@ -34,6 +34,7 @@ class InputField;
 struct GroupMediaLayout;
 class EmojiButton;
 class AlbumPreview;
+class AlbumThumbnailCache;
 class VerticalLayout;
 class FlatLabel;
 } // namespace Ui
@@ -93,7 +94,8 @@ private:
 			int from,
 			int till,
 			Fn<bool()> gifPaused,
-			Ui::SendFilesWay way);
+			Ui::SendFilesWay way,
+			std::shared_ptr<Ui::AlbumThumbnailCache> thumbnailCache);
 		Block(Block &&other) = default;
 		Block &operator=(Block &&other) = default;
 
@@ -165,6 +167,7 @@ private:
 
 	Ui::PreparedList _list;
 	std::optional<int> _removingIndex;
+	const std::shared_ptr<Ui::AlbumThumbnailCache> _thumbnailCache;
 
 	SendLimit _sendLimit = SendLimit::Many;
 	SendMenu::Type _sendMenuType = SendMenu::Type();
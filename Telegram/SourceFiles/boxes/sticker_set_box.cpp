@@ -660,7 +660,7 @@ not_null<Lottie::MultiPlayer*> StickerSetBox::Inner::getLottiePlayer() {
 	if (!_lottiePlayer) {
 		_lottiePlayer = std::make_unique<Lottie::MultiPlayer>(
 			Lottie::Quality::Default,
-			Lottie::MakeFrameRenderer());
+			ChatHelpers::LottieRenderer());
 		_lottiePlayer->updates(
 		) | rpl::start_with_next([=] {
 			update();
@@ -704,9 +704,10 @@ void StickerSetBox::Inner::paintEvent(QPaintEvent *e) {
 	}
 
 	if (_lottiePlayer) {
-		const auto paused = _controller->isGifPausedAtLeastFor(
+		const auto allowed = _controller->animationFrameAllowed(
+			_lottiePlayer.get(),
 			Window::GifPauseReason::Layer);
-		if (!paused) {
+		if (allowed) {
 			_lottiePlayer->markFrameShown();
 		}
 	}
@@ -224,6 +224,7 @@ private:
 	void updateRowThumbnail(not_null<Row*> row);
 
 	void readVisibleSets();
+	void clearInvisibleThumbnails();
 
 	void updateControlsGeometry();
 	void rebuildAppendSet(not_null<StickersSet*> set, int maxNameWidth);
@@ -1362,9 +1363,10 @@ void StickersBox::Inner::paintRowThumbnail(
 				size.width(),
 				size.height()),
 			frame);
-		const auto paused = _controller->isGifPausedAtLeastFor(
+		const auto allowed = _controller->animationFrameAllowed(
+			row->lottie.get(),
 			Window::GifPauseReason::Layer);
-		if (!paused) {
+		if (allowed) {
 			row->lottie->markFrameShown();
 		}
 	}
@@ -2324,9 +2326,36 @@ void StickersBox::Inner::visibleTopBottomUpdated(
 	if (_section == Section::Featured) {
 		readVisibleSets();
 	}
+	clearInvisibleThumbnails();
 	checkLoadMore();
 }
 
+void StickersBox::Inner::clearInvisibleThumbnails() {
+	// Keep one screen above and below, so that scrolling doesn't flicker.
+	const auto height = (_visibleBottom - _visibleTop);
+	const auto itemsVisibleTop = _visibleTop - _itemsTop - height;
+	const auto itemsVisibleBottom = _visibleBottom - _itemsTop + height;
+	const auto rowFrom = floorclamp(
+		itemsVisibleTop,
+		_rowHeight,
+		0,
+		_rows.size());
+	const auto rowTo = ceilclamp(
+		itemsVisibleBottom,
+		_rowHeight,
+		0,
+		_rows.size());
+	for (auto i = 0, count = int(_rows.size()); i != count; ++i) {
+		if ((i >= rowFrom && i < rowTo) || i == _dragging) {
+			continue;
+		}
+		const auto row = _rows[i].get();
+		row->lottie = nullptr;
+		row->thumbnailMedia = nullptr;
+		row->stickerMedia = nullptr;
+	}
+}
+
 void StickersBox::Inner::checkLoadMore() {
 	if (_loadMoreCallback) {
 		auto scrollHeight = (_visibleBottom - _visibleTop);
@@ -425,6 +425,12 @@ void Panel::reinitWithCall(Call *call) {
 			: QSize());
 		if (_incoming->widget()->isHidden()) {
 			return;
+		} else if (window()->isHidden()
+			|| (window()->windowState() & Qt::WindowMinimized)) {
+			// Nobody will see this frame, drop it right away so that
+			// the track doesn't wait for us to paint it.
+			track->markFrameShown();
+			return;
 		}
 		const auto incoming = incomingFrameGeometry();
 		const auto outgoing = outgoingFrameGeometry();
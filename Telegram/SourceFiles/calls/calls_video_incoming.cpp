@@ -439,15 +439,24 @@ void Panel::Incoming::RendererSW::paintFallback(
 	const auto markGuard = gsl::finally([&] {
 		_owner->_track->markFrameShown();
 	});
-	const auto data = _owner->_track->frameWithInfo(true);
-	const auto &image = data.original;
+	const auto data = _owner->_track->frameWithInfo(false);
+	const auto rect = _owner->widget()->rect();
 	const auto rotation = data.rotation;
+
+	// Let the track scale its yuv420 frame right to the widget size,
+	// painting the full resolution ARGB32 frame with smooth scaling
+	// each time is too expensive for large incoming videos.
+	using namespace Media::View;
+	const auto size = FlipSizeByRotation(
+		rect.size() * cIntRetinaFactor(),
+		rotation);
+	const auto image = (data.format != Webrtc::FrameFormat::None
+		&& !size.isEmpty())
+		? _owner->_track->frame({ .resize = size, .outer = size })
+		: QImage();
 	if (image.isNull()) {
 		p.fillRect(clip.boundingRect(), Qt::black);
 	} else {
-		const auto rect = _owner->widget()->rect();
-		using namespace Media::View;
-		auto hq = PainterHighQualityEnabler(p);
 		if (UsePainterRotation(rotation)) {
 			if (rotation) {
 				p.save();
@@ -51,6 +51,10 @@ constexpr auto kFixManualLargeVideoDuration = 5 * crl::time(1000);
 constexpr auto kFixSpeakingLargeVideoDuration = 3 * crl::time(1000);
 constexpr auto kFullAsMediumsCount = 4; // 1 Full is like 4 Mediums.
 constexpr auto kMaxMediumQualities = 16; // 4 Fulls or 16 Mediums.
+constexpr auto kMinMediumQualities = 4; // 1 Full or 4 Mediums.
+constexpr auto kCheckVideoLoadInterval = 2 * crl::time(1000);
+constexpr auto kMinRenderedFramesPerSecond = 10;
+constexpr auto kRestoreVideoLoadChecks = 5;
 
 [[nodiscard]] std::unique_ptr<Webrtc::MediaDevices> CreateMediaDevices() {
 	const auto &settings = Core::App().settings();
@@ -88,6 +92,14 @@ constexpr auto kMaxMediumQualities = 16; // 4 Fulls or 16 Mediums.
 	return (i == end(list)) ? 1 : (i->raisedHandRating + 1);
 }
 
+// Levels are collected on the tgcalls thread and the main thread takes
+// all of them at once, so a busy main thread doesn't get a queue of them.
+struct PendingLevels {
+	QMutex mutex;
+	base::flat_map<uint32, tgcalls::GroupLevelValue> values;
+	bool scheduled = false;
+};
+
 struct JoinVideoEndpoint {
 	std::string id;
 };
@@ -247,6 +259,7 @@ struct GroupCall::VideoTrack {
 	not_null<PeerData*> peer;
 	rpl::lifetime lifetime;
 	Group::VideoQuality quality = Group::VideoQuality();
+	int framesRendered = 0;
 	bool shown = false;
 };
 
@@ -575,6 +588,7 @@ GroupCall::GroupCall(
 , _scheduleDate(info.scheduleDate)
 , _lastSpokeCheckTimer([=] { checkLastSpoke(); })
 , _checkJoinedTimer([=] { checkJoined(); })
+, _videoLoadCheckTimer([=] { checkVideoLoad(); })
 , _pushToTalkCancelTimer([=] { pushToTalkCancel(); })
 , _connectingSoundTimer([=] { playConnectingSoundOnce(); })
 , _mediaDevices(CreateMediaDevices()) {
@@ -1159,9 +1173,12 @@ void GroupCall::markEndpointActive(
 			const auto size = track->frameSize();
 			if (size.isEmpty()) {
 				track->markFrameShown();
-			} else if (!activeTrack->shown) {
-				activeTrack->shown = true;
-				markTrackShown(endpoint, true);
+			} else {
+				++activeTrack->framesRendered;
+				if (!activeTrack->shown) {
+					activeTrack->shown = true;
+					markTrackShown(endpoint, true);
+				}
 			}
 			activeTrack->trackSize = size;
 		}, i->second->lifetime);
@@ -1182,6 +1199,9 @@ void GroupCall::markEndpointActive(
 			}, i->second->lifetime);
 		}
 		addVideoOutput(i->first.id, { track->sink() });
+		if (!_videoLoadCheckTimer.isActive()) {
+			_videoLoadCheckTimer.callEach(kCheckVideoLoadInterval);
+		}
 	} else {
 		if (_videoEndpointLarge.current() == endpoint) {
 			setVideoEndpointLarge({});
@@ -2271,6 +2291,7 @@ bool GroupCall::tryCreateController() {
 
 	const auto weak = base::make_weak(&_instanceGuard);
 	const auto myLevel = std::make_shared<tgcalls::GroupLevelValue>();
+	const auto pending = std::make_shared<PendingLevels>();
 	tgcalls::GroupInstanceDescriptor descriptor = {
 		.threads = tgcalls::StaticThreads::getThreads(),
 		.config = tgcalls::GroupConfig{
@@ -2291,7 +2312,40 @@ bool GroupCall::tryCreateController() {
 				}
 				*myLevel = updates.front().value;
 			}
-			crl::on_main(weak, [=] { audioLevelsUpdated(data); });
+			{
+				QMutexLocker lock(&pending->mutex);
+				for (const auto &[ssrc, value] : updates) {
+					// Keep the loudest value since the last publish.
+					const auto i = pending->values.find(ssrc);
+					if (i == end(pending->values)) {
+						pending->values.emplace(ssrc, value);
+					} else {
+						i->second.level = std::max(
+							i->second.level,
+							value.level);
+						i->second.voice = i->second.voice || value.voice;
+					}
+				}
+				if (pending->scheduled) {
+					return;
+				}
+				pending->scheduled = true;
+			}
+			crl::on_main(weak, [=] {
+				auto data = tgcalls::GroupLevelsUpdate();
+				{
+					QMutexLocker lock(&pending->mutex);
+					pending->scheduled = false;
+					const auto values = base::take(pending->values);
+					data.updates.reserve(values.size());
+					for (const auto &[ssrc, value] : values) {
+						data.updates.push_back({ ssrc, value });
+					}
+				}
+				if (!data.updates.empty()) {
+					audioLevelsUpdated(data);
+				}
+			});
 		},
 		.initialInputDeviceId = _audioInputId.toStdString(),
 		.initialOutputDeviceId = _audioOutputId.toStdString(),
@@ -2627,9 +2681,12 @@ void GroupCall::updateRequestedVideoChannels() {
 	// Try to preserve all cameras as Medium;
 	const auto mediumsCount = mediums
 		+ (fullcameras + fullscreencasts) * kFullAsMediumsCount;
-	const auto downgradeSome = (mediumsCount > kMaxMediumQualities);
+	const auto maxMediums = _maxMediumQualities
+		? _maxMediumQualities
+		: kMaxMediumQualities;
+	const auto downgradeSome = (mediumsCount > maxMediums);
 	const auto downgradeAll = (fullscreencasts * kFullAsMediumsCount)
-		> kMaxMediumQualities;
+		> maxMediums;
 	if (downgradeSome) {
 		for (auto &channel : channels) {
 			if (channel.maxQuality == Quality::Full) {
@@ -2650,7 +2707,7 @@ void GroupCall::updateRequestedVideoChannels() {
 			fullscreencasts = 0;
 		}
 	}
-	if (mediums > kMaxMediumQualities) {
+	if (mediums > maxMediums) {
 		for (auto &channel : channels) {
 			if (channel.maxQuality == Quality::Medium) {
 				channel.maxQuality = Quality::Thumbnail;
@@ -2672,6 +2729,54 @@ void GroupCall::updateRequestedVideoChannelsDelayed() {
 	});
 }
 
+void GroupCall::checkVideoLoad() {
+	if (_activeVideoTracks.empty()) {
+		_videoLoadCheckTimer.cancel();
+		return;
+	}
+
+	// Camera streams requested above Thumbnail quality that we don't
+	// manage to decode and render fast enough mean that we've asked for
+	// more pixels than this machine can handle, so we lower the budget.
+	// Screencasts are skipped, they have low frame rates by design.
+	const auto minFrames = kMinRenderedFramesPerSecond
+		* kCheckVideoLoadInterval
+		/ crl::time(1000);
+	auto checked = 0;
+	auto slow = 0;
+	for (const auto &[endpoint, video] : _activeVideoTracks) {
+		const auto frames = base::take(video->framesRendered);
+		if (endpoint.type != VideoEndpointType::Camera
+			|| video->quality == Group::VideoQuality::Thumbnail
+			|| video->track.state() != Webrtc::VideoState::Active) {
+			continue;
+		}
+		++checked;
+		if (frames < minFrames) {
+			++slow;
+		}
+	}
+	const auto current = _maxMediumQualities
+		? _maxMediumQualities
+		: kMaxMediumQualities;
+	auto updated = current;
+	if (checked > 1 && slow * 2 > checked) {
+		_videoLoadGoodChecks = 0;
+		updated = std::max(current - kFullAsMediumsCount, kMinMediumQualities);
+	} else if (!slow && current < kMaxMediumQualities) {
+		if (++_videoLoadGoodChecks >= kRestoreVideoLoadChecks) {
+			_videoLoadGoodChecks = 0;
+			updated = std::min(
+				current + kFullAsMediumsCount,
+				kMaxMediumQualities);
+		}
+	}
+	if (updated != current) {
+		_maxMediumQualities = updated;
+		updateRequestedVideoChannelsDelayed();
+	}
+}
+
 void GroupCall::fillActiveVideoEndpoints() {
 	const auto real = lookupReal();
 	Assert(real != nullptr);
@@ -520,6 +520,7 @@ private:
 	void updateRequestedVideoChannels();
 	void updateRequestedVideoChannelsDelayed();
 	void fillActiveVideoEndpoints();
+	void checkVideoLoad();
 
 	void editParticipant(
 		not_null<PeerData*> participantPeer,
@@ -563,6 +564,8 @@ private:
 	rpl::event_stream<Error> _errors;
 	bool _recordingStoppedByMe = false;
 	bool _requestedVideoChannelsUpdateScheduled = false;
+	int _maxMediumQualities = 0;
+	int _videoLoadGoodChecks = 0;
 
 	MTP::DcId _broadcastDcId = 0;
 	base::flat_map<not_null<LoadPartTask*>, LoadingPart> _broadcastParts;
@@ -640,6 +643,7 @@ private:
 	rpl::event_stream<> _titleChanged;
 	base::Timer _lastSpokeCheckTimer;
 	base::Timer _checkJoinedTimer;
+	base::Timer _videoLoadCheckTimer;
 
 	crl::time _lastSendProgressUpdate = 0;
 
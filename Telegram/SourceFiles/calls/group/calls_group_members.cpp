@@ -554,18 +554,14 @@ void Members::Controller::updateRow(
 	} else if (addedToBottom) {
 		const auto real = _call->lookupReal();
 		if (real && real->joinedToTop()) {
-			const auto proj = [&](const PeerListRow &other) {
-				const auto &real = static_cast<const Row&>(other);
-				return real.speaking()
-					? 2
-					: (&real == addedToBottom)
-					? 1
-					: 0;
-			};
-			delegate()->peerListSortRows([&](
-					const PeerListRow &a,
-					const PeerListRow &b) {
-				return proj(a) > proj(b);
+			// Speaking, then the new row, then all others: two stable
+			// partitions give that order without sorting all the rows.
+			delegate()->peerListPartitionRows([](const PeerListRow &other) {
+				return static_cast<const Row&>(other).speaking();
+			});
+			delegate()->peerListPartitionRows([&](const PeerListRow &other) {
+				return static_cast<const Row&>(other).speaking()
+					|| (&other == addedToBottom);
 			});
 		}
 	}
@@ -656,6 +652,17 @@ void Members::Controller::checkRowPosition(not_null<Row*> row) {
 	// Someone started speaking and has a non-speaking row above him.
 	// Or someone raised hand and has force muted above him.
 	// Or someone was forced muted and had can_unmute_self below him. Sort.
+	if (!_peer->canManageGroupCall()) {
+		// Only speaking rows are moved up here: 'row' to the top, all
+		// other speaking below it, so two stable partitions are enough.
+		delegate()->peerListPartitionRows([](const PeerListRow &other) {
+			return static_cast<const Row&>(other).speaking();
+		});
+		delegate()->peerListPartitionRows([&](const PeerListRow &other) {
+			return (&other == row.get());
+		});
+		return;
+	}
 	static constexpr auto kTop = std::numeric_limits<uint64>::max();
 	const auto projForAdmin = [&](const PeerListRow &other) {
 		const auto &real = static_cast<const Row&>(other);
@@ -671,23 +678,11 @@ void Members::Controller::checkRowPosition(not_null<Row*> row) {
 			// All not force-muted lie between raised hands and speaking.
 			: (kTop - 2);
 	};
-	const auto projForOther = [&](const PeerListRow &other) {
-		const auto &real = static_cast<const Row&>(other);
-		return real.speaking()
-			// Speaking 'row' to the top, all other speaking below it.
-			? (&real == row.get() ? kTop : (kTop - 1))
-			: 0ULL;
-	};
-
-	using Comparator = Fn<bool(const PeerListRow&, const PeerListRow&)>;
-	const auto makeComparator = [&](const auto &proj) -> Comparator {
-		return [&](const PeerListRow &a, const PeerListRow &b) {
-			return proj(a) > proj(b);
-		};
-	};
-	delegate()->peerListSortRows(_peer->canManageGroupCall()
-		? makeComparator(projForAdmin)
-		: makeComparator(projForOther));
+	delegate()->peerListSortRows([&](
+			const PeerListRow &a,
+			const PeerListRow &b) {
+		return projForAdmin(a) > projForAdmin(b);
+	});
 }
 
 void Members::Controller::updateRow(
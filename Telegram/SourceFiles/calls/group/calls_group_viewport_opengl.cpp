@@ -761,12 +761,22 @@ void Viewport::RendererGL::paintTile(
 		geometry.size(),
 		_factor);
 	prepareObjects(f, tileData, blurSize);
-	f.glViewport(0, 0, blurSize.width(), blurSize.height());
 
-	bindFrame(f, data, tileData, _downscaleProgram);
+	// The first blur pass result depends only on the frame itself,
+	// so while the frame is the same we repaint only the final pass.
+	const auto imageIndex = _userpicFrame ? 0 : (data.index + 1);
+	if (tileData.blurredIndex != imageIndex
+		|| tileData.blurredRotation != frameRotation) {
+		tileData.blurredIndex = imageIndex;
+		tileData.blurredRotation = frameRotation;
+
+		f.glViewport(0, 0, blurSize.width(), blurSize.height());
 
-	drawDownscalePass(f, tileData);
-	drawFirstBlurPass(f, tileData, blurSize);
+		bindFrame(f, data, tileData, _downscaleProgram);
+
+		drawDownscalePass(f, tileData);
+		drawFirstBlurPass(f, tileData, blurSize);
+	}
 
 	f.glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject);
 	setDefaultViewport(f);
@@ -895,6 +905,7 @@ void Viewport::RendererGL::prepareObjects(
 		return;
 	}
 	tileData.textureBlurSize = blurSize;
+	tileData.blurredIndex = -1;
 
 	const auto create = [&](int framebufferIndex, int index) {
 		tileData.textures.bind(f, index);
@@ -1264,6 +1275,8 @@ void Viewport::RendererGL::validateDatas() {
 			maybeStaleAfter->stale = false;
 			maybeStaleAfter->pause = paused;
 			maybeStaleAfter->paused.stop();
+			maybeStaleAfter->trackIndex = -1;
+			maybeStaleAfter->blurredIndex = -1;
 			request.updating = true;
 		} else {
 			// This invalidates maybeStale*, but they're already equal.
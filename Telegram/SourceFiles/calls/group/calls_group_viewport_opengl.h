@@ -54,6 +54,8 @@ private:
 		QRect nameRect;
 		int nameVersion = 0;
 		mutable int trackIndex = -1;
+		mutable int blurredIndex = -1;
+		mutable int blurredRotation = 0;
 		mutable QSize rgbaSize;
 		mutable QSize textureSize;
 		mutable QSize textureChromaSize;
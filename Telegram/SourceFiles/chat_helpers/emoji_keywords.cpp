@@ -25,6 +25,9 @@ namespace {
 constexpr auto kRefreshEach = 60 * 60 * crl::time(1000); // 1 hour.
 constexpr auto kKeepNotUsedLangPacksCount = 4;
 constexpr auto kKeepNotUsedInputLanguagesCount = 4;
+constexpr auto kIndexMagic = quint32(0x4957'4B54); // "TKWI"
+constexpr auto kIndexFormat = quint32(1);
+constexpr auto kNoKey = quint32(-1);
 
 using namespace Ui::Emoji;
 
@@ -35,10 +38,90 @@ struct LangPackEmoji {
 	QString text;
 };
 
-struct LangPackData {
-	int version = 0;
-	int maxKeyLength = 0;
-	std::map<QString, std::vector<LangPackEmoji>> emoji;
+using KeywordsMap = std::map<QString, std::vector<LangPackEmoji>>;
+
+// The index is a prefix trie over the sorted keywords, packed in a single
+// buffer that is written to the cache file as is. Keywords in a subtree
+// form a contiguous range, so a prefix query is one walk down the trie.
+struct PackedHeader {
+	quint32 magic = 0;
+	quint32 format = 0;
+	qint32 version = 0;
+	quint32 maxKeyLength = 0;
+	quint32 nodesCount = 0;
+	quint32 keysCount = 0;
+	quint32 emojiCount = 0;
+	quint32 charsCount = 0;
+};
+
+struct PackedNode {
+	quint32 ch = 0;
+	quint32 childrenCount = 0;
+	quint32 firstChild = 0;
+	quint32 keysBegin = 0;
+	quint32 keysEnd = 0;
+	quint32 exact = kNoKey;
+};
+
+struct PackedString {
+	quint32 offset = 0;
+	quint32 length = 0;
+};
+
+struct PackedKey {
+	PackedString text;
+	quint32 emojiBegin = 0;
+	quint32 emojiEnd = 0;
+};
+
+struct PackedEmoji {
+	PackedString text;
+	PackedString lookup;
+};
+
+static_assert(sizeof(PackedHeader) == 32);
+static_assert(sizeof(PackedNode) == 24);
+static_assert(sizeof(PackedKey) == 16);
+static_assert(sizeof(PackedEmoji) == 16);
+
+class KeywordsIndex final {
+public:
+	KeywordsIndex() = default;
+
+	[[nodiscard]] static KeywordsIndex FromPacked(QByteArray packed);
+	[[nodiscard]] static KeywordsIndex Build(
+		int version,
+		const KeywordsMap &emoji);
+
+	[[nodiscard]] int version() const;
+	[[nodiscard]] int maxKeyLength() const;
+	[[nodiscard]] bool empty() const;
+	[[nodiscard]] const QByteArray &packed() const;
+	[[nodiscard]] KeywordsMap unpack() const;
+	void resetVersion();
+
+	void query(
+		std::vector<Result> &result,
+		const QString &normalized,
+		bool exact) const;
+
+private:
+	explicit KeywordsIndex(QByteArray packed);
+
+	[[nodiscard]] bool valid() const;
+	[[nodiscard]] const PackedHeader &header() const;
+	[[nodiscard]] const PackedNode *nodes() const;
+	[[nodiscard]] const PackedKey *keys() const;
+	[[nodiscard]] const PackedEmoji *emoji() const;
+	[[nodiscard]] const QChar *chars() const;
+	[[nodiscard]] QString string(PackedString value) const;
+	[[nodiscard]] QString rawString(PackedString value) const;
+	void appendKey(
+		std::vector<Result> &result,
+		const PackedKey &key) const;
+
+	QByteArray _packed;
+
 };
 
 [[nodiscard]] bool MustAddPostfix(const QString &text) {
@@ -91,12 +174,24 @@ void CreateCacheFilePath() {
 	return internal::CacheFileFolder() + qstr("/keywords/") + id;
 }
 
-[[nodiscard]] LangPackData ReadLocalCache(const QString &id) {
+[[nodiscard]] QString IndexFilePath(const QString &id) {
+	const auto path = CacheFilePath(id);
+	return path.isEmpty() ? path : (path + qstr(".index"));
+}
+
+[[nodiscard]] LangPackEmoji ResolveEmoji(const QString &text) {
+	const auto emoji = MustAddPostfix(text)
+		? (text + QChar(Ui::Emoji::kPostfix))
+		: text;
+	return { FindExact(emoji), text };
+}
+
+[[nodiscard]] KeywordsIndex ReadLegacyLocalCache(const QString &id) {
 	auto file = QFile(CacheFilePath(id));
 	if (!file.open(QIODevice::ReadOnly)) {
 		return {};
 	}
-	auto result = LangPackData();
+	auto result = KeywordsMap();
 	auto stream = QDataStream(&file);
 	stream.setVersion(QDataStream::Qt_5_1);
 	auto version = qint32();
@@ -116,50 +211,46 @@ void CreateCacheFilePath() {
 		if (size < 0 || stream.status() != QDataStream::Ok) {
 			return {};
 		}
-		auto &list = result.emoji[key];
+		auto &list = result[key];
 		for (auto j = 0; j != size; ++j) {
 			auto text = QString();
 			stream >> text;
 			if (stream.status() != QDataStream::Ok) {
 				return {};
 			}
-			const auto emoji = MustAddPostfix(text)
-				? (text + QChar(Ui::Emoji::kPostfix))
-				: text;
-			const auto entry = LangPackEmoji{ FindExact(emoji), text };
+			const auto entry = ResolveEmoji(text);
 			if (!entry.emoji) {
 				return {};
 			}
 			list.push_back(entry);
 		}
-		result.maxKeyLength = std::max(result.maxKeyLength, int(key.size()));
 	}
-	result.version = version;
-	return result;
+	return KeywordsIndex::Build(version, result);
 }
 
-void WriteLocalCache(const QString &id, const LangPackData &data) {
-	if (!data.version && data.emoji.empty()) {
+void WriteLocalCache(const QString &id, const KeywordsIndex &index) {
+	if (!index.version() && index.empty()) {
 		return;
 	}
 	CreateCacheFilePath();
-	auto file = QFile(CacheFilePath(id));
+	auto file = QFile(IndexFilePath(id));
 	if (!file.open(QIODevice::WriteOnly)) {
 		return;
 	}
-	auto stream = QDataStream(&file);
-	stream.setVersion(QDataStream::Qt_5_1);
-	stream
-		<< qint32(data.version)
-		<< qint32(data.emoji.size());
-	for (const auto &[key, list] : data.emoji) {
-		stream
-			<< key
-			<< qint32(list.size());
-		for (const auto &emoji : list) {
-			stream << emoji.text;
-		}
+	file.write(index.packed());
+}
+
+[[nodiscard]] KeywordsIndex ReadLocalCache(const QString &id) {
+	auto file = QFile(IndexFilePath(id));
+	if (file.open(QIODevice::ReadOnly)) {
+		return KeywordsIndex::FromPacked(file.readAll());
 	}
+	auto result = ReadLegacyLocalCache(id);
+	if (result.version() || !result.empty()) {
+		WriteLocalCache(id, result);
+		QFile::remove(CacheFilePath(id));
+	}
+	return result;
 }
 
 [[nodiscard]] QString NormalizeQuery(const QString &query) {
@@ -170,30 +261,6 @@ void WriteLocalCache(const QString &id, const LangPackData &data) {
 	return key.toLower().trimmed();
 }
 
-void AppendFoundEmoji(
-		std::vector<Result> &result,
-		const QString &label,
-		const std::vector<LangPackEmoji> &list) {
-	// It is important that the 'result' won't relocate while inserting.
-	result.reserve(result.size() + list.size());
-	const auto alreadyBegin = begin(result);
-	const auto alreadyEnd = alreadyBegin + result.size();
-
-	auto &&add = ranges::views::all(
-		list
-	) | ranges::views::filter([&](const LangPackEmoji &entry) {
-		const auto i = ranges::find(
-			alreadyBegin,
-			alreadyEnd,
-			entry.emoji,
-			&Result::emoji);
-		return (i == alreadyEnd);
-	}) | ranges::views::transform([&](const LangPackEmoji &entry) {
-		return Result{ entry.emoji, label, entry.text };
-	});
-	result.insert(end(result), add.begin(), add.end());
-}
-
 void AppendLegacySuggestions(
 		std::vector<Result> &result,
 		const QString &query) {
@@ -239,25 +306,21 @@ void AppendLegacySuggestions(
 }
 
 void ApplyDifference(
-		LangPackData &data,
+		KeywordsIndex &index,
 		const QVector<MTPEmojiKeyword> &keywords,
 		int version) {
-	data.version = version;
+	auto data = index.unpack();
 	for (const auto &keyword : keywords) {
 		keyword.match([&](const MTPDemojiKeyword &keyword) {
 			const auto word = NormalizeKey(qs(keyword.vkeyword()));
 			if (word.isEmpty()) {
 				return;
 			}
-			auto &list = data.emoji[word];
+			auto &list = data[word];
 			auto &&emoji = ranges::views::all(
 				keyword.vemoticons().v
 			) | ranges::views::transform([](const MTPstring &string) {
-				const auto text = qs(string);
-				const auto emoji = MustAddPostfix(text)
-					? (text + QChar(Ui::Emoji::kPostfix))
-					: text;
-				return LangPackEmoji{ FindExact(emoji), text };
+				return ResolveEmoji(qs(string));
 			}) | ranges::views::filter([&](const LangPackEmoji &entry) {
 				if (!entry.emoji) {
 					LOG(("API Warning: emoji %1 is not supported, word: %2."
@@ -273,8 +336,8 @@ void ApplyDifference(
 			if (word.isEmpty()) {
 				return;
 			}
-			const auto i = data.emoji.find(word);
-			if (i == end(data.emoji)) {
+			const auto i = data.find(word);
+			if (i == end(data)) {
 				return;
 			}
 			auto &list = i->second;
@@ -284,19 +347,304 @@ void ApplyDifference(
 					end(list));
 			}
 			if (list.empty()) {
-				data.emoji.erase(i);
+				data.erase(i);
 			}
 		});
 	}
-	if (data.emoji.empty()) {
-		data.maxKeyLength = 0;
+	index = KeywordsIndex::Build(version, data);
+}
+
+KeywordsIndex::KeywordsIndex(QByteArray packed) : _packed(std::move(packed)) {
+}
+
+KeywordsIndex KeywordsIndex::FromPacked(QByteArray packed) {
+	auto result = KeywordsIndex(std::move(packed));
+	return result.valid() ? result : KeywordsIndex();
+}
+
+KeywordsIndex KeywordsIndex::Build(int version, const KeywordsMap &emoji) {
+	auto texts = std::vector<const QString*>();
+	auto keys = std::vector<PackedKey>();
+	auto packedEmoji = std::vector<PackedEmoji>();
+	auto chars = QString();
+	auto maxKeyLength = 0;
+	texts.reserve(emoji.size());
+	keys.reserve(emoji.size());
+	const auto push = [&](const QString &text) {
+		const auto result = PackedString{
+			.offset = quint32(chars.size()),
+			.length = quint32(text.size()),
+		};
+		chars.append(text);
+		return result;
+	};
+	for (const auto &[key, list] : emoji) {
+		if (list.empty()) {
+			continue;
+		}
+		auto packedKey = PackedKey{
+			.text = push(key),
+			.emojiBegin = quint32(packedEmoji.size()),
+		};
+		for (const auto &entry : list) {
+			const auto text = push(entry.text);
+			const auto lookup = MustAddPostfix(entry.text)
+				? push(entry.text + QChar(Ui::Emoji::kPostfix))
+				: text;
+			packedEmoji.push_back({ text, lookup });
+		}
+		packedKey.emojiEnd = quint32(packedEmoji.size());
+		keys.push_back(packedKey);
+		texts.push_back(&key);
+		accumulate_max(maxKeyLength, int(key.size()));
+	}
+
+	// Children of each node are allocated together, sorted by the char.
+	auto nodes = std::vector<PackedNode>(1);
+	const auto build = [&](
+			auto &&self,
+			int index,
+			int depth,
+			int from,
+			int till) -> void {
+		nodes[index].keysBegin = from;
+		nodes[index].keysEnd = till;
+		if (from < till && texts[from]->size() == depth) {
+			nodes[index].exact = from++;
+		}
+		const auto charAt = [&](int key) {
+			return quint32((*texts[key])[depth].unicode());
+		};
+		auto children = 0;
+		for (auto i = from; i != till; ++i) {
+			if (i == from || charAt(i) != charAt(i - 1)) {
+				++children;
+			}
+		}
+		const auto first = int(nodes.size());
+		nodes[index].firstChild = first;
+		nodes[index].childrenCount = children;
+		nodes.resize(first + children);
+		auto child = first;
+		for (auto i = from; i != till; ++child) {
+			const auto ch = charAt(i);
+			auto j = i + 1;
+			while (j != till && charAt(j) == ch) {
+				++j;
+			}
+			nodes[child].ch = ch;
+			self(self, child, depth + 1, i, j);
+			i = j;
+		}
+	};
+	build(build, 0, 0, 0, int(keys.size()));
+
+	const auto header = PackedHeader{
+		.magic = kIndexMagic,
+		.format = kIndexFormat,
+		.version = version,
+		.maxKeyLength = quint32(maxKeyLength),
+		.nodesCount = quint32(nodes.size()),
+		.keysCount = quint32(keys.size()),
+		.emojiCount = quint32(packedEmoji.size()),
+		.charsCount = quint32(chars.size()),
+	};
+	auto packed = QByteArray();
+	packed.reserve(int(sizeof(PackedHeader)
+		+ nodes.size() * sizeof(PackedNode)
+		+ keys.size() * sizeof(PackedKey)
+		+ packedEmoji.size() * sizeof(PackedEmoji)
+		+ chars.size() * sizeof(QChar)));
+	const auto append = [&](const auto *data, std::size_t count) {
+		packed.append(
+			reinterpret_cast<const char*>(data),
+			int(count * sizeof(*data)));
+	};
+	append(&header, 1);
+	append(nodes.data(), nodes.size());
+	append(keys.data(), keys.size());
+	append(packedEmoji.data(), packedEmoji.size());
+	append(chars.constData(), chars.size());
+	return KeywordsIndex(std::move(packed));
+}
+
+bool KeywordsIndex::valid() const {
+	if (_packed.size() < int(sizeof(PackedHeader))) {
+		return false;
+	}
+	const auto &header = this->header();
+	const auto size = int64(sizeof(PackedHeader))
+		+ int64(header.nodesCount) * sizeof(PackedNode)
+		+ int64(header.keysCount) * sizeof(PackedKey)
+		+ int64(header.emojiCount) * sizeof(PackedEmoji)
+		+ int64(header.charsCount) * sizeof(QChar);
+	if (header.magic != kIndexMagic
+		|| header.format != kIndexFormat
+		|| header.version < 0
+		|| !header.nodesCount
+		|| size != _packed.size()) {
+		return false;
+	}
+	const auto goodString = [&](PackedString value) {
+		return (value.offset <= header.charsCount)
+			&& (value.length <= header.charsCount - value.offset);
+	};
+	const auto nodes = this->nodes();
+	for (auto i = quint32(); i != header.nodesCount; ++i) {
+		const auto &node = nodes[i];
+		if (node.firstChild > header.nodesCount
+			|| node.childrenCount > header.nodesCount - node.firstChild
+			|| node.keysBegin > node.keysEnd
+			|| node.keysEnd > header.keysCount
+			|| (node.exact != kNoKey && node.exact >= header.keysCount)) {
+			return false;
+		}
+	}
+	const auto keys = this->keys();
+	for (auto i = quint32(); i != header.keysCount; ++i) {
+		const auto &key = keys[i];
+		if (!goodString(key.text)
+			|| key.emojiBegin > key.emojiEnd
+			|| key.emojiEnd > header.emojiCount) {
+			return false;
+		}
+	}
+	const auto emoji = this->emoji();
+	for (auto i = quint32(); i != header.emojiCount; ++i) {
+		if (!goodString(emoji[i].text) || !goodString(emoji[i].lookup)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const PackedHeader &KeywordsIndex::header() const {
+	return *reinterpret_cast<const PackedHeader*>(_packed.constData());
+}
+
+const PackedNode *KeywordsIndex::nodes() const {
+	return reinterpret_cast<const PackedNode*>(
+		_packed.constData() + sizeof(PackedHeader));
+}
+
+const PackedKey *KeywordsIndex::keys() const {
+	return reinterpret_cast<const PackedKey*>(
+		nodes() + header().nodesCount);
+}
+
+const PackedEmoji *KeywordsIndex::emoji() const {
+	return reinterpret_cast<const PackedEmoji*>(
+		keys() + header().keysCount);
+}
+
+const QChar *KeywordsIndex::chars() const {
+	return reinterpret_cast<const QChar*>(emoji() + header().emojiCount);
+}
+
+QString KeywordsIndex::string(PackedString value) const {
+	return QString(chars() + value.offset, value.length);
+}
+
+QString KeywordsIndex::rawString(PackedString value) const {
+	return QString::fromRawData(chars() + value.offset, value.length);
+}
+
+int KeywordsIndex::version() const {
+	return _packed.isEmpty() ? 0 : header().version;
+}
+
+int KeywordsIndex::maxKeyLength() const {
+	return _packed.isEmpty() ? 0 : header().maxKeyLength;
+}
+
+bool KeywordsIndex::empty() const {
+	return _packed.isEmpty() || !header().keysCount;
+}
+
+const QByteArray &KeywordsIndex::packed() const {
+	return _packed;
+}
+
+void KeywordsIndex::resetVersion() {
+	if (!_packed.isEmpty()) {
+		reinterpret_cast<PackedHeader*>(_packed.data())->version = 0;
+	}
+}
+
+KeywordsMap KeywordsIndex::unpack() const {
+	auto result = KeywordsMap();
+	if (empty()) {
+		return result;
+	}
+	const auto keys = this->keys();
+	const auto emoji = this->emoji();
+	for (auto i = quint32(); i != header().keysCount; ++i) {
+		const auto &key = keys[i];
+		auto &list = result[string(key.text)];
+		for (auto j = key.emojiBegin; j != key.emojiEnd; ++j) {
+			auto entry = ResolveEmoji(string(emoji[j].text));
+			if (entry.emoji) {
+				list.push_back(std::move(entry));
+			}
+		}
+	}
+	return result;
+}
+
+void KeywordsIndex::query(
+		std::vector<Result> &result,
+		const QString &normalized,
+		bool exact) const {
+	if (empty()) {
+		return;
+	}
+	const auto nodes = this->nodes();
+	auto node = nodes;
+	for (const auto ch : normalized) {
+		const auto from = nodes + node->firstChild;
+		const auto till = from + node->childrenCount;
+		const auto i = std::lower_bound(
+			from,
+			till,
+			quint32(ch.unicode()),
+			[](const PackedNode &node, quint32 ch) { return node.ch < ch; });
+		if (i == till || i->ch != ch.unicode()) {
+			return;
+		}
+		node = i;
+	}
+	const auto keys = this->keys();
+	if (exact) {
+		if (node->exact != kNoKey) {
+			appendKey(result, keys[node->exact]);
+		}
 	} else {
-		auto &&lengths = ranges::views::all(
-			data.emoji
-		) | ranges::views::transform([](auto &&pair) {
-			return pair.first.size();
-		});
-		data.maxKeyLength = *ranges::max_element(lengths);
+		for (auto i = node->keysBegin; i != node->keysEnd; ++i) {
+			appendKey(result, keys[i]);
+		}
+	}
+}
+
+void KeywordsIndex::appendKey(
+		std::vector<Result> &result,
+		const PackedKey &key) const {
+	// Skip the emoji that were already found for the previous keywords.
+	const auto already = int(result.size());
+	const auto emoji = this->emoji();
+	auto label = QString();
+	for (auto i = key.emojiBegin; i != key.emojiEnd; ++i) {
+		const auto found = FindExact(rawString(emoji[i].lookup));
+		if (!found) {
+			continue;
+		}
+		const auto till = begin(result) + already;
+		if (ranges::find(begin(result), till, found, &Result::emoji) != till) {
+			continue;
+		}
+		if (label.isEmpty()) {
+			label = string(key.text);
+		}
+		result.push_back({ found, label, string(emoji[i].text) });
 	}
 }
 
@@ -331,12 +679,12 @@ private:
 
 	void readLocalCache();
 	void applyDifference(const MTPEmojiKeywordsDifference &result);
-	void applyData(LangPackData &&data);
+	void applyData(KeywordsIndex &&data);
 
 	not_null<Delegate*> _delegate;
 	QString _id;
 	State _state = State::ReadingCache;
-	LangPackData _data;
+	KeywordsIndex _data;
 	crl::time _lastRefreshTime = 0;
 	mtpRequestId _requestId = 0;
 	base::binary_guard _guard;
@@ -362,7 +710,7 @@ EmojiKeywords::LangPack::~LangPack() {
 void EmojiKeywords::LangPack::readLocalCache() {
 	const auto id = _id;
 	auto callback = crl::guard(_guard.make_guard(), [=](
-			LangPackData &&result) {
+			KeywordsIndex &&result) {
 		applyData(std::move(result));
 		refresh();
 	});
@@ -405,10 +753,10 @@ void EmojiKeywords::LangPack::refresh() {
 			_lastRefreshTime = crl::now();
 		}).send();
 	};
-	_requestId = (_data.version > 0)
+	_requestId = (_data.version() > 0)
 		? send(MTPmessages_GetEmojiKeywordsDifference(
 			MTP_string(_id),
-			MTP_int(_data.version)))
+			MTP_int(_data.version())))
 		: send(MTPmessages_GetEmojiKeywords(
 			MTP_string(_id)));
 }
@@ -423,17 +771,17 @@ void EmojiKeywords::LangPack::applyDifference(
 			LOG(("API Error: Bad lang_code for emoji keywords %1 -> %2").arg(
 				_id,
 				code));
-			_data.version = 0;
+			_data.resetVersion();
 			_state = State::Refreshed;
 			return;
-		} else if (keywords.isEmpty() && _data.version >= version) {
+		} else if (keywords.isEmpty() && _data.version() >= version) {
 			_state = State::Refreshed;
 			return;
 		}
 		const auto id = _id;
 		auto copy = _data;
 		auto callback = crl::guard(_guard.make_guard(), [=](
-				LangPackData &&result) {
+				KeywordsIndex &&result) {
 			applyData(std::move(result));
 		});
 		crl::async([=,
@@ -451,7 +799,7 @@ void EmojiKeywords::LangPack::applyDifference(
 	});
 }
 
-void EmojiKeywords::LangPack::applyData(LangPackData &&data) {
+void EmojiKeywords::LangPack::applyData(KeywordsIndex &&data) {
 	_data = std::move(data);
 	_state = State::Refreshed;
 	_delegate->langPackRefreshed();
@@ -470,30 +818,18 @@ void EmojiKeywords::LangPack::apiChanged() {
 std::vector<Result> EmojiKeywords::LangPack::query(
 		const QString &normalized,
 		bool exact) const {
-	if (normalized.size() > _data.maxKeyLength
-		|| _data.emoji.empty()
+	if (normalized.size() > _data.maxKeyLength()
+		|| _data.empty()
 		|| (exact && SkipExactKeyword(_id, normalized))) {
 		return {};
 	}
-
-	const auto from = _data.emoji.lower_bound(normalized);
-	auto &&chosen = ranges::make_subrange(
-		from,
-		end(_data.emoji)
-	) | ranges::views::take_while([&](const auto &pair) {
-		const auto &key = pair.first;
-		return exact ? (key == normalized) : key.startsWith(normalized);
-	});
-
 	auto result = std::vector<Result>();
-	for (const auto &[key, list] : chosen) {
-		AppendFoundEmoji(result, key, list);
-	}
+	_data.query(result, normalized, exact);
 	return result;
 }
 
 int EmojiKeywords::LangPack::maxQueryLength() const {
-	return _data.maxKeyLength;
+	return _data.maxKeyLength();
 }
 
 EmojiKeywords::EmojiKeywords() {
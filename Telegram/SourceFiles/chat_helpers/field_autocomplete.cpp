@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_peer_values.h"
 #include "data/data_file_origin.h"
 #include "data/data_session.h"
+#include "data/data_changes.h"
 #include "data/stickers/data_stickers.h"
 #include "chat_helpers/send_context_menu.h" // SendMenu::FillSendMenu
 #include "chat_helpers/stickers_lottie.h"
@@ -173,6 +174,18 @@ FieldAutocomplete::FieldAutocomplete(
 	) | rpl::start_with_next(crl::guard(_inner, [=] {
 		_inner->onParentGeometryChanged();
 	}), lifetime());
+
+	using PeerUpdateFlag = Data::PeerUpdate::Flag;
+	_controller->session().changes().peerUpdates(
+		PeerUpdateFlag::Members
+		| PeerUpdateFlag::Name
+		| PeerUpdateFlag::Username
+	) | rpl::start_with_next([=](const Data::PeerUpdate &update) {
+		if (update.peer == _mentionCandidatesPeer
+			|| update.peer->isUser()) {
+			_mentionCandidatesPeer = nullptr;
+		}
+	}, lifetime());
 }
 
 not_null<Window::SessionController*> FieldAutocomplete::controller() const {
@@ -380,14 +393,20 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 			}
 			return true;
 		};
-		auto filterNotPassedByName = [&](UserData *user) -> bool {
+		const auto matchesPrefix = [&](not_null<UserData*> user) {
+			if (user->username.startsWith(_filter, Qt::CaseInsensitive)) {
+				return true;
+			}
 			for (const auto &nameWord : user->nameWords()) {
 				if (nameWord.startsWith(_filter, Qt::CaseInsensitive)) {
-					auto exactUsername = (user->username.compare(_filter, Qt::CaseInsensitive) == 0);
-					return exactUsername;
+					return true;
 				}
 			}
-			return filterNotPassedByUsername(user);
+			return false;
+		};
+		const auto exactUsername = [&](not_null<UserData*> user) {
+			return !_filter.isEmpty()
+				&& !user->username.compare(_filter, Qt::CaseInsensitive);
 		};
 
 		bool listAllSuggestions = _filter.isEmpty();
@@ -402,46 +421,79 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 				++recentInlineBots;
 			}
 		}
-		if (_chat) {
+
+		// Prefix matches only lose members when more letters are typed,
+		// so the previous candidates are narrowed down instead of a rescan.
+		const auto peer = _chat
+			? static_cast<PeerData*>(_chat)
+			: (_channel && _channel->isMegagroup())
+			? static_cast<PeerData*>(_channel)
+			: nullptr;
+		const auto narrow = peer
+			&& (_mentionCandidatesPeer == peer)
+			&& _filter.startsWith(
+				_mentionCandidatesFilter,
+				Qt::CaseInsensitive);
+		const auto passes = [&](not_null<UserData*> user) {
+			return !user->isInaccessible()
+				&& (listAllSuggestions || matchesPrefix(user));
+		};
+		_mentionCandidatesFilter = _filter;
+		if (!narrow) {
+			_mentionCandidates.clear();
+			_mentionCandidatesPeer = peer;
+		}
+		if (narrow) {
+			_mentionCandidates.erase(
+				ranges::remove_if(_mentionCandidates, [&](
+						not_null<UserData*> user) {
+					return !matchesPrefix(user);
+				}),
+				end(_mentionCandidates));
+		} else if (_chat) {
 			auto sorted = base::flat_multi_map<TimeId, not_null<UserData*>>();
 			const auto byOnline = [&](not_null<UserData*> user) {
 				return Data::SortByOnlineValue(user, now);
 			};
-			mrows.reserve(mrows.size() + (_chat->participants.empty() ? _chat->lastAuthors.size() : _chat->participants.size()));
+			_mentionCandidates.reserve(_chat->participants.empty() ? _chat->lastAuthors.size() : _chat->participants.size());
 			if (_chat->noParticipantInfo()) {
 				_chat->session().api().requestFullPeer(_chat);
+				_mentionCandidatesPeer = nullptr;
 			} else if (!_chat->participants.empty()) {
 				for (const auto &user : _chat->participants) {
-					if (user->isInaccessible()) continue;
-					if (!listAllSuggestions && filterNotPassedByName(user)) continue;
-					if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
-					sorted.emplace(byOnline(user), user);
+					if (passes(user)) {
+						sorted.emplace(byOnline(user), user);
+					}
 				}
 			}
 			for (const auto user : _chat->lastAuthors) {
-				if (user->isInaccessible()) continue;
-				if (!listAllSuggestions && filterNotPassedByName(user)) continue;
-				if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
-				mrows.push_back({ user });
-				sorted.remove(byOnline(user), user);
+				if (passes(user)) {
+					_mentionCandidates.push_back(user);
+					sorted.remove(byOnline(user), user);
+				}
 			}
 			for (auto i = sorted.cend(), b = sorted.cbegin(); i != b;) {
 				--i;
-				mrows.push_back({ i->second });
+				_mentionCandidates.push_back(i->second);
 			}
 		} else if (_channel && _channel->isMegagroup()) {
 			if (_channel->lastParticipantsRequestNeeded()) {
 				_channel->session().api().requestLastParticipants(_channel);
+				_mentionCandidatesPeer = nullptr;
 			} else {
-				mrows.reserve(mrows.size() + _channel->mgInfo->lastParticipants.size());
+				_mentionCandidates.reserve(_channel->mgInfo->lastParticipants.size());
 				for (const auto user : _channel->mgInfo->lastParticipants) {
-					if (user->isInaccessible()) continue;
-					if (!listAllSuggestions && filterNotPassedByName(user)) continue;
-					if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
-					mrows.push_back({ user });
+					if (passes(user)) {
+						_mentionCandidates.push_back(user);
+					}
 				}
 			}
 		}
+		for (const auto user : _mentionCandidates) {
+			if (exactUsername(user)) continue;
+			if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
+			mrows.push_back({ user });
+		}
 	} else if (_type == Type::Hashtags) {
 		bool listAllSuggestions = _filter.isEmpty();
 		auto &recent(cRecentWriteHashtags());
@@ -863,9 +915,10 @@ void FieldAutocomplete::Inner::paintEvent(QPaintEvent *e) {
 					p.drawImage(
 						QRect(ppos, size),
 						frame);
-					const auto paused = _controller->isGifPausedAtLeastFor(
+					const auto allowed = _controller->animationFrameAllowed(
+						sticker.animated.get(),
 						Window::GifPauseReason::SavedGifs);
-					if (!paused) {
+					if (allowed) {
 						sticker.animated->markFrameShown();
 					}
 				} else if (const auto image = media->getStickerSmall()) {
@@ -1258,7 +1311,7 @@ auto FieldAutocomplete::Inner::getLottieRenderer()
 	if (auto result = _lottieRenderer.lock()) {
 		return result;
 	}
-	auto result = Lottie::MakeFrameRenderer();
+	auto result = ChatHelpers::LottieRenderer();
 	_lottieRenderer = result;
 	return result;
 }
@@ -185,6 +185,11 @@ private:
 	uint64 _stickersSeed = 0;
 	Type _type = Type::Mentions;
 	QString _filter;
+
+	// Members matching _mentionCandidatesFilter by prefix in display order.
+	std::vector<not_null<UserData*>> _mentionCandidates;
+	QString _mentionCandidatesFilter;
+	PeerData *_mentionCandidatesPeer = nullptr;
 	QRect _boundings;
 	bool _addInlineBots;
 
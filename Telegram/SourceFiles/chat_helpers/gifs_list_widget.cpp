@@ -267,8 +267,11 @@ void GifsListWidget::cancelGifsSearch() {
 	}
 	_inlineRequestTimer.stop();
 	_inlineQuery = _inlineNextQuery = _inlineNextOffset = QString();
-	_inlineCache.clear();
-	refreshInlineRows(nullptr, true);
+
+	// Keep the results, so that searching the same query again, like
+	// after reopening the panel, shows them without a request.
+	refreshInlineRows(nullptr, false);
+	removeExpiredInlineCache();
 }
 
 void GifsListWidget::inlineResultsDone(const MTPmessages_BotResults &result) {
@@ -288,6 +291,8 @@ void GifsListWidget::inlineResultsDone(const MTPmessages_BotResults &result) {
 			it = _inlineCache.emplace(
 				_inlineQuery,
 				std::make_unique<InlineCacheEntry>()).first;
+			it->second->expires = crl::now()
+				+ d.vcache_time().v * crl::time(1000);
 		}
 		const auto entry = it->second.get();
 		entry->nextOffset = qs(d.vnext_offset().value_or_empty());
@@ -676,6 +681,34 @@ int GifsListWidget::refreshInlineRows(const InlineCacheEntry *entry, bool result
 	return added;
 }
 
+bool GifsListWidget::hasInlineCacheEntry(const QString &query) {
+	const auto i = _inlineCache.find(query);
+	if (i == end(_inlineCache)) {
+		return false;
+	} else if (query == _inlineQuery || i->second->expires > crl::now()) {
+		return true;
+	}
+	for (const auto &result : i->second->results) {
+		_inlineLayouts.erase(result.get());
+	}
+	_inlineCache.erase(i);
+	return false;
+}
+
+void GifsListWidget::removeExpiredInlineCache() {
+	const auto now = crl::now();
+	for (auto i = begin(_inlineCache); i != end(_inlineCache);) {
+		if (i->first == _inlineQuery || i->second->expires > now) {
+			++i;
+			continue;
+		}
+		for (const auto &result : i->second->results) {
+			_inlineLayouts.erase(result.get());
+		}
+		i = _inlineCache.erase(i);
+	}
+}
+
 int GifsListWidget::validateExistingInlineRows(const InlineResults &results) {
 	const auto until = _mosaic.validateExistingRows([&](
 			not_null<const LayoutItem*> item,
@@ -783,7 +816,7 @@ void GifsListWidget::searchForGifs(const QString &query) {
 			_api.request(_inlineRequestId).cancel();
 			_inlineRequestId = 0;
 		}
-		if (_inlineCache.find(query) != _inlineCache.cend()) {
+		if (hasInlineCacheEntry(query)) {
 			_inlineRequestTimer.stop();
 			_inlineQuery = _inlineNextQuery = query;
 			showInlineRows(true);
@@ -116,6 +116,7 @@ private:
 	struct InlineCacheEntry {
 		QString nextOffset;
 		InlineResults results;
+		crl::time expires = 0; // From the cache_time of the first page.
 	};
 
 	void clearHeavyData();
@@ -157,6 +158,8 @@ private:
 	void deleteUnusedGifLayouts();
 
 	void deleteUnusedInlineLayouts();
+	[[nodiscard]] bool hasInlineCacheEntry(const QString &query);
+	void removeExpiredInlineCache();
 
 	int validateExistingInlineRows(const InlineResults &results);
 	void selectInlineResult(
@@ -32,6 +32,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "styles/style_chat.h"
 #include "base/qt_adapters.h"
 
+#ifndef TDESKTOP_DISABLE_SPELLCHECK
+#include "chat_helpers/spellchecker_common.h"
+#endif // TDESKTOP_DISABLE_SPELLCHECK
+
 #include <QtCore/QMimeData>
 #include <QtCore/QStack>
 #include <QtGui/QGuiApplication>
@@ -47,6 +51,7 @@ using EditLinkAction = Ui::InputField::EditLinkAction;
 using EditLinkSelection = Ui::InputField::EditLinkSelection;
 
 constexpr auto kParseLinksTimeout = crl::time(1000);
+constexpr auto kParseLinksMaxTimeout = 3 * crl::time(1000);
 
 // For mention tags save and validate userId, ignore tags for different userId.
 class FieldTagMimeProcessor : public Ui::InputField::TagMimeProcessor {
@@ -327,6 +332,13 @@ void InitSpellchecker(
 			}
 		});
 	field->setExtendedContextMenu(s->contextMenuCreated());
+
+	if (!field->getLastText().isEmpty()) {
+		Spellchecker::RequestDictionaries();
+	}
+	QObject::connect(field.get(), &Ui::InputField::changed, [] {
+		Spellchecker::RequestDictionaries();
+	});
 #endif // TDESKTOP_DISABLE_SPELLCHECK
 }
 
@@ -493,10 +505,21 @@ MessageLinksParser::MessageLinksParser(not_null<Ui::InputField*> field)
 , _timer([=] { parse(); }) {
 	_connection = QObject::connect(_field, &Ui::InputField::changed, [=] {
 		const auto length = _field->getTextWithTags().text.size();
+		const auto now = crl::now();
+		if (!_timer.isActive()) {
+			_changesStarted = now;
+		}
+
+		// While the user keeps typing we wait for a pause, so that we
+		// don't request previews for each prefix of a typed link.
+		// Pasted text is parsed right away.
 		const auto timeout = (std::abs(length - _lastLength) > 2)
 			? 0
-			: kParseLinksTimeout;
-		if (!_timer.isActive() || timeout < _timer.remainingTime()) {
+			: std::clamp(
+				_changesStarted + kParseLinksMaxTimeout - now,
+				crl::time(0),
+				kParseLinksTimeout);
+		if (!_timer.isActive() || _timer.remainingTime() > 0) {
 			_timer.callOnce(timeout);
 		}
 		_lastLength = length;
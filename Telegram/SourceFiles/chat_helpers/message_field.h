@@ -99,6 +99,7 @@ private:
 	not_null<Ui::InputField*> _field;
 	rpl::variable<QStringList> _list;
 	int _lastLength = 0;
+	crl::time _changesStarted = 0;
 	base::Timer _timer;
 	base::qt_connection _connection;
 
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #ifndef TDESKTOP_DISABLE_SPELLCHECK
 
 #include "base/platform/base_platform_info.h"
+#include "base/timer.h"
 #include "base/zlib_help.h"
 #include "data/data_session.h"
 #include "lang/lang_instance.h"
@@ -45,6 +46,8 @@ constexpr auto kLangsForLWC = { 31, 91 };
 // 225 - QLocale::UnitesStates, 30 - QLocale::Brazil.
 constexpr auto kDefaultCountries = { 225, 30 };
 
+constexpr auto kUnloadDictionariesTimeout = 15 * 60 * crl::time(1000);
+
 // Language With Country.
 inline auto LWC(QLocale::Country country) {
 	const auto l = QLocale::matchingLocales(
@@ -190,6 +193,50 @@ void AddExceptions() {
 	ranges::for_each(exceptions, Platform::Spellchecker::AddWord);
 }
 
+void AddExceptionsAsync() {
+	// Hunspell lookups are guarded inside the engine and may take a while
+	// right after the dictionaries were (re)loaded, keep them off main.
+	crl::async(AddExceptions);
+}
+
+// Hunspell dictionaries take a lot of time and memory to load, so they
+// are loaded only when some spellchecked field is used and unloaded
+// after a long time without any use.
+struct LazyDictionaries {
+	std::vector<int> languages;
+	std::unique_ptr<base::Timer> unloadTimer;
+	crl::time lastUsed = 0;
+	bool lazy = false;
+	bool loaded = false;
+};
+
+LazyDictionaries Lazy;
+
+void ApplyLanguages() {
+	Platform::Spellchecker::UpdateLanguages(Lazy.languages);
+	Lazy.loaded = !Lazy.languages.empty();
+}
+
+void CheckUnloadDictionaries() {
+	if (!Lazy.loaded) {
+		return;
+	}
+	const auto passed = crl::now() - Lazy.lastUsed;
+	if (passed < kUnloadDictionariesTimeout) {
+		Lazy.unloadTimer->callOnce(kUnloadDictionariesTimeout - passed);
+		return;
+	}
+	Platform::Spellchecker::UpdateLanguages({});
+	Lazy.loaded = false;
+}
+
+void RequestLanguages(std::vector<int> languages) {
+	Lazy.languages = std::move(languages);
+	if (!Lazy.lazy || Lazy.loaded || Lazy.languages.empty()) {
+		ApplyLanguages();
+	}
+}
+
 } // namespace
 
 DictLoaderPtr GlobalLoader() {
@@ -313,11 +360,28 @@ bool WriteDefaultDictionary() {
 	return false;
 }
 
+void RequestDictionaries() {
+	if (!Lazy.lazy) {
+		return;
+	}
+	Lazy.lastUsed = crl::now();
+	if (Lazy.loaded || Lazy.languages.empty()) {
+		return;
+	}
+	ApplyLanguages();
+	if (!Lazy.unloadTimer) {
+		Lazy.unloadTimer = std::make_unique<base::Timer>(
+			CheckUnloadDictionaries);
+	}
+	Lazy.unloadTimer->callOnce(kUnloadDictionariesTimeout);
+}
+
 rpl::producer<QString> ButtonManageDictsState(
 		not_null<Main::Session*> session) {
 	if (Platform::Spellchecker::IsSystemSpellchecker()) {
 		return rpl::single(QString());
 	}
+	RequestDictionaries();
 	const auto computeString = [=] {
 		if (!Core::App().settings().spellcheckerEnabled()) {
 			return QString();
@@ -382,11 +446,11 @@ void Start(not_null<Main::Session*> session) {
 	auto &lifetime = session->lifetime();
 
 	const auto onEnabled = [=](auto enabled) {
-		Platform::Spellchecker::UpdateLanguages(
-			enabled
-				? settings->dictionariesEnabled()
-				: std::vector<int>());
+		RequestLanguages(enabled
+			? settings->dictionariesEnabled()
+			: std::vector<int>());
 	};
+	Lazy.lazy = !Platform::Spellchecker::IsSystemSpellchecker();
 
 	const auto guard = gsl::finally([=] {
 		onEnabled(settings->spellcheckerEnabled());
@@ -401,13 +465,13 @@ void Start(not_null<Main::Session*> session) {
 	}
 
 	Spellchecker::SupportedScriptsChanged(
-	) | rpl::start_with_next(AddExceptions, lifetime);
+	) | rpl::start_with_next(AddExceptionsAsync, lifetime);
 
 	Spellchecker::SetWorkingDirPath(DictionariesPath());
 
 	settings->dictionariesEnabledChanges(
 	) | rpl::start_with_next([](auto dictionaries) {
-		Platform::Spellchecker::UpdateLanguages(dictionaries);
+		RequestLanguages(std::move(dictionaries));
 	}, lifetime);
 
 	settings->spellcheckerEnabledChanges(
@@ -35,6 +35,10 @@ bool WriteDefaultDictionary();
 std::vector<Dict> Dictionaries();
 
 void Start(not_null<Main::Session*> session);
+
+// Loads the enabled Hunspell dictionaries if they were not loaded yet or
+// were unloaded after a long time without use.
+void RequestDictionaries();
 [[nodiscard]] rpl::producer<QString> ButtonManageDictsState(
 	not_null<Main::Session*> session);
 
@@ -9,7 +9,21 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "styles/style_chat.h"
 
+#include <QtCore/QDir>
+
 namespace Stickers {
+namespace {
+
+[[nodiscard]] QString CacheBaseFolder() {
+	return cWorkingDir() + u"tdata/emoji_large/"_q;
+}
+
+[[nodiscard]] QSize PreparedSize() {
+	const auto side = st::largeEmojiSize + 2 * st::largeEmojiOutline;
+	return QSize(side, side) * cIntRetinaFactor();
+}
+
+} // namespace
 
 EmojiImageLoader::EmojiImageLoader(crl::weak_on_queue<EmojiImageLoader> weak)
 : _weak(std::move(weak)) {
@@ -21,12 +35,49 @@ void EmojiImageLoader::init(
 	Expects(images != nullptr);
 
 	_images = std::move(images);
+	refreshCacheFolder();
 	if (largeEnabled) {
 		_images->ensureLoaded();
 	}
 }
 
+void EmojiImageLoader::refreshCacheFolder() {
+	const auto name = QString::number(_images->id())
+		+ '_'
+		+ QString::number(PreparedSize().width());
+	const auto folder = CacheBaseFolder() + name + '/';
+	if (folder == _cacheFolder) {
+		return;
+	}
+	_cacheFolder = folder;
+
+	// Only the current emoji set and scale are worth keeping on disk.
+	auto base = QDir(CacheBaseFolder());
+	const auto stale = base.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+	for (const auto &entry : stale) {
+		if (entry != name) {
+			QDir(base.filePath(entry)).removeRecursively();
+		}
+	}
+	QDir().mkpath(_cacheFolder);
+}
+
 QImage EmojiImageLoader::prepare(EmojiPtr emoji) const {
+	const auto path = _cacheFolder
+		+ QString::fromLatin1(emoji->id().toUtf8().toHex())
+		+ u".png"_q;
+	auto cached = QImage(path);
+	if (cached.size() == PreparedSize()) {
+		return cached.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+	}
+	auto result = render(emoji);
+	if (!result.isNull() && _images->ensureLoaded()) {
+		result.save(path, "PNG");
+	}
+	return result;
+}
+
+QImage EmojiImageLoader::render(EmojiPtr emoji) const {
 	const auto loaded = _images->ensureLoaded();
 	const auto factor = cIntRetinaFactor();
 	const auto side = st::largeEmojiSize + 2 * st::largeEmojiOutline;
@@ -86,6 +137,7 @@ QImage EmojiImageLoader::prepare(EmojiPtr emoji) const {
 
 void EmojiImageLoader::switchTo(std::shared_ptr<UniversalImages> images) {
 	_images = std::move(images);
+	refreshCacheFolder();
 }
 
 auto EmojiImageLoader::releaseImages() -> std::shared_ptr<UniversalImages> {
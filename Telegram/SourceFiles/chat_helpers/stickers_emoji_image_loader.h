@@ -26,8 +26,12 @@ public:
 	std::shared_ptr<UniversalImages> releaseImages();
 
 private:
+	[[nodiscard]] QImage render(EmojiPtr emoji) const;
+	void refreshCacheFolder();
+
 	crl::weak_on_queue<EmojiImageLoader> _weak;
 	std::shared_ptr<UniversalImages> _images;
+	QString _cacheFolder;
 
 };
 
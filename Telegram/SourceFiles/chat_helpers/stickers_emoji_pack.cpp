@@ -29,6 +29,7 @@ namespace Stickers {
 namespace {
 
 constexpr auto kRefreshTimeout = 7200 * crl::time(1000);
+constexpr auto kRecentImagesLimit = 64;
 
 [[nodiscard]] std::optional<int> IndexFromEmoticon(const QString &emoticon) {
 	if (emoticon.size() < 2) {
@@ -134,6 +135,7 @@ EmojiPack::EmojiPack(not_null<Main::Session*> session)
 	Ui::Emoji::Updated(
 	) | rpl::start_with_next([=] {
 		_images.clear();
+		_recentImages.clear();
 		refreshAll();
 	}, _lifetime);
 }
@@ -189,10 +191,12 @@ std::shared_ptr<LargeEmojiImage> EmojiPack::image(EmojiPtr emoji) {
 		emoji,
 		std::weak_ptr<LargeEmojiImage>()).first;
 	if (const auto result = i->second.lock()) {
+		rememberRecent(result);
 		return result;
 	}
 	auto result = std::make_shared<LargeEmojiImage>();
 	const auto raw = result.get();
+	raw->emoji = emoji;
 	const auto weak = base::make_weak(_session.get());
 	raw->load = [=] {
 		Core::App().emojiImageLoader().with([=](
@@ -216,9 +220,24 @@ std::shared_ptr<LargeEmojiImage> EmojiPack::image(EmojiPtr emoji) {
 		raw->load = nullptr;
 	};
 	i->second = result;
+	rememberRecent(result);
 	return result;
 }
 
+void EmojiPack::rememberRecent(
+		const std::shared_ptr<LargeEmojiImage> &image) {
+	// Keep recently shown images alive so that scrolling back and forth
+	// through emoji-only messages doesn't prepare them again.
+	const auto i = ranges::find(_recentImages, image);
+	if (i != end(_recentImages)) {
+		std::rotate(i, i + 1, end(_recentImages));
+		return;
+	} else if (_recentImages.size() >= kRecentImagesLimit) {
+		_recentImages.erase(begin(_recentImages));
+	}
+	_recentImages.push_back(image);
+}
+
 auto EmojiPack::animationsForEmoji(EmojiPtr emoji) const
 -> const base::flat_map<int, not_null<DocumentData*>> & {
 	static const auto empty = base::flat_map<int, not_null<DocumentData*>>();
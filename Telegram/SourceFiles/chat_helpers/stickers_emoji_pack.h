@@ -38,6 +38,7 @@ namespace Stickers {
 using IsolatedEmoji = Ui::Text::IsolatedEmoji;
 
 struct LargeEmojiImage {
+	EmojiPtr emoji = nullptr;
 	std::optional<Image> image;
 	FnMut<void()> load;
 
@@ -89,6 +90,7 @@ private:
 	void refreshAll();
 	void refreshItems(EmojiPtr emoji);
 	void refreshItems(const base::flat_set<not_null<HistoryItem*>> &list);
+	void rememberRecent(const std::shared_ptr<LargeEmojiImage> &image);
 
 	not_null<Main::Session*> _session;
 	base::flat_map<EmojiPtr, not_null<DocumentData*>> _map;
@@ -96,6 +98,7 @@ private:
 		IsolatedEmoji,
 		base::flat_set<not_null<HistoryItem*>>> _items;
 	base::flat_map<EmojiPtr, std::weak_ptr<LargeEmojiImage>> _images;
+	std::vector<std::shared_ptr<LargeEmojiImage>> _recentImages;
 	mtpRequestId _requestId = 0;
 
 	base::flat_map<
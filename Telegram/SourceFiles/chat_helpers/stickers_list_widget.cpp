@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_changes.h"
 #include "chat_helpers/send_context_menu.h" // SendMenu::FillSendMenu
 #include "chat_helpers/stickers_lottie.h"
+#include "core/paint_benchmark.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "ui/effects/animations.h"
@@ -869,9 +870,10 @@ void StickersListWidget::Footer::paintSetIcon(
 					size.width(),
 					size.height()),
 				frame);
-			const auto paused = _pan->controller()->isGifPausedAtLeastFor(
+			const auto allowed = _pan->controller()->animationFrameAllowed(
+				icon.lottie.get(),
 				Window::GifPauseReason::SavedGifs);
-			if (!paused) {
+			if (allowed) {
 				icon.lottie->markFrameShown();
 			}
 		}
@@ -924,6 +926,7 @@ StickersListWidget::StickersListWidget(
 	bool masks)
 : Inner(parent, controller)
 , _api(&controller->session().mtp())
+, _lottieWarmup(&controller->session(), StickerLottieSize::StickersPanel)
 , _section(Section::Stickers)
 , _isMasks(masks)
 , _pathGradient(std::make_unique<Ui::PathShiftGradient>(
@@ -1576,6 +1579,9 @@ QRect StickersListWidget::stickerRect(int section, int sel) {
 }
 
 void StickersListWidget::paintEvent(QPaintEvent *e) {
+	const auto measure = Core::PaintBenchmark::Measure(
+		"stickers_list",
+		"paint");
 	Painter p(this);
 	auto clip = e->rect();
 	p.fillRect(clip, st::emojiPanBg);
@@ -1735,9 +1741,10 @@ void StickersListWidget::paintStickers(Painter &p, QRect clip) {
 
 void StickersListWidget::markLottieFrameShown(Set &set) {
 	if (const auto player = set.lottiePlayer.get()) {
-		const auto paused = controller()->isGifPausedAtLeastFor(
+		const auto allowed = controller()->animationFrameAllowed(
+			player,
 			Window::GifPauseReason::SavedGifs);
-		if (!paused) {
+		if (allowed) {
 			player->markFrameShown();
 		}
 	}
@@ -2524,6 +2531,29 @@ void StickersListWidget::preloadImages() {
 	if (_footer) {
 		_footer->preloadImages();
 	}
+	startLottieWarmup();
+}
+
+void StickersListWidget::startLottieWarmup() {
+	const auto box = boundingBoxSize() * cIntRetinaFactor();
+	if (_isMasks || box.isEmpty()) {
+		return;
+	}
+	// Recent and faved stickers come first in _mySets.
+	auto documents = std::vector<not_null<DocumentData*>>();
+	for (const auto &set : _mySets) {
+		for (const auto &sticker : set.stickers) {
+			const auto data = sticker.document->sticker();
+			if (data && data->animated) {
+				documents.push_back(sticker.document);
+			}
+		}
+	}
+	_lottieWarmup.start(std::move(documents), box);
+}
+
+void StickersListWidget::cancelLottieWarmup() {
+	_lottieWarmup.cancel();
 }
 
 uint64 StickersListWidget::currentSet(int yOffset) const {
@@ -2984,7 +3014,7 @@ auto StickersListWidget::getLottieRenderer()
 	if (auto result = _lottieRenderer.lock()) {
 		return result;
 	}
-	auto result = Lottie::MakeFrameRenderer();
+	auto result = LottieRenderer();
 	_lottieRenderer = result;
 	return result;
 }
@@ -3064,6 +3094,8 @@ void StickersListWidget::showMegagroupSet(ChannelData *megagroup) {
 }
 
 void StickersListWidget::afterShown() {
+	// The panel plays and caches the shown stickers itself.
+	cancelLottieWarmup();
 	if (_footer) {
 		_footer->stealFocus();
 	}
@@ -3073,6 +3105,7 @@ void StickersListWidget::beforeHiding() {
 	if (_footer) {
 		_footer->returnFocus();
 	}
+	startLottieWarmup();
 }
 
 void StickersListWidget::displaySet(uint64 setId) {
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "chat_helpers/tabbed_selector.h"
+#include "chat_helpers/stickers_lottie_warmup.h"
 #include "data/stickers/data_stickers.h"
 #include "base/variant.h"
 #include "base/timer.h"
@@ -69,6 +70,7 @@ public:
 	void beforeHiding() override;
 
 	void refreshStickers();
+	void cancelLottieWarmup();
 
 	std::vector<StickerIcon> fillIcons();
 	bool preventAutoHide();
@@ -250,6 +252,7 @@ private:
 	bool stickerHasDeleteButton(const Set &set, int index) const;
 	std::vector<Sticker> collectRecentStickers();
 	void refreshRecentStickers(bool resize = true);
+	void startLottieWarmup();
 	void refreshFavedStickers();
 	enum class GroupStickersPlace {
 		Visible,
@@ -349,6 +352,7 @@ private:
 	std::vector<bool> _custom;
 	base::flat_set<not_null<DocumentData*>> _favedStickersMap;
 	std::weak_ptr<Lottie::FrameRenderer> _lottieRenderer;
+	LottieWarmup _lottieWarmup;
 
 	mtpRequestId _officialRequestId = 0;
 	int _officialOffset = 0;
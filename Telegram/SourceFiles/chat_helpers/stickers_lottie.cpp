@@ -18,13 +18,40 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/path_shift_gradient.h"
 #include "main/main_session.h"
 
+#include <thread>
+
 namespace ChatHelpers {
 namespace {
 
 constexpr auto kDontCacheLottieAfterArea = 512 * 512;
+constexpr auto kMaxLottieRenderers = 4;
+
+[[nodiscard]] int LottieRenderersCount() {
+	const auto cores = int(std::thread::hardware_concurrency());
+	return std::clamp(cores / 2, 1, kMaxLottieRenderers);
+}
 
 } // namespace
 
+std::shared_ptr<Lottie::FrameRenderer> LottieRenderer() {
+	static auto Pool = std::vector<std::weak_ptr<Lottie::FrameRenderer>>(
+		LottieRenderersCount());
+
+	// Give out the least used renderer, creating them on demand.
+	auto result = std::shared_ptr<Lottie::FrameRenderer>();
+	for (auto &weak : Pool) {
+		auto strong = weak.lock();
+		if (!strong) {
+			strong = Lottie::MakeFrameRenderer();
+			weak = strong;
+			return strong;
+		} else if (!result || strong.use_count() < result.use_count()) {
+			result = std::move(strong);
+		}
+	}
+	return result;
+}
+
 template <typename Method>
 auto LottieCachedFromContent(
 		Method &&method,
@@ -32,20 +59,38 @@ auto LottieCachedFromContent(
 		uint8 keyShift,
 		not_null<Main::Session*> session,
 		const QByteArray &content,
-		QSize box) {
+		QSize box,
+		Fn<void(int64 written)> cachedSize = nullptr) {
 	const auto key = Storage::Cache::Key{
 		baseKey.high,
 		baseKey.low + keyShift
 	};
+	const auto weak = base::make_weak(session.get());
 	const auto get = [=](FnMut<void(QByteArray &&cached)> handler) {
-		session->data().cacheBigFile().get(
-			key,
-			std::move(handler));
+		if (!cachedSize) {
+			session->data().cacheBigFile().get(
+				key,
+				std::move(handler));
+			return;
+		}
+		auto wrapped = [=, handler = std::move(handler)](
+				QByteArray &&cached) mutable {
+			if (!cached.isEmpty()) {
+				crl::on_main(weak, [=] {
+					cachedSize(0);
+				});
+			}
+			handler(std::move(cached));
+		};
+		session->data().cacheBigFile().get(key, std::move(wrapped));
 	};
-	const auto weak = base::make_weak(session.get());
 	const auto put = [=](QByteArray &&cached) {
 		crl::on_main(weak, [=, data = std::move(cached)]() mutable {
+			const auto size = int64(data.size());
 			weak->data().cacheBigFile().put(key, std::move(data));
+			if (cachedSize) {
+				cachedSize(size);
+			}
 		});
 	};
 	return method(
@@ -129,6 +174,30 @@ not_null<Lottie::Animation*> LottieAnimationFromDocument(
 	return LottieFromDocument(method, media, uint8(sizeTag), box);
 }
 
+Lottie::Animation *LottieWarmupFromDocument(
+		not_null<Lottie::MultiPlayer*> player,
+		not_null<Data::DocumentMedia*> media,
+		StickerLottieSize sizeTag,
+		QSize box,
+		Fn<void(int64 written)> cachedSize) {
+	const auto document = media->owner();
+	const auto baseKey = document->bigFileBaseCacheKey();
+	if (!baseKey || box.width() * box.height() > kDontCacheLottieAfterArea) {
+		return nullptr;
+	}
+	const auto method = [&](auto &&...args) {
+		return player->append(std::forward<decltype(args)>(args)...);
+	};
+	return LottieCachedFromContent(
+		method,
+		baseKey,
+		uint8(sizeTag),
+		&document->session(),
+		Lottie::ReadContent(media->bytes(), document->filepath()),
+		box,
+		std::move(cachedSize)).get();
+}
+
 bool HasLottieThumbnail(
 		Data::StickersSetThumbnailView *thumb,
 		Data::DocumentMedia *media) {
@@ -50,6 +50,10 @@ enum class StickerLottieSize : uchar {
 	EmojiInteractionReserved3,
 };
 
+// Renderers are shared by all sticker panels and boxes, so that heavy
+// screens spread over a few threads without starting a thread each.
+[[nodiscard]] std::shared_ptr<Lottie::FrameRenderer> LottieRenderer();
+
 [[nodiscard]] std::unique_ptr<Lottie::SinglePlayer> LottiePlayerFromDocument(
 	not_null<Data::DocumentMedia*> media,
 	StickerLottieSize sizeTag,
@@ -69,6 +73,17 @@ enum class StickerLottieSize : uchar {
 	StickerLottieSize sizeTag,
 	QSize box);
 
+// Same cache key as LottieAnimationFromDocument(), nullptr if the frames
+// of this document at this size are not cached at all. 'cachedSize' is
+// called on main thread when the frames cache is found (with zero) or
+// written (with the count of bytes written).
+[[nodiscard]] Lottie::Animation *LottieWarmupFromDocument(
+	not_null<Lottie::MultiPlayer*> player,
+	not_null<Data::DocumentMedia*> media,
+	StickerLottieSize sizeTag,
+	QSize box,
+	Fn<void(int64 written)> cachedSize);
+
 [[nodiscard]] bool HasLottieThumbnail(
 	Data::StickersSetThumbnailView *thumb,
 	Data::DocumentMedia *media);
@@ -0,0 +1,156 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "chat_helpers/stickers_lottie_warmup.h"
+
+#include "chat_helpers/stickers_lottie.h"
+#include "lottie/lottie_multi_player.h"
+#include "lottie/lottie_animation.h"
+#include "data/data_document.h"
+#include "data/data_document_media.h"
+#include "main/main_session.h"
+
+namespace ChatHelpers {
+namespace {
+
+constexpr auto kWarmupTimeout = 10 * crl::time(1000);
+constexpr auto kWarmupDiskBudget = int64(32 * 1024 * 1024);
+
+} // namespace
+
+LottieWarmup::LottieWarmup(
+	not_null<Main::Session*> session,
+	StickerLottieSize sizeTag)
+: _session(session)
+, _sizeTag(sizeTag)
+, _timeout([=] { finish(0); }) {
+}
+
+LottieWarmup::~LottieWarmup() {
+	clearCurrent();
+}
+
+void LottieWarmup::start(
+		std::vector<not_null<DocumentData*>> documents,
+		QSize box) {
+	if (_box != box) {
+		// Frames of other size are stored with other cache keys.
+		clearCurrent();
+		_warmed.clear();
+		_box = box;
+	}
+	_queue.clear();
+	for (const auto document : documents) {
+		if (document != _document && !_warmed.contains(document)) {
+			_queue.push_back(document);
+		}
+	}
+	if (!_document) {
+		next();
+	}
+}
+
+void LottieWarmup::cancel() {
+	_queue.clear();
+	clearCurrent();
+}
+
+void LottieWarmup::clearCurrent() {
+	_timeout.cancel();
+	_currentLifetime.destroy();
+	_animation = nullptr;
+	_player = nullptr;
+	_media = nullptr;
+	_document = nullptr;
+}
+
+void LottieWarmup::next() {
+	clearCurrent();
+	if (_written >= kWarmupDiskBudget) {
+		_queue.clear();
+		return;
+	}
+	while (!_queue.empty()) {
+		const auto document = _queue.front();
+		_queue.pop_front();
+		const auto sticker = document->sticker();
+		if (!sticker || !sticker->animated || _warmed.contains(document)) {
+			continue;
+		}
+		_document = document;
+		_media = document->createMediaView();
+		_media->checkStickerSmall();
+		_timeout.callOnce(kWarmupTimeout);
+		if (_media->loaded()) {
+			play();
+		} else {
+			_session->downloaderTaskFinished(
+			) | rpl::filter([=] {
+				return _media->loaded();
+			}) | rpl::take(1) | rpl::start_with_next([=] {
+				play();
+			}, _currentLifetime);
+		}
+		return;
+	}
+}
+
+void LottieWarmup::nextQueued() {
+	// We may be inside a callback of the current player.
+	crl::on_main(this, [=, document = _document] {
+		if (_document == document) {
+			next();
+		}
+	});
+}
+
+void LottieWarmup::play() {
+	Expects(_document != nullptr);
+	Expects(_media != nullptr);
+
+	_player = std::make_unique<Lottie::MultiPlayer>(
+		Lottie::Quality::Default,
+		LottieRenderer());
+	const auto document = _document;
+	_animation = LottieWarmupFromDocument(
+		_player.get(),
+		_media.get(),
+		_sizeTag,
+		_box,
+		crl::guard(this, [=](int64 written) {
+			if (_document == document) {
+				finish(written);
+			}
+		}));
+	if (!_animation) {
+		_warmed.emplace(document);
+		nextQueued();
+		return;
+	}
+	_player->updates(
+	) | rpl::start_with_next([=] {
+		// Frames are not shown, but the player should think they are,
+		// so that it renders the whole loop and writes it to the cache.
+		if (_animation->ready()) {
+			[[maybe_unused]] const auto frame = _animation->frame(
+				Lottie::FrameRequest{ _box });
+			_player->unpause(_animation);
+		}
+		_player->markFrameShown();
+	}, _currentLifetime);
+}
+
+void LottieWarmup::finish(int64 written) {
+	if (_document) {
+		_warmed.emplace(_document);
+	}
+	_written += written;
+	_timeout.cancel();
+	nextQueued();
+}
+
+} // namespace ChatHelpers
@@ -0,0 +1,69 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+#include "base/weak_ptr.h"
+
+class DocumentData;
+
+namespace Lottie {
+class MultiPlayer;
+class Animation;
+} // namespace Lottie
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace Data {
+class DocumentMedia;
+} // namespace Data
+
+namespace ChatHelpers {
+
+enum class StickerLottieSize : uchar;
+
+// Plays animated stickers offscreen one by one, so that the frames cache
+// for the given size is ready when they are shown for the first time.
+class LottieWarmup final : public base::has_weak_ptr {
+public:
+	LottieWarmup(
+		not_null<Main::Session*> session,
+		StickerLottieSize sizeTag);
+	~LottieWarmup();
+
+	// Replaces the queue, documents warmed up before are skipped.
+	void start(std::vector<not_null<DocumentData*>> documents, QSize box);
+	void cancel();
+
+private:
+	void next();
+	void nextQueued();
+	void play();
+	void finish(int64 written);
+	void clearCurrent();
+
+	const not_null<Main::Session*> _session;
+	const StickerLottieSize _sizeTag;
+	QSize _box;
+
+	std::deque<not_null<DocumentData*>> _queue;
+	base::flat_set<not_null<DocumentData*>> _warmed;
+	int64 _written = 0;
+
+	DocumentData *_document = nullptr;
+	std::shared_ptr<Data::DocumentMedia> _media;
+	std::unique_ptr<Lottie::MultiPlayer> _player;
+	Lottie::Animation *_animation = nullptr;
+	base::Timer _timeout;
+	rpl::lifetime _currentLifetime;
+
+};
+
+} // namespace ChatHelpers
@@ -33,6 +33,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "styles/style_chat_helpers.h"
 
 namespace ChatHelpers {
+namespace {
+
+constexpr auto kHiddenRefreshStickersDelay = crl::time(1000);
+
+} // namespace
 
 class TabbedSelector::SlideAnimation : public Ui::RoundShadowAnimation {
 public:
@@ -386,8 +391,14 @@ TabbedSelector::TabbedSelector(
 	}
 
 	if (hasStickersTab()) {
+		_refreshStickersTimer.setCallback([=] { refreshStickers(); });
+
 		session().data().stickers().stickerSetInstalled(
 		) | rpl::start_with_next([=](uint64 setId) {
+			if (_refreshStickersTimer.isActive()) {
+				_refreshStickersTimer.cancel();
+				refreshStickers();
+			}
 			_tabsSlider->setActiveSection(indexByType(SelectorTab::Stickers));
 			stickers()->showStickerSet(setId);
 			_showRequests.fire({});
@@ -395,7 +406,15 @@ TabbedSelector::TabbedSelector(
 
 		session().data().stickers().updated(
 		) | rpl::start_with_next([=] {
-			refreshStickers();
+			if (isHidden()) {
+				if (!_refreshStickersTimer.isActive()) {
+					_refreshStickersTimer.callOnce(
+						kHiddenRefreshStickersDelay);
+				}
+			} else {
+				_refreshStickersTimer.cancel();
+				refreshStickers();
+			}
 		}, lifetime());
 		refreshStickers();
 	}
@@ -685,6 +704,12 @@ int TabbedSelector::marginBottom() const {
 	return st::emojiFooterHeight;
 }
 
+void TabbedSelector::cancelStickersWarmup() {
+	if (hasStickersTab()) {
+		stickers()->cancelLottieWarmup();
+	}
+}
+
 void TabbedSelector::refreshStickers() {
 	if (hasStickersTab()) {
 		stickers()->refreshStickers();
@@ -760,6 +785,10 @@ void TabbedSelector::hideFinished() {
 }
 
 void TabbedSelector::showStarted() {
+	if (_refreshStickersTimer.isActive()) {
+		_refreshStickersTimer.cancel();
+		refreshStickers();
+	}
 	if (hasStickersTab()) {
 		session().api().updateStickers();
 	}
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/panel_animation.h"
 #include "mtproto/sender.h"
 #include "base/object_ptr.h"
+#include "base/timer.h"
 
 namespace InlineBots {
 struct ResultSelected;
@@ -93,6 +94,7 @@ public:
 
 	void setRoundRadius(int radius);
 	void refreshStickers();
+	void cancelStickersWarmup();
 	void setCurrentPeer(PeerData *peer);
 
 	void hideFinished();
@@ -244,6 +246,10 @@ private:
 
 	base::unique_qptr<Ui::PopupMenu> _menu;
 
+	// Sets are loaded in several requests, while we're hidden they are
+	// rebuilt once for all of them.
+	base::Timer _refreshStickersTimer;
+
 	Fn<void(SelectorTab)> _afterShownCallback;
 	Fn<void(SelectorTab)> _beforeHidingCallback;
 
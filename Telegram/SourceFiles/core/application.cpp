@@ -45,6 +45,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 #include "core/file_utilities.h"
 #include "core/crash_reports.h"
+#include "core/startup_phases.h"
+#include "core/paint_benchmark.h"
+#include "core/frame_monitor.h"
+#include "core/memory_accounting.h"
 #include "main/main_account.h"
 #include "main/main_domain.h"
 #include "main/main_session.h"
@@ -57,7 +61,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio_track.h"
 #include "media/player/media_player_instance.h"
 #include "media/player/media_player_float.h"
-#include "media/clip/media_clip_reader.h" // For Media::Clip::Finish().
+#include "media/clip/media_clip_reader.h"
+#include "media/streaming/media_streaming_reader.h"
 #include "window/notifications_manager.h"
 #include "window/themes/window_theme.h"
 #include "window/window_lock_widgets.h"
@@ -94,6 +99,7 @@ namespace {
 constexpr auto kQuitPreventTimeoutMs = crl::time(1500);
 constexpr auto kAutoLockTimeoutLateMs = crl::time(3000);
 constexpr auto kClearEmojiImageSourceTimeout = 10 * crl::time(1000);
+constexpr auto kPurgeAllocatorTimeout = 30 * crl::time(1000);
 
 void SetCrashAnnotationsGL() {
 #ifdef Q_OS_WIN
@@ -132,6 +138,7 @@ Application::Application(not_null<Launcher*> launcher)
 , _databases(std::make_unique<Storage::Databases>())
 , _animationsManager(std::make_unique<Ui::Animations::Manager>())
 , _clearEmojiImageLoaderTimer([=] { clearEmojiSourceImages(); })
+, _purgeAllocatorTimer([] { Platform::PurgeAllocatorCaches(); })
 , _audio(std::make_unique<Media::Audio::Instance>())
 , _fallbackProductionConfig(
 	std::make_unique<MTP::Config>(MTP::Environment::Production))
@@ -165,6 +172,16 @@ Application::Application(not_null<Launcher*> launcher)
 			UpdateChecker().setMtproto(session);
 		}
 	}, _lifetime);
+
+	MemoryAccounting::Register(u"Image pixmaps"_q, [] {
+		return Images::GetPixmapCacheStats().bytes;
+	});
+	MemoryAccounting::Register(u"Streaming slices"_q, [] {
+		return Media::Streaming::Reader::SlicesMemoryUsage();
+	});
+	MemoryAccounting::Register(u"Animation clip frames"_q, [] {
+		return Media::Clip::FramesMemoryUsage();
+	});
 }
 
 Application::~Application() {
@@ -172,6 +189,9 @@ Application::~Application() {
 		Local::writeSettings();
 	}
 
+	PaintBenchmark::Finish();
+	FrameMonitor::Finish();
+
 	// Depend on activeWindow() for now :(
 	Shortcuts::Finish();
 
@@ -210,6 +230,8 @@ Application::~Application() {
 }
 
 void Application::run() {
+	const auto phase = StartupPhases::Phase("application_run");
+
 	style::internal::StartFonts();
 
 	ThirdParty::start();
@@ -662,6 +684,7 @@ void Application::checkLocalTime() {
 }
 
 void Application::handleAppActivated() {
+	_purgeAllocatorTimer.cancel();
 	checkLocalTime();
 	if (_window) {
 		_window->updateIsActiveFocus();
@@ -673,6 +696,7 @@ void Application::handleAppDeactivated() {
 		_window->updateIsActiveBlur();
 	}
 	Ui::Tooltip::Hide();
+	_purgeAllocatorTimer.callOnce(kPurgeAllocatorTimeout);
 }
 
 rpl::producer<bool> Application::appDeactivatedValue() const {
@@ -332,6 +332,7 @@ private:
 	const std::unique_ptr<Ui::Animations::Manager> _animationsManager;
 	crl::object_on_queue<Stickers::EmojiImageLoader> _emojiImageLoader;
 	base::Timer _clearEmojiImageLoaderTimer;
+	base::Timer _purgeAllocatorTimer;
 	const std::unique_ptr<Media::Audio::Instance> _audio;
 	mutable std::unique_ptr<MTP::Config> _fallbackProductionConfig;
 
@@ -0,0 +1,85 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/coalesced_dispatcher.h"
+
+#include <QtCore/QMutex>
+
+namespace Core {
+
+struct CoalescedDispatcher::State {
+	void flush();
+
+	QString name;
+	mutable QMutex mutex;
+	base::flat_map<uint64, Fn<void()>> pending;
+	base::flat_map<uint64, KeyStats> stats;
+	bool scheduled = false;
+};
+
+void CoalescedDispatcher::State::flush() {
+	auto callbacks = base::flat_map<uint64, Fn<void()>>();
+	{
+		QMutexLocker lock(&mutex);
+		scheduled = false;
+		callbacks = base::take(pending);
+		for (const auto &[key, callback] : callbacks) {
+			++stats[key].called;
+		}
+	}
+	for (const auto &[key, callback] : callbacks) {
+		callback();
+	}
+}
+
+CoalescedDispatcher::CoalescedDispatcher(QString name)
+: _state(std::make_shared<State>()) {
+	_state->name = std::move(name);
+}
+
+CoalescedDispatcher::~CoalescedDispatcher() {
+	for (const auto &entry : stats()) {
+		DEBUG_LOG(("Coalesced: %1 key %2, posted %3, called %4."
+			).arg(_state->name
+			).arg(entry.key
+			).arg(entry.posted
+			).arg(entry.called));
+	}
+}
+
+void CoalescedDispatcher::post(uint64 key, Fn<void()> callback) {
+	Expects(callback != nullptr);
+
+	{
+		QMutexLocker lock(&_state->mutex);
+		_state->pending[key] = std::move(callback);
+		auto &stats = _state->stats[key];
+		stats.key = key;
+		++stats.posted;
+		if (_state->scheduled) {
+			return;
+		}
+		_state->scheduled = true;
+	}
+	crl::on_main([weak = std::weak_ptr<State>(_state)] {
+		if (const auto strong = weak.lock()) {
+			strong->flush();
+		}
+	});
+}
+
+auto CoalescedDispatcher::stats() const -> std::vector<KeyStats> {
+	auto result = std::vector<KeyStats>();
+	QMutexLocker lock(&_state->mutex);
+	result.reserve(_state->stats.size());
+	for (const auto &[key, stats] : _state->stats) {
+		result.push_back(stats);
+	}
+	return result;
+}
+
+} // namespace Core
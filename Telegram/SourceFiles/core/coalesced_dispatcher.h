@@ -0,0 +1,39 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+
+// Callbacks may be posted from any thread. Callbacks with the same key
+// replace each other until they're called, so only the last one runs,
+// and all the pending keys are flushed by a single crl::on_main.
+class CoalescedDispatcher final {
+public:
+	struct KeyStats {
+		uint64 key = 0;
+		int posted = 0;
+		int called = 0;
+	};
+
+	explicit CoalescedDispatcher(QString name);
+	~CoalescedDispatcher();
+
+	// The callback should be guarded, it is called from the main thread
+	// while the dispatcher is alive.
+	void post(uint64 key, Fn<void()> callback);
+
+	[[nodiscard]] std::vector<KeyStats> stats() const;
+
+private:
+	struct State;
+
+	const std::shared_ptr<State> _state;
+
+};
+
+} // namespace Core
@@ -124,7 +124,7 @@ QByteArray Settings::serialize() const {
 		+ Serialize::bytearraySize(proxy)
 		+ sizeof(qint32) * 2
 		+ Serialize::bytearraySize(_photoEditorBrush)
-		+ sizeof(qint32);
+		+ sizeof(qint32) * 8;
 
 	auto result = QByteArray();
 	result.reserve(size);
@@ -221,7 +221,12 @@ QByteArray Settings::serialize() const {
 			<< _photoEditorBrush
 			<< qint32(_groupCallNoiseSuppression ? 1 : 0)
 			<< qint32(_voicePlaybackSpeed * 100)
-			<< qint32(_closeToTaskbar.current() ? 1 : 0);
+			<< qint32(_closeToTaskbar.current() ? 1 : 0)
+			<< qint32(_hardwareAcceleratedVideo ? 1 : 0)
+			<< qint32(_fewerDownloadConnections ? 1 : 0)
+			<< qint32(_downloadSpeedLimit / 1024)
+			<< qint32(_uploadSpeedLimit / 1024)
+			<< qint32(_offlinePreloadLimit / (1024 * 1024));
 	}
 	return result;
 }
@@ -305,6 +310,12 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 	qint32 hiddenGroupCallTooltips = qint32(_hiddenGroupCallTooltips.value());
 	QByteArray photoEditorBrush = _photoEditorBrush;
 	qint32 closeToTaskbar = _closeToTaskbar.current() ? 1 : 0;
+	qint32 hardwareAcceleratedVideo = _hardwareAcceleratedVideo ? 1 : 0;
+	qint32 fewerDownloadConnections = _fewerDownloadConnections ? 1 : 0;
+	qint32 downloadSpeedLimit = qint32(_downloadSpeedLimit / 1024);
+	qint32 uploadSpeedLimit = qint32(_uploadSpeedLimit / 1024);
+	qint32 offlinePreloadLimit = qint32(
+		_offlinePreloadLimit / (1024 * 1024));
 
 	stream >> themesAccentColors;
 	if (!stream.atEnd()) {
@@ -465,6 +476,18 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 	if (!stream.atEnd()) {
 		stream >> closeToTaskbar;
 	}
+	if (!stream.atEnd()) {
+		stream >> hardwareAcceleratedVideo;
+	}
+	if (!stream.atEnd()) {
+		stream >> fewerDownloadConnections;
+	}
+	if (!stream.atEnd()) {
+		stream >> downloadSpeedLimit >> uploadSpeedLimit;
+	}
+	if (!stream.atEnd()) {
+		stream >> offlinePreloadLimit;
+	}
 	if (stream.status() != QDataStream::Ok) {
 		LOG(("App Error: "
 			"Bad data for Core::Settings::constructFromSerialized()"));
@@ -606,6 +629,13 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 	}();
 	_photoEditorBrush = photoEditorBrush;
 	_closeToTaskbar = (closeToTaskbar == 1);
+	_hardwareAcceleratedVideo = (hardwareAcceleratedVideo == 1);
+	_fewerDownloadConnections = (fewerDownloadConnections == 1);
+	_downloadSpeedLimit = int64(std::max(downloadSpeedLimit, 0)) * 1024;
+	_uploadSpeedLimit = int64(std::max(uploadSpeedLimit, 0)) * 1024;
+	_offlinePreloadLimit = int64(std::max(offlinePreloadLimit, 0))
+		* 1024
+		* 1024;
 }
 
 QString Settings::getSoundPath(const QString &key) const {
@@ -613,6 +613,40 @@ public:
 	[[nodiscard]] rpl::producer<bool> closeToTaskbarChanges() const {
 		return _closeToTaskbar.changes();
 	}
+	void setHardwareAcceleratedVideo(bool value) {
+		_hardwareAcceleratedVideo = value;
+	}
+	[[nodiscard]] bool hardwareAcceleratedVideo() const {
+		return _hardwareAcceleratedVideo;
+	}
+	void setFewerDownloadConnections(bool value) {
+		_fewerDownloadConnections = value;
+	}
+	[[nodiscard]] bool fewerDownloadConnections() const {
+		return _fewerDownloadConnections;
+	}
+
+	// Bytes per second, zero means no limit.
+	void setDownloadSpeedLimit(int64 value) {
+		_downloadSpeedLimit = value;
+	}
+	[[nodiscard]] int64 downloadSpeedLimit() const {
+		return _downloadSpeedLimit;
+	}
+	void setUploadSpeedLimit(int64 value) {
+		_uploadSpeedLimit = value;
+	}
+	[[nodiscard]] int64 uploadSpeedLimit() const {
+		return _uploadSpeedLimit;
+	}
+
+	// Bytes a day preloaded from unread chats while idle, zero is off.
+	void setOfflinePreloadLimit(int64 value) {
+		_offlinePreloadLimit = value;
+	}
+	[[nodiscard]] int64 offlinePreloadLimit() const {
+		return _offlinePreloadLimit;
+	}
 
 	[[nodiscard]] static bool ThirdColumnByDefault();
 	[[nodiscard]] static float64 DefaultDialogsWidthRatio();
@@ -714,6 +748,11 @@ private:
 	rpl::variable<WorkMode> _workMode = WorkMode::WindowAndTray;
 	base::flags<Calls::Group::StickedTooltip> _hiddenGroupCallTooltips;
 	rpl::variable<bool> _closeToTaskbar = false;
+	bool _hardwareAcceleratedVideo = false;
+	bool _fewerDownloadConnections = false;
+	int64 _downloadSpeedLimit = 0;
+	int64 _uploadSpeedLimit = 0;
+	int64 _offlinePreloadLimit = 0;
 
 	bool _tabbedReplacedWithInfo = false; // per-window
 	rpl::event_stream<bool> _tabbedReplacedWithInfoValue; // per-window
@@ -0,0 +1,280 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/frame_monitor.h"
+
+#include "base/invoke_queued.h"
+#include "base/timer.h"
+#include "ui/rp_widget.h"
+#include "styles/style_basic.h"
+
+#include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
+
+#include <chrono>
+
+namespace Core::FrameMonitor {
+namespace {
+
+constexpr auto kFramesCount = 120;
+constexpr auto kHotspotsCount = 5;
+constexpr auto kLastStallsCount = 5;
+constexpr auto kWakeupSourcesCount = 3;
+constexpr auto kRepaintDelay = crl::time(250);
+constexpr auto kStallThresholds = std::array<int64, 3>{
+	16'000,
+	50'000,
+	100'000,
+}; // Microseconds.
+
+struct Hotspot {
+	int64 total = 0;
+	int count = 0;
+};
+
+struct Stall {
+	QString name;
+	int64 duration = 0;
+};
+
+struct State {
+	std::array<int64, kFramesCount> frames = { { 0 } };
+	int frameIndex = 0;
+	base::flat_map<const char*, Hotspot> hotspots;
+	std::array<int, kStallThresholds.size()> stalls = { { 0 } };
+	std::deque<Stall> lastStalls;
+	base::flat_map<std::pair<const char*, int>, int> wakeups;
+	int64 started = 0;
+	bool enabled = false;
+};
+
+State &GetState() {
+	static auto result = State();
+	return result;
+}
+
+class Hud final : public Ui::RpWidget {
+public:
+	Hud();
+
+protected:
+	void paintEvent(QPaintEvent *e) override;
+
+private:
+	base::Timer _repaintTimer;
+
+};
+
+Hud::Hud()
+: RpWidget(nullptr)
+, _repaintTimer([=] { update(); }) {
+	setWindowFlags(Qt::FramelessWindowHint
+		| Qt::WindowStaysOnTopHint
+		| Qt::BypassWindowManagerHint
+		| Qt::NoDropShadowWindowHint
+		| Qt::Tool);
+	setAttribute(Qt::WA_TransparentForMouseEvents);
+	setAttribute(Qt::WA_ShowWithoutActivating);
+	setAttribute(Qt::WA_TranslucentBackground);
+
+	const auto lines = 2
+		+ kHotspotsCount
+		+ 1
+		+ kLastStallsCount
+		+ 1
+		+ kWakeupSourcesCount;
+	const auto size = QSize(
+		kFramesCount * 3,
+		st::normalFont->height * (lines + 4));
+	const auto screen = QGuiApplication::primaryScreen();
+	const auto available = screen
+		? screen->availableGeometry()
+		: QRect(QPoint(), size);
+	setGeometry(QRect(
+		available.topLeft() + QPoint(
+			available.width() - size.width() - st::normalFont->height,
+			st::normalFont->height),
+		size));
+	_repaintTimer.callEach(kRepaintDelay);
+}
+
+void Hud::paintEvent(QPaintEvent *e) {
+	const auto &state = GetState();
+
+	auto p = QPainter(this);
+	p.fillRect(rect(), QColor(0, 0, 0, 192));
+	p.setPen(Qt::white);
+	p.setFont(st::normalFont);
+
+	// Rolling frame time graph, 33 ms is the full graph height.
+	const auto line = st::normalFont->height;
+	const auto graph = QRect(0, 0, width(), line * 4);
+	const auto step = width() / kFramesCount;
+	auto sum = int64(0);
+	auto count = 0;
+	for (auto i = 0; i != kFramesCount; ++i) {
+		const auto value = state.frames[
+			(state.frameIndex + i) % kFramesCount];
+		if (!value) {
+			continue;
+		}
+		sum += value;
+		++count;
+		const auto height = std::min(
+			int(value * graph.height() / 33'000),
+			graph.height());
+		p.fillRect(
+			i * step,
+			graph.height() - height,
+			step,
+			height,
+			(value > kStallThresholds[0]) ? Qt::red : Qt::green);
+	}
+
+	auto top = graph.height();
+	const auto text = [&](const QString &value) {
+		p.drawText(QRect(line / 2, top, width() - line, line), value);
+		top += line;
+	};
+	text(u"Frame: %1 ms avg, stalls 16/50/100 ms: %2 / %3 / %4"_q
+		.arg(count ? QString::number(sum / 1000. / count, 'f', 1) : "-")
+		.arg(state.stalls[0])
+		.arg(state.stalls[1])
+		.arg(state.stalls[2]));
+
+	text(u"Paint hotspots:"_q);
+	auto hotspots = std::vector<std::pair<const char*, Hotspot>>(
+		state.hotspots.begin(),
+		state.hotspots.end());
+	ranges::sort(hotspots, ranges::greater(), [](const auto &pair) {
+		return pair.second.total;
+	});
+	for (const auto &[name, hotspot] : hotspots | ranges::views::take(
+			kHotspotsCount)) {
+		text(u"%1: %2 ms in %3"_q
+			.arg(QString::fromLatin1(name))
+			.arg(QString::number(hotspot.total / 1000., 'f', 1))
+			.arg(hotspot.count));
+	}
+
+	// Each outermost main thread event is one event loop wakeup.
+	auto wakeups = std::vector<std::pair<std::pair<const char*, int>, int>>(
+		state.wakeups.begin(),
+		state.wakeups.end());
+	auto wakeupsCount = 0;
+	for (const auto &[source, count] : wakeups) {
+		wakeupsCount += count;
+	}
+	const auto seconds = std::max(
+		(FrameMonitor::Now() - state.started) / 1'000'000.,
+		1.);
+	text(u"Wakeups: %1 per second, top sources:"_q
+		.arg(QString::number(wakeupsCount / seconds, 'f', 1)));
+	ranges::sort(wakeups, ranges::greater(), [](const auto &pair) {
+		return pair.second;
+	});
+	for (const auto &[source, count] : wakeups | ranges::views::take(
+			kWakeupSourcesCount)) {
+		text(u"%1 event %2: %3 per second"_q
+			.arg(QString::fromLatin1(source.first))
+			.arg(source.second)
+			.arg(QString::number(count / seconds, 'f', 1)));
+	}
+
+	text(u"Last stalls:"_q);
+	for (const auto &stall : state.lastStalls) {
+		text(u"%1: %2 ms"_q
+			.arg(stall.name)
+			.arg(QString::number(stall.duration / 1000., 'f', 1)));
+	}
+}
+
+std::unique_ptr<Hud> &HudInstance() {
+	static auto result = std::unique_ptr<Hud>();
+	return result;
+}
+
+[[nodiscard]] QString EventName(
+		not_null<QObject*> receiver,
+		not_null<QEvent*> e) {
+	const auto className = QString::fromLatin1(
+		receiver->metaObject()->className());
+	return (e->type() == base::InvokeQueuedEvent::kType)
+		? (u"InvokeQueued on "_q + className)
+		: (className + u" event "_q + QString::number(int(e->type())));
+}
+
+} // namespace
+
+bool Enabled() {
+	return GetState().enabled;
+}
+
+void Toggle() {
+	auto &state = GetState();
+	auto &hud = HudInstance();
+	if (state.enabled) {
+		hud = nullptr;
+		state = State();
+	} else {
+		state.enabled = true;
+		state.started = Now();
+		hud = std::make_unique<Hud>();
+		hud->show();
+	}
+}
+
+void Finish() {
+	if (Enabled()) {
+		Toggle();
+	}
+}
+
+int64 Now() {
+	using namespace std::chrono;
+	return duration_cast<microseconds>(
+		steady_clock::now().time_since_epoch()).count();
+}
+
+void RecordEvent(
+		not_null<QObject*> receiver,
+		not_null<QEvent*> e,
+		int64 started,
+		int64 duration,
+		bool outermost) {
+	auto &state = GetState();
+	const auto hud = HudInstance().get();
+	if (receiver.get() == static_cast<QObject*>(hud)) {
+		return;
+	}
+	const auto type = e->type();
+	if (type == QEvent::Paint) {
+		auto &hotspot = state.hotspots[receiver->metaObject()->className()];
+		hotspot.total += duration;
+		++hotspot.count;
+	} else if (type == QEvent::UpdateRequest && receiver->isWidgetType()) {
+		state.frames[state.frameIndex] = duration;
+		state.frameIndex = (state.frameIndex + 1) % kFramesCount;
+	}
+	if (outermost) {
+		++state.wakeups[{ receiver->metaObject()->className(), int(type) }];
+	}
+	if (!outermost || duration <= kStallThresholds[0]) {
+		return;
+	}
+	for (auto i = 0; i != int(kStallThresholds.size()); ++i) {
+		if (duration > kStallThresholds[i]) {
+			++state.stalls[i];
+		}
+	}
+	state.lastStalls.push_front({ EventName(receiver, e), duration });
+	if (int(state.lastStalls.size()) > kLastStallsCount) {
+		state.lastStalls.pop_back();
+	}
+}
+
+} // namespace Core::FrameMonitor
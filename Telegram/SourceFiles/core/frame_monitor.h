@@ -0,0 +1,30 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::FrameMonitor {
+
+[[nodiscard]] bool Enabled();
+
+// Shows or hides the frame time overlay and starts / stops recording.
+void Toggle();
+
+// Destroys the overlay, called on application quit.
+void Finish();
+
+[[nodiscard]] int64 Now();
+
+// Called by Sandbox::notify() for every main thread event when enabled.
+void RecordEvent(
+	not_null<QObject*> receiver,
+	not_null<QEvent*> e,
+	int64 started,
+	int64 duration,
+	bool outermost);
+
+} // namespace Core::FrameMonitor
@@ -15,6 +15,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "core/update_checker.h"
 #include "core/sandbox.h"
+#include "core/startup_phases.h"
+#include "core/paint_benchmark.h"
 #include "base/concurrent_timer.h"
 
 #include <QtCore/QLoggingCategory>
@@ -305,6 +307,7 @@ void Launcher::init() {
 
 int Launcher::exec() {
 	init();
+	Core::StartupPhases::Mark("launcher_init");
 
 	if (cLaunchMode() == LaunchModeFixPrevious) {
 		return psFixPrevious();
@@ -314,6 +317,7 @@ int Launcher::exec() {
 
 	// Must be started before Platform is started.
 	Logs::start(this);
+	Core::StartupPhases::Mark("logs_start");
 
 	if (Logs::DebugEnabled()) {
 		const auto openalLogPath = QDir::toNativeSeparators(
@@ -334,6 +338,7 @@ int Launcher::exec() {
 
 	// Must be started before Sandbox is created.
 	Platform::start();
+	Core::StartupPhases::Mark("platform_start");
 	auto result = executeApplication();
 
 	DEBUG_LOG(("Telegram finished, result: %1").arg(result));
@@ -473,6 +478,8 @@ void Launcher::processArguments() {
 		{ "-workdir"        , KeyFormat::OneValue },
 		{ "--"              , KeyFormat::OneValue },
 		{ "-scale"          , KeyFormat::OneValue },
+		{ "-startuptrace"   , KeyFormat::OneValue },
+		{ "-paintbench"     , KeyFormat::OneValue },
 	};
 	auto parseResult = QMap<QByteArray, QStringList>();
 	auto parsingKey = QByteArray();
@@ -521,6 +528,16 @@ void Launcher::processArguments() {
 	}
 	gStartUrl = parseResult.value("--", {}).join(QString());
 
+	const auto tracePath = parseResult.value("-startuptrace", {});
+	if (!tracePath.isEmpty()) {
+		Core::StartupPhases::SetTracePath(tracePath.front());
+	}
+
+	const auto benchmarkPath = parseResult.value("-paintbench", {});
+	if (!benchmarkPath.isEmpty()) {
+		Core::PaintBenchmark::SetOutputPath(benchmarkPath.front());
+	}
+
 	const auto scaleKey = parseResult.value("-scale", {});
 	if (scaleKey.size() > 0) {
 		const auto value = scaleKey[0].toInt();
@@ -532,6 +549,12 @@ void Launcher::processArguments() {
 
 int Launcher::executeApplication() {
 	FilteredCommandLineArguments arguments(_argc, _argv);
+	if (!cManyInstance()
+		&& Sandbox::HandOffToRunningInstance(
+			arguments.count(),
+			arguments.values())) {
+		return 0;
+	}
 	Sandbox sandbox(this, arguments.count(), arguments.values());
 	Ui::MainQueueProcessor processor;
 	base::ConcurrentTimerEnvironment environment;
@@ -0,0 +1,57 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/memory_accounting.h"
+
+namespace Core::MemoryAccounting {
+namespace {
+
+struct Provider {
+	QString name;
+	Fn<int64()> bytes;
+};
+
+struct State {
+	base::flat_map<int, Provider> providers;
+	int autoincrement = 0;
+};
+
+State &GetState() {
+	static auto result = State();
+	return result;
+}
+
+} // namespace
+
+int Register(const QString &name, Fn<int64()> bytes) {
+	Expects(bytes != nullptr);
+
+	auto &state = GetState();
+	const auto id = ++state.autoincrement;
+	state.providers.emplace(id, Provider{ name, std::move(bytes) });
+	return id;
+}
+
+void Unregister(int id) {
+	GetState().providers.remove(id);
+}
+
+std::vector<Entry> Collect() {
+	auto sums = base::flat_map<QString, int64>();
+	for (const auto &[id, provider] : GetState().providers) {
+		sums[provider.name] += provider.bytes();
+	}
+	auto result = std::vector<Entry>();
+	result.reserve(sums.size());
+	for (const auto &[name, bytes] : sums) {
+		result.push_back({ name, bytes });
+	}
+	ranges::sort(result, ranges::greater(), &Entry::bytes);
+	return result;
+}
+
+} // namespace Core::MemoryAccounting
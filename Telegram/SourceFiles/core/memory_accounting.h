@@ -0,0 +1,25 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::MemoryAccounting {
+
+struct Entry {
+	QString name;
+	int64 bytes = 0;
+};
+
+// Providers are called on the main thread only when the stats are
+// requested, so they may do some work to compute an estimate.
+[[nodiscard]] int Register(const QString &name, Fn<int64()> bytes);
+void Unregister(int id);
+
+// Entries with the same name are summed, the largest go first.
+[[nodiscard]] std::vector<Entry> Collect();
+
+} // namespace Core::MemoryAccounting
@@ -0,0 +1,204 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/paint_benchmark.h"
+
+#include "base/timer.h"
+#include "ui/widgets/scroll_area.h"
+
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QPointer>
+
+#include <chrono>
+
+namespace Core::PaintBenchmark {
+namespace {
+
+constexpr auto kScrollStepDelay = crl::time(16);
+constexpr auto kMaxScrollSteps = 1000;
+
+struct Sample {
+	const char *widget = nullptr;
+	const char *kind = nullptr;
+	const char *script = nullptr;
+	int64 started = 0; // Microseconds.
+	int64 duration = 0;
+};
+
+struct Script {
+	QPointer<Ui::ScrollArea> scroll;
+	const char *name = nullptr;
+	std::unique_ptr<base::Timer> timer;
+	bool down = false;
+	int steps = 0;
+};
+
+struct State {
+	std::vector<Sample> samples;
+	QString outputPath;
+	Script script;
+	bool enabled = false;
+};
+
+State &GetState() {
+	static auto result = State();
+	return result;
+}
+
+[[nodiscard]] int64 Now() {
+	using namespace std::chrono;
+	return duration_cast<microseconds>(
+		steady_clock::now().time_since_epoch()).count();
+}
+
+void ScrollStep() {
+	auto &script = GetState().script;
+	const auto scroll = script.scroll.data();
+	if (!scroll || ++script.steps > kMaxScrollSteps) {
+		script.timer->cancel();
+		script.name = nullptr;
+		return;
+	}
+	const auto top = scroll->scrollTop();
+	const auto step = std::max(scroll->height() / 2, 1);
+	if (!script.down) {
+		if (top > 0) {
+			scroll->scrollToY(std::max(top - step, 0));
+			return;
+		}
+		script.down = true;
+	}
+	if (top < scroll->scrollTopMax()) {
+		scroll->scrollToY(top + step);
+	} else {
+		script.timer->cancel();
+		script.name = nullptr;
+	}
+}
+
+[[nodiscard]] QJsonObject Summary(std::vector<int64> durations) {
+	ranges::sort(durations);
+	const auto count = int(durations.size());
+	const auto percentile = [&](int value) {
+		return double(durations[(count - 1) * value / 100]);
+	};
+	auto sum = int64(0);
+	for (const auto duration : durations) {
+		sum += duration;
+	}
+	return QJsonObject{
+		{ "count", count },
+		{ "avg", double(sum) / count },
+		{ "p50", percentile(50) },
+		{ "p95", percentile(95) },
+		{ "max", double(durations.back()) },
+	};
+}
+
+void WriteResults(const QString &path, const std::vector<Sample> &samples) {
+	const auto origin = samples.front().started;
+	auto list = QJsonArray();
+	auto grouped = base::flat_map<QString, std::vector<int64>>();
+	for (const auto &sample : samples) {
+		const auto widget = QString::fromLatin1(sample.widget);
+		const auto kind = QString::fromLatin1(sample.kind);
+		auto object = QJsonObject{
+			{ "widget", widget },
+			{ "kind", kind },
+			{ "ts", double(sample.started - origin) },
+			{ "dur", double(sample.duration) },
+		};
+		if (sample.script) {
+			object.insert("script", QString::fromLatin1(sample.script));
+		}
+		list.push_back(object);
+		grouped[widget + '/' + kind].push_back(sample.duration);
+	}
+	auto summary = QJsonObject();
+	for (auto &[key, durations] : grouped) {
+		summary.insert(key, Summary(std::move(durations)));
+	}
+	auto f = QFile(path);
+	if (!f.open(QIODevice::WriteOnly)) {
+		LOG(("Benchmark Error: Could not write results to '%1'."
+			).arg(path));
+		return;
+	}
+	f.write(QJsonDocument(QJsonObject{
+		{ "samples", list },
+		{ "summary", summary },
+		{ "timeUnit", "us" },
+	}).toJson(QJsonDocument::Compact));
+}
+
+} // namespace
+
+void SetOutputPath(const QString &path) {
+	auto &state = GetState();
+	state.outputPath = path;
+	state.enabled = !path.isEmpty();
+}
+
+bool Enabled() {
+	return GetState().enabled;
+}
+
+Measure::Measure(const char *widget, const char *kind)
+: _widget(widget)
+, _kind(kind)
+, _started(Enabled() ? Now() : 0) {
+}
+
+Measure::~Measure() {
+	if (!_started) {
+		return;
+	}
+	auto &state = GetState();
+	if (state.enabled) {
+		state.samples.push_back({
+			.widget = _widget,
+			.kind = _kind,
+			.script = state.script.name,
+			.started = _started,
+			.duration = Now() - _started,
+		});
+	}
+}
+
+void ScriptScroll(not_null<Ui::ScrollArea*> scroll, const char *name) {
+	auto &state = GetState();
+	if (!state.enabled) {
+		return;
+	}
+	auto &script = state.script;
+	if (!script.timer) {
+		script.timer = std::make_unique<base::Timer>(ScrollStep);
+	}
+	script.scroll = scroll.get();
+	script.name = name;
+	script.down = false;
+	script.steps = 0;
+	script.timer->callEach(kScrollStepDelay);
+}
+
+void Finish() {
+	auto &state = GetState();
+	if (!state.enabled) {
+		return;
+	}
+	state.enabled = false;
+	state.script = Script();
+
+	const auto samples = base::take(state.samples);
+	if (!samples.empty()) {
+		WriteResults(state.outputPath, samples);
+	}
+}
+
+} // namespace Core::PaintBenchmark
@@ -0,0 +1,42 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Ui {
+class ScrollArea;
+} // namespace Ui
+
+namespace Core::PaintBenchmark {
+
+// Enables the benchmark, timings are written as JSON to this path.
+void SetOutputPath(const QString &path);
+[[nodiscard]] bool Enabled();
+
+// Names must be string literals, they are stored as pointers.
+class Measure final {
+public:
+	Measure(const char *widget, const char *kind);
+	~Measure();
+
+	Measure(const Measure &other) = delete;
+	Measure &operator=(const Measure &other) = delete;
+
+private:
+	const char *_widget = nullptr;
+	const char *_kind = nullptr;
+	int64 _started = 0;
+
+};
+
+// Scrolls the area to the top and back to the bottom, one step a frame.
+void ScriptScroll(not_null<Ui::ScrollArea*> scroll, const char *name);
+
+// Writes all the recorded timings, called on application quit.
+void Finish();
+
+} // namespace Core::PaintBenchmark
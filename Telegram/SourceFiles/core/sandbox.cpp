@@ -19,6 +19,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/launcher.h"
 #include "core/local_url_handlers.h"
 #include "core/update_checker.h"
+#include "core/frame_monitor.h"
+#include "core/startup_phases.h"
 #include "base/timer.h"
 #include "base/concurrent_timer.h"
 #include "base/invoke_queued.h"
@@ -37,6 +39,12 @@ namespace {
 
 constexpr auto kEmptyPidForCommandResponse = 0ULL;
 
+// Without a quick connection we don't know if another instance exists,
+// so we fall back to the full startup. Once the command is written we
+// never run it a second time, even if the response is late.
+constexpr auto kHandOffConnectTimeout = 300;
+constexpr auto kHandOffResponseTimeout = 5000;
+
 QChar _toHex(ushort v) {
 	v = v & 0x000F;
 	return QChar::fromLatin1((v >= 10) ? ('a' + (v - 10)) : ('0' + v));
@@ -75,8 +83,81 @@ QString _escapeFrom7bit(const QString &str) {
 	return result;
 }
 
+[[nodiscard]] QString LocalServerName() {
+	const auto d = QFile::encodeName(QDir(cWorkingDir()).absolutePath());
+	char h[33] = { 0 };
+	hashMd5Hex(d.constData(), d.size(), h);
+	return Platform::SingleInstanceLocalServerName(h);
+}
+
+[[nodiscard]] QString PrepareInstanceCommands() {
+	QString commands;
+	const QStringList &lst(cSendPaths());
+	for (QStringList::const_iterator i = lst.cbegin(), e = lst.cend(); i != e; ++i) {
+		commands += qsl("SEND:") + _escapeTo7bit(*i) + ';';
+	}
+	if (!cStartUrl().isEmpty()) {
+		commands += qsl("OPEN:") + _escapeTo7bit(cStartUrl()) + ';';
+	} else if (cQuit()) {
+		commands += qsl("CMD:quit;");
+	} else {
+		commands += qsl("CMD:show;");
+	}
+	return commands;
+}
+
+[[nodiscard]] std::optional<uint64> ParseInstanceResponse(
+		const QString &data) {
+	const auto match = QRegularExpression("RES:(\\d+);").match(data);
+	if (!match.hasMatch()) {
+		return std::nullopt;
+	}
+	return match.captured(1).toULongLong();
+}
+
 } // namespace
 
+bool Sandbox::HandOffToRunningInstance(int &argc, char **argv) {
+	const auto phase = StartupPhases::Phase("single_instance_handoff");
+
+	// The blocking socket calls need only a bare core application.
+	const auto application = QCoreApplication(argc, argv);
+	auto socket = QLocalSocket();
+	socket.connectToServer(LocalServerName());
+	if (!socket.waitForConnected(kHandOffConnectTimeout)) {
+		return false;
+	}
+	LOG(("Socket connected, this is not the first application instance, "
+		"handing off commands..."));
+
+	socket.write(PrepareInstanceCommands().toLatin1());
+	auto response = QString();
+	const auto finish = [&](const char *name) {
+		StartupPhases::Mark(name);
+		StartupPhases::Finish("single_instance_quit");
+		return true;
+	};
+	if (!socket.waitForBytesWritten(kHandOffResponseTimeout)) {
+		LOG(("Could not write show command, error %1, quitting..."
+			).arg(socket.error()));
+		return finish("single_instance_handoff_failed");
+	}
+	while (socket.waitForReadyRead(kHandOffResponseTimeout)) {
+		response.append(QString::fromLatin1(socket.readAll()));
+		if (const auto pid = ParseInstanceResponse(response)) {
+			if (*pid != kEmptyPidForCommandResponse) {
+				psActivateProcess(*pid);
+			}
+			LOG(("Show command response received, pid = %1, quitting..."
+				).arg(*pid));
+			return finish("single_instance_second");
+		}
+	}
+	LOG(("Show command response not received, error %1, quitting..."
+		).arg(socket.error()));
+	return finish("single_instance_handoff_failed");
+}
+
 Sandbox::Sandbox(
 	not_null<Core::Launcher*> launcher,
 	int &argc,
@@ -96,10 +177,7 @@ int Sandbox::start() {
 	if (!Core::UpdaterDisabled()) {
 		_updateChecker = std::make_unique<Core::UpdateChecker>();
 	}
-	const auto d = QFile::encodeName(QDir(cWorkingDir()).absolutePath());
-	char h[33] = { 0 };
-	hashMd5Hex(d.constData(), d.size(), h);
-	_localServerName = Platform::SingleInstanceLocalServerName(h);
+	_localServerName = LocalServerName();
 
 	connect(
 		&_localSocket,
@@ -230,19 +308,7 @@ void Sandbox::socketConnected() {
 	LOG(("Socket connected, this is not the first application instance, sending show command..."));
 	_secondInstance = true;
 
-	QString commands;
-	const QStringList &lst(cSendPaths());
-	for (QStringList::const_iterator i = lst.cbegin(), e = lst.cend(); i != e; ++i) {
-		commands += qsl("SEND:") + _escapeTo7bit(*i) + ';';
-	}
-	if (!cStartUrl().isEmpty()) {
-		commands += qsl("OPEN:") + _escapeTo7bit(cStartUrl()) + ';';
-	} else if (cQuit()) {
-		commands += qsl("CMD:quit;");
-	} else {
-		commands += qsl("CMD:show;");
-	}
-
+	const auto commands = PrepareInstanceCommands();
 	DEBUG_LOG(("Sandbox Info: writing commands %1").arg(commands));
 	_localSocket.write(commands.toLatin1());
 }
@@ -264,15 +330,13 @@ void Sandbox::socketReading() {
 		return;
 	}
 	_localSocketReadData.append(_localSocket.readAll());
-	if (QRegularExpression("RES:(\\d+);").match(_localSocketReadData).hasMatch()) {
-		uint64 pid = base::StringViewMid(
-			_localSocketReadData,
-			4,
-			_localSocketReadData.length() - 5).toULongLong();
-		if (pid != kEmptyPidForCommandResponse) {
-			psActivateProcess(pid);
+	if (const auto pid = ParseInstanceResponse(_localSocketReadData)) {
+		if (*pid != kEmptyPidForCommandResponse) {
+			psActivateProcess(*pid);
 		}
-		LOG(("Show command response received, pid = %1, activating and quitting...").arg(pid));
+		LOG(("Show command response received, pid = %1, activating and quitting...").arg(*pid));
+		StartupPhases::Mark("single_instance_second");
+		StartupPhases::Finish("single_instance_quit");
 		return App::quit();
 	}
 }
@@ -285,6 +349,7 @@ void Sandbox::socketError(QLocalSocket::LocalSocketError e) {
 		return App::quit();
 	}
 
+	StartupPhases::Mark("single_instance_first");
 	if (e == QLocalSocket::ServerNotFoundError) {
 		LOG(("This is the only instance of Telegram, starting server and app..."));
 	} else {
@@ -556,9 +621,29 @@ bool Sandbox::notify(QObject *receiver, QEvent *e) {
 			return true;
 		}
 	}
+	if (FrameMonitor::Enabled()) {
+		return notifyMeasured(receiver, e);
+	}
 	return notifyOrInvoke(receiver, e);
 }
 
+bool Sandbox::notifyMeasured(QObject *receiver, QEvent *e) {
+	// Receiver may be destroyed while the event is processed.
+	const auto weak = QPointer<QObject>(receiver);
+	const auto outermost = (_eventNestingLevel == _loopNestingLevel + 1);
+	const auto started = FrameMonitor::Now();
+	const auto result = notifyOrInvoke(receiver, e);
+	if (weak) {
+		FrameMonitor::RecordEvent(
+			receiver,
+			e,
+			started,
+			FrameMonitor::Now() - started,
+			outermost);
+	}
+	return result;
+}
+
 void Sandbox::processPostponedCalls(int level) {
 	while (!_postponedCalls.empty()) {
 		auto &last = _postponedCalls.back();
@@ -61,6 +61,12 @@ public:
 		return *static_cast<Sandbox*>(QCoreApplication::instance());
 	}
 
+	// Passes the command line to a running instance before the GUI is
+	// initialized, returns true if this instance should quit right away.
+	[[nodiscard]] static bool HandOffToRunningInstance(
+		int &argc,
+		char **argv);
+
 	~Sandbox();
 
 protected:
@@ -76,6 +82,7 @@ private:
 	};
 
 	bool notifyOrInvoke(QObject *receiver, QEvent *e);
+	bool notifyMeasured(QObject *receiver, QEvent *e);
 
 	void closeApplication(); // will be done in aboutToQuit()
 	void checkForQuit(); // will be done in exec()
@@ -0,0 +1,151 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/startup_phases.h"
+
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QThread>
+
+#include <atomic>
+#include <chrono>
+
+namespace Core::StartupPhases {
+namespace {
+
+struct Event {
+	const char *name = nullptr;
+	int64 started = 0; // Microseconds.
+	int64 duration = -1; // Instant events have negative duration.
+	quint64 thread = 0;
+};
+
+struct State {
+	QMutex mutex;
+	std::vector<Event> events;
+	QString tracePath;
+	std::atomic<bool> finished = false;
+};
+
+State &GetState() {
+	static auto result = State();
+	return result;
+}
+
+[[nodiscard]] int64 Now() {
+	using namespace std::chrono;
+	return duration_cast<microseconds>(
+		steady_clock::now().time_since_epoch()).count();
+}
+
+void Record(Event &&event) {
+	auto &state = GetState();
+	QMutexLocker lock(&state.mutex);
+	if (!state.finished) {
+		event.thread = quint64(quintptr(QThread::currentThreadId()));
+		state.events.push_back(std::move(event));
+	}
+}
+
+void WriteTrace(const QString &path, const std::vector<Event> &events) {
+	const auto origin = events.front().started;
+	auto list = QJsonArray();
+	for (const auto &event : events) {
+		auto object = QJsonObject();
+		object.insert("name", QString::fromLatin1(event.name));
+		object.insert("cat", "startup");
+		object.insert("ph", (event.duration < 0) ? "i" : "X");
+		object.insert("ts", double(event.started - origin));
+		if (event.duration >= 0) {
+			object.insert("dur", double(event.duration));
+		} else {
+			object.insert("s", "p");
+		}
+		object.insert("pid", 1);
+		object.insert("tid", double(event.thread));
+		list.push_back(object);
+	}
+	auto f = QFile(path);
+	if (!f.open(QIODevice::WriteOnly)) {
+		LOG(("Startup Error: Could not write trace to '%1'.").arg(path));
+		return;
+	}
+	f.write(QJsonDocument(QJsonObject{
+		{ "traceEvents", list },
+		{ "displayTimeUnit", "ms" },
+	}).toJson(QJsonDocument::Compact));
+}
+
+} // namespace
+
+void Mark(const char *name) {
+	Record({ .name = name, .started = Now() });
+}
+
+Phase::Phase(const char *name) : _name(name), _started(Now()) {
+}
+
+Phase::~Phase() {
+	Record({
+		.name = _name,
+		.started = _started,
+		.duration = Now() - _started,
+	});
+}
+
+void SetTracePath(const QString &path) {
+	auto &state = GetState();
+	QMutexLocker lock(&state.mutex);
+	state.tracePath = path;
+}
+
+void Finish(const char *name) {
+	auto &state = GetState();
+	if (state.finished) {
+		return;
+	}
+	Mark(name);
+
+	auto events = std::vector<Event>();
+	auto tracePath = QString();
+	{
+		QMutexLocker lock(&state.mutex);
+		if (state.finished) {
+			return;
+		}
+		state.finished = true;
+		events = base::take(state.events);
+		tracePath = state.tracePath;
+	}
+	if (events.empty()) {
+		return;
+	}
+	ranges::stable_sort(events, ranges::less(), &Event::started);
+
+	const auto origin = events.front().started;
+	const auto ms = [](int64 value) {
+		return QString::number(value / 1000., 'f', 1);
+	};
+	for (const auto &event : events) {
+		if (event.duration < 0) {
+			LOG(("Startup: %1 at %2 ms."
+				).arg(event.name
+				).arg(ms(event.started - origin)));
+		} else {
+			LOG(("Startup: %1 at %2 ms took %3 ms."
+				).arg(event.name
+				).arg(ms(event.started - origin)
+				).arg(ms(event.duration)));
+		}
+	}
+	if (!tracePath.isEmpty()) {
+		WriteTrace(tracePath, events);
+	}
+}
+
+} // namespace Core::StartupPhases
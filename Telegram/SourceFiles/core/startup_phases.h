@@ -0,0 +1,36 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::StartupPhases {
+
+// Names must be string literals, they are stored as pointers.
+void Mark(const char *name);
+
+class Phase final {
+public:
+	explicit Phase(const char *name);
+	~Phase();
+
+	Phase(const Phase &other) = delete;
+	Phase &operator=(const Phase &other) = delete;
+
+private:
+	const char *_name = nullptr;
+	int64 _started = 0;
+
+};
+
+// Writes a Chrome trace (chrome://tracing) to this path on Finish().
+void SetTracePath(const QString &path);
+
+// Logs all the recorded phases, called on the first main window paint
+// or when the command line was handed off to a running instance.
+void Finish(const char *name);
+
+} // namespace Core::StartupPhases
@@ -265,6 +265,20 @@ QString ExtractFilename(const QString &url) {
 	return QString();
 }
 
+bool SameAsInstalled(const QString &relativeName, const QByteArray &data) {
+#ifdef Q_OS_MAC
+	// The application bundle is replaced as a whole.
+	return false;
+#else // Q_OS_MAC
+	QFile installed(cExeDir() + relativeName);
+	if (installed.size() != data.size()
+		|| !installed.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	return (installed.readAll() == data);
+#endif // Q_OS_MAC
+}
+
 bool UnpackUpdate(const QString &filepath) {
 #ifndef TDESKTOP_DISABLE_AUTOUPDATE
 	QFile input(filepath);
@@ -457,6 +471,12 @@ bool UnpackUpdate(const QString &filepath) {
 				LOG(("Update Error: bad file size %1 not matching data size %2").arg(fileSize).arg(fileInnerData.size()));
 				return false;
 			}
+			if (SameAsInstalled(relativeName, fileInnerData)) {
+				// The updater copies only what is in the temp folder.
+				DEBUG_LOG(("Update Info: skipping unchanged file '%1'"
+					).arg(relativeName));
+				continue;
+			}
 
 			QFile f(tempDirPath + '/' + relativeName);
 			if (!QDir().mkpath(QFileInfo(f).absolutePath())) {
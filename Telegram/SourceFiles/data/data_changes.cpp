@@ -17,15 +17,22 @@ void Changes::Manager<DataType, UpdateType>::updated(
 		Flags flags,
 		bool dropScheduled) {
 	sendRealtimeNotifications(data, flags);
+	++_stats.updates;
 	if (dropScheduled) {
 		const auto i = _updates.find(data);
 		if (i != _updates.end()) {
 			flags |= i->second;
 			_updates.erase(i);
+			++_stats.merged;
 		}
+		++_stats.delivered;
 		_stream.fire({ data, flags });
 	} else {
-		_updates[data] |= flags;
+		auto &already = _updates[data];
+		if (already) {
+			++_stats.merged;
+		}
+		already |= flags;
 	}
 }
 
@@ -78,12 +85,24 @@ rpl::producer<UpdateType> Changes::Manager<DataType, UpdateType>::flagsValue(
 
 template <typename DataType, typename UpdateType>
 void Changes::Manager<DataType, UpdateType>::sendNotifications() {
-	for (const auto &[data, flags] : base::take(_updates)) {
+	auto updates = base::take(_updates);
+	_stats.delivered += updates.size();
+	for (const auto &[data, flags] : updates) {
 		_stream.fire({ data, flags });
 	}
 }
 
-Changes::Changes(not_null<Main::Session*> session) : _session(session) {
+template <typename DataType, typename UpdateType>
+void Changes::Manager<DataType, UpdateType>::addStats(
+		ChangesStats &to) const {
+	to.updates += _stats.updates;
+	to.merged += _stats.merged;
+	to.delivered += _stats.delivered;
+}
+
+Changes::Changes(not_null<Main::Session*> session)
+: _session(session)
+, _coalesceTimer([=] { sendScheduledNotifications(); }) {
 }
 
 Main::Session &Changes::session() const {
@@ -227,9 +246,53 @@ rpl::producer<EntryUpdate> Changes::realtimeEntryUpdates(
 void Changes::scheduleNotifications() {
 	if (!_notify) {
 		_notify = true;
-		crl::on_main(&session(), [=] {
-			sendNotifications();
-		});
+		if (_suspended) {
+			return;
+		} else if (_coalesceInterval > 0) {
+			if (!_coalesceTimer.isActive()) {
+				_coalesceTimer.callOnce(_coalesceInterval);
+			}
+		} else {
+			crl::on_main(&session(), [=] {
+				sendScheduledNotifications();
+			});
+		}
+	}
+}
+
+void Changes::sendScheduledNotifications() {
+	if (!_suspended) {
+		sendNotifications();
+	}
+}
+
+void Changes::setCoalesceInterval(crl::time interval) {
+	_coalesceInterval = std::max(interval, crl::time(0));
+	if (!_coalesceInterval && _coalesceTimer.isActive()) {
+		_coalesceTimer.cancel();
+		sendScheduledNotifications();
+	}
+}
+
+ChangesStats Changes::stats() const {
+	auto result = ChangesStats();
+	_peerChanges.addStats(result);
+	_historyChanges.addStats(result);
+	_messageChanges.addStats(result);
+	_entryChanges.addStats(result);
+	return result;
+}
+
+void Changes::suspendNotifications() {
+	++_suspended;
+}
+
+void Changes::resumeNotifications() {
+	Expects(_suspended > 0);
+
+	if (!--_suspended && _notify) {
+		_notify = false;
+		scheduleNotifications();
 	}
 }
 
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/flags.h"
+#include "base/timer.h"
 
 class History;
 class PeerData;
@@ -176,6 +177,12 @@ struct EntryUpdate {
 
 };
 
+struct ChangesStats {
+	int64 updates = 0;
+	int64 merged = 0;
+	int64 delivered = 0;
+};
+
 class Changes final {
 public:
 	explicit Changes(not_null<Main::Session*> session);
@@ -245,6 +252,19 @@ public:
 
 	void sendNotifications();
 
+	// While suspended, scheduled notifications are accumulated per object
+	// and sent once after the last resume. Explicit sends are not affected.
+	void suspendNotifications();
+	void resumeNotifications();
+
+	// By default scheduled notifications are sent on the next event loop
+	// iteration. With a positive interval they are sent at most once per
+	// that interval, for example once per frame.
+	void setCoalesceInterval(crl::time interval);
+
+	// Realtime notifications are not counted, they're never merged.
+	[[nodiscard]] ChangesStats stats() const;
+
 private:
 	template <typename DataType, typename UpdateType>
 	class Manager final {
@@ -268,6 +288,8 @@ private:
 
 		void sendNotifications();
 
+		void addStats(ChangesStats &to) const;
+
 	private:
 		static constexpr auto kCount = details::CountBit<Flag>();
 
@@ -276,10 +298,12 @@ private:
 		std::array<rpl::event_stream<UpdateType>, kCount> _realtimeStreams;
 		base::flat_map<not_null<DataType*>, Flags> _updates;
 		rpl::event_stream<UpdateType> _stream;
+		ChangesStats _stats;
 
 	};
 
 	void scheduleNotifications();
+	void sendScheduledNotifications();
 
 	const not_null<Main::Session*> _session;
 
@@ -289,6 +313,9 @@ private:
 	Manager<HistoryItem, MessageUpdate> _messageChanges;
 	Manager<Dialogs::Entry, EntryUpdate> _entryChanges;
 
+	base::Timer _coalesceTimer;
+	crl::time _coalesceInterval = 0;
+	int _suspended = 0;
 	bool _notify = false;
 
 };
@@ -562,10 +562,18 @@ bool ChatFilters::loadNextExceptions(bool chatsListLoaded) {
 	return true;
 }
 
-void ChatFilters::refreshHistory(not_null<History*> history) {
-	if (history->inChatList() && !list().empty()) {
-		_owner->refreshChatListEntry(history);
+void ChatFilters::refreshHistory(
+		not_null<History*> history,
+		ChatFilter::Flags affected) {
+	if (!history->inChatList() || list().empty()) {
+		return;
+	} else if (affected
+		&& ranges::none_of(list(), [&](const ChatFilter &filter) {
+			return (filter.flags() & affected) != 0;
+		})) {
+		return;
 	}
+	_owner->refreshChatListEntry(history, affected);
 }
 
 void ChatFilters::requestSuggested() {
@@ -106,7 +106,11 @@ public:
 
 	bool loadNextExceptions(bool chatsListLoaded);
 
-	void refreshHistory(not_null<History*> history);
+	// Only filters having one of the 'affected' flags are checked again,
+	// an empty 'affected' means that the history is checked against all.
+	void refreshHistory(
+		not_null<History*> history,
+		ChatFilter::Flags affected = ChatFilter::Flags());
 
 	[[nodiscard]] not_null<Dialogs::MainList*> chatsList(FilterId filterId);
 
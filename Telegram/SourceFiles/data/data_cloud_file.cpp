@@ -22,6 +22,54 @@ CloudFile::~CloudFile() {
 	base::take(loader);
 }
 
+FileLoader *CloudFileLoads::loader(const Storage::Cache::Key &key) const {
+	const auto i = _entries.find(key);
+	return (i != end(_entries)) ? i->second.loader.get() : nullptr;
+}
+
+void CloudFileLoads::started(
+		const Storage::Cache::Key &key,
+		not_null<FileLoader*> loader) {
+	_entries.emplace_or_assign(key, Entry{ loader });
+	loader->lifetime().add([=, weak = base::make_weak(this)] {
+		if (const auto strong = weak.get()) {
+			strong->finished(key, loader);
+		}
+	});
+}
+
+void CloudFileLoads::wait(
+		const Storage::Cache::Key &key,
+		const std::shared_ptr<Fn<void()>> &retry) {
+	const auto i = _entries.find(key);
+	Assert(i != end(_entries));
+	i->second.waiting.push_back(retry);
+}
+
+void CloudFileLoads::finished(
+		const Storage::Cache::Key &key,
+		not_null<FileLoader*> loader) {
+	const auto i = _entries.find(key);
+	if (i == end(_entries) || i->second.loader != loader) {
+		return;
+	}
+	auto waiting = std::move(i->second.waiting);
+	_entries.erase(i);
+	if (waiting.empty()) {
+		return;
+	}
+
+	// We're inside ~FileLoader() here, so retry a bit later.
+	crl::on_main(this, [waiting = std::move(waiting)] {
+		for (const auto &weak : waiting) {
+			if (const auto strong = weak.lock()) {
+				const auto retry = *strong;
+				retry();
+			}
+		}
+	});
+}
+
 void CloudImageView::set(
 		not_null<Main::Session*> session,
 		QImage image) {
@@ -58,6 +106,7 @@ void CloudImage::set(
 		_file.location = ImageLocation();
 		_view = std::weak_ptr<CloudImageView>();
 	}
+	const auto location = _file.location;
 	UpdateCloudFile(
 		_file,
 		data,
@@ -69,11 +118,13 @@ void CloudImage::set(
 				view->set(session, data.preloaded);
 			}
 		});
+	checkViewOutdated(location);
 }
 
 void CloudImage::update(
 		not_null<Main::Session*> session,
 		const ImageWithLocation &data) {
+	const auto location = _file.location;
 	UpdateCloudFile(
 		_file,
 		data,
@@ -85,6 +136,18 @@ void CloudImage::update(
 				view->set(session, data.preloaded);
 			}
 		});
+	checkViewOutdated(location);
+}
+
+void CloudImage::checkViewOutdated(const ImageLocation &was) {
+	if (!_file.location.valid() || _file.location == was) {
+		return;
+	} else if (_file.loader) {
+		// The loader was already restarted for the new location.
+		return;
+	}
+	const auto view = activeView();
+	_viewOutdated = view && view->image();
 }
 
 bool CloudImage::empty() const {
@@ -92,7 +155,7 @@ bool CloudImage::empty() const {
 }
 
 bool CloudImage::loading() const {
-	return (_file.loader != nullptr);
+	return (_file.loader != nullptr) || (_file.waiting != nullptr);
 }
 
 bool CloudImage::failed() const {
@@ -103,11 +166,13 @@ void CloudImage::load(not_null<Main::Session*> session, FileOrigin origin) {
 	const auto autoLoading = false;
 	const auto finalCheck = [=] {
 		if (const auto active = activeView()) {
-			return !active->image();
+			// Keep showing the smaller image until the larger one loads.
+			return !active->image() || _viewOutdated;
 		}
 		return true;
 	};
 	const auto done = [=](QImage result) {
+		_viewOutdated = false;
 		if (const auto active = activeView()) {
 			active->set(session, std::move(result));
 		}
@@ -212,22 +277,60 @@ void LoadCloudFile(
 		Fn<void(CloudFile&)> done,
 		Fn<void(bool)> fail,
 		Fn<void()> progress,
-		int downloadFrontPartSize = 0) {
+		int downloadFrontPartSize = 0,
+		bool prefetch = false) {
 	const auto loadSize = downloadFrontPartSize
 		? std::min(downloadFrontPartSize, file.byteSize)
 		: file.byteSize;
-	if (file.loader) {
+	const auto request = [&](not_null<FileLoader*> loader) {
 		if (fromCloud == LoadFromCloudOrLocal) {
-			file.loader->permitLoadFromCloud();
+			loader->permitLoadFromCloud();
 		}
-		if (file.loader->loadSize() < loadSize) {
-			file.loader->increaseLoadSize(loadSize, autoLoading);
+		if (loader->loadSize() < loadSize) {
+			loader->increaseLoadSize(loadSize, autoLoading);
 		}
+		if (!prefetch) {
+			loader->raisePriority();
+		}
+	};
+	auto &loads = session->data().cloudFileLoads();
+	const auto key = file.location.valid()
+		? file.location.file().cacheKey()
+		: Storage::Cache::Key();
+	if (file.loader) {
+		request(file.loader.get());
 		return;
-	} else if ((file.flags & CloudFile::Flag::Failed)
+	} else if (file.waiting) {
+		if (const auto shared = key ? loads.loader(key) : nullptr) {
+			request(shared);
+			return;
+		}
+		file.waiting = nullptr;
+	}
+	if ((file.flags & CloudFile::Flag::Failed)
 		|| !file.location.valid()
 		|| (finalCheck && !finalCheck())) {
 		return;
+	} else if (const auto shared = key ? loads.loader(key) : nullptr) {
+		request(shared);
+		file.waiting = std::make_shared<Fn<void()>>([=, &file] {
+			file.waiting = nullptr;
+			LoadCloudFile(
+				session,
+				file,
+				origin,
+				fromCloud,
+				autoLoading,
+				cacheTag,
+				finalCheck,
+				done,
+				fail,
+				progress,
+				downloadFrontPartSize,
+				prefetch);
+		});
+		loads.wait(key, file.waiting);
+		return;
 	}
 	file.flags &= ~CloudFile::Flag::Cancelled;
 	file.loader = CreateFileLoader(
@@ -242,6 +345,12 @@ void LoadCloudFile(
 		fromCloud,
 		autoLoading,
 		cacheTag);
+	if (prefetch) {
+		file.loader->setPrefetch();
+	}
+	if (key) {
+		loads.started(key, file.loader.get());
+	}
 
 	const auto finish = [done](CloudFile &file) {
 		if (!file.loader || file.loader->cancelled()) {
@@ -287,7 +396,8 @@ void LoadCloudFile(
 		Fn<void(QImage)> done,
 		Fn<void(bool)> fail,
 		Fn<void()> progress,
-		int downloadFrontPartSize) {
+		int downloadFrontPartSize,
+		bool prefetch) {
 	const auto callback = [=](CloudFile &file) {
 		if (auto read = file.loader->imageData(); read.isNull()) {
 			file.flags |= CloudFile::Flag::Failed;
@@ -309,7 +419,8 @@ void LoadCloudFile(
 		callback,
 		std::move(fail),
 		std::move(progress),
-		downloadFrontPartSize);
+		downloadFrontPartSize,
+		prefetch);
 }
 
 void LoadCloudFile(
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/flags.h"
+#include "base/weak_ptr.h"
 #include "ui/image/image.h"
 #include "ui/image/image_location.h"
 
@@ -38,11 +39,39 @@ struct CloudFile final {
 
 	ImageLocation location;
 	std::unique_ptr<FileLoader> loader;
+	std::shared_ptr<Fn<void()>> waiting;
 	int byteSize = 0;
 	int progressivePartSize = 0;
 	base::flags<Flag> flags;
 };
 
+// Lets CloudFile-s with the same location share one download.
+// While some CloudFile loads a location others only wait for it
+// and read the result from the local cache when it finishes.
+class CloudFileLoads final : public base::has_weak_ptr {
+public:
+	[[nodiscard]] FileLoader *loader(const Storage::Cache::Key &key) const;
+	void started(
+		const Storage::Cache::Key &key,
+		not_null<FileLoader*> loader);
+	void wait(
+		const Storage::Cache::Key &key,
+		const std::shared_ptr<Fn<void()>> &retry);
+
+private:
+	struct Entry {
+		not_null<FileLoader*> loader;
+		std::vector<std::weak_ptr<Fn<void()>>> waiting;
+	};
+
+	void finished(
+		const Storage::Cache::Key &key,
+		not_null<FileLoader*> loader);
+
+	base::flat_map<Storage::Cache::Key, Entry> _entries;
+
+};
+
 class CloudImageView final {
 public:
 	void set(not_null<Main::Session*> session, QImage image);
@@ -83,8 +112,11 @@ public:
 		const std::shared_ptr<CloudImageView> &view) const;
 
 private:
+	void checkViewOutdated(const ImageLocation &was);
+
 	CloudFile _file;
 	std::weak_ptr<CloudImageView> _view;
+	bool _viewOutdated = false;
 
 };
 
@@ -107,7 +139,8 @@ void LoadCloudFile(
 	Fn<void(QImage)> done,
 	Fn<void(bool)> fail = nullptr,
 	Fn<void()> progress = nullptr,
-	int downloadFrontPartSize = 0);
+	int downloadFrontPartSize = 0,
+	bool prefetch = false);
 
 void LoadCloudFile(
 	not_null<Main::Session*> session,
@@ -15,6 +15,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 #include "inline_bots/inline_bot_layout_item.h"
 #include "main/main_session.h"
+#include "main/main_account.h"
+#include "main/main_domain.h"
 #include "mainwidget.h"
 #include "core/file_utilities.h"
 #include "core/mime_type.h"
@@ -24,6 +26,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/player/media_player_instance.h"
 #include "media/streaming/media_streaming_loader_mtproto.h"
 #include "media/streaming/media_streaming_loader_local.h"
+#include "mtproto/mtp_instance.h"
 #include "storage/localstorage.h"
 #include "storage/storage_account.h"
 #include "storage/streamed_file_downloader.h"
@@ -75,6 +78,27 @@ QString JoinStringList(const QStringList &list, const QString &separator) {
 	return result;
 }
 
+// Files saved by other accounts of the same environment are reused,
+// document ids are the same for all of them. Media cache locations are
+// skipped, because each account has its own encrypted cache.
+[[nodiscard]] Core::FileLocation ReadOtherAccountsFileLocation(
+		not_null<Main::Session*> session,
+		MediaKey key) {
+	const auto environment = session->mtp().environment();
+	for (const auto &[index, account] : Core::App().domain().accounts()) {
+		if (account.get() == &session->account()
+			|| !account->sessionExists()
+			|| account->mtp().environment() != environment) {
+			continue;
+		}
+		auto result = account->local().readFileLocation(key);
+		if (!result.isEmpty() && !result.inMediaCache() && result.check()) {
+			return result;
+		}
+	}
+	return Core::FileLocation();
+}
+
 } // namespace
 
 QString FileNameUnsafe(
@@ -494,6 +518,14 @@ bool DocumentData::thumbnailFailed() const {
 }
 
 void DocumentData::loadThumbnail(Data::FileOrigin origin) {
+	loadThumbnail(origin, false);
+}
+
+void DocumentData::prefetchThumbnail(Data::FileOrigin origin) {
+	loadThumbnail(origin, true);
+}
+
+void DocumentData::loadThumbnail(Data::FileOrigin origin, bool prefetch) {
 	const auto autoLoading = false;
 	const auto finalCheck = [=] {
 		if (const auto active = activeMediaView()) {
@@ -514,7 +546,11 @@ void DocumentData::loadThumbnail(Data::FileOrigin origin) {
 		autoLoading,
 		Data::kImageCacheTag,
 		finalCheck,
-		done);
+		done,
+		nullptr,
+		nullptr,
+		0,
+		prefetch);
 }
 
 const ImageLocation &DocumentData::thumbnailLocation() const {
@@ -1000,11 +1036,18 @@ QByteArray documentWaveformEncode5bit(const VoiceWaveform &waveform) {
 
 const Core::FileLocation &DocumentData::location(bool check) const {
 	if (check && !_location.check()) {
-		const auto location = session().local().readFileLocation(mediaKey());
+		const auto key = mediaKey();
+		auto location = session().local().readFileLocation(key);
 		const auto that = const_cast<DocumentData*>(this);
 		if (location.inMediaCache()) {
 			that->setLoadedInMediaCacheLocation();
 		} else {
+			if (location.isEmpty() && !isNull()) {
+				location = ReadOtherAccountsFileLocation(&session(), key);
+				if (!location.isEmpty()) {
+					session().local().writeFileLocation(key, location);
+				}
+			}
 			that->_location = location;
 		}
 	}
@@ -162,6 +162,7 @@ public:
 	[[nodiscard]] bool thumbnailLoading() const;
 	[[nodiscard]] bool thumbnailFailed() const;
 	void loadThumbnail(Data::FileOrigin origin);
+	void prefetchThumbnail(Data::FileOrigin origin);
 	[[nodiscard]] const ImageLocation &thumbnailLocation() const;
 	[[nodiscard]] int thumbnailByteSize() const;
 
@@ -296,6 +297,7 @@ private:
 	void validateLottieSticker();
 	void setMaybeSupportsStreaming(bool supports);
 	void setLoadedInMediaCacheLocation();
+	void loadThumbnail(Data::FileOrigin origin, bool prefetch);
 	void setFileName(const QString &remoteFileName);
 
 	void finishLoad();
@@ -34,6 +34,7 @@ namespace {
 constexpr auto kReadAreaLimit = 12'032 * 9'024;
 constexpr auto kWallPaperThumbnailLimit = 960;
 constexpr auto kGoodThumbQuality = 87;
+constexpr auto kGoodThumbTasksLimit = 2;
 
 enum class FileType {
 	Video,
@@ -44,6 +45,48 @@ enum class FileType {
 	Theme,
 };
 
+struct GoodThumbnailTask {
+	not_null<DocumentData*> document;
+	base::weak_ptr<Main::Session> session;
+	FnMut<void()> task;
+};
+
+struct GoodThumbnailQueue {
+	std::vector<GoodThumbnailTask> tasks;
+	int running = 0;
+};
+
+[[nodiscard]] GoodThumbnailQueue &GoodThumbnailTasks() {
+	static auto result = GoodThumbnailQueue();
+	return result;
+}
+
+void StartGoodThumbnailTasks() {
+	auto &queue = GoodThumbnailTasks();
+	queue.tasks.erase(ranges::remove_if(queue.tasks, [](
+			const GoodThumbnailTask &task) {
+		return !task.session;
+	}), end(queue.tasks));
+	while (queue.running < kGoodThumbTasksLimit && !queue.tasks.empty()) {
+		const auto i = ranges::find_if(queue.tasks, [](
+				const GoodThumbnailTask &task) {
+			return (task.document->activeMediaView() != nullptr);
+		});
+		auto task = std::move((i != end(queue.tasks))
+			? *i
+			: queue.tasks.front()).task;
+		queue.tasks.erase((i != end(queue.tasks)) ? i : begin(queue.tasks));
+		++queue.running;
+		crl::async([task = std::move(task)]() mutable {
+			task();
+			crl::on_main([] {
+				--GoodThumbnailTasks().running;
+				StartGoodThumbnailTasks();
+			});
+		});
+	}
+}
+
 [[nodiscard]] bool MayHaveGoodThumbnail(not_null<DocumentData*> owner) {
 	return owner->isVideoFile()
 		|| owner->isAnimation()
@@ -149,12 +192,24 @@ bool VideoPreviewState::loaded() const {
 
 DocumentMedia::DocumentMedia(not_null<DocumentData*> owner)
 : _owner(owner) {
+	if (_owner->sticker()) {
+		// Sticker thumbnails are shown again and again in the panels,
+		// restore them from the compressed copy left by a previous media.
+		_coldKey = { _owner->session().uniqueId(), _owner->id };
+		if (auto image = Images::TakeCold(_coldKey); !image.isNull()) {
+			_thumbnail = std::make_unique<Image>(std::move(image));
+		}
+	}
 }
 
 // NB! Right now DocumentMedia can outlive Main::Session!
 // In DocumentData::collectLocalData a shared_ptr is sent on_main.
 // In case this is a problem the ~Gif code should be rewritten.
-DocumentMedia::~DocumentMedia() = default;
+DocumentMedia::~DocumentMedia() {
+	if (_coldKey.id && _thumbnail) {
+		Images::PutCold(_coldKey, _thumbnail->original());
+	}
+}
 
 not_null<DocumentData*> DocumentMedia::owner() const {
 	return _owner;
@@ -420,7 +475,7 @@ void DocumentMedia::GenerateGoodThumbnail(
 		return;
 	}
 	const auto guard = base::make_weak(&document->owner().session());
-	crl::async([=, location = std::move(location)] {
+	EnqueueGoodThumbnailTask(document, [=, location = std::move(location)] {
 		const auto filepath = (location && location->accessEnable())
 			? location->name()
 			: QString();
@@ -454,6 +509,17 @@ void DocumentMedia::GenerateGoodThumbnail(
 	});
 }
 
+void DocumentMedia::EnqueueGoodThumbnailTask(
+		not_null<DocumentData*> document,
+		FnMut<void()> task) {
+	GoodThumbnailTasks().tasks.push_back({
+		.document = document,
+		.session = base::make_weak(&document->session()),
+		.task = std::move(task),
+	});
+	StartGoodThumbnailTasks();
+}
+
 void DocumentMedia::CheckGoodThumbnail(not_null<DocumentData*> document) {
 	if (!document->goodThumbnailChecked()) {
 		ReadOrGenerateThumbnail(document);
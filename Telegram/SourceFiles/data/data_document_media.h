@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/flags.h"
+#include "ui/image/image_cold_cache.h"
 
 class Image;
 class FileLoader;
@@ -83,6 +84,12 @@ public:
 	// For DocumentData.
 	static void CheckGoodThumbnail(not_null<DocumentData*> document);
 
+	// Good thumbnails are generated on a background queue with a small
+	// concurrency limit, documents with an active media view go first.
+	static void EnqueueGoodThumbnailTask(
+		not_null<DocumentData*> document,
+		FnMut<void()> task);
+
 private:
 	enum class Flag : uchar {
 		GoodThumbnailWanted = 0x01,
@@ -106,6 +113,7 @@ private:
 	mutable QPainterPath _pathThumbnail;
 	std::unique_ptr<Image> _thumbnail;
 	std::unique_ptr<Image> _sticker;
+	Images::ColdKey _coldKey;
 	QByteArray _bytes;
 	QByteArray _videoThumbnailBytes;
 	Flags _flags;
@@ -0,0 +1,179 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "data/data_msg_id.h"
+
+namespace Data {
+
+[[nodiscard]] inline uint64 MixHashBits(uint64 value) {
+	value ^= value >> 33;
+	value *= 0xFF51AFD7ED558CCDULL;
+	value ^= value >> 33;
+	value *= 0xC4CEB9FE1A85EC53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+struct IdHash {
+	[[nodiscard]] uint64 operator()(uint64 id) const {
+		return MixHashBits(id);
+	}
+};
+
+struct FullMsgIdHash {
+	[[nodiscard]] uint64 operator()(FullMsgId id) const {
+		return MixHashBits((id.channel.bare * 0x9E3779B97F4A7C15ULL)
+			^ uint64(id.msg.bare));
+	}
+};
+
+// Open addressing with linear probing and backward shift deletion, so
+// there are no tombstones and a lookup touches one contiguous run of slots.
+// Pointers returned by find() and emplace() are valid until the next
+// emplace() or erase() call.
+template <typename Key, typename Value, typename Hash = IdHash>
+class FlatHashMap final {
+public:
+	[[nodiscard]] Value *find(const Key &key) {
+		const auto index = lookup(key);
+		return (index >= 0) ? &_slots[index].value : nullptr;
+	}
+	[[nodiscard]] const Value *find(const Key &key) const {
+		const auto index = lookup(key);
+		return (index >= 0) ? &_slots[index].value : nullptr;
+	}
+	[[nodiscard]] bool contains(const Key &key) const {
+		return (lookup(key) >= 0);
+	}
+
+	std::pair<Value*, bool> emplace(const Key &key, Value &&value) {
+		if (const auto found = find(key)) {
+			return { found, false };
+		}
+		if ((_size + 1) * 4 > int(_slots.size()) * 3) {
+			rehash(_slots.empty() ? kMinCapacity : (_slots.size() * 2));
+		}
+		auto index = ideal(key);
+		while (_slots[index].used) {
+			index = (index + 1) & mask();
+		}
+		auto &slot = _slots[index];
+		slot.key = key;
+		slot.value = std::move(value);
+		slot.used = true;
+		++_size;
+		return { &slot.value, true };
+	}
+
+	std::optional<Value> take(const Key &key) {
+		const auto index = lookup(key);
+		if (index < 0) {
+			return std::nullopt;
+		}
+		auto result = std::make_optional(std::move(_slots[index].value));
+		remove(index);
+		return result;
+	}
+	bool erase(const Key &key) {
+		const auto index = lookup(key);
+		if (index < 0) {
+			return false;
+		}
+		remove(index);
+		return true;
+	}
+
+	template <typename Callback>
+	void forEach(Callback &&callback) const {
+		for (const auto &slot : _slots) {
+			if (slot.used) {
+				callback(slot.key, slot.value);
+			}
+		}
+	}
+
+	[[nodiscard]] int size() const {
+		return _size;
+	}
+	[[nodiscard]] bool empty() const {
+		return !_size;
+	}
+	void clear() {
+		// Values are destroyed after the map is already empty.
+		const auto was = base::take(_slots);
+		_size = 0;
+	}
+
+private:
+	struct Slot {
+		Key key = Key();
+		Value value = Value();
+		bool used = false;
+	};
+
+	static constexpr auto kMinCapacity = size_t(16);
+
+	[[nodiscard]] size_t mask() const {
+		return _slots.size() - 1;
+	}
+	[[nodiscard]] size_t ideal(const Key &key) const {
+		return size_t(Hash()(key)) & mask();
+	}
+
+	[[nodiscard]] int lookup(const Key &key) const {
+		if (_slots.empty()) {
+			return -1;
+		}
+		for (auto index = ideal(key);; index = (index + 1) & mask()) {
+			const auto &slot = _slots[index];
+			if (!slot.used) {
+				return -1;
+			} else if (slot.key == key) {
+				return int(index);
+			}
+		}
+	}
+
+	void remove(size_t index) {
+		// Move back the entries that were displaced past the removed one.
+		auto next = (index + 1) & mask();
+		while (_slots[next].used) {
+			const auto wanted = ideal(_slots[next].key);
+			const auto distance = (next - wanted) & mask();
+			const auto available = (next - index) & mask();
+			if (distance >= available) {
+				_slots[index] = std::move(_slots[next]);
+				index = next;
+			}
+			next = (next + 1) & mask();
+		}
+		_slots[index] = Slot();
+		--_size;
+	}
+
+	void rehash(size_t capacity) {
+		auto was = base::take(_slots);
+		_slots.resize(capacity);
+		for (auto &slot : was) {
+			if (slot.used) {
+				auto index = ideal(slot.key);
+				while (_slots[index].used) {
+					index = (index + 1) & mask();
+				}
+				_slots[index] = std::move(slot);
+			}
+		}
+	}
+
+	std::vector<Slot> _slots;
+	int _size = 0;
+
+};
+
+} // namespace Data
@@ -0,0 +1,121 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_full_peer_cache.h"
+
+#include "data/data_session.h"
+#include "data/data_types.h"
+#include "data/data_user.h"
+#include "data/data_chat.h"
+#include "data/data_channel.h"
+#include "main/main_session.h"
+#include "storage/cache/storage_cache_database.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kCacheVersion = mtpPrime(1);
+
+template <typename Type>
+void Cache(not_null<PeerData*> peer, const Type &data) {
+	auto buffer = mtpBuffer();
+	buffer.push_back(kCacheVersion);
+	data.write(buffer);
+	peer->owner().cache().put(
+		FullPeerCacheKey(peer->id),
+		Storage::Cache::Database::TaggedValue(
+			QByteArray(
+				reinterpret_cast<const char*>(buffer.constData()),
+				buffer.size() * sizeof(mtpPrime)),
+			kFullPeerCacheTag));
+}
+
+template <typename Type>
+[[nodiscard]] std::optional<Type> Parse(const QByteArray &bytes) {
+	if (bytes.size() % sizeof(mtpPrime) || bytes.size() < sizeof(mtpPrime)) {
+		return std::nullopt;
+	}
+	auto from = reinterpret_cast<const mtpPrime*>(bytes.constData());
+	const auto till = from + (bytes.size() / sizeof(mtpPrime));
+	if (*from++ != kCacheVersion) {
+		return std::nullopt;
+	}
+	auto result = Type();
+	if (!result.read(from, till)) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+void ApplyCached(not_null<UserData*> user, const MTPUserFull &data) {
+	const auto &full = data.c_userFull();
+	user->setAbout(qs(full.vabout().value_or_empty()));
+	user->setCommonChatsCount(full.vcommon_chats_count().v);
+	if (const auto info = full.vbot_info()) {
+		user->setBotInfo(*info);
+	}
+}
+
+void ApplyCached(not_null<PeerData*> peer, const MTPChatFull &data) {
+	data.match([&](const MTPDchatFull &data) {
+		if (const auto chat = peer->asChat()) {
+			chat->setAbout(qs(data.vabout()));
+		}
+	}, [&](const MTPDchannelFull &data) {
+		if (const auto channel = peer->asChannel()) {
+			channel->setAbout(qs(data.vabout()));
+			channel->setMembersCount(
+				data.vparticipants_count().value_or_empty());
+			channel->setAdminsCount(data.vadmins_count().value_or_empty());
+			channel->setRestrictedCount(
+				data.vbanned_count().value_or_empty());
+			channel->setKickedCount(data.vkicked_count().value_or_empty());
+		}
+	});
+}
+
+template <typename Type, typename Apply>
+void Read(not_null<PeerData*> peer, Apply apply) {
+	const auto guard = base::make_weak(&peer->session());
+	peer->owner().cache().get(FullPeerCacheKey(peer->id), [=](
+			QByteArray &&value) {
+		auto parsed = Parse<Type>(value);
+		if (!parsed) {
+			return;
+		}
+		crl::on_main(guard, [=, data = std::move(*parsed)] {
+			// The server data we already have is newer than the cached one.
+			if (!peer->wasFullUpdated()) {
+				apply(data);
+			}
+		});
+	});
+}
+
+} // namespace
+
+void CacheFullUser(not_null<UserData*> user, const MTPUserFull &data) {
+	Cache(user, data);
+}
+
+void CacheFullChat(not_null<PeerData*> peer, const MTPChatFull &data) {
+	Cache(peer, data);
+}
+
+void ReadCachedFullPeer(not_null<PeerData*> peer) {
+	if (const auto user = peer->asUser()) {
+		Read<MTPUserFull>(user, [=](const MTPUserFull &data) {
+			ApplyCached(user, data);
+		});
+	} else {
+		Read<MTPChatFull>(peer, [=](const MTPChatFull &data) {
+			ApplyCached(peer, data);
+		});
+	}
+}
+
+} // namespace Data
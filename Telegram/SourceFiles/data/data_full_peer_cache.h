@@ -0,0 +1,24 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class PeerData;
+class UserData;
+
+namespace Data {
+
+// The last full info of users and chats is kept in the (encrypted) cache
+// database, so that profiles can be painted before the server answers.
+void CacheFullUser(not_null<UserData*> user, const MTPUserFull &data);
+void CacheFullChat(not_null<PeerData*> peer, const MTPChatFull &data);
+
+// Only the fields shown in the profile are applied from the cache and
+// only until the full info is received from the server.
+void ReadCachedFullPeer(not_null<PeerData*> peer);
+
+} // namespace Data
@@ -12,6 +12,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_chat.h"
 #include "data/data_folder.h"
 #include "data/data_scheduled_messages.h"
+#include "data/data_replies_list.h"
+#include "data/data_messages_cache.h"
+#include "data/data_user.h"
 #include "main/main_session.h"
 #include "window/notifications_manager.h"
 #include "history/history.h"
@@ -24,12 +27,87 @@ namespace Data {
 namespace {
 
 constexpr auto kReadRequestTimeout = 3 * crl::time(1000);
+constexpr auto kUnloadIdleCheckPeriod = 60 * crl::time(1000);
+constexpr auto kUnloadIdleTimeout = 30 * 60 * crl::time(1000);
+constexpr auto kMaxIdleLoaded = 50;
+constexpr auto kRepliesListsLimit = 8;
+constexpr auto kWarmUpMessagesCount = 30;
+constexpr auto kWarmUpValidFor = 60 * crl::time(1000);
+
+using RequestType = Histories::RequestType;
+
+// Whether a request of the waiting type can't be sent (and gets
+// cancelled and resent later if already sent) while a request
+// of the blocking type is in flight for the same history.
+[[nodiscard]] bool RequestsConflict(
+		RequestType waiting,
+		RequestType blocking) {
+	switch (waiting) {
+	case RequestType::History:
+	case RequestType::ChatListMessage:
+		// Messages may come back that the server already deleted.
+		return (blocking == RequestType::Delete);
+	case RequestType::None:
+	case RequestType::ReadInbox:
+	case RequestType::Delete:
+	case RequestType::Send:
+		return false;
+	}
+	Unexpected("Type in RequestsConflict.");
+}
+
+// Whether a dialog entry refresh would get stale top message or
+// unread counters if done while a request of this type is in flight.
+[[nodiscard]] bool ConflictsWithEntry(RequestType type) {
+	switch (type) {
+	case RequestType::None:
+	case RequestType::History:
+	case RequestType::ChatListMessage:
+		return false;
+	case RequestType::ReadInbox:
+	case RequestType::Delete:
+	case RequestType::Send:
+		return true;
+	}
+	Unexpected("Type in ConflictsWithEntry.");
+}
+
+[[nodiscard]] QString RequestTypeName(RequestType type) {
+	switch (type) {
+	case RequestType::History: return u"history"_q;
+	case RequestType::ChatListMessage: return u"chat_list_message"_q;
+	case RequestType::ReadInbox: return u"read_inbox"_q;
+	case RequestType::Delete: return u"delete"_q;
+	case RequestType::Send: return u"send"_q;
+	}
+	return u"none"_q;
+}
 
 } // namespace
 
 Histories::Histories(not_null<Session*> owner)
 : _owner(owner)
-, _readRequestsTimer([=] { sendReadRequests(); }) {
+, _readRequestsTimer([=] { sendReadRequests(); })
+, _unloadIdleTimer([=] { unloadIdle(); }) {
+	_unloadIdleTimer.callEach(kUnloadIdleCheckPeriod);
+}
+
+Histories::~Histories() {
+	const auto log = [](const QString &name, const PostponeStats &stats) {
+		if (!stats.count) {
+			return;
+		}
+		LOG(("Histories Info: %1 requests postponed %2 times, "
+			"average delay %3 ms, max delay %4 ms."
+			).arg(name
+			).arg(stats.count
+			).arg(stats.total / stats.count
+			).arg(stats.max));
+	};
+	for (const auto &[type, stats] : _postponeStats) {
+		log(RequestTypeName(type), stats);
+	}
+	log(u"dialog_entry"_q, _entryPostponeStats);
 }
 
 Session &Histories::owner() const {
@@ -58,15 +136,104 @@ not_null<History*> Histories::findOrCreate(PeerId peerId) {
 }
 
 void Histories::unloadAll() {
+	_repliesLists.clear();
 	for (const auto &[peerId, history] : _map) {
 		history->clear(History::ClearType::Unload);
 	}
 }
 
+void Histories::unloadHidden() {
+	for (const auto &[peerId, history] : _map) {
+		if (!history->isEmpty() && !_shownCounts.contains(history.get())) {
+			unload(history.get());
+		}
+	}
+}
+
+void Histories::unload(not_null<History*> history) {
+	// Cached threads would lose their unloaded messages one by one,
+	// leaving holes in their windows, so they're dropped beforehand.
+	_repliesLists.erase(
+		ranges::remove(
+			_repliesLists,
+			history,
+			&RepliesList::history),
+		end(_repliesLists));
+	history->clear(History::ClearType::Unload);
+	_hiddenAt.remove(history);
+}
+
+std::shared_ptr<RepliesList> Histories::repliesList(
+		not_null<History*> history,
+		MsgId rootId) {
+	const auto i = ranges::find_if(_repliesLists, [&](
+			const std::shared_ptr<RepliesList> &list) {
+		return (list->history() == history) && (list->rootId() == rootId);
+	});
+	if (i != end(_repliesLists)) {
+		std::rotate(i, i + 1, end(_repliesLists));
+		return _repliesLists.back();
+	} else if (_repliesLists.size() >= kRepliesListsLimit) {
+		_repliesLists.erase(begin(_repliesLists));
+	}
+	_repliesLists.push_back(
+		std::make_shared<RepliesList>(history, rootId));
+	return _repliesLists.back();
+}
+
 void Histories::clearAll() {
+	_repliesLists.clear();
+	_shownCounts.clear();
+	_hiddenAt.clear();
+	_warmUpRequests.clear();
+	_warmedUp.clear();
 	_map.clear();
 }
 
+rpl::lifetime Histories::markShown(not_null<History*> history) {
+	shownChanged(history, true);
+	return rpl::lifetime(crl::guard(this, [=] {
+		shownChanged(history, false);
+	}));
+}
+
+void Histories::shownChanged(not_null<History*> history, bool shown) {
+	if (shown) {
+		++_shownCounts[history];
+		_hiddenAt.remove(history);
+		return;
+	}
+	const auto i = _shownCounts.find(history);
+	Assert(i != end(_shownCounts));
+	if (!--i->second) {
+		_shownCounts.erase(i);
+		_hiddenAt[history] = crl::now();
+	}
+}
+
+void Histories::unloadIdle() {
+	const auto now = crl::now();
+	auto idle = std::vector<std::pair<crl::time, not_null<History*>>>();
+	for (const auto &[peerId, history] : _map) {
+		if (history->isEmpty() || _shownCounts.contains(history.get())) {
+			continue;
+		}
+		// Histories loaded without ever being shown count from now.
+		const auto i = _hiddenAt.emplace(history.get(), now).first;
+		idle.emplace_back(i->second, history.get());
+	}
+	ranges::sort(idle);
+
+	// Messages are requested again when the history is shown next time.
+	const auto over = int(idle.size()) - kMaxIdleLoaded;
+	for (auto i = 0; i != int(idle.size()); ++i) {
+		const auto &[hiddenAt, history] = idle[i];
+		if (i < over || hiddenAt + kUnloadIdleTimeout <= now) {
+			unload(history);
+		}
+	}
+}
+
 void Histories::readInbox(not_null<History*> history) {
 	DEBUG_LOG(("Reading: readInbox called."));
 	if (history->lastServerMessageKnown()) {
@@ -317,7 +484,7 @@ void Histories::sendDialogRequests() {
 		} else if (!postponeEntryRequest(*state)) {
 			return true;
 		}
-		state->postponedRequestEntry = true;
+		markEntryRequestPostponed(state);
 		return false;
 	}) | ranges::to_vector;
 
@@ -413,7 +580,8 @@ void Histories::requestFakeChatListMessage(
 	}
 
 	_fakeChatListRequests.emplace(history);
-	sendRequest(history, RequestType::History, [=](Fn<void()> finish) {
+	const auto type = RequestType::ChatListMessage;
+	sendRequest(history, type, [=](Fn<void()> finish) {
 		return session().api().request(MTPmessages_GetHistory(
 			history->peer->input,
 			MTP_int(0), // offset_id
@@ -438,6 +606,61 @@ void Histories::requestFakeChatListMessage(
 	});
 }
 
+void Histories::warmUp(
+		not_null<History*> history,
+		Fn<void(const MTPmessages_Messages&)> done) {
+	if (!history->isEmpty()
+		|| history->unreadCount() >= kWarmUpMessagesCount
+		|| _warmUpRequests.contains(history)) {
+		return;
+	}
+	const auto now = crl::now();
+	const auto i = _warmedUp.find(history);
+	if (i != end(_warmedUp) && i->second + kWarmUpValidFor > now) {
+		return;
+	}
+	const auto requestId = sendRequest(history, RequestType::History, [=](
+			Fn<void()> finish) {
+		return session().api().request(MTPmessages_GetHistory(
+			history->peer->input,
+			MTP_int(0), // offset_id
+			MTP_int(0), // offset_date
+			MTP_int(0), // add_offset
+			MTP_int(kWarmUpMessagesCount),
+			MTP_int(0), // max_id
+			MTP_int(0), // min_id
+			MTP_long(0) // hash
+		)).done([=](const MTPmessages_Messages &result) {
+			_warmUpRequests.remove(history);
+			_warmedUp[history] = crl::now();
+			CacheLastMessages(history, result);
+			result.match([](const MTPDmessages_messagesNotModified &) {
+			}, [&](const auto &data) {
+				for (const auto &user : data.vusers().v) {
+					owner().processUser(user)->loadUserpic();
+				}
+				for (const auto &chat : data.vchats().v) {
+					owner().processChat(chat)->loadUserpic();
+				}
+			});
+			if (done) {
+				done(result);
+			}
+			finish();
+		}).fail([=](const MTP::Error &error) {
+			_warmUpRequests.remove(history);
+			finish();
+		}).send();
+	});
+	_warmUpRequests.emplace(history, requestId);
+}
+
+void Histories::cancelWarmUp(not_null<History*> history) {
+	if (const auto requestId = _warmUpRequests.take(history)) {
+		cancelRequest(*requestId);
+	}
+}
+
 void Histories::requestGroupAround(not_null<HistoryItem*> item) {
 	const auto history = item->history();
 	const auto id = item->id;
@@ -451,7 +674,8 @@ void Histories::requestGroupAround(not_null<HistoryItem*> item) {
 		}
 	}
 	constexpr auto kMaxAlbumCount = 10;
-	const auto requestId = sendRequest(history, RequestType::History, [=](
+	const auto type = RequestType::ChatListMessage;
+	const auto requestId = sendRequest(history, type, [=](
 			Fn<void()> finish) {
 		return session().api().request(MTPmessages_GetHistory(
 			history->peer->input,
@@ -585,20 +809,34 @@ void Histories::checkEmptyState(not_null<History*> history) {
 	}
 }
 
-bool Histories::postponeHistoryRequest(const State &state) const {
-	const auto proj = [](const auto &pair) {
-		return pair.second.type;
-	};
-	const auto i = ranges::find(state.sent, RequestType::Delete, proj);
-	return (i != end(state.sent));
+bool Histories::postponeRequest(
+		const State &state,
+		RequestType type) const {
+	return ranges::any_of(state.sent, [&](const auto &pair) {
+		return RequestsConflict(type, pair.second.type);
+	});
 }
 
 bool Histories::postponeEntryRequest(const State &state) const {
 	return ranges::any_of(state.sent, [](const auto &pair) {
-		return pair.second.type != RequestType::History;
+		return ConflictsWithEntry(pair.second.type);
 	});
 }
 
+void Histories::markEntryRequestPostponed(not_null<State*> state) {
+	if (!state->postponedRequestEntry) {
+		state->postponedRequestEntry = true;
+		state->postponedRequestEntryAt = crl::now();
+	}
+}
+
+void Histories::countPostponed(PostponeStats &stats, crl::time postponedAt) {
+	const auto delay = crl::now() - postponedAt;
+	++stats.count;
+	stats.total += delay;
+	accumulate_max(stats.max, delay);
+}
+
 void Histories::deleteMessages(
 		not_null<History*> history,
 		const QVector<MTPint> &ids,
@@ -764,43 +1002,80 @@ int Histories::sendRequest(
 		Fn<mtpRequestId(Fn<void()> finish)> generator) {
 	Expects(type != RequestType::None);
 
-	auto &state = _states[history];
+	const auto state = &_states[history];
 	const auto id = ++_requestAutoincrement;
 	_historyByRequest.emplace(id, history);
-	if (type == RequestType::History && postponeHistoryRequest(state)) {
-		state.postponed.emplace(
-			id,
-			PostponedHistoryRequest{ std::move(generator) });
+	if (postponeRequest(*state, type)) {
+		state->postponed.emplace(id, PostponedRequest{
+			std::move(generator),
+			type,
+			crl::now()
+		});
 		return id;
 	}
+	startRequest(history, state, id, type, std::move(generator));
+	return id;
+}
+
+void Histories::startRequest(
+		not_null<History*> history,
+		not_null<State*> state,
+		int id,
+		RequestType type,
+		Fn<mtpRequestId(Fn<void()> finish)> generator) {
 	const auto requestId = generator([=] { checkPostponed(history, id); });
-	state.sent.emplace(id, SentRequest{
+	state->sent.emplace(id, SentRequest{
 		std::move(generator),
 		requestId,
 		type
 	});
-	if (!state.postponedRequestEntry
-		&& postponeEntryRequest(state)
-		&& _dialogRequests.contains(history)) {
-		state.postponedRequestEntry = true;
-	}
-	if (postponeHistoryRequest(state)) {
-		const auto resendHistoryRequest = [&](auto &pair) {
-			auto &[id, sent] = pair;
-			if (sent.type != RequestType::History) {
-				return false;
-			}
-			state.postponed.emplace(
-				id,
-				PostponedHistoryRequest{ std::move(sent.generator) });
-			session().api().request(sent.id).cancel();
-			return true;
-		};
-		state.sent.erase(
-			ranges::remove_if(state.sent, resendHistoryRequest),
-			end(state.sent));
+	if (ConflictsWithEntry(type) && _dialogRequests.contains(history)) {
+		markEntryRequestPostponed(state);
+	}
+	const auto now = crl::now();
+	const auto resendConflicting = [&](auto &pair) {
+		auto &[id, sent] = pair;
+		if (!RequestsConflict(sent.type, type)) {
+			return false;
+		}
+		state->postponed.emplace(id, PostponedRequest{
+			std::move(sent.generator),
+			sent.type,
+			now
+		});
+		session().api().request(sent.id).cancel();
+		return true;
+	};
+	state->sent.erase(
+		ranges::remove_if(state->sent, resendConflicting),
+		end(state->sent));
+}
+
+void Histories::sendPostponedRequests(
+		not_null<History*> history,
+		not_null<State*> state) {
+	const auto ready = [&](const auto &pair) {
+		return !postponeRequest(*state, pair.second.type);
+	};
+	while (true) {
+		const auto i = ranges::find_if(state->postponed, ready);
+		if (i == end(state->postponed)) {
+			break;
+		}
+		const auto id = i->first;
+		auto request = std::move(i->second);
+		state->postponed.erase(i);
+		countPostponed(_postponeStats[request.type], request.postponedAt);
+		DEBUG_LOG(("Histories: sending %1 request after %2 ms postponed."
+			).arg(RequestTypeName(request.type)
+			).arg(crl::now() - request.postponedAt));
+		startRequest(
+			history,
+			state,
+			id,
+			request.type,
+			std::move(request.generator));
 	}
-	return id;
 }
 
 void Histories::checkPostponed(not_null<History*> history, int id) {
@@ -835,18 +1110,7 @@ void Histories::finishSentRequest(
 		session().api().request(i->second.id).cancel();
 		state->sent.erase(i);
 	}
-	if (!state->postponed.empty() && !postponeHistoryRequest(*state)) {
-		for (auto &[id, postponed] : base::take(state->postponed)) {
-			const auto requestId = postponed.generator([=, id=id] {
-				checkPostponed(history, id);
-			});
-			state->sent.emplace(id, SentRequest{
-				std::move(postponed.generator),
-				requestId,
-				RequestType::History
-			});
-		}
-	}
+	sendPostponedRequests(history, state);
 	if (state->postponedRequestEntry && !postponeEntryRequest(*state)) {
 		const auto i = _dialogRequests.find(history);
 		Assert(i != end(_dialogRequests));
@@ -856,6 +1120,9 @@ void Histories::finishSentRequest(
 		Assert(ok);
 		_dialogRequests.erase(i);
 		state->postponedRequestEntry = false;
+		countPostponed(
+			_entryPostponeStats,
+			state->postponedRequestEntryAt);
 		postponeRequestDialogEntries();
 	}
 	checkEmptyState(history);
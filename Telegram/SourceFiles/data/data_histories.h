@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/timer.h"
+#include "base/weak_ptr.h"
 
 class History;
 class HistoryItem;
@@ -20,18 +21,21 @@ namespace Data {
 
 class Session;
 class Folder;
+class RepliesList;
 
-class Histories final {
+class Histories final : public base::has_weak_ptr {
 public:
 	enum class RequestType : uchar {
 		None,
 		History,
+		ChatListMessage,
 		ReadInbox,
 		Delete,
 		Send,
 	};
 
 	explicit Histories(not_null<Session*> owner);
+	~Histories();
 
 	[[nodiscard]] Session &owner() const;
 	[[nodiscard]] Main::Session &session() const;
@@ -42,8 +46,18 @@ public:
 	void applyPeerDialogs(const MTPmessages_PeerDialogs &dialogs);
 
 	void unloadAll();
+	void unloadHidden();
 	void clearAll();
 
+	// Views of histories that are not shown for a while are unloaded,
+	// the history is kept shown while the returned lifetime is alive.
+	[[nodiscard]] rpl::lifetime markShown(not_null<History*> history);
+
+	// Recently viewed threads keep their loaded windows for a while.
+	[[nodiscard]] std::shared_ptr<RepliesList> repliesList(
+		not_null<History*> history,
+		MsgId rootId);
+
 	void readInbox(not_null<History*> history);
 	void readInboxTill(not_null<HistoryItem*> item);
 	void readInboxTill(not_null<History*> history, MsgId tillId);
@@ -61,6 +75,14 @@ public:
 
 	void requestGroupAround(not_null<HistoryItem*> item);
 
+	// Loads the last page of a chat the user is about to open into the
+	// messages cache and starts loading the userpics it shows. Does
+	// nothing if the first unread message won't fit in that page.
+	void warmUp(
+		not_null<History*> history,
+		Fn<void(const MTPmessages_Messages&)> done = nullptr);
+	void cancelWarmUp(not_null<History*> history);
+
 	void deleteMessages(
 		not_null<History*> history,
 		const QVector<MTPint> &ids,
@@ -80,8 +102,10 @@ public:
 	void cancelRequest(int id);
 
 private:
-	struct PostponedHistoryRequest {
+	struct PostponedRequest {
 		Fn<mtpRequestId(Fn<void()> finish)> generator;
+		RequestType type = RequestType::None;
+		crl::time postponedAt = 0;
 	};
 	struct SentRequest {
 		Fn<mtpRequestId(Fn<void()> finish)> generator;
@@ -89,14 +113,20 @@ private:
 		RequestType type = RequestType::None;
 	};
 	struct State {
-		base::flat_map<int, PostponedHistoryRequest> postponed;
+		base::flat_map<int, PostponedRequest> postponed;
 		base::flat_map<int, SentRequest> sent;
 		MsgId willReadTill = 0;
 		MsgId sentReadTill = 0;
 		crl::time willReadWhen = 0;
 		bool sentReadDone = false;
+		crl::time postponedRequestEntryAt = 0;
 		bool postponedRequestEntry = false;
 	};
+	struct PostponeStats {
+		int count = 0;
+		crl::time total = 0;
+		crl::time max = 0;
+	};
 	struct ChatListGroupRequest {
 		MsgId aroundId = 0;
 		mtpRequestId requestId = 0;
@@ -112,12 +142,29 @@ private:
 		not_null<History*> history,
 		not_null<State*> state,
 		int id);
-	[[nodiscard]] bool postponeHistoryRequest(const State &state) const;
+	void startRequest(
+		not_null<History*> history,
+		not_null<State*> state,
+		int id,
+		RequestType type,
+		Fn<mtpRequestId(Fn<void()> finish)> generator);
+	void sendPostponedRequests(
+		not_null<History*> history,
+		not_null<State*> state);
+	[[nodiscard]] bool postponeRequest(
+		const State &state,
+		RequestType type) const;
 	[[nodiscard]] bool postponeEntryRequest(const State &state) const;
+	void markEntryRequestPostponed(not_null<State*> state);
+	void countPostponed(PostponeStats &stats, crl::time postponedAt);
 	void postponeRequestDialogEntries();
 
 	void sendDialogRequests();
 
+	void shownChanged(not_null<History*> history, bool shown);
+	void unloadIdle();
+	void unload(not_null<History*> history);
+
 	const not_null<Session*> _owner;
 
 	std::unordered_map<PeerId, std::unique_ptr<History>> _map;
@@ -134,7 +181,17 @@ private:
 		not_null<History*>,
 		std::vector<Fn<void()>>> _dialogRequestsPending;
 
+	base::flat_map<RequestType, PostponeStats> _postponeStats;
+	PostponeStats _entryPostponeStats;
+
 	base::flat_set<not_null<History*>> _fakeChatListRequests;
+	base::flat_map<not_null<History*>, int> _warmUpRequests;
+	base::flat_map<not_null<History*>, crl::time> _warmedUp;
+
+	base::flat_map<not_null<History*>, int> _shownCounts;
+	base::flat_map<not_null<History*>, crl::time> _hiddenAt;
+	base::Timer _unloadIdleTimer;
+	std::vector<std::shared_ptr<RepliesList>> _repliesLists;
 
 	base::flat_map<
 		not_null<History*>,
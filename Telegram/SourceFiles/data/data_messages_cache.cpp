@@ -0,0 +1,131 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_messages_cache.h"
+
+#include "data/data_session.h"
+#include "data/data_types.h"
+#include "history/history.h"
+#include "main/main_session.h"
+#include "storage/cache/storage_cache_database.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kCacheVersion = mtpPrime(1);
+constexpr auto kMaxCachedMessages = 50;
+
+[[nodiscard]] QByteArray Serialize(const MTPmessages_Messages &data) {
+	return data.match([](const MTPDmessages_messagesNotModified &) {
+		return QByteArray();
+	}, [](const auto &data) {
+		auto messages = data.vmessages().v;
+		if (messages.size() > kMaxCachedMessages) {
+			// Messages come from the newest to the oldest.
+			messages.resize(kMaxCachedMessages);
+		}
+		auto buffer = mtpBuffer();
+		buffer.push_back(kCacheVersion);
+		MTP_messages_messages(
+			MTP_vector<MTPMessage>(std::move(messages)),
+			data.vchats(),
+			data.vusers()
+		).write(buffer);
+		return QByteArray(
+			reinterpret_cast<const char*>(buffer.constData()),
+			buffer.size() * sizeof(mtpPrime));
+	});
+}
+
+[[nodiscard]] std::optional<MTPDmessages_messages> Parse(
+		const QByteArray &bytes) {
+	if (bytes.size() % sizeof(mtpPrime) || bytes.size() < sizeof(mtpPrime)) {
+		return std::nullopt;
+	}
+	auto from = reinterpret_cast<const mtpPrime*>(bytes.constData());
+	const auto till = from + (bytes.size() / sizeof(mtpPrime));
+	if (*from++ != kCacheVersion) {
+		return std::nullopt;
+	}
+	auto result = MTPmessages_Messages();
+	if (!result.read(from, till)
+		|| result.type() != mtpc_messages_messages) {
+		return std::nullopt;
+	}
+	return result.c_messages_messages();
+}
+
+[[nodiscard]] PeerId UserPeerId(const MTPUser &user) {
+	return user.match([](const auto &data) {
+		return peerFromUser(data.vid());
+	});
+}
+
+[[nodiscard]] PeerId ChatPeerId(const MTPChat &chat) {
+	return chat.match([](const MTPDchannel &data) {
+		return peerFromChannel(data.vid().v);
+	}, [](const MTPDchannelForbidden &data) {
+		return peerFromChannel(data.vid().v);
+	}, [](const auto &data) {
+		return peerFromChat(data.vid().v);
+	});
+}
+
+template <typename Type, typename PeerIdFromData>
+[[nodiscard]] MTPVector<Type> OnlyMissing(
+		not_null<Session*> owner,
+		const MTPVector<Type> &list,
+		PeerIdFromData peerIdFromData) {
+	auto result = QVector<Type>();
+	for (const auto &data : list.v) {
+		if (!owner->peerLoaded(peerIdFromData(data))) {
+			result.push_back(data);
+		}
+	}
+	return MTP_vector<Type>(std::move(result));
+}
+
+} // namespace
+
+void CacheLastMessages(
+		not_null<History*> history,
+		const MTPmessages_Messages &data) {
+	auto bytes = Serialize(data);
+	if (bytes.isEmpty()) {
+		return;
+	}
+	history->owner().cache().put(
+		MessagesCacheKey(history->peer->id),
+		Storage::Cache::Database::TaggedValue(
+			std::move(bytes),
+			kMessagesCacheTag));
+}
+
+void ReadCachedLastMessages(
+		not_null<History*> history,
+		Fn<void(QVector<MTPMessage>&&)> done) {
+	const auto guard = base::make_weak(&history->session());
+	const auto key = MessagesCacheKey(history->peer->id);
+	history->owner().cache().get(key, [=](QByteArray &&value) {
+		auto parsed = Parse(value);
+		if (!parsed) {
+			return;
+		}
+		crl::on_main(guard, [=, data = std::move(*parsed)] {
+			// The server data we already have is newer than the cached one.
+			const auto owner = &history->owner();
+			owner->processUsers(
+				OnlyMissing(owner, data.vusers(), UserPeerId));
+			owner->processChats(
+				OnlyMissing(owner, data.vchats(), ChatPeerId));
+			auto messages = data.vmessages().v;
+			done(std::move(messages));
+		});
+	});
+}
+
+} // namespace Data
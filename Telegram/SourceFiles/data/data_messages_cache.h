@@ -0,0 +1,26 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class History;
+
+namespace Data {
+
+// The last page of messages of a chat is kept in the (encrypted) cache
+// database, so that the chat can be painted before the server answers.
+void CacheLastMessages(
+	not_null<History*> history,
+	const MTPmessages_Messages &data);
+
+// Users and chats from the cached slice are applied only if they are not
+// loaded yet, 'done' is called on main thread with the cached messages.
+void ReadCachedLastMessages(
+	not_null<History*> history,
+	Fn<void(QVector<MTPMessage>&&)> done);
+
+} // namespace Data
@@ -0,0 +1,148 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_offline_preload.h"
+
+#include "core/application.h"
+#include "core/core_settings.h"
+#include "data/data_session.h"
+#include "data/data_histories.h"
+#include "data/data_photo.h"
+#include "data/data_document.h"
+#include "data/data_file_origin.h"
+#include "dialogs/dialogs_main_list.h"
+#include "dialogs/dialogs_indexed_list.h"
+#include "history/history.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kCheckPeriod = 5 * 60 * crl::time(1000);
+constexpr auto kIdleTimeout = 20 * 60 * crl::time(1000);
+constexpr auto kRoundDuration = 24 * 60 * 60 * crl::time(1000);
+constexpr auto kChatsPerCheck = 10;
+constexpr auto kSmallMediaSize = 512 * 1024;
+
+} // namespace
+
+OfflinePreload::OfflinePreload(not_null<Session*> owner)
+: _owner(owner)
+, _timer([=] { check(); }) {
+	_timer.callEach(kCheckPeriod);
+}
+
+void OfflinePreload::check() {
+	const auto limit = Core::App().settings().offlinePreloadLimit();
+	const auto now = crl::now();
+	if (!limit || now - Core::App().lastNonIdleTime() < kIdleTimeout) {
+		return;
+	} else if (!_roundStarted || now - _roundStarted >= kRoundDuration) {
+		_roundStarted = now;
+		_spent = 0;
+		_preloaded.clear();
+	}
+	if (_spent < limit) {
+		preloadChats();
+	}
+}
+
+void OfflinePreload::preloadChats() {
+	auto left = kChatsPerCheck;
+	for (const auto &row : _owner->chatsList()->indexed()->all()) {
+		const auto history = row->history();
+		if (!history
+			|| !history->unreadCount()
+			|| _preloaded.contains(history)) {
+			continue;
+		}
+		_preloaded.emplace(history);
+		_owner->histories().warmUp(history, crl::guard(this, [=](
+				const MTPmessages_Messages &result) {
+			preloadMedia(history, result);
+		}));
+		if (!--left) {
+			break;
+		}
+	}
+	if (left == kChatsPerCheck) {
+		DEBUG_LOG(("Offline Preload: All unread chats preloaded, "
+			"%1 bytes spent.").arg(_spent));
+	}
+}
+
+void OfflinePreload::preloadMedia(
+		not_null<History*> history,
+		const MTPmessages_Messages &result) {
+	const auto channelId = peerToChannel(history->peer->id);
+	const auto process = [&](const MTPMessage &message) {
+		const auto data = message.match([](const MTPDmessage &data) {
+			return &data;
+		}, [](const auto &) -> const MTPDmessage* {
+			return nullptr;
+		});
+		const auto media = data ? data->vmedia() : nullptr;
+		if (!media) {
+			return true;
+		}
+		const auto origin = FileOrigin(FullMsgId(channelId, data->vid().v));
+		return media->match([&](const MTPDmessageMediaPhoto &data) {
+			const auto photo = data.vphoto()
+				? _owner->processPhoto(*data.vphoto()).get()
+				: nullptr;
+			if (!photo || photo->isNull()) {
+				return true;
+			} else if (!spend(photo->imageByteSize(PhotoSize::Large))) {
+				return false;
+			}
+			photo->prefetch(PhotoSize::Large, origin);
+			return true;
+		}, [&](const MTPDmessageMediaDocument &data) {
+			const auto document = data.vdocument()
+				? _owner->processDocument(*data.vdocument()).get()
+				: nullptr;
+			if (!document || document->isNull()) {
+				return true;
+			} else if (document->hasThumbnail()) {
+				if (!spend(document->thumbnailByteSize())) {
+					return false;
+				}
+				document->prefetchThumbnail(origin);
+			}
+			const auto small = (document->isVoiceMessage()
+				|| document->sticker())
+				&& (document->size <= kSmallMediaSize);
+			if (small && !document->loadedInMediaCache()) {
+				if (!spend(document->size)) {
+					return false;
+				}
+				document->save(origin, QString(), LoadFromCloudOrLocal, true);
+			}
+			return true;
+		}, [](const auto &) {
+			return true;
+		});
+	};
+	result.match([](const MTPDmessages_messagesNotModified &) {
+	}, [&](const auto &data) {
+		for (const auto &message : data.vmessages().v) {
+			if (!process(message)) {
+				break;
+			}
+		}
+	});
+}
+
+bool OfflinePreload::spend(int64 bytes) {
+	const auto limit = Core::App().settings().offlinePreloadLimit();
+	if (_spent + bytes > limit) {
+		return false;
+	}
+	_spent += bytes;
+	return true;
+}
+
+} // namespace Data
@@ -0,0 +1,42 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+#include "base/weak_ptr.h"
+
+class History;
+
+namespace Data {
+
+class Session;
+
+// While the app is idle for a long time the last pages of unread chats
+// are put to the messages cache together with their thumbnails and
+// small media, within Core::Settings::offlinePreloadLimit() a day.
+class OfflinePreload final : public base::has_weak_ptr {
+public:
+	explicit OfflinePreload(not_null<Session*> owner);
+
+private:
+	void check();
+	void preloadChats();
+	void preloadMedia(
+		not_null<History*> history,
+		const MTPmessages_Messages &result);
+	[[nodiscard]] bool spend(int64 bytes);
+
+	const not_null<Session*> _owner;
+	base::Timer _timer;
+	base::flat_set<not_null<History*>> _preloaded;
+	crl::time _roundStarted = 0;
+	int64 _spent = 0;
+
+};
+
+} // namespace Data
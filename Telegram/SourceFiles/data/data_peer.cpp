@@ -47,9 +47,80 @@ namespace {
 
 constexpr auto kUpdateFullPeerTimeout = crl::time(5000); // Not more than once in 5 seconds.
 constexpr auto kUserpicSize = 160;
+constexpr auto kEmptyUserpicsCacheLimit = 512;
 
 using UpdateFlag = Data::PeerUpdate::Flag;
 
+// Peers without a photo are painted a lot in the chats list, members lists
+// and autocomplete, always at the same few sizes. Drawing the ellipse and
+// shaping the letters each time is much slower than blitting a pixmap.
+class EmptyUserpicsCache final {
+public:
+	[[nodiscard]] const QPixmap &lookup(
+		not_null<Ui::EmptyUserpic*> userpic,
+		int size);
+
+private:
+	// Background key, letters key, foreground color, size.
+	using Key = std::tuple<uint64, uint64, uint32, int>;
+	struct Entry {
+		QPixmap pixmap;
+		uint64 lastUsed = 0;
+	};
+
+	void prune();
+
+	base::flat_map<Key, Entry> _entries;
+	uint64 _counter = 0;
+
+};
+
+const QPixmap &EmptyUserpicsCache::lookup(
+		not_null<Ui::EmptyUserpic*> userpic,
+		int size) {
+	const auto [background, letters] = userpic->uniqueKey();
+	const auto key = Key{
+		background,
+		letters,
+		anim::getPremultiplied(st::historyPeerUserpicFg->c),
+		size,
+	};
+	auto i = _entries.find(key);
+	if (i == end(_entries)) {
+		if (_entries.size() >= kEmptyUserpicsCacheLimit) {
+			prune();
+		}
+		i = _entries.emplace(key, Entry{ userpic->generate(size) }).first;
+	}
+	i->second.lastUsed = ++_counter;
+	return i->second.pixmap;
+}
+
+void EmptyUserpicsCache::prune() {
+	// Drop the least recently used half at once.
+	auto used = ranges::views::values(
+		_entries
+	) | ranges::views::transform(&Entry::lastUsed) | ranges::to_vector;
+	const auto middle = begin(used) + used.size() / 2;
+	ranges::nth_element(used, middle);
+	const auto threshold = *middle;
+	for (auto i = begin(_entries); i != end(_entries);) {
+		if (i->second.lastUsed < threshold) {
+			i = _entries.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+// Pixmaps can't be destroyed after the QGuiApplication is gone.
+NeverFreedPointer<EmptyUserpicsCache> EmptyUserpicsCacheInstance;
+
+[[nodiscard]] EmptyUserpicsCache &EmptyUserpics() {
+	EmptyUserpicsCacheInstance.createIfNull();
+	return *EmptyUserpicsCacheInstance;
+}
+
 } // namespace
 
 namespace Data {
@@ -319,7 +390,7 @@ void PeerData::paintUserpic(
 	if (const auto userpic = currentUserpic(view)) {
 		p.drawPixmap(x, y, userpic->pixCircled(size, size));
 	} else {
-		ensureEmptyUserpic()->paint(p, x, y, x + size + x, size);
+		p.drawPixmap(x, y, EmptyUserpics().lookup(ensureEmptyUserpic(), size));
 	}
 }
 
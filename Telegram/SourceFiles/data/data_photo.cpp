@@ -277,6 +277,19 @@ void PhotoData::load(
 		Data::FileOrigin origin,
 		LoadFromCloudSetting fromCloud,
 		bool autoLoading) {
+	load(size, origin, fromCloud, autoLoading, false);
+}
+
+void PhotoData::prefetch(PhotoSize size, Data::FileOrigin origin) {
+	load(size, origin, LoadFromCloudOrLocal, true, true);
+}
+
+void PhotoData::load(
+		PhotoSize size,
+		Data::FileOrigin origin,
+		LoadFromCloudSetting fromCloud,
+		bool autoLoading,
+		bool prefetch) {
 	const auto valid = validSizeIndex(size);
 	const auto existing = existingSizeIndex(size);
 
@@ -335,7 +348,8 @@ void PhotoData::load(
 		done,
 		fail,
 		progress,
-		_images[existing].progressivePartSize);
+		_images[existing].progressivePartSize,
+		prefetch);
 
 	if (size == PhotoSize::Large) {
 		_owner->notifyPhotoLayoutChanged(this);
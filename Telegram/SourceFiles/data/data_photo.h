@@ -118,6 +118,7 @@ public:
 		Data::FileOrigin origin,
 		LoadFromCloudSetting fromCloud = LoadFromCloudOrLocal,
 		bool autoLoading = false);
+	void prefetch(Data::PhotoSize size, Data::FileOrigin origin);
 	[[nodiscard]] const ImageLocation &location(Data::PhotoSize size) const;
 	[[nodiscard]] std::optional<QSize> size(Data::PhotoSize size) const;
 	[[nodiscard]] int imageByteSize(Data::PhotoSize size) const;
@@ -159,6 +160,13 @@ public:
 	std::unique_ptr<Data::UploadState> uploadingData;
 
 private:
+	void load(
+		Data::PhotoSize size,
+		Data::FileOrigin origin,
+		LoadFromCloudSetting fromCloud,
+		bool autoLoading,
+		bool prefetch);
+
 	QByteArray _inlineThumbnailBytes;
 	std::array<Data::CloudFile, Data::kPhotoSizeCount> _images;
 	Data::CloudFile _video;
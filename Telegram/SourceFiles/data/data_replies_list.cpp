@@ -23,6 +23,7 @@ namespace Data {
 namespace {
 
 constexpr auto kMessagesPerPage = 50;
+constexpr auto kPreloadMessagesCount = kMessagesPerPage / 2;
 
 [[nodiscard]] HistoryService *GenerateDivider(
 		not_null<History*> history,
@@ -50,6 +51,28 @@ struct RepliesList::Viewer {
 RepliesList::RepliesList(not_null<History*> history, MsgId rootId)
 : _history(history)
 , _rootId(rootId) {
+	// The list is kept consistent even while nobody views it, because
+	// Histories keeps recently viewed lists alive for quick reopening.
+	_history->session().changes().messageUpdates(
+		MessageUpdate::Flag::NewAdded
+		| MessageUpdate::Flag::NewMaybeAdded
+		| MessageUpdate::Flag::Destroyed
+	) | rpl::filter([=](const MessageUpdate &update) {
+		return applyUpdate(update);
+	}) | rpl::start_with_next([=] {
+		_partLoaded.fire({});
+	}, _lifetime);
+
+	_history->owner().channelDifferenceTooLong(
+	) | rpl::filter([=](not_null<ChannelData*> channel) {
+		if (_history->peer != channel || !_skippedAfter.has_value()) {
+			return false;
+		}
+		_skippedAfter = std::nullopt;
+		return true;
+	}) | rpl::start_with_next([=] {
+		_partLoaded.fire({});
+	}, _lifetime);
 }
 
 RepliesList::~RepliesList() {
@@ -86,11 +109,9 @@ rpl::producer<MessagesSlice> RepliesList::source(
 		viewer->limitAfter = limitAfter;
 
 		_history->session().changes().messageUpdates(
-			MessageUpdate::Flag::NewAdded
-			| MessageUpdate::Flag::NewMaybeAdded
-			| MessageUpdate::Flag::Destroyed
+			MessageUpdate::Flag::Destroyed
 		) | rpl::filter([=](const MessageUpdate &update) {
-			return applyUpdate(viewer, update);
+			return rootDestroyed(viewer, update);
 		}) | rpl::start_with_next(pushDelayed, lifetime);
 
 		_history->session().changes().historyUpdates(
@@ -101,15 +122,6 @@ rpl::producer<MessagesSlice> RepliesList::source(
 		_partLoaded.events(
 		) | rpl::start_with_next(pushDelayed, lifetime);
 
-		_history->owner().channelDifferenceTooLong(
-		) | rpl::filter([=](not_null<ChannelData*> channel) {
-			if (_history->peer != channel || !_skippedAfter.has_value()) {
-				return false;
-			}
-			_skippedAfter = std::nullopt;
-			return true;
-		}) | rpl::start_with_next(pushDelayed, lifetime);
-
 		push();
 		return lifetime;
 	};
@@ -356,32 +368,40 @@ bool RepliesList::buildFromData(not_null<Viewer*> viewer) {
 
 	injectRootMessageAndReverse(viewer);
 
-	if (_skippedBefore != 0 && useBefore < viewer->limitBefore + 1) {
+	// Prefetch in the direction the viewer is moving to, before it
+	// reaches the end of the loaded window.
+	if (_skippedBefore != 0
+		&& availableBefore - useBefore < kPreloadMessagesCount) {
 		loadBefore();
 	}
-	if (_skippedAfter != 0 && useAfter < viewer->limitAfter) {
+	if (_skippedAfter != 0
+		&& availableAfter - useAfter < kPreloadMessagesCount) {
 		loadAfter();
 	}
 
 	return true;
 }
 
-bool RepliesList::applyUpdate(
+bool RepliesList::rootDestroyed(
 		not_null<Viewer*> viewer,
-		const MessageUpdate &update) {
+		const MessageUpdate &update) const {
 	if (update.item->history() != _history
 		|| !IsServerMsgId(update.item->id)) {
 		return false;
 	}
-	if (update.flags & MessageUpdate::Flag::Destroyed) {
-		const auto id = update.item->fullId();
-		for (auto i = 0; i != viewer->injectedForRoot; ++i) {
-			if (viewer->slice.ids[i] == id) {
-				return true;
-			}
+	const auto id = update.item->fullId();
+	for (auto i = 0; i != viewer->injectedForRoot; ++i) {
+		if (viewer->slice.ids[i] == id) {
+			return true;
 		}
 	}
-	if (update.item->replyToTop() != _rootId) {
+	return false;
+}
+
+bool RepliesList::applyUpdate(const MessageUpdate &update) {
+	if (update.item->history() != _history
+		|| !IsServerMsgId(update.item->id)
+		|| update.item->replyToTop() != _rootId) {
 		return false;
 	}
 	const auto id = update.item->id;
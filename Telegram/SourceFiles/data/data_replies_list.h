@@ -24,6 +24,13 @@ public:
 	RepliesList(not_null<History*> history, MsgId rootId);
 	~RepliesList();
 
+	[[nodiscard]] not_null<History*> history() const {
+		return _history;
+	}
+	[[nodiscard]] MsgId rootId() const {
+		return _rootId;
+	}
+
 	[[nodiscard]] rpl::producer<MessagesSlice> source(
 		MessagePosition aroundId,
 		int limitBefore,
@@ -49,9 +56,10 @@ private:
 	void appendLocalMessages(MessagesSlice &slice);
 
 	[[nodiscard]] bool buildFromData(not_null<Viewer*> viewer);
-	[[nodiscard]] bool applyUpdate(
+	[[nodiscard]] bool applyUpdate(const MessageUpdate &update);
+	[[nodiscard]] bool rootDestroyed(
 		not_null<Viewer*> viewer,
-		const MessageUpdate &update);
+		const MessageUpdate &update) const;
 	void injectRootMessageAndReverse(not_null<Viewer*> viewer);
 	void injectRootMessage(not_null<Viewer*> viewer);
 	void injectRootDivider(
@@ -75,6 +83,8 @@ private:
 	int _beforeId = 0;
 	int _afterId = 0;
 
+	rpl::lifetime _lifetime;
+
 };
 
 } // namespace Data
@@ -12,6 +12,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_send_action.h"
 
 namespace Data {
+namespace {
+
+// Typing rows don't need the full frame rate, cap their repaints.
+constexpr auto kAnimationFrameDuration = crl::time(33);
+
+} // namespace
 
 SendActionManager::SendActionManager()
 : _animation([=](crl::time now) { return callback(now); }) {
@@ -115,6 +121,12 @@ void SendActionManager::repliesPaintersClear(
 }
 
 bool SendActionManager::callback(crl::time now) {
+	if (_lastAnimationFrame
+		&& now >= _lastAnimationFrame
+		&& now < _lastAnimationFrame + kAnimationFrameDuration) {
+		return true;
+	}
+	_lastAnimationFrame = now;
 	for (auto i = begin(_sendActions); i != end(_sendActions);) {
 		const auto sendAction = lookupPainter(
 			i->first.first,
@@ -125,7 +137,11 @@ bool SendActionManager::callback(crl::time now) {
 			i = _sendActions.erase(i);
 		}
 	}
-	return !_sendActions.empty();
+	if (_sendActions.empty()) {
+		_lastAnimationFrame = 0;
+		return false;
+	}
+	return true;
 }
 
 auto SendActionManager::animationUpdated() const
@@ -148,6 +164,7 @@ void SendActionManager::updateSpeakingAnimation(not_null<History*> history) {
 
 void SendActionManager::clear() {
 	_sendActions.clear();
+	_lastAnimationFrame = 0;
 }
 
 } // namespace Data
@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/mime_type.h" // Core::IsMimeSticker
 #include "core/crash_reports.h" // CrashReports::SetAnnotation
+#include "core/memory_accounting.h"
 #include "ui/image/image.h"
 #include "ui/image/image_location_factory.h" // Images::FromPhotoSize
 #include "ui/text/format_values.h" // Ui::FormatPhone
@@ -58,6 +59,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_streaming.h"
 #include "data/data_media_rotation.h"
 #include "data/data_histories.h"
+#include "data/data_offline_preload.h"
 #include "base/platform/base_platform_info.h"
 #include "base/unixtime.h"
 #include "base/call_delayed.h"
@@ -66,10 +68,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "app.h"
 #include "styles/style_boxes.h" // st::backgroundSize
 
+#include <xxhash.h>
+
 namespace Data {
 namespace {
 
 constexpr auto kMaxNotifyCheckDelay = 24 * 3600 * crl::time(1000);
+constexpr auto kWebPagePreviewLifetime = 10 * 60 * crl::time(1000);
+constexpr auto kWebPagePreviewsLimit = 256;
 
 using ViewElement = HistoryView::Element;
 
@@ -212,8 +218,102 @@ std::vector<UnavailableReason> ExtractUnavailableReasons(
 			double(std::numeric_limits<int>::max())));
 }
 
+// Points closer than a couple of map pixels share one thumbnail, so that
+// slightly moving live locations don't request a new map each time.
+[[nodiscard]] std::pair<int64, int64> LocationCell(
+		const GeoPointLocation &location) {
+	constexpr auto kCellPixels = 2.;
+	constexpr auto kTilePixels = 256.;
+	const auto step = kCellPixels
+		* 360.
+		/ (kTilePixels * std::pow(2., location.zoom));
+	return {
+		int64(std::floor(location.lat / step)),
+		int64(std::floor(location.lon / step)),
+	};
+}
+
+constexpr auto kProcessStatsLogEach = 100;
+
+enum class ProcessKind {
+	Users,
+	Chats,
+	Messages,
+};
+
+struct ProcessStats {
+	bool enabled = false;
+	int calls = 0;
+	std::array<int, 3> objects = { { 0 } };
+	std::array<int, 3> skipped = { { 0 } };
+	std::array<crl::profile_time, 3> durations = { { 0 } };
+};
+
+ProcessStats GlobalProcessStats;
+
+void AddProcessDuration(
+		ProcessKind kind,
+		int objects,
+		crl::profile_time duration) {
+	auto &stats = GlobalProcessStats;
+	stats.objects[int(kind)] += objects;
+	stats.durations[int(kind)] += duration;
+	if (++stats.calls < kProcessStatsLogEach) {
+		return;
+	}
+	const auto part = [&](ProcessKind kind) {
+		return QString("%1 (%2 unchanged) in %3us"
+		).arg(stats.objects[int(kind)]
+		).arg(stats.skipped[int(kind)]
+		).arg(stats.durations[int(kind)]);
+	};
+	LOG(("Data Process: %1 calls, users %2, chats %3, messages %4."
+		).arg(stats.calls
+		).arg(part(ProcessKind::Users)
+		).arg(part(ProcessKind::Chats)
+		).arg(part(ProcessKind::Messages)));
+	stats.calls = 0;
+	stats.objects = {};
+	stats.skipped = {};
+	stats.durations = {};
+}
+
+void AddProcessSkipped(ProcessKind kind) {
+	if (GlobalProcessStats.enabled) {
+		++GlobalProcessStats.skipped[int(kind)];
+	}
+}
+
+template <typename MTPData>
+[[nodiscard]] uint64 ProcessedHash(const MTPData &data) {
+	auto buffer = mtpBuffer();
+	data.write(buffer);
+	return XXH64(buffer.data(), buffer.size() * sizeof(mtpPrime), 0);
+}
+
+[[nodiscard]] auto MeasureProcess(ProcessKind kind, int objects) {
+	const auto started = GlobalProcessStats.enabled
+		? crl::profile()
+		: crl::profile_time(0);
+	return gsl::finally([=] {
+		if (GlobalProcessStats.enabled) {
+			AddProcessDuration(kind, objects, crl::profile() - started);
+		}
+	});
+}
+
 } // namespace
 
+bool ToggleProcessStats() {
+	auto &stats = GlobalProcessStats;
+	stats.enabled = !stats.enabled;
+	stats.calls = 0;
+	stats.objects = {};
+	stats.skipped = {};
+	stats.durations = {};
+	return stats.enabled;
+}
+
 Session::Session(not_null<Main::Session*> session)
 : _session(session)
 , _cache(Core::App().databases().get(
@@ -241,7 +341,9 @@ Session::Session(not_null<Main::Session*> session)
 , _mediaRotation(std::make_unique<MediaRotation>())
 , _histories(std::make_unique<Histories>(this))
 , _stickers(std::make_unique<Stickers>(this))
-, _sponsoredMessages(std::make_unique<SponsoredMessages>(this)) {
+, _sponsoredMessages(std::make_unique<SponsoredMessages>(this))
+, _offlinePreload(std::make_unique<OfflinePreload>(this))
+, _cloudFileLoads(std::make_unique<CloudFileLoads>()) {
 	_cache->open(_session->local().cacheKey());
 	_bigFileCache->open(_session->local().cacheBigFileKey());
 
@@ -257,6 +359,8 @@ Session::Session(not_null<Main::Session*> session)
 	setupChannelLeavingViewer();
 	setupPeerNameViewer();
 	setupUserIsContactViewer();
+	setupProcessedPeersViewer();
+	setupMemoryAccounting();
 
 	_chatsList.unreadStateChanges(
 	) | rpl::start_with_next([=] {
@@ -285,7 +389,6 @@ void Session::clear() {
 	_sponsoredMessages = nullptr;
 	_dependentMessages.clear();
 	base::take(_messages);
-	base::take(_channelMessages);
 	_messageByRandomId.clear();
 	_sentMessagesData.clear();
 	cSetRecentInlineBots(RecentInlineBots());
@@ -293,6 +396,7 @@ void Session::clear() {
 	App::clearMousedItems();
 	_histories->clearAll();
 	_webpages.clear();
+	_locationCells.clear();
 	_locations.clear();
 	_polls.clear();
 	_games.clear();
@@ -379,6 +483,11 @@ not_null<UserData*> Session::processUser(const MTPUser &data) {
 	const auto result = user(data.match([](const auto &data) {
 		return data.vid().v;
 	}));
+	const auto hash = ProcessedHash(data);
+	if (!processedPeerChanged(result, hash)) {
+		AddProcessSkipped(ProcessKind::Users);
+		return result;
+	}
 	auto minimal = false;
 	const MTPUserStatus *status = nullptr;
 	const MTPUserStatus emptyStatus = MTP_userStatusEmpty();
@@ -575,6 +684,7 @@ not_null<UserData*> Session::processUser(const MTPUser &data) {
 	if (flags) {
 		session().changes().peerUpdated(result, flags);
 	}
+	_processedPeerHashes[result] = hash;
 	return result;
 }
 
@@ -590,6 +700,11 @@ not_null<PeerData*> Session::processChat(const MTPChat &data) {
 	}, [&](const MTPDchannelForbidden &data) {
 		return peer(peerFromChannel(data.vid().v));
 	});
+	const auto hash = ProcessedHash(data);
+	if (!processedPeerChanged(result, hash)) {
+		AddProcessSkipped(ProcessKind::Chats);
+		return result;
+	}
 	auto minimal = false;
 
 	using UpdateFlag = Data::PeerUpdate::Flag;
@@ -831,10 +946,19 @@ not_null<PeerData*> Session::processChat(const MTPChat &data) {
 	if (flags) {
 		session().changes().peerUpdated(result, flags);
 	}
+	_processedPeerHashes[result] = hash;
 	return result;
 }
 
+bool Session::processedPeerChanged(
+		not_null<PeerData*> peer,
+		uint64 hash) const {
+	const auto i = _processedPeerHashes.find(peer);
+	return (i == end(_processedPeerHashes)) || (i->second != hash);
+}
+
 UserData *Session::processUsers(const MTPVector<MTPUser> &data) {
+	const auto measure = MeasureProcess(ProcessKind::Users, data.v.size());
 	auto result = (UserData*)nullptr;
 	for (const auto &user : data.v) {
 		result = processUser(user);
@@ -843,6 +967,7 @@ UserData *Session::processUsers(const MTPVector<MTPUser> &data) {
 }
 
 PeerData *Session::processChats(const MTPVector<MTPChat> &data) {
+	const auto measure = MeasureProcess(ProcessKind::Chats, data.v.size());
 	auto result = (PeerData*)nullptr;
 	for (const auto &chat : data.v) {
 		result = processChat(chat);
@@ -1159,6 +1284,72 @@ void Session::setupPeerNameViewer() {
 	}, _lifetime);
 }
 
+void Session::setupMemoryAccounting() {
+	using namespace Core::MemoryAccounting;
+	const auto ids = std::array{
+		Register(u"Messages"_q, [=] {
+			auto result = int64(0);
+			for (const auto &[peerId, peer] : _peers) {
+				if (const auto history = historyLoaded(peer.get())) {
+					result += history->memoryStats().bytes;
+				}
+			}
+			return result;
+		}),
+		Register(u"Peers"_q, [=] {
+			auto result = int64(0);
+			for (const auto &[peerId, peer] : _peers) {
+				result += peer->isUser()
+					? sizeof(UserData)
+					: peer->isChat()
+					? sizeof(ChatData)
+					: sizeof(ChannelData);
+			}
+			return result;
+		}),
+		Register(u"Photos, documents and web pages"_q, [=] {
+			return int64(_photos.size()) * sizeof(PhotoData)
+				+ int64(_documents.size()) * sizeof(DocumentData)
+				+ int64(_webpages.size()) * sizeof(WebPageData);
+		}),
+	};
+	_lifetime.add([=] {
+		for (const auto id : ids) {
+			Unregister(id);
+		}
+	});
+}
+
+void Session::setupProcessedPeersViewer() {
+	// Any change of the fields that processUser / processChat write
+	// makes the next application of an unchanged MTPUser / MTPChat
+	// meaningful again, so it should not be skipped.
+	using Flag = PeerUpdate::Flag;
+	for (const auto flag : {
+		Flag::Name,
+		Flag::Username,
+		Flag::Photo,
+		Flag::Migration,
+		Flag::UnavailableReason,
+		Flag::CanShareContact,
+		Flag::IsContact,
+		Flag::PhoneNumber,
+		Flag::OnlineStatus,
+		Flag::BotCanBeInvited,
+		Flag::IsBot,
+		Flag::Members,
+		Flag::Rights,
+		Flag::ChannelAmIn,
+		Flag::GroupCall,
+	}) {
+		session().changes().realtimePeerUpdates(
+			flag
+		) | rpl::start_with_next([=](const PeerUpdate &update) {
+			_processedPeerHashes.erase(update.peer);
+		}, _lifetime);
+	}
+}
+
 void Session::setupUserIsContactViewer() {
 	session().changes().peerUpdates(
 		PeerUpdate::Flag::IsContact
@@ -1203,15 +1394,35 @@ void Session::enumerateItemViews(
 }
 
 void Session::photoLoadSettingsChanged() {
-	for (const auto &[id, photo] : _photos) {
+	_photos.forEach([](
+			PhotoId id,
+			const std::unique_ptr<PhotoData> &photo) {
 		photo->automaticLoadSettingsChanged();
-	}
+	});
 }
 
 void Session::documentLoadSettingsChanged() {
-	for (const auto &[id, document] : _documents) {
+	_documents.forEach([](
+			DocumentId id,
+			const std::unique_ptr<DocumentData> &document) {
 		document->automaticLoadSettingsChanged();
-	}
+	});
+}
+
+auto Session::downloadedDocuments() const
+-> base::flat_map<DocumentId, QString> {
+	auto result = base::flat_map<DocumentId, QString>();
+	_documents.forEach([&](
+			DocumentId id,
+			const std::unique_ptr<DocumentData> &document) {
+		const auto &location = document->location();
+		if (!location.isEmpty()
+			&& !location.inMediaCache()
+			&& location.size == document->size) {
+			result.emplace(id, location.name());
+		}
+	});
+	return result;
 }
 
 void Session::notifyPhotoLayoutChanged(not_null<const PhotoData*> photo) {
@@ -1334,12 +1545,11 @@ rpl::producer<not_null<HistoryItem*>> Session::newItemAdded() const {
 }
 
 void Session::changeMessageId(ChannelId channel, MsgId wasId, MsgId nowId) {
-	const auto list = messagesListForInsert(channel);
-	auto i = list->find(wasId);
-	Assert(i != list->end());
-	auto owned = std::move(i->second);
-	list->erase(i);
-	const auto [j, ok] = list->emplace(nowId, std::move(owned));
+	auto owned = _messages.take({ channel, wasId });
+	Assert(owned.has_value());
+	const auto [j, ok] = _messages.emplace(
+		{ channel, nowId },
+		std::move(*owned));
 
 	Ensures(ok);
 }
@@ -1575,6 +1785,24 @@ void Session::unloadHeavyViewParts(
 	}
 }
 
+void Session::unloadHeavyViewParts(
+		not_null<HistoryView::ElementDelegate*> delegate,
+		const std::vector<not_null<History*>> &keep) {
+	if (_heavyViewParts.empty()) {
+		return;
+	}
+	auto remove = std::vector<not_null<ViewElement*>>();
+	for (const auto &view : _heavyViewParts) {
+		if (view->delegate() == delegate
+			&& !ranges::contains(keep, view->history())) {
+			remove.push_back(view);
+		}
+	}
+	for (const auto view : remove) {
+		view->unloadHeavyPart();
+	}
+}
+
 void Session::removeMegagroupParticipant(
 		not_null<ChannelData*> channel,
 		not_null<UserData*> user) {
@@ -1836,6 +2064,7 @@ void Session::updateEditedMessage(const MTPMessage &data) {
 void Session::processMessages(
 		const QVector<MTPMessage> &data,
 		NewMessageType type) {
+	const auto measure = MeasureProcess(ProcessKind::Messages, data.size());
 	auto indices = base::flat_map<uint64, int>();
 	for (int i = 0, l = data.size(); i != l; ++i) {
 		const auto &message = data[i];
@@ -1884,30 +2113,13 @@ void Session::processExistingMessages(
 	});
 }
 
-const Session::Messages *Session::messagesList(ChannelId channelId) const {
-	if (channelId == NoChannel) {
-		return &_messages;
-	}
-	const auto i = _channelMessages.find(channelId);
-	return (i != end(_channelMessages)) ? &i->second : nullptr;
-}
-
-auto Session::messagesListForInsert(ChannelId channelId)
--> not_null<Messages*> {
-	return (channelId == NoChannel)
-		? &_messages
-		: &_channelMessages[channelId];
-}
-
 void Session::registerMessage(not_null<HistoryItem*> item) {
-	const auto list = messagesListForInsert(item->channelId());
-	const auto itemId = item->id;
-	const auto i = list->find(itemId);
-	if (i != list->end()) {
+	const auto key = FullMsgId(item->channelId(), item->id);
+	if (const auto existing = _messages.find(key)) {
 		LOG(("App Error: Trying to re-registerMessage()."));
-		i->second->destroy();
+		(*existing)->destroy();
 	}
-	list->emplace(itemId, item);
+	_messages.emplace(key, item.get());
 }
 
 void Session::registerMessageTTL(TimeId when, not_null<HistoryItem*> item) {
@@ -1964,20 +2176,15 @@ void Session::checkTTLs() {
 void Session::processMessagesDeleted(
 		ChannelId channelId,
 		const QVector<MTPint> &data) {
-	const auto list = messagesList(channelId);
 	const auto affected = (channelId != NoChannel)
 		? historyLoaded(peerFromChannel(channelId))
 		: nullptr;
-	if (!list && !affected) {
-		return;
-	}
 
 	auto historiesToCheck = base::flat_set<not_null<History*>>();
 	for (const auto &messageId : data) {
-		const auto i = list ? list->find(messageId.v) : Messages::iterator();
-		if (list && i != list->end()) {
-			const auto history = i->second->history();
-			i->second->destroy();
+		if (const auto item = message(channelId, messageId.v)) {
+			const auto history = item->history();
+			item->destroy();
 			if (!history->chatListMessageKnown()) {
 				historiesToCheck.emplace(history);
 			}
@@ -2011,7 +2218,7 @@ void Session::unregisterMessage(not_null<HistoryItem*> item) {
 		Data::MessageUpdate::Flag::Destroyed);
 	groups().unregisterMessage(item);
 	removeDependencyMessage(item);
-	messagesListForInsert(peerToChannel(peerId))->erase(item->id);
+	_messages.erase({ peerToChannel(peerId), item->id });
 }
 
 MsgId Session::nextLocalMessageId() {
@@ -2039,13 +2246,8 @@ HistoryItem *Session::message(ChannelId channelId, MsgId itemId) const {
 		return nullptr;
 	}
 
-	const auto data = messagesList(channelId);
-	if (!data) {
-		return nullptr;
-	}
-
-	const auto i = data->find(itemId);
-	return (i != data->end()) ? i->second.get() : nullptr;
+	const auto i = _messages.find({ channelId, itemId });
+	return i ? *i : nullptr;
 }
 
 HistoryItem *Session::message(
@@ -2329,12 +2531,12 @@ void Session::checkSelfDestructItems() {
 
 not_null<PhotoData*> Session::photo(PhotoId id) {
 	auto i = _photos.find(id);
-	if (i == _photos.end()) {
+	if (!i) {
 		i = _photos.emplace(
 			id,
 			std::make_unique<PhotoData>(this, id)).first;
 	}
-	return i->second.get();
+	return i->get();
 }
 
 not_null<PhotoData*> Session::processPhoto(const MTPPhoto &data) {
@@ -2438,13 +2640,10 @@ void Session::photoConvert(
 	});
 	const auto idChanged = (original->id != id);
 	if (idChanged) {
-		auto i = _photos.find(id);
-		if (i == _photos.end()) {
-			const auto j = _photos.find(original->id);
-			Assert(j != _photos.end());
-			auto owned = std::move(j->second);
-			_photos.erase(j);
-			i = _photos.emplace(id, std::move(owned)).first;
+		if (!_photos.contains(id)) {
+			auto owned = _photos.take(original->id);
+			Assert(owned.has_value());
+			_photos.emplace(id, std::move(*owned));
 		}
 
 		original->id = id;
@@ -2605,12 +2804,17 @@ void Session::photoApplyFields(
 
 not_null<DocumentData*> Session::document(DocumentId id) {
 	auto i = _documents.find(id);
-	if (i == _documents.cend()) {
+	if (!i) {
 		i = _documents.emplace(
 			id,
 			std::make_unique<DocumentData>(this, id)).first;
 	}
-	return i->second.get();
+	return i->get();
+}
+
+DocumentData *Session::documentLoaded(DocumentId id) const {
+	const auto i = _documents.find(id);
+	return (i && (*i)->date) ? i->get() : nullptr;
 }
 
 not_null<DocumentData*> Session::processDocument(const MTPDocument &data) {
@@ -2686,13 +2890,10 @@ void Session::documentConvert(
 	const auto oldGoodKey = original->goodThumbnailCacheKey();
 	const auto idChanged = (original->id != id);
 	if (idChanged) {
-		auto i = _documents.find(id);
-		if (i == _documents.end()) {
-			const auto j = _documents.find(original->id);
-			Assert(j != _documents.end());
-			auto owned = std::move(j->second);
-			_documents.erase(j);
-			i = _documents.emplace(id, std::move(owned)).first;
+		if (!_documents.contains(id)) {
+			auto owned = _documents.take(original->id);
+			Assert(owned.has_value());
+			_documents.emplace(id, std::move(*owned));
 		}
 
 		original->id = id;
@@ -2835,12 +3036,12 @@ void Session::documentApplyFields(
 
 not_null<WebPageData*> Session::webpage(WebPageId id) {
 	auto i = _webpages.find(id);
-	if (i == _webpages.cend()) {
+	if (!i) {
 		i = _webpages.emplace(
 			id,
 			std::make_unique<WebPageData>(this, id)).first;
 	}
-	return i->second.get();
+	return i->get();
 }
 
 not_null<WebPageData*> Session::processWebpage(const MTPWebPage &data) {
@@ -3038,6 +3239,37 @@ void Session::webpageApplyFields(
 	}
 }
 
+std::optional<WebPageId> Session::webpagePreview(
+		const QString &links) const {
+	const auto i = _webpagePreviews.find(links);
+	if (i == end(_webpagePreviews)
+		|| (i->second.received + kWebPagePreviewLifetime <= crl::now())) {
+		return std::nullopt;
+	}
+	return i->second.id;
+}
+
+void Session::rememberWebpagePreview(const QString &links, WebPageId id) {
+	const auto now = crl::now();
+	if (!_webpagePreviews.contains(links)
+		&& _webpagePreviews.size() >= kWebPagePreviewsLimit) {
+		for (auto i = begin(_webpagePreviews); i != end(_webpagePreviews);) {
+			if (i->second.received + kWebPagePreviewLifetime <= now) {
+				i = _webpagePreviews.erase(i);
+			} else {
+				++i;
+			}
+		}
+		if (_webpagePreviews.size() >= kWebPagePreviewsLimit) {
+			_webpagePreviews.erase(ranges::min_element(
+				_webpagePreviews,
+				ranges::less(),
+				[](const auto &pair) { return pair.second.received; }));
+		}
+	}
+	_webpagePreviews[links] = WebPagePreview{ .id = id, .received = now };
+}
+
 not_null<GameData*> Session::game(GameId id) {
 	auto i = _games.find(id);
 	if (i == _games.cend()) {
@@ -3254,17 +3486,23 @@ not_null<Data::CloudImage*> Session::location(const LocationPoint &point) {
 		return i->second.get();
 	}
 	const auto location = Data::ComputeLocation(point);
+	const auto cell = LocationCell(location);
+	if (const auto j = _locationCells.find(cell); j != end(_locationCells)) {
+		return j->second;
+	}
 	const auto prepared = ImageWithLocation{
 		.location = ImageLocation(
 			{ location },
 			location.width,
 			location.height)
 	};
-	return _locations.emplace(
+	const auto result = _locations.emplace(
 		point,
 		std::make_unique<Data::CloudImage>(
 			_session,
 			prepared)).first->second.get();
+	_locationCells.emplace(cell, result);
+	return result;
 }
 
 void Session::registerPhotoItem(
@@ -3665,7 +3903,9 @@ not_null<Dialogs::IndexedList*> Session::contactsNoChatsList() {
 	return &_contactsNoChatsList;
 }
 
-void Session::refreshChatListEntry(Dialogs::Key key) {
+void Session::refreshChatListEntry(
+		Dialogs::Key key,
+		ChatFilter::Flags affectedFilters) {
 	Expects(key.entry()->folderKnown());
 
 	using namespace Dialogs;
@@ -3688,6 +3928,11 @@ void Session::refreshChatListEntry(Dialogs::Key key) {
 		return;
 	}
 	for (const auto &filter : _chatsFilters->list()) {
+		if (!creating
+			&& affectedFilters
+			&& !(filter.flags() & affectedFilters)) {
+			continue;
+		}
 		const auto id = filter.id();
 		const auto filterList = chatsFilters().chatsList(id);
 		auto event = ChatListEntryRefresh{ .key = key, .filterId = id };
@@ -12,8 +12,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "dialogs/dialogs_indexed_list.h"
 #include "dialogs/dialogs_main_list.h"
 #include "data/data_groups.h"
+#include "data/data_chat_filters.h"
 #include "data/data_cloud_file.h"
 #include "data/data_notify_settings.h"
+#include "data/data_flat_hash_map.h"
 #include "history/history_location_manager.h"
 #include "base/timer.h"
 #include "base/flags.h"
@@ -57,6 +59,7 @@ class CloudThemes;
 class Streaming;
 class MediaRotation;
 class Histories;
+class OfflinePreload;
 class DocumentMedia;
 class PhotoMedia;
 class Stickers;
@@ -107,6 +110,9 @@ public:
 	[[nodiscard]] Histories &histories() const {
 		return *_histories;
 	}
+	[[nodiscard]] CloudFileLoads &cloudFileLoads() const {
+		return *_cloudFileLoads;
+	}
 	[[nodiscard]] Stickers &stickers() const {
 		return *_stickers;
 	}
@@ -274,6 +280,9 @@ public:
 		not_null<HistoryView::ElementDelegate*> delegate,
 		int from,
 		int till);
+	void unloadHeavyViewParts(
+		not_null<HistoryView::ElementDelegate*> delegate,
+		const std::vector<not_null<History*>> &keep);
 
 	using MegagroupParticipant = std::tuple<
 		not_null<ChannelData*>,
@@ -383,6 +392,8 @@ public:
 
 	void photoLoadSettingsChanged();
 	void documentLoadSettingsChanged();
+	[[nodiscard]] auto downloadedDocuments() const
+		-> base::flat_map<DocumentId, QString>;
 
 	void notifyPhotoLayoutChanged(not_null<const PhotoData*> photo);
 	void requestPhotoViewRepaint(not_null<const PhotoData*> photo);
@@ -459,6 +470,7 @@ public:
 		const ImageLocation &thumbnailLocation);
 
 	[[nodiscard]] not_null<DocumentData*> document(DocumentId id);
+	[[nodiscard]] DocumentData *documentLoaded(DocumentId id) const;
 	not_null<DocumentData*> processDocument(const MTPDocument &data);
 	not_null<DocumentData*> processDocument(const MTPDdocument &data);
 	not_null<DocumentData*> processDocument(
@@ -507,6 +519,12 @@ public:
 		const QString &author,
 		TimeId pendingTill);
 
+	// Results of messages.getWebPagePreview for the links in the field,
+	// empty WebPageId if the server didn't return any webpage.
+	[[nodiscard]] std::optional<WebPageId> webpagePreview(
+		const QString &links) const;
+	void rememberWebpagePreview(const QString &links, WebPageId id);
+
 	[[nodiscard]] not_null<GameData*> game(GameId id);
 	not_null<GameData*> processGame(const MTPDgame &data);
 	[[nodiscard]] not_null<GameData*> game(
@@ -622,7 +640,9 @@ public:
 			return existenceChanged || (moved.from != moved.to);
 		}
 	};
-	void refreshChatListEntry(Dialogs::Key key);
+	void refreshChatListEntry(
+		Dialogs::Key key,
+		ChatFilter::Flags affectedFilters = ChatFilter::Flags());
 	void removeChatListEntry(Dialogs::Key key);
 	[[nodiscard]] auto chatListEntryRefreshes() const
 		-> rpl::producer<ChatListEntryRefresh>;
@@ -676,7 +696,7 @@ public:
 	void clearLocalStorage();
 
 private:
-	using Messages = std::unordered_map<MsgId, not_null<HistoryItem*>>;
+	using Messages = FlatHashMap<FullMsgId, HistoryItem*, FullMsgIdHash>;
 
 	void suggestStartExport();
 
@@ -684,6 +704,11 @@ private:
 	void setupChannelLeavingViewer();
 	void setupPeerNameViewer();
 	void setupUserIsContactViewer();
+	void setupProcessedPeersViewer();
+	[[nodiscard]] bool processedPeerChanged(
+		not_null<PeerData*> peer,
+		uint64 hash) const;
+	void setupMemoryAccounting();
 
 	void checkSelfDestructItems();
 
@@ -698,8 +723,6 @@ private:
 		Data::Folder *requestFolder,
 		const MTPDdialogFolder &data);
 
-	const Messages *messagesList(ChannelId channelId) const;
-	not_null<Messages*> messagesListForInsert(ChannelId channelId);
 	not_null<HistoryItem*> registerMessage(
 		std::unique_ptr<HistoryItem> item);
 	void changeMessageId(ChannelId channel, MsgId wasId, MsgId nowId);
@@ -853,7 +876,6 @@ private:
 
 	MsgId _localMessageIdCounter = StartClientMsgId;
 	Messages _messages;
-	std::map<ChannelId, Messages> _channelMessages;
 	std::map<
 		not_null<HistoryItem*>,
 		base::flat_set<not_null<HistoryItem*>>> _dependentMessages;
@@ -866,30 +888,32 @@ private:
 	base::Timer _selfDestructTimer;
 	std::vector<FullMsgId> _selfDestructItems;
 
-	std::unordered_map<
-		PhotoId,
-		std::unique_ptr<PhotoData>> _photos;
+	FlatHashMap<PhotoId, std::unique_ptr<PhotoData>> _photos;
 	std::unordered_map<
 		not_null<const PhotoData*>,
 		base::flat_set<not_null<HistoryItem*>>> _photoItems;
-	std::unordered_map<
-		DocumentId,
-		std::unique_ptr<DocumentData>> _documents;
+	FlatHashMap<DocumentId, std::unique_ptr<DocumentData>> _documents;
 	std::unordered_map<
 		not_null<const DocumentData*>,
 		base::flat_set<not_null<HistoryItem*>>> _documentItems;
-	std::unordered_map<
-		WebPageId,
-		std::unique_ptr<WebPageData>> _webpages;
+	FlatHashMap<WebPageId, std::unique_ptr<WebPageData>> _webpages;
 	std::unordered_map<
 		not_null<const WebPageData*>,
 		base::flat_set<not_null<HistoryItem*>>> _webpageItems;
 	std::unordered_map<
 		not_null<const WebPageData*>,
 		base::flat_set<not_null<ViewElement*>>> _webpageViews;
+	struct WebPagePreview {
+		WebPageId id = 0;
+		crl::time received = 0;
+	};
+	base::flat_map<QString, WebPagePreview> _webpagePreviews;
 	std::unordered_map<
 		LocationPoint,
 		std::unique_ptr<Data::CloudImage>> _locations;
+	base::flat_map<
+		std::pair<int64, int64>,
+		not_null<Data::CloudImage*>> _locationCells;
 	std::unordered_map<
 		PollId,
 		std::unique_ptr<PollData>> _polls;
@@ -910,6 +934,10 @@ private:
 		base::flat_set<not_null<ViewElement*>>> _contactViews;
 	std::unordered_set<not_null<HistoryItem*>> _callItems;
 
+	// Hashes of the last applied MTPUser / MTPChat, dropped on any
+	// peer update that could make applying the same data matter again.
+	std::unordered_map<not_null<PeerData*>, uint64> _processedPeerHashes;
+
 	base::flat_set<not_null<WebPageData*>> _webpagesUpdated;
 	base::flat_set<not_null<GameData*>> _gamesUpdated;
 	base::flat_set<not_null<PollData*>> _pollsUpdated;
@@ -968,10 +996,16 @@ private:
 	std::unique_ptr<Histories> _histories;
 	std::unique_ptr<Stickers> _stickers;
 	std::unique_ptr<SponsoredMessages> _sponsoredMessages;
+	std::unique_ptr<OfflinePreload> _offlinePreload;
+	std::unique_ptr<CloudFileLoads> _cloudFileLoads;
 	MsgId _nonHistoryEntryId = ServerMaxMsgId;
 
 	rpl::lifetime _lifetime;
 
 };
 
+// Logs the time spent in processUsers / processChats / processMessages
+// each 100 calls.
+bool ToggleProcessStats();
+
 } // namespace Data
@@ -21,6 +21,10 @@ constexpr auto kDocumentThumbCacheMask = 0x00000000000000FFULL;
 constexpr auto kWebDocumentCacheTag = 0x0000020000000000ULL;
 constexpr auto kUrlCacheTag = 0x0000030000000000ULL;
 constexpr auto kGeoPointCacheTag = 0x0000040000000000ULL;
+constexpr auto kMessagesCacheKeyTag = 0x0000050000000000ULL;
+constexpr auto kFullPeerCacheKeyTag = 0x0000060000000000ULL;
+constexpr auto kThemePreviewCacheKeyTag = 0x0000070000000000ULL;
+constexpr auto kSearchCacheKeyTag = 0x0000080000000000ULL;
 
 } // namespace
 
@@ -86,6 +90,25 @@ Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location) {
 	};
 }
 
+Storage::Cache::Key MessagesCacheKey(PeerId peerId) {
+	return Storage::Cache::Key{ Data::kMessagesCacheKeyTag, peerId.value };
+}
+
+Storage::Cache::Key FullPeerCacheKey(PeerId peerId) {
+	return Storage::Cache::Key{ Data::kFullPeerCacheKeyTag, peerId.value };
+}
+
+Storage::Cache::Key ThemePreviewCacheKey(uint64 hash) {
+	return Storage::Cache::Key{ Data::kThemePreviewCacheKeyTag, hash };
+}
+
+Storage::Cache::Key SearchCacheKey(uint8 kind, uint64 hash) {
+	return Storage::Cache::Key{
+		Data::kSearchCacheKeyTag | uint64(kind),
+		hash,
+	};
+}
+
 } // namespace Data
 
 void MessageCursor::fillFrom(not_null<const Ui::InputField*> field) {
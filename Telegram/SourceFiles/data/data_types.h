@@ -49,12 +49,20 @@ Storage::Cache::Key DocumentThumbCacheKey(int32 dcId, uint64 id);
 Storage::Cache::Key WebDocumentCacheKey(const WebFileLocation &location);
 Storage::Cache::Key UrlCacheKey(const QString &location);
 Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location);
+Storage::Cache::Key MessagesCacheKey(PeerId peerId);
+Storage::Cache::Key FullPeerCacheKey(PeerId peerId);
+Storage::Cache::Key ThemePreviewCacheKey(uint64 hash);
+Storage::Cache::Key SearchCacheKey(uint8 kind, uint64 hash);
 
 constexpr auto kImageCacheTag = uint8(0x01);
 constexpr auto kStickerCacheTag = uint8(0x02);
 constexpr auto kVoiceMessageCacheTag = uint8(0x03);
 constexpr auto kVideoMessageCacheTag = uint8(0x04);
 constexpr auto kAnimationCacheTag = uint8(0x05);
+constexpr auto kMessagesCacheTag = uint8(0x06);
+constexpr auto kFullPeerCacheTag = uint8(0x07);
+constexpr auto kThemePreviewCacheTag = uint8(0x08);
+constexpr auto kSearchCacheTag = uint8(0x09);
 
 struct FileOrigin;
 
@@ -279,6 +287,9 @@ enum class MessageFlag : uint32 {
 
 	// In channels.
 	IsSponsored           = (1U << 29),
+
+	// Text was laid out by some view, parse new text right away.
+	TextValidated         = (1U << 30),
 };
 inline constexpr bool is_flag_type(MessageFlag) { return true; }
 using MessageFlags = base::flags<MessageFlag>;
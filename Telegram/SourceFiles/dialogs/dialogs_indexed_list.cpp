@@ -12,6 +12,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 
 namespace Dialogs {
+namespace {
+
+constexpr auto kPrefixLength = 2;
+
+[[nodiscard]] uint32 PrefixKey(const QString &word) {
+	Expects(word.size() >= kPrefixLength);
+
+	return (uint32(word[0].unicode()) << 16) | uint32(word[1].unicode());
+}
+
+} // namespace
 
 IndexedList::IndexedList(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
@@ -33,6 +44,7 @@ RowsByLetter IndexedList::addToEnd(Key key) {
 		}
 		result.letters.emplace(ch, j->second.addToEnd(key));
 	}
+	addPrefixes(key);
 	return result;
 }
 
@@ -49,6 +61,7 @@ Row *IndexedList::addByName(Key key) {
 		}
 		j->second.addByName(key);
 	}
+	addPrefixes(key);
 	return result;
 }
 
@@ -119,6 +132,8 @@ void IndexedList::adjustByName(
 	const auto mainRow = _list.adjustByName(key);
 	if (!mainRow) return;
 
+	refreshPrefixes(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -156,6 +171,8 @@ void IndexedList::adjustNames(
 	auto mainRow = _list.getRow(key);
 	if (!mainRow) return;
 
+	refreshPrefixes(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -193,15 +210,82 @@ void IndexedList::del(Key key, Row *replacedBy) {
 				it->second.del(key, replacedBy);
 			}
 		}
+		removePrefixes(key);
 	}
 }
 
 void IndexedList::clear() {
 	_index.clear();
+	_prefixes.clear();
+	_prefixesByKey.clear();
+	++_changes;
+}
+
+void IndexedList::addPrefixes(Key key) {
+	++_changes;
+
+	auto prefixes = std::vector<uint32>();
+	for (const auto &word : key.entry()->chatListNameWords()) {
+		if (word.size() >= kPrefixLength) {
+			prefixes.push_back(PrefixKey(word));
+		}
+	}
+	if (prefixes.empty()) {
+		return;
+	}
+	ranges::sort(prefixes);
+	prefixes.erase(ranges::unique(prefixes), end(prefixes));
+	for (const auto prefix : prefixes) {
+		_prefixes[prefix].emplace(key);
+	}
+	_prefixesByKey.emplace_or_assign(key, std::move(prefixes));
+}
+
+void IndexedList::removePrefixes(Key key) {
+	++_changes;
+
+	const auto prefixes = _prefixesByKey.take(key);
+	if (!prefixes) {
+		return;
+	}
+	for (const auto prefix : *prefixes) {
+		const auto i = _prefixes.find(prefix);
+		if (i != end(_prefixes)) {
+			i->second.remove(key);
+			if (i->second.empty()) {
+				_prefixes.erase(i);
+			}
+		}
+	}
+}
+
+void IndexedList::refreshPrefixes(Key key) {
+	removePrefixes(key);
+	addPrefixes(key);
 }
 
 std::vector<not_null<Row*>> IndexedList::filtered(
 		const QStringList &words) const {
+	// Two letters usually cut the candidates by an order of magnitude
+	// compared to the first letter lists, so start from the prefix index.
+	auto prefixWord = (const QString*)nullptr;
+	auto prefixKeys = (const base::flat_set<Key>*)nullptr;
+	for (const auto &word : words) {
+		if (word.size() < kPrefixLength) {
+			continue;
+		}
+		const auto i = _prefixes.find(PrefixKey(word));
+		if (i == end(_prefixes)) {
+			return {};
+		} else if (!prefixKeys || prefixKeys->size() > i->second.size()) {
+			prefixWord = &word;
+			prefixKeys = &i->second;
+		}
+	}
+	if (prefixKeys) {
+		return filteredByPrefix(words, *prefixWord, *prefixKeys);
+	}
+
 	const auto minimal = [&]() -> const Dialogs::List* {
 		if (empty()) {
 			return nullptr;
@@ -226,28 +310,69 @@ std::vector<not_null<Row*>> IndexedList::filtered(
 	}
 	result.reserve(minimal->size());
 	for (const auto &row : *minimal) {
-		const auto &nameWords = row->entry()->chatListNameWords();
-		const auto found = [&](const QString &word) {
-			for (const auto &name : nameWords) {
-				if (name.startsWith(word)) {
-					return true;
-				}
-			}
-			return false;
-		};
-		const auto allFound = [&] {
-			for (const auto &word : words) {
-				if (!found(word)) {
-					return false;
-				}
-			}
-			return true;
-		}();
-		if (allFound) {
+		if (NameWordsMatch(row->entry(), words)) {
 			result.push_back(row);
 		}
 	}
 	return result;
 }
 
+std::vector<not_null<Row*>> IndexedList::filteredByPrefix(
+		const QStringList &words,
+		const QString &word,
+		const base::flat_set<Key> &keys) const {
+	// Every key here has a name word starting with word[0],
+	// so it has a row in that letter list, ordered as all() is.
+	const auto letter = filtered(word[0]);
+	if (!letter) {
+		return {};
+	}
+	auto result = std::vector<not_null<Row*>>();
+	result.reserve(keys.size());
+	for (const auto &key : keys) {
+		if (NameWordsMatch(key.entry(), words)) {
+			if (const auto row = letter->getRow(key)) {
+				result.push_back(row);
+			}
+		}
+	}
+	ranges::sort(result, ranges::less(), &Row::pos);
+	return result;
+}
+
+bool NameWordsMatch(not_null<Entry*> entry, const QStringList &words) {
+	const auto &nameWords = entry->chatListNameWords();
+	const auto found = [&](const QString &word) {
+		for (const auto &name : nameWords) {
+			if (name.startsWith(word)) {
+				return true;
+			}
+		}
+		return false;
+	};
+	for (const auto &word : words) {
+		if (!found(word)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SearchWordsNarrow(
+		const QStringList &previous,
+		const QStringList &words) {
+	if (previous.isEmpty()) {
+		return false;
+	}
+	for (const auto &was : previous) {
+		const auto extended = ranges::any_of(words, [&](const QString &word) {
+			return word.startsWith(was);
+		});
+		if (!extended) {
+			return false;
+		}
+	}
+	return true;
+}
+
 } // namespace Dialogs
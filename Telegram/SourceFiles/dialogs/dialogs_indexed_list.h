@@ -49,6 +49,12 @@ public:
 	}
 	std::vector<not_null<Row*>> filtered(const QStringList &words) const;
 
+	// Increased on every change of the rows or their names, so a caller
+	// can tell whether results it filtered earlier are still complete.
+	[[nodiscard]] int changes() const {
+		return _changes;
+	}
+
 	// Part of List interface is duplicated here for all() list.
 	int size() const { return all().size(); }
 	bool empty() const { return all().empty(); }
@@ -80,11 +86,33 @@ private:
 		not_null<History*> history,
 		const base::flat_set<QChar> &oldChars);
 
+	void addPrefixes(Key key);
+	void removePrefixes(Key key);
+	void refreshPrefixes(Key key);
+	[[nodiscard]] std::vector<not_null<Row*>> filteredByPrefix(
+		const QStringList &words,
+		const QString &word,
+		const base::flat_set<Key> &keys) const;
+
 	SortMode _sortMode = SortMode();
 	FilterId _filterId = 0;
 	List _list, _empty;
 	base::flat_map<QChar, List> _index;
 
+	// Entries by the first two letters of each of their name words.
+	base::flat_map<uint32, base::flat_set<Key>> _prefixes;
+	base::flat_map<Key, std::vector<uint32>> _prefixesByKey;
+	int _changes = 0;
+
 };
 
+[[nodiscard]] bool NameWordsMatch(
+	not_null<Entry*> entry,
+	const QStringList &words);
+
+// True if everything matching 'words' also matches 'previous'.
+[[nodiscard]] bool SearchWordsNarrow(
+	const QStringList &previous,
+	const QStringList &words);
+
 } // namespace Dialogs
@@ -13,8 +13,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "dialogs/dialogs_search_from_controllers.h"
 #include "history/history.h"
 #include "history/history_item.h"
+#include "history/view/history_view_element.h"
 #include "core/shortcuts.h"
 #include "core/application.h"
+#include "core/paint_benchmark.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "ui/text/text_utilities.h"
@@ -59,6 +61,68 @@ namespace {
 
 constexpr auto kHashtagResultsLimit = 5;
 constexpr auto kStartReorderThreshold = 30;
+constexpr auto kLocalSearchResultsLimit = 50;
+constexpr auto kPaintStatsLogEach = 200;
+constexpr auto kWarmUpDelay = crl::time(300);
+
+// Upper bounds of the paint time buckets in microseconds.
+constexpr auto kPaintStatsBuckets = std::array<crl::profile_time, 6>{ {
+	500,
+	1000,
+	2000,
+	4000,
+	8000,
+	16000,
+} };
+
+struct PaintStats {
+	bool enabled = false;
+	int count = 0;
+	std::array<int, kPaintStatsBuckets.size() + 1> buckets = { { 0 } };
+};
+
+PaintStats GlobalPaintStats;
+
+void AddPaintDuration(crl::profile_time duration) {
+	auto &stats = GlobalPaintStats;
+	const auto i = ranges::lower_bound(kPaintStatsBuckets, duration);
+	++stats.buckets[i - begin(kPaintStatsBuckets)];
+	if (++stats.count < kPaintStatsLogEach) {
+		return;
+	}
+	auto parts = QStringList();
+	for (auto j = 0; j != stats.buckets.size(); ++j) {
+		parts.push_back((j < kPaintStatsBuckets.size())
+			? QString("<%1us: %2"
+			).arg(kPaintStatsBuckets[j]
+			).arg(stats.buckets[j])
+			: QString("more: %1").arg(stats.buckets[j]));
+	}
+	LOG(("Dialogs Paint: %1 paints, %2."
+		).arg(stats.count
+		).arg(parts.join(", ")));
+	stats.count = 0;
+	stats.buckets = {};
+}
+
+[[nodiscard]] bool MessageWordsMatch(
+		not_null<HistoryItem*> item,
+		const QStringList &words) {
+	const auto text = item->originalText().text;
+	if (text.isEmpty()) {
+		return false;
+	}
+	const auto textWords = TextUtilities::PrepareSearchWords(text);
+	for (const auto &word : words) {
+		const auto found = ranges::any_of(textWords, [&](const QString &t) {
+			return t.startsWith(word);
+		});
+		if (!found) {
+			return false;
+		}
+	}
+	return true;
+}
 
 int FixedOnTopDialogsCount(not_null<Dialogs::IndexedList*> list) {
 	auto result = 0;
@@ -110,11 +174,20 @@ struct InnerWidget::PeerSearchResult {
 	BasicRow row;
 };
 
+bool TogglePaintStats() {
+	auto &stats = GlobalPaintStats;
+	stats.enabled = !stats.enabled;
+	stats.count = 0;
+	stats.buckets = {};
+	return stats.enabled;
+}
+
 InnerWidget::InnerWidget(
 	QWidget *parent,
 	not_null<Window::SessionController*> controller)
 : RpWidget(parent)
 , _controller(controller)
+, _warmUpTimer([=] { warmUp(); })
 , _pinnedShiftAnimation([=](crl::time now) {
 	return pinnedShiftAnimationCallback(now);
 })
@@ -379,12 +452,23 @@ void InnerWidget::changeOpenedFolder(Data::Folder *folder) {
 }
 
 void InnerWidget::paintEvent(QPaintEvent *e) {
+	const auto measure = Core::PaintBenchmark::Measure(
+		"dialogs_list",
+		"paint");
 	Painter p(this);
 
 	const auto r = e->rect();
 	if (_controller->widget()->contentOverlapped(this, r)) {
 		return;
 	}
+	const auto paintStarted = GlobalPaintStats.enabled
+		? crl::profile()
+		: crl::profile_time(0);
+	const auto paintStatsGuard = gsl::finally([&] {
+		if (GlobalPaintStats.enabled) {
+			AddPaintDuration(crl::profile() - paintStarted);
+		}
+	});
 	const auto activeEntry = _controller->activeChatEntryCurrent();
 	auto fullWidth = width();
 	auto dialogsClip = r;
@@ -997,6 +1081,30 @@ void InnerWidget::selectByMouse(QPoint globalPosition) {
 			setCursor(wasSelected ? style::cur_default : style::cur_pointer);
 		}
 	}
+	scheduleWarmUp();
+}
+
+void InnerWidget::scheduleWarmUp() {
+	const auto history = computeChosenRow().key.history();
+	if (_warmUpHistory == history) {
+		return;
+	} else if (_warmUpHistory && _warmUpStarted) {
+		session().data().histories().cancelWarmUp(_warmUpHistory);
+	}
+	_warmUpHistory = history;
+	_warmUpStarted = false;
+	if (history) {
+		_warmUpTimer.callOnce(kWarmUpDelay);
+	} else {
+		_warmUpTimer.cancel();
+	}
+}
+
+void InnerWidget::warmUp() {
+	if (const auto history = _warmUpHistory) {
+		_warmUpStarted = true;
+		session().data().histories().warmUp(history);
+	}
 }
 
 void InnerWidget::mousePressEvent(QMouseEvent *e) {
@@ -1696,6 +1804,7 @@ void InnerWidget::clearSelection() {
 			= -1;
 		setCursor(style::cur_default);
 	}
+	scheduleWarmUp();
 }
 
 void InnerWidget::fillSupportSearchMenu(not_null<Ui::PopupMenu*> menu) {
@@ -1817,24 +1926,61 @@ void InnerWidget::applyFilterUpdate(QString newFilter, bool force) {
 		if (_filter.isEmpty() && !_searchFromPeer) {
 			clearFilter();
 		} else {
-			_state = WidgetState::Filtered;
-			_waitingForSearch = true;
-			_filterResults.clear();
-			_filterResultsGlobal.clear();
-			const auto append = [&](not_null<IndexedList*> list) {
-				const auto results = list->filtered(words);
-				_filterResults.insert(
-					end(_filterResults),
-					begin(results),
-					end(results));
-			};
+			auto lists = std::vector<not_null<IndexedList*>>();
 			if (!_searchInChat && !words.isEmpty()) {
-				append(session().data().chatsList()->indexed());
+				const auto data = &session().data();
+				lists.push_back(data->chatsList()->indexed());
 				const auto id = Data::Folder::kId;
-				if (const auto folder = session().data().folderLoaded(id)) {
-					append(folder->chatsList()->indexed());
+				if (const auto folder = data->folderLoaded(id)) {
+					lists.push_back(folder->chatsList()->indexed());
+				}
+				lists.push_back(data->contactsNoChatsList());
+			}
+			auto changes = 0;
+			for (const auto list : lists) {
+				changes += list->changes();
+			}
+
+			// While the query is only being typed further and no chat was
+			// added or renamed, the new results are a subset of the old ones.
+			const auto narrow = !force
+				&& !mentionsSearch
+				&& (_state == WidgetState::Filtered)
+				&& (_filterResultsChanges == changes)
+				&& SearchWordsNarrow(_filterResultsWords, words);
+			_state = WidgetState::Filtered;
+			_waitingForSearch = true;
+			if (narrow) {
+				const auto global = [&](not_null<Row*> row) {
+					const auto history = row->history();
+					const auto i = history
+						? _filterResultsGlobal.find(history->peer)
+						: end(_filterResultsGlobal);
+					return (i != end(_filterResultsGlobal))
+						&& (i->second.get() == row);
+				};
+				_filterResults.erase(
+					ranges::remove_if(_filterResults, [&](not_null<Row*> row) {
+						return global(row)
+							|| !NameWordsMatch(row->entry(), words);
+					}),
+					end(_filterResults));
+				_filterResultsGlobal.clear();
+			} else {
+				_filterResults.clear();
+				_filterResultsGlobal.clear();
+				for (const auto list : lists) {
+					const auto results = list->filtered(words);
+					_filterResults.insert(
+						end(_filterResults),
+						begin(results),
+						end(results));
 				}
-				append(session().data().contactsNoChatsList());
+			}
+			_filterResultsWords = mentionsSearch ? QStringList() : words;
+			_filterResultsChanges = changes;
+			if (_searchInChat && !mentionsSearch && !words.isEmpty()) {
+				searchInLoaded(words);
 			}
 			refresh(true);
 		}
@@ -1845,6 +1991,35 @@ void InnerWidget::applyFilterUpdate(QString newFilter, bool force) {
 	}
 }
 
+void InnerWidget::searchInLoaded(const QStringList &words) {
+	const auto history = _searchInChat.history();
+	if (!history) {
+		return;
+	}
+
+	// Show what we have right away, the server results replace these.
+	clearSearchResults(false);
+	for (const auto &block : ranges::views::reverse(history->blocks)) {
+		for (const auto &view : ranges::views::reverse(block->messages)) {
+			const auto item = view->data();
+			if (!IsServerMsgId(item->id)
+				|| (_searchFromPeer && item->from() != _searchFromPeer)
+				|| !MessageWordsMatch(item, words)) {
+				continue;
+			}
+			_searchResults.push_back(
+				std::make_unique<FakeRow>(_searchInChat, item));
+			if (_searchResults.size() == kLocalSearchResultsLimit) {
+				break;
+			}
+		}
+		if (_searchResults.size() == kLocalSearchResultsLimit) {
+			break;
+		}
+	}
+	_searchedCount = _searchResults.size();
+}
+
 void InnerWidget::onHashtagFilterUpdate(QStringView newFilter) {
 	if (newFilter.isEmpty() || newFilter.at(0) != '#' || _searchInChat) {
 		_hashtagFilter = QString();
@@ -1936,6 +2111,7 @@ void InnerWidget::visibleTopBottomUpdated(
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 	loadPeerPhotos();
+	preparePreviewsDelayed();
 	if (_visibleTop + PreloadHeightsCount * (_visibleBottom - _visibleTop) >= height()) {
 		if (_loadMoreCallback) {
 			_loadMoreCallback();
@@ -2464,6 +2640,7 @@ void InnerWidget::selectSkip(int32 direction) {
 			mustScrollTo(searchedOffset() + _searchedSelected * st::dialogsRowHeight + (_searchedSelected ? 0 : -st::searchedBarHeight), searchedOffset() + (_searchedSelected + 1) * st::dialogsRowHeight);
 		}
 	}
+	scheduleWarmUp();
 	update();
 }
 
@@ -2529,6 +2706,7 @@ void InnerWidget::selectSkipPage(int32 pixels, int32 direction) {
 	} else {
 		return selectSkip(direction * toSkip);
 	}
+	scheduleWarmUp();
 	update();
 }
 
@@ -2587,6 +2765,52 @@ void InnerWidget::loadPeerPhotos() {
 	}
 }
 
+void InnerWidget::preparePreviewsDelayed() {
+	if (_preparePreviewsScheduled) {
+		return;
+	}
+	_preparePreviewsScheduled = true;
+	crl::on_main(this, [=] {
+		if (_preparePreviewsScheduled) {
+			preparePreviews();
+		}
+	});
+}
+
+void InnerWidget::preparePreviews() {
+	_preparePreviewsScheduled = false;
+	if (_state != WidgetState::Default || _visibleBottom <= _visibleTop) {
+		return;
+	}
+
+	// Prepare last message previews of the rows just outside of the
+	// visible area, so that scrolling to them doesn't do it in paint.
+	const auto list = shownDialogs();
+	const auto skip = dialogsOffset() - _skipTopDialogs * st::dialogsRowHeight;
+	const auto height = _visibleBottom - _visibleTop;
+	const auto yFrom = std::max(_visibleTop - skip - height, 0);
+	const auto yTo = _visibleBottom - skip + height;
+	const auto visibleFrom = _visibleTop - skip;
+	const auto visibleTo = _visibleBottom - skip;
+	for (auto i = list->cfind(yFrom, st::dialogsRowHeight)
+		, end = list->cend(); i != end; ++i) {
+		const auto top = (*i)->pos() * st::dialogsRowHeight;
+		if (top >= yTo) {
+			break;
+		} else if (top + st::dialogsRowHeight > visibleFrom
+			&& top < visibleTo) {
+			continue;
+		}
+		const auto history = (*i)->history();
+		const auto item = history
+			? history->chatListMessage()
+			: nullptr;
+		if (item) {
+			history->lastItemDialogsView.prepare(item, {});
+		}
+	}
+}
+
 bool InnerWidget::chooseCollapsedRow() {
 	if (_state != WidgetState::Default) {
 		return false;
@@ -2690,6 +2914,8 @@ bool InnerWidget::chooseRow() {
 	}
 	const auto chosen = computeChosenRow();
 	if (chosen.key) {
+		// The chat is loaded by the history widget right now.
+		_warmUpTimer.cancel();
 		if (IsServerMsgId(chosen.message.fullId.msg)) {
 			session().local().saveRecentSearchHashtags(_filter);
 		}
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/rp_widget.h"
 #include "base/flags.h"
 #include "base/object_ptr.h"
+#include "base/timer.h"
 
 namespace MTP {
 class Error;
@@ -62,6 +63,9 @@ enum class WidgetState {
 	Filtered,
 };
 
+// Logs a histogram of the chats list paint times each 200 paints.
+bool TogglePaintStats();
+
 class InnerWidget final : public Ui::RpWidget {
 	Q_OBJECT
 
@@ -195,7 +199,11 @@ private:
 	void mousePressReleased(QPoint globalPosition, Qt::MouseButton button);
 	void clearIrrelevantState();
 	void selectByMouse(QPoint globalPosition);
+	void scheduleWarmUp();
+	void warmUp();
 	void loadPeerPhotos();
+	void preparePreviewsDelayed();
+	void preparePreviews();
 	void setCollapsedPressed(int pressed);
 	void setPressed(Row *pressed);
 	void setHashtagPressed(int pressed);
@@ -307,6 +315,7 @@ private:
 	void refreshSearchInChatLabel();
 
 	void clearSearchResults(bool clearPeerSearchResults = true);
+	void searchInLoaded(const QStringList &words);
 	void updateSelectedRow(Key key = Key());
 
 	not_null<IndexedList*> shownDialogs() const;
@@ -337,6 +346,10 @@ private:
 	Row *_selected = nullptr;
 	Row *_pressed = nullptr;
 
+	History *_warmUpHistory = nullptr;
+	base::Timer _warmUpTimer;
+	bool _warmUpStarted = false;
+
 	Row *_dragging = nullptr;
 	int _draggingIndex = -1;
 	int _aboveIndex = -1;
@@ -354,6 +367,7 @@ private:
 
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
+	bool _preparePreviewsScheduled = false;
 	QString _filter, _hashtagFilter;
 
 	std::vector<std::unique_ptr<HashtagResult>> _hashtagResults;
@@ -363,6 +377,8 @@ private:
 	bool _hashtagDeletePressed = false;
 
 	std::vector<not_null<Row*>> _filterResults;
+	QStringList _filterResultsWords;
+	int _filterResultsChanges = 0;
 	base::flat_map<
 		not_null<PeerData*>,
 		std::unique_ptr<Row>> _filterResultsGlobal;
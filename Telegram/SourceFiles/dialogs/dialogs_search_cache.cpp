@@ -0,0 +1,305 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "dialogs/dialogs_search_cache.h"
+
+#include "base/unixtime.h"
+#include "data/data_session.h"
+#include "data/data_types.h"
+#include "main/main_session.h"
+#include "storage/cache/storage_cache_database.h"
+
+#include <xxhash.h>
+
+namespace Dialogs {
+namespace {
+
+constexpr auto kCacheVersion = mtpPrime(1);
+constexpr auto kCacheLifetime = 15 * TimeId(60);
+
+enum class CacheKind : uint8 {
+	Messages = 0x01,
+	Peers = 0x02,
+};
+
+[[nodiscard]] Storage::Cache::Key ComputeKey(
+		CacheKind kind,
+		const QString &query,
+		PeerId inChat) {
+	const auto seed = XXH64(&inChat.value, sizeof(inChat.value), 0);
+	const auto hash = XXH64(
+		query.constData(),
+		query.size() * sizeof(ushort),
+		seed);
+	return Data::SearchCacheKey(uint8(kind), hash);
+}
+
+[[nodiscard]] bool HasAllWords(
+		const QStringList &words,
+		const QStringList &names) {
+	const auto findWord = [&](const QString &word) {
+		for (const auto &name : names) {
+			if (name.startsWith(word)) {
+				return true;
+			}
+		}
+		return false;
+	};
+	return ranges::all_of(words, findWord);
+}
+
+[[nodiscard]] QString MessageText(const MTPMessage &message) {
+	return message.match([](const MTPDmessage &data) {
+		return qs(data.vmessage());
+	}, [](const auto &) {
+		return QString();
+	});
+}
+
+[[nodiscard]] PeerId ChatPeerId(const MTPChat &chat) {
+	return chat.match([](const MTPDchannel &data) {
+		return peerFromChannel(data.vid().v);
+	}, [](const MTPDchannelForbidden &data) {
+		return peerFromChannel(data.vid().v);
+	}, [](const auto &data) {
+		return peerFromChat(data.vid().v);
+	});
+}
+
+[[nodiscard]] QStringList ChatNames(const MTPChat &chat) {
+	return chat.match([](const MTPDchannel &data) {
+		return TextUtilities::PrepareSearchWords(
+			qs(data.vtitle()) + ' ' + qs(data.vusername().value_or_empty()));
+	}, [](const MTPDchatEmpty &) {
+		return QStringList();
+	}, [](const auto &data) {
+		return TextUtilities::PrepareSearchWords(qs(data.vtitle()));
+	});
+}
+
+[[nodiscard]] QStringList UserNames(const MTPUser &user) {
+	return user.match([](const MTPDuser &data) {
+		return TextUtilities::PrepareSearchWords(
+			qs(data.vfirst_name().value_or_empty())
+			+ ' '
+			+ qs(data.vlast_name().value_or_empty())
+			+ ' '
+			+ qs(data.vusername().value_or_empty()));
+	}, [](const MTPDuserEmpty &) {
+		return QStringList();
+	});
+}
+
+// Cached results may be older than what we already have in memory.
+template <typename Data>
+void ProcessUnknownPeersData(
+		not_null<Main::Session*> session,
+		const Data &data) {
+	auto &owner = session->data();
+	auto users = QVector<MTPUser>();
+	for (const auto &user : data.vusers().v) {
+		const auto id = user.match([](const auto &data) {
+			return peerFromUser(data.vid());
+		});
+		if (!owner.peerLoaded(id)) {
+			users.push_back(user);
+		}
+	}
+	auto chats = QVector<MTPChat>();
+	for (const auto &chat : data.vchats().v) {
+		if (!owner.peerLoaded(ChatPeerId(chat))) {
+			chats.push_back(chat);
+		}
+	}
+	owner.processUsers(MTP_vector<MTPUser>(std::move(users)));
+	owner.processChats(MTP_vector<MTPChat>(std::move(chats)));
+}
+
+void ProcessUnknownPeers(
+		not_null<Main::Session*> session,
+		const MTPmessages_Messages &result) {
+	result.match([](const MTPDmessages_messagesNotModified &) {
+	}, [&](const auto &data) {
+		ProcessUnknownPeersData(session, data);
+	});
+}
+
+void ProcessUnknownPeers(
+		not_null<Main::Session*> session,
+		const MTPcontacts_Found &result) {
+	ProcessUnknownPeersData(session, result.c_contacts_found());
+}
+
+template <typename Type>
+void Cache(
+		not_null<Main::Session*> session,
+		const Storage::Cache::Key &key,
+		const Type &data) {
+	auto buffer = mtpBuffer();
+	buffer.push_back(kCacheVersion);
+	buffer.push_back(mtpPrime(base::unixtime::now()));
+	data.write(buffer);
+	session->data().cache().put(
+		key,
+		Storage::Cache::Database::TaggedValue(
+			QByteArray(
+				reinterpret_cast<const char*>(buffer.constData()),
+				buffer.size() * sizeof(mtpPrime)),
+			Data::kSearchCacheTag));
+}
+
+template <typename Type>
+[[nodiscard]] std::optional<Type> Parse(const QByteArray &bytes) {
+	if (bytes.size() % sizeof(mtpPrime)
+		|| bytes.size() < 2 * sizeof(mtpPrime)) {
+		return std::nullopt;
+	}
+	auto from = reinterpret_cast<const mtpPrime*>(bytes.constData());
+	const auto till = from + (bytes.size() / sizeof(mtpPrime));
+	if (*from++ != kCacheVersion) {
+		return std::nullopt;
+	}
+	const auto date = TimeId(*from++);
+	const auto now = base::unixtime::now();
+	if (date > now || date + kCacheLifetime < now) {
+		return std::nullopt;
+	}
+	auto result = Type();
+	if (!result.read(from, till)) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+template <typename Type>
+void Read(
+		not_null<Main::Session*> session,
+		const Storage::Cache::Key &key,
+		Fn<void(const Type&)> done) {
+	const auto guard = base::make_weak(session);
+	session->data().cache().get(key, [=](QByteArray &&value) {
+		auto parsed = Parse<Type>(value);
+		if (!parsed) {
+			return;
+		}
+		crl::on_main(guard, [=, data = std::move(*parsed)] {
+			ProcessUnknownPeers(session, data);
+			done(data);
+		});
+	});
+}
+
+} // namespace
+
+bool SearchResultComplete(const MTPmessages_Messages &result) {
+	return result.match([](const MTPDmessages_messages &data) {
+		return true;
+	}, [](const MTPDmessages_messagesNotModified &) {
+		return false;
+	}, [](const auto &data) {
+		return (data.vcount().v <= data.vmessages().v.size());
+	});
+}
+
+bool PeerSearchResultComplete(const MTPcontacts_Found &result, int limit) {
+	const auto &data = result.c_contacts_found();
+	return (data.vmy_results().v.size() + data.vresults().v.size() < limit);
+}
+
+MTPmessages_Messages FilterSearchResult(
+		const MTPmessages_Messages &result,
+		const QString &query) {
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	return result.match([&](const MTPDmessages_messagesNotModified &) {
+		return result;
+	}, [&](const auto &data) {
+		auto messages = QVector<MTPMessage>();
+		for (const auto &message : data.vmessages().v) {
+			const auto text = MessageText(message);
+			if (!text.isEmpty()
+				&& HasAllWords(
+					words,
+					TextUtilities::PrepareSearchWords(text))) {
+				messages.push_back(message);
+			}
+		}
+		return MTP_messages_messages(
+			MTP_vector<MTPMessage>(std::move(messages)),
+			data.vchats(),
+			data.vusers());
+	});
+}
+
+MTPcontacts_Found FilterPeerSearchResult(
+		const MTPcontacts_Found &result,
+		const QString &query) {
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	const auto &data = result.c_contacts_found();
+	auto names = base::flat_map<PeerId, QStringList>();
+	for (const auto &user : data.vusers().v) {
+		const auto id = user.match([](const auto &data) {
+			return peerFromUser(data.vid());
+		});
+		names.emplace(id, UserNames(user));
+	}
+	for (const auto &chat : data.vchats().v) {
+		names.emplace(ChatPeerId(chat), ChatNames(chat));
+	}
+	const auto filter = [&](const MTPVector<MTPPeer> &peers) {
+		auto result = QVector<MTPPeer>();
+		for (const auto &peer : peers.v) {
+			const auto i = names.find(peerFromMTP(peer));
+			if (i != end(names) && HasAllWords(words, i->second)) {
+				result.push_back(peer);
+			}
+		}
+		return MTP_vector<MTPPeer>(std::move(result));
+	};
+	return MTP_contacts_found(
+		filter(data.vmy_results()),
+		filter(data.vresults()),
+		data.vchats(),
+		data.vusers());
+}
+
+void CacheSearchResult(
+		not_null<Main::Session*> session,
+		const QString &query,
+		PeerId inChat,
+		const MTPmessages_Messages &result) {
+	Cache(session, ComputeKey(CacheKind::Messages, query, inChat), result);
+}
+
+void ReadCachedSearchResult(
+		not_null<Main::Session*> session,
+		const QString &query,
+		PeerId inChat,
+		Fn<void(const MTPmessages_Messages&)> done) {
+	Read(
+		session,
+		ComputeKey(CacheKind::Messages, query, inChat),
+		std::move(done));
+}
+
+void CachePeerSearchResult(
+		not_null<Main::Session*> session,
+		const QString &query,
+		const MTPcontacts_Found &result) {
+	Cache(session, ComputeKey(CacheKind::Peers, query, PeerId()), result);
+}
+
+void ReadCachedPeerSearchResult(
+		not_null<Main::Session*> session,
+		const QString &query,
+		Fn<void(const MTPcontacts_Found&)> done) {
+	Read(
+		session,
+		ComputeKey(CacheKind::Peers, query, PeerId()),
+		std::move(done));
+}
+
+} // namespace Dialogs
@@ -0,0 +1,50 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace Dialogs {
+
+// Whether the server returned everything it found in a single page,
+// so the result can be filtered locally for a longer query.
+[[nodiscard]] bool SearchResultComplete(const MTPmessages_Messages &result);
+[[nodiscard]] bool PeerSearchResultComplete(
+	const MTPcontacts_Found &result,
+	int limit);
+
+[[nodiscard]] MTPmessages_Messages FilterSearchResult(
+	const MTPmessages_Messages &result,
+	const QString &query);
+[[nodiscard]] MTPcontacts_Found FilterPeerSearchResult(
+	const MTPcontacts_Found &result,
+	const QString &query);
+
+// Short-lived on-disk copies of the first pages of search results.
+void CacheSearchResult(
+	not_null<Main::Session*> session,
+	const QString &query,
+	PeerId inChat,
+	const MTPmessages_Messages &result);
+void ReadCachedSearchResult(
+	not_null<Main::Session*> session,
+	const QString &query,
+	PeerId inChat,
+	Fn<void(const MTPmessages_Messages&)> done);
+void CachePeerSearchResult(
+	not_null<Main::Session*> session,
+	const QString &query,
+	const MTPcontacts_Found &result);
+void ReadCachedPeerSearchResult(
+	not_null<Main::Session*> session,
+	const QString &query,
+	Fn<void(const MTPcontacts_Found&)> done);
+
+} // namespace Dialogs
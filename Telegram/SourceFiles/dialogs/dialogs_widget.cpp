@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "dialogs/dialogs_widget.h"
 
 #include "dialogs/dialogs_inner_widget.h"
+#include "dialogs/dialogs_search_cache.h"
 #include "dialogs/dialogs_search_from_controllers.h"
 #include "dialogs/dialogs_key.h"
 #include "dialogs/dialogs_entry.h"
@@ -825,8 +826,7 @@ bool Widget::onSearchMessages(bool searchCache) {
 		if (!success) {
 			return false;
 		}
-		const auto i = _searchCache.find(q);
-		if (i != _searchCache.end()) {
+		if (const auto cached = cachedSearchResult(q)) {
 			_searchQuery = q;
 			_searchQueryFrom = _searchFromAuthor;
 			_searchNextRate = 0;
@@ -836,9 +836,11 @@ bool Widget::onSearchMessages(bool searchCache) {
 				_searchInChat
 					? SearchRequestType::PeerFromStart
 					: SearchRequestType::FromStart,
-				i->second,
+				*cached,
 				0);
 			result = true;
+		} else {
+			readSearchDiskCache(q);
 		}
 	} else if (_searchQuery != q || _searchQueryFrom != _searchFromAuthor) {
 		_searchQuery = q;
@@ -912,16 +914,22 @@ bool Widget::onSearchMessages(bool searchCache) {
 	const auto query = Api::ConvertPeerSearchQuery(q);
 	if (searchForPeersRequired(query)) {
 		if (searchCache) {
-			auto i = _peerSearchCache.find(query);
-			if (i != _peerSearchCache.end()) {
+			if (const auto cached = cachedPeerSearchResult(query)) {
 				_peerSearchQuery = query;
 				_peerSearchRequest = 0;
-				peerSearchReceived(i->second, 0);
+				peerSearchReceived(*cached, 0);
 				result = true;
+			} else {
+				readPeerSearchDiskCache(query);
 			}
 		} else if (_peerSearchQuery != query) {
 			_peerSearchQuery = query;
 			_peerSearchFull = false;
+			if (_peerSearchRequest) {
+				// This request is superseded by the new query.
+				_peerSearchQueries.remove(_peerSearchRequest);
+				_api.request(base::take(_peerSearchRequest)).cancel();
+			}
 			_peerSearchRequest = _api.request(MTPcontacts_Search(
 				MTP_string(_peerSearchQuery),
 				MTP_int(SearchPeopleLimit)
@@ -953,6 +961,104 @@ bool Widget::searchForPeersRequired(const QString &query) const {
 	return (query[0] != '#');
 }
 
+const MTPmessages_Messages *Widget::cachedSearchResult(
+		const QString &query) {
+	const auto i = _searchCache.find(query);
+	if (i != end(_searchCache)) {
+		return &i->second;
+	} else if (_searchFromAuthor) {
+		return nullptr;
+	}
+
+	// A complete result for a prefix already has everything we need.
+	auto prefix = end(_searchCache);
+	for (auto j = begin(_searchCache); j != end(_searchCache); ++j) {
+		if (!j->first.isEmpty()
+			&& query.startsWith(j->first)
+			&& (prefix == end(_searchCache)
+				|| j->first.size() > prefix->first.size())
+			&& SearchResultComplete(j->second)) {
+			prefix = j;
+		}
+	}
+	if (prefix == end(_searchCache)) {
+		return nullptr;
+	}
+	auto filtered = FilterSearchResult(prefix->second, query);
+	return &_searchCache.emplace(query, std::move(filtered)).first->second;
+}
+
+const MTPcontacts_Found *Widget::cachedPeerSearchResult(
+		const QString &query) {
+	const auto i = _peerSearchCache.find(query);
+	if (i != end(_peerSearchCache)) {
+		return &i->second;
+	}
+	auto prefix = end(_peerSearchCache);
+	for (auto j = begin(_peerSearchCache); j != end(_peerSearchCache); ++j) {
+		if (!j->first.isEmpty()
+			&& query.startsWith(j->first)
+			&& (prefix == end(_peerSearchCache)
+				|| j->first.size() > prefix->first.size())
+			&& PeerSearchResultComplete(j->second, SearchPeopleLimit)) {
+			prefix = j;
+		}
+	}
+	if (prefix == end(_peerSearchCache)) {
+		return nullptr;
+	}
+	auto filtered = FilterPeerSearchResult(prefix->second, query);
+	return &_peerSearchCache.emplace(
+		query,
+		std::move(filtered)).first->second;
+}
+
+bool Widget::searchDiskCacheAllowed() const {
+	return !_searchFromAuthor && (!_searchInChat || _searchInChat.peer());
+}
+
+void Widget::readSearchDiskCache(const QString &query) {
+	if (!searchDiskCacheAllowed()
+		|| !_searchDiskCacheRead.emplace(query).second) {
+		return;
+	}
+	const auto peer = _searchInChat.peer();
+	ReadCachedSearchResult(
+		&session(),
+		query,
+		peer ? peer->id : PeerId(),
+		crl::guard(this, [=](const MTPmessages_Messages &result) {
+			if (_searchInChat.peer() != peer
+				|| _searchCache.contains(query)) {
+				return;
+			}
+			_searchCache.emplace(query, result);
+			if (_filter->getLastText().trimmed() == query) {
+				onNeedSearchMessages();
+			}
+		}));
+}
+
+void Widget::readPeerSearchDiskCache(const QString &query) {
+	if (!_peerSearchDiskCacheRead.emplace(query).second) {
+		return;
+	}
+	ReadCachedPeerSearchResult(
+		&session(),
+		query,
+		crl::guard(this, [=](const MTPcontacts_Found &result) {
+			if (_peerSearchCache.contains(query)) {
+				return;
+			}
+			_peerSearchCache.emplace(query, result);
+			const auto now = Api::ConvertPeerSearchQuery(
+				_filter->getLastText().trimmed());
+			if (now == query) {
+				onNeedSearchMessages();
+			}
+		}));
+}
+
 void Widget::onNeedSearchMessages() {
 	if (!onSearchMessages(true)) {
 		_searchTimer.start(AutoSearchTimeout);
@@ -1127,6 +1233,14 @@ void Widget::searchReceived(
 			auto i = _searchQueries.find(requestId);
 			if (i != _searchQueries.end()) {
 				_searchCache[i->second] = result;
+				if (searchDiskCacheAllowed()) {
+					const auto peer = _searchInChat.peer();
+					CacheSearchResult(
+						&session(),
+						i->second,
+						peer ? peer->id : PeerId(),
+						result);
+				}
 				_searchQueries.erase(i);
 			}
 		}
@@ -1236,6 +1350,7 @@ void Widget::peerSearchReceived(
 		auto i = _peerSearchQueries.find(requestId);
 		if (i != _peerSearchQueries.end()) {
 			_peerSearchCache[i->second] = result;
+			CachePeerSearchResult(&session(), i->second, result);
 			_peerSearchQueries.erase(i);
 		}
 	}
@@ -1386,6 +1501,7 @@ void Widget::applyFilterUpdate(bool force) {
 
 	if (filterText.isEmpty()) {
 		_peerSearchCache.clear();
+		_peerSearchDiskCacheRead.clear();
 		for (const auto &[requestId, query] : base::take(_peerSearchQueries)) {
 			_api.request(requestId).cancel();
 		}
@@ -1444,6 +1560,7 @@ void Widget::setSearchInChat(Key chat, PeerData *from) {
 
 void Widget::clearSearchCache() {
 	_searchCache.clear();
+	_searchDiskCacheRead.clear();
 	_singleMessageSearch.clear();
 	for (const auto &[requestId, query] : base::take(_searchQueries)) {
 		session().api().request(requestId).cancel();
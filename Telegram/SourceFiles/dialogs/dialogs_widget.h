@@ -149,6 +149,13 @@ private:
 	void setupConnectingWidget();
 	void setupMainMenuToggle();
 	bool searchForPeersRequired(const QString &query) const;
+	[[nodiscard]] const MTPmessages_Messages *cachedSearchResult(
+		const QString &query);
+	[[nodiscard]] const MTPcontacts_Found *cachedPeerSearchResult(
+		const QString &query);
+	[[nodiscard]] bool searchDiskCacheAllowed() const;
+	void readSearchDiskCache(const QString &query);
+	void readPeerSearchDiskCache(const QString &query);
 	void setSearchInChat(Key chat, PeerData *from = nullptr);
 	void showJumpToDate();
 	void showSearchFrom();
@@ -241,6 +248,8 @@ private:
 	base::flat_map<mtpRequestId, QString> _searchQueries;
 	base::flat_map<QString, MTPcontacts_Found> _peerSearchCache;
 	base::flat_map<mtpRequestId, QString> _peerSearchQueries;
+	base::flat_set<QString> _searchDiskCacheRead;
+	base::flat_set<QString> _peerSearchDiskCacheRead;
 
 	QPixmap _widthAnimationCache;
 
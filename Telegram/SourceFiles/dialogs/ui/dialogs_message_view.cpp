@@ -94,6 +94,43 @@ bool MessageView::dependsOn(not_null<const HistoryItem*> item) const {
 	return (_textCachedFor == item.get());
 }
 
+void MessageView::prepare(
+		not_null<const HistoryItem*> item,
+		ToPreviewOptions options) const {
+	if (_textCachedFor == item.get()) {
+		return;
+	}
+	options.existing = &_imagesCache;
+	auto preview = item->toPreview(options);
+	if (!preview.images.empty() && preview.imagesInTextPosition > 0) {
+		_senderCache.setText(
+			st::dialogsTextStyle,
+			preview.text.mid(0, preview.imagesInTextPosition).trimmed(),
+			DialogTextOptions());
+		preview.text = preview.text.mid(preview.imagesInTextPosition);
+	} else {
+		_senderCache = { st::dialogsTextWidthMin };
+	}
+	_textCache.setText(
+		st::dialogsTextStyle,
+		preview.text.trimmed(),
+		DialogTextOptions());
+	_textCachedFor = item;
+	_imagesCache = std::move(preview.images);
+	if (preview.loadingContext.has_value()) {
+		if (!_loadingContext) {
+			_loadingContext = std::make_unique<LoadingContext>();
+			item->history()->session().downloaderTaskFinished(
+			) | rpl::start_with_next([=] {
+				_textCachedFor = nullptr;
+			}, _loadingContext->lifetime);
+		}
+		_loadingContext->context = std::move(preview.loadingContext);
+	} else {
+		_loadingContext = nullptr;
+	}
+}
+
 void MessageView::paint(
 		Painter &p,
 		not_null<const HistoryItem*> item,
@@ -104,37 +141,7 @@ void MessageView::paint(
 	if (geometry.isEmpty()) {
 		return;
 	}
-	if (_textCachedFor != item.get()) {
-		options.existing = &_imagesCache;
-		auto preview = item->toPreview(options);
-		if (!preview.images.empty() && preview.imagesInTextPosition > 0) {
-			_senderCache.setText(
-				st::dialogsTextStyle,
-				preview.text.mid(0, preview.imagesInTextPosition).trimmed(),
-				DialogTextOptions());
-			preview.text = preview.text.mid(preview.imagesInTextPosition);
-		} else {
-			_senderCache = { st::dialogsTextWidthMin };
-		}
-		_textCache.setText(
-			st::dialogsTextStyle,
-			preview.text.trimmed(),
-			DialogTextOptions());
-		_textCachedFor = item;
-		_imagesCache = std::move(preview.images);
-		if (preview.loadingContext.has_value()) {
-			if (!_loadingContext) {
-				_loadingContext = std::make_unique<LoadingContext>();
-				item->history()->session().downloaderTaskFinished(
-				) | rpl::start_with_next([=] {
-					_textCachedFor = nullptr;
-				}, _loadingContext->lifetime);
-			}
-			_loadingContext->context = std::move(preview.loadingContext);
-		} else {
-			_loadingContext = nullptr;
-		}
-	}
+	prepare(item, options);
 	p.setTextPalette(active
 		? st::dialogsTextPaletteActive
 		: selected
@@ -38,6 +38,9 @@ public:
 	void itemInvalidated(not_null<const HistoryItem*> item);
 	[[nodiscard]] bool dependsOn(not_null<const HistoryItem*> item) const;
 
+	void prepare(
+		not_null<const HistoryItem*> item,
+		ToPreviewOptions options) const;
 	void paint(
 		Painter &p,
 		not_null<const HistoryItem*> item,
@@ -36,6 +36,48 @@ QImage ImageModified(QImage image, const PhotoModifications &mods) {
 	return cropped.transformed(transform);
 }
 
+QSize ImageModifiedSize(QSize size, const PhotoModifications &mods) {
+	const auto cropped = mods.crop.isValid() ? mods.crop.size() : size;
+	return (mods.angle % 180) ? cropped.transposed() : cropped;
+}
+
+QImage ImageModifiedPreview(
+		QImage image,
+		const PhotoModifications &mods,
+		int maxWidth) {
+	Expects(!image.isNull());
+	Expects(maxWidth > 0);
+
+	const auto full = ImageModifiedSize(image.size(), mods);
+	if (!mods || full.width() <= maxWidth) {
+		return ImageModified(std::move(image), mods);
+	}
+	const auto scale = maxWidth / float64(full.width());
+	auto scaled = image.scaled(
+		std::max(int(std::round(image.width() * scale)), 1),
+		std::max(int(std::round(image.height() * scale)), 1),
+		Qt::IgnoreAspectRatio,
+		Qt::SmoothTransformation);
+	const auto scaleX = scaled.width() / float64(image.width());
+	const auto scaleY = scaled.height() / float64(image.height());
+	auto scaledMods = PhotoModifications{
+		.angle = mods.angle,
+		.flipped = mods.flipped,
+		.crop = (mods.crop.isValid()
+			? QRectF(
+				mods.crop.x() * scaleX,
+				mods.crop.y() * scaleY,
+				mods.crop.width() * scaleX,
+				mods.crop.height() * scaleY
+			).toRect().intersected(scaled.rect())
+			: QRect()),
+		.paint = mods.paint,
+	};
+
+	// The painting is rendered from the scene rect to the target rect.
+	return ImageModified(std::move(scaled), scaledMods);
+}
+
 bool PhotoModifications::empty() const {
 	return !angle && !flipped && !crop.isValid() && !paint;
 }
@@ -37,4 +37,17 @@ struct EditorData {
 	QImage image,
 	const PhotoModifications &mods);
 
+// Size of the ImageModified() result for the image of the given size.
+[[nodiscard]] QSize ImageModifiedSize(
+	QSize size,
+	const PhotoModifications &mods);
+
+// Applies the modifications to a downscaled copy of the image, so that
+// the result is not much wider than maxWidth and no full size rendering
+// of the painting is done for a preview.
+[[nodiscard]] QImage ImageModifiedPreview(
+	QImage image,
+	const PhotoModifications &mods,
+	int maxWidth);
+
 } // namespace Editor
@@ -15,17 +15,24 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/utils.h"
 #include <QtCore/QDateTime>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QThread>
 #include <QtGui/QImageReader>
 #include <range/v3/algorithm/max_element.hpp>
 #include <range/v3/view/all.hpp>
 #include <range/v3/view/transform.hpp>
 #include <range/v3/range/conversion.hpp>
 
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
 namespace Export {
 namespace Data {
 namespace {
 
 constexpr auto kMaxImageSize = 10000;
+constexpr auto kMinThumbsRunning = 4;
+constexpr auto kMaxRememberedThumbs = 65536;
 constexpr auto kMigratedMessagesIdShift = -1'000'000'000;
 
 QString PrepareFileNameDatePart(TimeId date) {
@@ -576,7 +583,21 @@ UserpicsSlice ParseUserpicsSlice(
 	return result;
 }
 
-std::pair<QString, QSize> WriteImageThumb(
+struct ImageThumbs::Queue {
+	std::mutex mutex;
+	std::condition_variable finished;
+	std::set<QString> writing;
+	int running = 0;
+};
+
+ImageThumbs::ImageThumbs() : _queue(std::make_shared<Queue>()) {
+}
+
+ImageThumbs::~ImageThumbs() {
+	wait();
+}
+
+std::pair<QString, QSize> ImageThumbs::write(
 		const QString &basePath,
 		const QString &largePath,
 		Fn<QSize(QSize)> convertSize,
@@ -597,42 +618,79 @@ std::pair<QString, QSize> WriteImageThumb(
 		|| size.height() >= kMaxImageSize) {
 		return {};
 	}
-	auto image = reader.read();
-	if (image.isNull()) {
-		return {};
-	}
-	const auto finalSize = convertSize(image.size());
+	const auto finalSize = convertSize(size);
 	if (finalSize.isEmpty()) {
 		return {};
 	}
-	image = std::move(image).scaled(
-		finalSize,
-		Qt::IgnoreAspectRatio,
-		Qt::SmoothTransformation);
 	const auto finalFormat = format ? *format : reader.format();
 	const auto finalQuality = quality ? *quality : reader.quality();
+	const auto key = QString("%1\n%2\n%3x%4\n%5\n%6").arg(
+		path,
+		postfix
+	).arg(finalSize.width()
+	).arg(finalSize.height()
+	).arg(QString::fromLatin1(finalFormat)
+	).arg(finalQuality);
+	if (const auto i = _written.find(key); i != end(_written)) {
+		return i->second;
+	}
 	const auto lastSlash = largePath.lastIndexOf('/');
 	const auto firstDot = largePath.indexOf('.', lastSlash + 1);
 	const auto thumb = (firstDot >= 0)
 		? largePath.mid(0, firstDot) + postfix + largePath.mid(firstDot)
 		: largePath + postfix;
-	const auto result = Output::File::PrepareRelativePath(basePath, thumb);
-	if (!image.save(
-			basePath + result,
-			finalFormat.constData(),
-			finalQuality)) {
-		return {};
+
+	auto lock = std::unique_lock<std::mutex>(_queue->mutex);
+	const auto result = Output::File::PrepareRelativePath(
+		basePath,
+		thumb,
+		[&](const QString &relativePath) {
+			return _queue->writing.contains(relativePath);
+		});
+	const auto maxRunning = std::max(
+		2 * QThread::idealThreadCount(),
+		kMinThumbsRunning);
+	_queue->finished.wait(lock, [&] {
+		return _queue->running < maxRunning;
+	});
+	_queue->writing.emplace(result);
+	++_queue->running;
+	lock.unlock();
+
+	crl::async([=, queue = _queue] {
+		auto image = QImageReader(path).read();
+		if (!image.isNull()) {
+			image = std::move(image).scaled(
+				finalSize,
+				Qt::IgnoreAspectRatio,
+				Qt::SmoothTransformation);
+			image.save(
+				basePath + result,
+				finalFormat.constData(),
+				finalQuality);
+		}
+		{
+			auto lock = std::unique_lock<std::mutex>(queue->mutex);
+			queue->writing.erase(result);
+			--queue->running;
+		}
+		queue->finished.notify_all();
+	});
+
+	if (_written.size() >= kMaxRememberedThumbs) {
+		_written.clear();
 	}
-	return { result, finalSize };
+	return _written.emplace(key, std::pair{ result, finalSize })
+		.first->second;
 }
 
-QString WriteImageThumb(
+QString ImageThumbs::write(
 		const QString &basePath,
 		const QString &largePath,
 		int width,
 		int height,
 		const QString &postfix) {
-	return WriteImageThumb(
+	return write(
 		basePath,
 		largePath,
 		[=](QSize size) { return QSize(width, height); },
@@ -641,6 +699,13 @@ QString WriteImageThumb(
 		postfix).first;
 }
 
+void ImageThumbs::wait() {
+	auto lock = std::unique_lock<std::mutex>(_queue->mutex);
+	_queue->finished.wait(lock, [&] {
+		return !_queue->running;
+	});
+}
+
 ContactInfo ParseContactInfo(const MTPUser &data) {
 	auto result = ContactInfo();
 	data.match([&](const MTPDuser &data) {
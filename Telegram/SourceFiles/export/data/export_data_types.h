@@ -83,20 +83,39 @@ struct Image {
 	File file;
 };
 
-std::pair<QString, QSize> WriteImageThumb(
-	const QString &basePath,
-	const QString &largePath,
-	Fn<QSize(QSize)> convertSize,
-	std::optional<QByteArray> format = std::nullopt,
-	std::optional<int> quality = std::nullopt,
-	const QString &postfix = "_thumb");
-
-QString WriteImageThumb(
-	const QString &basePath,
-	const QString &largePath,
-	int width,
-	int height,
-	const QString &postfix = "_thumb");
+// Thumb path and size are computed right away from the image header,
+// while decoding, scaling and saving is done in background threads.
+// The same thumb requested a few times is written only once.
+class ImageThumbs final {
+public:
+	ImageThumbs();
+	~ImageThumbs();
+
+	[[nodiscard]] std::pair<QString, QSize> write(
+		const QString &basePath,
+		const QString &largePath,
+		Fn<QSize(QSize)> convertSize,
+		std::optional<QByteArray> format = std::nullopt,
+		std::optional<int> quality = std::nullopt,
+		const QString &postfix = "_thumb");
+
+	[[nodiscard]] QString write(
+		const QString &basePath,
+		const QString &largePath,
+		int width,
+		int height,
+		const QString &postfix = "_thumb");
+
+	// Waits until all the requested thumbs are written.
+	void wait();
+
+private:
+	struct Queue;
+
+	const std::shared_ptr<Queue> _queue;
+	std::map<QString, std::pair<QString, QSize>> _written;
+
+};
 
 struct ContactInfo {
 	UserId userId = 0;
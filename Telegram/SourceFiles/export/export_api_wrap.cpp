@@ -11,6 +11,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_file.h"
+#include "export/output/export_output_abstract.h"
+#include "export/output/export_output_stats.h"
 #include "mtproto/mtproto_response.h"
 #include "base/value_ordering.h"
 #include "base/bytes.h"
@@ -18,13 +20,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <set>
 #include <deque>
 
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
 namespace Export {
 namespace {
 
 constexpr auto kUserpicsSliceLimit = 100;
-constexpr auto kFileChunkSize = 128 * 1024;
-constexpr auto kFileRequestsCount = 2;
-//constexpr auto kFileNextRequestDelay = crl::time(20);
+constexpr auto kFileChunkSize = 512 * 1024;
+constexpr auto kFileRequestsCount = 4;
+constexpr auto kFileProcessesCount = 4;
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
 constexpr auto kTopPeerSliceLimit = 100;
@@ -104,6 +110,38 @@ private:
 
 };
 
+class ApiWrap::ResumeJournal {
+public:
+	using Location = Data::FileLocation;
+
+	ResumeJournal(
+		const QString &folder,
+		const QByteArray &signature,
+		Output::Stats *stats);
+
+	[[nodiscard]] std::optional<QString> restore(const Location &location);
+	void save(
+		const Location &location,
+		const QString &relativePath,
+		int size);
+	void finish();
+
+private:
+	struct Entry {
+		QString relativePath;
+		int size = 0;
+	};
+
+	[[nodiscard]] bool read(const QByteArray &signature);
+	void write(const QByteArray &line);
+
+	const QString _folder;
+	Output::Stats *_stats = nullptr;
+	std::map<LocationKey, Entry> _entries;
+	QFile _file;
+
+};
+
 struct ApiWrap::StartProcess {
 	FnMut<void(StartInfo)> done;
 
@@ -162,12 +200,19 @@ struct ApiWrap::FileProcess {
 	struct Request {
 		int offset = 0;
 		QByteArray bytes;
+		mtpRequestId requestId = 0;
+		int referenceVersion = 0;
 	};
 	std::deque<Request> requests;
-	mtpRequestId requestId = 0;
+
+	// Parts are not requested while the file reference is being refreshed.
+	mtpRequestId referenceRequestId = 0;
+	int referenceVersion = 0;
 };
 
 struct ApiWrap::FileProgress {
+	uint64 randomId = 0;
+	QString path;
 	int ready = 0;
 	int total = 0;
 };
@@ -211,6 +256,12 @@ struct ApiWrap::ChatProcess {
 	std::optional<Data::MessagesSlice> slice;
 	bool lastSlice = false;
 	int fileIndex = 0;
+
+	// Next slice of the same split, requested while files are loading.
+	std::optional<MTPmessages_Messages> prefetched;
+	int64 prefetchRequested = 0;
+	bool prefetching = false;
+	bool prefetchWaited = false;
 };
 
 
@@ -322,6 +373,105 @@ std::optional<QString> ApiWrap::LoadedFileCache::find(
 	return std::nullopt;
 }
 
+ApiWrap::ResumeJournal::ResumeJournal(
+	const QString &folder,
+	const QByteArray &signature,
+	Output::Stats *stats)
+: _folder(folder)
+, _stats(stats)
+, _file(Output::ResumeJournalPath(folder)) {
+	const auto resumed = read(signature);
+	QDir().mkpath(_folder);
+	if (resumed) {
+		if (_file.open(QIODevice::Append)) {
+			LOG(("Export Info: Resuming with %1 files loaded."
+				).arg(_entries.size()));
+		}
+	} else if (_file.open(QIODevice::WriteOnly)) {
+		write(signature + '\n');
+	}
+}
+
+bool ApiWrap::ResumeJournal::read(const QByteArray &signature) {
+	auto file = QFile(_file.fileName());
+	if (!file.open(QIODevice::ReadOnly)
+		|| file.readLine().trimmed() != signature) {
+		return false;
+	}
+	while (!file.atEnd()) {
+		auto line = file.readLine();
+		if (!line.endsWith('\n')) {
+			// The last record was interrupted.
+			break;
+		}
+		line.chop(1);
+		const auto fields = line.split(' ');
+		if (fields.size() < 4) {
+			continue;
+		}
+		const auto key = LocationKey{
+			fields[0].toULongLong(),
+			fields[1].toULongLong(),
+		};
+		_entries[key] = Entry{
+			QString::fromUtf8(fields.mid(3).join(' ')),
+			fields[2].toInt(),
+		};
+	}
+	return true;
+}
+
+void ApiWrap::ResumeJournal::write(const QByteArray &line) {
+	if (_file.write(line) != line.size() || !_file.flush()) {
+		LOG(("Export Error: Could not write resume journal '%1'."
+			).arg(_file.fileName()));
+		_file.close();
+	}
+}
+
+std::optional<QString> ApiWrap::ResumeJournal::restore(
+		const Location &location) {
+	if (!location) {
+		return std::nullopt;
+	}
+	const auto i = _entries.find(ComputeLocationKey(location));
+	if (i == end(_entries)) {
+		return std::nullopt;
+	}
+	const auto &entry = i->second;
+	if (QFileInfo(_folder + entry.relativePath).size() != entry.size) {
+		return std::nullopt;
+	}
+	if (_stats) {
+		_stats->incrementFiles();
+		_stats->incrementBytes(entry.size);
+	}
+	return entry.relativePath;
+}
+
+void ApiWrap::ResumeJournal::save(
+		const Location &location,
+		const QString &relativePath,
+		int size) {
+	if (!location || !_file.isOpen()) {
+		return;
+	}
+	const auto key = ComputeLocationKey(location);
+	write(QByteArray::number(key.type)
+		+ ' '
+		+ QByteArray::number(key.id)
+		+ ' '
+		+ QByteArray::number(size)
+		+ ' '
+		+ relativePath.toUtf8()
+		+ '\n');
+}
+
+void ApiWrap::ResumeJournal::finish() {
+	_file.close();
+	_file.remove();
+}
+
 ApiWrap::FileProcess::FileProcess(const QString &path, Output::Stats *stats)
 : file(path, stats) {
 }
@@ -352,12 +502,14 @@ auto ApiWrap::splitRequest(int index, Request &&request) {
 		std::forward<Request>(request)));
 }
 
-auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
+auto ApiWrap::fileRequest(not_null<FileProcess*> process, int offset) {
+	const auto &location = process->location;
+
 	Expects(location.dcId != 0
 		|| location.data.type() == mtpc_inputTakeoutFileLocation);
 	Expects(_takeoutId.has_value());
-	Expects(_fileProcess->requestId == 0);
 
+	const auto randomId = process->randomId;
 	return std::move(_mtp.request(MTPInvokeWithTakeout<MTPupload_GetFile>(
 		MTP_long(*_takeoutId),
 		MTPupload_GetFile(
@@ -365,25 +517,13 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
 			location.data,
 			MTP_int(offset),
 			MTP_int(kFileChunkSize))
-	)).fail([=](const MTP::Error &result) {
-		_fileProcess->requestId = 0;
-		if (result.type() == qstr("TAKEOUT_FILE_EMPTY")
-			&& _otherDataProcess != nullptr) {
-			filePartDone(
-				0,
-				MTP_upload_file(
-					MTP_storage_filePartial(),
-					MTP_int(0),
-					MTP_bytes()));
-		} else if (result.type() == qstr("LOCATION_INVALID")
-			|| result.type() == qstr("VERSION_INVALID")
-			|| result.type() == qstr("LOCATION_NOT_AVAILABLE")) {
-			filePartUnavailable();
-		} else if (result.code() == 400
-			&& result.type().startsWith(qstr("FILE_REFERENCE_"))) {
-			filePartRefreshReference(offset);
-		} else {
-			error(std::move(result));
+	)).done([=](const MTPupload_File &result) {
+		if (const auto process = fileProcess(randomId)) {
+			filePartDone(process, offset, result);
+		}
+	}).fail([=](const MTP::Error &result) {
+		if (const auto process = fileProcess(randomId)) {
+			filePartFailed(process, offset, result);
 		}
 	}).toDC(MTP::ShiftDcId(location.dcId, MTP::kExportMediaDcShift)));
 }
@@ -403,13 +543,19 @@ rpl::producer<Output::Result> ApiWrap::ioErrors() const {
 
 void ApiWrap::startExport(
 		const Settings &settings,
+		base::flat_map<uint64, QString> localDocuments,
 		Output::Stats *stats,
 		FnMut<void(StartInfo)> done) {
 	Expects(_settings == nullptr);
 	Expects(_startProcess == nullptr);
 
 	_settings = std::make_unique<Settings>(settings);
+	_localDocuments = std::move(localDocuments);
 	_stats = stats;
+	_resumeJournal = std::make_unique<ResumeJournal>(
+		_settings->path,
+		Output::ResumeSignature(*_settings),
+		_stats);
 	_startProcess = std::make_unique<StartProcess>();
 	_startProcess->done = std::move(done);
 
@@ -780,16 +926,21 @@ void ApiWrap::loadNextUserpic() {
 	for (auto &list = _userpicsProcess->slice->list
 		; _userpicsProcess->fileIndex < list.size()
 		; ++_userpicsProcess->fileIndex) {
-		const auto ready = processFileLoad(
-			list[_userpicsProcess->fileIndex].image.file,
-			Data::FileOrigin(),
-			[=](FileProgress value) { return loadUserpicProgress(value); },
-			[=](const QString &path) { loadUserpicDone(path); });
-		if (!ready) {
+		if (_fileProcesses.size() >= kFileProcessesCount) {
 			return;
 		}
+		const auto index = _userpicsProcess->fileIndex;
+		processFileLoad(
+			list[index].image.file,
+			Data::FileOrigin(),
+			[=](FileProgress value) {
+				return loadUserpicProgress(index, value);
+			},
+			[=](const QString &path) { loadUserpicDone(index, path); });
+	}
+	if (_fileProcesses.empty()) {
+		finishUserpicsSlice();
 	}
-	finishUserpicsSlice();
 }
 
 void ApiWrap::finishUserpicsSlice() {
@@ -819,30 +970,26 @@ void ApiWrap::finishUserpicsSlice() {
 	}).send();
 }
 
-bool ApiWrap::loadUserpicProgress(FileProgress progress) {
-	Expects(_fileProcess != nullptr);
+bool ApiWrap::loadUserpicProgress(int index, FileProgress progress) {
 	Expects(_userpicsProcess != nullptr);
 	Expects(_userpicsProcess->slice.has_value());
-	Expects((_userpicsProcess->fileIndex >= 0)
-		&& (_userpicsProcess->fileIndex
-			< _userpicsProcess->slice->list.size()));
+	Expects((index >= 0)
+		&& (index < _userpicsProcess->slice->list.size()));
 
 	return _userpicsProcess->fileProgress(DownloadProgress{
-		_fileProcess->randomId,
-		_fileProcess->relativePath,
-		_userpicsProcess->fileIndex,
+		progress.randomId,
+		progress.path,
+		index,
 		progress.ready,
 		progress.total });
 }
 
-void ApiWrap::loadUserpicDone(const QString &relativePath) {
+void ApiWrap::loadUserpicDone(int index, const QString &relativePath) {
 	Expects(_userpicsProcess != nullptr);
 	Expects(_userpicsProcess->slice.has_value());
-	Expects((_userpicsProcess->fileIndex >= 0)
-		&& (_userpicsProcess->fileIndex
-			< _userpicsProcess->slice->list.size()));
+	Expects((index >= 0)
+		&& (index < _userpicsProcess->slice->list.size()));
 
-	const auto index = _userpicsProcess->fileIndex;
 	auto &file = _userpicsProcess->slice->list[index].image.file;
 	file.relativePath = relativePath;
 	if (relativePath.isEmpty()) {
@@ -1032,20 +1179,22 @@ void ApiWrap::messagesCountLoaded(int localSplitIndex, int count) {
 void ApiWrap::finishExport(FnMut<void()> done) {
 	const auto guard = gsl::finally([&] { _takeoutId = std::nullopt; });
 
+	if (_resumeJournal) {
+		base::take(_resumeJournal)->finish();
+	}
+
 	mainRequest(MTPaccount_FinishTakeoutSession(
 		MTP_flags(MTPaccount_FinishTakeoutSession::Flag::f_success)
 	)).done(std::move(done)).send();
 }
 
 void ApiWrap::skipFile(uint64 randomId) {
-	if (!_fileProcess || _fileProcess->randomId != randomId) {
+	const auto process = fileProcess(randomId);
+	if (!process) {
 		return;
 	}
 	LOG(("Export Info: File skipped."));
-	Assert(!_fileProcess->requests.empty());
-	Assert(_fileProcess->requestId != 0);
-	_mtp.request(base::take(_fileProcess->requestId)).cancel();
-	base::take(_fileProcess)->done(QString());
+	finishFile(process, false);
 }
 
 void ApiWrap::cancelExportFast() {
@@ -1368,7 +1517,16 @@ void ApiWrap::requestMessagesSlice() {
 	if (!count) {
 		loadMessagesFiles({});
 		return;
+	} else if (_chatProcess->prefetched) {
+		messagesSliceReceived(
+			*base::take(_chatProcess->prefetched),
+			_chatProcess->prefetchRequested);
+		return;
+	} else if (_chatProcess->prefetching) {
+		_chatProcess->prefetchWaited = true;
+		return;
 	}
+	const auto requested = Output::Stats::Now();
 	requestChatMessages(
 		_chatProcess->info.splits[_chatProcess->localSplitIndex],
 		_chatProcess->largestIdPlusOne,
@@ -1377,19 +1535,62 @@ void ApiWrap::requestMessagesSlice() {
 		[=](const MTPmessages_Messages &result) {
 		Expects(_chatProcess != nullptr);
 
-		result.match([&](const MTPDmessages_messagesNotModified &data) {
-			error("Unexpected messagesNotModified received.");
-		}, [&](const auto &data) {
-			if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
-				_chatProcess->lastSlice = true;
-			}
-			loadMessagesFiles(Data::ParseMessagesSlice(
-				_chatProcess->context,
-				data.vmessages(),
-				data.vusers(),
-				data.vchats(),
-				_chatProcess->info.relativePath));
-		});
+		messagesSliceReceived(result, requested);
+	});
+}
+
+void ApiWrap::prefetchMessagesSlice(int32 offsetId) {
+	Expects(_chatProcess != nullptr);
+	Expects(!_chatProcess->prefetching && !_chatProcess->prefetched);
+
+	// Request the next slice while the files of this one are loading and
+	// being written, so that we don't wait for the network between them.
+	const auto process = _chatProcess.get();
+	process->prefetching = true;
+	process->prefetchRequested = Output::Stats::Now();
+	requestChatMessages(
+		process->info.splits[process->localSplitIndex],
+		offsetId,
+		-kMessagesSliceLimit,
+		kMessagesSliceLimit,
+		[=](const MTPmessages_Messages &result) {
+		if (_chatProcess.get() != process) {
+			return;
+		}
+		process->prefetching = false;
+		if (base::take(process->prefetchWaited)) {
+			messagesSliceReceived(result, process->prefetchRequested);
+		} else {
+			process->prefetched = result;
+		}
+	});
+}
+
+void ApiWrap::messagesSliceReceived(
+		const MTPmessages_Messages &result,
+		int64 requested) {
+	Expects(_chatProcess != nullptr);
+
+	result.match([&](const MTPDmessages_messagesNotModified &data) {
+		error("Unexpected messagesNotModified received.");
+	}, [&](const auto &data) {
+		if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
+			_chatProcess->lastSlice = true;
+		}
+		if (_stats) {
+			_stats->addFetchTime(Output::Stats::Now() - requested);
+			_stats->incrementMessages(data.vmessages().v.size());
+		}
+		auto slice = Data::ParseMessagesSlice(
+			_chatProcess->context,
+			data.vmessages(),
+			data.vusers(),
+			data.vchats(),
+			_chatProcess->info.relativePath);
+		if (!_chatProcess->lastSlice && !slice.list.empty()) {
+			prefetchMessagesSlice(slice.list.back().id + 1);
+		}
+		loadMessagesFiles(std::move(slice));
 	});
 }
 
@@ -1478,21 +1679,21 @@ void ApiWrap::loadMessagesFiles(Data::MessagesSlice &&slice) {
 	loadNextMessageFile();
 }
 
-Data::Message *ApiWrap::currentFileMessage() const {
+Data::Message *ApiWrap::fileMessage(int index) const {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
 
-	return &_chatProcess->slice->list[_chatProcess->fileIndex];
+	return &_chatProcess->slice->list[index];
 }
 
-Data::FileOrigin ApiWrap::currentFileMessageOrigin() const {
+Data::FileOrigin ApiWrap::fileMessageOrigin(int index) const {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
 
 	const auto splitIndex = _chatProcess->info.splits[
 		_chatProcess->localSplitIndex];
 	auto result = Data::FileOrigin();
-	result.messageId = currentFileMessage()->id;
+	result.messageId = fileMessage(index)->id;
 	result.split = (splitIndex >= 0)
 		? splitIndex
 		: (int(_splits.size()) + splitIndex);
@@ -1506,39 +1707,39 @@ void ApiWrap::loadNextMessageFile() {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
 
+	// Files of the slice are loaded in parallel, the slice is finished
+	// when the last of them is done.
 	for (auto &list = _chatProcess->slice->list
 		; _chatProcess->fileIndex < list.size()
 		; ++_chatProcess->fileIndex) {
-		const auto &message = list[_chatProcess->fileIndex];
-		if (Data::SkipMessageByDate(message, *_settings)) {
-			continue;
-		}
-		const auto fileProgress = [=](FileProgress value) {
-			return loadMessageFileProgress(value);
-		};
-		const auto ready = processFileLoad(
-			list[_chatProcess->fileIndex].file(),
-			currentFileMessageOrigin(),
-			fileProgress,
-			[=](const QString &path) { loadMessageFileDone(path); },
-			currentFileMessage());
-		if (!ready) {
+		if (_fileProcesses.size() >= kFileProcessesCount) {
 			return;
 		}
-		const auto thumbProgress = [=](FileProgress value) {
-			return loadMessageThumbProgress(value);
-		};
-		const auto thumbReady = processFileLoad(
-			list[_chatProcess->fileIndex].thumb().file,
-			currentFileMessageOrigin(),
-			thumbProgress,
-			[=](const QString &path) { loadMessageThumbDone(path); },
-			currentFileMessage());
-		if (!thumbReady) {
-			return;
+		const auto index = _chatProcess->fileIndex;
+		auto &message = list[index];
+		if (Data::SkipMessageByDate(message, *_settings)) {
+			continue;
 		}
+		processFileLoad(
+			message.file(),
+			fileMessageOrigin(index),
+			[=](FileProgress value) {
+				return loadMessageFileProgress(index, value);
+			},
+			[=](const QString &path) { loadMessageFileDone(index, path); },
+			&message);
+		processFileLoad(
+			message.thumb().file,
+			fileMessageOrigin(index),
+			[=](FileProgress value) {
+				return loadMessageThumbProgress(index, value);
+			},
+			[=](const QString &path) { loadMessageThumbDone(index, path); },
+			&message);
+	}
+	if (_fileProcesses.empty()) {
+		finishMessagesSlice();
 	}
-	finishMessagesSlice();
 }
 
 void ApiWrap::finishMessagesSlice() {
@@ -1570,28 +1771,24 @@ void ApiWrap::finishMessagesSlice() {
 	}
 }
 
-bool ApiWrap::loadMessageFileProgress(FileProgress progress) {
-	Expects(_fileProcess != nullptr);
+bool ApiWrap::loadMessageFileProgress(int index, FileProgress progress) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0) && (index < _chatProcess->slice->list.size()));
 
 	return _chatProcess->fileProgress(DownloadProgress{
-		.randomId = _fileProcess->randomId,
-		.path = _fileProcess->relativePath,
-		.itemIndex = _chatProcess->fileIndex,
+		.randomId = progress.randomId,
+		.path = progress.path,
+		.itemIndex = index,
 		.ready = progress.ready,
 		.total = progress.total });
 }
 
-void ApiWrap::loadMessageFileDone(const QString &relativePath) {
+void ApiWrap::loadMessageFileDone(int index, const QString &relativePath) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0) && (index < _chatProcess->slice->list.size()));
 
-	const auto index = _chatProcess->fileIndex;
 	auto &file = _chatProcess->slice->list[index].file();
 	file.relativePath = relativePath;
 	if (relativePath.isEmpty()) {
@@ -1600,17 +1797,15 @@ void ApiWrap::loadMessageFileDone(const QString &relativePath) {
 	loadNextMessageFile();
 }
 
-bool ApiWrap::loadMessageThumbProgress(FileProgress progress) {
-	return loadMessageFileProgress(progress);
+bool ApiWrap::loadMessageThumbProgress(int index, FileProgress progress) {
+	return loadMessageFileProgress(index, progress);
 }
 
-void ApiWrap::loadMessageThumbDone(const QString &relativePath) {
+void ApiWrap::loadMessageThumbDone(int index, const QString &relativePath) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0) && (index < _chatProcess->slice->list.size()));
 
-	const auto index = _chatProcess->fileIndex;
 	auto &file = _chatProcess->slice->list[index].thumb().file;
 	file.relativePath = relativePath;
 	if (relativePath.isEmpty()) {
@@ -1681,6 +1876,41 @@ bool ApiWrap::processFileLoad(
 	return false;
 }
 
+bool ApiWrap::writeLocalDocument(
+		Data::File &file,
+		const Data::FileOrigin &origin) {
+	if (file.location.data.type() != mtpc_inputDocumentFileLocation) {
+		return false;
+	}
+	const auto &data = file.location.data.c_inputDocumentFileLocation();
+	if (!data.vthumb_size().v.isEmpty()) {
+		return false;
+	}
+	const auto i = _localDocuments.find(data.vid().v);
+	if (i == end(_localDocuments)) {
+		return false;
+	}
+	const auto source = base::take(i->second);
+	_localDocuments.erase(i);
+
+	// The client could have changed or removed the file since then.
+	const auto info = QFileInfo(source);
+	if (!info.isFile() || info.size() != file.size) {
+		return false;
+	}
+	const auto process = prepareFileProcess(file, origin);
+	const auto result = Output::File::Copy(
+		source,
+		_settings->path + process->relativePath,
+		_stats);
+	if (!result) {
+		return false;
+	}
+	file.relativePath = process->relativePath;
+	_fileCache->save(file.location, file.relativePath);
+	return true;
+}
+
 bool ApiWrap::writePreloadedFile(
 		Data::File &file,
 		const Data::FileOrigin &origin) {
@@ -1691,6 +1921,12 @@ bool ApiWrap::writePreloadedFile(
 	if (const auto path = _fileCache->find(file.location)) {
 		file.relativePath = *path;
 		return true;
+	} else if (const auto path = _resumeJournal->restore(file.location)) {
+		file.relativePath = *path;
+		_fileCache->save(file.location, file.relativePath);
+		return true;
+	} else if (writeLocalDocument(file, origin)) {
+		return true;
 	} else if (!file.content.isEmpty()) {
 		const auto process = prepareFileProcess(file, origin);
 		if (const auto result = process->file.writeBlock(file.content)) {
@@ -1709,27 +1945,21 @@ void ApiWrap::loadFile(
 		const Data::FileOrigin &origin,
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done) {
-	Expects(_fileProcess == nullptr);
 	Expects(file.location.dcId != 0
 		|| file.location.data.type() == mtpc_inputTakeoutFileLocation);
 
-	_fileProcess = prepareFileProcess(file, origin);
-	_fileProcess->progress = std::move(progress);
-	_fileProcess->done = std::move(done);
+	_fileProcesses.push_back(prepareFileProcess(file, origin));
+	const auto process = _fileProcesses.back().get();
+	process->progress = std::move(progress);
+	process->done = std::move(done);
 
-	if (_fileProcess->progress) {
-		const auto progress = FileProgress{
-			_fileProcess->file.size(),
-			_fileProcess->size
-		};
-		if (!_fileProcess->progress(progress)) {
-			return;
-		}
+	if (!fileProgress(process)) {
+		return;
 	}
 
-	loadFilePart();
+	loadFilePart(process);
 
-	Ensures(_fileProcess->requestId != 0);
+	Ensures(!process->requests.empty());
 }
 
 auto ApiWrap::prepareFileProcess(
@@ -1738,9 +1968,16 @@ auto ApiWrap::prepareFileProcess(
 -> std::unique_ptr<FileProcess> {
 	Expects(_settings != nullptr);
 
+	// Files loaded in parallel are not created until their first part.
+	const auto reserved = [&](const QString &relativePath) {
+		return ranges::any_of(_fileProcesses, [&](const auto &process) {
+			return (process->relativePath == relativePath);
+		});
+	};
 	const auto relativePath = Output::File::PrepareRelativePath(
 		_settings->path,
-		file.suggestedPath);
+		file.suggestedPath,
+		reserved);
 	auto result = std::make_unique<FileProcess>(
 		_settings->path + relativePath,
 		_stats);
@@ -1752,71 +1989,88 @@ auto ApiWrap::prepareFileProcess(
 	return result;
 }
 
-void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requestId
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
-		return;
-	}
+auto ApiWrap::fileProcess(uint64 randomId) const -> FileProcess* {
+	const auto i = ranges::find(
+		_fileProcesses,
+		randomId,
+		[](const std::unique_ptr<FileProcess> &process) {
+			return process->randomId;
+		});
+	return (i != end(_fileProcesses)) ? i->get() : nullptr;
+}
 
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
-	_fileProcess->requestId = fileRequest(
-		_fileProcess->location,
-		_fileProcess->offset
-	).done([=](const MTPupload_File &result) {
-		_fileProcess->requestId = 0;
-		filePartDone(offset, result);
-	}).send();
-	_fileProcess->offset += kFileChunkSize;
+bool ApiWrap::fileProgress(not_null<FileProcess*> process) {
+	// When several files are loaded only the earliest one is shown.
+	if (!process->progress || _fileProcesses.front().get() != process) {
+		return true;
+	}
+	return process->progress(FileProgress{
+		.randomId = process->randomId,
+		.path = process->relativePath,
+		.ready = process->file.size(),
+		.total = process->size,
+	});
+}
 
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		// Only one request at a time supported right now.
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
+void ApiWrap::loadFilePart(not_null<FileProcess*> process) {
+	// Without a known size parts are requested one by one until empty.
+	const auto limit = (process->size > 0) ? kFileRequestsCount : 1;
+	while (!process->referenceRequestId
+		&& process->requests.size() < limit
+		&& (process->size <= 0 || process->offset < process->size)) {
+		const auto offset = process->offset;
+		process->requests.push_back({ .offset = offset });
+		process->offset += kFileChunkSize;
+		sendFilePart(process, offset);
 	}
 }
 
-void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
-	Expects(_fileProcess != nullptr);
-	Expects(!_fileProcess->requests.empty());
+void ApiWrap::sendFilePart(not_null<FileProcess*> process, int offset) {
+	using Request = FileProcess::Request;
+	const auto i = ranges::find(
+		process->requests,
+		offset,
+		&Request::offset);
+	Assert(i != end(process->requests));
+
+	i->referenceVersion = process->referenceVersion;
+	i->requestId = fileRequest(process, offset).send();
+}
 
+void ApiWrap::filePartDone(
+		not_null<FileProcess*> process,
+		int offset,
+		const MTPupload_File &result) {
+	Expects(!process->requests.empty());
+
+	using Request = FileProcess::Request;
+	auto &requests = process->requests;
+	const auto i = ranges::find(requests, offset, &Request::offset);
+	Assert(i != end(requests));
+
+	i->requestId = 0;
 	if (result.type() == mtpc_upload_fileCdnRedirect) {
 		error("Cdn redirect is not supported.");
 		return;
 	}
 	const auto &data = result.c_upload_file();
 	if (data.vbytes().v.isEmpty()) {
-		if (_fileProcess->size > 0) {
+		if (process->size > 0) {
 			error("Empty bytes received in file part.");
 			return;
 		}
-		const auto result = _fileProcess->file.writeBlock({});
+		const auto result = process->file.writeBlock({});
 		if (!result) {
 			ioError(result);
 			return;
 		}
 	} else {
-		using Request = FileProcess::Request;
-		auto &requests = _fileProcess->requests;
-		const auto i = ranges::find(
-			requests,
-			offset,
-			[](const Request &request) { return request.offset; });
-		Assert(i != end(requests));
-
 		i->bytes = data.vbytes().v;
+		if (_stats) {
+			_stats->incrementDownloaded(i->bytes.size());
+		}
 
-		auto &file = _fileProcess->file;
+		auto &file = process->file;
 		while (!requests.empty() && !requests.front().bytes.isEmpty()) {
 			const auto &bytes = requests.front().bytes;
 			if (const auto result = file.writeBlock(bytes); !result) {
@@ -1826,35 +2080,80 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 			requests.pop_front();
 		}
 
-		if (_fileProcess->progress) {
-			_fileProcess->progress(FileProgress{
-				file.size(),
-				_fileProcess->size });
-		}
+		[[maybe_unused]] const auto proceed = fileProgress(process);
 
 		if (!requests.empty()
-			|| !_fileProcess->size
-			|| _fileProcess->size > _fileProcess->offset) {
-			loadFilePart();
+			|| !process->size
+			|| process->size > process->offset) {
+			loadFilePart(process);
 			return;
 		}
 	}
-
-	auto process = base::take(_fileProcess);
-	const auto relativePath = process->relativePath;
-	_fileCache->save(process->location, relativePath);
-	process->done(process->relativePath);
+	finishFile(process, true);
 }
 
-void ApiWrap::filePartRefreshReference(int offset) {
-	Expects(_fileProcess != nullptr);
-	Expects(_fileProcess->requestId == 0);
+void ApiWrap::filePartFailed(
+		not_null<FileProcess*> process,
+		int offset,
+		const MTP::Error &result) {
+	using Request = FileProcess::Request;
+	const auto i = ranges::find(
+		process->requests,
+		offset,
+		&Request::offset);
+	Assert(i != end(process->requests));
+
+	i->requestId = 0;
+	if (result.type() == qstr("TAKEOUT_FILE_EMPTY")
+		&& _otherDataProcess != nullptr) {
+		filePartDone(
+			process,
+			offset,
+			MTP_upload_file(
+				MTP_storage_filePartial(),
+				MTP_int(0),
+				MTP_bytes()));
+	} else if (result.type() == qstr("LOCATION_INVALID")
+		|| result.type() == qstr("VERSION_INVALID")
+		|| result.type() == qstr("LOCATION_NOT_AVAILABLE")) {
+		filePartUnavailable(process);
+	} else if (result.code() == 400
+		&& result.type().startsWith(qstr("FILE_REFERENCE_"))) {
+		if (i->referenceVersion != process->referenceVersion) {
+			// Sent before the reference was refreshed, just resend.
+			sendFilePart(process, offset);
+		} else {
+			filePartRefreshReference(process);
+		}
+	} else {
+		error(std::move(result));
+	}
+}
 
-	const auto &origin = _fileProcess->origin;
+void ApiWrap::filePartRefreshReference(not_null<FileProcess*> process) {
+	if (process->referenceRequestId) {
+		// All failed parts are sent again when the reference is refreshed.
+		return;
+	}
+	const auto &origin = process->origin;
 	if (!origin.messageId) {
 		error("FILE_REFERENCE error for non-message file.");
 		return;
 	}
+	const auto randomId = process->randomId;
+	const auto fail = [=](const MTP::Error &error) {
+		if (const auto process = fileProcess(randomId)) {
+			process->referenceRequestId = 0;
+			filePartUnavailable(process);
+		}
+		return true;
+	};
+	const auto done = [=](const MTPmessages_Messages &result) {
+		if (const auto process = fileProcess(randomId)) {
+			process->referenceRequestId = 0;
+			filePartExtractReference(process, result);
+		}
+	};
 	if (origin.peer.type() == mtpc_inputPeerChannel
 		|| origin.peer.type() == mtpc_inputPeerChannelFromMessage) {
 		const auto channel = (origin.peer.type() == mtpc_inputPeerChannel)
@@ -1865,43 +2164,28 @@ void ApiWrap::filePartRefreshReference(int offset) {
 				origin.peer.c_inputPeerChannelFromMessage().vpeer(),
 				origin.peer.c_inputPeerChannelFromMessage().vmsg_id(),
 				origin.peer.c_inputPeerChannelFromMessage().vchannel_id());
-		_fileProcess->requestId = mainRequest(MTPchannels_GetMessages(
+		process->referenceRequestId = mainRequest(MTPchannels_GetMessages(
 			channel,
 			MTP_vector<MTPInputMessage>(
 				1,
 				MTP_inputMessageID(MTP_int(origin.messageId)))
-		)).fail([=](const MTP::Error &error) {
-			_fileProcess->requestId = 0;
-			filePartUnavailable();
-			return true;
-		}).done([=](const MTPmessages_Messages &result) {
-			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
-		}).send();
+		)).fail(fail).done(done).send();
 	} else {
-		_fileProcess->requestId = splitRequest(
+		process->referenceRequestId = splitRequest(
 			origin.split,
 			MTPmessages_GetMessages(
 				MTP_vector<MTPInputMessage>(
 					1,
 					MTP_inputMessageID(MTP_int(origin.messageId)))
 			)
-		).fail([=](const MTP::Error &error) {
-			_fileProcess->requestId = 0;
-			filePartUnavailable();
-			return true;
-		}).done([=](const MTPmessages_Messages &result) {
-			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
-		}).send();
+		).fail(fail).done(done).send();
 	}
 }
 
 void ApiWrap::filePartExtractReference(
-		int offset,
+		not_null<FileProcess*> process,
 		const MTPmessages_Messages &result) {
-	Expects(_fileProcess != nullptr);
-	Expects(_fileProcess->requestId == 0);
+	Expects(process->referenceRequestId == 0);
 
 	result.match([&](const MTPDmessages_messagesNotModified &data) {
 		error("Unexpected messagesNotModified received.");
@@ -1917,36 +2201,69 @@ void ApiWrap::filePartExtractReference(
 			data.vchats(),
 			_chatProcess->info.relativePath);
 		for (const auto &message : messages.list) {
-			if (message.id == _fileProcess->origin.messageId) {
+			if (message.id == process->origin.messageId) {
 				const auto refresh1 = Data::RefreshFileReference(
-					_fileProcess->location,
+					process->location,
 					message.file().location);
 				const auto refresh2 = Data::RefreshFileReference(
-					_fileProcess->location,
+					process->location,
 					message.thumb().file.location);
 				if (refresh1 || refresh2) {
-					_fileProcess->requestId = fileRequest(
-						_fileProcess->location,
-						offset
-					).done([=](const MTPupload_File &result) {
-						_fileProcess->requestId = 0;
-						filePartDone(offset, result);
-					}).send();
+					++process->referenceVersion;
+					auto failed = std::vector<int>();
+					for (const auto &request : process->requests) {
+						if (!request.requestId && request.bytes.isEmpty()) {
+							failed.push_back(request.offset);
+						}
+					}
+					for (const auto offset : failed) {
+						sendFilePart(process, offset);
+					}
+					loadFilePart(process);
 					return;
 				}
 			}
 		}
-		filePartUnavailable();
+		filePartUnavailable(process);
 	});
 }
 
-void ApiWrap::filePartUnavailable() {
-	Expects(_fileProcess != nullptr);
-	Expects(!_fileProcess->requests.empty());
-
+void ApiWrap::filePartUnavailable(not_null<FileProcess*> process) {
 	LOG(("Export Error: File unavailable."));
 
-	base::take(_fileProcess)->done(QString());
+	finishFile(process, false);
+}
+
+void ApiWrap::finishFile(not_null<FileProcess*> process, bool loaded) {
+	const auto i = ranges::find_if(
+		_fileProcesses,
+		[&](const std::unique_ptr<FileProcess> &owned) {
+			return (owned.get() == process);
+		});
+	Assert(i != end(_fileProcesses));
+
+	const auto taken = std::move(*i);
+	_fileProcesses.erase(i);
+	for (auto &request : taken->requests) {
+		if (const auto requestId = base::take(request.requestId)) {
+			_mtp.request(requestId).cancel();
+		}
+	}
+	if (const auto requestId = base::take(taken->referenceRequestId)) {
+		_mtp.request(requestId).cancel();
+	}
+	if (loaded) {
+		_fileCache->save(taken->location, taken->relativePath);
+		_resumeJournal->save(
+			taken->location,
+			taken->relativePath,
+			taken->file.size());
+	}
+	if (!_fileProcesses.empty()) {
+		[[maybe_unused]] const auto proceed = fileProgress(
+			_fileProcesses.front().get());
+	}
+	taken->done(loaded ? taken->relativePath : QString());
 }
 
 void ApiWrap::error(const MTP::Error &error) {
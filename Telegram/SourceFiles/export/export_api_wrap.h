@@ -47,6 +47,7 @@ public:
 	};
 	void startExport(
 		const Settings &settings,
+		base::flat_map<uint64, QString> localDocuments,
 		Output::Stats *stats,
 		FnMut<void(StartInfo)> done);
 
@@ -92,6 +93,7 @@ public:
 
 private:
 	class LoadedFileCache;
+	class ResumeJournal;
 	struct StartProcess;
 	struct ContactsProcess;
 	struct UserpicsProcess;
@@ -116,8 +118,8 @@ private:
 	void handleUserpicsSlice(const MTPphotos_Photos &result);
 	void loadUserpicsFiles(Data::UserpicsSlice &&slice);
 	void loadNextUserpic();
-	bool loadUserpicProgress(FileProgress value);
-	void loadUserpicDone(const QString &relativePath);
+	bool loadUserpicProgress(int index, FileProgress value);
+	void loadUserpicDone(int index, const QString &relativePath);
 	void finishUserpicsSlice();
 	void finishUserpics();
 
@@ -150,6 +152,10 @@ private:
 	void checkFirstMessageDate(int localSplitIndex, int count);
 	void messagesCountLoaded(int localSplitIndex, int count);
 	void requestMessagesSlice();
+	void prefetchMessagesSlice(int32 offsetId);
+	void messagesSliceReceived(
+		const MTPmessages_Messages &result,
+		int64 requested);
 	void requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -158,15 +164,15 @@ private:
 		FnMut<void(MTPmessages_Messages&&)> done);
 	void loadMessagesFiles(Data::MessagesSlice &&slice);
 	void loadNextMessageFile();
-	bool loadMessageFileProgress(FileProgress value);
-	void loadMessageFileDone(const QString &relativePath);
-	bool loadMessageThumbProgress(FileProgress value);
-	void loadMessageThumbDone(const QString &relativePath);
+	bool loadMessageFileProgress(int index, FileProgress value);
+	void loadMessageFileDone(int index, const QString &relativePath);
+	bool loadMessageThumbProgress(int index, FileProgress value);
+	void loadMessageThumbDone(int index, const QString &relativePath);
 	void finishMessagesSlice();
 	void finishMessages();
 
-	[[nodiscard]] Data::Message *currentFileMessage() const;
-	[[nodiscard]] Data::FileOrigin currentFileMessageOrigin() const;
+	[[nodiscard]] Data::Message *fileMessage(int index) const;
+	[[nodiscard]] Data::FileOrigin fileMessageOrigin(int index) const;
 
 	bool processFileLoad(
 		Data::File &file,
@@ -177,6 +183,9 @@ private:
 	std::unique_ptr<FileProcess> prepareFileProcess(
 		const Data::File &file,
 		const Data::FileOrigin &origin) const;
+	bool writeLocalDocument(
+		Data::File &file,
+		const Data::FileOrigin &origin);
 	bool writePreloadedFile(
 		Data::File &file,
 		const Data::FileOrigin &origin);
@@ -185,13 +194,24 @@ private:
 		const Data::FileOrigin &origin,
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done);
-	void loadFilePart();
-	void filePartDone(int offset, const MTPupload_File &result);
-	void filePartUnavailable();
-	void filePartRefreshReference(int offset);
-	void filePartExtractReference(
+	[[nodiscard]] FileProcess *fileProcess(uint64 randomId) const;
+	[[nodiscard]] bool fileProgress(not_null<FileProcess*> process);
+	void loadFilePart(not_null<FileProcess*> process);
+	void sendFilePart(not_null<FileProcess*> process, int offset);
+	void filePartDone(
+		not_null<FileProcess*> process,
 		int offset,
+		const MTPupload_File &result);
+	void filePartFailed(
+		not_null<FileProcess*> process,
+		int offset,
+		const MTP::Error &result);
+	void filePartUnavailable(not_null<FileProcess*> process);
+	void filePartRefreshReference(not_null<FileProcess*> process);
+	void filePartExtractReference(
+		not_null<FileProcess*> process,
 		const MTPmessages_Messages &result);
+	void finishFile(not_null<FileProcess*> process, bool loaded);
 
 	template <typename Request>
 	class RequestBuilder;
@@ -203,7 +223,7 @@ private:
 	[[nodiscard]] auto splitRequest(int index, Request &&request);
 
 	[[nodiscard]] auto fileRequest(
-		const Data::FileLocation &location,
+		not_null<FileProcess*> process,
 		int offset);
 
 	void error(const MTP::Error &error);
@@ -216,14 +236,16 @@ private:
 	Output::Stats *_stats = nullptr;
 
 	std::unique_ptr<Settings> _settings;
+	base::flat_map<uint64, QString> _localDocuments;
 	MTPInputUser _user = MTP_inputUserSelf();
 
 	std::unique_ptr<StartProcess> _startProcess;
 	std::unique_ptr<LoadedFileCache> _fileCache;
+	std::unique_ptr<ResumeJournal> _resumeJournal;
 	std::unique_ptr<ContactsProcess> _contactsProcess;
 	std::unique_ptr<UserpicsProcess> _userpicsProcess;
 	std::unique_ptr<OtherDataProcess> _otherDataProcess;
-	std::unique_ptr<FileProcess> _fileProcess;
+	std::vector<std::unique_ptr<FileProcess>> _fileProcesses;
 	std::unique_ptr<LeftChannelsProcess> _leftChannelsProcess;
 	std::unique_ptr<DialogsProcess> _dialogsProcess;
 	std::unique_ptr<ChatProcess> _chatProcess;
@@ -250,6 +250,7 @@ void ControllerObject::startExport(
 
 	_settings.path = Output::NormalizePath(_settings);
 	_writer = Output::CreateWriter(_settings.format);
+	_stats.start();
 	fillExportSteps();
 	exportNext();
 }
@@ -354,7 +355,9 @@ void ControllerObject::exportNext() {
 
 void ControllerObject::initialize() {
 	setState(stateInitializing());
-	_api.startExport(_settings, &_stats, [=](ApiWrap::StartInfo info) {
+	auto localDocuments = base::take(_environment.localDocuments);
+	_api.startExport(_settings, std::move(localDocuments), &_stats, [=](
+			ApiWrap::StartInfo info) {
 		initialized(info);
 	});
 }
@@ -473,7 +476,14 @@ void ControllerObject::exportNextDialog() {
 			setState(stateDialogs(progress));
 			return true;
 		}, [=](Data::MessagesSlice &&result) {
-			if (ioCatchError(_writer->writeDialogSlice(result))) {
+			const auto started = Output::Stats::Now();
+			const auto writeTime = _stats.writeTime();
+			const auto written = _writer->writeDialogSlice(result);
+			_stats.addFormatTime(Output::Stats::Now()
+				- started
+				- (_stats.writeTime() - writeTime));
+			_stats.incrementSlices();
+			if (ioCatchError(written)) {
 				return false;
 			}
 			_messagesWritten += result.list.size();
@@ -508,6 +518,8 @@ ProcessingState ControllerObject::prepareState(
 	result.substepsPassed = _substepsPassed;
 	result.substepsNow = substepsInStep(_lastProcessingStep);
 	result.substepsTotal = _substepsTotal;
+	result.messagesPerSecond = _stats.messagesPerSecond();
+	result.bytesPerSecond = _stats.downloadedPerSecond();
 	return result;
 }
 
@@ -603,6 +615,8 @@ int ControllerObject::substepsInStep(Step step) const {
 }
 
 void ControllerObject::setFinishedState() {
+	LOG(("Export Info: Finished, stats: %1."
+		).arg(QString::fromUtf8(_stats.summary())));
 	setState(FinishedState{
 		_writer->mainFilePath(),
 		_stats.filesCount(),
@@ -79,6 +79,9 @@ struct ProcessingState {
 	QString bytesName;
 	int bytesLoaded = 0;
 	int bytesCount = 0;
+
+	int messagesPerSecond = 0;
+	int64 bytesPerSecond = 0;
 };
 
 struct ApiErrorState {
@@ -111,6 +111,9 @@ struct Environment {
 	QByteArray aboutWebSessions;
 	QByteArray aboutChats;
 	QByteArray aboutLeftChats;
+
+	// Documents already downloaded by the client, id -> local path.
+	base::flat_map<uint64, QString> localDocuments;
 };
 
 } // namespace Export
@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "export/output/export_output_abstract.h"
 
+#include "export/output/export_output_binary.h"
 #include "export/output/export_output_html.h"
 #include "export/output/export_output_json.h"
 #include "export/output/export_output_stats.h"
@@ -14,10 +15,25 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QDir>
 #include <QtCore/QDate>
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 
 namespace Export {
 namespace Output {
 
+namespace {
+
+[[nodiscard]] bool ResumeJournalMatches(
+		const QString &folder,
+		const QByteArray &signature) {
+	auto file = QFile(ResumeJournalPath(folder));
+	return file.open(QIODevice::ReadOnly)
+		&& (file.readLine().trimmed() == signature);
+}
+
+} // namespace
+
 QString NormalizePath(const Settings &settings) {
 	QDir folder(settings.path);
 	const auto path = folder.absolutePath();
@@ -30,11 +46,34 @@ QString NormalizePath(const Settings &settings) {
 	if (list.isEmpty() && !settings.forceSubPath) {
 		return result;
 	}
+	const auto prefix = QString(settings.onlySinglePeer()
+		? "ChatExport_"
+		: "DataExport_");
+	const auto signature = ResumeSignature(settings);
+	if (ResumeJournalMatches(result, signature)) {
+		return result;
+	}
+	auto resume = QString();
+	auto resumeModified = QDateTime();
+	for (const auto &info : list) {
+		if (!info.isDir() || !info.fileName().startsWith(prefix)) {
+			continue;
+		}
+		const auto path = info.absoluteFilePath() + '/';
+		if (!ResumeJournalMatches(path, signature)) {
+			continue;
+		}
+		const auto modified = QFileInfo(ResumeJournalPath(path)).lastModified();
+		if (resume.isEmpty() || modified > resumeModified) {
+			resume = path;
+			resumeModified = modified;
+		}
+	}
+	if (!resume.isEmpty()) {
+		return resume;
+	}
 	const auto date = QDate::currentDate();
-	const auto base = QString(settings.onlySinglePeer()
-		? "ChatExport_%1"
-		: "DataExport_%1"
-	).arg(date.toString(Qt::ISODate));
+	const auto base = prefix + date.toString(Qt::ISODate);
 	const auto add = [&](int i) {
 		return base + (i ? " (" + QString::number(i) + ')' : QString());
 	};
@@ -46,10 +85,44 @@ QString NormalizePath(const Settings &settings) {
 	return result;
 }
 
+QString ResumeJournalPath(const QString &folder) {
+	return folder + "export_progress.journal";
+}
+
+QByteArray ResumeSignature(const Settings &settings) {
+	const auto peerId = settings.singlePeer.match([](
+			const MTPDinputPeerUser &data) {
+		return uint64(data.vuser_id().v);
+	}, [](const MTPDinputPeerChat &data) {
+		return uint64(data.vchat_id().v);
+	}, [](const MTPDinputPeerChannel &data) {
+		return uint64(data.vchannel_id().v);
+	}, [](const auto &data) {
+		return uint64(0);
+	});
+	const auto values = std::vector<uint64>{
+		uint64(settings.format),
+		uint64(settings.types.value()),
+		uint64(settings.fullChats.value()),
+		uint64(settings.media.types.value()),
+		uint64(settings.media.sizeLimit),
+		uint64(settings.singlePeer.type()),
+		peerId,
+		uint64(settings.singlePeerFrom),
+		uint64(settings.singlePeerTill),
+	};
+	auto result = QByteArray("TDESKTOP_EXPORT 1");
+	for (const auto value : values) {
+		result += ' ' + QByteArray::number(value);
+	}
+	return result;
+}
+
 std::unique_ptr<AbstractWriter> CreateWriter(Format format) {
 	switch (format) {
 	case Format::Html: return std::make_unique<HtmlWriter>();
 	case Format::Json: return std::make_unique<JsonWriter>();
+	case Format::Binary: return std::make_unique<BinaryWriter>();
 	}
 	Unexpected("Format in Export::Output::CreateWriter.");
 }
@@ -29,12 +29,18 @@ namespace Output {
 
 QString NormalizePath(const Settings &settings);
 
+// An unfinished export keeps a journal of the files it has downloaded,
+// so exporting the same data to the same folder later continues it.
+[[nodiscard]] QString ResumeJournalPath(const QString &folder);
+[[nodiscard]] QByteArray ResumeSignature(const Settings &settings);
+
 struct Result;
 class Stats;
 
 enum class Format {
 	Html,
 	Json,
+	Binary,
 };
 
 class AbstractWriter {
@@ -0,0 +1,229 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "export/output/export_output_binary.h"
+
+#include "export/output/export_output_result.h"
+#include "export/data/export_data_types.h"
+
+#include <QtCore/QtEndian>
+
+namespace Export {
+namespace Output {
+namespace {
+
+constexpr auto kSegmentVersion = uint32(1);
+constexpr auto kSegmentMagic = "TDXS";
+constexpr auto kSegmentEndMagic = "TDXE";
+constexpr auto kSegmentsMagic = "TDXL";
+
+enum class RecordFlag : uchar {
+	Out = (1 << 0),
+	Forwarded = (1 << 1),
+	Service = (1 << 2),
+	Edited = (1 << 3),
+};
+
+template <typename Value>
+void Append(QByteArray &to, Value value) {
+	if constexpr (sizeof(Value) == 1) {
+		to.append(char(value));
+	} else {
+		const auto little = qToLittleEndian(value);
+		to.append(reinterpret_cast<const char*>(&little), sizeof(little));
+	}
+}
+
+void AppendString(QByteArray &to, const QByteArray &value) {
+	Append(to, uint32(value.size()));
+	to.append(value);
+}
+
+QByteArray SerializeRecord(const Data::Message &message) {
+	const auto flags = uchar(0)
+		| (message.out ? uchar(RecordFlag::Out) : 0)
+		| (message.forwarded ? uchar(RecordFlag::Forwarded) : 0)
+		| (!v::is_null(message.action.content)
+			? uchar(RecordFlag::Service)
+			: 0)
+		| (message.edited ? uchar(RecordFlag::Edited) : 0);
+
+	auto result = QByteArray();
+	Append(result, int32(message.id));
+	Append(result, int32(message.date));
+	Append(result, int32(message.edited));
+	Append(result, uint64(message.fromId.value));
+	Append(result, uint64(message.forwardedFromId.value));
+	Append(result, int32(message.replyToMsgId));
+	Append(result, uchar(flags));
+	Append(result, uchar(message.media.content.index()));
+	Append(result, uchar(message.action.content.index()));
+	Append(result, uchar(0));
+	Append(result, uint32(message.text.size()));
+	for (const auto &part : message.text) {
+		Append(result, uchar(part.type));
+		AppendString(result, part.text);
+		AppendString(result, part.additional);
+	}
+	AppendString(result, message.file().relativePath.toUtf8());
+	AppendString(result, message.thumb().file.relativePath.toUtf8());
+	return result;
+}
+
+} // namespace
+
+Result BinaryWriter::start(
+		const Settings &settings,
+		const Environment &environment,
+		Stats *stats) {
+	Expects(_segment == nullptr);
+
+	_settings = base::duplicate(settings);
+	_stats = stats;
+	return _metadata.start(settings, environment, stats);
+}
+
+Result BinaryWriter::writePersonal(const Data::PersonalInfo &data) {
+	return _metadata.writePersonal(data);
+}
+
+Result BinaryWriter::writeUserpicsStart(const Data::UserpicsInfo &data) {
+	return _metadata.writeUserpicsStart(data);
+}
+
+Result BinaryWriter::writeUserpicsSlice(const Data::UserpicsSlice &data) {
+	return _metadata.writeUserpicsSlice(data);
+}
+
+Result BinaryWriter::writeUserpicsEnd() {
+	return _metadata.writeUserpicsEnd();
+}
+
+Result BinaryWriter::writeContactsList(const Data::ContactsList &data) {
+	return _metadata.writeContactsList(data);
+}
+
+Result BinaryWriter::writeSessionsList(const Data::SessionsList &data) {
+	return _metadata.writeSessionsList(data);
+}
+
+Result BinaryWriter::writeOtherData(const Data::File &data) {
+	return _metadata.writeOtherData(data);
+}
+
+Result BinaryWriter::writeDialogsStart(const Data::DialogsInfo &data) {
+	return _metadata.writeDialogsStart(data);
+}
+
+Result BinaryWriter::writeDialogStart(const Data::DialogInfo &data) {
+	Expects(_segment == nullptr);
+
+	if (const auto result = _metadata.writeDialogStart(data); !result) {
+		return result;
+	}
+	const auto relativePath = data.relativePath + "messages.bin";
+	_segments.push_back({
+		.peerId = data.peerId.value,
+		.relativePath = relativePath,
+	});
+	_index.clear();
+	_segment = std::make_unique<File>(
+		pathWithRelativePath(relativePath),
+		_stats);
+
+	auto block = QByteArray(kSegmentMagic);
+	Append(block, kSegmentVersion);
+	Append(block, uint64(data.peerId.value));
+	return _segment->writeBlock(block);
+}
+
+Result BinaryWriter::writeDialogSlice(const Data::MessagesSlice &data) {
+	Expects(_segment != nullptr);
+	Expects(!_segments.empty());
+
+	auto &segment = _segments.back();
+	auto block = QByteArray();
+	for (const auto &message : data.list) {
+		if (Data::SkipMessageByDate(message, _settings)) {
+			continue;
+		}
+		_index.push_back({
+			.id = message.id,
+			.date = message.date,
+			.offset = uint64(_segment->size() + block.size()),
+		});
+		if (!segment.count || segment.minDate > message.date) {
+			segment.minDate = message.date;
+		}
+		if (!segment.count || segment.maxDate < message.date) {
+			segment.maxDate = message.date;
+		}
+		++segment.count;
+		block.append(SerializeRecord(message));
+	}
+	return block.isEmpty() ? Result::Success() : _segment->writeBlock(block);
+}
+
+Result BinaryWriter::writeDialogEnd() {
+	Expects(_segment != nullptr);
+
+	// Messages come in id order, which is almost the date order already.
+	ranges::stable_sort(_index, ranges::less(), &IndexEntry::date);
+
+	const auto indexOffset = uint64(_segment->size());
+	auto block = QByteArray();
+	block.reserve(_index.size() * 16 + 16);
+	for (const auto &entry : _index) {
+		Append(block, int32(entry.id));
+		Append(block, int32(entry.date));
+		Append(block, entry.offset);
+	}
+	Append(block, indexOffset);
+	Append(block, uint32(_index.size()));
+	block.append(kSegmentEndMagic);
+
+	const auto result = _segment->writeBlock(block);
+	_segment = nullptr;
+	_index.clear();
+	if (!result) {
+		return result;
+	}
+	return _metadata.writeDialogEnd();
+}
+
+Result BinaryWriter::writeDialogsEnd() {
+	if (const auto result = _metadata.writeDialogsEnd(); !result) {
+		return result;
+	}
+	auto block = QByteArray(kSegmentsMagic);
+	Append(block, kSegmentVersion);
+	Append(block, uint32(_segments.size()));
+	for (const auto &segment : _segments) {
+		Append(block, segment.peerId);
+		Append(block, uint32(segment.count));
+		Append(block, int32(segment.minDate));
+		Append(block, int32(segment.maxDate));
+		AppendString(block, segment.relativePath.toUtf8());
+	}
+	return File(pathWithRelativePath("segments.bin"), _stats).writeBlock(
+		block);
+}
+
+Result BinaryWriter::finish() {
+	return _metadata.finish();
+}
+
+QString BinaryWriter::mainFilePath() {
+	return _metadata.mainFilePath();
+}
+
+QString BinaryWriter::pathWithRelativePath(const QString &path) const {
+	return _settings.path + path;
+}
+
+} // namespace Output
+} // namespace Export
@@ -0,0 +1,88 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "export/output/export_output_json.h"
+
+namespace Export {
+namespace Output {
+
+// Everything except messages goes to result.json just like in JsonWriter
+// (chats there have empty "messages" arrays), messages of each chat go to
+// a "messages.bin" segment in the chat folder.
+//
+// Segment: "TDXS" magic, uint32 version, uint64 peer id, then records,
+// then the index of { int32 id, int32 date, uint64 record offset } entries
+// sorted by date and the trailer { uint64 index offset, uint32 count,
+// "TDXE" magic }. All numbers are little-endian, so a reader can map
+// the file, find the index from the last 16 bytes and seek directly.
+//
+// "segments.bin" in the export root has "TDXL" magic, uint32 version,
+// uint32 count and { uint64 peer id, uint32 messages count, int32 min date,
+// int32 max date, uint32 length, utf8 relative path } for each segment.
+class BinaryWriter final : public AbstractWriter {
+public:
+	Format format() override {
+		return Format::Binary;
+	}
+
+	Result start(
+		const Settings &settings,
+		const Environment &environment,
+		Stats *stats) override;
+
+	Result writePersonal(const Data::PersonalInfo &data) override;
+
+	Result writeUserpicsStart(const Data::UserpicsInfo &data) override;
+	Result writeUserpicsSlice(const Data::UserpicsSlice &data) override;
+	Result writeUserpicsEnd() override;
+
+	Result writeContactsList(const Data::ContactsList &data) override;
+
+	Result writeSessionsList(const Data::SessionsList &data) override;
+
+	Result writeOtherData(const Data::File &data) override;
+
+	Result writeDialogsStart(const Data::DialogsInfo &data) override;
+	Result writeDialogStart(const Data::DialogInfo &data) override;
+	Result writeDialogSlice(const Data::MessagesSlice &data) override;
+	Result writeDialogEnd() override;
+	Result writeDialogsEnd() override;
+
+	Result finish() override;
+
+	QString mainFilePath() override;
+
+private:
+	struct IndexEntry {
+		int32 id = 0;
+		TimeId date = 0;
+		uint64 offset = 0;
+	};
+	struct Segment {
+		uint64 peerId = 0;
+		QString relativePath;
+		int count = 0;
+		TimeId minDate = 0;
+		TimeId maxDate = 0;
+	};
+
+	[[nodiscard]] QString pathWithRelativePath(const QString &path) const;
+
+	Settings _settings;
+	Stats *_stats = nullptr;
+	JsonWriter _metadata;
+
+	std::unique_ptr<File> _segment;
+	std::vector<IndexEntry> _index;
+	std::vector<Segment> _segments;
+
+};
+
+} // namespace Output
+} // namespace Export
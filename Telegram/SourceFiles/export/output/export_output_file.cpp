@@ -50,7 +50,12 @@ Result File::writeBlockAttempt(const QByteArray &block) {
 	if (!size) {
 		return Result::Success();
 	}
-	if (_file->write(block) == size && _file->flush()) {
+	const auto started = Stats::Now();
+	const auto written = (_file->write(block) == size) && _file->flush();
+	if (_stats) {
+		_stats->addWriteTime(Stats::Now() - started);
+	}
+	if (written) {
 		_offset += size;
 		if (_stats) {
 			_stats->incrementBytes(size);
@@ -96,8 +101,13 @@ Result File::fatalError() const {
 
 QString File::PrepareRelativePath(
 		const QString &folder,
-		const QString &suggested) {
-	if (!QFile::exists(folder + suggested)) {
+		const QString &suggested,
+		Fn<bool(const QString&)> reserved) {
+	const auto taken = [&](const QString &relativePath) {
+		return QFile::exists(folder + relativePath)
+			|| (reserved && reserved(relativePath));
+	};
+	if (!taken(suggested)) {
 		return suggested;
 	}
 
@@ -115,7 +125,7 @@ QString File::PrepareRelativePath(
 	auto attempt = 0;
 	while (true) {
 		const auto relativePath = relativePart(++attempt);
-		if (!QFile::exists(folder + relativePath)) {
+		if (!taken(relativePath)) {
 			return relativePath;
 		}
 	}
@@ -28,9 +28,11 @@ public:
 
 	[[nodiscard]] Result writeBlock(const QByteArray &block);
 
+	// 'reserved' tells about paths of files that were not created yet.
 	[[nodiscard]] static QString PrepareRelativePath(
 		const QString &folder,
-		const QString &suggested);
+		const QString &suggested,
+		Fn<bool(const QString&)> reserved = nullptr);
 
 	[[nodiscard]] static Result Copy(
 		const QString &source,
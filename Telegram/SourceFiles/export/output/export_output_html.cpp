@@ -21,6 +21,7 @@ namespace Output {
 namespace {
 
 constexpr auto kMessagesInFile = 1000;
+constexpr auto kDialogBlockSize = 256 * 1024;
 constexpr auto kPersonalUserpicSize = 90;
 constexpr auto kEntryUserpicSize = 48;
 constexpr auto kServiceMessagePhotoSize = 60;
@@ -468,7 +469,11 @@ struct HtmlWriter::MessageInfo {
 
 class HtmlWriter::Wrap {
 public:
-	Wrap(const QString &path, const QString &base, Stats *stats);
+	Wrap(
+		const QString &path,
+		const QString &base,
+		Stats *stats,
+		not_null<Data::ImageThumbs*> thumbs);
 
 	[[nodiscard]] bool empty() const;
 
@@ -574,6 +579,7 @@ private:
 	[[nodiscard]] QByteArray pushPoll(const Data::Poll &data);
 
 	File _file;
+	const not_null<Data::ImageThumbs*> _thumbs;
 	QByteArray _composedStart;
 	bool _closed = false;
 	QByteArray _base;
@@ -619,11 +625,12 @@ QByteArray ComposeName(const UserpicData &data, const QByteArray &empty) {
 }
 
 QString WriteUserpicThumb(
+		not_null<Data::ImageThumbs*> thumbs,
 		const QString &basePath,
 		const QString &largePath,
 		const UserpicData &userpic,
 		const QString &postfix = "_thumb") {
-	return Data::WriteImageThumb(
+	return thumbs->write(
 		basePath,
 		largePath,
 		userpic.pixelSize * 2,
@@ -634,8 +641,10 @@ QString WriteUserpicThumb(
 HtmlWriter::Wrap::Wrap(
 	const QString &path,
 	const QString &base,
-	Stats *stats)
-: _file(path, stats) {
+	Stats *stats,
+	not_null<Data::ImageThumbs*> thumbs)
+: _file(path, stats)
+, _thumbs(thumbs) {
 	Expects(base.endsWith('/'));
 	Expects(path.startsWith(base));
 
@@ -886,6 +895,7 @@ QByteArray HtmlWriter::Wrap::pushServiceMessage(
 		userpic.pixelSize = kServiceMessagePhotoSize;
 		userpic.largeLink = photo->image.file.relativePath;
 		userpic.imageLink = WriteUserpicThumb(
+			_thumbs,
 			basePath,
 			userpic.largeLink,
 			userpic);
@@ -1365,7 +1375,7 @@ QByteArray HtmlWriter::Wrap::pushStickerMedia(
 		const QString &basePath) {
 	using namespace Data;
 
-	const auto [thumb, size] = WriteImageThumb(
+	const auto [thumb, size] = _thumbs->write(
 		basePath,
 		data.file.relativePath,
 		CalculateThumbSize(
@@ -1532,7 +1542,7 @@ QByteArray HtmlWriter::Wrap::pushPhotoMedia(
 		const QString &basePath) {
 	using namespace Data;
 
-	const auto [thumb, size] = WriteImageThumb(
+	const auto [thumb, size] = _thumbs->write(
 		basePath,
 		data.image.file.relativePath,
 		CalculateThumbSize(
@@ -1876,6 +1886,7 @@ Result HtmlWriter::start(
 	_settings = base::duplicate(settings);
 	_environment = environment;
 	_stats = stats;
+	_thumbs = std::make_unique<Data::ImageThumbs>();
 
 	//const auto result = copyFile(
 	//	":/export/css/bootstrap.min.css",
@@ -1973,6 +1984,7 @@ Result HtmlWriter::writePreparedPersonal(
 		? QString()
 		: userpicsFilePath();
 	userpic.imageLink = WriteUserpicThumb(
+		_thumbs.get(),
 		_settings.path,
 		userpicPath,
 		userpic,
@@ -2073,7 +2085,11 @@ Result HtmlWriter::writeUserpicsSlice(const Data::UserpicsSlice &data) {
 			Unexpected("Skip reason while writing photo path.");
 		}();
 		const auto &path = userpic.image.file.relativePath;
-		data.imageLink = WriteUserpicThumb(_settings.path, path, data);
+		data.imageLink = WriteUserpicThumb(
+			_thumbs.get(),
+			_settings.path,
+			path,
+			data);
 		data.firstName = path.toUtf8();
 		block.append(_userpics->pushListEntry(
 			data,
@@ -2406,7 +2422,14 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 		: 0;
 	auto previous = _lastMessageInfo.get();
 	auto saved = std::optional<MessageInfo>();
-	auto block = QByteArray();
+
+	// The same buffer is reused for all slices and is written out each
+	// time it is filled, so memory doesn't depend on the chat size.
+	auto &block = _dialogBlock;
+	if (block.capacity() < kDialogBlockSize) {
+		block.reserve(kDialogBlockSize);
+	}
+	block.resize(0);
 	for (const auto &message : data.list) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
@@ -2420,7 +2443,7 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 				_lastMessageIdsPerFile.push_back(saved
 					? saved->id
 					: _lastMessageInfo->id);
-				block = QByteArray();
+				block.resize(0);
 				_lastMessageInfo = nullptr;
 				previous = nullptr;
 				saved = std::nullopt;
@@ -2456,11 +2479,23 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 		++_messagesCount;
 		saved = info;
 		previous = &*saved;
+
+		if (block.size() >= kDialogBlockSize) {
+			if (const auto result = _chat->writeBlock(block); !result) {
+				return result;
+			}
+			block.resize(0);
+		}
 	}
 	if (saved) {
 		_lastMessageInfo = std::make_unique<MessageInfo>(*saved);
 	}
-	return block.isEmpty() ? Result::Success() : _chat->writeBlock(block);
+	if (block.isEmpty()) {
+		return Result::Success();
+	}
+	const auto result = _chat->writeBlock(block);
+	block.resize(0);
+	return result;
 }
 
 Result HtmlWriter::writeEmptySinglePeer() {
@@ -2712,6 +2747,7 @@ Result HtmlWriter::switchToNextChatFile(int index) {
 Result HtmlWriter::finish() {
 	Expects(_settings.onlySinglePeer() || _summary != nullptr);
 
+	_thumbs->wait();
 	if (_settings.onlySinglePeer()) {
 		return Result::Success();
 	}
@@ -2768,7 +2804,8 @@ std::unique_ptr<HtmlWriter::Wrap> HtmlWriter::fileWithRelativePath(
 	return std::make_unique<Wrap>(
 		pathWithRelativePath(path),
 		_settings.path,
-		_stats);
+		_stats,
+		_thumbs.get());
 }
 
 HtmlWriter::~HtmlWriter() = default;
@@ -135,6 +135,7 @@ private:
 	Settings _settings;
 	Environment _environment;
 	Stats *_stats = nullptr;
+	std::unique_ptr<Data::ImageThumbs> _thumbs;
 
 	struct SavedSection;
 	std::vector<SavedSection> _savedSections;
@@ -159,6 +160,7 @@ private:
 	std::unique_ptr<Wrap> _chats;
 	std::unique_ptr<Wrap> _chat;
 	std::vector<int> _lastMessageIdsPerFile;
+	QByteArray _dialogBlock;
 	bool _chatFileEmpty = false;
 
 };
@@ -7,12 +7,45 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "export/output/export_output_stats.h"
 
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <chrono>
+
 namespace Export {
 namespace Output {
+namespace {
+
+constexpr auto kMicrosecondsInSecond = int64(1000 * 1000);
+
+[[nodiscard]] int64 PerSecond(int64 count, int64 microseconds) {
+	return (microseconds > 0)
+		? (count * kMicrosecondsInSecond / microseconds)
+		: 0;
+}
+
+} // namespace
 
 Stats::Stats(const Stats &other)
 : _files(other._files.load())
-, _bytes(other._bytes.load()) {
+, _bytes(other._bytes.load())
+, _messages(other._messages.load())
+, _downloaded(other._downloaded.load())
+, _fetchTime(other._fetchTime.load())
+, _formatTime(other._formatTime.load())
+, _writeTime(other._writeTime.load())
+, _slices(other._slices.load())
+, _started(other._started.load()) {
+}
+
+int64 Stats::Now() {
+	using namespace std::chrono;
+	return duration_cast<microseconds>(
+		steady_clock::now().time_since_epoch()).count();
+}
+
+void Stats::start() {
+	_started = Now();
 }
 
 void Stats::incrementFiles() {
@@ -23,6 +56,30 @@ void Stats::incrementBytes(int count) {
 	_bytes += count;
 }
 
+void Stats::incrementMessages(int count) {
+	_messages += count;
+}
+
+void Stats::incrementDownloaded(int count) {
+	_downloaded += count;
+}
+
+void Stats::addFetchTime(int64 microseconds) {
+	_fetchTime += microseconds;
+}
+
+void Stats::addFormatTime(int64 microseconds) {
+	_formatTime += microseconds;
+}
+
+void Stats::addWriteTime(int64 microseconds) {
+	_writeTime += microseconds;
+}
+
+void Stats::incrementSlices() {
+	++_slices;
+}
+
 int Stats::filesCount() const {
 	return _files;
 }
@@ -31,5 +88,65 @@ int64 Stats::bytesCount() const {
 	return _bytes;
 }
 
+int Stats::messagesCount() const {
+	return _messages;
+}
+
+int64 Stats::downloadedCount() const {
+	return _downloaded;
+}
+
+int64 Stats::fetchTime() const {
+	return _fetchTime;
+}
+
+int64 Stats::formatTime() const {
+	return _formatTime;
+}
+
+int64 Stats::writeTime() const {
+	return _writeTime;
+}
+
+int Stats::slicesCount() const {
+	return _slices;
+}
+
+int64 Stats::elapsed() const {
+	const auto started = _started.load();
+	return started ? (Now() - started) : 0;
+}
+
+int Stats::messagesPerSecond() const {
+	return int(PerSecond(_messages, elapsed()));
+}
+
+int64 Stats::downloadedPerSecond() const {
+	return PerSecond(_downloaded, elapsed());
+}
+
+QByteArray Stats::summary() const {
+	const auto milliseconds = [](int64 microseconds) {
+		return double(microseconds / 1000);
+	};
+	const auto slices = slicesCount();
+	auto result = QJsonObject();
+	result.insert("elapsed_ms", milliseconds(elapsed()));
+	result.insert("files", filesCount());
+	result.insert("bytes_written", double(bytesCount()));
+	result.insert("messages", messagesCount());
+	result.insert("messages_per_second", messagesPerSecond());
+	result.insert("messages_fetch_ms", milliseconds(fetchTime()));
+	result.insert("bytes_downloaded", double(downloadedCount()));
+	result.insert("bytes_downloaded_per_second", double(downloadedPerSecond()));
+	result.insert("slices", slices);
+	result.insert("format_ms", milliseconds(formatTime()));
+	result.insert(
+		"format_per_slice_ms",
+		slices ? (milliseconds(formatTime()) / slices) : 0.);
+	result.insert("write_ms", milliseconds(writeTime()));
+	return QJsonDocument(result).toJson(QJsonDocument::Compact);
+}
+
 } // namespace Output
 } // namespace Export
@@ -17,15 +17,48 @@ public:
 	Stats() = default;
 	Stats(const Stats &other);
 
+	// Microseconds from an arbitrary point, for the stage timings.
+	[[nodiscard]] static int64 Now();
+
+	void start();
+
 	void incrementFiles();
 	void incrementBytes(int count);
 
+	void incrementMessages(int count);
+	void incrementDownloaded(int count);
+	void addFetchTime(int64 microseconds);
+	void addFormatTime(int64 microseconds);
+	void addWriteTime(int64 microseconds);
+	void incrementSlices();
+
 	int filesCount() const;
 	int64 bytesCount() const;
 
+	int messagesCount() const;
+	int64 downloadedCount() const;
+	int64 fetchTime() const;
+	int64 formatTime() const;
+	int64 writeTime() const;
+	int slicesCount() const;
+	int64 elapsed() const;
+
+	int messagesPerSecond() const;
+	int64 downloadedPerSecond() const;
+
+	[[nodiscard]] QByteArray summary() const;
+
 private:
-	std::atomic<int> _files;
-	std::atomic<int64> _bytes;
+	std::atomic<int> _files = 0;
+	std::atomic<int64> _bytes = 0;
+
+	std::atomic<int> _messages = 0;
+	std::atomic<int64> _downloaded = 0;
+	std::atomic<int64> _fetchTime = 0;
+	std::atomic<int64> _formatTime = 0;
+	std::atomic<int64> _writeTime = 0;
+	std::atomic<int> _slices = 0;
+	std::atomic<int64> _started = 0;
 
 };
 
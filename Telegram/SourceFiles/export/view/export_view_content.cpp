@@ -64,9 +64,17 @@ Content ContentFromState(
 			return;
 		}
 		const auto progress = state.bytesLoaded / float64(state.bytesCount);
-		const auto info = Ui::FormatDownloadText(
+		const auto loaded = Ui::FormatDownloadText(
 			state.bytesLoaded,
 			state.bytesCount);
+		const auto info = (state.bytesPerSecond > 0)
+			? (loaded
+				+ ", "
+				+ tr::lng_export_download_speed(
+					tr::now,
+					lt_size,
+					Ui::FormatSizeText(state.bytesPerSecond)))
+			: loaded;
 		push(id, label, info, progress, randomId);
 	};
 	switch (state.step) {
@@ -111,7 +119,13 @@ Content ContentFromState(
 			(state.itemCount > 0
 				? (QString::number(state.itemIndex)
 					+ " / "
-					+ QString::number(state.itemCount))
+					+ QString::number(state.itemCount)
+					+ (state.messagesPerSecond > 0
+						? (", " + tr::lng_export_messages_speed(
+							tr::now,
+							lt_amount,
+							QString::number(state.messagesPerSecond)))
+						: QString()))
 				: QString()),
 			(state.itemCount > 0
 				? (state.itemIndex / float64(state.itemCount))
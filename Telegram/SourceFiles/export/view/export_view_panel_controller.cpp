@@ -92,6 +92,7 @@ Environment PrepareEnvironment(not_null<Main::Session*> session) {
 	result.aboutWebSessions = tr::lng_export_about_web_sessions(tr::now).toUtf8();
 	result.aboutChats = tr::lng_export_about_chats(tr::now).toUtf8();
 	result.aboutLeftChats = tr::lng_export_about_left_chats(tr::now).toUtf8();
+	result.localDocuments = session->data().downloadedDocuments();
 	return result;
 }
 
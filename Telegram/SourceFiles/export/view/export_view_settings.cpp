@@ -75,6 +75,7 @@ void ChooseFormatBox(
 	box->setTitle(tr::lng_export_option_choose_format());
 	addFormatOption(tr::lng_export_option_html(tr::now), Format::Html);
 	addFormatOption(tr::lng_export_option_json(tr::now), Format::Json);
+	addFormatOption(tr::lng_export_option_binary(tr::now), Format::Binary);
 	box->addButton(tr::lng_settings_save(), [=] { done(group->value()); });
 	box->addButton(tr::lng_cancel(), [=] { box->closeBox(); });
 }
@@ -273,6 +274,7 @@ void SettingsWidget::setupPathAndFormat(
 	addLocationLabel(container);
 	addFormatOption(tr::lng_export_option_html(tr::now), Format::Html);
 	addFormatOption(tr::lng_export_option_json(tr::now), Format::Json);
+	addFormatOption(tr::lng_export_option_binary(tr::now), Format::Binary);
 }
 
 void SettingsWidget::addLocationLabel(
@@ -341,7 +343,11 @@ void SettingsWidget::addFormatAndLocationLabel(
 		return data.format;
 	}) | rpl::distinct_until_changed(
 	) | rpl::map([](Format format) {
-		const auto text = (format == Format::Html) ? "HTML" : "JSON";
+		const auto text = (format == Format::Html)
+			? "HTML"
+			: (format == Format::Json)
+			? "JSON"
+			: "Binary";
 		return Ui::Text::Link(text, u"internal:edit_format"_q);
 	});
 	const auto label = container->add(
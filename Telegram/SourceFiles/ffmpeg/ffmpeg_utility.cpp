@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "logs.h"
 
 #include <QImage>
+#include <QMutex>
 
 #ifdef LIB_FFMPEG_USE_QT_PRIVATE_API
 #include <private/qdrawhelper_p.h>
@@ -18,6 +19,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 extern "C" {
 #include <libavutil/opt.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/pixdesc.h>
 } // extern "C"
 
 namespace FFmpeg {
@@ -30,10 +33,80 @@ constexpr auto kMaxScaleByAspectRatio = 16;
 constexpr auto kAvioBlockSize = 4096;
 constexpr auto kTimeUnknown = std::numeric_limits<crl::time>::min();
 constexpr auto kDurationMax = crl::time(std::numeric_limits<int>::max());
+constexpr auto kFrameBuffersPoolMaxBytes = int64(64) * 1024 * 1024;
+constexpr auto kFrameBuffersPoolMaxCount = 16;
+
+// Frame storage buffers keep their size in the first kAlignImageBy bytes.
+static_assert(sizeof(int64) <= kAlignImageBy);
+
+// Released frame buffers are kept here for reuse, so that a playing video
+// doesn't allocate a new frame storage on each frame, even if the QImage
+// with the previous frame was shared with the renderer.
+class FrameBuffersPool final {
+public:
+	[[nodiscard]] uchar *take(int64 size);
+	void release(uchar *buffer);
+
+private:
+	QMutex _mutex;
+	std::vector<uchar*> _buffers;
+	int64 _total = 0;
+
+};
+
+[[nodiscard]] int64 FrameBufferSize(const uchar *buffer) {
+	return *reinterpret_cast<const int64*>(buffer);
+}
+
+uchar *FrameBuffersPool::take(int64 size) {
+	QMutexLocker lock(&_mutex);
+	for (auto i = _buffers.size(); i != 0;) {
+		const auto buffer = _buffers[--i];
+		if (FrameBufferSize(buffer) == size) {
+			_buffers.erase(begin(_buffers) + i);
+			_total -= size;
+			return buffer;
+		}
+	}
+	return nullptr;
+}
+
+void FrameBuffersPool::release(uchar *buffer) {
+	const auto size = FrameBufferSize(buffer);
+	if (size > kFrameBuffersPoolMaxBytes) {
+		delete[] buffer;
+		return;
+	}
+	auto removed = std::vector<uchar*>();
+	{
+		QMutexLocker lock(&_mutex);
+		_buffers.push_back(buffer);
+		_total += size;
+		auto count = 0;
+		while (_total > kFrameBuffersPoolMaxBytes
+			|| int(_buffers.size()) > kFrameBuffersPoolMaxCount) {
+			const auto oldest = _buffers[count++];
+			_total -= FrameBufferSize(oldest);
+			removed.push_back(oldest);
+			if (count == int(_buffers.size())) {
+				break;
+			}
+		}
+		_buffers.erase(begin(_buffers), begin(_buffers) + count);
+	}
+	for (const auto buffer : removed) {
+		delete[] buffer;
+	}
+}
+
+[[nodiscard]] FrameBuffersPool &FrameBuffers() {
+	// Never destroyed, frames may be released during static destruction.
+	static const auto result = new FrameBuffersPool();
+	return *result;
+}
 
 void AlignedImageBufferCleanupHandler(void* data) {
-	const auto buffer = static_cast<uchar*>(data);
-	delete[] buffer;
+	FrameBuffers().release(static_cast<uchar*>(data));
 }
 
 [[nodiscard]] bool IsValidAspectRatio(AVRational aspect) {
@@ -76,6 +149,92 @@ void PremultiplyLine(uchar *dst, const uchar *src, int intsCount) {
 #endif // LIB_FFMPEG_USE_QT_PRIVATE_API
 }
 
+[[nodiscard]] AVHWDeviceType HwDeviceType(AVPixelFormat format) {
+	switch (format) {
+#ifdef Q_OS_WIN
+	case AV_PIX_FMT_D3D11: return AV_HWDEVICE_TYPE_D3D11VA;
+	case AV_PIX_FMT_DXVA2_VLD: return AV_HWDEVICE_TYPE_DXVA2;
+#elif defined Q_OS_MAC // Q_OS_WIN
+	case AV_PIX_FMT_VIDEOTOOLBOX: return AV_HWDEVICE_TYPE_VIDEOTOOLBOX;
+#else // Q_OS_WIN || Q_OS_MAC
+	case AV_PIX_FMT_VAAPI: return AV_HWDEVICE_TYPE_VAAPI;
+	case AV_PIX_FMT_VDPAU: return AV_HWDEVICE_TYPE_VDPAU;
+#endif // Q_OS_WIN || Q_OS_MAC
+	default: break;
+	}
+	return AV_HWDEVICE_TYPE_NONE;
+}
+
+[[nodiscard]] bool CodecSupportsHw(
+		not_null<const AVCodec*> codec,
+		AVHWDeviceType type) {
+	for (auto i = 0;; ++i) {
+		const auto config = avcodec_get_hw_config(codec, i);
+		if (!config) {
+			return false;
+		} else if ((config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)
+			&& config->device_type == type) {
+			return true;
+		}
+	}
+}
+
+[[nodiscard]] bool InitHw(
+		not_null<AVCodecContext*> context,
+		not_null<const AVCodec*> codec) {
+	const auto types = std::array{
+#ifdef Q_OS_WIN
+		AV_HWDEVICE_TYPE_D3D11VA,
+		AV_HWDEVICE_TYPE_DXVA2,
+#elif defined Q_OS_MAC // Q_OS_WIN
+		AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+#else // Q_OS_WIN || Q_OS_MAC
+		AV_HWDEVICE_TYPE_VAAPI,
+		AV_HWDEVICE_TYPE_VDPAU,
+#endif // Q_OS_WIN || Q_OS_MAC
+	};
+	for (const auto type : types) {
+		if (!CodecSupportsHw(codec, type)) {
+			continue;
+		}
+		auto device = (AVBufferRef*)nullptr;
+		const auto error = AvErrorWrap(av_hwdevice_ctx_create(
+			&device,
+			type,
+			nullptr,
+			nullptr,
+			0));
+		if (error || !device) {
+			LogError(qstr("av_hwdevice_ctx_create"), error);
+			continue;
+		}
+		context->hw_device_ctx = device;
+		return true;
+	}
+	return false;
+}
+
+[[nodiscard]] AVPixelFormat GetHwFormat(
+		AVCodecContext *context,
+		const AVPixelFormat *formats) {
+	const auto device = context->hw_device_ctx
+		? reinterpret_cast<AVHWDeviceContext*>(context->hw_device_ctx->data)
+		: nullptr;
+	auto software = AV_PIX_FMT_NONE;
+	for (auto p = formats; *p != AV_PIX_FMT_NONE; ++p) {
+		const auto type = HwDeviceType(*p);
+		if (device && type == device->type) {
+			return *p;
+		} else if (type == AV_HWDEVICE_TYPE_NONE
+			&& !(av_pix_fmt_desc_get(*p)->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+			software = *p;
+		}
+	}
+
+	// Fall back to the software decoding.
+	return software;
+}
+
 } // namespace
 
 IOPointer MakeIOPointer(
@@ -154,7 +313,7 @@ void FormatDeleter::operator()(AVFormatContext *value) {
 	}
 }
 
-CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
+CodecPointer MakeCodecPointer(CodecDescriptor descriptor) {
 	auto error = AvErrorWrap();
 
 	auto result = CodecPointer(avcodec_alloc_context3(nullptr));
@@ -163,6 +322,7 @@ CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
 		LogError(qstr("avcodec_alloc_context3"));
 		return {};
 	}
+	const auto stream = descriptor.stream;
 	error = avcodec_parameters_to_context(context, stream->codecpar);
 	if (error) {
 		LogError(qstr("avcodec_parameters_to_context"), error);
@@ -172,11 +332,16 @@ CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
 	av_opt_set(context, "threads", "auto", 0);
 	av_opt_set_int(context, "refcounted_frames", 1, 0);
 
+
 	const auto codec = avcodec_find_decoder(context->codec_id);
 	if (!codec) {
 		LogError(qstr("avcodec_find_decoder"), context->codec_id);
 		return {};
-	} else if ((error = avcodec_open2(context, codec, nullptr))) {
+	}
+	if (descriptor.hwAllowed && InitHw(context, codec)) {
+		context->get_format = GetHwFormat;
+	}
+	if ((error = avcodec_open2(context, codec, nullptr))) {
 		LogError(qstr("avcodec_open2"), error);
 		return {};
 	}
@@ -207,6 +372,31 @@ void FrameDeleter::operator()(AVFrame *value) {
 	av_frame_free(&value);
 }
 
+AvErrorWrap TransferHardwareFrame(FramePointer &frame, FramePointer &buffer) {
+	if (!frame->hw_frames_ctx) {
+		return AvErrorWrap();
+	}
+	if (!buffer) {
+		buffer = MakeFramePointer();
+	} else {
+		ClearFrameMemory(buffer.get());
+	}
+	auto error = AvErrorWrap(av_hwframe_transfer_data(
+		buffer.get(),
+		frame.get(),
+		0));
+	if (error) {
+		LogError(qstr("av_hwframe_transfer_data"), error);
+		return error;
+	} else if ((error = av_frame_copy_props(buffer.get(), frame.get()))) {
+		LogError(qstr("av_frame_copy_props"), error);
+		return error;
+	}
+	av_frame_unref(frame.get());
+	std::swap(frame, buffer);
+	return AvErrorWrap();
+}
+
 SwscalePointer MakeSwscalePointer(
 		QSize srcSize,
 		int srcFormat,
@@ -371,10 +561,16 @@ QImage CreateFrameStorage(QSize size) {
 		? (widthAlign - (width % widthAlign))
 		: 0);
 	const auto perLine = neededWidth * kPixelBytesSize;
-	const auto buffer = new uchar[perLine * height + kAlignImageBy];
+	const auto size = int64(perLine) * height;
+	auto buffer = FrameBuffers().take(size);
+	if (!buffer) {
+		buffer = new uchar[2 * kAlignImageBy + size];
+		*reinterpret_cast<int64*>(buffer) = size;
+	}
 	const auto cleanupData = static_cast<void *>(buffer);
-	const auto address = reinterpret_cast<uintptr_t>(buffer);
-	const auto alignedBuffer = buffer + ((address % kAlignImageBy)
+	const auto data = buffer + kAlignImageBy;
+	const auto address = reinterpret_cast<uintptr_t>(data);
+	const auto alignedBuffer = data + ((address % kAlignImageBy)
 		? (kAlignImageBy - (address % kAlignImageBy))
 		: 0);
 	return QImage(
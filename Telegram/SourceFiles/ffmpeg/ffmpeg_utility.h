@@ -125,7 +125,12 @@ struct CodecDeleter {
 	void operator()(AVCodecContext *value);
 };
 using CodecPointer = std::unique_ptr<AVCodecContext, CodecDeleter>;
-[[nodiscard]] CodecPointer MakeCodecPointer(not_null<AVStream*> stream);
+
+struct CodecDescriptor {
+	not_null<AVStream*> stream;
+	bool hwAllowed = false;
+};
+[[nodiscard]] CodecPointer MakeCodecPointer(CodecDescriptor descriptor);
 
 struct FrameDeleter {
 	void operator()(AVFrame *value);
@@ -135,6 +140,12 @@ using FramePointer = std::unique_ptr<AVFrame, FrameDeleter>;
 [[nodiscard]] bool FrameHasData(AVFrame *frame);
 void ClearFrameMemory(AVFrame *frame);
 
+// Hardware decoded frames keep their data in the GPU surface, this moves
+// it to a software frame that can be used with swscale or YUV420 textures.
+[[nodiscard]] AvErrorWrap TransferHardwareFrame(
+	FramePointer &frame,
+	FramePointer &buffer);
+
 struct SwscaleDeleter {
 	QSize srcSize;
 	int srcFormat = int(AV_PIX_FMT_NONE);
@@ -66,7 +66,10 @@ namespace {
 constexpr auto kMaxChannelAdmins = 200;
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kEventsFirstPage = 20;
-constexpr auto kEventsPerPage = 50;
+constexpr auto kEventsPerPage = 100;
+constexpr auto kPreloadScreensCount = 5;
+constexpr auto kCachedWindowsLimit = 4;
+constexpr auto kCachedWindowEventsLimit = 1000;
 constexpr auto kClearUserpicsAfter = 50;
 
 } // namespace
@@ -410,16 +413,18 @@ void InnerWidget::repaintScrollDateCallback() {
 }
 
 void InnerWidget::checkPreloadMore() {
-	if (_visibleTop + PreloadHeightsCount * (_visibleBottom - _visibleTop) > height()) {
+	const auto preload = kPreloadScreensCount * (_visibleBottom - _visibleTop);
+	if (_visibleTop + preload > height()) {
 		preloadMore(Direction::Down);
 	}
-	if (_visibleTop < PreloadHeightsCount * (_visibleBottom - _visibleTop)) {
+	if (_visibleTop < preload) {
 		preloadMore(Direction::Up);
 	}
 }
 
 void InnerWidget::applyFilter(FilterValue &&value) {
 	if (_filter != value) {
+		cacheCurrentWindow();
 		_filter = value;
 		clearAndRequestLog();
 	}
@@ -428,6 +433,7 @@ void InnerWidget::applyFilter(FilterValue &&value) {
 void InnerWidget::applySearch(const QString &query) {
 	auto clearQuery = query.trimmed();
 	if (_searchQuery != query) {
+		cacheCurrentWindow();
 		_searchQuery = query;
 		clearAndRequestLog();
 	}
@@ -507,7 +513,53 @@ void InnerWidget::clearAndRequestLog() {
 	_upLoaded = false;
 	_downLoaded = true;
 	updateMinMaxIds();
-	preloadMore(Direction::Up);
+	if (!restoreCachedWindow()) {
+		preloadMore(Direction::Up);
+	}
+}
+
+void InnerWidget::cacheCurrentWindow() {
+	if (!_eventsCacheable || _filterChanged) {
+		return;
+	}
+	const auto query = _searchQuery;
+	const auto i = ranges::find_if(_cachedWindows, [&](const auto &window) {
+		return (window.filter == _filter) && (window.query == query);
+	});
+	if (i != end(_cachedWindows)) {
+		_cachedWindows.erase(i);
+	}
+	auto events = _events;
+	auto upLoaded = _upLoaded;
+	if (events.size() > kCachedWindowEventsLimit) {
+		// Keep only the newest events, the rest will be requested again.
+		events.resize(kCachedWindowEventsLimit);
+		upLoaded = false;
+	}
+	_cachedWindows.push_back({
+		.filter = _filter,
+		.query = query,
+		.events = std::move(events),
+		.upLoaded = upLoaded,
+	});
+	if (_cachedWindows.size() > kCachedWindowsLimit) {
+		_cachedWindows.erase(begin(_cachedWindows));
+	}
+}
+
+bool InnerWidget::restoreCachedWindow() {
+	const auto i = ranges::find_if(_cachedWindows, [&](const auto &window) {
+		return (window.filter == _filter)
+			&& (window.query == _searchQuery);
+	});
+	if (i == end(_cachedWindows) || i->events.isEmpty()) {
+		return false;
+	}
+	auto window = std::move(*i);
+	_cachedWindows.erase(i);
+	_upLoaded = window.upLoaded;
+	addEvents(Direction::Up, window.events);
+	return true;
 }
 
 void InnerWidget::updateEmptyText() {
@@ -710,6 +762,7 @@ void InnerWidget::restoreState(not_null<SectionMemento*> memento) {
 	_upLoaded = memento->upLoaded();
 	_downLoaded = memento->downLoaded();
 	_filterChanged = false;
+	_eventsCacheable = false;
 	updateMinMaxIds();
 	updateSize();
 }
@@ -777,6 +830,11 @@ void InnerWidget::addEvents(Direction direction, const QVector<MTPChannelAdminLo
 		update();
 		return;
 	}
+	if (_eventsCacheable) {
+		// Keep the raw events in the same order as _items to be able
+		// to restore this window quickly after switching the filter back.
+		_events = up ? (_events + events) : (events + _events);
+	}
 
 	// When loading items up we just add them to the back of the _items vector.
 	// When loading items down we add them to a new vector and copy _items after them.
@@ -1039,6 +1097,8 @@ void InnerWidget::clearAfterFilterChange() {
 	_items.clear();
 	_eventIds.clear();
 	_itemsByData.clear();
+	_events.clear();
+	_eventsCacheable = true;
 	updateEmptyText();
 	updateSize();
 }
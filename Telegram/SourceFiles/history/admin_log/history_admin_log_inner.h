@@ -219,6 +219,8 @@ private:
 	void paintEmpty(Painter &p, not_null<const Ui::ChatStyle*> st);
 	void clearAfterFilterChange();
 	void clearAndRequestLog();
+	void cacheCurrentWindow();
+	[[nodiscard]] bool restoreCachedWindow();
 	void addEvents(Direction direction, const QVector<MTPChannelAdminLogEvent> &events);
 	Element *viewForItem(const HistoryItem *item);
 
@@ -261,7 +263,17 @@ private:
 	const std::unique_ptr<Ui::PathShiftGradient> _pathGradient;
 	std::shared_ptr<Ui::ChatTheme> _theme;
 
+	struct CachedWindow {
+		FilterValue filter;
+		QString query;
+		QVector<MTPChannelAdminLogEvent> events;
+		bool upLoaded = false;
+	};
+
 	std::vector<OwnedItem> _items;
+	QVector<MTPChannelAdminLogEvent> _events;
+	std::vector<CachedWindow> _cachedWindows;
+	bool _eventsCacheable = true;
 	std::set<uint64> _eventIds;
 	std::map<not_null<const HistoryItem*>, not_null<Element*>> _itemsByData;
 	base::flat_map<not_null<const HistoryItem*>, TimeId> _itemDates;
@@ -8,6 +8,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 
 #include "history/view/history_view_element.h"
+#include "history/view/history_view_message.h"
+#include "history/view/history_view_service_message.h"
 #include "history/history_message.h"
 #include "history/history_service.h"
 #include "history/history_item_components.h"
@@ -58,6 +60,7 @@ constexpr auto kNewBlockEachMessage = 50;
 constexpr auto kSkipCloudDraftsFor = TimeId(2);
 
 using UpdateFlag = Data::HistoryUpdate::Flag;
+using FilterFlag = Data::ChatFilter::Flag;
 
 } // namespace
 
@@ -113,6 +116,12 @@ void History::skipNotification() {
 	}
 }
 
+void History::skipNotificationsTillLast() {
+	while (_notifications.size() > 1) {
+		_notifications.pop_front();
+	}
+}
+
 void History::popNotification(HistoryItem *item) {
 	if (!empty(_notifications) && (_notifications.back() == item)) {
 		_notifications.pop_back();
@@ -672,7 +681,9 @@ void History::setUnreadMentionsCount(int count) {
 	_unreadMentionsCount = count;
 	const auto has = (count > 0);
 	if (has != had) {
-		owner().chatsFilters().refreshHistory(this);
+		owner().chatsFilters().refreshHistory(
+			this,
+			FilterFlag::NoRead | FilterFlag::NoMuted);
 		updateChatListEntry();
 	}
 }
@@ -1104,6 +1115,9 @@ void History::mainViewRemoved(
 	if (_firstUnreadView == view) {
 		getNextFirstUnreadMessage();
 	}
+	if (_firstUnreadCache.view == view) {
+		invalidateFirstUnreadCache();
+	}
 	if (_unreadBarView == view) {
 		_unreadBarView = nullptr;
 	}
@@ -1213,6 +1227,13 @@ HistoryBlock *History::prepareBlockForAddingItem() {
 void History::viewReplaced(not_null<const Element*> was, Element *now) {
 	if (scrollTopItem == was) scrollTopItem = now;
 	if (_firstUnreadView == was) _firstUnreadView = now;
+	if (_firstUnreadCache.view == was) {
+		if (now) {
+			_firstUnreadCache.view = now;
+		} else {
+			invalidateFirstUnreadCache();
+		}
+	}
 	if (_unreadBarView == was) _unreadBarView = now;
 }
 
@@ -1226,8 +1247,13 @@ void History::addItemToBlock(not_null<HistoryItem*> item) {
 	const auto view = block->messages.back().get();
 	view->attachToBlock(block, block->messages.size() - 1);
 
-	if (isBuildingFrontBlock() && _buildingFrontBlock->expectedItemsCount > 0) {
-		--_buildingFrontBlock->expectedItemsCount;
+	if (isBuildingFrontBlock()) {
+		invalidateFirstUnreadCache();
+		if (_buildingFrontBlock->expectedItemsCount > 0) {
+			--_buildingFrontBlock->expectedItemsCount;
+		}
+	} else {
+		firstUnreadAppended(view);
 	}
 }
 
@@ -1449,20 +1475,100 @@ void History::calculateFirstUnreadMessage() {
 	if (!unreadCount() || !trackUnreadMessages()) {
 		return;
 	}
+	_firstUnreadView = computeFirstUnreadMessage();
+}
+
+HistoryView::Element *History::computeFirstUnreadMessage() {
+	Expects(_inboxReadBefore.has_value());
+
+	const auto before = *_inboxReadBefore;
+	auto &cache = _firstUnreadCache;
+	if (!cache.valid || cache.before > before) {
+		cache.view = walkFirstUnreadMessage(before);
+		cache.valid = true;
+	} else if (cache.before < before && cache.view) {
+		cache.view = advanceFirstUnreadMessage(cache.view, before);
+	}
+	cache.before = before;
+
+#ifdef _DEBUG
+	if (const auto walked = walkFirstUnreadMessage(before)
+		; walked != cache.view) {
+		LOG(("History Error: Bad first unread cache in %1, %2 != %3."
+			).arg(peer->id.value
+			).arg(walked ? walked->data()->id.bare : 0
+			).arg(cache.view ? cache.view->data()->id.bare : 0));
+		cache.view = walked;
+	}
+#endif // _DEBUG
+
+	return cache.view;
+}
+
+HistoryView::Element *History::walkFirstUnreadMessage(MsgId before) const {
+	auto result = (Element*)nullptr;
 	for (const auto &block : ranges::views::reverse(blocks)) {
 		for (const auto &message : ranges::views::reverse(block->messages)) {
 			const auto item = message->data();
 			if (!IsServerMsgId(item->id)) {
 				continue;
 			} else if (!item->out()) {
-				if (item->id >= *_inboxReadBefore) {
-					_firstUnreadView = message.get();
+				if (item->id >= before) {
+					result = message.get();
 				} else {
-					return;
+					return result;
 				}
 			}
 		}
 	}
+	return result;
+}
+
+HistoryView::Element *History::advanceFirstUnreadMessage(
+		not_null<Element*> from,
+		MsgId before) const {
+	// All incoming messages after the old first unread one had ids
+	// not less than the old read till, so the new first unread is the
+	// first incoming one from here that is still not read.
+	const auto block = from->block();
+	const auto check = [&](const std::unique_ptr<Element> &message) {
+		const auto item = message->data();
+		return IsServerMsgId(item->id)
+			&& !item->out()
+			&& (item->id >= before);
+	};
+	const auto count = int(block->messages.size());
+	for (auto i = from->indexInBlock(); i != count; ++i) {
+		if (check(block->messages[i])) {
+			return block->messages[i].get();
+		}
+	}
+	const auto blocksCount = int(blocks.size());
+	for (auto j = block->indexInHistory() + 1; j != blocksCount; ++j) {
+		for (const auto &message : blocks[j]->messages) {
+			if (check(message)) {
+				return message.get();
+			}
+		}
+	}
+	return nullptr;
+}
+
+void History::firstUnreadAppended(not_null<Element*> view) {
+	auto &cache = _firstUnreadCache;
+	if (!cache.valid || cache.view) {
+		return;
+	}
+	const auto item = view->data();
+	if (IsServerMsgId(item->id)
+		&& !item->out()
+		&& item->id >= cache.before) {
+		cache.view = view;
+	}
+}
+
+void History::invalidateFirstUnreadCache() {
+	_firstUnreadCache = FirstUnreadCache();
 }
 
 bool History::readInboxTillNeedsRequest(MsgId tillId) {
@@ -1505,19 +1611,21 @@ std::optional<int> History::countStillUnreadLocal(MsgId readTillId) const {
 			).arg(maxMsgId().bare));
 		if (minMsgId() <= before && maxMsgId() >= readTillId) {
 			auto result = 0;
-			for (const auto &block : blocks) {
-				for (const auto &message : block->messages) {
-					const auto item = message->data();
-					if (!IsServerMsgId(item->id)
-						|| (item->out() && !item->isFromScheduled())) {
-						continue;
-					} else if (item->id > readTillId) {
-						break;
-					} else if (item->id >= before) {
-						++result;
+			[&] {
+				for (const auto &block : blocks) {
+					for (const auto &message : block->messages) {
+						const auto item = message->data();
+						if (!IsServerMsgId(item->id)
+							|| (item->out() && !item->isFromScheduled())) {
+							continue;
+						} else if (item->id > readTillId) {
+							return;
+						} else if (item->id >= before) {
+							++result;
+						}
 					}
 				}
-			}
+			}();
 			DEBUG_LOG(("Reading: check before result %1 with existing %2"
 				).arg(result
 				).arg(_unreadCount.value_or(-666)));
@@ -1659,7 +1767,7 @@ void History::setUnreadCount(int newUnreadCount) {
 	const auto wasForBadge = (unreadCountForBadge() > 0);
 	const auto refresher = gsl::finally([&] {
 		if (wasForBadge != (unreadCountForBadge() > 0)) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(this, FilterFlag::NoRead);
 		}
 		session().changes().historyUpdated(this, UpdateFlag::UnreadView);
 	});
@@ -1704,7 +1812,7 @@ void History::setUnreadMark(bool unread) {
 	const auto noUnreadMessages = !unreadCount();
 	const auto refresher = gsl::finally([&] {
 		if (inChatList() && noUnreadMessages) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(this, FilterFlag::NoRead);
 			updateChatListEntry();
 		}
 		session().changes().historyUpdated(this, UpdateFlag::UnreadView);
@@ -1727,7 +1835,7 @@ void History::setFakeUnreadWhileOpened(bool enabled) {
 		return;
 	}
 	_fakeUnreadWhileOpened = enabled;
-	owner().chatsFilters().refreshHistory(this);
+	owner().chatsFilters().refreshHistory(this, FilterFlag::NoRead);
 }
 
 [[nodiscard]] bool History::fakeUnreadWhileOpened() const {
@@ -1744,7 +1852,7 @@ bool History::changeMute(bool newMute) {
 	}
 	const auto refresher = gsl::finally([&] {
 		if (inChatList()) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(this, FilterFlag::NoMuted);
 			updateChatListEntry();
 		}
 		session().changes().peerUpdated(
@@ -1991,6 +2099,7 @@ not_null<HistoryItem*> History::addNewInTheMiddle(
 		item->createView(
 			HistoryInner::ElementDelegate()));
 	(*it)->attachToBlock(block.get(), itemIndex);
+	invalidateFirstUnreadCache();
 	if (itemIndex + 1 < block->messages.size()) {
 		for (auto i = itemIndex + 1, l = int(block->messages.size()); i != l; ++i) {
 			block->messages[i]->setIndexInBlock(i);
@@ -2977,6 +3086,25 @@ bool History::isEmpty() const {
 	return blocks.empty();
 }
 
+HistoryMemoryStats History::memoryStats() const {
+	auto result = HistoryMemoryStats();
+	for (const auto &item : _messages) {
+		++result.items;
+		result.bytes += item->memoryUsage();
+	}
+	for (const auto &block : blocks) {
+		result.views += block->messages.size();
+		result.bytes += sizeof(HistoryBlock)
+			+ block->messages.capacity() * sizeof(block->messages.front());
+		for (const auto &view : block->messages) {
+			result.bytes += view->data()->toHistoryMessage()
+				? sizeof(HistoryView::Message)
+				: sizeof(HistoryView::Service);
+		}
+	}
+	return result;
+}
+
 bool History::isDisplayedEmpty() const {
 	if (!loadedAtTop() || !loadedAtBottom()) {
 		return false;
@@ -3107,6 +3235,7 @@ QVector<MsgId> History::collectMessagesFromUserToDelete(
 void History::clear(ClearType type) {
 	_unreadBarView = nullptr;
 	_firstUnreadView = nullptr;
+	invalidateFirstUnreadCache();
 	removeJoinedMessage();
 
 	forgetScrollState();
@@ -3229,6 +3358,13 @@ HistoryBlock::HistoryBlock(not_null<History*> history)
 }
 
 int HistoryBlock::resizeGetHeight(int newWidth, bool resizeAllItems) {
+	if (!resizeAllItems && !_hasPendingResizedItems) {
+		// With thousands of loaded messages most of the blocks don't
+		// change when a single message is edited or its media is loaded.
+		return _height;
+	}
+	_hasPendingResizedItems = false;
+
 	auto y = 0;
 	for (const auto &message : messages) {
 		message->setY(y);
@@ -3255,6 +3391,8 @@ void HistoryBlock::remove(not_null<Element*> view) {
 	for (auto i = itemIndex, l = int(messages.size()); i < l; ++i) {
 		messages[i]->setIndexInBlock(i);
 	}
+	setHasPendingResizedItems();
+	_history->setHasPendingResizedItems();
 	if (messages.empty()) {
 		// Deletes this.
 		_history->removeBlock(this);
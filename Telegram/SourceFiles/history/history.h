@@ -63,6 +63,12 @@ namespace HistoryView {
 class Element;
 } // namespace HistoryView
 
+struct HistoryMemoryStats {
+	int items = 0;
+	int views = 0;
+	int64 bytes = 0;
+};
+
 enum class NewMessageType {
 	Unread,
 	Last,
@@ -95,6 +101,9 @@ public:
 
 	bool isEmpty() const;
 	bool isDisplayedEmpty() const;
+
+	// Approximate, counts items with their texts and views, not media.
+	[[nodiscard]] HistoryMemoryStats memoryStats() const;
 	Element *findFirstNonEmpty() const;
 	Element *findFirstDisplayed() const;
 	Element *findLastNonEmpty() const;
@@ -299,6 +308,7 @@ public:
 	HistoryItem *currentNotification();
 	bool hasNotification() const;
 	void skipNotification();
+	void skipNotificationsTillLast();
 	void popNotification(HistoryItem *item);
 
 	bool hasPendingResizedItems() const;
@@ -568,6 +578,13 @@ private:
 
 	HistoryItem *lastAvailableMessage() const;
 	void getNextFirstUnreadMessage();
+	[[nodiscard]] Element *computeFirstUnreadMessage();
+	[[nodiscard]] Element *walkFirstUnreadMessage(MsgId before) const;
+	[[nodiscard]] Element *advanceFirstUnreadMessage(
+		not_null<Element*> from,
+		MsgId before) const;
+	void firstUnreadAppended(not_null<Element*> view);
+	void invalidateFirstUnreadCache();
 	bool nonEmptyCountMoreThan(int count) const;
 
 	// Creates if necessary a new block for adding item.
@@ -589,6 +606,15 @@ private:
 	int _height = 0;
 	Element *_unreadBarView = nullptr;
 	Element *_firstUnreadView = nullptr;
+
+	// Result of the last first unread lookup, kept up to date when
+	// messages are appended or read to avoid walking all the blocks.
+	struct FirstUnreadCache {
+		Element *view = nullptr;
+		MsgId before = 0;
+		bool valid = false;
+	};
+	FirstUnreadCache _firstUnreadCache;
 	HistoryService *_joinedMessage = nullptr;
 	bool _loadedAtTop = false;
 	bool _loadedAtBottom = true;
@@ -654,6 +680,9 @@ public:
 	void refreshView(not_null<Element*> view);
 
 	int resizeGetHeight(int newWidth, bool resizeAllItems);
+	void setHasPendingResizedItems() {
+		_hasPendingResizedItems = true;
+	}
 	int y() const {
 		return _y;
 	}
@@ -698,5 +727,6 @@ protected:
 	int _y = 0;
 	int _height = 0;
 	int _indexInHistory = -1;
+	bool _hasPendingResizedItems = true;
 
 };
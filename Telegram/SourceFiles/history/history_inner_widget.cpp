@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/file_utilities.h"
 #include "core/crash_reports.h"
 #include "core/click_handler_types.h"
+#include "core/paint_benchmark.h"
 #include "history/history.h"
 #include "history/history_message.h"
 #include "history/view/media/history_view_media.h"
@@ -586,6 +587,9 @@ void HistoryInner::paintEmpty(
 }
 
 void HistoryInner::paintEvent(QPaintEvent *e) {
+	const auto measure = Core::PaintBenchmark::Measure(
+		"history_inner",
+		"paint");
 	if (Ui::skipPaintEvent(this, e)) {
 		return;
 	}
@@ -2213,6 +2217,9 @@ void HistoryInner::checkHistoryActivation() {
 }
 
 void HistoryInner::recountHistoryGeometry() {
+	const auto measure = Core::PaintBenchmark::Measure(
+		"history_inner",
+		"layout");
 	_contentWidth = _scroll->width();
 
 	const auto visibleHeight = _scroll->height();
@@ -2390,12 +2397,55 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	const auto till = _visibleAreaBottom + pages * visibleAreaHeight;
 	session().data().unloadHeavyViewParts(ElementDelegate(), from, till);
 	checkHistoryActivation();
+	prefetchMedia();
 
 	_emojiInteractions->visibleAreaUpdated(
 		_visibleAreaTop - _historyPaddingTop,
 		_visibleAreaBottom - _historyPaddingTop);
 }
 
+void HistoryInner::prefetchMedia() {
+	const auto range = _mediaPrefetcher.scrolled(
+		_visibleAreaTop,
+		_visibleAreaBottom);
+	const auto collect = [&](History *history, int historytop) {
+		if (historytop < 0 || !history || history->isEmpty()) {
+			return;
+		} else if (range.till <= historytop
+			|| historytop + history->height() <= range.from) {
+			return;
+		}
+		const auto &blocks = history->blocks;
+		auto blockIndex = BinarySearchBlocksOrItems<true>(
+			blocks,
+			range.from - historytop);
+		for (; blockIndex != int(blocks.size()); ++blockIndex) {
+			const auto block = blocks[blockIndex].get();
+			const auto blocktop = historytop + block->y();
+			if (blocktop >= range.till) {
+				return;
+			}
+			const auto &messages = block->messages;
+			auto itemIndex = BinarySearchBlocksOrItems<true>(
+				messages,
+				range.from - blocktop);
+			for (; itemIndex != int(messages.size()); ++itemIndex) {
+				const auto view = messages[itemIndex].get();
+				const auto itemtop = blocktop + view->y();
+				if (itemtop >= range.till) {
+					return;
+				}
+				_mediaPrefetcher.add(view, itemtop, itemtop + view->height());
+			}
+		}
+	};
+	if (range.from < range.till) {
+		collect(_migrated, migratedTop());
+		collect(_history, historyTop());
+		_mediaPrefetcher.request();
+	}
+}
+
 bool HistoryInner::displayScrollDate() const {
 	return (_visibleAreaTop <= height() - 2 * (_visibleAreaBottom - _visibleAreaTop));
 }
@@ -2650,7 +2700,11 @@ bool HistoryInner::elementIntersectsRange(
 		int from,
 		int till) const {
 	const auto top = itemTop(view);
-	if (top < 0) {
+	if (top == -2) {
+		// Recently shown chats keep their heavy parts while we're hidden,
+		// HistoryWidget unloads them when they're not warm anymore.
+		return true;
+	} else if (top < 0) {
 		return false;
 	}
 	const auto bottom = top + view->height();
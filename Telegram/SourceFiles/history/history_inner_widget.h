@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/tooltip.h"
 #include "ui/widgets/scroll_area.h"
 #include "history/view/history_view_top_bar_widget.h"
+#include "history/view/history_view_media_prefetch.h"
 
 namespace Data {
 struct Group;
@@ -73,6 +74,7 @@ public:
 	void setItemsRevealHeight(int revealHeight);
 	void changeItemsRevealHeight(int revealHeight);
 	void checkHistoryActivation();
+	void prefetchMedia();
 	void recountHistoryGeometry();
 	void updateSize();
 
@@ -355,6 +357,7 @@ private:
 	const not_null<History*> _history;
 	const std::unique_ptr<HistoryView::EmojiInteractions> _emojiInteractions;
 	std::shared_ptr<Ui::ChatTheme> _theme;
+	HistoryView::MediaPrefetcher _mediaPrefetcher;
 
 	History *_migrated = nullptr;
 	int _contentWidth = 0;
@@ -291,6 +291,23 @@ PeerData *HistoryItem::displayFrom() const {
 	return author().get();
 }
 
+int HistoryItem::textHeightFor(int textWidth) {
+	if (_textHeights[0].width == textWidth) {
+		return _textHeights[0].height;
+	} else if (_textHeights[1].width != textWidth) {
+		_textHeights[1] = {
+			.width = textWidth,
+			.height = _text.countHeight(textWidth),
+		};
+	}
+	std::swap(_textHeights[0], _textHeights[1]);
+	return _textHeights[0].height;
+}
+
+void HistoryItem::invalidateTextHeights() {
+	_textHeights = {};
+}
+
 void HistoryItem::invalidateChatListEntry() {
 	history()->session().changes().messageUpdated(
 		this,
@@ -924,7 +941,7 @@ MessageGroupId HistoryItem::groupId() const {
 }
 
 bool HistoryItem::isEmpty() const {
-	return _text.isEmpty()
+	return emptyText()
 		&& !_media
 		&& !Has<HistoryMessageLogEntryOriginal>();
 }
@@ -934,7 +951,7 @@ QString HistoryItem::notificationText() const {
 		if (_media && !serviceMsg()) {
 			return _media->notificationText();
 		} else if (!emptyText()) {
-			return _text.toString();
+			return _pendingText ? _pendingText->text : _text.toString();
 		}
 		return QString();
 	}();
@@ -948,7 +965,9 @@ ItemPreview HistoryItem::toPreview(ToPreviewOptions options) const {
 		if (_media) {
 			return _media->toPreview(options);
 		} else if (!emptyText()) {
-			return { .text = TextUtilities::Clean(_text.toString()) };
+			return { .text = TextUtilities::Clean(_pendingText
+				? _pendingText->text
+				: _text.toString()) };
 		}
 		return {};
 	}();
@@ -991,6 +1010,16 @@ HistoryItem::~HistoryItem() {
 	applyTTL(0);
 }
 
+int64 HistoryItem::memoryUsage() const {
+	const auto object = toHistoryMessage()
+		? sizeof(HistoryMessage)
+		: sizeof(HistoryService);
+	const auto length = _pendingText
+		? _pendingText->text.size()
+		: _text.length();
+	return int64(object) + length * int64(sizeof(QChar));
+}
+
 QDateTime ItemDateTime(not_null<const HistoryItem*> item) {
 	return base::unixtime::parse(item->date());
 }
@@ -167,16 +167,18 @@ public:
 	// For edit media in history_message.
 	virtual void returnSavedMedia() {};
 	void savePreviousMedia() {
-		_savedLocalEditMediaData = {
-			originalText(),
-			_media->clone(this),
-		};
+		_savedLocalEditMediaData = std::make_unique<SavedMediaData>(
+			SavedMediaData{
+				originalText(),
+				_media->clone(this),
+			});
 	}
 	[[nodiscard]] bool isEditingMedia() const {
-		return _savedLocalEditMediaData.media != nullptr;
+		return _savedLocalEditMediaData
+			&& (_savedLocalEditMediaData->media != nullptr);
 	}
 	void clearSavedMedia() {
-		_savedLocalEditMediaData = {};
+		_savedLocalEditMediaData = nullptr;
 	}
 
 	// Zero result means this message is not self-destructing right now.
@@ -358,7 +360,7 @@ public:
 	}
 
 	[[nodiscard]] bool emptyText() const {
-		return _text.isEmpty();
+		return _pendingText ? _pendingText->text.isEmpty() : _text.isEmpty();
 	}
 
 	[[nodiscard]] bool canPin() const;
@@ -441,6 +443,9 @@ public:
 
 	virtual ~HistoryItem();
 
+	// Approximate, counts the object and its text, not components or media.
+	[[nodiscard]] int64 memoryUsage() const;
+
 	MsgId id;
 
 protected:
@@ -454,6 +459,10 @@ protected:
 	virtual void markMediaAsReadHook() {
 	}
 
+	// Called when a view is created, parses the pending text.
+	virtual void validateText() {
+	}
+
 	void applyServiceDateEdition(const MTPDmessageService &data);
 	void finishEdition(int oldKeyboardTop);
 	void finishEditionToEmpty();
@@ -470,16 +479,21 @@ protected:
 	void applyTTL(const MTPDmessageService &data);
 	void applyTTL(TimeId destroyAt);
 
+	[[nodiscard]] int textHeightFor(int textWidth);
+	void invalidateTextHeights();
+
 	Ui::Text::String _text = { st::msgMinWidth };
-	int _textWidth = -1;
-	int _textHeight = 0;
+
+	// Raw text that wasn't parsed to _text yet, until a view needs it.
+	mutable std::unique_ptr<TextWithEntities> _pendingText;
 
 	struct SavedMediaData {
 		TextWithEntities text;
 		std::unique_ptr<Data::Media> media;
 	};
 
-	SavedMediaData _savedLocalEditMediaData;
+	// Only while editing media, so it is kept out of line.
+	std::unique_ptr<SavedMediaData> _savedLocalEditMediaData;
 	std::unique_ptr<Data::Media> _media;
 
 private:
@@ -487,9 +501,18 @@ private:
 	TimeId _date = 0;
 	TimeId _ttlDestroyAt = 0;
 
+	struct TextHeight {
+		int width = -1;
+		int height = 0;
+	};
+
 	HistoryView::Element *_mainView = nullptr;
 	friend class HistoryView::Element;
 
+	// Going back and forth between two widths, like when toggling the
+	// third column, doesn't break the lines of the text again.
+	std::array<TextHeight, 2> _textHeights;
+
 	MessageGroupId _groupId = MessageGroupId();
 
 };
@@ -1216,9 +1216,9 @@ void HistoryMessage::returnSavedMedia() {
 		return;
 	}
 	const auto wasGrouped = history()->owner().groups().isGrouped(this);
-	_media = std::move(_savedLocalEditMediaData.media);
-	setText(_savedLocalEditMediaData.text);
-	clearSavedMedia();
+	const auto saved = base::take(_savedLocalEditMediaData);
+	_media = std::move(saved->media);
+	setText(saved->text);
 	if (wasGrouped) {
 		history()->owner().groups().refreshMessage(this, true);
 	} else {
@@ -1574,8 +1574,29 @@ void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
 	if (_media && _media->consumeMessageText(textWithEntities)) {
 		setEmptyText();
 		return;
+	} else if (!(_flags & MessageFlag::TextValidated)) {
+		// Most of the loaded messages are never displayed, so we don't
+		// build text blocks for them until some view is created.
+		_pendingText = std::make_unique<TextWithEntities>(textWithEntities);
+		invalidateTextHeights();
+		return;
 	}
+	parseText(textWithEntities);
+}
 
+void HistoryMessage::validateText() {
+	_flags |= MessageFlag::TextValidated;
+	parsePendingText();
+}
+
+void HistoryMessage::parsePendingText() const {
+	if (const auto pending = base::take(_pendingText)) {
+		// Data accessors still may need the parsed text.
+		const_cast<HistoryMessage*>(this)->parseText(*pending);
+	}
+}
+
+void HistoryMessage::parseText(const TextWithEntities &textWithEntities) {
 	clearIsolatedEmoji();
 	const auto context = Core::MarkedTextContext{
 		.session = &history()->session()
@@ -1596,8 +1617,7 @@ void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
 		checkIsolatedEmoji();
 	}
 
-	_textWidth = -1;
-	_textHeight = 0;
+	invalidateTextHeights();
 }
 
 void HistoryMessage::reapplyText() {
@@ -1606,14 +1626,14 @@ void HistoryMessage::reapplyText() {
 }
 
 void HistoryMessage::setEmptyText() {
+	_pendingText = nullptr;
 	clearIsolatedEmoji();
 	_text.setMarkedText(
 		st::messageTextStyle,
 		{ QString(), EntitiesInText() },
 		Ui::ItemTextOptions(this));
 
-	_textWidth = -1;
-	_textHeight = 0;
+	invalidateTextHeights();
 }
 
 void HistoryMessage::clearIsolatedEmoji() {
@@ -1676,12 +1696,15 @@ void HistoryMessage::setReplyMarkup(HistoryMessageMarkupData &&markup) {
 }
 
 Ui::Text::IsolatedEmoji HistoryMessage::isolatedEmoji() const {
+	parsePendingText();
 	return _text.toIsolatedEmoji();
 }
 
 TextWithEntities HistoryMessage::originalText() const {
 	if (emptyText()) {
 		return { QString(), EntitiesInText() };
+	} else if (_pendingText) {
+		return *_pendingText;
 	}
 	return _text.toTextWithEntities();
 }
@@ -1690,11 +1713,16 @@ TextForMimeData HistoryMessage::clipboardText() const {
 	if (emptyText()) {
 		return TextForMimeData();
 	}
+	parsePendingText();
 	return _text.toTextForMimeData();
 }
 
 bool HistoryMessage::textHasLinks() const {
-	return emptyText() ? false : _text.hasLinks();
+	if (emptyText()) {
+		return false;
+	}
+	parsePendingText();
+	return _text.hasLinks();
 }
 
 void HistoryMessage::setViewsCount(int count) {
@@ -220,6 +220,9 @@ public:
 	~HistoryMessage();
 
 private:
+	void validateText() override;
+	void parseText(const TextWithEntities &textWithEntities);
+	void parsePendingText() const;
 	void setEmptyText();
 	[[nodiscard]] bool isTooOldForEdit(TimeId now) const;
 	[[nodiscard]] bool isLegacyMessage() const {
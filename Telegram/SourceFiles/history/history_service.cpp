@@ -984,8 +984,7 @@ void HistoryService::setServiceText(const PreparedText &prepared) {
 		// Link indices start with 1.
 		_text.setLink(++linkIndex, link);
 	}
-	_textWidth = -1;
-	_textHeight = 0;
+	invalidateTextHeights();
 }
 
 void HistoryService::markMediaAsReadHook() {
@@ -1186,8 +1185,7 @@ void HistoryService::removeMedia() {
 	if (!_media) return;
 
 	_media.reset();
-	_textWidth = -1;
-	_textHeight = 0;
+	invalidateTextHeights();
 	history()->owner().requestItemResize(this);
 }
 
@@ -61,6 +61,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_sponsored_messages.h"
 #include "data/data_file_origin.h"
 #include "data/data_histories.h"
+#include "data/data_messages_cache.h"
 #include "data/data_group_call.h"
 #include "data/stickers/data_stickers.h"
 #include "history/history.h"
@@ -131,6 +132,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "chat_helpers/emoji_suggestions_widget.h"
 #include "core/crash_reports.h"
 #include "core/shortcuts.h"
+#include "core/paint_benchmark.h"
 #include "support/support_common.h"
 #include "support/support_autocomplete.h"
 #include "dialogs/dialogs_key.h"
@@ -163,6 +165,7 @@ constexpr auto kSaveDraftTimeout = 1000;
 constexpr auto kSaveDraftAnywayTimeout = 5000;
 constexpr auto kSaveCloudDraftIdleTimeout = 14000;
 constexpr auto kRefreshSlowmodeLabelTimeout = crl::time(200);
+constexpr auto kWarmHistoriesLimit = size_t(3);
 constexpr auto kCommonModifiers = 0
 	| Qt::ShiftModifier
 	| Qt::MetaModifier
@@ -497,9 +500,18 @@ HistoryWidget::HistoryWidget(
 	}, lifetime());
 
 	session().data().viewResizeRequest(
-	) | rpl::start_with_next([=](not_null<HistoryView::Element*> view) {
-		if (view->data()->mainView() == view) {
-			updateHistoryGeometry();
+	) | rpl::filter([=](not_null<HistoryView::Element*> view) {
+		return (view->data()->mainView() == view);
+	}) | rpl::start_with_next([=] {
+		// Many views are resized together, for example when a batch of
+		// reply targets arrives, so the geometry is updated once for all.
+		if (!_updateHistoryGeometryScheduled) {
+			_updateHistoryGeometryScheduled = true;
+			crl::on_main(this, [=] {
+				if (base::take(_updateHistoryGeometryScheduled)) {
+					updateHistoryGeometry();
+				}
+			});
 		}
 	}, lifetime());
 
@@ -1495,6 +1507,9 @@ void HistoryWidget::toggleChooseChatTheme(not_null<PeerData*> peer) {
 void HistoryWidget::fieldChanged() {
 	const auto updateTyping = (_textUpdateEvents & TextUpdateEvent::SendTyping);
 
+	// Don't compete with the app for CPU while the user is typing.
+	controller()->tabbedSelector()->cancelStickersWarmup();
+
 	InvokeQueued(this, [=] {
 		updateInlineBotQuery();
 		const auto choosingSticker = updateStickersByEmoji();
@@ -2005,6 +2020,7 @@ void HistoryWidget::showHistory(
 		}
 
 		_history->showAtMsgId = _showAtMsgId;
+		rememberWarmHistory(_history);
 
 		destroyUnreadBarOnClose();
 		_pinnedBar = nullptr;
@@ -2033,7 +2049,6 @@ void HistoryWidget::showHistory(
 	_replyEditMsg = nullptr;
 	_editMsgId = _replyToId = 0;
 	_previewData = nullptr;
-	_previewCache.clear();
 	_fieldBarCancel->hide();
 
 	_membersDropdownShowTimer.cancel();
@@ -2045,8 +2060,17 @@ void HistoryWidget::showHistory(
 	_historyInited = false;
 	_contactStatus = nullptr;
 
-	// Unload lottie animations.
-	session().data().unloadHeavyViewParts(HistoryInner::ElementDelegate());
+	// Unload lottie animations, except the ones of recently shown chats.
+	auto keepHeavyParts = std::vector<not_null<History*>>();
+	for (const auto history : _warmHistories) {
+		keepHeavyParts.push_back(history);
+		if (const auto migrated = history->migrateFrom()) {
+			keepHeavyParts.push_back(migrated);
+		}
+	}
+	session().data().unloadHeavyViewParts(
+		HistoryInner::ElementDelegate(),
+		keepHeavyParts);
 
 	if (peerId) {
 		_peer = session().data().peer(peerId);
@@ -2217,6 +2241,10 @@ void HistoryWidget::showHistory(
 	controller()->floatPlayerAreaUpdated();
 
 	crl::on_main(this, [=] { controller()->widget()->setInnerFocus(); });
+
+	if (_history && Core::PaintBenchmark::Enabled()) {
+		Core::PaintBenchmark::ScriptScroll(_scroll.data(), "history_scroll");
+	}
 }
 
 void HistoryWidget::setHistory(History *history) {
@@ -2227,6 +2255,18 @@ void HistoryWidget::setHistory(History *history) {
 	_history = history;
 	_migrated = _history ? _history->migrateFrom() : nullptr;
 	registerDraftSource();
+	markHistoriesShown();
+}
+
+void HistoryWidget::markHistoriesShown() {
+	_historiesShownLifetime.destroy();
+	auto &histories = session().data().histories();
+	if (_history) {
+		_historiesShownLifetime.add(histories.markShown(_history));
+	}
+	if (_migrated) {
+		_historiesShownLifetime.add(histories.markShown(_migrated));
+	}
 }
 
 void HistoryWidget::unregisterDraftSources() {
@@ -2283,6 +2323,16 @@ void HistoryWidget::clearDelayedShowAtRequest() {
 	}
 }
 
+void HistoryWidget::rememberWarmHistory(not_null<History*> history) {
+	_warmHistories.erase(
+		ranges::remove(_warmHistories, history),
+		end(_warmHistories));
+	_warmHistories.insert(begin(_warmHistories), history);
+	if (_warmHistories.size() > kWarmHistoriesLimit) {
+		_warmHistories.resize(kWarmHistoriesLimit);
+	}
+}
+
 void HistoryWidget::clearAllLoadRequests() {
 	Expects(_history != nullptr);
 
@@ -2292,6 +2342,11 @@ void HistoryWidget::clearAllLoadRequests() {
 		histories.cancelRequest(_firstLoadRequest);
 		_firstLoadRequest = 0;
 	}
+	if (_cachedFirstLoadRequest) {
+		histories.cancelRequest(_cachedFirstLoadRequest);
+		_cachedFirstLoadRequest = 0;
+		destroyCachedMessages();
+	}
 	if (_preloadRequest) {
 		histories.cancelRequest(_preloadRequest);
 		_preloadRequest = 0;
@@ -2732,6 +2787,10 @@ void HistoryWidget::messagesFailed(const MTP::Error &error, int requestId) {
 	} else if (_firstLoadRequest == requestId) {
 		_firstLoadRequest = 0;
 		controller()->showBackFromStack();
+	} else if (_cachedFirstLoadRequest == requestId) {
+		// Keep showing the cached messages.
+		_cachedFirstLoadRequest = 0;
+		_cachedMessageIds.clear();
 	} else if (_delayedShowAtRequest == requestId) {
 		_delayedShowAtRequest = 0;
 	}
@@ -2748,6 +2807,8 @@ void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages
 			_preloadDownRequest = 0;
 		} else if (_firstLoadRequest == requestId) {
 			_firstLoadRequest = 0;
+		} else if (_cachedFirstLoadRequest == requestId) {
+			_cachedFirstLoadRequest = 0;
 		} else if (_delayedShowAtRequest == requestId) {
 			_delayedShowAtRequest = 0;
 		}
@@ -2813,6 +2874,8 @@ void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages
 		}
 
 		historyLoaded();
+	} else if (_cachedFirstLoadRequest == requestId) {
+		replaceCachedMessages(peer, *histList);
 	} else if (_delayedShowAtRequest == requestId) {
 		if (toMigrated) {
 			_history->clear(History::ClearType::Unload);
@@ -2852,6 +2915,74 @@ void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages
 	}
 }
 
+void HistoryWidget::cachedMessagesReceived(QVector<MTPMessage> &&messages) {
+	Expects(_history != nullptr);
+
+	if (!_firstLoadRequest || !_history->isEmpty() || messages.isEmpty()) {
+		return;
+	}
+
+	// Remember what the cache has created to reconcile with the server.
+	const auto &owner = _history->owner();
+	const auto channel = _history->channelId();
+	for (const auto &message : messages) {
+		const auto id = IdFromMessage(message);
+		if (!owner.message(channel, id)) {
+			_cachedMessageIds.push_back(id);
+		}
+	}
+	addMessagesToFront(_peer, messages);
+	_cachedFirstLoadRequest = base::take(_firstLoadRequest);
+	historyLoaded();
+}
+
+void HistoryWidget::replaceCachedMessages(
+		PeerData *peer,
+		const QVector<MTPMessage> &messages) {
+	Expects(_history != nullptr);
+
+	_cachedFirstLoadRequest = 0;
+	clearAllLoadRequests();
+
+	auto &owner = _history->owner();
+	const auto channel = _history->channelId();
+	auto received = base::flat_set<MsgId>();
+	received.reserve(messages.size());
+	for (const auto &message : messages) {
+		received.emplace(IdFromMessage(message));
+	}
+	for (const auto id : base::take(_cachedMessageIds)) {
+		if (!received.contains(id)) {
+			if (const auto item = owner.message(channel, id)) {
+				item->destroy();
+			}
+		} else {
+			// The cached version could be outdated.
+			const auto i = ranges::find(messages, id, IdFromMessage);
+			owner.updateEditedMessage(*i);
+		}
+	}
+
+	_history->clear(History::ClearType::Unload);
+	_firstLoadRequest = -1; // hack - don't updateListSize yet
+	addMessagesToFront(peer, messages);
+	_firstLoadRequest = 0;
+	historyLoaded();
+}
+
+void HistoryWidget::destroyCachedMessages() {
+	Expects(_history != nullptr);
+
+	// The cached messages were never confirmed by the server.
+	const auto &owner = _history->owner();
+	const auto channel = _history->channelId();
+	for (const auto id : base::take(_cachedMessageIds)) {
+		if (const auto item = owner.message(channel, id)) {
+			item->destroy();
+		}
+	}
+}
+
 void HistoryWidget::historyLoaded() {
 	_historyInited = false;
 	doneShow();
@@ -2927,9 +3058,11 @@ void HistoryWidget::firstLoadMessages() {
 	const auto historyHash = uint64(0);
 
 	const auto history = from;
+	const auto lastPage = !offsetId && !offset;
 	const auto type = Data::Histories::RequestType::History;
 	auto &histories = history->owner().histories();
-	_firstLoadRequest = histories.sendRequest(history, type, [=](Fn<void()> finish) {
+	const auto requestId = std::make_shared<int>();
+	*requestId = _firstLoadRequest = histories.sendRequest(history, type, [=](Fn<void()> finish) {
 		return history->session().api().request(MTPmessages_GetHistory(
 			history->peer->input,
 			MTP_int(offsetId),
@@ -2940,13 +3073,33 @@ void HistoryWidget::firstLoadMessages() {
 			MTP_int(minId),
 			MTP_long(historyHash)
 		)).done([=](const MTPmessages_Messages &result) {
-			messagesReceived(history->peer, result, _firstLoadRequest);
+			if (lastPage) {
+				Data::CacheLastMessages(history, result);
+			}
+			messagesReceived(history->peer, result, *requestId);
 			finish();
 		}).fail([=](const MTP::Error &error) {
-			messagesFailed(error, _firstLoadRequest);
+			messagesFailed(error, *requestId);
 			finish();
 		}).send();
 	});
+
+	// The cached last page has the first unread message in it as well.
+	const auto unreadInLastPage = (_showAtMsgId == ShowAtUnreadMsgId)
+		&& (_history->unreadCount() < kMessagesPerPageFirst);
+	if ((lastPage || unreadInLastPage)
+		&& history == _history
+		&& !_migrated
+		&& _history->isEmpty()) {
+		const auto firstLoadRequest = _firstLoadRequest;
+		Data::ReadCachedLastMessages(history, crl::guard(this, [=](
+				QVector<MTPMessage> &&messages) {
+			if (_history == history
+				&& _firstLoadRequest == firstLoadRequest) {
+				cachedMessagesReceived(std::move(messages));
+			}
+		}));
+	}
 }
 
 void HistoryWidget::loadMessages() {
@@ -5016,6 +5169,7 @@ void HistoryWidget::updateHistoryGeometry(
 		_updateHistoryGeometryRequired = true;
 		return; // scrollTopMax etc are not working after recountHistoryGeometry()
 	}
+	_updateHistoryGeometryScheduled = false;
 
 	auto newScrollHeight = height() - _topBar->height();
 	if (_pinnedBar) {
@@ -5637,6 +5791,7 @@ void HistoryWidget::handlePeerMigration() {
 		channel->session().api().requestParticipantsCountDelayed(channel);
 	} else {
 		_migrated = _history->migrateFrom();
+		markHistoriesShown();
 		_list->notifyMigrateUpdated();
 		setupPinnedTracker();
 		setupGroupCallBar();
@@ -6547,8 +6702,8 @@ void HistoryWidget::checkPreview() {
 				previewCancel();
 			}
 		} else {
-			const auto i = _previewCache.constFind(links);
-			if (i == _previewCache.cend()) {
+			const auto cached = session().data().webpagePreview(links);
+			if (!cached) {
 				_previewRequest = _api.request(MTPmessages_GetWebPagePreview(
 					MTP_flags(0),
 					MTP_string(links),
@@ -6556,8 +6711,8 @@ void HistoryWidget::checkPreview() {
 				)).done([=](const MTPMessageMedia &result, mtpRequestId requestId) {
 					gotPreview(links, result, requestId);
 				}).send();
-			} else if (i.value()) {
-				_previewData = session().data().webpage(i.value());
+			} else if (*cached) {
+				_previewData = session().data().webpage(*cached);
 				updatePreview();
 			} else if (_previewData && _previewData->pendingTill >= 0) {
 				previewCancel();
@@ -6592,7 +6747,7 @@ void HistoryWidget::gotPreview(
 	if (result.type() == mtpc_messageMediaWebPage) {
 		const auto &data = result.c_messageMediaWebPage().vwebpage();
 		const auto page = session().data().processWebpage(data);
-		_previewCache.insert(links, page->id);
+		session().data().rememberWebpagePreview(links, page->id);
 		if (page->pendingTill > 0
 			&& page->pendingTill <= base::unixtime::now()) {
 			page->pendingTill = -1;
@@ -6606,7 +6761,7 @@ void HistoryWidget::gotPreview(
 		}
 		session().data().sendWebPageGamePollNotifications();
 	} else if (result.type() == mtpc_messageMediaEmpty) {
-		_previewCache.insert(links, 0);
+		session().data().rememberWebpagePreview(links, 0);
 		if (links == _previewLinks
 			&& _previewState == Data::PreviewState::Allowed) {
 			_previewData = nullptr;
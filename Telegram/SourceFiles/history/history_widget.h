@@ -234,6 +234,7 @@ public:
 		Ui::ReportReason reason,
 		Fn<void(MessageIdsList)> callback);
 	void clearAllLoadRequests();
+	void rememberWarmHistory(not_null<History*> history);
 	void clearDelayedShowAtRequest();
 	void clearDelayedShowAt();
 	void saveFieldToHistoryLocalDraft();
@@ -535,6 +536,11 @@ private:
 	void messagesFailed(const MTP::Error &error, int requestId);
 	void addMessagesToFront(PeerData *peer, const QVector<MTPMessage> &messages);
 	void addMessagesToBack(PeerData *peer, const QVector<MTPMessage> &messages);
+	void cachedMessagesReceived(QVector<MTPMessage> &&messages);
+	void replaceCachedMessages(
+		PeerData *peer,
+		const QVector<MTPMessage> &messages);
+	void destroyCachedMessages();
 
 	void updateHistoryGeometry(bool initial = false, bool loadedDown = false, const ScrollChange &change = { ScrollChangeNone, 0 });
 	void updateListSize();
@@ -569,6 +575,7 @@ private:
 	void unregisterDraftSources();
 	void registerDraftSource();
 	void setHistory(History *history);
+	void markHistoriesShown();
 	void setEditMsgId(MsgId msgId);
 
 	HistoryItem *getItemFromHistoryOrMigrated(MsgId genericMsgId) const;
@@ -647,8 +654,6 @@ private:
 	QStringList _parsedLinks;
 	QString _previewLinks;
 	WebPageData *_previewData = nullptr;
-	typedef QMap<QString, WebPageId> PreviewCache;
-	PreviewCache _previewCache;
 	mtpRequestId _previewRequest = 0;
 	Ui::Text::String _previewTitle;
 	Ui::Text::String _previewDescription;
@@ -667,6 +672,8 @@ private:
 	MsgId _showAtMsgId = ShowAtUnreadMsgId;
 
 	int _firstLoadRequest = 0; // Not real mtpRequestId.
+	int _cachedFirstLoadRequest = 0; // Not real mtpRequestId.
+	std::vector<MsgId> _cachedMessageIds;
 	int _preloadRequest = 0; // Not real mtpRequestId.
 	int _preloadDownRequest = 0; // Not real mtpRequestId.
 
@@ -678,10 +685,13 @@ private:
 	QPointer<HistoryInner> _list;
 	History *_migrated = nullptr;
 	History *_history = nullptr;
+	std::vector<not_null<History*>> _warmHistories;
+	rpl::lifetime _historiesShownLifetime;
 	// Initial updateHistoryGeometry() was called.
 	bool _historyInited = false;
 	// If updateListSize() was called without updateHistoryGeometry().
 	bool _updateHistoryGeometryRequired = false;
+	bool _updateHistoryGeometryScheduled = false;
 
 	int _lastScrollTop = 0; // gifs optimization
 	crl::time _lastScrolled = 0;
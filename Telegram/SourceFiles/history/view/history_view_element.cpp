@@ -327,6 +327,7 @@ Element::Element(
 , _dateTime(_isScheduledUntilOnline ? QDateTime() : ItemDateTime(data))
 , _context(delegate->elementContext()) {
 	history()->owner().registerItemView(this);
+	_data->validateText();
 	refreshMedia(replacing);
 	if (_context == Context::History) {
 		history()->setHasPendingResizedItems();
@@ -433,6 +434,9 @@ void Element::setPendingResize() {
 	_flags |= Flag::NeedsResize;
 	if (_context == Context::History) {
 		data()->_history->setHasPendingResizedItems();
+		if (_block) {
+			_block->setHasPendingResizedItems();
+		}
 	}
 }
 
@@ -833,6 +837,7 @@ void Element::attachToBlock(not_null<HistoryBlock*> block, int index) {
 	_block = block;
 	_indexInBlock = index;
 	_data->setMainView(this);
+	_block->setHasPendingResizedItems();
 	previousInBlocksChanged();
 }
 
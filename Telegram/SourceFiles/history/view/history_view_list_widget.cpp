@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwindow.h"
 #include "mainwidget.h"
 #include "core/click_handler_types.h"
+#include "core/paint_benchmark.h"
 #include "apiwrap.h"
 #include "layout/layout_selection.h"
 #include "window/window_adaptive.h"
@@ -748,9 +749,33 @@ void ListWidget::visibleTopBottomUpdated(
 		scrollDateHideByTimer();
 	}
 	_controller->floatPlayerAreaUpdated();
+	prefetchMedia();
 	_applyUpdatedScrollState.call();
 }
 
+void ListWidget::prefetchMedia() {
+	const auto range = _mediaPrefetcher.scrolled(_visibleTop, _visibleBottom);
+	if (range.from >= range.till || _items.empty()) {
+		return;
+	}
+	auto i = std::lower_bound(
+		begin(_items),
+		end(_items),
+		range.from,
+		[this](auto &elem, int top) {
+			return this->itemTop(elem) + elem->height() <= top;
+		});
+	for (; i != end(_items); ++i) {
+		const auto view = i->get();
+		const auto top = itemTop(view);
+		if (top >= range.till) {
+			break;
+		}
+		_mediaPrefetcher.add(view, top, top + view->height());
+	}
+	_mediaPrefetcher.request();
+}
+
 void ListWidget::applyUpdatedScrollState() {
 	checkMoveToOtherViewer();
 	_delegate->listVisibleItemsChanged(collectVisibleItems());
@@ -1514,6 +1539,9 @@ void ListWidget::revealItemsCallback() {
 }
 
 int ListWidget::resizeGetHeight(int newWidth) {
+	const auto measure = Core::PaintBenchmark::Measure(
+		"history_list",
+		"layout");
 	update();
 
 	const auto resizeAllItems = (_itemsWidth != newWidth);
@@ -1604,6 +1632,9 @@ TextSelection ListWidget::itemRenderSelection(
 }
 
 void ListWidget::paintEvent(QPaintEvent *e) {
+	const auto measure = Core::PaintBenchmark::Measure(
+		"history_list",
+		"paint");
 	if (Ui::skipPaintEvent(this, e)) {
 		return;
 	}
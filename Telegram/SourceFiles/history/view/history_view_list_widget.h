@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/sender.h"
 #include "data/data_messages.h"
 #include "history/view/history_view_element.h"
+#include "history/view/history_view_media_prefetch.h"
 
 namespace Main {
 class Session;
@@ -382,6 +383,7 @@ private:
 
 	void checkMoveToOtherViewer();
 	void updateVisibleTopItem();
+	void prefetchMedia();
 	void updateItemsGeometry();
 	void updateSize();
 	void refreshAttachmentsFromTill(int from, int till);
@@ -551,6 +553,7 @@ private:
 	int _scrollDateLastItemTop = 0;
 	ClickHandlerPtr _scrollDateLink;
 	SingleQueuedInvokation _applyUpdatedScrollState;
+	MediaPrefetcher _mediaPrefetcher;
 
 	MessagesBar _bar;
 	rpl::variable<QString> _barText;
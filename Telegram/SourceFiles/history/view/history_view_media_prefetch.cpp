@@ -0,0 +1,143 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "history/view/history_view_media_prefetch.h"
+
+#include "history/view/history_view_element.h"
+#include "history/history_item.h"
+#include "data/data_media_types.h"
+#include "data/data_web_page.h"
+#include "data/data_photo.h"
+#include "data/data_document.h"
+
+namespace HistoryView {
+namespace {
+
+constexpr auto kLookAheadTime = crl::time(1000);
+constexpr auto kMaxLookAheadScreens = 4;
+constexpr auto kScrollIdleTimeout = crl::time(300);
+constexpr auto kPrefetchBytesLimit = 2 * 1024 * 1024;
+constexpr auto kRaisePriorityScreenPart = 4;
+constexpr auto kMaxRememberedFiles = 1024;
+
+} // namespace
+
+auto MediaPrefetcher::scrolled(int visibleTop, int visibleBottom) -> Range {
+	const auto now = crl::now();
+	const auto shift = visibleTop - _visibleTop;
+	const auto elapsed = now - _scrollTime;
+	if (!_scrollTime || elapsed > kScrollIdleTimeout) {
+		_speed = 0.;
+	} else if (shift) {
+		const auto speed = std::abs(shift) / float64(std::max(elapsed, crl::time(1)));
+		_speed = (_speed + speed) / 2.;
+	}
+	if (shift) {
+		_scrollingUp = (shift < 0);
+	}
+	_scrollTime = now;
+	_visibleTop = visibleTop;
+	_visibleBottom = visibleBottom;
+
+	const auto height = visibleBottom - visibleTop;
+	const auto ahead = std::clamp(
+		int(base::SafeRound(_speed * kLookAheadTime)),
+		height,
+		height * kMaxLookAheadScreens);
+	return _scrollingUp
+		? Range{ visibleTop - ahead, visibleTop }
+		: Range{ visibleBottom, visibleBottom + ahead };
+}
+
+void MediaPrefetcher::add(not_null<Element*> view, int top, int bottom) {
+	const auto distance = (top >= _visibleBottom)
+		? (top - _visibleBottom)
+		: (bottom <= _visibleTop)
+		? (_visibleTop - bottom)
+		: -1;
+	if (distance >= 0 && view->data()->media()) {
+		_candidates.push_back({ view, distance });
+	}
+}
+
+void MediaPrefetcher::request() {
+	ranges::sort(_candidates, ranges::less(), &Candidate::distance);
+
+	if (_photos.size() > kMaxRememberedFiles) {
+		_photos.clear();
+	}
+	if (_documents.size() > kMaxRememberedFiles) {
+		_documents.clear();
+	}
+	const auto raiseDistance = (_visibleBottom - _visibleTop)
+		/ kRaisePriorityScreenPart;
+	auto loading = 0;
+	for (const auto &candidate : base::take(_candidates)) {
+		if (loading >= kPrefetchBytesLimit) {
+			break;
+		}
+		const auto item = candidate.view->data();
+		const auto media = item->media();
+		if (!media) {
+			continue;
+		}
+		const auto raise = (candidate.distance < raiseDistance);
+		const auto page = media->webpage();
+		const auto photo = page ? page->photo : media->photo();
+		const auto document = page ? page->document : media->document();
+		if (photo) {
+			loading += prefetch(photo, item->fullId(), raise);
+		}
+		if (document) {
+			loading += prefetch(document, item->fullId(), raise);
+		}
+	}
+}
+
+int MediaPrefetcher::prefetch(
+		not_null<PhotoData*> photo,
+		FullMsgId itemId,
+		bool raise) {
+	using Data::PhotoSize;
+	if (!photo->hasExact(PhotoSize::Small)
+		&& !photo->hasExact(PhotoSize::Thumbnail)) {
+		return 0;
+	} else if (_photos.emplace(photo).second) {
+		if (raise) {
+			photo->load(PhotoSize::Small, itemId, LoadFromCloudOrLocal, true);
+		} else {
+			photo->prefetch(PhotoSize::Small, itemId);
+		}
+	} else if (!photo->loading(PhotoSize::Small)) {
+		return 0;
+	} else if (raise) {
+		photo->load(PhotoSize::Small, itemId, LoadFromCloudOrLocal, true);
+	}
+	return photo->imageByteSize(PhotoSize::Small);
+}
+
+int MediaPrefetcher::prefetch(
+		not_null<DocumentData*> document,
+		FullMsgId itemId,
+		bool raise) {
+	if (!document->hasThumbnail()) {
+		return 0;
+	} else if (_documents.emplace(document).second) {
+		if (raise) {
+			document->loadThumbnail(itemId);
+		} else {
+			document->prefetchThumbnail(itemId);
+		}
+	} else if (!document->thumbnailLoading()) {
+		return 0;
+	} else if (raise) {
+		document->loadThumbnail(itemId);
+	}
+	return document->thumbnailByteSize();
+}
+
+} // namespace HistoryView
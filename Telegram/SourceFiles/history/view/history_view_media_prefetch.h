@@ -0,0 +1,59 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class PhotoData;
+class DocumentData;
+
+namespace HistoryView {
+
+class Element;
+
+// Requests small photos and thumbnails of the messages ahead of the
+// viewport in the scroll direction, nearest first, while the files that
+// are still loading fit in the prefetch budget.
+class MediaPrefetcher final {
+public:
+	struct Range {
+		int from = 0;
+		int till = 0;
+	};
+
+	// Returns the area where the widget should look for candidates.
+	[[nodiscard]] Range scrolled(int visibleTop, int visibleBottom);
+	void add(not_null<Element*> view, int top, int bottom);
+	void request();
+
+private:
+	struct Candidate {
+		not_null<Element*> view;
+		int distance = 0;
+	};
+
+	[[nodiscard]] int prefetch(
+		not_null<PhotoData*> photo,
+		FullMsgId itemId,
+		bool raise);
+	[[nodiscard]] int prefetch(
+		not_null<DocumentData*> document,
+		FullMsgId itemId,
+		bool raise);
+
+	int _visibleTop = 0;
+	int _visibleBottom = 0;
+	crl::time _scrollTime = 0;
+	float64 _speed = 0.; // Pixels per millisecond.
+	bool _scrollingUp = false;
+
+	std::vector<Candidate> _candidates;
+	base::flat_set<not_null<PhotoData*>> _photos;
+	base::flat_set<not_null<DocumentData*>> _documents;
+
+};
+
+} // namespace HistoryView
@@ -344,12 +344,10 @@ QSize Message::performCountOptimalSize() {
 
 		if (mediaOnBottom || (mediaDisplayed && _viewButton)) {
 			if (item->_text.removeSkipBlock()) {
-				item->_textWidth = -1;
-				item->_textHeight = 0;
+				item->invalidateTextHeights();
 			}
 		} else if (item->_text.updateSkipBlock(skipBlockWidth(), skipBlockHeight())) {
-			item->_textWidth = -1;
-			item->_textHeight = 0;
+			item->invalidateTextHeights();
 		}
 
 		maxWidth = plainMaxWidth();
@@ -2596,11 +2594,7 @@ int Message::resizeContentGetHeight(int newWidth) {
 		} else {
 			if (hasVisibleText()) {
 				auto textWidth = qMax(contentWidth - st::msgPadding.left() - st::msgPadding.right(), 1);
-				if (textWidth != item->_textWidth) {
-					item->_textWidth = textWidth;
-					item->_textHeight = item->_text.countHeight(textWidth);
-				}
-				newHeight = item->_textHeight;
+				newHeight = item->textHeightFor(textWidth);
 			} else {
 				newHeight = 0;
 			}
@@ -2720,8 +2714,7 @@ void Message::initTime() const {
 	}
 	if (item->_text.hasSkipBlock()) {
 		if (item->_text.updateSkipBlock(skipBlockWidth(), skipBlockHeight())) {
-			item->_textWidth = -1;
-			item->_textHeight = 0;
+			item->invalidateTextHeights();
 		}
 	}
 }
@@ -49,6 +49,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/file_utilities.h"
 #include "main/main_session.h"
 #include "data/data_session.h"
+#include "data/data_histories.h"
 #include "data/data_user.h"
 #include "data/data_chat.h"
 #include "data/data_channel.h"
@@ -1558,7 +1559,9 @@ void RepliesWidget::restoreState(not_null<RepliesMemento*> memento) {
 	if (auto replies = memento->getReplies()) {
 		setReplies(std::move(replies));
 	} else if (!_replies) {
-		setReplies(std::make_shared<Data::RepliesList>(_history, _rootId));
+		setReplies(_history->owner().histories().repliesList(
+			_history,
+			_rootId));
 	}
 	restoreReplyReturns(memento->replyReturns());
 	_inner->restoreState(memento->list());
@@ -414,9 +414,7 @@ QSize Service::performCountCurrentSize(int newWidth) {
 	const auto item = message();
 	const auto media = this->media();
 
-	if (item->_text.isEmpty()) {
-		item->_textHeight = 0;
-	} else {
+	if (!item->_text.isEmpty()) {
 		auto contentWidth = newWidth;
 		if (delegate()->elementIsChatWide()) {
 			accumulate_min(contentWidth, st::msgMaxWidth + 2 * st::msgPhotoSkip + 2 * st::msgMargin.left());
@@ -427,14 +425,10 @@ QSize Service::performCountCurrentSize(int newWidth) {
 		}
 
 		auto nwidth = qMax(contentWidth - st::msgServicePadding.left() - st::msgServicePadding.right(), 0);
-		if (nwidth != item->_textWidth) {
-			item->_textWidth = nwidth;
-			item->_textHeight = item->_text.countHeight(nwidth);
-		}
 		if (contentWidth >= maxWidth()) {
 			newHeight += minHeight();
 		} else {
-			newHeight += item->_textHeight;
+			newHeight += item->textHeightFor(nwidth);
 		}
 		newHeight += st::msgServicePadding.top() + st::msgServicePadding.bottom() + st::msgServiceMargin.top() + st::msgServiceMargin.bottom();
 		if (media) {
@@ -144,8 +144,22 @@ TopBarWidget::TopBarWidget(
 		session().data().sendActionManager().animationUpdated(
 		) | rpl::filter([=](const AnimationUpdate &update) {
 			return (update.history == _activeChat.key.history());
-		}) | rpl::start_with_next([=] {
-			update();
+		}) | rpl::start_with_next([=](const AnimationUpdate &update) {
+			if (update.textUpdated) {
+				this->update();
+				return;
+			}
+			const auto statustop = st::topBarHeight
+				- st::topBarArrowPadding.bottom()
+				- st::dialogsTextFont->height;
+			const auto height = std::max(
+				update.height,
+				st::dialogsTextFont->height);
+			rtlupdate(
+				_leftTaken + update.left,
+				statustop,
+				update.width,
+				height);
 		}, lifetime());
 	}
 
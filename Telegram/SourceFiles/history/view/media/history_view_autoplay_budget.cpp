@@ -0,0 +1,75 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "history/view/media/history_view_autoplay_budget.h"
+
+namespace HistoryView {
+namespace {
+
+// Roughly two 720p streams at 30 fps.
+constexpr auto kPixelsPerSecondLimit = int64(2) * 1280 * 720 * 30;
+constexpr auto kAssumedFrameRate = 30;
+constexpr auto kStaleTimeout = crl::time(1000);
+
+} // namespace
+
+AutoplayBudget &AutoplayBudget::Instance() {
+	static auto result = AutoplayBudget();
+	return result;
+}
+
+bool AutoplayBudget::request(
+		not_null<const void*> key,
+		QSize size,
+		QRect geometry,
+		QRect viewport,
+		crl::time now) {
+	clearStale(now);
+
+	const auto delta = geometry.center() - viewport.center();
+	auto &entry = _entries[key];
+	entry.cost = int64(std::max(size.width(), 1))
+		* std::max(size.height(), 1)
+		* kAssumedFrameRate;
+	entry.distance = int64(delta.x()) * delta.x()
+		+ int64(delta.y()) * delta.y();
+	entry.seen = now;
+
+	auto closer = int64(0);
+	for (const auto &[other, data] : _entries) {
+		if (other == key) {
+			continue;
+		} else if (data.distance < entry.distance
+			|| (data.distance == entry.distance && other < key)) {
+			closer += data.cost;
+			if (closer >= kPixelsPerSecondLimit) {
+				return false;
+			}
+		}
+	}
+	return !closer || (closer + entry.cost <= kPixelsPerSecondLimit);
+}
+
+void AutoplayBudget::forget(not_null<const void*> key) {
+	_entries.remove(key);
+}
+
+void AutoplayBudget::clearStale(crl::time now) {
+	if (now - _clearedAt < kStaleTimeout / 2) {
+		return;
+	}
+	_clearedAt = now;
+	for (auto i = _entries.begin(); i != _entries.end();) {
+		if (now - i->second.seen > kStaleTimeout) {
+			i = _entries.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+} // namespace HistoryView
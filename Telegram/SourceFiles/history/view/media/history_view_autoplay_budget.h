@@ -0,0 +1,41 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace HistoryView {
+
+// Shared limit of decoded pixels per second for autoplaying inline media.
+// Candidates closest to the viewport center are granted first, the rest
+// keep showing their current (or thumbnail) frame until budget frees up.
+class AutoplayBudget final {
+public:
+	[[nodiscard]] static AutoplayBudget &Instance();
+
+	[[nodiscard]] bool request(
+		not_null<const void*> key,
+		QSize size,
+		QRect geometry,
+		QRect viewport,
+		crl::time now);
+	void forget(not_null<const void*> key);
+
+private:
+	struct Entry {
+		int64 cost = 0;
+		int64 distance = 0;
+		crl::time seen = 0;
+	};
+
+	void clearStale(crl::time now);
+
+	base::flat_map<not_null<const void*>, Entry> _entries;
+	crl::time _clearedAt = 0;
+
+};
+
+} // namespace HistoryView
@@ -23,6 +23,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "history/view/history_view_element.h"
 #include "history/view/history_view_cursor_state.h"
+#include "history/view/media/history_view_autoplay_budget.h"
 #include "history/view/media/history_view_media_common.h"
 #include "window/window_session_controller.h"
 #include "core/application.h" // Application::showDocument.
@@ -94,6 +95,7 @@ Gif::Gif(
 }
 
 Gif::~Gif() {
+	AutoplayBudget::Instance().forget(this);
 	if (_streamed || _dataMedia) {
 		if (_streamed) {
 			_data->owner().streaming().keepAlive(_data);
@@ -276,6 +278,20 @@ bool Gif::autoplayEnabled() const {
 		_data);
 }
 
+bool Gif::autoplayOverBudget(
+		const PaintContext &context,
+		QRect geometry) const {
+	const auto size = _data->dimensions.isEmpty()
+		? geometry.size()
+		: _data->dimensions;
+	return !AutoplayBudget::Instance().request(
+		this,
+		size,
+		geometry,
+		context.viewport,
+		context.now);
+}
+
 void Gif::draw(Painter &p, const PaintContext &context) const {
 	if (width() < st::msgPadding.left() + st::msgPadding.right() + 1) return;
 
@@ -293,7 +309,11 @@ void Gif::draw(Painter &p, const PaintContext &context) const {
 		&& canBePlayed
 		&& CanPlayInline(_data);
 	const auto activeRoundPlaying = activeRoundStreamed();
+	const auto overBudget = autoplay
+		&& !activeRoundPlaying
+		&& autoplayOverBudget(context, QRect(0, 0, width(), height()));
 	const auto startPlay = autoplay
+		&& !overBudget
 		&& !_streamed
 		&& !activeRoundPlaying;
 	if (startPlay) {
@@ -368,7 +388,7 @@ void Gif::draw(Painter &p, const PaintContext &context) const {
 	auto roundCorners = (isRound || inWebPage) ? RectPart::AllCorners : ((isBubbleTop() ? (RectPart::TopLeft | RectPart::TopRight) : RectPart::None)
 		| ((isRoundedInBubbleBottom() && _caption.isEmpty()) ? (RectPart::BottomLeft | RectPart::BottomRight) : RectPart::None));
 	if (streamed) {
-		auto paused = autoPaused;
+		auto paused = autoPaused || overBudget;
 		if (isRound) {
 			if (activeRoundStreamed()) {
 				paused = false;
@@ -920,7 +940,9 @@ void Gif::drawGrouped(
 		&& autoplayEnabled()
 		&& canBePlayed
 		&& CanPlayInline(_data);
-	const auto startPlay = autoplay && !_streamed;
+	const auto overBudget = autoplay
+		&& autoplayOverBudget(context, geometry);
+	const auto startPlay = autoplay && !overBudget && !_streamed;
 	if (startPlay) {
 		const_cast<Gif*>(this)->playAnimation(true);
 	} else {
@@ -953,7 +975,7 @@ void Gif::drawGrouped(
 	const auto roundRadius = ImageRoundRadius::Large;
 
 	if (streamed) {
-		const auto paused = autoPaused;
+		const auto paused = autoPaused || overBudget;
 		auto request = ::Media::Streaming::FrameRequest();
 		const auto original = sizeForAspectRatio();
 		const auto originalWidth = style::ConvertScale(original.width());
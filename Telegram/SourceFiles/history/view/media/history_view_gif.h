@@ -126,6 +126,9 @@ private:
 	void refreshCaption();
 
 	[[nodiscard]] bool autoplayEnabled() const;
+	[[nodiscard]] bool autoplayOverBudget(
+		const PaintContext &context,
+		QRect geometry) const;
 
 	void playAnimation(bool autoplay) override;
 	QSize countOptimalSize() override;
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item.h"
 #include "history/history.h"
 #include "ui/image/image.h"
+#include "ui/emoji_config.h"
 #include "ui/chat/chat_style.h"
 #include "data/data_file_origin.h"
 #include "styles/style_chat.h"
@@ -84,8 +85,18 @@ void LargeEmoji::draw(
 				? prepared->pixColored(context.st->msgStickerOverlay(), w, h)
 				: prepared->pix(w, h);
 			p.drawPixmap(x, y, pixmap);
-		} else if (image->load) {
-			image->load();
+		} else {
+			// Show the regular emoji until the large one is prepared.
+			const auto esize = Ui::Emoji::GetSizeLarge() / cIntRetinaFactor();
+			Ui::Emoji::Draw(
+				p,
+				image->emoji,
+				Ui::Emoji::GetSizeLarge(),
+				x + (w - esize) / 2,
+				y + (size.height() - esize) / 2);
+			if (image->load) {
+				image->load();
+			}
 		}
 		x += w + skip;
 	}
@@ -28,7 +28,7 @@ constexpr auto kMaxForwardedBarLines = 4;
 auto UnwrappedMedia::Content::stickerTakeLottie(
 	not_null<DocumentData*> data,
 	const Lottie::ColorReplacements *replacements)
--> std::unique_ptr<Lottie::SinglePlayer> {
+-> std::shared_ptr<Lottie::SinglePlayer> {
 	return nullptr;
 }
 
@@ -386,7 +386,7 @@ TextState UnwrappedMedia::textState(QPoint point, StateRequest request) const {
 	return result;
 }
 
-std::unique_ptr<Lottie::SinglePlayer> UnwrappedMedia::stickerTakeLottie(
+std::shared_ptr<Lottie::SinglePlayer> UnwrappedMedia::stickerTakeLottie(
 		not_null<DocumentData*> data,
 		const Lottie::ColorReplacements *replacements) {
 	return _content->stickerTakeLottie(data, replacements);
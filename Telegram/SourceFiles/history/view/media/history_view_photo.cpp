@@ -268,9 +268,20 @@ void Photo::draw(Painter &p, const PaintContext &context) const {
 		auto roundCorners = inWebPage ? RectPart::AllCorners : ((isBubbleTop() ? (RectPart::TopLeft | RectPart::TopRight) : RectPart::None)
 			| ((isRoundedInBubbleBottom() && _caption.isEmpty()) ? (RectPart::BottomLeft | RectPart::BottomRight) : RectPart::None));
 		const auto pix = [&] {
-			if (const auto large = _dataMedia->image(PhotoSize::Large)) {
-				return large->pixSingle(_pixw, _pixh, paintw, painth, roundRadius, roundCorners);
-			} else if (const auto thumbnail = _dataMedia->image(
+			const auto large = _dataMedia->image(PhotoSize::Large);
+			if (large) {
+				const auto owner = &history()->owner();
+				const auto itemId = _realParent->fullId();
+				const auto ready = [=] {
+					if (const auto item = owner->message(itemId)) {
+						owner->requestItemRepaint(item);
+					}
+				};
+				if (const auto prepared = large->pixSingleAsync(ready, _pixw, _pixh, paintw, painth, roundRadius, roundCorners)) {
+					return *prepared;
+				}
+			}
+			if (const auto thumbnail = _dataMedia->image(
 					PhotoSize::Thumbnail)) {
 				return thumbnail->pixBlurredSingle(_pixw, _pixh, paintw, painth, roundRadius, roundCorners);
 			} else if (const auto small = _dataMedia->image(
@@ -278,6 +289,8 @@ void Photo::draw(Painter &p, const PaintContext &context) const {
 				return small->pixBlurredSingle(_pixw, _pixh, paintw, painth, roundRadius, roundCorners);
 			} else if (const auto blurred = _dataMedia->thumbnailInline()) {
 				return blurred->pixBlurredSingle(_pixw, _pixh, paintw, painth, roundRadius, roundCorners);
+			} else if (large) {
+				return large->pixSingle(_pixw, _pixh, paintw, painth, roundRadius, roundCorners);
 			} else {
 				return QPixmap();
 			}
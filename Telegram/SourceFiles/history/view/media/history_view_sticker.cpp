@@ -54,6 +54,54 @@ constexpr auto kMaxEmojiSizeFixed = 256;
 	return image;
 }
 
+struct SharedLottieKey {
+	not_null<DocumentData*> document;
+	const Lottie::ColorReplacements *replacements = nullptr;
+	QSize box;
+
+	friend inline bool operator<(
+			const SharedLottieKey &a,
+			const SharedLottieKey &b) {
+		return std::make_tuple(
+			a.document.get(),
+			a.replacements,
+			a.box.width(),
+			a.box.height()
+		) < std::make_tuple(
+			b.document.get(),
+			b.replacements,
+			b.box.width(),
+			b.box.height());
+	}
+};
+
+// Views of the same looping sticker of the same size share one player,
+// so decoding and frame memory don't grow with the count of messages.
+template <typename Create>
+[[nodiscard]] std::shared_ptr<Lottie::SinglePlayer> SharedLottiePlayer(
+		const SharedLottieKey &key,
+		Create &&create) {
+	static auto Players = base::flat_map<
+		SharedLottieKey,
+		std::weak_ptr<Lottie::SinglePlayer>>();
+	const auto i = Players.find(key);
+	if (i != end(Players)) {
+		if (auto result = i->second.lock()) {
+			return result;
+		}
+	}
+	for (auto j = begin(Players); j != end(Players);) {
+		if (j->second.expired()) {
+			j = Players.erase(j);
+		} else {
+			++j;
+		}
+	}
+	auto result = std::shared_ptr<Lottie::SinglePlayer>(create());
+	Players[key] = result;
+	return result;
+}
+
 } // namespace
 
 Sticker::Sticker(
@@ -157,9 +205,12 @@ void Sticker::paintLottie(
 		Painter &p,
 		const PaintContext &context,
 		const QRect &r) {
+	// The shared player frame must not depend on the selection
+	// of one of the views, so we color it here instead.
+	const auto shared = (_lottie.use_count() > 1);
 	auto request = Lottie::FrameRequest();
 	request.box = _size * cIntRetinaFactor();
-	if (context.selected() && !_nextLastDiceFrame) {
+	if (context.selected() && !_nextLastDiceFrame && !shared) {
 		request.colored = context.st->msgStickerOverlay()->c;
 	}
 	const auto frame = _lottie
@@ -172,7 +223,8 @@ void Sticker::paintLottie(
 	const auto &image = _lastDiceFrame.isNull()
 		? frame.image
 		: _lastDiceFrame;
-	const auto prepared = (!_lastDiceFrame.isNull() && context.selected())
+	const auto colorHere = (!_lastDiceFrame.isNull() || shared);
+	const auto prepared = (colorHere && context.selected())
 		? Images::prepareColored(context.st->msgStickerOverlay()->c, image)
 		: image;
 	const auto size = prepared.size() / cIntRetinaFactor();
@@ -344,15 +396,28 @@ void Sticker::setDiceIndex(const QString &emoji, int index) {
 	_diceIndex = index;
 }
 
+bool Sticker::lottieShareable() const {
+	// Play-once and dice stickers keep the playback state per view.
+	return (_diceIndex < 0)
+		&& !isEmojiSticker()
+		&& Core::App().settings().loopAnimatedStickers();
+}
+
 void Sticker::setupLottie() {
 	Expects(_dataMedia != nullptr);
 
-	_lottie = ChatHelpers::LottiePlayerFromDocument(
-		_dataMedia.get(),
-		_replacements,
-		ChatHelpers::StickerLottieSize::MessageHistory,
-		size() * cIntRetinaFactor(),
-		Lottie::Quality::High);
+	const auto box = size() * cIntRetinaFactor();
+	const auto create = [&] {
+		return ChatHelpers::LottiePlayerFromDocument(
+			_dataMedia.get(),
+			_replacements,
+			ChatHelpers::StickerLottieSize::MessageHistory,
+			box,
+			Lottie::Quality::High);
+	};
+	_lottie = lottieShareable()
+		? SharedLottiePlayer({ _data, _replacements, box }, create)
+		: std::shared_ptr<Lottie::SinglePlayer>(create());
 	lottieCreated();
 }
 
@@ -392,7 +457,7 @@ void Sticker::unloadLottie() {
 	_parent->checkHeavyPart();
 }
 
-std::unique_ptr<Lottie::SinglePlayer> Sticker::stickerTakeLottie(
+std::shared_ptr<Lottie::SinglePlayer> Sticker::stickerTakeLottie(
 		not_null<DocumentData*> data,
 		const Lottie::ColorReplacements *replacements) {
 	return (data == _data && replacements == _replacements)
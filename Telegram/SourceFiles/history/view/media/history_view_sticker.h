@@ -53,7 +53,7 @@ public:
 	void stickerClearLoopPlayed() override {
 		_lottieOncePlayed = false;
 	}
-	std::unique_ptr<Lottie::SinglePlayer> stickerTakeLottie(
+	std::shared_ptr<Lottie::SinglePlayer> stickerTakeLottie(
 		not_null<DocumentData*> data,
 		const Lottie::ColorReplacements *replacements) override;
 
@@ -91,6 +91,7 @@ private:
 	void ensureDataMediaCreated() const;
 	void dataMediaCreated() const;
 
+	[[nodiscard]] bool lottieShareable() const;
 	void setupLottie();
 	void lottieCreated();
 	void unloadLottie();
@@ -99,7 +100,7 @@ private:
 	const not_null<Element*> _parent;
 	const not_null<DocumentData*> _data;
 	const Lottie::ColorReplacements *_replacements = nullptr;
-	std::unique_ptr<Lottie::SinglePlayer> _lottie;
+	std::shared_ptr<Lottie::SinglePlayer> _lottie;
 	mutable std::shared_ptr<Data::DocumentMedia> _dataMedia;
 	ClickHandlerPtr _link;
 	QSize _size;
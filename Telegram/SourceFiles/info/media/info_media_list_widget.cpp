@@ -41,6 +41,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "boxes/delete_messages_box.h"
 #include "boxes/peer_list_controllers.h"
 #include "core/file_utilities.h"
+#include "core/paint_benchmark.h"
 #include "facades.h"
 
 #include <QtWidgets/QApplication>
@@ -767,6 +768,7 @@ void ListWidget::restart() {
 
 	_universalAroundId = kDefaultAroundId;
 	_idsLimit = kMinimalIdsLimit;
+	_idsAheadBefore = _idsAheadAfter = 0;
 	_slice = SparseIdsMergedSlice(sliceKey(_universalAroundId));
 
 	refreshViewer();
@@ -996,8 +998,8 @@ void ListWidget::refreshViewer() {
 	const auto idForViewer = sliceKey(_universalAroundId).universalId;
 	_controller->mediaSource(
 		idForViewer,
-		_idsLimit,
-		_idsLimit
+		_idsLimit + _idsAheadBefore,
+		_idsLimit + _idsAheadAfter
 	) | rpl::start_with_next([=](SparseIdsMergedSlice &&slice) {
 		if (!slice.fullCount()) {
 			// Don't display anything while full count is unknown.
@@ -1170,6 +1172,9 @@ void ListWidget::restoreState(not_null<Memento*> memento) {
 }
 
 int ListWidget::resizeGetHeight(int newWidth) {
+	const auto measure = Core::PaintBenchmark::Measure(
+		"info_media_list",
+		"layout");
 	if (newWidth > 0) {
 		for (auto &section : _sections) {
 			section.resizeToWidth(newWidth);
@@ -1310,7 +1315,7 @@ void ListWidget::checkMoveToOtherViewer() {
 		- kPreloadIfLessThanScreens;
 	auto minUniversalIdDelta = (minScreenDelta * visibleHeight)
 		/ minItemHeight;
-	auto preloadAroundItem = [&](const FoundItem &item) {
+	auto preloadAroundItem = [&](const FoundItem &item, bool bottom) {
 		auto preloadRequired = false;
 		auto universalId = GetUniversalId(item.layout);
 		if (!preloadRequired) {
@@ -1324,16 +1329,20 @@ void ListWidget::checkMoveToOtherViewer() {
 			preloadRequired = (qAbs(*delta) >= minUniversalIdDelta);
 		}
 		if (preloadRequired) {
+			// Ask for more ids in the scroll direction, so that the next
+			// slice request goes out as soon as the previous one arrives.
 			_idsLimit = preloadIdsLimit;
+			_idsAheadBefore = bottom ? preloadIdsLimit : 0;
+			_idsAheadAfter = bottom ? 0 : preloadIdsLimit;
 			_universalAroundId = universalId;
 			refreshViewer();
 		}
 	};
 
 	if (preloadTop && !topLoaded) {
-		preloadAroundItem(topItem);
+		preloadAroundItem(topItem, false);
 	} else if (preloadBottom && !bottomLoaded) {
-		preloadAroundItem(bottomItem);
+		preloadAroundItem(bottomItem, true);
 	}
 }
 
@@ -1403,6 +1412,9 @@ QMargins ListWidget::padding() const {
 }
 
 void ListWidget::paintEvent(QPaintEvent *e) {
+	const auto measure = Core::PaintBenchmark::Measure(
+		"info_media_list",
+		"paint");
 	Painter p(this);
 
 	auto outerWidth = width();
@@ -303,6 +303,8 @@ private:
 	static constexpr auto kDefaultAroundId = (ServerMaxMsgId - 1);
 	UniversalMsgId _universalAroundId = kDefaultAroundId;
 	int _idsLimit = kMinimalIdsLimit;
+	int _idsAheadBefore = 0;
+	int _idsAheadAfter = 0;
 	SparseIdsMergedSlice _slice;
 
 	std::unordered_map<UniversalMsgId, CachedItem> _layouts;
@@ -25,6 +25,17 @@ constexpr auto kCloudLangPackName = "tdesktop"_cs;
 constexpr auto kCustomLanguage = "#custom"_cs;
 constexpr auto kLangValuesLimit = 20000;
 
+enum class CompiledValueFlag : uchar {
+	Own = (1 << 0),
+	Base = (1 << 1),
+};
+
+struct CompiledValue {
+	ushort index = 0;
+	uchar flags = 0;
+	QString value;
+};
+
 std::vector<QString> PrepareDefaultValues() {
 	auto result = std::vector<QString>();
 	result.reserve(kKeysCount);
@@ -210,6 +221,42 @@ void ParseKeyValue(
 	}
 }
 
+// Parsed values are appended after the raw key-value pairs, so that
+// the startup doesn't run ValueParser for every string again. Key
+// indices are valid only for the app version that wrote them.
+[[nodiscard]] bool ReadCompiledValues(
+		QDataStream &stream,
+		std::vector<CompiledValue> &values) {
+	if (stream.atEnd()) {
+		return false;
+	}
+	qint32 appVersion = 0, count = 0;
+	stream >> appVersion >> count;
+	if (stream.status() != QDataStream::Ok
+		|| appVersion != AppVersion
+		|| count < 0
+		|| count > kKeysCount) {
+		return false;
+	}
+	values.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		quint16 index = 0;
+		quint8 flags = 0;
+		QString value;
+		stream >> index >> flags >> value;
+		if (stream.status() != QDataStream::Ok || index >= kKeysCount) {
+			values.clear();
+			return false;
+		}
+		values.push_back({
+			.index = ushort(index),
+			.flags = uchar(flags),
+			.value = std::move(value),
+		});
+	}
+	return true;
+}
+
 } // namespace
 
 QString DefaultLanguageId() {
@@ -399,6 +446,31 @@ QByteArray Instance::serialize() const {
 	const auto base = _base ? _base->serialize() : QByteArray();
 	size += Serialize::bytearraySize(base);
 
+	auto compiled = std::vector<CompiledValue>();
+	if (!_derived) {
+		for (auto i = 0; i != kKeysCount; ++i) {
+			const auto flags = uchar(0
+				| (_nonDefaultSet[i] ? uchar(CompiledValueFlag::Own) : 0)
+				| ((_base && _base->_nonDefaultSet[i])
+					? uchar(CompiledValueFlag::Base)
+					: 0));
+			if (flags) {
+				compiled.push_back({
+					.index = ushort(i),
+					.flags = flags,
+					.value = _values[i],
+				});
+			}
+		}
+		size += sizeof(qint32) // AppVersion
+			+ sizeof(qint32); // compiled.size()
+		for (const auto &value : compiled) {
+			size += sizeof(quint16)
+				+ sizeof(quint8)
+				+ Serialize::stringSize(value.value);
+		}
+	}
+
 	auto result = QByteArray();
 	result.reserve(size);
 	{
@@ -420,6 +492,15 @@ QByteArray Instance::serialize() const {
 			stream << nonDefault.first << nonDefault.second;
 		}
 		stream << base;
+		if (!_derived) {
+			stream << qint32(AppVersion) << qint32(compiled.size());
+			for (const auto &value : compiled) {
+				stream
+					<< quint16(value.index)
+					<< quint8(value.flags)
+					<< value.value;
+			}
+		}
 	}
 	return result;
 }
@@ -427,6 +508,13 @@ QByteArray Instance::serialize() const {
 void Instance::fillFromSerialized(
 		const QByteArray &data,
 		int dataAppVersion) {
+	fillFromSerialized(data, dataAppVersion, true);
+}
+
+void Instance::fillFromSerialized(
+		const QByteArray &data,
+		int dataAppVersion,
+		bool parseValues) {
 	QDataStream stream(data);
 	stream.setVersion(QDataStream::Qt_5_1);
 	qint32 serializeVersion = 0;
@@ -527,9 +615,14 @@ void Instance::fillFromSerialized(
 	} else {
 		stream >> base;
 	}
+	auto compiled = std::vector<CompiledValue>();
+	const auto useCompiled = parseValues
+		&& !legacyFormat
+		&& !_derived
+		&& ReadCompiledValues(stream, compiled);
 	if (!base.isEmpty()) {
 		_base = std::make_unique<Instance>(this, PrivateTag{});
-		_base->fillFromSerialized(base, dataAppVersion);
+		_base->fillFromSerialized(base, dataAppVersion, !useCompiled);
 	}
 
 	_id = id;
@@ -546,7 +639,20 @@ void Instance::fillFromSerialized(
 	_customFileContent = customFileContent;
 	LOG(("Lang Info: Loaded cached, keys: %1").arg(nonDefaultValuesCount));
 	for (auto i = 0, count = nonDefaultValuesCount * 2; i != count; i += 2) {
-		applyValue(nonDefaultStrings[i], nonDefaultStrings[i + 1]);
+		if (parseValues && !useCompiled) {
+			applyValue(nonDefaultStrings[i], nonDefaultStrings[i + 1]);
+		} else {
+			storeValue(nonDefaultStrings[i], nonDefaultStrings[i + 1]);
+		}
+	}
+	for (auto &value : compiled) {
+		if (value.flags & uchar(CompiledValueFlag::Own)) {
+			_nonDefaultSet[value.index] = 1;
+		}
+		if (_base && (value.flags & uchar(CompiledValueFlag::Base))) {
+			_base->_nonDefaultSet[value.index] = 1;
+		}
+		_values[value.index] = std::move(value.value);
 	}
 	updatePluralRules();
 	updateChoosingStickerReplacement();
@@ -752,6 +858,11 @@ void Instance::applyValue(const QByteArray &key, const QByteArray &value) {
 	});
 }
 
+void Instance::storeValue(const QByteArray &key, const QByteArray &value) {
+	// Parsed values will be taken from the compiled table.
+	_nonDefaultValues.emplace_hint(end(_nonDefaultValues), key, value);
+}
+
 void Instance::updatePluralRules() {
 	if (_pluralId.isEmpty()) {
 		_pluralId = isCustom()
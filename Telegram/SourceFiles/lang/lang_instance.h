@@ -109,6 +109,11 @@ public:
 
 private:
 	void setBaseId(const QString &baseId, const QString &pluralId);
+	void fillFromSerialized(
+		const QByteArray &data,
+		int dataAppVersion,
+		bool parseValues);
+	void storeValue(const QByteArray &key, const QByteArray &value);
 
 	void applyDifferenceToMe(const MTPDlangPackDifference &difference);
 	void applyValue(const QByteArray &key, const QByteArray &value);
@@ -134,7 +134,12 @@ void AbstractMosaicLayout::addItems(
 }
 
 void AbstractMosaicLayout::setRightSkip(int rightSkip) {
-	_rightSkip = rightSkip;
+	if (_rightSkip != rightSkip) {
+		_rightSkip = rightSkip;
+		for (auto &row : _rows) {
+			row.layoutWidth = -1;
+		}
+	}
 }
 
 void AbstractMosaicLayout::setOffset(int left, int top) {
@@ -289,6 +294,7 @@ int AbstractMosaicLayout::validateExistingRows(
 			_rows[untilRow].items,
 			0,
 			[](int w, auto &row) { return w + row->maxWidth(); });
+		_rows[untilRow].layoutWidth = -1;
 		layoutRow(_rows[untilRow], _width);
 		return until;
 	}
@@ -352,6 +358,14 @@ void AbstractMosaicLayout::layoutRow(Row &row, int fullWidth) {
 	const auto count = int(row.items.size());
 	Assert(count <= kInlineItemsMaxPerRow);
 
+	// Items of a row don't change after it is finalized, so resizing to
+	// the same width again (appending items, repeated resize events with
+	// only the height changed) can skip the row entirely.
+	if (row.layoutWidth == fullWidth) {
+		return;
+	}
+	row.layoutWidth = fullWidth;
+
 	// Enumerate items in the order of growing maxWidth()
 	// for that sort item indices by maxWidth().
 	int indices[kInlineItemsMaxPerRow];
@@ -63,6 +63,7 @@ private:
 	struct Row {
 		int maxWidth = 0;
 		int height = 0;
+		int layoutWidth = -1;
 		std::vector<AbstractLayoutItem*> items;
 	};
 
@@ -11,8 +11,15 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "core/launcher.h"
 
+#include <condition_variable>
+#include <thread>
+
 namespace {
 
+constexpr auto kDebugWriteInterval = std::chrono::milliseconds(100);
+constexpr auto kDebugWriteBatchSize = 256 * 1024;
+constexpr auto kMaxPendingDebugSize = 16 * 1024 * 1024;
+
 std::atomic<int> ThreadCounter/* = 0*/;
 thread_local bool WritingEntryFlag/* = false*/;
 
@@ -77,6 +84,9 @@ public:
 			files[i].reset(new QFile());
 		}
 	}
+	~LogsDataFields() {
+		stopDebugWriter();
+	}
 
 	bool openMain() {
 		return reopen(LogDataMain, 0, qsl("start"));
@@ -110,12 +120,13 @@ public:
 	}
 
 	void write(LogDataType type, const QString &msg) {
+		if (type != LogDataMain) {
+			enqueueDebug(type, msg);
+			return;
+		}
 		QMutexLocker lock(_logsMutex(type));
 		WritingEntryScope scope;
 
-		if (type != LogDataMain) {
-			reopenDebug();
-		}
 		const auto file = files[type].get();
 		if (!file || !file->isOpen()) {
 			return;
@@ -125,8 +136,92 @@ public:
 	}
 
 private:
+	// Debug logs are written by a separate thread in batches, so that
+	// the threads writing them don't wait for the disk on each entry.
+	// The main log is still written and flushed right away.
+	void enqueueDebug(LogDataType type, const QString &msg) {
+		auto utf8 = msg.toUtf8();
+		auto lock = std::unique_lock(_pendingMutex);
+		if (_pendingStopped) {
+			return;
+		} else if (_pendingSize + utf8.size() > kMaxPendingDebugSize) {
+			++_pendingDropped[type];
+			return;
+		}
+		_pendingSize += utf8.size();
+		_pending[type].append(utf8);
+		if (!_writer.joinable()) {
+			_writer = std::thread([=] { debugWriterLoop(); });
+		}
+		if (_pendingSize >= kDebugWriteBatchSize) {
+			lock.unlock();
+			_pendingChanged.notify_one();
+		}
+	}
+
+	void debugWriterLoop() {
+		auto lock = std::unique_lock(_pendingMutex);
+		while (true) {
+			_pendingChanged.wait_for(lock, kDebugWriteInterval, [&] {
+				return _pendingStopped
+					|| (_pendingSize >= kDebugWriteBatchSize);
+			});
+			auto pending = base::take(_pending);
+			const auto dropped = base::take(_pendingDropped);
+			const auto stopped = _pendingStopped;
+			_pendingSize = 0;
+			lock.unlock();
+
+			writeDebugBatch(std::move(pending), dropped);
+			if (stopped) {
+				return;
+			}
+			lock.lock();
+		}
+	}
+
+	void writeDebugBatch(
+			std::array<QByteArray, LogDataCount> &&pending,
+			const std::array<int, LogDataCount> &dropped) {
+		WritingEntryScope scope;
+
+		reopenDebug();
+		for (auto type = int(LogDataDebug); type != LogDataCount; ++type) {
+			auto &data = pending[type];
+			if (dropped[type]) {
+				data.append(QString("[%1 log entries dropped]\n"
+				).arg(dropped[type]).toUtf8());
+			}
+			const auto file = files[type].get();
+			if (data.isEmpty() || !file || !file->isOpen()) {
+				continue;
+			}
+			file->write(data);
+			file->flush();
+		}
+	}
+
+	void stopDebugWriter() {
+		{
+			auto lock = std::unique_lock(_pendingMutex);
+			_pendingStopped = true;
+		}
+		_pendingChanged.notify_one();
+		if (_writer.joinable()) {
+			_writer.join();
+		}
+	}
+
 	std::unique_ptr<QFile> files[LogDataCount];
 
+	std::mutex _pendingMutex;
+	std::condition_variable _pendingChanged;
+	std::array<QByteArray, LogDataCount> _pending;
+	std::array<int, LogDataCount> _pendingDropped = { { 0 } };
+	int _pendingSize = 0;
+	bool _pendingStopped = false;
+	std::thread _writer;
+
 	int32 part = -1;
 
 	bool reopen(LogDataType type, int32 dayIndex, const QString &postfix) {
@@ -200,6 +200,10 @@ void Account::destroySession(DestroyReason reason) {
 		return;
 	}
 
+	if (reason == DestroyReason::Quitting) {
+		local().writePendingStickers();
+	}
+
 	_sessionValue = nullptr;
 
 	if (reason == DestroyReason::LoggedOut) {
@@ -10,9 +10,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/shortcuts.h"
 #include "core/crash_reports.h"
+#include "core/startup_phases.h"
 #include "main/main_account.h"
 #include "main/main_session.h"
 #include "data/data_session.h"
+#include "data/data_histories.h"
 #include "data/data_changes.h"
 #include "data/data_user.h"
 #include "mtproto/mtproto_config.h"
@@ -62,6 +64,7 @@ bool Domain::started() const {
 Storage::StartResult Domain::start(const QByteArray &passcode) {
 	Expects(!started());
 
+	const auto phase = Core::StartupPhases::Phase("domain_start");
 	const auto result = _local->start(passcode);
 	if (result == Storage::StartResult::Success) {
 		activateAfterStarting();
@@ -407,9 +410,15 @@ void Domain::activate(not_null<Main::Account*> account) {
 	auto wasAuthed = false;
 
 	_activeLifetime.destroy();
-	if (_active.current()) {
+	if (const auto was = _active.current()) {
 		_lastActiveIndex = _accountToActivate;
-		wasAuthed = _active.current()->sessionExists();
+		wasAuthed = was->sessionExists();
+		if (const auto session = was->maybeSession()) {
+			// Background accounts keep only the chats list loaded.
+			crl::on_main(session, [=] {
+				session->data().histories().unloadHidden();
+			});
+		}
 	}
 	_accountToActivate = i->index;
 	_active = account.get();
@@ -92,6 +92,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/shortcuts.h"
 #include "core/application.h"
 #include "core/changelogs.h"
+#include "core/startup_phases.h"
 #include "base/unixtime.h"
 #include "calls/calls_call.h"
 #include "calls/calls_instance.h"
@@ -1925,6 +1926,7 @@ void MainWidget::animationCallback() {
 }
 
 void MainWidget::paintEvent(QPaintEvent *e) {
+	Core::StartupPhases::Finish("first_paint");
 	if (_background) {
 		checkChatBackground();
 	}
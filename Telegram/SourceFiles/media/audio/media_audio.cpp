@@ -34,6 +34,8 @@ namespace {
 constexpr auto kSuppressRatioAll = 0.2;
 constexpr auto kSuppressRatioSong = 0.05;
 constexpr auto kWaveformCounterBufferSize = 256 * 1024;
+constexpr auto kWaveformFullDecodeDuration = 5 * 60 * crl::time(1000);
+constexpr auto kWaveformSampledWindow = crl::time(200);
 constexpr auto kEffectDestructionDelay = crl::time(1000);
 
 QMutex AudioMutex;
@@ -461,8 +463,50 @@ void Mixer::Track::clear() {
 	}
 
 	setExternalData(nullptr);
-	lastUpdateWhen = 0;
-	lastUpdatePosition = 0;
+	publishSyncPoint(0, 0, 0);
+	++generation;
+}
+
+void Mixer::Track::publishSyncPoint(
+		uint32 externalPlayId,
+		crl::time position,
+		crl::time when) {
+	// Writers are serialized by AudioMutex, readers only retry.
+	const auto sequence = _syncPoint.sequence.load(std::memory_order_relaxed);
+	_syncPoint.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	_syncPoint.externalPlayId.store(externalPlayId, std::memory_order_relaxed);
+	_syncPoint.position.store(position, std::memory_order_relaxed);
+	_syncPoint.when.store(when, std::memory_order_relaxed);
+	_syncPoint.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+Streaming::TimePoint Mixer::Track::readSyncPoint(
+		uint32 externalPlayId) const {
+	while (true) {
+		const auto before = _syncPoint.sequence.load(
+			std::memory_order_acquire);
+		if (before & 1) {
+			continue;
+		}
+		const auto id = _syncPoint.externalPlayId.load(
+			std::memory_order_relaxed);
+		const auto position = _syncPoint.position.load(
+			std::memory_order_relaxed);
+		const auto when = _syncPoint.when.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const auto after = _syncPoint.sequence.load(
+			std::memory_order_relaxed);
+		if (before != after) {
+			continue;
+		}
+		auto result = Streaming::TimePoint();
+		if (id == externalPlayId && when > 0) {
+			result.trackTime = position;
+			result.worldTime = when;
+		}
+		return result;
+	}
 }
 
 void Mixer::Track::started() {
@@ -906,29 +950,30 @@ Streaming::TimePoint Mixer::getExternalSyncTimePoint(
 		const AudioMsgId &audio) const {
 	Expects(audio.externalPlayId() != 0);
 
-	auto result = Streaming::TimePoint();
+	// Called by the video threads for each frame, so it doesn't lock.
 	const auto type = audio.type();
-
-	QMutexLocker lock(&AudioMutex);
-	const auto track = trackForType(type);
-	if (track && track->state.id == audio && track->lastUpdateWhen > 0) {
-		result.trackTime = track->lastUpdatePosition;
-		result.worldTime = track->lastUpdateWhen;
+	const auto count = (type == AudioMsgId::Type::Video) ? 1 : kTogetherLimit;
+	for (auto i = 0; i != count; ++i) {
+		const auto track = trackForType(type, i);
+		if (!track) {
+			break;
+		}
+		const auto result = track->readSyncPoint(audio.externalPlayId());
+		if (result) {
+			return result;
+		}
 	}
-	return result;
+	return Streaming::TimePoint();
 }
 
 crl::time Mixer::getExternalCorrectedTime(const AudioMsgId &audio, crl::time frameMs, crl::time systemMs) {
-	auto result = frameMs;
-	const auto type = audio.type();
-
-	QMutexLocker lock(&AudioMutex);
-	const auto track = trackForType(type);
-	if (track && track->state.id == audio && track->lastUpdateWhen > 0) {
-		result = static_cast<crl::time>(track->lastUpdatePosition);
-		if (systemMs > track->lastUpdateWhen) {
-			result += (systemMs - track->lastUpdateWhen);
-		}
+	const auto point = getExternalSyncTimePoint(audio);
+	if (!point) {
+		return frameMs;
+	}
+	auto result = point.trackTime;
+	if (systemMs > point.worldTime) {
+		result += (systemMs - point.worldTime);
 	}
 	return result;
 }
@@ -940,8 +985,10 @@ void Mixer::externalSoundProgress(const AudioMsgId &audio) {
 	const auto current = trackForType(type);
 	if (current && current->state.length && current->state.frequency) {
 		if (current->state.id == audio && current->state.state == State::Playing) {
-			current->lastUpdateWhen = crl::now();
-			current->lastUpdatePosition = (current->state.position * 1000ULL) / current->state.frequency;
+			current->publishSyncPoint(
+				audio.externalPlayId(),
+				(current->state.position * 1000ULL) / current->state.frequency,
+				crl::now());
 		}
 	}
 }
@@ -1724,20 +1771,59 @@ public:
 		if (!FFMpegLoader::open(positionMs)) {
 			return false;
 		}
+		if (samplesCount() < Media::Player::kWaveformSamplesCount) {
+			return false;
+		}
 
+		const auto duration = samplesCount() * 1000 / samplesFrequency();
+		auto peaks = (duration > kWaveformFullDecodeDuration)
+			? countPeaksSampled()
+			: countPeaks();
+		if (peaks.isEmpty()) {
+			return false;
+		}
+
+		auto sum = std::accumulate(peaks.cbegin(), peaks.cend(), 0LL);
+		const auto peak = uint16(
+			qMax(int32(sum * 1.8 / peaks.size()), 2500));
+
+		result.resize(peaks.size());
+		for (int32 i = 0, l = peaks.size(); i != l; ++i) {
+			result[i] = char(qMin(31U, uint32(qMin(peaks.at(i), peak)) * 31 / peak));
+		}
+
+		return true;
+	}
+
+	const VoiceWaveform &waveform() const {
+		return result;
+	}
+
+	~FFMpegWaveformCounter() {
+	}
+
+private:
+	template <typename Callback>
+	void iterateSamples(const QByteArray &buffer, Callback &&callback) {
+		const auto fmt = format();
+		const auto sampleBytes = bytes::make_span(buffer);
+		if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
+			Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
+		} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
+			Media::Audio::IterateSamples<int16>(sampleBytes, callback);
+		}
+	}
+
+	QVector<uint16> countPeaks() {
 		QByteArray buffer;
 		buffer.reserve(kWaveformCounterBufferSize);
 		int64 countbytes = sampleSize() * samplesCount();
 		int64 processed = 0;
 		int64 sumbytes = 0;
-		if (samplesCount() < Media::Player::kWaveformSamplesCount) {
-			return false;
-		}
 
 		QVector<uint16> peaks;
 		peaks.reserve(Media::Player::kWaveformSamplesCount);
 
-		auto fmt = format();
 		auto peak = uint16(0);
 		auto callback = [&](uint16 sample) {
 			accumulate_max(peak, sample);
@@ -1759,42 +1845,54 @@ public:
 			if (buffer.isEmpty()) {
 				continue;
 			}
-
-			auto sampleBytes = bytes::make_span(buffer);
-			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
-				Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
-			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
-			}
+			iterateSamples(buffer, callback);
 			processed += sampleSize() * samples;
 		}
 		if (sumbytes > 0 && peaks.size() < Media::Player::kWaveformSamplesCount) {
 			peaks.push_back(peak);
 		}
+		return peaks;
+	}
 
-		if (peaks.isEmpty()) {
-			return false;
-		}
+	// Long files are not decoded fully, each bar gets the peak
+	// of a short window decoded after a seek to the bar start.
+	QVector<uint16> countPeaksSampled() {
+		const auto count = Media::Player::kWaveformSamplesCount;
+		const auto duration = samplesCount() * 1000 / samplesFrequency();
+		const auto window = int64(samplesFrequency())
+			* kWaveformSampledWindow
+			/ 1000;
 
-		auto sum = std::accumulate(peaks.cbegin(), peaks.cend(), 0LL);
-		peak = qMax(int32(sum * 1.8 / peaks.size()), 2500);
+		QByteArray buffer;
+		buffer.reserve(kWaveformCounterBufferSize);
 
-		result.resize(peaks.size());
-		for (int32 i = 0, l = peaks.size(); i != l; ++i) {
-			result[i] = char(qMin(31U, uint32(qMin(peaks.at(i), peak)) * 31 / peak));
+		QVector<uint16> peaks;
+		peaks.reserve(count);
+		for (auto i = 0; i != count; ++i) {
+			if (!jumpTo(duration * i / count)) {
+				break;
+			}
+			auto peak = uint16(0);
+			auto collected = int64(0);
+			while (collected < window) {
+				buffer.resize(0);
+
+				int64 samples = 0;
+				const auto res = readMore(buffer, samples);
+				if (res == ReadResult::Error
+					|| res == ReadResult::EndOfFile) {
+					break;
+				}
+				iterateSamples(buffer, [&](uint16 sample) {
+					accumulate_max(peak, sample);
+				});
+				collected += samples;
+			}
+			peaks.push_back(peak);
 		}
-
-		return true;
-	}
-
-	const VoiceWaveform &waveform() const {
-		return result;
+		return peaks;
 	}
 
-	~FFMpegWaveformCounter() {
-	}
-
-private:
 	VoiceWaveform result;
 
 };
@@ -16,6 +16,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QTimer>
 
+#include <atomic>
+
 namespace Media {
 struct ExternalSoundData;
 struct ExternalSoundPart;
@@ -224,6 +226,16 @@ private:
 
 		int getNotQueuedBufferIndex();
 
+		// Thread: Any. Must be locked: AudioMutex.
+		void publishSyncPoint(
+			uint32 externalPlayId,
+			crl::time position,
+			crl::time when);
+
+		// Thread: Any.
+		[[nodiscard]] Streaming::TimePoint readSyncPoint(
+			uint32 externalPlayId) const;
+
 		// Thread: Main. Must be locked: AudioMutex.
 		void setExternalData(std::unique_ptr<ExternalSoundData> data);
 		void changeSpeedEffect(float64 speed);
@@ -253,10 +265,20 @@ private:
 		std::unique_ptr<ExternalSoundData> externalData;
 
 		std::unique_ptr<SpeedEffect> speedEffect;
-		crl::time lastUpdateWhen = 0;
-		crl::time lastUpdatePosition = 0;
+
+		// Bumped on each clear(), so the loader thread can find out that
+		// the track was changed without locking AudioMutex.
+		std::atomic<uint32> generation = 0;
 
 	private:
+		// Sequence lock: odd 'sequence' means the point is being written.
+		struct SyncPoint {
+			std::atomic<uint32> sequence = 0;
+			std::atomic<uint32> externalPlayId = 0;
+			std::atomic<crl::time> position = 0;
+			std::atomic<crl::time> when = 0;
+		};
+
 		void createStream(AudioMsgId::Type type);
 		void destroyStream();
 		void resetStream();
@@ -264,6 +286,8 @@ private:
 		void applySourceSpeedEffect();
 		void removeSourceSpeedEffect();
 
+		SyncPoint _syncPoint;
+
 	};
 
 	bool fadedStop(AudioMsgId::Type type, bool *fadedStart = 0);
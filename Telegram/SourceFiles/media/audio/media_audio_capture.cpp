@@ -26,6 +26,10 @@ constexpr auto kCaptureFadeInDuration = crl::time(300);
 constexpr auto kCaptureBufferSlice = 256 * 1024;
 constexpr auto kCaptureUpdateDelta = crl::time(100);
 
+// OpenAL keeps capturing while we encode on the same thread, so its buffer
+// should be large enough to survive a slow encoding of a few frames.
+constexpr auto kCaptureDeviceBufferDuration = crl::time(1000);
+
 Instance *CaptureInstance = nullptr;
 
 bool ErrorHappened(ALCdevice *device) {
@@ -37,6 +41,15 @@ bool ErrorHappened(ALCdevice *device) {
 	return false;
 }
 
+// Branch free, so that the compiler can vectorize it.
+[[nodiscard]] uint16 PeakValue(const short *from, const short *till) {
+	auto result = 0;
+	for (; from != till; ++from) {
+		result = std::max(result, std::abs(int(*from)));
+	}
+	return uint16(result);
+}
+
 } // namespace
 
 class Instance::Inner final : public QObject {
@@ -160,6 +173,7 @@ struct Instance::Inner::Private {
 	uint8_t **srcSamplesData = nullptr;
 	uint8_t **dstSamplesData = nullptr;
 	SwrContext *swrContext = nullptr;
+	FFmpeg::FramePointer frame;
 
 	int32 lastUpdate = 0;
 	uint16 levelMax = 0;
@@ -238,7 +252,11 @@ void Instance::Inner::start(Fn<void(Update)> updated, Fn<void()> error) {
 	_error = std::move(error);
 
 	// Start OpenAL Capture
-	d->device = alcCaptureOpenDevice(nullptr, kCaptureFrequency, AL_FORMAT_MONO16, kCaptureFrequency / 5);
+	d->device = alcCaptureOpenDevice(
+		nullptr,
+		kCaptureFrequency,
+		AL_FORMAT_MONO16,
+		kCaptureDeviceBufferDuration * kCaptureFrequency / 1000);
 	if (!d->device) {
 		LOG(("Audio Error: capture device not present!"));
 		fail();
@@ -505,6 +523,7 @@ void Instance::Inner::stop(Fn<void(Result&&)> callback) {
 			swr_free(&d->swrContext);
 			d->swrContext = nullptr;
 		}
+		d->frame = nullptr;
 		if (d->opened) {
 			avformat_close_input(&d->fmtContext);
 			d->opened = false;
@@ -574,17 +593,22 @@ void Instance::Inner::process() {
 		auto skipSamples = kCaptureSkipDuration * kCaptureFrequency / 1000;
 		auto fadeSamples = kCaptureFadeInDuration * kCaptureFrequency / 1000;
 		auto levelindex = d->fullSamples + static_cast<int>(s / sizeof(short));
-		for (auto ptr = (const short*)(_captured.constData() + s), end = (const short*)(_captured.constData() + news); ptr < end; ++ptr, ++levelindex) {
-			if (levelindex > skipSamples) {
-				uint16 value = qAbs(*ptr);
-				if (levelindex < skipSamples + fadeSamples) {
-					value = qRound(value * float64(levelindex - skipSamples) / fadeSamples);
-				}
-				if (d->levelMax < value) {
-					d->levelMax = value;
-				}
+		auto ptr = (const short*)(_captured.constData() + s);
+		const auto end = (const short*)(_captured.constData() + news);
+		if (levelindex <= skipSamples) {
+			const auto skip = std::min(
+				int(end - ptr),
+				skipSamples + 1 - levelindex);
+			ptr += skip;
+			levelindex += skip;
+		}
+		for (; ptr != end && levelindex < skipSamples + fadeSamples; ++ptr, ++levelindex) {
+			const auto value = uint16(qRound(std::abs(int(*ptr)) * float64(levelindex - skipSamples) / fadeSamples));
+			if (d->levelMax < value) {
+				d->levelMax = value;
 			}
 		}
+		d->levelMax = std::max(d->levelMax, PeakValue(ptr, end));
 		qint32 samplesFull = d->fullSamples + _captured.size() / sizeof(short), samplesSinceUpdate = samplesFull - d->lastUpdate;
 		if (samplesSinceUpdate > kCaptureUpdateDelta * kCaptureFrequency / 1000) {
 			_updated(Update{ .samples = samplesFull, .level = d->levelMax });
@@ -643,13 +667,17 @@ bool Instance::Inner::processFrame(int32 offset, int32 framesize) {
 	}
 
 	d->waveform.reserve(d->waveform.size() + (samplesCnt / d->waveformEach) + 1);
-	for (short *ptr = srcSamplesDataChannel, *end = ptr + samplesCnt; ptr != end; ++ptr) {
-		uint16 value = qAbs(*ptr);
-		if (d->waveformPeak < value) {
-			d->waveformPeak = value;
-		}
-		if (++d->waveformMod == d->waveformEach) {
-			d->waveformMod -= d->waveformEach;
+	for (short *ptr = srcSamplesDataChannel, *end = ptr + samplesCnt; ptr != end;) {
+		const auto chunk = int(std::min(
+			int64(end - ptr),
+			d->waveformEach - d->waveformMod));
+		d->waveformPeak = std::max(
+			d->waveformPeak,
+			PeakValue(ptr, ptr + chunk));
+		ptr += chunk;
+		d->waveformMod += chunk;
+		if (d->waveformMod == d->waveformEach) {
+			d->waveformMod = 0;
 			d->waveform.push_back(uchar(d->waveformPeak / 256));
 			d->waveformPeak = 0;
 		}
@@ -677,7 +705,10 @@ bool Instance::Inner::processFrame(int32 offset, int32 framesize) {
 
 	// Write audio frame
 
-	AVFrame *frame = av_frame_alloc();
+	if (!d->frame) {
+		d->frame = FFmpeg::MakeFramePointer();
+	}
+	const auto frame = d->frame.get();
 
 	frame->format = d->codecContext->sample_fmt;
 	frame->channels = d->codecContext->channels;
@@ -694,7 +725,6 @@ bool Instance::Inner::processFrame(int32 offset, int32 framesize) {
 
 	d->fullSamples += samplesCnt;
 
-	av_frame_free(&frame);
 	return true;
 }
 
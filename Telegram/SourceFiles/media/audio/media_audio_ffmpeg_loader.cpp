@@ -311,6 +311,21 @@ bool AbstractAudioFFMpegLoader::frameHasDesiredFormat() const {
 		&& (_frame->sample_rate == _swrDstRate);
 }
 
+bool AbstractAudioFFMpegLoader::frameConvertibleWithoutResample() const {
+	const auto format = _frame->format;
+	const auto frameChannelLayout = ComputeChannelLayout(
+		_frame->channel_layout,
+		_frame->channels);
+	return true
+		&& (_frame->sample_rate == _swrDstRate)
+		&& (frameChannelLayout == _swrDstChannelLayout)
+		&& (_swrDstSampleFormat == AV_SAMPLE_FMT_S16)
+		&& (format == AV_SAMPLE_FMT_FLT
+			|| format == AV_SAMPLE_FMT_FLTP
+			|| format == AV_SAMPLE_FMT_S16P)
+		&& (!_swrContext || !swr_get_delay(_swrContext, _swrSrcRate));
+}
+
 bool AbstractAudioFFMpegLoader::initResampleForFrame() {
 	const auto frameChannelLayout = ComputeChannelLayout(
 		_frame->channel_layout,
@@ -441,6 +456,39 @@ void AbstractAudioFFMpegLoader::appendSamples(
 	samplesAdded += count;
 }
 
+// The same rate and channels, only the sample format is different.
+// Plain loops over the samples, so that the compiler can vectorize them.
+void AbstractAudioFFMpegLoader::appendConvertedSamples(
+		QByteArray &result,
+		int64 &samplesAdded) const {
+	const auto count = _frame->nb_samples;
+	const auto channels = _outputChannels;
+	const auto from = result.size();
+	result.resize(from + count * _outputSampleSize);
+	const auto to = reinterpret_cast<int16*>(result.data() + from);
+	const auto data = _frame->extended_data;
+	const auto planar = (_frame->format != AV_SAMPLE_FMT_FLT);
+	for (auto channel = 0; channel != channels; ++channel) {
+		const auto step = planar ? 1 : channels;
+		const auto index = planar ? channel : 0;
+		const auto shift = planar ? 0 : channel;
+		if (_frame->format == AV_SAMPLE_FMT_S16P) {
+			const auto in = reinterpret_cast<const int16*>(data[index]);
+			for (auto i = 0; i != count; ++i) {
+				to[i * channels + channel] = in[i * step + shift];
+			}
+		} else {
+			const auto in = reinterpret_cast<const float*>(data[index]);
+			for (auto i = 0; i != count; ++i) {
+				const auto value = in[i * step + shift] * 32768.f;
+				to[i * channels + channel] = int16(
+					std::clamp(value, -32768.f, 32767.f));
+			}
+		}
+	}
+	samplesAdded += count;
+}
+
 AudioPlayerLoader::ReadResult AbstractAudioFFMpegLoader::readFromReadyFrame(
 	QByteArray & result,
 	int64 & samplesAdded) {
@@ -451,6 +499,9 @@ AudioPlayerLoader::ReadResult AbstractAudioFFMpegLoader::readFromReadyFrame(
 			_frame->extended_data,
 			_frame->nb_samples);
 		return ReadResult::Ok;
+	} else if (frameConvertibleWithoutResample()) {
+		appendConvertedSamples(result, samplesAdded);
+		return ReadResult::Ok;
 	} else if (!initResampleForFrame()) {
 		return ReadResult::Error;
 	}
@@ -584,6 +635,18 @@ bool FFMpegLoader::seekTo(crl::time positionMs) {
 	return true;
 }
 
+bool FFMpegLoader::jumpTo(crl::time positionMs) {
+	const auto stream = fmtContext->streams[streamId];
+	const auto timeBase = stream->time_base;
+	const auto timeStamp = (positionMs * timeBase.den)
+		/ (1000LL * timeBase.num);
+	if (av_seek_frame(fmtContext, streamId, timeStamp, 0) < 0) {
+		return false;
+	}
+	avcodec_flush_buffers(_codecContext);
+	return true;
+}
+
 AudioPlayerLoader::ReadResult FFMpegLoader::readMore(
 	QByteArray & result,
 	int64 & samplesAdded) {
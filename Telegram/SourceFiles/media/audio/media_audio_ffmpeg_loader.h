@@ -120,6 +120,7 @@ protected:
 private:
 	ReadResult readFromReadyFrame(QByteArray &result, int64 &samplesAdded);
 	bool frameHasDesiredFormat() const;
+	bool frameConvertibleWithoutResample() const;
 	bool initResampleForFrame();
 	bool initResampleUsingFormat();
 	bool ensureResampleSpaceAvailable(int samples);
@@ -129,6 +130,9 @@ private:
 		int64 &samplesAdded,
 		uint8_t **data,
 		int count) const;
+	void appendConvertedSamples(
+		QByteArray &result,
+		int64 &samplesAdded) const;
 
 	FFmpeg::FramePointer _frame;
 	int _outputFormat = AL_FORMAT_STEREO16;
@@ -163,6 +167,10 @@ public:
 
 	~FFMpegLoader();
 
+protected:
+	// Seeks and drops the decoded data, for reading from several places.
+	bool jumpTo(crl::time positionMs);
+
 private:
 	bool openCodecContext();
 	bool seekTo(crl::time positionMs);
@@ -153,7 +153,8 @@ void Loaders::onLoad(const AudioMsgId &audio) {
 void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 	auto err = SetupNoErrorStarted;
 	auto type = audio.type();
-	auto l = setupLoader(audio, err, positionMs);
+	auto loading = LoadingTrack();
+	auto l = setupLoader(audio, err, loading, positionMs);
 	if (!l) {
 		if (err == SetupErrorAtStart) {
 			emitError(type);
@@ -201,8 +202,10 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 			break;
 		}
 
-		QMutexLocker lock(internal::audioPlayerMutex());
-		if (!checkLoader(type)) {
+		// The track could be changed only through its clear(), so there is
+		// no need to lock AudioMutex for each decoded packet.
+		if (loading.track->generation.load() != loading.generation) {
+			LOG(("Audio Error: playing changed while loading"));
 			clear(type);
 			return;
 		}
@@ -325,6 +328,7 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 AudioPlayerLoader *Loaders::setupLoader(
 		const AudioMsgId &audio,
 		SetupError &err,
+		LoadingTrack &loading,
 		crl::time positionMs) {
 	err = SetupErrorAtStart;
 	QMutexLocker lock(internal::audioPlayerMutex());
@@ -337,6 +341,8 @@ AudioPlayerLoader *Loaders::setupLoader(
 		err = SetupErrorNotPlaying;
 		return nullptr;
 	}
+	loading.track = track;
+	loading.generation = track->generation.load();
 
 	bool isGoodId = false;
 	AudioPlayerLoader *l = nullptr;
@@ -61,10 +61,15 @@ private:
 		SetupErrorLoadedFull = 2,
 		SetupNoErrorStarted = 3,
 	};
+	struct LoadingTrack {
+		Mixer::Track *track = nullptr;
+		uint32 generation = 0;
+	};
 	void loadData(AudioMsgId audio, crl::time positionMs = 0);
 	AudioPlayerLoader *setupLoader(
 		const AudioMsgId &audio,
 		SetupError &err,
+		LoadingTrack &loading,
 		crl::time positionMs);
 	Mixer::Track *checkLoader(AudioMsgId::Type type);
 
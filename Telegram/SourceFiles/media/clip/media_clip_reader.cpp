@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/clip/media_clip_ffmpeg.h"
 #include "media/clip/media_clip_check_streaming.h"
 #include "core/file_location.h"
+#include "platform/platform_specific.h"
 #include "base/random.h"
 #include "base/invoke_queued.h"
 #include "logs.h"
@@ -31,12 +32,23 @@ namespace Media {
 namespace Clip {
 namespace {
 
-constexpr auto kClipThreadsCount = 8;
+constexpr auto kMaxClipThreadsCount = 8;
 constexpr auto kAverageGifSize = 320 * 240;
 constexpr auto kWaitBeforeGifPause = crl::time(200);
+constexpr auto kBusyMeasurePeriod = crl::time(1000);
 
 QVector<QThread*> threads;
 QVector<Manager*> managers;
+base::flat_set<not_null<const Reader*>> readers;
+
+[[nodiscard]] int ClipThreadsCount() {
+	// Leave one core for the main thread, idealThreadCount() may be -1.
+	static const auto result = std::clamp(
+		QThread::idealThreadCount() - 1,
+		1,
+		kMaxClipThreadsCount);
+	return result;
+}
 
 QImage PrepareFrameImage(const FrameRequest &request, const QImage &original, bool hasAlpha, QImage &cache) {
 	auto needResize = (original.width() != request.framew) || (original.height() != request.frameh);
@@ -109,19 +121,30 @@ Reader::Reader(const QByteArray &data, Callback &&callback)
 }
 
 void Reader::init(const Core::FileLocation &location, const QByteArray &data) {
-	if (threads.size() < kClipThreadsCount) {
+	readers.emplace(this);
+	if (threads.size() < ClipThreadsCount()) {
 		_threadIndex = threads.size();
 		threads.push_back(new QThread());
 		managers.push_back(new Manager(threads.back()));
+		QObject::connect(threads.back(), &QThread::started, [] {
+			// Emitted in the started thread itself.
+			Platform::UseMediaAllocatorArena();
+		});
 		threads.back()->start();
 	} else {
+		// Prefer the thread that spent the least time decoding recently,
+		// the pixels count only tells us how heavy the readers could be.
+		const auto now = crl::now();
 		_threadIndex = int32(base::RandomValue<uint32>() % threads.size());
-		int32 loadLevel = 0x7FFFFFFF;
+		auto busyLevel = std::numeric_limits<int>::max();
+		auto loadLevel = std::numeric_limits<int>::max();
 		for (int32 i = 0, l = threads.size(); i < l; ++i) {
-			int32 level = managers.at(i)->loadLevel();
-			if (level < loadLevel) {
+			const auto busy = managers.at(i)->busyLevel(now);
+			const auto load = managers.at(i)->loadLevel();
+			if (busy < busyLevel || (busy == busyLevel && load < loadLevel)) {
 				_threadIndex = i;
-				loadLevel = level;
+				busyLevel = busy;
+				loadLevel = load;
 			}
 		}
 	}
@@ -344,6 +367,7 @@ void Reader::finished() {
 
 Reader::~Reader() {
 	stop();
+	readers.remove(this);
 }
 
 class ReaderPrivate {
@@ -576,6 +600,29 @@ Manager::Manager(QThread *thread) {
 	connect(&_timer, &QTimer::timeout, this, [=] { process(); });
 }
 
+int Manager::busyLevel(crl::time now) const {
+	const auto measured = _busyMeasuredAt.load(std::memory_order_acquire);
+	return (now - measured > 2 * kBusyMeasurePeriod)
+		? 0
+		: _busyLevel.load(std::memory_order_acquire);
+}
+
+void Manager::accumulateBusy(crl::time started, crl::time finished) {
+	if (!_busyMeasureStart) {
+		_busyMeasureStart = started;
+	}
+	_busyAccumulated += (finished - started);
+	const auto period = finished - _busyMeasureStart;
+	if (period >= kBusyMeasurePeriod) {
+		_busyLevel.store(
+			int(_busyAccumulated * kBusyMeasurePeriod / period),
+			std::memory_order_release);
+		_busyMeasuredAt.store(finished, std::memory_order_release);
+		_busyAccumulated = 0;
+		_busyMeasureStart = finished;
+	}
+}
+
 void Manager::append(Reader *reader, const Core::FileLocation &location, const QByteArray &data) {
 	reader->_private = new ReaderPrivate(reader, location, data);
 	_loadLevel.fetchAndAddRelaxed(kAverageGifSize);
@@ -735,6 +782,7 @@ void Manager::process() {
 
 	bool checkAllReaders = false;
 	auto ms = crl::now(), minms = ms + 86400 * crl::time(1000);
+	const auto started = ms;
 	{
 		QMutexLocker lock(&_readerPointersMutex);
 		for (auto it = _readerPointers.begin(), e = _readerPointers.end(); it != e; ++it) {
@@ -797,6 +845,7 @@ void Manager::process() {
 	}
 
 	ms = crl::now();
+	accumulateBusy(started, ms);
 	if (_needReProcess || minms <= ms) {
 		_needReProcess = false;
 		_timer.start(1);
@@ -887,6 +936,16 @@ void Finish() {
 	}
 }
 
+int64 FramesMemoryUsage() {
+	// Each of the three frames holds the original image and the pixmap.
+	constexpr auto kImagesPerReader = 3 * 2;
+	auto result = int64(0);
+	for (const auto reader : readers) {
+		result += int64(reader->width()) * reader->height() * 4;
+	}
+	return result * kImagesPerReader;
+}
+
 Reader *const ReaderPointer::BadPointer = reinterpret_cast<Reader*>(1);
 
 ReaderPointer::~ReaderPointer() {
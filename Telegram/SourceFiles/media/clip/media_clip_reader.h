@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtCore/QTimer>
 #include <QtCore/QMutex>
 
+#include <atomic>
+
 namespace Core {
 class FileLocation;
 } // namespace Core
@@ -228,6 +230,10 @@ public:
 	int loadLevel() const {
 		return _loadLevel;
 	}
+
+	// Milliseconds spent processing per second, zero if idle for a while.
+	int busyLevel(crl::time now) const;
+
 	void append(Reader *reader, const Core::FileLocation &location, const QByteArray &data);
 	void start(Reader *reader);
 	void update(Reader *reader);
@@ -239,8 +245,13 @@ private:
 	void finish();
 	void callback(Reader *reader, Notification notification);
 	void clear();
+	void accumulateBusy(crl::time started, crl::time finished);
 
 	QAtomicInt _loadLevel;
+	std::atomic<int> _busyLevel = 0;
+	std::atomic<crl::time> _busyMeasuredAt = 0;
+	crl::time _busyMeasureStart = 0;
+	crl::time _busyAccumulated = 0;
 	using ReaderPointers = QMap<Reader*, QAtomicInt>;
 	ReaderPointers _readerPointers;
 	mutable QMutex _readerPointersMutex;
@@ -272,5 +283,8 @@ private:
 
 void Finish();
 
+// Approximate bytes held by the frames of all alive readers, main thread.
+[[nodiscard]] int64 FramesMemoryUsage();
+
 } // namespace Clip
 } // namespace Media
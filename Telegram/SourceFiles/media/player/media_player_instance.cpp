@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/player/media_player_instance.h"
 
 #include "data/data_document.h"
+#include "data/data_document_media.h"
 #include "data/data_session.h"
 #include "data/data_streaming.h"
 #include "data/data_file_click_handler.h"
@@ -39,8 +40,11 @@ Instance *SingleInstance = nullptr;
 // Preload X message ids before and after current.
 constexpr auto kIdsLimit = 32;
 
-// Preload next messages if we went further from current than that.
-constexpr auto kIdsPreloadAfter = 28;
+// And more in the direction the playlist is being played in.
+constexpr auto kIdsPrefetchLimit = 128;
+
+// Preload next messages if we got that close to the loaded edge.
+constexpr auto kIdsPreloadMargin = 4;
 
 constexpr auto kMinLengthForSavePosition = 20 * TimeId(60); // 20 minutes.
 
@@ -289,11 +293,14 @@ bool Instance::validPlaylist(not_null<Data*> data) {
 			|| *data->playlistRequestedKey != *data->playlistSliceKey) {
 			return false;
 		}
-		auto distance = data->playlistSlice
-			| countDistanceInData(*key, *data->playlistRequestedKey)
-			| func::abs;
+		const auto distance = data->playlistSlice
+			| countDistanceInData(*key, *data->playlistRequestedKey);
 		if (distance) {
-			return (*distance < kIdsPreloadAfter);
+			// Distance is positive if we moved towards older messages.
+			const auto limit = (*distance > 0)
+				? data->playlistRequestedBefore
+				: data->playlistRequestedAfter;
+			return (std::abs(*distance) < limit - kIdsPreloadMargin);
 		}
 	}
 	return !data->playlistSlice;
@@ -303,6 +310,12 @@ void Instance::validatePlaylist(not_null<Data*> data) {
 	data->playlistLifetime.destroy();
 	if (const auto key = playlistKey(data)) {
 		data->playlistRequestedKey = key;
+		data->playlistRequestedBefore = (data->playlistDirection < 0)
+			? kIdsPrefetchLimit
+			: kIdsLimit;
+		data->playlistRequestedAfter = (data->playlistDirection > 0)
+			? kIdsPrefetchLimit
+			: kIdsLimit;
 
 		const auto sharedMediaViewer = key->scheduled
 			? SharedScheduledMediaViewer
@@ -310,8 +323,8 @@ void Instance::validatePlaylist(not_null<Data*> data) {
 		sharedMediaViewer(
 			&data->history->session(),
 			SharedMediaMergedKey(*key, data->overview),
-			kIdsLimit,
-			kIdsLimit
+			data->playlistRequestedBefore,
+			data->playlistRequestedAfter
 		) | rpl::start_with_next([=](SparseIdsMergedSlice &&update) {
 			data->playlistSlice = std::move(update);
 			data->playlistSliceKey = key;
@@ -366,6 +379,7 @@ bool Instance::moveInPlaylist(
 	}
 	const auto newIndex = *data->playlistIndex + delta;
 	if (const auto item = itemByIndex(data, newIndex)) {
+		data->playlistDirection = (delta > 0) ? 1 : -1;
 		if (const auto media = item->media()) {
 			if (const auto document = media->document()) {
 				if (autonext) {
@@ -386,6 +400,22 @@ bool Instance::moveInPlaylist(
 	return false;
 }
 
+void Instance::preloadNext(not_null<Data*> data) {
+	if (!data->playlistIndex) {
+		return;
+	}
+	const auto item = itemByIndex(data, *data->playlistIndex + 1);
+	const auto media = item ? item->media() : nullptr;
+	const auto document = media ? media->document() : nullptr;
+	if (!document
+		|| (!document->isAudioFile() && !document->isVoiceMessage())) {
+		return;
+	}
+	// Respects the auto download settings, the loading itself goes on
+	// in the DocumentData, so the media view is not kept.
+	document->createMediaView()->automaticLoad(item->fullId(), item);
+}
+
 bool Instance::previousAvailable(AudioMsgId::Type type) const {
 	const auto data = getData(type);
 	Assert(data != nullptr);
@@ -506,6 +536,14 @@ void Instance::playStreamed(
 		handleStreamingError(data, std::move(error));
 	}, data->streamed->lifetime);
 
+	// Start loading the next track only when the current one is cached,
+	// so that it doesn't take the bandwidth from the current playback.
+	using namespace rpl::mappers;
+	data->streamed->instance.player().fullInCache(
+	) | rpl::filter(_1) | rpl::take(1) | rpl::start_with_next([=] {
+		preloadNext(data);
+	}, data->streamed->lifetime);
+
 	data->streamed->instance.play(streamingOptions(audioId));
 
 	emitUpdate(audioId.type());
@@ -186,6 +186,9 @@ private:
 		std::optional<SliceKey> playlistSliceKey;
 		std::optional<SliceKey> playlistRequestedKey;
 		std::optional<int> playlistIndex;
+		int playlistRequestedBefore = 0;
+		int playlistRequestedAfter = 0;
+		int playlistDirection = 0;
 		rpl::lifetime playlistLifetime;
 		rpl::lifetime sessionLifetime;
 		rpl::event_stream<> playlistChanges;
@@ -230,6 +233,7 @@ private:
 	void validatePlaylist(not_null<Data*> data);
 	void playlistUpdated(not_null<Data*> data);
 	bool moveInPlaylist(not_null<Data*> data, int delta, bool autonext);
+	void preloadNext(not_null<Data*> data);
 	HistoryItem *itemByIndex(not_null<Data*> data, int index);
 	void stopAndClear(not_null<Data*> data);
 
@@ -46,6 +46,7 @@ struct PlaybackOptions {
 	bool syncVideoByAudio = true;
 	bool waitForMarkAsShown = false;
 	bool loop = false;
+	bool hwAllowed = false;
 };
 
 struct TrackState {
@@ -154,6 +155,7 @@ enum class FrameFormat {
 	None,
 	ARGB32,
 	YUV420,
+	NV12,
 };
 
 struct FrameChannel {
@@ -161,6 +163,7 @@ struct FrameChannel {
 	int stride = 0;
 };
 
+// For NV12 frames 'u' is the interleaved UV plane and 'v' is empty.
 struct FrameYUV420 {
 	QSize size;
 	QSize chromaSize;
@@ -221,10 +221,7 @@ void Document::validateGoodThumbnail() {
 	const auto information = _info.video;
 	const auto key = document->goodThumbnailCacheKey();
 	const auto guard = base::make_weak(&document->session());
-	document->owner().cache().get(key, [=](QByteArray value) {
-		if (!value.isEmpty()) {
-			return;
-		}
+	const auto generate = [=] {
 		const auto image = [&] {
 			auto result = information.cover;
 			if (information.rotation != 0) {
@@ -260,6 +257,14 @@ void Document::validateGoodThumbnail() {
 					base::duplicate(bytes),
 					Data::kImageCacheTag));
 		});
+	};
+	document->owner().cache().get(key, [=](QByteArray value) {
+		if (!value.isEmpty()) {
+			return;
+		}
+		crl::on_main(guard, [=] {
+			Data::DocumentMedia::EnqueueGoodThumbnailTask(document, generate);
+		});
 	});
 }
 
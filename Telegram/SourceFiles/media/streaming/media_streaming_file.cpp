@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_loader.h"
 #include "media/streaming/media_streaming_file_delegate.h"
 #include "ffmpeg/ffmpeg_utility.h"
+#include "platform/platform_specific.h"
 
 namespace Media {
 namespace Streaming {
@@ -133,7 +134,8 @@ void File::Context::logFatal(
 
 Stream File::Context::initStream(
 		not_null<AVFormatContext*> format,
-		AVMediaType type) {
+		AVMediaType type,
+		bool hwAllowed) {
 	auto result = Stream();
 	const auto index = result.index = av_find_best_stream(
 		format,
@@ -161,7 +163,10 @@ Stream File::Context::initStream(
 		}
 	}
 
-	result.codec = FFmpeg::MakeCodecPointer(info);
+	result.codec = FFmpeg::MakeCodecPointer({
+		.stream = info,
+		.hwAllowed = hwAllowed && (type == AVMEDIA_TYPE_VIDEO),
+	});
 	if (!result.codec) {
 		return result;
 	}
@@ -228,6 +233,45 @@ void File::Context::seekToPosition(
 	return logFatal(qstr("av_seek_frame"), error);
 }
 
+void File::Context::useKeyframes(
+		not_null<AVFormatContext*> format,
+		const Stream &stream) {
+	const auto known = _reader->keyframes();
+	const auto info = format->streams[stream.index];
+	const auto count = (known.streamIndex == stream.index)
+		? int(known.offsets.size())
+		: 0;
+	if (info->nb_index_entries > 0 && info->nb_index_entries >= count) {
+		// Files with a complete index in the header (like mp4) don't need it.
+		_keyframes = Reader::Keyframes();
+		return;
+	}
+	_keyframes = Reader::Keyframes{ .streamIndex = stream.index };
+	for (const auto &[timestamp, offset] : known.offsets) {
+		av_add_index_entry(info, offset, timestamp, 0, 0, AVINDEX_KEYFRAME);
+	}
+}
+
+void File::Context::rememberKeyframe(const AVPacket &packet) {
+	if (!(packet.flags & AV_PKT_FLAG_KEY)
+		|| packet.pos < 0
+		|| int(_keyframes.offsets.size()) >= Reader::Keyframes::kMax) {
+		return;
+	}
+	const auto timestamp = (packet.pts != AV_NOPTS_VALUE)
+		? packet.pts
+		: packet.dts;
+	if (timestamp != AV_NOPTS_VALUE) {
+		_keyframes.offsets.emplace(timestamp, packet.pos);
+	}
+}
+
+void File::Context::saveKeyframes() {
+	if (!_keyframes.offsets.empty()) {
+		_reader->saveKeyframes(base::take(_keyframes));
+	}
+}
+
 std::variant<FFmpeg::Packet, FFmpeg::AvErrorWrap> File::Context::readPacket() {
 	auto error = FFmpeg::AvErrorWrap();
 
@@ -243,7 +287,7 @@ std::variant<FFmpeg::Packet, FFmpeg::AvErrorWrap> File::Context::readPacket() {
 	return error;
 }
 
-void File::Context::start(crl::time position) {
+void File::Context::start(crl::time position, bool hwAllowed) {
 	auto error = FFmpeg::AvErrorWrap();
 
 	if (unroll()) {
@@ -262,12 +306,12 @@ void File::Context::start(crl::time position) {
 		return logFatal(qstr("avformat_find_stream_info"), error);
 	}
 
-	auto video = initStream(format.get(), AVMEDIA_TYPE_VIDEO);
+	auto video = initStream(format.get(), AVMEDIA_TYPE_VIDEO, hwAllowed);
 	if (unroll()) {
 		return;
 	}
 
-	auto audio = initStream(format.get(), AVMEDIA_TYPE_AUDIO);
+	auto audio = initStream(format.get(), AVMEDIA_TYPE_AUDIO, false);
 	if (unroll()) {
 		return;
 	}
@@ -277,7 +321,9 @@ void File::Context::start(crl::time position) {
 		sendFullInCache(true);
 	}
 	if (video.codec || audio.codec) {
-		seekToPosition(format.get(), video.codec ? video : audio, position);
+		const auto &stream = video.codec ? video : audio;
+		useKeyframes(format.get(), stream);
+		seekToPosition(format.get(), stream, position);
 	}
 	if (unroll()) {
 		return;
@@ -317,6 +363,8 @@ void File::Context::readNextPacket() {
 		const auto i = _queuedPackets.find(index);
 		if (i == end(_queuedPackets)) {
 			return;
+		} else if (index == _keyframes.streamIndex) {
+			rememberKeyframe(packet->fields());
 		}
 		i->second.push_back(std::move(*packet));
 		if (i->second.size() == kMaxQueuedPackets) {
@@ -407,7 +455,10 @@ File::File(std::shared_ptr<Reader> reader)
 : _reader(std::move(reader)) {
 }
 
-void File::start(not_null<FileDelegate*> delegate, crl::time position) {
+void File::start(
+		not_null<FileDelegate*> delegate,
+		crl::time position,
+		bool hwAllowed) {
 	stop(true);
 
 	_reader->startStreaming();
@@ -415,10 +466,12 @@ void File::start(not_null<FileDelegate*> delegate, crl::time position) {
 
 	_thread = std::thread([=, context = &*_context] {
 		crl::toggle_fp_exceptions(true);
-		context->start(position);
+		Platform::UseMediaAllocatorArena();
+		context->start(position, hwAllowed);
 		while (!context->finished()) {
 			context->readNextPacket();
 		}
+		context->saveKeyframes();
 		if (!context->interrupted()) {
 			context->stopStreamingAsync();
 		}
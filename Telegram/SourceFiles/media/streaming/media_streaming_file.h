@@ -28,7 +28,10 @@ public:
 	File(const File &other) = delete;
 	File &operator=(const File &other) = delete;
 
-	void start(not_null<FileDelegate*> delegate, crl::time position);
+	void start(
+		not_null<FileDelegate*> delegate,
+		crl::time position,
+		bool hwAllowed);
 	void wake();
 	void stop(bool stillActive = false);
 
@@ -43,7 +46,7 @@ private:
 		Context(not_null<FileDelegate*> delegate, not_null<Reader*> reader);
 		~Context();
 
-		void start(crl::time position);
+		void start(crl::time position, bool hwAllowed);
 		void readNextPacket();
 
 		void interrupt();
@@ -52,6 +55,7 @@ private:
 		[[nodiscard]] bool failed() const;
 		[[nodiscard]] bool finished() const;
 
+		void saveKeyframes();
 		void stopStreamingAsync();
 
 	private:
@@ -74,11 +78,16 @@ private:
 
 		Stream initStream(
 			not_null<AVFormatContext *> format,
-			AVMediaType type);
+			AVMediaType type,
+			bool hwAllowed);
 		void seekToPosition(
 			not_null<AVFormatContext *> format,
 			const Stream &stream,
 			crl::time position);
+		void useKeyframes(
+			not_null<AVFormatContext *> format,
+			const Stream &stream);
+		void rememberKeyframe(const AVPacket &packet);
 
 		// TODO base::expected.
 		[[nodiscard]] auto readPacket()
@@ -97,6 +106,7 @@ private:
 		bool _failed = false;
 		bool _readTillEnd = false;
 		std::optional<bool> _fullInCache;
+		Reader::Keyframes _keyframes;
 		crl::semaphore _semaphore;
 		std::atomic<bool> _interrupted = false;
 
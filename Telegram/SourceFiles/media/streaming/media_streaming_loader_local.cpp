@@ -10,6 +10,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/cache/storage_cache_types.h"
 
 #include <QtCore/QBuffer>
+#include <QtCore/QFile>
+
+#ifndef Q_OS_WIN
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // Q_OS_WIN
 
 namespace Media {
 namespace Streaming {
@@ -18,10 +24,27 @@ namespace {
 // This is the maximum file size in Telegram API.
 constexpr auto kMaxFileSize = 4000 * 512 * 1024;
 
+// How much of the mapped file we ask the kernel to read in advance.
+constexpr auto kReadaheadSize = 16 * Loader::kPartSize;
+
 int ValidateLocalSize(int64 size) {
 	return (size > 0 && size <= kMaxFileSize) ? int(size) : 0;
 }
 
+void AdviseReadahead(const uchar *mapped, int size, int offset) {
+#ifndef Q_OS_WIN
+	static const auto page = std::max(int(sysconf(_SC_PAGESIZE)), 1);
+	const auto from = (offset / page) * page;
+	const auto till = std::min(offset + kReadaheadSize, size);
+	if (till > from) {
+		posix_madvise(
+			const_cast<uchar*>(mapped) + from,
+			till - from,
+			POSIX_MADV_WILLNEED);
+	}
+#endif // Q_OS_WIN
+}
+
 } // namespace
 
 LoaderLocal::LoaderLocal(std::unique_ptr<QIODevice> device)
@@ -31,6 +54,9 @@ LoaderLocal::LoaderLocal(std::unique_ptr<QIODevice> device)
 
 	if (!_size || !_device->open(QIODevice::ReadOnly)) {
 		fail();
+	} else if (const auto file = dynamic_cast<QFile*>(_device.get())) {
+		// If mapping fails we fall back to seek and read.
+		_mapped = file->map(0, _size);
 	}
 }
 
@@ -43,6 +69,10 @@ int LoaderLocal::size() const {
 }
 
 void LoaderLocal::load(int offset) {
+	if (_mapped) {
+		loadMapped(offset);
+		return;
+	}
 	if (_device->pos() != offset && !_device->seek(offset)) {
 		fail();
 		return;
@@ -59,6 +89,21 @@ void LoaderLocal::load(int offset) {
 	});
 }
 
+void LoaderLocal::loadMapped(int offset) {
+	if (offset < 0 || offset >= _size) {
+		fail();
+		return;
+	}
+	const auto length = std::min(kPartSize, _size - offset);
+	auto result = QByteArray(
+		reinterpret_cast<const char*>(_mapped + offset),
+		length);
+	AdviseReadahead(_mapped, _size, offset + length);
+	crl::on_main(this, [=, result = std::move(result)]() mutable {
+		_parts.fire({ offset, std::move(result) });
+	});
+}
+
 void LoaderLocal::fail() {
 	crl::on_main(this, [=] {
 		_parts.fire({ LoadedPart::kFailedOffset });
@@ -39,10 +39,12 @@ public:
 	void clearAttachedDownloader() override;
 
 private:
+	void loadMapped(int offset);
 	void fail();
 
 	const std::unique_ptr<QIODevice> _device;
 	const int _size = 0;
+	uchar *_mapped = nullptr;
 	rpl::event_stream<LoadedPart> _parts;
 
 };
@@ -22,6 +22,8 @@ constexpr auto kBufferFor = 3 * crl::time(1000);
 constexpr auto kLoadInAdvanceForRemote = 32 * crl::time(1000);
 constexpr auto kLoadInAdvanceForLocal = 5 * crl::time(1000);
 constexpr auto kMsFrequency = 1000; // 1000 ms per second.
+constexpr auto kAudioReceivedTillKey = uint64(0);
+constexpr auto kVideoReceivedTillKey = uint64(1);
 
 // If we played for 3 seconds and got stuck it looks like we're loading
 // slower than we're playing, so load full file in that case.
@@ -81,6 +83,7 @@ void SaveValidStartInformation(Information &to, Information &&from) {
 
 Player::Player(std::shared_ptr<Reader> reader)
 : _file(std::make_unique<File>(std::move(reader)))
+, _receivedTill(u"Streaming::Player received till"_q)
 , _remoteLoader(_file->isRemoteLoader())
 , _renderFrameTimer([=] { checkNextFrameRender(); }) {
 }
@@ -368,9 +371,9 @@ bool Player::fileProcessPackets(
 					_audio->streamTimeBase()),
 				crl::time(0),
 				computeAudioDuration() - 1);
-			crl::on_main(&_sessionGuard, [=] {
+			_receivedTill.post(kAudioReceivedTillKey, crl::guard(&_sessionGuard, [=] {
 				audioReceivedTill(till);
-			});
+			}));
 			_audio->process(base::take(list));
 		} else if (_video && _video->streamIndex() == index) {
 			//for (const auto &packet : list) {
@@ -388,9 +391,9 @@ bool Player::fileProcessPackets(
 					_video->streamTimeBase()),
 				crl::time(0),
 				computeVideoDuration() - 1);
-			crl::on_main(&_sessionGuard, [=] {
+			_receivedTill.post(kVideoReceivedTillKey, crl::guard(&_sessionGuard, [=] {
 				videoReceivedTill(till);
-			});
+			}));
 			_video->process(base::take(list));
 		} else {
 			list.clear(); // Free non-needed packets.
@@ -410,16 +413,16 @@ void Player::fileProcessEndOfFile() {
 	};
 	if (_audio) {
 		const auto till = _loopingShift + computeAudioDuration();
-		crl::on_main(&_sessionGuard, [=] {
+		_receivedTill.post(kAudioReceivedTillKey, crl::guard(&_sessionGuard, [=] {
 			audioReceivedTill(till);
-		});
+		}));
 		_audio->process(generateEmptyQueue());
 	}
 	if (_video) {
 		const auto till = _loopingShift + computeVideoDuration();
-		crl::on_main(&_sessionGuard, [=] {
+		_receivedTill.post(kVideoReceivedTillKey, crl::guard(&_sessionGuard, [=] {
 			videoReceivedTill(till);
-		});
+		}));
 		_video->process(generateEmptyQueue());
 	}
 }
@@ -495,6 +498,7 @@ void Player::provideStartInformation() {
 		fail(Error::OpenFailed);
 	} else {
 		_stage = Stage::Ready;
+		_stats.ready = crl::now();
 
 		if (_audio && _audioFinished) {
 			// Audio was stopped before it was ready.
@@ -535,11 +539,15 @@ void Player::play(const PlaybackOptions &options) {
 
 	savePreviousReceivedTill(options, previous);
 	_options = options;
+	_stats = SessionStats{
+		.started = crl::now(),
+		.position = options.position,
+	};
 	if (!Media::Audio::SupportsSpeedControl()) {
 		_options.speed = 1.;
 	}
 	_stage = Stage::Initializing;
-	_file->start(delegate(), _options.position);
+	_file->start(delegate(), _options.position, _options.hwAllowed);
 }
 
 void Player::savePreviousReceivedTill(
@@ -690,6 +698,9 @@ bool Player::receivedTillEnd() const {
 void Player::checkResumeFromWaitingForData() {
 	if (_pausedByWaitingForData && bothReceivedEnough(kBufferFor)) {
 		_pausedByWaitingForData = false;
+		if (const auto since = base::take(_stats.stalledSince)) {
+			_stats.stalledTotal += crl::now() - since;
+		}
 		updatePausedState();
 		_updates.fire({ WaitingForData{ false } });
 	}
@@ -708,6 +719,8 @@ void Player::start() {
 		return !bothReceivedEnough(kBufferFor);
 	}) | rpl::start_with_next([=] {
 		_pausedByWaitingForData = true;
+		++_stats.stalls;
+		_stats.stalledSince = crl::now();
 		updatePausedState();
 		_updates.fire({ WaitingForData{ true } });
 	}, _sessionLifetime);
@@ -770,7 +783,26 @@ void Player::checkVideoStep() {
 	}
 }
 
+void Player::logSessionStats() {
+	if (!_stats.started) {
+		return;
+	}
+	const auto now = crl::now();
+	if (_stats.stalledSince) {
+		_stats.stalledTotal += now - _stats.stalledSince;
+	}
+	DEBUG_LOG(("Streaming Info: Session from %1 ms, %2 ms long, "
+		"first frame after %3 ms, %4 stalls for %5 ms."
+		).arg(_stats.position
+		).arg(now - _stats.started
+		).arg(_stats.ready ? (_stats.ready - _stats.started) : -1
+		).arg(_stats.stalls
+		).arg(_stats.stalledTotal));
+	_stats = SessionStats();
+}
+
 void Player::stop(bool stillActive) {
+	logSessionStats();
 	_file->stop(stillActive);
 	_sessionLifetime = rpl::lifetime();
 	_stage = Stage::Uninitialized;
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_file_delegate.h"
+#include "core/coalesced_dispatcher.h"
 #include "base/weak_ptr.h"
 #include "base/timer.h"
 
@@ -161,6 +162,19 @@ private:
 		TrackState &state,
 		crl::time position);
 
+	// Written to the debug log when the session stops, a session
+	// started from a non-zero position is a seek.
+	struct SessionStats {
+		crl::time started = 0;
+		crl::time position = 0;
+		crl::time ready = 0;
+		crl::time stalledSince = 0;
+		crl::time stalledTotal = 0;
+		int stalls = 0;
+	};
+
+	void logSessionStats();
+
 	const std::unique_ptr<File> _file;
 
 	// Immutable while File is active after it is ready.
@@ -171,6 +185,9 @@ private:
 	// Immutable while File is active.
 	base::has_weak_ptr _sessionGuard;
 
+	// Receives posts from the File thread, called on the main thread.
+	Core::CoalescedDispatcher _receivedTill;
+
 	// Immutable while File is active except '.speed'.
 	// '.speed' is changed from the main thread.
 	PlaybackOptions _options;
@@ -196,6 +213,7 @@ private:
 	crl::time _pausedTime = kTimeUnknown;
 	crl::time _currentFrameTime = kTimeUnknown;
 	crl::time _nextFrameTime = kTimeUnknown;
+	SessionStats _stats;
 	base::Timer _renderFrameTimer;
 	rpl::event_stream<Update, Error> _updates;
 	rpl::event_stream<bool> _fullInCache;
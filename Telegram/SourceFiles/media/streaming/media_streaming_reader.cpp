@@ -10,6 +10,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_loader.h"
 #include "storage/cache/storage_cache_database.h"
+#include "platform/platform_specific.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QDataStream>
 
 namespace Media {
 namespace Streaming {
@@ -21,14 +25,135 @@ constexpr auto kInSlice = kPartsInSlice * kPartSize;
 constexpr auto kMaxPartsInHeader = 64;
 constexpr auto kMaxOnlyInHeader = 80 * kPartSize;
 constexpr auto kPartsOutsideFirstSliceGood = 8;
-constexpr auto kSlicesInMemory = 2;
+
+// Each reader may always keep that many slices in memory, the rest
+// of the process-wide budget is shared by recently used readers.
+constexpr auto kMinSlicesInMemory = 2;
+constexpr auto kMinSlicesBudget = int64(32) * 1024 * 1024;
+constexpr auto kMaxSlicesBudget = int64(512) * 1024 * 1024;
+constexpr auto kDefaultSlicesBudget = int64(128) * 1024 * 1024;
+constexpr auto kSlicesBudgetMemoryPart = 64;
+constexpr auto kIdleReaderTimeout = 3 * crl::time(1000);
 
 // 1 MB of parts are requested from cloud ahead of reading demand.
 constexpr auto kPreloadPartsAhead = 8;
 constexpr auto kDownloaderRequestsLimit = 4;
 
+// Slices use the same high part with the consecutive low parts.
+constexpr auto kKeyframesCacheKeyFlag = 0x0000000000010000ULL;
+constexpr auto kKeyframesCacheVersion = qint32(1);
+
 using PartsMap = base::flat_map<int, QByteArray>;
 
+// Thread safe, each reader works with its slices in its own thread.
+class SlicesBudget final {
+public:
+	SlicesBudget();
+
+	[[nodiscard]] int add();
+	void remove(int id);
+
+	void used(int id, int resident);
+	void unloaded(int id, int resident);
+	[[nodiscard]] int allowed(int id) const;
+	[[nodiscard]] int resident() const;
+
+private:
+	struct Entry {
+		int resident = 0;
+		crl::time lastUsed = 0;
+	};
+
+	const int _total = 0;
+
+	mutable QMutex _mutex;
+	base::flat_map<int, Entry> _entries;
+	int _autoincrement = 0;
+
+};
+
+[[nodiscard]] int ComputeTotalSlicesBudget() {
+	const auto memory = Platform::PhysicalMemorySize();
+	const auto bytes = (memory > 0)
+		? std::clamp(
+			memory / kSlicesBudgetMemoryPart,
+			kMinSlicesBudget,
+			kMaxSlicesBudget)
+		: kDefaultSlicesBudget;
+	return std::max(int(bytes / kInSlice), kMinSlicesInMemory);
+}
+
+SlicesBudget::SlicesBudget() : _total(ComputeTotalSlicesBudget()) {
+}
+
+int SlicesBudget::add() {
+	QMutexLocker lock(&_mutex);
+	const auto id = ++_autoincrement;
+	_entries.emplace(id, Entry{ .lastUsed = crl::now() });
+	return id;
+}
+
+void SlicesBudget::remove(int id) {
+	QMutexLocker lock(&_mutex);
+	_entries.remove(id);
+}
+
+void SlicesBudget::used(int id, int resident) {
+	QMutexLocker lock(&_mutex);
+	const auto i = _entries.find(id);
+	Assert(i != end(_entries));
+	i->second.resident = resident;
+	i->second.lastUsed = crl::now();
+}
+
+void SlicesBudget::unloaded(int id, int resident) {
+	QMutexLocker lock(&_mutex);
+	const auto i = _entries.find(id);
+	Assert(i != end(_entries));
+	i->second.resident = resident;
+}
+
+int SlicesBudget::allowed(int id) const {
+	QMutexLocker lock(&_mutex);
+	const auto i = _entries.find(id);
+	Assert(i != end(_entries));
+
+	const auto now = crl::now();
+	const auto &mine = i->second;
+	if (now - mine.lastUsed > kIdleReaderTimeout) {
+		return kMinSlicesInMemory;
+	}
+
+	// Everyone keeps the minimum, the rest goes to the most recently used
+	// readers first: those used after us keep what they already hold.
+	auto extra = _total;
+	for (const auto &[otherId, other] : _entries) {
+		extra -= std::min(other.resident, kMinSlicesInMemory);
+	}
+	for (const auto &[otherId, other] : _entries) {
+		if (otherId != id
+			&& other.lastUsed >= mine.lastUsed
+			&& now - other.lastUsed <= kIdleReaderTimeout) {
+			extra -= std::max(other.resident - kMinSlicesInMemory, 0);
+		}
+	}
+	return kMinSlicesInMemory + std::max(extra, 0);
+}
+
+int SlicesBudget::resident() const {
+	QMutexLocker lock(&_mutex);
+	auto result = 0;
+	for (const auto &[id, entry] : _entries) {
+		result += entry.resident;
+	}
+	return result;
+}
+
+[[nodiscard]] SlicesBudget &Budget() {
+	static auto result = SlicesBudget();
+	return result;
+}
+
 struct ParsedCacheEntry {
 	PartsMap parts;
 	std::optional<PartsMap> included;
@@ -157,6 +282,56 @@ ParsedCacheEntry ParseCacheEntry(
 	return result;
 }
 
+[[nodiscard]] QByteArray SerializeKeyframes(
+		const Reader::Keyframes &keyframes) {
+	auto result = QByteArray();
+	result.reserve(3 * sizeof(qint32)
+		+ keyframes.offsets.size() * 2 * sizeof(qint64));
+	{
+		QDataStream stream(&result, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream
+			<< kKeyframesCacheVersion
+			<< qint32(keyframes.streamIndex)
+			<< qint32(keyframes.offsets.size());
+		for (const auto &[timestamp, offset] : keyframes.offsets) {
+			stream << qint64(timestamp) << qint64(offset);
+		}
+	}
+	return result;
+}
+
+[[nodiscard]] Reader::Keyframes ParseKeyframes(
+		const QByteArray &data,
+		int size) {
+	QDataStream stream(data);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto version = qint32();
+	auto streamIndex = qint32();
+	auto count = qint32();
+	stream >> version >> streamIndex >> count;
+	if (stream.status() != QDataStream::Ok
+		|| version != kKeyframesCacheVersion
+		|| streamIndex < 0
+		|| count <= 0
+		|| count > Reader::Keyframes::kMax) {
+		return {};
+	}
+	auto result = Reader::Keyframes{ .streamIndex = streamIndex };
+	for (auto i = 0; i != count; ++i) {
+		auto timestamp = qint64();
+		auto offset = qint64();
+		stream >> timestamp >> offset;
+		if (stream.status() != QDataStream::Ok
+			|| offset < 0
+			|| offset >= size) {
+			return {};
+		}
+		result.offsets.emplace(timestamp, offset);
+	}
+	return result;
+}
+
 template <typename Range> // Range::value_type is Pair<int, QByteArray>
 int FindNotLoadedStart(Range &&parts, int offset) {
 	auto result = offset;
@@ -219,12 +394,14 @@ struct Reader::CacheHelper {
 	explicit CacheHelper(Storage::Cache::Key baseKey);
 
 	Storage::Cache::Key key(int sliceNumber) const;
+	Storage::Cache::Key keyframesKey() const;
 
 	const Storage::Cache::Key baseKey;
 
 	QMutex mutex;
 	base::flat_map<int, PartsMap> results;
 	std::vector<int> sizes;
+	std::optional<QByteArray> keyframes;
 	std::atomic<crl::semaphore*> waiting = nullptr;
 };
 
@@ -236,6 +413,13 @@ Storage::Cache::Key Reader::CacheHelper::key(int sliceNumber) const {
 	return Storage::Cache::Key{ baseKey.high, baseKey.low + sliceNumber };
 }
 
+Storage::Cache::Key Reader::CacheHelper::keyframesKey() const {
+	return Storage::Cache::Key{
+		baseKey.high | kKeyframesCacheKeyFlag,
+		baseKey.low
+	};
+}
+
 void Reader::Slice::processCacheData(PartsMap &&data) {
 	Expects((flags & Flag::LoadingFromCache) != 0);
 	Expects(!(flags & Flag::LoadedFromCache));
@@ -333,7 +517,8 @@ auto Reader::Slice::offsetsFromLoader(int from, int till) const
 }
 
 Reader::Slices::Slices(int size, bool useCache)
-: _size(size) {
+: _size(size)
+, _budgetId(Budget().add()) {
 	Expects(size > 0);
 
 	if (useCache) {
@@ -346,6 +531,10 @@ Reader::Slices::Slices(int size, bool useCache)
 	}
 }
 
+Reader::Slices::~Slices() {
+	Budget().remove(_budgetId);
+}
+
 bool Reader::Slices::headerModeUnknown() const {
 	return (_headerMode == HeaderMode::Unknown);
 }
@@ -540,6 +729,34 @@ void Reader::Slices::processPart(
 	checkSliceFullLoaded(index + 1);
 }
 
+void Reader::Slices::processUnrequestedPart(
+		int offset,
+		QByteArray &&bytes) {
+	Expects(isFullInHeader() || (offset / kInSlice < _data.size()));
+
+	// Parts loaded for the downloader are kept only if their slice is
+	// resident anyway, so that streaming doesn't request them again.
+	if (isFullInHeader()) {
+		if (!_header.parts.contains(offset)) {
+			_header.addPart(offset, bytes);
+			checkSliceFullLoaded(0);
+		}
+		return;
+	} else if (_headerMode == HeaderMode::Unknown) {
+		return;
+	}
+	const auto index = offset / kInSlice;
+	auto &slice = _data[index];
+	const auto local = offset - index * kInSlice;
+	if (slice.parts.empty()
+		|| (slice.flags & Slice::Flag::LoadingFromCache)
+		|| slice.parts.contains(local)) {
+		return;
+	}
+	slice.addPart(local, std::move(bytes));
+	checkSliceFullLoaded(index + 1);
+}
+
 auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 	Expects(!buffer.empty());
 	Expects(offset >= 0 && offset < _size);
@@ -694,6 +911,7 @@ void Reader::Slices::markSliceUsed(int sliceIndex) {
 			std::rotate(i, next, end);
 		}
 	}
+	Budget().used(_budgetId, int(_usedSlices.size()));
 }
 
 int Reader::Slices::maxSliceSize(int sliceNumber) const {
@@ -704,11 +922,12 @@ Reader::SerializedSlice Reader::Slices::serializeAndUnloadUnused() {
 	using Flag = Slice::Flag;
 
 	if (_headerMode == HeaderMode::Unknown
-		|| _usedSlices.size() <= kSlicesInMemory) {
+		|| _usedSlices.size() <= Budget().allowed(_budgetId)) {
 		return {};
 	}
 	const auto purgeSlice = _usedSlices.front();
 	_usedSlices.pop_front();
+	Budget().unloaded(_budgetId, int(_usedSlices.size()));
 	if (!(_data[purgeSlice].flags & Flag::LoadedFromCache)) {
 		// If the only data in this slice was from _header, just leave it.
 		return {};
@@ -845,6 +1064,10 @@ Reader::SerializedSlice Reader::Slices::unloadToCache() {
 	return {};
 }
 
+int64 Reader::SlicesMemoryUsage() {
+	return Budget().resident() * int64(kInSlice);
+}
+
 Reader::Reader(
 	std::unique_ptr<Loader> loader,
 	Storage::Cache::Database *cache)
@@ -868,6 +1091,7 @@ Reader::Reader(
 
 	if (_cacheHelper) {
 		readFromCache(0);
+		readKeyframesFromCache();
 	}
 }
 
@@ -1191,6 +1415,64 @@ void Reader::putToCache(SerializedSlice &&slice) {
 	_cache->put(_cacheHelper->key(slice.number), std::move(slice.data));
 }
 
+void Reader::readKeyframesFromCache() {
+	Expects(_cache != nullptr);
+	Expects(_cacheHelper != nullptr);
+
+	const auto cache = std::weak_ptr<CacheHelper>(_cacheHelper);
+	_cache->get(_cacheHelper->keyframesKey(), [=](QByteArray &&result) {
+		if (const auto strong = cache.lock()) {
+			QMutexLocker lock(&strong->mutex);
+			strong->keyframes = std::move(result);
+		}
+	});
+}
+
+Reader::Keyframes Reader::keyframes() {
+	if (_cacheHelper) {
+		auto cached = std::optional<QByteArray>();
+		{
+			QMutexLocker lock(&_cacheHelper->mutex);
+			cached = base::take(_cacheHelper->keyframes);
+		}
+		if (cached && !cached->isEmpty()) {
+			mergeKeyframes(ParseKeyframes(*cached, _loader->size()));
+		}
+	}
+	return _keyframes;
+}
+
+void Reader::saveKeyframes(Keyframes &&keyframes) {
+	if (!mergeKeyframes(std::move(keyframes)) || !_cacheHelper) {
+		return;
+	}
+	Assert(_cache != nullptr);
+	_cache->put(
+		_cacheHelper->keyframesKey(),
+		SerializeKeyframes(_keyframes));
+}
+
+bool Reader::mergeKeyframes(Keyframes &&keyframes) {
+	if (keyframes.streamIndex < 0 || keyframes.offsets.empty()) {
+		return false;
+	} else if (keyframes.streamIndex != _keyframes.streamIndex) {
+		if (_keyframes.offsets.size() >= keyframes.offsets.size()) {
+			return false;
+		}
+		_keyframes = std::move(keyframes);
+		return true;
+	}
+	auto changed = false;
+	for (const auto &[timestamp, offset] : keyframes.offsets) {
+		if (int(_keyframes.offsets.size()) >= Keyframes::kMax) {
+			break;
+		} else if (_keyframes.offsets.emplace(timestamp, offset).second) {
+			changed = true;
+		}
+	}
+	return changed;
+}
+
 int Reader::size() const {
 	return _loader->size();
 }
@@ -1248,6 +1530,10 @@ Reader::FillState Reader::fill(
 	do {
 		lastResult = fillFromSlices(offset, buffer);
 		if (lastResult == FillState::Success) {
+			const auto till = offset + int(buffer.size());
+			for (auto part = offset / kPartSize; part * kPartSize < till; ++part) {
+				_readOffsets.emplace(part * kPartSize);
+			}
 			return done();
 		}
 		startWaiting();
@@ -1353,7 +1639,12 @@ bool Reader::processLoadedParts() {
 		if (!part.valid(size())) {
 			_streamingError = Error::LoadFailed;
 			return false;
-		} else if (!_loadingOffsets.remove(part.offset)) {
+		}
+		_loadedOffsets.emplace(part.offset);
+		if (!_loadingOffsets.remove(part.offset)) {
+			_slices.processUnrequestedPart(
+				part.offset,
+				std::move(part.bytes));
 			continue;
 		}
 		_slices.processPart(
@@ -1394,6 +1685,16 @@ void Reader::finalizeCache() {
 
 Reader::~Reader() {
 	finalizeCache();
+
+	if (!_loadedOffsets.empty()) {
+		const auto unread = ranges::count_if(_loadedOffsets, [&](int offset) {
+			return !_readOffsets.contains(offset);
+		});
+		DEBUG_LOG(("Streaming Info: "
+			"Loaded %1 parts, %2 of them were not read."
+			).arg(_loadedOffsets.size()
+			).arg(unread));
+	}
 }
 
 } // namespace Streaming
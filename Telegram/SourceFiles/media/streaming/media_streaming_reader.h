@@ -39,11 +39,24 @@ public:
 		Failed,
 	};
 
+	// Keyframe timestamps of one stream (in its time base) with the byte
+	// offsets of their packets, collected while demuxing, so that seeking
+	// in files without a full index doesn't scan the file for a keyframe.
+	struct Keyframes {
+		static constexpr auto kMax = 4096;
+
+		int streamIndex = -1;
+		base::flat_map<int64, int64> offsets;
+	};
+
 	// Main thread.
 	explicit Reader(
 		std::unique_ptr<Loader> loader,
 		Storage::Cache::Database *cache = nullptr);
 
+	// Any thread, bytes of slices held in memory by all readers.
+	[[nodiscard]] static int64 SlicesMemoryUsage();
+
 	void setLoaderPriority(int priority);
 
 	// Any thread.
@@ -59,6 +72,8 @@ public:
 	void headerDone();
 	[[nodiscard]] int headerSize() const;
 	[[nodiscard]] bool fullInCache() const;
+	[[nodiscard]] Keyframes keyframes();
+	void saveKeyframes(Keyframes &&keyframes);
 
 	// Thread safe.
 	void startSleep(not_null<crl::semaphore*> wake);
@@ -144,6 +159,9 @@ private:
 	class Slices {
 	public:
 		Slices(int size, bool useCache);
+		Slices(const Slices &other) = delete;
+		Slices &operator=(const Slices &other) = delete;
+		~Slices();
 
 		void headerDone(bool fromCache);
 		[[nodiscard]] int headerSize() const;
@@ -159,6 +177,7 @@ private:
 		void processCacheResult(int sliceNumber, PartsMap &&result);
 		void processCachedSizes(const std::vector<int> &sizes);
 		void processPart(int offset, QByteArray &&bytes);
+		void processUnrequestedPart(int offset, QByteArray &&bytes);
 
 		[[nodiscard]] FillResult fill(int offset, bytes::span buffer);
 		[[nodiscard]] SerializedSlice unloadToCache();
@@ -196,6 +215,7 @@ private:
 		Slice _header;
 		std::deque<int> _usedSlices;
 		int _size = 0;
+		int _budgetId = 0;
 		HeaderMode _headerMode = HeaderMode::Unknown;
 		bool _fullInCache = false;
 
@@ -207,6 +227,8 @@ private:
 	[[nodiscard]] bool readFromCacheForDownloader(int sliceNumber);
 	bool processCacheResults();
 	void putToCache(SerializedSlice &&data);
+	void readKeyframesFromCache();
+	bool mergeKeyframes(Keyframes &&keyframes);
 
 	void cancelLoadInRange(int from, int till);
 	void loadAtOffset(int offset);
@@ -261,6 +283,12 @@ private:
 	bool _streamingActive = false;
 
 	// Streaming thread.
+	Keyframes _keyframes;
+
+	// Parts received from the loader and parts demuxer read, the
+	// difference is logged as over-fetched when the reader is destroyed.
+	base::flat_set<int> _loadedOffsets;
+	base::flat_set<int> _readOffsets;
 	std::deque<int> _offsetsForDownloader;
 	base::flat_set<int> _downloaderOffsetsRequested;
 	base::flat_map<int, std::optional<PartsMap>> _downloaderReadCache;
@@ -74,9 +74,11 @@ FFmpeg::AvErrorWrap ReadNextFrame(Stream &stream) {
 		error = avcodec_receive_frame(
 			stream.codec.get(),
 			stream.frame.get());
-		if (!error
-			|| error.code() != AVERROR(EAGAIN)
-			|| stream.queue.empty()) {
+		if (!error) {
+			return FFmpeg::TransferHardwareFrame(
+				stream.frame,
+				stream.transferredFrame);
+		} else if (error.code() != AVERROR(EAGAIN) || stream.queue.empty()) {
 			return error;
 		}
 
@@ -185,7 +187,12 @@ FrameYUV420 ExtractYUV420(Stream &stream, AVFrame *frame) {
 		},
 		.y = { .data = frame->data[0], .stride = frame->linesize[0] },
 		.u = { .data = frame->data[1], .stride = frame->linesize[1] },
-		.v = { .data = frame->data[2], .stride = frame->linesize[2] },
+		.v = (frame->format == AV_PIX_FMT_NV12)
+			? FrameChannel()
+			: FrameChannel{
+				.data = frame->data[2],
+				.stride = frame->linesize[2],
+			},
 	};
 }
 
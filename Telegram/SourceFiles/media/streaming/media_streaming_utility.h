@@ -41,6 +41,7 @@ struct Stream {
 	int rotation = 0;
 	AVRational aspect = FFmpeg::kNormalAspect;
 	FFmpeg::SwscalePointer swscale;
+	FFmpeg::FramePointer transferredFrame;
 };
 
 [[nodiscard]] crl::time FramePosition(const Stream &stream);
@@ -21,10 +21,18 @@ constexpr auto kDisplaySkipped = crl::time(-1);
 constexpr auto kFinishedPosition = std::numeric_limits<crl::time>::max();
 static_assert(kDisplaySkipped != kTimeUnknown);
 
-[[nodiscard]] QImage ConvertToARGB32(const FrameYUV420 &data) {
+[[nodiscard]] bool IsPlanarFormat(FrameFormat format) {
+	return (format == FrameFormat::YUV420) || (format == FrameFormat::NV12);
+}
+
+[[nodiscard]] QImage ConvertToARGB32(
+		FrameFormat format,
+		const FrameYUV420 &data,
+		FFmpeg::SwscalePointer &swscale) {
+	Expects(IsPlanarFormat(format));
 	Expects(data.y.data != nullptr);
 	Expects(data.u.data != nullptr);
-	Expects(data.v.data != nullptr);
+	Expects(format == FrameFormat::NV12 || data.v.data != nullptr);
 	Expects(!data.size.isEmpty());
 
 	//if (FFmpeg::RotationSwapWidthHeight(stream.rotation)) {
@@ -32,11 +40,14 @@ static_assert(kDisplaySkipped != kTimeUnknown);
 	//}
 
 	auto result = FFmpeg::CreateFrameStorage(data.size);
-	const auto swscale = FFmpeg::MakeSwscalePointer(
+	swscale = FFmpeg::MakeSwscalePointer(
 		data.size,
-		AV_PIX_FMT_YUV420P,
+		(format == FrameFormat::NV12
+			? AV_PIX_FMT_NV12
+			: AV_PIX_FMT_YUV420P),
 		data.size,
-		AV_PIX_FMT_BGRA);
+		AV_PIX_FMT_BGRA,
+		&swscale);
 	if (!swscale) {
 		return QImage();
 	}
@@ -424,14 +435,16 @@ void VideoTrackObject::rasterizeFrame(not_null<Frame*> frame) {
 
 	fillRequests(frame);
 	frame->format = FrameFormat::None;
-	if (frame->decoded->format == AV_PIX_FMT_YUV420P && !requireARGB32()) {
+	const auto decodedFormat = frame->decoded->format;
+	const auto nv12 = (decodedFormat == AV_PIX_FMT_NV12);
+	if ((decodedFormat == AV_PIX_FMT_YUV420P || nv12) && !requireARGB32()) {
 		frame->alpha = false;
 		frame->yuv420 = ExtractYUV420(_stream, frame->decoded.get());
 		if (frame->yuv420.size.isEmpty()
 			|| frame->yuv420.chromaSize.isEmpty()
 			|| !frame->yuv420.y.data
 			|| !frame->yuv420.u.data
-			|| !frame->yuv420.v.data) {
+			|| (!nv12 && !frame->yuv420.v.data)) {
 			frame->prepared.clear();
 			fail(Error::InvalidData);
 			return;
@@ -442,7 +455,7 @@ void VideoTrackObject::rasterizeFrame(not_null<Frame*> frame) {
 				prepared.image = QImage();
 			}
 		}
-		frame->format = FrameFormat::YUV420;
+		frame->format = nv12 ? FrameFormat::NV12 : FrameFormat::YUV420;
 	} else {
 		frame->alpha = (frame->decoded->format == AV_PIX_FMT_BGRA);
 		frame->yuv420.size = {
@@ -1106,9 +1119,11 @@ QImage VideoTrack::frame(
 			unwrapped.updateFrameRequest(instance, useRequest);
 		});
 	}
-	if (frame->original.isNull()
-		&& frame->format == FrameFormat::YUV420) {
-		frame->original = ConvertToARGB32(frame->yuv420);
+	if (frame->original.isNull() && IsPlanarFormat(frame->format)) {
+		frame->original = ConvertToARGB32(
+			frame->format,
+			frame->yuv420,
+			_argb32Swscale);
 	}
 	if (!frame->alpha
 		&& GoodForRequest(frame->original, _streamRotation, useRequest)) {
@@ -1161,8 +1176,11 @@ FrameWithInfo VideoTrack::frameWithInfo(const Instance *instance) {
 
 QImage VideoTrack::currentFrameImage() {
 	const auto frame = _shared->frameForPaint();
-	if (frame->original.isNull() && frame->format == FrameFormat::YUV420) {
-		frame->original = ConvertToARGB32(frame->yuv420);
+	if (frame->original.isNull() && IsPlanarFormat(frame->format)) {
+		frame->original = ConvertToARGB32(
+			frame->format,
+			frame->yuv420,
+			_argb32Swscale);
 	}
 	return frame->original;
 }
@@ -1216,7 +1234,7 @@ bool VideoTrack::IsDecoded(not_null<const Frame*> frame) {
 bool VideoTrack::IsRasterized(not_null<const Frame*> frame) {
 	return IsDecoded(frame)
 		&& (!frame->original.isNull()
-			|| frame->format == FrameFormat::YUV420);
+			|| IsPlanarFormat(frame->format));
 }
 
 bool VideoTrack::IsStale(not_null<const Frame*> frame, crl::time trackTime) {
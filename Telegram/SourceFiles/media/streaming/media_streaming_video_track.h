@@ -167,6 +167,9 @@ private:
 	//AVRational _streamAspect = kNormalAspect;
 	std::unique_ptr<Shared> _shared;
 
+	// Main thread, converting planar frames for painting.
+	FFmpeg::SwscalePointer _argb32Swscale;
+
 	using Implementation = VideoTrackObject;
 	crl::object_on_queue<Implementation> _wrapped;
 
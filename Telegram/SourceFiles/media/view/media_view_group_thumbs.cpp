@@ -30,6 +30,7 @@ namespace View {
 namespace {
 
 constexpr auto kThumbDuration = crl::time(150);
+constexpr auto kThumbsPoolSize = 16;
 
 int Round(float64 value) {
 	return int(base::SafeRound(value));
@@ -190,8 +191,12 @@ public:
 		Data::FileOrigin origin,
 		Fn<void()> handler);
 
+	[[nodiscard]] Key key() const;
+
 	int leftToUpdate() const;
 	int rightToUpdate() const;
+	int finalLeft() const;
+	int finalWidth() const;
 
 	void animateToLeft(not_null<Thumb*> next);
 	void animateToRight(not_null<Thumb*> prev);
@@ -199,8 +204,10 @@ public:
 	void setState(State state);
 	State state() const;
 	bool removed() const;
+	void revive();
 
-	void paint(Painter &p, int x, int y, int outerWidth, float64 progress);
+	// Returns false if the thumb is visible, but not loaded yet.
+	bool paint(Painter &p, int x, int y, int outerWidth, float64 progress);
 	ClickHandlerPtr getState(QPoint point) const;
 
 private:
@@ -208,12 +215,12 @@ private:
 	void validateImage();
 	int currentLeft() const;
 	int currentWidth() const;
-	int finalLeft() const;
-	int finalWidth() const;
 	void animateTo(int left, int width);
 
 	ClickHandlerPtr _link;
 	const Key _key;
+	PhotoData *_photo = nullptr;
+	DocumentData *_document = nullptr;
 	std::shared_ptr<Data::DocumentMedia> _documentMedia;
 	std::shared_ptr<Data::PhotoMedia> _photoMedia;
 	Image *_image = nullptr;
@@ -232,7 +239,6 @@ private:
 GroupThumbs::Thumb::Thumb(Key key, Fn<void()> handler)
 : _key(key) {
 	_link = std::make_shared<LambdaClickHandler>(std::move(handler));
-	validateImage();
 }
 
 GroupThumbs::Thumb::Thumb(
@@ -241,11 +247,9 @@ GroupThumbs::Thumb::Thumb(
 	Data::FileOrigin origin,
 	Fn<void()> handler)
 : _key(key)
-, _photoMedia(photo->createMediaView())
+, _photo(photo)
 , _origin(origin) {
 	_link = std::make_shared<LambdaClickHandler>(std::move(handler));
-	_photoMedia->wanted(Data::PhotoSize::Thumbnail, origin);
-	validateImage();
 }
 
 GroupThumbs::Thumb::Thumb(
@@ -254,11 +258,13 @@ GroupThumbs::Thumb::Thumb(
 	Data::FileOrigin origin,
 	Fn<void()> handler)
 : _key(key)
-, _documentMedia(document->createMediaView())
+, _document(document)
 , _origin(origin) {
 	_link = std::make_shared<LambdaClickHandler>(std::move(handler));
-	_documentMedia->thumbnailWanted(origin);
-	validateImage();
+}
+
+Key GroupThumbs::Thumb::key() const {
+	return _key;
 }
 
 QSize GroupThumbs::Thumb::wantedPixSize() const {
@@ -270,6 +276,13 @@ QSize GroupThumbs::Thumb::wantedPixSize() const {
 }
 
 void GroupThumbs::Thumb::validateImage() {
+	if (_photo && !_photoMedia) {
+		_photoMedia = _photo->createMediaView();
+		_photoMedia->wanted(Data::PhotoSize::Thumbnail, _origin);
+	} else if (_document && !_documentMedia) {
+		_documentMedia = _document->createMediaView();
+		_documentMedia->thumbnailWanted(_origin);
+	}
 	if (!_image) {
 		if (_photoMedia) {
 			_image = _photoMedia->image(Data::PhotoSize::Thumbnail);
@@ -340,6 +353,8 @@ void GroupThumbs::Thumb::setState(State state) {
 	const auto isNewThumb = (_state == State::Alive);
 	_state = state;
 	if (_state == State::Current) {
+		// The current thumb width defines the whole strip layout.
+		validateImage();
 		if (isNewThumb) {
 			_opacity = anim::value(1.);
 			_left = anim::value(-_fullWidth / 2);
@@ -407,20 +422,31 @@ bool GroupThumbs::Thumb::removed() const {
 	return (_state == State::Dying) && _hiding && !_opacity.current();
 }
 
-void GroupThumbs::Thumb::paint(
+void GroupThumbs::Thumb::revive() {
+	_state = State::Alive;
+	_opacity = anim::value(0., 1.);
+	_hiding = false;
+}
+
+bool GroupThumbs::Thumb::paint(
 		Painter &p,
 		int x,
 		int y,
 		int outerWidth,
 		float64 progress) {
-	validateImage();
-
 	_opacity.update(progress, anim::linear);
 	_left.update(progress, anim::linear);
 	_width.update(progress, anim::linear);
 
 	const auto left = x + currentLeft();
 	const auto width = currentWidth();
+	if (left >= outerWidth || left + width <= 0) {
+		return true;
+	}
+	validateImage();
+	if (_full.isNull()) {
+		return false;
+	}
 	const auto opacity = p.opacity();
 	p.setOpacity(_opacity.current() * opacity);
 	if (width == _fullWidth) {
@@ -436,6 +462,7 @@ void GroupThumbs::Thumb::paint(
 		p.drawPixmap(to, _full, from);
 	}
 	p.setOpacity(opacity);
+	return true;
 }
 
 ClickHandlerPtr GroupThumbs::Thumb::getState(QPoint point) const {
@@ -461,6 +488,7 @@ GroupThumbs::GroupThumbs(not_null<Main::Session*> session, Context context)
 void GroupThumbs::updateContext(Context context) {
 	if (_context != context) {
 		clear();
+		_pool.clear();
 		_context = context;
 	}
 }
@@ -728,9 +756,24 @@ auto GroupThumbs::createThumb(Key key, not_null<DocumentData*> document)
 
 auto GroupThumbs::validateCacheEntry(Key key) -> not_null<Thumb*> {
 	const auto i = _cache.find(key);
-	return (i != _cache.end())
-		? i->second.get()
-		: _cache.emplace(key, createThumb(key)).first->second.get();
+	if (i != _cache.end()) {
+		return i->second.get();
+	}
+	const auto j = ranges::find(_pool, key, &Thumb::key);
+	if (j != end(_pool)) {
+		auto thumb = std::move(*j);
+		_pool.erase(j);
+		thumb->revive();
+		return _cache.emplace(key, std::move(thumb)).first->second.get();
+	}
+	return _cache.emplace(key, createThumb(key)).first->second.get();
+}
+
+void GroupThumbs::moveToPool(std::unique_ptr<Thumb> thumb) {
+	if (_pool.size() >= kThumbsPoolSize) {
+		_pool.erase(begin(_pool));
+	}
+	_pool.push_back(std::move(thumb));
 }
 
 void GroupThumbs::markCacheStale() {
@@ -779,13 +822,17 @@ void GroupThumbs::clear() {
 }
 
 void GroupThumbs::startDelayedAnimation() {
+	_composite = QPixmap();
 	_animation.stop();
 	_waitingForAnimationStart = true;
 	countUpdatedRect();
 }
 
 void GroupThumbs::resizeToWidth(int newWidth) {
-	_width = newWidth;
+	if (_width != newWidth) {
+		_width = newWidth;
+		_composite = QPixmap();
+	}
 }
 
 int GroupThumbs::height() const {
@@ -822,9 +869,16 @@ void GroupThumbs::paint(Painter &p, int x, int y, int outerWidth) {
 		: _animation.value(1.);
 	x += (_width / 2);
 	y += st::mediaviewGroupPadding.top();
+	if (!_composite.isNull()) {
+		p.drawPixmap(x + _compositeLeft, y, _composite);
+		return;
+	}
+	auto ready = !_waitingForAnimationStart && !_animation.animating();
 	for (auto i = _cache.begin(); i != _cache.end();) {
 		const auto &thumb = i->second;
-		thumb->paint(p, x, y, outerWidth, progress);
+		if (!thumb->paint(p, x, y, outerWidth, progress)) {
+			ready = false;
+		}
 		if (thumb->removed()) {
 			_dying.erase(
 				ranges::remove(
@@ -832,11 +886,46 @@ void GroupThumbs::paint(Painter &p, int x, int y, int outerWidth) {
 					thumb.get(),
 					[](not_null<Thumb*> thumb) { return thumb.get(); }),
 				_dying.end());
+			moveToPool(std::move(i->second));
 			i = _cache.erase(i);
 		} else {
 			++i;
 		}
 	}
+	if (ready && _dying.empty()) {
+		validateComposite(x, outerWidth);
+	}
+}
+
+void GroupThumbs::validateComposite(int x, int outerWidth) {
+	if (_cache.empty()) {
+		return;
+	}
+	auto left = std::numeric_limits<int>::max();
+	auto right = std::numeric_limits<int>::min();
+	for (const auto &[key, thumb] : _cache) {
+		accumulate_min(left, thumb->finalLeft());
+		accumulate_max(right, thumb->finalLeft() + thumb->finalWidth());
+	}
+	accumulate_max(left, -x);
+	accumulate_min(right, outerWidth - x);
+	if (right <= left) {
+		return;
+	}
+	const auto width = right - left;
+	auto image = QImage(
+		QSize(width, st::mediaviewGroupHeight) * cIntRetinaFactor(),
+		QImage::Format_ARGB32_Premultiplied);
+	image.setDevicePixelRatio(cRetinaFactor());
+	image.fill(Qt::transparent);
+	{
+		Painter q(&image);
+		for (const auto &[key, thumb] : _cache) {
+			thumb->paint(q, -left, 0, width, 1.);
+		}
+	}
+	_composite = Ui::PixmapFromImage(std::move(image));
+	_compositeLeft = left;
 }
 
 ClickHandlerPtr GroupThumbs::getState(QPoint point) const {
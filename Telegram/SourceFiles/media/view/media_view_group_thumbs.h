@@ -30,6 +30,9 @@ public:
 		inline bool operator<(const CollageKey &other) const {
 			return index < other.index;
 		}
+		inline bool operator==(const CollageKey &other) const {
+			return index == other.index;
+		}
 	};
 	struct CollageSlice {
 		FullMsgId context;
@@ -104,6 +107,7 @@ private:
 	void updateContext(Context context);
 	void markCacheStale();
 	not_null<Thumb*> validateCacheEntry(Key key);
+	void moveToPool(std::unique_ptr<Thumb> thumb);
 	std::unique_ptr<Thumb> createThumb(Key key);
 	std::unique_ptr<Thumb> createThumb(
 		Key key,
@@ -123,6 +127,7 @@ private:
 	void markRestAsDying();
 	void animatePreviouslyAlive(const std::vector<not_null<Thumb*>> &old);
 	void startDelayedAnimation();
+	void validateComposite(int x, int outerWidth);
 
 	const not_null<Main::Session*> _session;
 	Context _context;
@@ -131,8 +136,11 @@ private:
 	std::vector<not_null<Thumb*>> _items;
 	std::vector<not_null<Thumb*>> _dying;
 	base::flat_map<Key, std::unique_ptr<Thumb>> _cache;
+	std::vector<std::unique_ptr<Thumb>> _pool;
 	int _width = 0;
 	QRect _updatedRect;
+	QPixmap _composite;
+	int _compositeLeft = 0;
 
 	rpl::event_stream<QRect> _updateRequests;
 	rpl::event_stream<Key> _activateStream;
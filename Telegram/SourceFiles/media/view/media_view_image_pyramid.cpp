@@ -0,0 +1,87 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/view/media_view_image_pyramid.h"
+
+namespace Media::View {
+namespace {
+
+// Smaller images are scaled fast enough as is.
+constexpr auto kMinPyramidSide = 2048;
+constexpr auto kMinLevelSide = 512;
+
+[[nodiscard]] std::vector<QImage> PrepareLevels(QImage original) {
+	auto result = std::vector<QImage>();
+	auto size = original.size();
+	while (std::max(size.width(), size.height()) > 2 * kMinLevelSide) {
+		size = QSize(
+			std::max(size.width() / 2, 1),
+			std::max(size.height() / 2, 1));
+		const auto &from = result.empty() ? original : result.back();
+		result.push_back(from.scaled(
+			size,
+			Qt::IgnoreAspectRatio,
+			Qt::SmoothTransformation
+		).convertToFormat(original.format()));
+	}
+	return result;
+}
+
+} // namespace
+
+ImagePyramid::ImagePyramid(Fn<void()> ready)
+: _ready(std::move(ready)) {
+}
+
+QImage ImagePyramid::level(
+		const QImage &original,
+		QSize target,
+		int maxSide) {
+	if (original.isNull()) {
+		return original;
+	} else if (_cacheKey != original.cacheKey()) {
+		prepare(original);
+	}
+	const auto fits = [&](const QImage &image) {
+		return !maxSide
+			|| (std::max(image.width(), image.height()) <= maxSide);
+	};
+	const auto covers = [&](const QImage &image) {
+		return (image.width() >= target.width())
+			&& (image.height() >= target.height());
+	};
+	auto result = fits(original) ? original : QImage();
+	for (const auto &level : _levels) {
+		if (!fits(level)) {
+			continue;
+		} else if (!result.isNull() && !covers(level)) {
+			break;
+		}
+		result = level;
+	}
+	return result;
+}
+
+void ImagePyramid::prepare(const QImage &original) {
+	_cacheKey = original.cacheKey();
+	_levels.clear();
+	if (std::max(original.width(), original.height()) < kMinPyramidSide) {
+		return;
+	}
+	const auto cacheKey = _cacheKey;
+	crl::async([=, weak = base::make_weak(this)] {
+		auto levels = PrepareLevels(original);
+		crl::on_main(weak, [=, levels = std::move(levels)]() mutable {
+			if (_cacheKey == cacheKey) {
+				_levels = std::move(levels);
+				_ready();
+			}
+		});
+	});
+}
+
+} // namespace Media::View
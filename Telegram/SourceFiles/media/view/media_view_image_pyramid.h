@@ -0,0 +1,38 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+namespace Media::View {
+
+// Halved copies of a large static image, prepared on a worker thread,
+// so that showing it zoomed out doesn't scale the whole original.
+class ImagePyramid final : public base::has_weak_ptr {
+public:
+	explicit ImagePyramid(Fn<void()> ready);
+
+	// The smallest prepared level covering the target size and fitting
+	// into maxSide (if not zero), the original while nothing is prepared.
+	// Returns a null image if the original doesn't fit and no prepared
+	// level fits yet either.
+	[[nodiscard]] QImage level(
+		const QImage &original,
+		QSize target,
+		int maxSide = 0);
+
+private:
+	void prepare(const QImage &original);
+
+	Fn<void()> _ready;
+	qint64 _cacheKey = 0;
+	std::vector<QImage> _levels;
+
+};
+
+} // namespace Media::View
@@ -0,0 +1,33 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/view/media_view_opengl_shaders.h"
+
+namespace Media::View {
+
+Ui::GL::ShaderPart FragmentSampleNV12Texture() {
+	return {
+		.header = R"(
+varying vec2 v_texcoord;
+uniform sampler2D y_texture;
+uniform sampler2D uv_texture;
+)",
+		.body = R"(
+	float y = texture2D(y_texture, v_texcoord).a - 0.0625;
+	vec4 uv = texture2D(uv_texture, v_texcoord);
+	float u = uv.r - 0.5;
+	float v = uv.a - 0.5;
+	result = vec4(
+		1.164 * y + 1.596 * v,
+		1.164 * y - 0.392 * u - 0.813 * v,
+		1.164 * y + 2.17 * u,
+		1.);
+)",
+	};
+}
+
+} // namespace Media::View
@@ -0,0 +1,18 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "ui/gl/gl_shader.h"
+
+namespace Media::View {
+
+// Luma goes to 'y_texture' as GL_ALPHA, the interleaved chroma plane goes
+// to 'uv_texture' as GL_LUMINANCE_ALPHA, so that U is in .r and V in .a.
+[[nodiscard]] Ui::GL::ShaderPart FragmentSampleNV12Texture();
+
+} // namespace Media::View
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/view/media_view_overlay_opengl.h"
 
 #include "ui/gl/gl_shader.h"
+#include "media/view/media_view_opengl_shaders.h"
 #include "media/streaming/media_streaming_common.h"
 #include "base/platform/base_platform_info.h"
 #include "core/crash_reports.h"
@@ -48,7 +49,8 @@ uniform float transparentSize;
 } // namespace
 
 OverlayWidget::RendererGL::RendererGL(not_null<OverlayWidget*> owner)
-: _owner(owner) {
+: _owner(owner)
+, _pyramid([=] { _owner->_widget->update(); }) {
 	style::PaletteChanged(
 	) | rpl::start_with_next([=] {
 		_radialImage.invalidate();
@@ -77,6 +79,7 @@ void OverlayWidget::RendererGL::init(
 	_contentBuffer->allocate(kValues * sizeof(GLfloat));
 
 	_textures.ensureCreated(f);
+	f.glGetIntegerv(GL_MAX_TEXTURE_SIZE, &_maxTextureSize);
 
 	_imageProgram.emplace();
 	_texturedVertexShader = LinkProgram(
@@ -106,6 +109,14 @@ void OverlayWidget::RendererGL::init(
 			FragmentSampleYUV420Texture(),
 		}));
 
+	_nv12Program.emplace();
+	LinkProgram(
+		&*_nv12Program,
+		_texturedVertexShader,
+		FragmentShader({
+			FragmentSampleNV12Texture(),
+		}));
+
 	_fillProgram.emplace();
 	LinkProgram(
 		&*_fillProgram,
@@ -136,6 +147,7 @@ void OverlayWidget::RendererGL::deinit(
 	_texturedVertexShader = nullptr;
 	_withTransparencyProgram = std::nullopt;
 	_yuv420Program = std::nullopt;
+	_nv12Program = std::nullopt;
 	_fillProgram = std::nullopt;
 	_controlsProgram = std::nullopt;
 	_contentBuffer = std::nullopt;
@@ -193,13 +205,18 @@ void OverlayWidget::RendererGL::paintTransformedVideoFrame(
 		paintTransformedStaticContent(data.original, geometry, false, false);
 		return;
 	}
-	Assert(data.format == Streaming::FrameFormat::YUV420);
+	Assert(data.format == Streaming::FrameFormat::YUV420
+		|| data.format == Streaming::FrameFormat::NV12);
 	Assert(!data.yuv420->size.isEmpty());
 	const auto yuv = data.yuv420;
-	_yuv420Program->bind();
+	const auto nv12 = (data.format == Streaming::FrameFormat::NV12);
+	const auto program = nv12 ? &*_nv12Program : &*_yuv420Program;
+	program->bind();
+	const auto nv12changed = (_chromaNV12 != nv12);
 
 	const auto upload = (_trackFrameIndex != data.index)
-		|| (_streamedIndex != _owner->streamedIndex());
+		|| (_streamedIndex != _owner->streamedIndex())
+		|| nv12changed;
 	_trackFrameIndex = data.index;
 	_streamedIndex = _owner->streamedIndex();
 
@@ -219,48 +236,70 @@ void OverlayWidget::RendererGL::paintTransformedVideoFrame(
 	_f->glActiveTexture(GL_TEXTURE1);
 	_textures.bind(*_f, 2);
 	if (upload) {
+		if (nv12changed) {
+			// The chroma texture has a different format, recreate it.
+			_chromaSize = QSize();
+			_chromaNV12 = nv12;
+		}
+		const auto format = nv12 ? GL_LUMINANCE_ALPHA : GL_ALPHA;
 		uploadTexture(
-			GL_ALPHA,
-			GL_ALPHA,
+			format,
+			format,
 			yuv->chromaSize,
 			_chromaSize,
-			yuv->u.stride,
+			nv12 ? (yuv->u.stride / 2) : yuv->u.stride,
 			yuv->u.data);
 	}
-	_f->glActiveTexture(GL_TEXTURE2);
-	_textures.bind(*_f, 3);
+	if (!nv12) {
+		_f->glActiveTexture(GL_TEXTURE2);
+		_textures.bind(*_f, 3);
+		if (upload) {
+			uploadTexture(
+				GL_ALPHA,
+				GL_ALPHA,
+				yuv->chromaSize,
+				_chromaSize,
+				yuv->v.stride,
+				yuv->v.data);
+		}
+	}
 	if (upload) {
-		uploadTexture(
-			GL_ALPHA,
-			GL_ALPHA,
-			yuv->chromaSize,
-			_chromaSize,
-			yuv->v.stride,
-			yuv->v.data);
 		_chromaSize = yuv->chromaSize;
 		_f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 	}
-	_yuv420Program->setUniformValue("y_texture", GLint(0));
-	_yuv420Program->setUniformValue("u_texture", GLint(1));
-	_yuv420Program->setUniformValue("v_texture", GLint(2));
+	program->setUniformValue("y_texture", GLint(0));
+	if (nv12) {
+		program->setUniformValue("uv_texture", GLint(1));
+	} else {
+		program->setUniformValue("u_texture", GLint(1));
+		program->setUniformValue("v_texture", GLint(2));
+	}
 
 	toggleBlending(false);
-	paintTransformedContent(&*_yuv420Program, geometry);
+	paintTransformedContent(program, geometry);
 }
 
 void OverlayWidget::RendererGL::paintTransformedStaticContent(
-		const QImage &image,
+		const QImage &original,
 		ContentGeometry geometry,
 		bool semiTransparent,
 		bool fillTransparentBackground) {
-	Expects(image.isNull()
-		|| image.format() == QImage::Format_RGB32
-		|| image.format() == QImage::Format_ARGB32_Premultiplied);
+	Expects(original.isNull()
+		|| original.format() == QImage::Format_RGB32
+		|| original.format() == QImage::Format_ARGB32_Premultiplied);
 
 	if (geometry.rect.isEmpty()) {
 		return;
 	}
 
+	// Very large images may not fit into a texture at all.
+	const auto image = _owner->_streamed
+		? original
+		: _pyramid.level(
+			original,
+			(geometry.rect.size() * _factor).toSize(),
+			_maxTextureSize);
+
 	auto &program = fillTransparentBackground
 		? _withTransparencyProgram
 		: _imageProgram;
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "media/view/media_view_overlay_renderer.h"
+#include "media/view/media_view_image_pyramid.h"
 #include "ui/gl/gl_image.h"
 #include "ui/gl/gl_primitives.h"
 
@@ -107,13 +108,17 @@ private:
 	QOpenGLShader *_texturedVertexShader = nullptr;
 	std::optional<QOpenGLShaderProgram> _withTransparencyProgram;
 	std::optional<QOpenGLShaderProgram> _yuv420Program;
+	std::optional<QOpenGLShaderProgram> _nv12Program;
 	std::optional<QOpenGLShaderProgram> _fillProgram;
 	std::optional<QOpenGLShaderProgram> _controlsProgram;
 	Ui::GL::Textures<4> _textures;
 	QSize _rgbaSize;
 	QSize _lumaSize;
 	QSize _chromaSize;
+	bool _chromaNV12 = false;
 	qint64 _cacheKey = 0;
+	ImagePyramid _pyramid;
+	GLint _maxTextureSize = 0;
 	int _trackFrameIndex = 0;
 	int _streamedIndex = 0;
 
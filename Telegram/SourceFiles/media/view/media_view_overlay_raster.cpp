@@ -13,7 +13,8 @@ namespace Media::View {
 
 OverlayWidget::RendererSW::RendererSW(not_null<OverlayWidget*> owner)
 : _owner(owner)
-, _transparentBrush(style::TransparentPlaceholder()) {
+, _transparentBrush(style::TransparentPlaceholder())
+, _pyramid([=] { _owner->_widget->update(); }) {
 }
 
 void OverlayWidget::RendererSW::paintFallback(
@@ -91,7 +92,15 @@ void OverlayWidget::RendererSW::paintTransformedStaticContent(
 	if (image.isNull()) {
 		return;
 	}
-	paintTransformedImage(image, rect, rotation);
+	if (_owner->_streamed) {
+		paintTransformedImage(image, rect, rotation);
+		return;
+	}
+	const auto target = geometry.rect.size() * style::DevicePixelRatio();
+	paintTransformedImage(
+		_pyramid.level(image, target.toSize()),
+		rect,
+		rotation);
 }
 
 void OverlayWidget::RendererSW::paintTransformedImage(
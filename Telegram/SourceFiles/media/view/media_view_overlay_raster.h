@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "media/view/media_view_overlay_renderer.h"
+#include "media/view/media_view_image_pyramid.h"
 
 namespace Media::View {
 
@@ -55,6 +56,7 @@ private:
 
 	const not_null<OverlayWidget*> _owner;
 	QBrush _transparentBrush;
+	ImagePyramid _pyramid;
 
 	Painter *_p = nullptr;
 	const QRegion *_clip = nullptr;
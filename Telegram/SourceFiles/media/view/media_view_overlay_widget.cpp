@@ -3042,6 +3042,7 @@ void OverlayWidget::restartAtSeekPosition(crl::time position) {
 	}
 	auto options = Streaming::PlaybackOptions();
 	options.position = position;
+	options.hwAllowed = Core::App().settings().hardwareAcceleratedVideo();
 	if (!_streamed->withSound) {
 		options.mode = Streaming::Mode::Video;
 		options.loop = true;
@@ -3233,6 +3234,14 @@ void OverlayWidget::validatePhotoImage(Image *image, bool blurred) {
 	}
 	const auto use = flipSizeByRotation({ _width, _height })
 		* cIntRetinaFactor();
+	if (!blurred) {
+		auto prepared = takePreparedPhotoImage(image, use);
+		if (!prepared.isNull()) {
+			setStaticContent(std::move(prepared));
+			_blurred = false;
+			return;
+		}
+	}
 	setStaticContent(image->pixNoCache(
 		use.width(),
 		use.height(),
@@ -3242,6 +3251,68 @@ void OverlayWidget::validatePhotoImage(Image *image, bool blurred) {
 	_blurred = blurred;
 }
 
+QImage OverlayWidget::takePreparedPhotoImage(
+		not_null<Image*> image,
+		QSize size) {
+	if (!_photo) {
+		return QImage();
+	}
+	const auto i = _preparedPhotos.find(_photo);
+	if (i == end(_preparedPhotos)
+		|| i->second.source != image
+		|| i->second.size != size
+		|| i->second.image.isNull()) {
+		return QImage();
+	}
+	auto result = std::move(i->second.image);
+	_preparedPhotos.erase(i);
+	return result;
+}
+
+void OverlayWidget::preparePhotoImage(
+		not_null<PhotoData*> photo,
+		not_null<Image*> image) {
+	// Same size validatePhotoImage() will ask when the photo is shown.
+	const auto rotation = photo->owner().mediaRotation().get(photo);
+	const auto size = FlipSizeByRotation(
+		style::ConvertScale(FlipSizeByRotation(
+			QSize(photo->width(), photo->height()),
+			rotation)),
+		rotation) * cIntRetinaFactor();
+	if (size.isEmpty()) {
+		return;
+	}
+	const auto i = _preparedPhotos.find(photo);
+	if (i != end(_preparedPhotos)
+		&& i->second.source == image
+		&& i->second.size == size) {
+		return;
+	}
+	if (i != end(_preparedPhotos)) {
+		i->second = PreparedPhoto{ image, size };
+	} else {
+		_preparedPhotos.emplace(photo, PreparedPhoto{ image, size });
+	}
+	const auto weak = Ui::MakeWeak(_widget);
+	crl::async([=, original = image->original()] {
+		auto scaled = Images::prepare(
+			original,
+			size.width(),
+			size.height(),
+			Images::Option::Smooth,
+			0,
+			0);
+		crl::on_main(weak, [=, result = std::move(scaled)]() mutable {
+			const auto i = _preparedPhotos.find(photo);
+			if (i != end(_preparedPhotos)
+				&& i->second.source == image
+				&& i->second.size == size) {
+				i->second.image = std::move(result);
+			}
+		});
+	});
+}
+
 void OverlayWidget::validatePhotoCurrentImage() {
 	if (!_photo) {
 		return;
@@ -4093,12 +4164,19 @@ void OverlayWidget::preloadData(int delta) {
 
 	auto photos = base::flat_set<std::shared_ptr<Data::PhotoMedia>>();
 	auto documents = base::flat_set<std::shared_ptr<Data::DocumentMedia>>();
+	auto prepared = base::flat_set<not_null<PhotoData*>>();
 	for (auto index = from; index != till + 1; ++index) {
 		auto entity = entityByIndex(index);
 		if (auto photo = std::get_if<not_null<PhotoData*>>(&entity.data)) {
 			const auto [i, ok] = photos.emplace((*photo)->createMediaView());
 			(*i)->wanted(Data::PhotoSize::Small, fileOrigin(entity));
 			(*photo)->load(fileOrigin(entity), LoadFromCloudOrLocal, true);
+			if (index != *_index) {
+				if (const auto large = (*i)->image(Data::PhotoSize::Large)) {
+					prepared.emplace(*photo);
+					preparePhotoImage(*photo, large);
+				}
+			}
 		} else if (auto document = std::get_if<not_null<DocumentData*>>(
 				&entity.data)) {
 			const auto [i, ok] = documents.emplace(
@@ -4111,6 +4189,13 @@ void OverlayWidget::preloadData(int delta) {
 	}
 	_preloadPhotos = std::move(photos);
 	_preloadDocuments = std::move(documents);
+	for (auto i = begin(_preparedPhotos); i != end(_preparedPhotos);) {
+		if (i->first == _photo || prepared.contains(i->first)) {
+			++i;
+		} else {
+			i = _preparedPhotos.erase(i);
+		}
+	}
 }
 
 void OverlayWidget::handleMousePress(
@@ -4631,6 +4716,7 @@ void OverlayWidget::clearBeforeHide() {
 	assignMediaPointer(nullptr);
 	_preloadPhotos.clear();
 	_preloadDocuments.clear();
+	_preparedPhotos.clear();
 	if (_menu) {
 		_menu->hideMenu(true);
 	}
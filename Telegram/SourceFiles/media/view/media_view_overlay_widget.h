@@ -404,6 +404,12 @@ private:
 	[[nodiscard]] bool documentContentShown() const;
 	[[nodiscard]] bool documentBubbleShown() const;
 	void setStaticContent(QImage image);
+	void preparePhotoImage(
+		not_null<PhotoData*> photo,
+		not_null<Image*> image);
+	[[nodiscard]] QImage takePreparedPhotoImage(
+		not_null<Image*> image,
+		QSize size);
 	[[nodiscard]] bool contentShown() const;
 	[[nodiscard]] bool opaqueContentShown() const;
 	void clearStreaming(bool savePosition = true);
@@ -426,6 +432,14 @@ private:
 	std::shared_ptr<Data::DocumentMedia> _documentMedia;
 	base::flat_set<std::shared_ptr<Data::PhotoMedia>> _preloadPhotos;
 	base::flat_set<std::shared_ptr<Data::DocumentMedia>> _preloadDocuments;
+
+	// Large images of the preloaded photos scaled in the background.
+	struct PreparedPhoto {
+		not_null<Image*> source;
+		QSize size;
+		QImage image; // Null while it is being prepared.
+	};
+	base::flat_map<not_null<PhotoData*>, PreparedPhoto> _preparedPhotos;
 	int _rotation = 0;
 	std::unique_ptr<SharedMedia> _sharedMedia;
 	std::optional<SharedMediaWithLastSlice> _sharedMediaData;
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/view/media_view_pip_opengl.h"
 
 #include "ui/gl/gl_shader.h"
+#include "media/view/media_view_opengl_shaders.h"
 #include "ui/gl/gl_primitives.h"
 #include "ui/widgets/shadow.h"
 #include "media/streaming/media_streaming_common.h"
@@ -195,6 +196,16 @@ void Pip::RendererGL::init(
 			FragmentRoundToShadow(),
 		}));
 
+	_nv12Program.emplace();
+	LinkProgram(
+		&*_nv12Program,
+		_texturedVertexShader,
+		FragmentShader({
+			FragmentSampleNV12Texture(),
+			FragmentApplyFade(),
+			FragmentRoundToShadow(),
+		}));
+
 	_imageProgram.emplace();
 	LinkProgram(
 		&*_imageProgram,
@@ -231,6 +242,7 @@ void Pip::RendererGL::deinit(
 	_texturedVertexShader = nullptr;
 	_argb32Program = std::nullopt;
 	_yuv420Program = std::nullopt;
+	_nv12Program = std::nullopt;
 	_controlsProgram = std::nullopt;
 	_contentBuffer = std::nullopt;
 }
@@ -289,12 +301,16 @@ void Pip::RendererGL::paintTransformedVideoFrame(
 		paintTransformedStaticContent(data.original, geometry);
 		return;
 	}
-	Assert(data.format == Streaming::FrameFormat::YUV420);
+	Assert(data.format == Streaming::FrameFormat::YUV420
+		|| data.format == Streaming::FrameFormat::NV12);
 	Assert(!data.yuv420->size.isEmpty());
 	const auto yuv = data.yuv420;
-	_yuv420Program->bind();
+	const auto nv12 = (data.format == Streaming::FrameFormat::NV12);
+	const auto program = nv12 ? &*_nv12Program : &*_yuv420Program;
+	program->bind();
+	const auto nv12changed = (_chromaNV12 != nv12);
 
-	const auto upload = (_trackFrameIndex != data.index);
+	const auto upload = (_trackFrameIndex != data.index) || nv12changed;
 	_trackFrameIndex = data.index;
 
 	_f->glActiveTexture(GL_TEXTURE0);
@@ -313,32 +329,46 @@ void Pip::RendererGL::paintTransformedVideoFrame(
 	_f->glActiveTexture(GL_TEXTURE1);
 	_textures.bind(*_f, 2);
 	if (upload) {
+		if (nv12changed) {
+			// The chroma texture has a different format, recreate it.
+			_chromaSize = QSize();
+			_chromaNV12 = nv12;
+		}
+		const auto format = nv12 ? GL_LUMINANCE_ALPHA : GL_ALPHA;
 		uploadTexture(
-			GL_ALPHA,
-			GL_ALPHA,
+			format,
+			format,
 			yuv->chromaSize,
 			_chromaSize,
-			yuv->u.stride,
+			nv12 ? (yuv->u.stride / 2) : yuv->u.stride,
 			yuv->u.data);
 	}
-	_f->glActiveTexture(GL_TEXTURE2);
-	_textures.bind(*_f, 3);
+	if (!nv12) {
+		_f->glActiveTexture(GL_TEXTURE2);
+		_textures.bind(*_f, 3);
+		if (upload) {
+			uploadTexture(
+				GL_ALPHA,
+				GL_ALPHA,
+				yuv->chromaSize,
+				_chromaSize,
+				yuv->v.stride,
+				yuv->v.data);
+		}
+	}
 	if (upload) {
-		uploadTexture(
-			GL_ALPHA,
-			GL_ALPHA,
-			yuv->chromaSize,
-			_chromaSize,
-			yuv->v.stride,
-			yuv->v.data);
 		_chromaSize = yuv->chromaSize;
 		_f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 	}
-	_yuv420Program->setUniformValue("y_texture", GLint(0));
-	_yuv420Program->setUniformValue("u_texture", GLint(1));
-	_yuv420Program->setUniformValue("v_texture", GLint(2));
+	program->setUniformValue("y_texture", GLint(0));
+	if (nv12) {
+		program->setUniformValue("uv_texture", GLint(1));
+	} else {
+		program->setUniformValue("u_texture", GLint(1));
+		program->setUniformValue("v_texture", GLint(2));
+	}
 
-	paintTransformedContent(&*_yuv420Program, geometry);
+	paintTransformedContent(program, geometry);
 }
 
 void Pip::RendererGL::paintTransformedStaticContent(
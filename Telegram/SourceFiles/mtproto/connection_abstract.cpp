@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/connection_tcp.h"
 #include "mtproto/connection_http.h"
 #include "mtproto/connection_resolving.h"
+#include "mtproto/details/mtproto_buffer_pool.h"
 #include "mtproto/session.h"
 #include "base/unixtime.h"
 #include "base/random.h"
@@ -81,7 +82,6 @@ mtpBuffer AbstractConnection::prepareSecurePacket(
 		uint64 keyId,
 		MTPint128 msgKey,
 		uint32 size) const {
-	auto result = mtpBuffer();
 	constexpr auto kTcpPrefixInts = 2;
 	constexpr auto kAuthKeyIdPosition = kTcpPrefixInts;
 	constexpr auto kAuthKeyIdInts = 2;
@@ -92,7 +92,7 @@ mtpBuffer AbstractConnection::prepareSecurePacket(
 		+ kAuthKeyIdInts
 		+ kMessageKeyInts;
 	constexpr auto kTcpPostfixInts = 4;
-	result.reserve(kPrefixInts + size + kTcpPostfixInts);
+	auto result = AcquireBuffer(int(kPrefixInts + size + kTcpPostfixInts));
 	result.resize(kPrefixInts);
 	*reinterpret_cast<uint64*>(&result[kAuthKeyIdPosition]) = keyId;
 	*reinterpret_cast<MTPint128*>(&result[kMessageKeyPosition]) = msgKey;
@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "mtproto/connection_http.h"
 
+#include "mtproto/details/mtproto_buffer_pool.h"
 #include "base/random.h"
 #include "base/qthelp_url.h"
 
@@ -39,12 +40,20 @@ void HttpConnection::sendData(mtpBuffer &&buffer) {
 
 	int32 requestSize = (buffer.size() - 2) * sizeof(mtpPrime);
 
-	QNetworkRequest request(url());
+	QNetworkRequest request(_url);
 	request.setHeader(QNetworkRequest::ContentLengthHeader, QVariant(requestSize));
 	request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(qsl("application/x-www-form-urlencoded")));
 
+	// Keep the sockets open between requests and let the manager put
+	// several POSTs on one socket instead of waiting for each reply.
+	request.setRawHeader("Connection", "keep-alive");
+	request.setAttribute(
+		QNetworkRequest::HttpPipeliningAllowedAttribute,
+		true);
+
 	TCP_LOG(("HTTP Info: sending %1 len request").arg(requestSize));
 	_requests.insert(_manager.post(request, QByteArray((const char*)(&buffer[2]), requestSize)));
+	ReleaseBuffer(std::move(buffer));
 }
 
 void HttpConnection::disconnectFromServer() {
@@ -70,6 +79,7 @@ void HttpConnection::connectToServer(
 		int16 protocolDcId,
 		bool protocolForFiles) {
 	_address = address;
+	_url = url();
 	connect(
 		&_manager,
 		&QNetworkAccessManager::finished,
@@ -81,7 +91,7 @@ void HttpConnection::connectToServer(
 	DEBUG_LOG(("HTTP Info: "
 		"dc:%1 - Sending fake req_pq to '%2'"
 		).arg(protocolDcId
-		).arg(url().toDisplayString()));
+		).arg(_url.toDisplayString()));
 
 	_pingTime = crl::now();
 	sendData(std::move(buffer));
@@ -98,7 +108,8 @@ mtpBuffer HttpConnection::handleResponse(QNetworkReply *reply) {
 		return mtpBuffer(1, -500);
 	}
 
-	mtpBuffer data(response.size() >> 2);
+	auto data = AcquireBuffer(response.size() >> 2);
+	data.resize(response.size() >> 2);
 	memcpy(data.data(), response.constData(), response.size());
 
 	return data;
@@ -173,7 +184,7 @@ void HttpConnection::requestFinished(QNetworkReply *reply) {
 			error(data[0]);
 		} else if (!data.isEmpty()) {
 			if (_status == Status::Ready) {
-				_receivedQueue.push_back(data);
+				_receivedQueue.push_back(std::move(data));
 				receivedData();
 			} else if (const auto res_pq = readPQFakeReply(data)) {
 				const auto &data = res_pq->c_resPQ();
@@ -58,6 +58,7 @@ private:
 
 	QNetworkAccessManager _manager;
 	QString _address;
+	QUrl _url;
 
 	QSet<QNetworkReply*> _requests;
 
@@ -8,6 +8,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/connection_tcp.h"
 
 #include "mtproto/details/mtproto_abstract_socket.h"
+#include "mtproto/details/mtproto_buffer_pool.h"
+#include "mtproto/details/mtproto_network_simulator.h"
 #include "base/bytes.h"
 #include "base/openssl_help.h"
 #include "base/random.h"
@@ -386,7 +388,8 @@ mtpBuffer TcpConnection::parsePacket(bytes::const_span bytes) {
 		}
 		return mtpBuffer(1, ints[0]);
 	}
-	auto result = mtpBuffer(ints.size());
+	auto result = AcquireBuffer(int(ints.size()));
+	result.resize(ints.size());
 	memcpy(result.data(), ints.data(), ints.size() * sizeof(mtpPrime));
 	return result;
 }
@@ -426,6 +429,7 @@ void TcpConnection::sendData(mtpBuffer &&buffer) {
 	TCP_LOG(("TCP Info: write packet %1 bytes").arg(bytes.size()));
 	aesCtrEncrypt(bytes, _sendKey, &_sendState);
 	_socket->write(connectionStartPrefix, bytes);
+	ReleaseBuffer(std::move(buffer));
 }
 
 bytes::const_span TcpConnection::prepareConnectionStartPrefix(
@@ -521,11 +525,14 @@ void TcpConnection::connectToServer(
 			).arg(protocolDcId
 			).arg(_address + ':' + QString::number(_port)));
 	}
-	_socket = AbstractSocket::Create(
+	_socket = WrapSimulatedSocket(
 		thread(),
-		secret,
-		ToNetworkProxy(_proxy),
-		protocolForFiles);
+		AbstractSocket::Create(
+			thread(),
+			secret,
+			ToNetworkProxy(_proxy),
+			protocolForFiles),
+		protocolDcId);
 	_protocolDcId = protocolDcId;
 
 	_socket->connected(
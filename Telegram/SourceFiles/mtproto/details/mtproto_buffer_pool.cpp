@@ -0,0 +1,127 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_buffer_pool.h"
+
+#include <QtCore/QMutex>
+
+namespace MTP::details {
+namespace {
+
+constexpr auto kMinClassShift = 6; // 64 ints.
+constexpr auto kMaxClassShift = 17; // 128K ints, the largest file part.
+constexpr auto kClassesCount = kMaxClassShift - kMinClassShift + 1;
+constexpr auto kLocalBytesLimit = 2 * 1024 * 1024;
+constexpr auto kSharedBytesLimit = 8 * 1024 * 1024;
+
+using FreeList = std::vector<mtpBuffer>;
+
+struct SharedPool {
+	QMutex mutex;
+	std::array<FreeList, kClassesCount> lists;
+};
+
+[[nodiscard]] SharedPool &Shared() {
+	static auto result = SharedPool();
+	return result;
+}
+
+[[nodiscard]] std::array<FreeList, kClassesCount> &Local() {
+	thread_local auto result = std::array<FreeList, kClassesCount>();
+	return result;
+}
+
+[[nodiscard]] int ClassInts(int index) {
+	return (1 << (kMinClassShift + index));
+}
+
+[[nodiscard]] int ListLimit(int index, int bytesLimit) {
+	return std::max(bytesLimit / int(ClassInts(index) * sizeof(mtpPrime)), 2);
+}
+
+// Smallest class that fits 'ints', to acquire from.
+[[nodiscard]] int ClassToAcquire(int ints) {
+	auto result = 0;
+	while (result < kClassesCount && ClassInts(result) < ints) {
+		++result;
+	}
+	return result;
+}
+
+// Largest class that 'capacity' fits, to release to.
+[[nodiscard]] int ClassToRelease(int capacity) {
+	auto result = -1;
+	while (result + 1 < kClassesCount && ClassInts(result + 1) <= capacity) {
+		++result;
+	}
+	return result;
+}
+
+void Refill(FreeList &list, int index) {
+	auto &shared = Shared();
+	QMutexLocker lock(&shared.mutex);
+	auto &from = shared.lists[index];
+	const auto count = std::min(
+		int(from.size()),
+		ListLimit(index, kLocalBytesLimit) / 2);
+	for (auto i = 0; i != count; ++i) {
+		list.push_back(std::move(from.back()));
+		from.pop_back();
+	}
+}
+
+void Spill(FreeList &list, int index) {
+	auto &shared = Shared();
+	QMutexLocker lock(&shared.mutex);
+	auto &to = shared.lists[index];
+	const auto limit = ListLimit(index, kSharedBytesLimit);
+	const auto count = int(list.size()) / 2;
+	for (auto i = 0; i != count; ++i) {
+		if (int(to.size()) < limit) {
+			to.push_back(std::move(list.back()));
+		}
+		list.pop_back();
+	}
+}
+
+} // namespace
+
+mtpBuffer AcquireBuffer(int ints) {
+	const auto index = ClassToAcquire(ints);
+	if (index == kClassesCount) {
+		auto result = mtpBuffer();
+		result.reserve(ints);
+		return result;
+	}
+	auto &list = Local()[index];
+	if (list.empty()) {
+		Refill(list, index);
+		if (list.empty()) {
+			auto result = mtpBuffer();
+			result.reserve(ClassInts(index));
+			return result;
+		}
+	}
+	auto result = std::move(list.back());
+	list.pop_back();
+	return result;
+}
+
+void ReleaseBuffer(mtpBuffer &&buffer) {
+	const auto index = ClassToRelease(buffer.capacity());
+	if (index < 0 || !buffer.isDetached()) {
+		return;
+	}
+	auto &list = Local()[index];
+	if (int(list.size()) >= ListLimit(index, kLocalBytesLimit)) {
+		Spill(list, index);
+	}
+	buffer.clear();
+	list.push_back(std::move(buffer));
+}
+
+} // namespace MTP::details
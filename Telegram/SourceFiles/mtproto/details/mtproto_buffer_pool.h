@@ -0,0 +1,25 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP::details {
+
+// Buffers are kept in power of two size classes in per-thread free lists.
+// Threads that release more than they acquire (session threads releasing
+// requests serialized in the main thread) spill the excess to a shared
+// list, from which the other threads refill their own lists.
+
+// Returns an empty buffer with at least the capacity for 'ints' values.
+[[nodiscard]] mtpBuffer AcquireBuffer(int ints);
+
+// The buffer is reused only if its data is not shared with other copies.
+void ReleaseBuffer(mtpBuffer &&buffer);
+
+} // namespace MTP::details
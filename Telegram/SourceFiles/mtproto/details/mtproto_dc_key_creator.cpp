@@ -13,9 +13,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/openssl_help.h"
 #include "base/random.h"
 #include "base/unixtime.h"
+#include "base/invoke_queued.h"
 #include "scheme.h"
 #include "logs.h"
 
+#include <crl/crl_async.h>
 #include <cmath>
 
 namespace MTP::details {
@@ -387,10 +389,13 @@ DcKeyCreator::DcKeyCreator(
 , _dcId(dcId)
 , _protocolDcId(protocolDcId)
 , _request(request)
-, _delegate(std::move(delegate)) {
+, _delegate(std::move(delegate))
+, _guard(std::make_shared<Guard>()) {
 	Expects(_request.temporaryExpiresIn > 0);
 	Expects(_delegate.done != nullptr);
 
+	_guard->creator = this;
+
 	QObject::connect(_connection, &AbstractConnection::receivedData, [=] {
 		answered();
 	});
@@ -403,6 +408,10 @@ DcKeyCreator::DcKeyCreator(
 }
 
 DcKeyCreator::~DcKeyCreator() {
+	{
+		QMutexLocker lock(&_guard->mutex);
+		_guard->creator = nullptr;
+	}
 	if (_delegate.done) {
 		stopReceiving();
 	}
@@ -664,12 +673,6 @@ void DcKeyCreator::dhParamsAnswered(
 		}
 		base::unixtime::update(dh_inner_data.vserver_time().v);
 
-		// check that dhPrime and (dhPrime - 1) / 2 are really prime
-		if (!IsPrimeAndGood(bytes::make_span(dh_inner_data.vdh_prime().v), dh_inner_data.vg().v)) {
-			LOG(("AuthKey Error: bad dh_prime primality!"));
-			return failed();
-		}
-
 		attempt->dhPrime = bytes::make_vector(
 			dh_inner_data.vdh_prime().v);
 		attempt->data.g = dh_inner_data.vg().v;
@@ -704,18 +707,59 @@ void DcKeyCreator::dhClientParamsSend(not_null<Attempt*> attempt) {
 	// gen rand 'b'
 	auto randomSeed = bytes::vector(ModExpFirst::kRandomPowerSize);
 	bytes::set_random(randomSeed);
-	auto g_b_data = CreateModExp(attempt->data.g, attempt->dhPrime, randomSeed);
-	if (g_b_data.modexp.empty()) {
+
+	// Prime checks and modular exponentiation take a lot of CPU time,
+	// so many sessions creating keys at once should not wait for each other.
+	attempt->stage = Stage::ComputingDH;
+	crl::async([
+		=,
+		guard = _guard,
+		g = attempt->data.g,
+		prime = attempt->dhPrime,
+		g_a = attempt->g_a
+	] {
+		auto computed = ComputedDH();
+
+		// check that dhPrime and (dhPrime - 1) / 2 are really prime
+		computed.primeGood = IsPrimeAndGood(prime, g);
+		if (computed.primeGood) {
+			auto g_b_data = CreateModExp(g, prime, randomSeed);
+			if (!g_b_data.modexp.empty()) {
+				computed.authKey = CreateAuthKey(
+					g_a,
+					g_b_data.randomPower,
+					prime);
+				computed.modexp = std::move(g_b_data.modexp);
+			}
+		}
+
+		QMutexLocker lock(&guard->mutex);
+		if (const auto creator = guard->creator) {
+			InvokeQueued(creator->_connection, [=] {
+				if (const auto creator = guard->creator) {
+					creator->dhClientParamsComputed(attempt, computed);
+				}
+			});
+		}
+	});
+}
+
+void DcKeyCreator::dhClientParamsComputed(
+		not_null<Attempt*> attempt,
+		const ComputedDH &computed) {
+	if (attempt->stage != Stage::ComputingDH || !_delegate.done) {
+		return;
+	} else if (!computed.primeGood) {
+		LOG(("AuthKey Error: bad dh_prime primality!"));
+		return failed();
+	} else if (computed.modexp.empty()) {
 		LOG(("AuthKey Error: could not generate good g_b."));
 		return failed();
-	}
-
-	auto computedAuthKey = CreateAuthKey(attempt->g_a, g_b_data.randomPower, attempt->dhPrime);
-	if (computedAuthKey.empty()) {
+	} else if (computed.authKey.empty()) {
 		LOG(("AuthKey Error: could not generate auth_key."));
 		return failed();
 	}
-	AuthKey::FillData(attempt->authKey, computedAuthKey);
+	AuthKey::FillData(attempt->authKey, computed.authKey);
 
 	auto auth_key_sha = openssl::Sha1(attempt->authKey);
 	memcpy(&attempt->data.auth_key_aux_hash.v, auth_key_sha.data(), 8);
@@ -725,7 +769,7 @@ void DcKeyCreator::dhClientParamsSend(not_null<Attempt*> attempt) {
 		attempt->data.nonce,
 		attempt->data.server_nonce,
 		attempt->data.retry_id,
-		MTP_bytes(g_b_data.modexp));
+		MTP_bytes(computed.modexp));
 
 	auto sdhEncString = EncryptClientDHInner(
 		client_dh_inner,
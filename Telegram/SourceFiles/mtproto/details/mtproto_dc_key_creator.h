@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/basic_types.h"
 #include "base/expected.h"
 
+#include <QtCore/QMutex>
+
 namespace MTP {
 class DcOptions;
 } // namespace MTP
@@ -58,6 +60,7 @@ private:
 		None,
 		WaitingPQ,
 		WaitingDH,
+		ComputingDH,
 		WaitingDone,
 		Ready,
 	};
@@ -94,6 +97,17 @@ private:
 		uint32 retries = 0;
 		Stage stage = Stage::None;
 	};
+	struct ComputedDH {
+		bytes::vector modexp;
+		bytes::vector authKey;
+		bool primeGood = false;
+	};
+
+	// Computations finish in the thread pool, the creator may be gone.
+	struct Guard {
+		QMutex mutex;
+		DcKeyCreator *creator = nullptr;
+	};
 
 	template <typename RequestType>
 	void sendNotSecureRequest(const RequestType &request);
@@ -116,6 +130,9 @@ private:
 		not_null<Attempt*> attempt,
 		const MTPserver_DH_Params &data);
 	void dhClientParamsSend(not_null<Attempt*> attempt);
+	void dhClientParamsComputed(
+		not_null<Attempt*> attempt,
+		const ComputedDH &computed);
 	void dhClientParamsAnswered(
 		not_null<Attempt*> attempt,
 		const MTPset_client_DH_params_answer &data);
@@ -134,6 +151,8 @@ private:
 	Attempt _temporary;
 	Attempt _persistent;
 
+	std::shared_ptr<Guard> _guard;
+
 };
 
 } // namespace MTP::details
@@ -25,6 +25,7 @@ namespace {
 constexpr auto kSendNextTimeout = crl::time(800);
 constexpr auto kMinTimeToLive = 10 * crl::time(1000);
 constexpr auto kMaxTimeToLive = 300 * crl::time(1000);
+constexpr auto kMaxStaleTime = 3600 * crl::time(1000);
 
 } // namespace
 
@@ -202,6 +203,9 @@ void DomainResolver::resolve(const AttemptKey &key) {
 		checkExpireAndPushResult(key.domain);
 		return;
 	}
+	const auto stale = !key.ipv6
+		&& (i != end(_cache))
+		&& (i->second.expireAt + kMaxStaleTime > _lastTimestamp);
 
 	auto attempts = std::vector<Attempt>();
 	auto domains = DnsDomains();
@@ -234,6 +238,30 @@ void DomainResolver::resolve(const AttemptKey &key) {
 
 	_attempts.emplace(key, Attempts{ std::move(attempts) });
 	sendNextRequest(key);
+
+	if (stale) {
+		pushStaleResult(key.domain);
+	}
+}
+
+void DomainResolver::pushStaleResult(const QString &domain) {
+	// Connect to the last known addresses while resolving them again,
+	// fresh addresses will be pushed as soon as they are received.
+	auto ips = QStringList();
+	for (const auto ipv6 : { false, true }) {
+		const auto i = _cache.find({ domain, ipv6 });
+		if (i != end(_cache)
+			&& i->second.expireAt + kMaxStaleTime > _lastTimestamp) {
+			ips.append(i->second.ips);
+		}
+	}
+	if (ips.isEmpty()) {
+		return;
+	}
+	const auto expireAt = _lastTimestamp + kMinTimeToLive;
+	InvokeQueued(this, [=] {
+		_callback(domain, ips, expireAt);
+	});
 }
 
 void DomainResolver::checkExpireAndPushResult(const QString &domain) {
@@ -83,6 +83,7 @@ private:
 	void sendNextRequest(const AttemptKey &key);
 	void performRequest(const AttemptKey &key, const Attempt &attempt);
 	void checkExpireAndPushResult(const QString &domain);
+	void pushStaleResult(const QString &domain);
 	void requestFinished(
 		const AttemptKey &key,
 		not_null<QNetworkReply*> reply);
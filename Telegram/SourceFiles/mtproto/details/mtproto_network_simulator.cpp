@@ -0,0 +1,273 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_network_simulator.h"
+
+#include "base/random.h"
+
+#include <QtCore/QMutex>
+
+namespace MTP::details {
+namespace {
+
+constexpr auto kReadChunkSize = 16 * 1024;
+constexpr auto kRetransmitDelay = crl::time(200);
+constexpr auto kTestModeDcIdShift = 10000;
+
+struct State {
+	QMutex mutex;
+	base::flat_map<int, NetworkConditions> conditions;
+	std::atomic<bool> enabled = false;
+};
+
+[[nodiscard]] State &GetState() {
+	static auto result = State();
+	return result;
+}
+
+[[nodiscard]] std::optional<NetworkConditions> LookupConditions(int dcId) {
+	auto &state = GetState();
+	QMutexLocker lock(&state.mutex);
+	const auto i = state.conditions.find(dcId);
+	if (i != end(state.conditions)) {
+		return i->second;
+	}
+	const auto j = state.conditions.find(0);
+	if (j != end(state.conditions)) {
+		return j->second;
+	}
+	return std::nullopt;
+}
+
+} // namespace
+
+void SetNetworkConditions(base::flat_map<int, NetworkConditions> conditions) {
+	auto &state = GetState();
+	QMutexLocker lock(&state.mutex);
+	state.enabled = !conditions.empty();
+	state.conditions = std::move(conditions);
+}
+
+bool NetworkSimulationEnabled() {
+	return GetState().enabled;
+}
+
+std::unique_ptr<AbstractSocket> WrapSimulatedSocket(
+		not_null<QThread*> thread,
+		std::unique_ptr<AbstractSocket> socket,
+		int16 protocolDcId) {
+	if (!NetworkSimulationEnabled()) {
+		return socket;
+	}
+	const auto dcId = std::abs(int(protocolDcId)) % kTestModeDcIdShift;
+	const auto conditions = LookupConditions(dcId);
+	if (!conditions) {
+		return socket;
+	}
+	return std::make_unique<SimulatedSocket>(
+		thread,
+		std::move(socket),
+		dcId,
+		*conditions);
+}
+
+SimulatedSocket::SimulatedSocket(
+	not_null<QThread*> thread,
+	std::unique_ptr<AbstractSocket> socket,
+	int dcId,
+	NetworkConditions conditions)
+: AbstractSocket(thread)
+, _socket(std::move(socket))
+, _conditions(conditions)
+, _dcId(dcId)
+, _timer(thread, [=] { process(); })
+, _connectedTimer(thread, [=] { _connected.fire({}); }) {
+	_socket->connected(
+	) | rpl::start_with_next([=] {
+		// Connection establishing takes a round trip.
+		_connectedTimer.callOnce(2 * _conditions.latency);
+	}, _lifetime);
+
+	_socket->disconnected(
+	) | rpl::start_to_stream(_disconnected, _lifetime);
+
+	_socket->readyRead(
+	) | rpl::start_with_next([=] {
+		readFromSocket();
+	}, _lifetime);
+
+	_socket->error(
+	) | rpl::start_to_stream(_error, _lifetime);
+
+	_socket->syncTimeRequests(
+	) | rpl::start_to_stream(_syncTimeRequests, _lifetime);
+}
+
+SimulatedSocket::~SimulatedSocket() {
+	const auto duration = _started ? (crl::now() - _started) : 0;
+	LOG(("Network Simulation: dc %1 - received %2 bytes, sent %3 bytes "
+		"in %4 ms, first bytes after %5 ms%6."
+		).arg(_dcId
+		).arg(_incoming.total
+		).arg(_outgoing.total
+		).arg(duration
+		).arg(_firstReceived ? (_firstReceived - _started) : -1
+		).arg(_reset ? ", reset" : ""));
+}
+
+void SimulatedSocket::connectToHost(const QString &address, int port) {
+	_started = crl::now();
+	_socket->connectToHost(address, port);
+}
+
+bool SimulatedSocket::isGoodStartNonce(bytes::const_span nonce) {
+	return _socket->isGoodStartNonce(nonce);
+}
+
+void SimulatedSocket::timedOut() {
+	_socket->timedOut();
+}
+
+bool SimulatedSocket::isConnected() {
+	return !_reset && _socket->isConnected();
+}
+
+bool SimulatedSocket::hasBytesAvailable() {
+	return (_receivedOffset < int64(_received.size()));
+}
+
+int64 SimulatedSocket::read(bytes::span buffer) {
+	const auto available = int64(_received.size()) - _receivedOffset;
+	const auto count = std::min(available, int64(buffer.size()));
+	if (count <= 0) {
+		return 0;
+	}
+	bytes::copy(
+		buffer,
+		bytes::make_span(_received).subspan(_receivedOffset, count));
+	_receivedOffset += count;
+	if (_receivedOffset == int64(_received.size())) {
+		_received.clear();
+		_receivedOffset = 0;
+	}
+	return count;
+}
+
+void SimulatedSocket::write(
+		bytes::const_span prefix,
+		bytes::const_span buffer) {
+	Expects(!buffer.empty());
+
+	if (_reset) {
+		return;
+	} else if (randomChance(_conditions.reset)) {
+		simulateReset();
+		return;
+	}
+	auto data = bytes::vector();
+	data.reserve(prefix.size() + buffer.size());
+	data.insert(end(data), prefix.begin(), prefix.end());
+	data.insert(end(data), buffer.begin(), buffer.end());
+	enqueue(_outgoing, std::move(data));
+	process();
+}
+
+int32 SimulatedSocket::debugState() {
+	return _socket->debugState();
+}
+
+void SimulatedSocket::readFromSocket() {
+	while (!_reset
+		&& _socket->isConnected()
+		&& _socket->hasBytesAvailable()) {
+		auto data = bytes::vector(kReadChunkSize);
+		const auto read = _socket->read(data);
+		if (read <= 0) {
+			break;
+		} else if (randomChance(_conditions.reset)) {
+			simulateReset();
+			return;
+		}
+		data.resize(read);
+		enqueue(_incoming, std::move(data));
+	}
+	process();
+}
+
+void SimulatedSocket::enqueue(Direction &direction, bytes::vector &&data) {
+	const auto now = crl::now();
+	const auto size = int64(data.size());
+	const auto transfer = (_conditions.bandwidth > 0)
+		? crl::time(size * 1000 / _conditions.bandwidth)
+		: crl::time(0);
+	direction.freeAt = std::max(direction.freeAt, now) + transfer;
+	auto when = direction.freeAt + _conditions.latency;
+	if (_conditions.jitter > 0) {
+		when += crl::time(
+			base::RandomValue<uint32>() % uint32(_conditions.jitter + 1));
+	}
+	if (randomChance(_conditions.loss)) {
+		when += kRetransmitDelay + 2 * _conditions.latency;
+	}
+
+	// It is a stream, so the chunks are never reordered.
+	direction.lastAt = when = std::max(when, direction.lastAt);
+	direction.total += size;
+	direction.chunks.push_back({ when, std::move(data) });
+}
+
+bool SimulatedSocket::randomChance(float64 chance) const {
+	if (chance <= 0.) {
+		return false;
+	}
+	const auto limit = std::numeric_limits<uint32>::max();
+	return (base::RandomValue<uint32>() < uint32(std::min(chance, 1.) * limit));
+}
+
+void SimulatedSocket::process() {
+	const auto now = crl::now();
+	while (!_outgoing.chunks.empty() && _outgoing.chunks.front().when <= now) {
+		_socket->write({}, _outgoing.chunks.front().data);
+		_outgoing.chunks.pop_front();
+	}
+	auto received = false;
+	while (!_incoming.chunks.empty() && _incoming.chunks.front().when <= now) {
+		const auto &data = _incoming.chunks.front().data;
+		_received.insert(end(_received), data.begin(), data.end());
+		_incoming.chunks.pop_front();
+		received = true;
+	}
+	auto next = std::optional<crl::time>();
+	if (!_outgoing.chunks.empty()) {
+		next = _outgoing.chunks.front().when;
+	}
+	if (!_incoming.chunks.empty()) {
+		next = std::min(
+			next.value_or(_incoming.chunks.front().when),
+			_incoming.chunks.front().when);
+	}
+	if (next) {
+		_timer.callOnce(std::max(*next - now, crl::time(0)));
+	}
+	if (received) {
+		if (!_firstReceived) {
+			_firstReceived = now;
+		}
+		_readyRead.fire({});
+	}
+}
+
+void SimulatedSocket::simulateReset() {
+	LOG(("Network Simulation: dc %1 - connection reset.").arg(_dcId));
+	_reset = true;
+	_timer.cancel();
+	_incoming.chunks.clear();
+	_outgoing.chunks.clear();
+	_error.fire({});
+}
+
+} // namespace MTP::details
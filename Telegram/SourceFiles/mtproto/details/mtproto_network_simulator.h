@@ -0,0 +1,89 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/details/mtproto_abstract_socket.h"
+#include "base/timer.h"
+
+namespace MTP::details {
+
+// Developer tool for reproducing bad networks locally, the conditions are
+// applied to the sockets created after they were set.
+struct NetworkConditions {
+	crl::time latency = 0; // One way, for both directions.
+	crl::time jitter = 0;
+	int64 bandwidth = 0; // Bytes per second for each direction, 0 for any.
+	float64 loss = 0.; // Chance of a chunk being delayed by retransmit.
+	float64 reset = 0.; // Chance of a connection reset on a chunk.
+};
+
+// The key is a bare dc id, zero key applies to all other dcs.
+void SetNetworkConditions(base::flat_map<int, NetworkConditions> conditions);
+[[nodiscard]] bool NetworkSimulationEnabled();
+
+// Returns the socket itself if there are no conditions for this dc.
+[[nodiscard]] std::unique_ptr<AbstractSocket> WrapSimulatedSocket(
+	not_null<QThread*> thread,
+	std::unique_ptr<AbstractSocket> socket,
+	int16 protocolDcId);
+
+class SimulatedSocket final : public AbstractSocket {
+public:
+	SimulatedSocket(
+		not_null<QThread*> thread,
+		std::unique_ptr<AbstractSocket> socket,
+		int dcId,
+		NetworkConditions conditions);
+	~SimulatedSocket();
+
+	void connectToHost(const QString &address, int port) override;
+	bool isGoodStartNonce(bytes::const_span nonce) override;
+	void timedOut() override;
+	bool isConnected() override;
+	bool hasBytesAvailable() override;
+	int64 read(bytes::span buffer) override;
+	void write(bytes::const_span prefix, bytes::const_span buffer) override;
+
+	int32 debugState() override;
+
+private:
+	struct Chunk {
+		crl::time when = 0;
+		bytes::vector data;
+	};
+	struct Direction {
+		std::deque<Chunk> chunks;
+		crl::time freeAt = 0;
+		crl::time lastAt = 0;
+		int64 total = 0;
+	};
+
+	void readFromSocket();
+	void enqueue(Direction &direction, bytes::vector &&data);
+	[[nodiscard]] bool randomChance(float64 chance) const;
+	void process();
+	void simulateReset();
+
+	const std::unique_ptr<AbstractSocket> _socket;
+	const NetworkConditions _conditions;
+	const int _dcId = 0;
+	base::Timer _timer;
+	base::Timer _connectedTimer;
+	Direction _incoming;
+	Direction _outgoing;
+	bytes::vector _received;
+	int64 _receivedOffset = 0;
+	crl::time _started = 0;
+	crl::time _firstReceived = 0;
+	bool _reset = false;
+
+	rpl::lifetime _lifetime;
+
+};
+
+} // namespace MTP::details
@@ -10,17 +10,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace MTP::details {
 
 bool ReceivedIdsManager::registerMsgId(mtpMsgId msgId, bool needAck) {
-	const auto i = _idsNeedAck.find(msgId);
-	if (i == _idsNeedAck.end()) {
-		if (_idsNeedAck.size() < kIdsBufferSize || msgId > min()) {
-			_idsNeedAck.emplace(msgId, needAck);
-			return true;
-		}
+	if (_idsNeedAck.size() >= kIdsBufferSize && msgId < min()) {
 		MTP_LOG(-1, ("No need to handle - %1 < min = %2").arg(msgId).arg(min()));
-	} else {
+		return false;
+	} else if (!_idsNeedAck.emplace(msgId, needAck).second) {
 		MTP_LOG(-1, ("No need to handle - %1 already is in map").arg(msgId));
+		return false;
 	}
-	return false;
+	return true;
 }
 
 mtpMsgId ReceivedIdsManager::min() const {
@@ -41,9 +38,10 @@ ReceivedIdsManager::State ReceivedIdsManager::lookup(mtpMsgId msgId) const {
 }
 
 void ReceivedIdsManager::shrink() {
-	auto size = _idsNeedAck.size();
-	while (size-- > kIdsBufferSize) {
-		_idsNeedAck.erase(_idsNeedAck.begin());
+	const auto size = int(_idsNeedAck.size());
+	if (size > kIdsBufferSize) {
+		const auto from = _idsNeedAck.begin();
+		_idsNeedAck.erase(from, from + (size - kIdsBufferSize));
 	}
 }
 
@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "mtproto/details/mtproto_serialized_request.h"
 
+#include "mtproto/details/mtproto_buffer_pool.h"
 #include "base/random.h"
 
 namespace MTP::details {
@@ -47,13 +48,18 @@ SerializedRequest SerializedRequest::Prepare(
 	const auto finalSize = std::max(size, reserveSize);
 
 	auto result = SerializedRequest(RequestConstructHider::Tag{});
-	result->reserve(kMessageBodyPosition + finalSize);
+	static_cast<mtpBuffer&>(*result) = AcquireBuffer(
+		kMessageBodyPosition + finalSize);
 	result->resize(kMessageBodyPosition);
 	result->back() = (size << 2);
 	result->lastSentTime = crl::now();
 	return result;
 }
 
+RequestData::~RequestData() {
+	ReleaseBuffer(std::move(static_cast<mtpBuffer&>(*this)));
+}
+
 RequestData *SerializedRequest::operator->() const {
 	Expects(_data != nullptr);
 
@@ -86,6 +86,7 @@ class RequestData : public mtpBuffer {
 public:
 	explicit RequestData(const RequestConstructHider::Tag &) {
 	}
+	~RequestData();
 
 	SerializedRequest after;
 	crl::time lastSentTime = 0;
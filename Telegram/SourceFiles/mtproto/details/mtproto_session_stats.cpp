@@ -0,0 +1,104 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_session_stats.h"
+
+namespace MTP {
+
+QString SessionStatsText(const SessionStats &stats) {
+	const auto average = stats.containersSent
+		? (double(stats.containerMessages) / stats.containersSent)
+		: 0.;
+	return QString("dc %1 [%2] state %3, queue %4, in flight %5, "
+		"sent %6 B, received %7 B in %8 packets, "
+		"containers %9 (avg %10 msgs), resends %11, "
+		"responses %12 (mean %13 ms, p99 %14 ms)"
+	).arg(stats.shiftedDcId
+	).arg(stats.transport.isEmpty() ? u"none"_q : stats.transport
+	).arg(stats.state
+	).arg(stats.sendQueue
+	).arg(stats.inFlight
+	).arg(stats.bytesSent
+	).arg(stats.bytesReceived
+	).arg(stats.packetsReceived
+	).arg(stats.containersSent
+	).arg(average, 0, 'f', 1
+	).arg(stats.resends
+	).arg(stats.responses
+	).arg(stats.responseTimeMean
+	).arg(stats.responseTimeP99);
+}
+
+namespace details {
+
+void SessionStatsCounter::sent(int64 bytes) {
+	QMutexLocker lock(&_mutex);
+	_bytesSent += bytes;
+}
+
+void SessionStatsCounter::received(int64 bytes) {
+	QMutexLocker lock(&_mutex);
+	_bytesReceived += bytes;
+	++_packetsReceived;
+}
+
+void SessionStatsCounter::containerSent(int messages) {
+	QMutexLocker lock(&_mutex);
+	++_containersSent;
+	_containerMessages += messages;
+}
+
+void SessionStatsCounter::resent(int count) {
+	QMutexLocker lock(&_mutex);
+	_resends += count;
+}
+
+void SessionStatsCounter::responseReceived(crl::time duration) {
+	QMutexLocker lock(&_mutex);
+	_responseTimes[_responses++ % kResponseTimesCount] = duration;
+	_smoothedResponseTime = _smoothedResponseTime
+		? ((_smoothedResponseTime * 7 + duration) / 8)
+		: duration;
+}
+
+crl::time SessionStatsCounter::smoothedResponseTime() const {
+	QMutexLocker lock(&_mutex);
+	return _smoothedResponseTime;
+}
+
+void SessionStatsCounter::fill(SessionStats &to) const {
+	QMutexLocker lock(&_mutex);
+	to.bytesSent = _bytesSent;
+	to.bytesReceived = _bytesReceived;
+	to.packetsReceived = _packetsReceived;
+	to.containersSent = _containersSent;
+	to.containerMessages = _containerMessages;
+	to.resends = _resends;
+	to.responses = _responses;
+
+	const auto count = int(std::min(_responses, int64(kResponseTimesCount)));
+	auto times = std::vector<crl::time>(
+		begin(_responseTimes),
+		begin(_responseTimes) + count);
+	lock.unlock();
+
+	if (times.empty()) {
+		return;
+	}
+	auto sum = crl::time(0);
+	for (const auto time : times) {
+		sum += time;
+	}
+	to.responseTimeMean = sum / count;
+
+	const auto p99 = begin(times) + (count * 99 / 100);
+	std::nth_element(begin(times), p99, end(times));
+	to.responseTimeP99 = *p99;
+}
+
+} // namespace details
+} // namespace MTP
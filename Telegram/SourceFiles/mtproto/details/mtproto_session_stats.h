@@ -0,0 +1,67 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <QtCore/QMutex>
+
+namespace MTP {
+
+struct SessionStats {
+	ShiftedDcId shiftedDcId = 0;
+	QString transport;
+	int32 state = 0;
+	int sendQueue = 0;
+	int inFlight = 0;
+	int64 bytesSent = 0;
+	int64 bytesReceived = 0;
+	int64 packetsReceived = 0;
+	int64 containersSent = 0;
+	int64 containerMessages = 0;
+	int64 resends = 0;
+	int64 responses = 0;
+	crl::time responseTimeMean = 0;
+	crl::time responseTimeP99 = 0;
+};
+
+[[nodiscard]] QString SessionStatsText(const SessionStats &stats);
+
+namespace details {
+
+// Written from the session thread, read from the main thread.
+class SessionStatsCounter final {
+public:
+	void sent(int64 bytes);
+	void received(int64 bytes);
+	void containerSent(int messages);
+	void resent(int count = 1);
+	void responseReceived(crl::time duration);
+
+	// Exponentially weighted, zero until the first response.
+	[[nodiscard]] crl::time smoothedResponseTime() const;
+
+	void fill(SessionStats &to) const;
+
+private:
+	// Mean and percentiles are computed over the last responses only.
+	static constexpr auto kResponseTimesCount = 512;
+
+	mutable QMutex _mutex;
+	int64 _bytesSent = 0;
+	int64 _bytesReceived = 0;
+	int64 _packetsReceived = 0;
+	int64 _containersSent = 0;
+	int64 _containerMessages = 0;
+	int64 _resends = 0;
+	int64 _responses = 0;
+	crl::time _smoothedResponseTime = 0;
+	std::array<crl::time, kResponseTimesCount> _responseTimes = { { 0 } };
+
+};
+
+} // namespace details
+} // namespace MTP
@@ -518,6 +518,7 @@ void TlsSocket::plainConnected() {
 void TlsSocket::plainDisconnected() {
 	_state = State::NotConnected;
 	_incoming = QByteArray();
+	_incomingStart = 0;
 	_serverHelloLength = 0;
 	_incomingGoodDataOffset = 0;
 	_incomingGoodDataLimit = 0;
@@ -632,6 +633,7 @@ void TlsSocket::readData() {
 	if (!isConnected()) {
 		return;
 	}
+	compactIncoming();
 	_incoming.append(_socket.readAll());
 	if (!checkNextPacket()) {
 		handleError();
@@ -642,7 +644,7 @@ void TlsSocket::readData() {
 
 bool TlsSocket::checkNextPacket() {
 	auto offset = 0;
-	const auto incoming = bytes::make_span(_incoming);
+	const auto incoming = incomingData();
 	while (!_incomingGoodDataLimit) {
 		const auto fullHeader = kServerHeader.size() + kLengthSize;
 		if (incoming.size() <= offset + fullHeader) {
@@ -672,15 +674,29 @@ void TlsSocket::shiftIncomingBy(int amount) {
 	Expects(_incomingGoodDataOffset == 0);
 	Expects(_incomingGoodDataLimit == 0);
 
-	const auto incoming = bytes::make_detached_span(_incoming);
-	if (incoming.size() > amount) {
-		bytes::move(incoming, incoming.subspan(amount));
-		_incoming.chop(amount);
+	// Consumed records are only skipped here, the buffer is compacted
+	// once per socket read in compactIncoming(), not once per record.
+	if (_incoming.size() - _incomingStart > amount) {
+		_incomingStart += amount;
 	} else {
 		_incoming.clear();
+		_incomingStart = 0;
 	}
 }
 
+void TlsSocket::compactIncoming() {
+	if (!_incomingStart) {
+		return;
+	}
+	const auto incoming = bytes::make_detached_span(_incoming);
+	bytes::move(incoming, incoming.subspan(_incomingStart));
+	_incoming.chop(base::take(_incomingStart));
+}
+
+bytes::const_span TlsSocket::incomingData() const {
+	return bytes::make_span(_incoming).subspan(_incomingStart);
+}
+
 void TlsSocket::connectToHost(const QString &address, int port) {
 	Expects(_state == State::NotConnected);
 
@@ -702,7 +718,7 @@ bool TlsSocket::isConnected() {
 
 bool TlsSocket::hasBytesAvailable() {
 	return (_incomingGoodDataLimit > 0)
-		&& (_incomingGoodDataOffset < _incoming.size());
+		&& (_incomingGoodDataOffset < incomingData().size());
 }
 
 int64 TlsSocket::read(bytes::span buffer) {
@@ -710,7 +726,7 @@ int64 TlsSocket::read(bytes::span buffer) {
 	while (_incomingGoodDataLimit) {
 		const auto available = std::min(
 			_incomingGoodDataLimit,
-			int(_incoming.size()) - _incomingGoodDataOffset);
+			int(incomingData().size()) - _incomingGoodDataOffset);
 		if (available <= 0) {
 			return written;
 		}
@@ -720,9 +736,7 @@ int64 TlsSocket::read(bytes::span buffer) {
 		}
 		bytes::copy(
 			buffer,
-			bytes::make_span(_incoming).subspan(
-				_incomingGoodDataOffset,
-				write));
+			incomingData().subspan(_incomingGoodDataOffset, write));
 		written += write;
 		buffer = buffer.subspan(write);
 		_incomingGoodDataLimit -= write;
@@ -746,27 +760,39 @@ void TlsSocket::write(bytes::const_span prefix, bytes::const_span buffer) {
 	if (!isConnected()) {
 		return;
 	}
+	// All records of the packet are framed in one reused buffer and
+	// passed to the socket at once instead of a write() call per field.
+	const auto headerSize = kClientHeader.size() + kLengthSize;
+	const auto records = (prefix.size() + buffer.size() + kClientPartSize - 1)
+		/ kClientPartSize;
+	_outgoing.clear();
+	_outgoing.reserve((prefix.empty() ? 0 : kClientPrefix.size())
+		+ records * headerSize
+		+ prefix.size()
+		+ buffer.size());
+	const auto append = [&](bytes::const_span data) {
+		_outgoing.insert(_outgoing.end(), data.begin(), data.end());
+	};
 	if (!prefix.empty()) {
-		_socket.write(kClientPrefix.data(), kClientPrefix.size());
+		append(bytes::make_span(kClientPrefix.data(), kClientPrefix.size()));
 	}
 	while (!buffer.empty()) {
 		const auto write = std::min(
 			kClientPartSize - prefix.size(),
 			buffer.size());
-		_socket.write(kClientHeader.data(), kClientHeader.size());
+		append(bytes::make_span(kClientHeader.data(), kClientHeader.size()));
 		const auto size = qToBigEndian(uint16(prefix.size() + write));
-		_socket.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		append(bytes::object_as_span(&size));
 		if (!prefix.empty()) {
-			_socket.write(
-				reinterpret_cast<const char*>(prefix.data()),
-				prefix.size());
+			append(prefix);
 			prefix = bytes::const_span();
 		}
-		_socket.write(
-			reinterpret_cast<const char*>(buffer.data()),
-			write);
+		append(buffer.subspan(0, write));
 		buffer = buffer.subspan(write);
 	}
+	_socket.write(
+		reinterpret_cast<const char*>(_outgoing.data()),
+		_outgoing.size());
 }
 
 int32 TlsSocket::debugState() {
@@ -53,11 +53,15 @@ private:
 	void readData();
 	[[nodiscard]] bool checkNextPacket();
 	void shiftIncomingBy(int amount);
+	void compactIncoming();
+	[[nodiscard]] bytes::const_span incomingData() const;
 
 	const bytes::vector _secret;
 	QTcpSocket _socket;
 	State _state = State::NotConnected;
 	QByteArray _incoming;
+	bytes::vector _outgoing;
+	int _incomingStart = 0;
 	int _incomingGoodDataOffset = 0;
 	int _incomingGoodDataLimit = 0;
 	int16 _serverHelloLength = 0;
@@ -0,0 +1,166 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_traffic_capture.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QDataStream>
+
+#include <atomic>
+
+namespace MTP::details {
+namespace {
+
+constexpr auto kMagic = 0x434D4454U; // "TDMC"
+constexpr auto kVersion = 1U;
+constexpr auto kFlushSize = 64 * 1024;
+constexpr auto kMaxFileSize = int64(32 * 1024 * 1024);
+constexpr auto kMaxPayloadSize = uint32(4096);
+
+enum class RecordType : quint8 {
+	Sent = 1,
+	Received = 2,
+};
+
+class Capture final {
+public:
+	Capture(const QString &path, CapturePayload payload);
+	~Capture();
+
+	[[nodiscard]] bool valid() const;
+	void write(RecordType type, const CaptureRecord &record);
+
+private:
+	bool open();
+	void flush();
+	void rotate();
+
+	const QString _path;
+	const CapturePayload _payload = CapturePayload::Redacted;
+	QFile _file;
+	QByteArray _buffer;
+	int64 _written = 0;
+
+};
+
+std::atomic<bool> Enabled = false;
+QMutex Mutex;
+std::unique_ptr<Capture> Instance;
+
+Capture::Capture(const QString &path, CapturePayload payload)
+: _path(path)
+, _payload(payload) {
+	open();
+}
+
+Capture::~Capture() {
+	flush();
+}
+
+bool Capture::valid() const {
+	return _file.isOpen();
+}
+
+bool Capture::open() {
+	_file.setFileName(_path);
+	if (!_file.open(QIODevice::WriteOnly)) {
+		LOG(("MTP Error: Could not open capture file '%1'.").arg(_path));
+		return false;
+	}
+	auto stream = QDataStream(&_buffer, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream << quint32(kMagic) << quint32(kVersion);
+	_written = 0;
+	return true;
+}
+
+void Capture::write(RecordType type, const CaptureRecord &record) {
+	const auto payloadSize = (_payload == CapturePayload::Full
+		&& record.payload)
+		? std::min(record.size, kMaxPayloadSize)
+		: uint32(0);
+	auto stream = QDataStream(&_buffer, QIODevice::Append);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream
+		<< quint8(type)
+		<< qint64(crl::now())
+		<< qint32(record.shiftedDcId)
+		<< quint64(record.sessionId)
+		<< quint64(record.msgId)
+		<< quint64(record.requestMsgId)
+		<< quint32(record.type)
+		<< quint32(record.size)
+		<< quint32(payloadSize);
+	if (payloadSize) {
+		stream.writeRawData(
+			reinterpret_cast<const char*>(record.payload),
+			payloadSize);
+	}
+	if (_buffer.size() >= kFlushSize) {
+		flush();
+	}
+}
+
+void Capture::flush() {
+	if (_buffer.isEmpty() || !_file.isOpen()) {
+		return;
+	}
+	_written += _file.write(_buffer);
+	_file.flush();
+	_buffer.clear();
+	if (_written >= kMaxFileSize) {
+		rotate();
+	}
+}
+
+void Capture::rotate() {
+	_file.close();
+	const auto previous = _path + ".1";
+	QFile::remove(previous);
+	QFile::rename(_path, previous);
+	open();
+}
+
+void Write(RecordType type, const CaptureRecord &record) {
+	QMutexLocker lock(&Mutex);
+	if (Instance) {
+		Instance->write(type, record);
+	}
+}
+
+} // namespace
+
+void StartTrafficCapture(const QString &path, CapturePayload payload) {
+	QMutexLocker lock(&Mutex);
+	Instance = nullptr;
+	Instance = std::make_unique<Capture>(path, payload);
+	if (!Instance->valid()) {
+		Instance = nullptr;
+	}
+	Enabled = (Instance != nullptr);
+}
+
+void StopTrafficCapture() {
+	QMutexLocker lock(&Mutex);
+	Enabled = false;
+	Instance = nullptr;
+}
+
+bool TrafficCaptureEnabled() {
+	return Enabled.load(std::memory_order_relaxed);
+}
+
+void CaptureSent(const CaptureRecord &record) {
+	Write(RecordType::Sent, record);
+}
+
+void CaptureReceived(const CaptureRecord &record) {
+	Write(RecordType::Received, record);
+}
+
+} // namespace MTP::details
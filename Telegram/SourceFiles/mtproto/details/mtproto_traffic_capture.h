@@ -0,0 +1,36 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace MTP::details {
+
+// Binary log of request and response headers for offline analysis,
+// read by Telegram/build/mtp_capture_stats.py.
+enum class CapturePayload {
+	Redacted,
+	Full,
+};
+
+struct CaptureRecord {
+	ShiftedDcId shiftedDcId = 0;
+	uint64 sessionId = 0;
+	mtpMsgId msgId = 0;
+	mtpMsgId requestMsgId = 0; // Set for responses only.
+	mtpTypeId type = 0;
+	uint32 size = 0;
+	const mtpPrime *payload = nullptr;
+};
+
+void StartTrafficCapture(const QString &path, CapturePayload payload);
+void StopTrafficCapture();
+[[nodiscard]] bool TrafficCaptureEnabled();
+
+void CaptureSent(const CaptureRecord &record);
+void CaptureReceived(const CaptureRecord &record);
+
+} // namespace MTP::details
@@ -40,7 +40,8 @@ constexpr ShiftedDcId groupCallStreamDcId(DcId dcId) {
 	return ShiftDcId(dcId, kGroupCallStreamDcShift);
 }
 
-constexpr auto kUploadSessionsCount = 2;
+constexpr auto kUploadSessionsCount = 8;
+constexpr auto kStartUploadSessionsCount = 2;
 
 namespace details {
 
@@ -28,6 +28,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/timer.h"
 #include "base/network_reachability.h"
 
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+
 namespace MTP {
 namespace {
 
@@ -106,6 +109,9 @@ public:
 	void ping();
 	void cancel(mtpRequestId requestId);
 	[[nodiscard]] int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
+	[[nodiscard]] std::vector<SessionStats> sessionsStats() const;
+	void setStatsDumpPath(const QString &path, crl::time period);
+	[[nodiscard]] QString statsDumpPath() const;
 	void killSession(ShiftedDcId shiftedDcId);
 	void stopSession(ShiftedDcId shiftedDcId);
 	void reInitConnection(DcId dcId);
@@ -214,6 +220,7 @@ private:
 		mtpRequestId requestId, DcId newdc);
 
 	void checkDelayedRequests();
+	void dumpStats();
 
 	const not_null<Instance*> _instance;
 	const Instance::Mode _mode = Instance::Mode::Normal;
@@ -282,6 +289,9 @@ private:
 
 	base::Timer _checkDelayedTimer;
 
+	QString _statsDumpPath;
+	base::Timer _statsDumpTimer;
+
 	Core::SettingsProxy &_proxySettings;
 
 	rpl::lifetime _lifetime;
@@ -363,6 +373,7 @@ void Instance::Private::start() {
 	}
 
 	_checkDelayedTimer.setCallback([this] { checkDelayedRequests(); });
+	_statsDumpTimer.setCallback([this] { dumpStats(); });
 
 	Assert(!hasMainDcId() == isKeysDestroyer());
 	requestConfig();
@@ -608,6 +619,45 @@ int32 Instance::Private::dcstate(ShiftedDcId shiftedDcId) {
 	return DisconnectedState;
 }
 
+std::vector<SessionStats> Instance::Private::sessionsStats() const {
+	return _sessions | ranges::views::transform([](const auto &pair) {
+		return pair.second->stats();
+	}) | ranges::to_vector;
+}
+
+void Instance::Private::setStatsDumpPath(
+		const QString &path,
+		crl::time period) {
+	_statsDumpPath = path;
+	if (_statsDumpPath.isEmpty()) {
+		_statsDumpTimer.cancel();
+	} else {
+		_statsDumpTimer.callEach(period);
+		dumpStats();
+	}
+}
+
+QString Instance::Private::statsDumpPath() const {
+	return _statsDumpPath;
+}
+
+void Instance::Private::dumpStats() {
+	auto file = QFile(_statsDumpPath);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		LOG(("MTP Error: could not open '%1' for stats dump."
+			).arg(_statsDumpPath));
+		setStatsDumpPath(QString(), 0);
+		return;
+	}
+	const auto time = QDateTime::currentDateTime().toString(
+		u"yyyy.MM.dd hh:mm:ss"_q);
+	auto text = QString();
+	for (const auto &stats : sessionsStats()) {
+		text += time + ' ' + SessionStatsText(stats) + '\n';
+	}
+	file.write(text.toUtf8());
+}
+
 QString Instance::Private::dctransport(ShiftedDcId shiftedDcId) {
 	if (!shiftedDcId) {
 		Assert(_mainSession != nullptr);
@@ -1868,6 +1918,18 @@ int32 Instance::dcstate(ShiftedDcId shiftedDcId) {
 	return _private->dcstate(shiftedDcId);
 }
 
+std::vector<SessionStats> Instance::sessionsStats() const {
+	return _private->sessionsStats();
+}
+
+void Instance::setStatsDumpPath(const QString &path, crl::time period) {
+	_private->setStatsDumpPath(path, period);
+}
+
+QString Instance::statsDumpPath() const {
+	return _private->statsDumpPath();
+}
+
 QString Instance::dctransport(ShiftedDcId shiftedDcId) {
 	return _private->dctransport(shiftedDcId);
 }
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "mtproto/details/mtproto_serialized_request.h"
+#include "mtproto/details/mtproto_session_stats.h"
 #include "mtproto/mtproto_response.h"
 
 namespace MTP {
@@ -97,6 +98,13 @@ public:
 	void cancel(mtpRequestId requestId);
 	int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
 
+	// Main thread.
+	[[nodiscard]] std::vector<SessionStats> sessionsStats() const;
+
+	// Appends sessionsStats() to the file each period, empty path stops.
+	void setStatsDumpPath(const QString &path, crl::time period);
+	[[nodiscard]] QString statsDumpPath() const;
+
 	// Main thread.
 	void killSession(ShiftedDcId shiftedDcId);
 	void stopSession(ShiftedDcId shiftedDcId);
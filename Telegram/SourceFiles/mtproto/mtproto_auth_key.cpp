@@ -11,7 +11,95 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QDataStream>
 
+#include <openssl/evp.h>
+
 namespace MTP {
+namespace {
+
+// The low level AES_* functions never use the hardware instructions,
+// while EVP picks AES-NI / ARMv8 Crypto / VAES code at runtime.
+class ThreadCipherContext final {
+public:
+	ThreadCipherContext() : _context(EVP_CIPHER_CTX_new()) {
+	}
+	~ThreadCipherContext() {
+		EVP_CIPHER_CTX_free(_context);
+	}
+
+	[[nodiscard]] EVP_CIPHER_CTX *get() const {
+		return _context;
+	}
+
+private:
+	EVP_CIPHER_CTX *_context = nullptr;
+
+};
+
+[[nodiscard]] EVP_CIPHER_CTX *CipherContext() {
+	static thread_local auto result = ThreadCipherContext();
+	return result.get();
+}
+
+void AddToCounter(uchar *counter, std::size_t blocks) {
+	for (auto i = AES_BLOCK_SIZE; i != 0 && blocks; --i) {
+		const auto sum = std::size_t(counter[i - 1]) + (blocks & 0xFF);
+		counter[i - 1] = uchar(sum & 0xFF);
+		blocks = (blocks >> 8) + (sum >> 8);
+	}
+}
+
+// IGE chains every block with the previous one in both directions,
+// so it runs block by block over a hardware ECB context.
+void IgeCrypt(
+		const uchar *src,
+		uchar *dst,
+		uint32 len,
+		const uchar *key,
+		const uchar *iv,
+		bool encrypt) {
+	Expects(!(len % AES_BLOCK_SIZE));
+
+	const auto context = CipherContext();
+	EVP_CipherInit_ex(
+		context,
+		EVP_aes_256_ecb(),
+		nullptr,
+		key,
+		nullptr,
+		encrypt ? 1 : 0);
+	EVP_CIPHER_CTX_set_padding(context, 0);
+
+	// iv is { previous ciphertext block, previous plaintext block }.
+	uchar previousInput[AES_BLOCK_SIZE];
+	uchar previousOutput[AES_BLOCK_SIZE];
+	memcpy(
+		encrypt ? previousOutput : previousInput,
+		iv,
+		AES_BLOCK_SIZE);
+	memcpy(
+		encrypt ? previousInput : previousOutput,
+		iv + AES_BLOCK_SIZE,
+		AES_BLOCK_SIZE);
+
+	uchar input[AES_BLOCK_SIZE];
+	uchar block[AES_BLOCK_SIZE];
+	auto length = 0;
+	for (auto offset = uint32(); offset != len; offset += AES_BLOCK_SIZE) {
+		memcpy(input, src + offset, AES_BLOCK_SIZE);
+		for (auto i = 0; i != AES_BLOCK_SIZE; ++i) {
+			block[i] = input[i] ^ previousOutput[i];
+		}
+		EVP_CipherUpdate(context, block, &length, block, AES_BLOCK_SIZE);
+		for (auto i = 0; i != AES_BLOCK_SIZE; ++i) {
+			block[i] ^= previousInput[i];
+		}
+		memcpy(dst + offset, block, AES_BLOCK_SIZE);
+		memcpy(previousInput, input, AES_BLOCK_SIZE);
+		memcpy(previousOutput, block, AES_BLOCK_SIZE);
+	}
+}
+
+} // namespace
 
 AuthKey::AuthKey(Type type, DcId dcId, const Data &data)
 : _type(type)
@@ -149,41 +237,80 @@ void AuthKey::countKeyId() {
 }
 
 void aesIgeEncryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
-	uchar aes_key[32], aes_iv[32];
-	memcpy(aes_key, key, 32);
-	memcpy(aes_iv, iv, 32);
-
-	AES_KEY aes;
-	AES_set_encrypt_key(aes_key, 256, &aes);
-	AES_ige_encrypt(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len, &aes, aes_iv, AES_ENCRYPT);
+	IgeCrypt(
+		static_cast<const uchar*>(src),
+		static_cast<uchar*>(dst),
+		len,
+		static_cast<const uchar*>(key),
+		static_cast<const uchar*>(iv),
+		true);
 }
 
 void aesIgeDecryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
-	uchar aes_key[32], aes_iv[32];
-	memcpy(aes_key, key, 32);
-	memcpy(aes_iv, iv, 32);
-
-	AES_KEY aes;
-	AES_set_decrypt_key(aes_key, 256, &aes);
-	AES_ige_encrypt(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len, &aes, aes_iv, AES_DECRYPT);
+	IgeCrypt(
+		static_cast<const uchar*>(src),
+		static_cast<uchar*>(dst),
+		len,
+		static_cast<const uchar*>(key),
+		static_cast<const uchar*>(iv),
+		false);
 }
 
 void aesCtrEncrypt(bytes::span data, const void *key, CTRState *state) {
-	AES_KEY aes;
-	AES_set_encrypt_key(static_cast<const uchar*>(key), 256, &aes);
+	aesCtrEncrypt(data, data, key, state);
+}
+
+void aesCtrEncrypt(
+		bytes::const_span from,
+		bytes::span to,
+		const void *key,
+		CTRState *state) {
+	Expects(to.size() >= from.size());
 
 	static_assert(CTRState::IvecSize == AES_BLOCK_SIZE, "Wrong size of ctr ivec!");
 	static_assert(CTRState::EcountSize == AES_BLOCK_SIZE, "Wrong size of ctr ecount!");
 
-	CRYPTO_ctr128_encrypt(
-		reinterpret_cast<const uchar*>(data.data()),
-		reinterpret_cast<uchar*>(data.data()),
-		data.size(),
-		&aes,
-		state->ivec,
-		state->ecount,
-		&state->num,
-		(block128_f)AES_encrypt);
+	auto input = reinterpret_cast<const uchar*>(from.data());
+	auto output = reinterpret_cast<uchar*>(to.data());
+	auto size = std::size_t(from.size());
+
+	// Finish the block started by the previous call, same as
+	// CRYPTO_ctr128_encrypt does with the saved ecount and num.
+	for (; state->num && size; --size) {
+		*output++ = *input++ ^ state->ecount[state->num];
+		state->num = (state->num + 1) % AES_BLOCK_SIZE;
+	}
+	if (!size) {
+		return;
+	}
+	const auto context = CipherContext();
+	EVP_EncryptInit_ex(
+		context,
+		EVP_aes_256_ctr(),
+		nullptr,
+		static_cast<const uchar*>(key),
+		state->ivec);
+
+	auto length = 0;
+	const auto full = size - (size % AES_BLOCK_SIZE);
+	if (full) {
+		EVP_EncryptUpdate(context, output, &length, input, int(full));
+		AddToCounter(state->ivec, full / AES_BLOCK_SIZE);
+	}
+	if (const auto tail = size - full) {
+		const uchar zero[AES_BLOCK_SIZE] = { 0 };
+		EVP_EncryptUpdate(
+			context,
+			state->ecount,
+			&length,
+			zero,
+			AES_BLOCK_SIZE);
+		AddToCounter(state->ivec, 1);
+		for (auto i = std::size_t(); i != tail; ++i) {
+			output[full + i] = input[full + i] ^ state->ecount[i];
+		}
+		state->num = uint32(tail);
+	}
 }
 
 } // namespace MTP
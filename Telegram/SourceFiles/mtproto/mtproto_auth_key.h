@@ -121,5 +121,10 @@ struct CTRState {
 	uchar ecount[EcountSize] = { 0 };
 };
 void aesCtrEncrypt(bytes::span data, const void *key, CTRState *state);
+void aesCtrEncrypt(
+	bytes::const_span from,
+	bytes::span to,
+	const void *key,
+	CTRState *state);
 
 } // namespace MTP
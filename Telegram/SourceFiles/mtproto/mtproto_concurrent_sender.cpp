@@ -35,7 +35,9 @@ DoneHandler ConcurrentSender::HandlerMaker::MakeDone(
 			if (const auto strong = weak.get()) {
 				strong->senderRequestDone(
 					response.requestId,
-					bytes::make_span(response.reply));
+					bytes::make_span(
+						response.reply.constData(),
+						response.reply.size()));
 			}
 		});
 		return true;
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/facade.h"
 #include "mtproto/connection_tcp.h"
 #include "storage/serialize_common.h"
+#include "base/unixtime.h"
 
 #include <QtCore/QFile>
 #include <QtCore/QRegularExpression>
@@ -18,7 +19,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace MTP {
 namespace {
 
-constexpr auto kVersion = 2;
+constexpr auto kVersion = 3;
+
+// An endpoint that failed this many times in a row gets the lowest
+// priority until it connects again.
+constexpr auto kEndpointFailuresLimit = 2;
+constexpr auto kMaxEndpointHealthCounter = 1024;
 
 using namespace details;
 
@@ -127,6 +133,8 @@ DcOptions::DcOptions(const DcOptions &other)
 , _publicKeys(other._publicKeys)
 , _cdnPublicKeys(other._cdnPublicKeys)
 , _immutable(other._immutable) {
+	QMutexLocker lock(&other._healthMutex);
+	_health = other._health;
 }
 
 DcOptions::~DcOptions() = default;
@@ -438,6 +446,22 @@ QByteArray DcOptions::serialize() const {
 		}
 	}
 
+	// Endpoint health.
+	QMutexLocker healthLock(&_healthMutex);
+	auto healthCount = 0;
+	size += sizeof(qint32);
+	for (const auto &[dcId, endpoints] : _health) {
+		if (isTemporaryDcId(dcId)) {
+			continue;
+		}
+		for (const auto &[endpoint, health] : endpoints) {
+			++healthCount;
+			size += sizeof(qint32)
+				+ Serialize::stringSize(endpoint)
+				+ 4 * sizeof(qint32);
+		}
+	}
+
 	auto result = QByteArray();
 	result.reserve(size);
 	{
@@ -471,6 +495,23 @@ QByteArray DcOptions::serialize() const {
 				<< Serialize::bytes(key.n)
 				<< Serialize::bytes(key.e);
 		}
+
+		// Endpoint health.
+		stream << qint32(healthCount);
+		for (const auto &[dcId, endpoints] : _health) {
+			if (isTemporaryDcId(dcId)) {
+				continue;
+			}
+			for (const auto &[endpoint, health] : endpoints) {
+				stream
+					<< qint32(dcId)
+					<< endpoint
+					<< qint32(health.successes)
+					<< qint32(health.failures)
+					<< qint32(health.connectTime)
+					<< qint32(health.lastSuccess);
+			}
+		}
 	}
 	return result;
 }
@@ -566,9 +607,103 @@ bool DcOptions::constructFromSerialized(const QByteArray &serialized) {
 			}
 		}
 	}
+
+	// Read endpoint health
+	if (!stream.atEnd() && version > 2) {
+		auto count = qint32(0);
+		stream >> count;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("MTP Error: Bad data for endpoint health in DcOptions::constructFromSerialized()"));
+			return false;
+		}
+
+		QMutexLocker healthLock(&_healthMutex);
+		_health.clear();
+		for (auto i = 0; i != count; ++i) {
+			auto dcId = qint32();
+			auto endpoint = QString();
+			auto successes = qint32();
+			auto failures = qint32();
+			auto connectTime = qint32();
+			auto lastSuccess = qint32();
+			stream
+				>> dcId
+				>> endpoint
+				>> successes
+				>> failures
+				>> connectTime
+				>> lastSuccess;
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("MTP Error: Bad data for endpoint health inside DcOptions::constructFromSerialized()"));
+				return false;
+			}
+			_health[dcId][endpoint] = EndpointHealth{
+				.successes = successes,
+				.failures = failures,
+				.connectTime = connectTime,
+				.lastSuccess = lastSuccess,
+			};
+		}
+	}
 	return true;
 }
 
+void DcOptions::endpointConnected(
+		DcId dcId,
+		const QString &endpoint,
+		crl::time connectTime) {
+	if (endpoint.isEmpty()) {
+		return;
+	}
+	QMutexLocker lock(&_healthMutex);
+	auto &health = _health[dcId][endpoint];
+	health.successes = std::min(
+		health.successes + 1,
+		kMaxEndpointHealthCounter);
+	health.failures = 0;
+	health.connectTime = health.connectTime
+		? int32((3 * health.connectTime + connectTime) / 4)
+		: int32(connectTime);
+	health.lastSuccess = base::unixtime::now();
+}
+
+void DcOptions::endpointFailed(DcId dcId, const QString &endpoint) {
+	if (endpoint.isEmpty()) {
+		return;
+	}
+	QMutexLocker lock(&_healthMutex);
+	auto &health = _health[dcId][endpoint];
+	health.failures = std::min(
+		health.failures + 1,
+		kMaxEndpointHealthCounter);
+}
+
+DcOptions::EndpointState DcOptions::endpointState(
+		DcId dcId,
+		const QString &endpoint) const {
+	QMutexLocker lock(&_healthMutex);
+	const auto i = _health.find(dcId);
+	if (i == end(_health)) {
+		return EndpointState::Unknown;
+	}
+	const auto j = i->second.find(endpoint);
+	if (j == end(i->second)) {
+		return EndpointState::Unknown;
+	} else if (j->second.failures >= kEndpointFailuresLimit) {
+		return EndpointState::Failing;
+	} else if (j->second.failures > 0 || !j->second.lastSuccess) {
+		return EndpointState::Unknown;
+	}
+
+	// The endpoint that connected last is preferred.
+	for (const auto &[key, health] : i->second) {
+		if (health.lastSuccess > j->second.lastSuccess) {
+			return EndpointState::Unknown;
+		}
+	}
+	return EndpointState::Preferred;
+}
+
 rpl::producer<DcId> DcOptions::changed() const {
 	return _changed.events();
 }
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/bytes.h"
 
 #include <QtCore/QReadWriteLock>
+#include <QtCore/QMutex>
 #include <string>
 #include <vector>
 #include <map>
@@ -106,6 +107,22 @@ public:
 		bool throughProxy) const;
 	[[nodiscard]] DcType dcType(ShiftedDcId shiftedDcId) const;
 
+	// Connection results of endpoints, keyed by "protocol:ip:port",
+	// so that sessions don't wait for endpoints that keep failing.
+	enum class EndpointState {
+		Unknown,
+		Preferred,
+		Failing,
+	};
+	void endpointConnected(
+		DcId dcId,
+		const QString &endpoint,
+		crl::time connectTime);
+	void endpointFailed(DcId dcId, const QString &endpoint);
+	[[nodiscard]] EndpointState endpointState(
+		DcId dcId,
+		const QString &endpoint) const;
+
 	void setCDNConfig(const MTPDcdnConfig &config);
 	[[nodiscard]] bool hasCDNKeysForDc(DcId dcId) const;
 	[[nodiscard]] details::RSAPublicKey getDcRSAKey(
@@ -117,6 +134,13 @@ public:
 	bool writeToFile(const QString &path) const;
 
 private:
+	struct EndpointHealth {
+		int32 successes = 0;
+		int32 failures = 0; // In a row.
+		int32 connectTime = 0; // Smoothed, in ms.
+		TimeId lastSuccess = 0;
+	};
+
 	bool applyOneGuarded(
 		DcId dcId,
 		Flags flags,
@@ -157,6 +181,9 @@ private:
 		base::flat_map<uint64, details::RSAPublicKey>> _cdnPublicKeys;
 	mutable QReadWriteLock _useThroughLockers;
 
+	base::flat_map<DcId, base::flat_map<QString, EndpointHealth>> _health;
+	mutable QMutex _healthMutex;
+
 	rpl::event_stream<DcId> _changed;
 	rpl::event_stream<> _cdnConfigChanged;
 
@@ -9,10 +9,25 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "base/openssl_help.h"
 
+#include <QtCore/QMutex>
+
 namespace MTP {
 namespace {
 
 constexpr auto kMaxModExpSize = 256;
+constexpr auto kMaxValidatedPrimes = 16;
+
+// Sessions of all accounts and media dcs get the same few primes,
+// so each (g, prime) pair is checked only once per launch.
+struct ValidatedPrimes {
+	QMutex mutex;
+	base::flat_set<std::pair<int, bytes::vector>> list;
+};
+
+[[nodiscard]] ValidatedPrimes &Validated() {
+	static auto result = ValidatedPrimes();
+	return result;
+}
 
 bool IsPrimeAndGoodCheck(const openssl::BigNum &prime, int g) {
 	constexpr auto kGoodPrimeBitsCount = 2048;
@@ -127,7 +142,22 @@ bool IsPrimeAndGood(bytes::const_span primeBytes, int g) {
 		}
 	}
 
-	return IsPrimeAndGoodCheck(openssl::BigNum(primeBytes), g);
+	auto key = std::make_pair(g, bytes::make_vector(primeBytes));
+	auto &validated = Validated();
+	{
+		QMutexLocker lock(&validated.mutex);
+		if (validated.list.contains(key)) {
+			return true;
+		}
+	}
+	if (!IsPrimeAndGoodCheck(openssl::BigNum(primeBytes), g)) {
+		return false;
+	}
+	QMutexLocker lock(&validated.mutex);
+	if (validated.list.size() < kMaxValidatedPrimes) {
+		validated.list.emplace(std::move(key));
+	}
+	return true;
 }
 
 ModExpFirst CreateModExp(
@@ -22,6 +22,7 @@ struct ModExpFirst {
 	bytes::vector randomPower;
 };
 
+// Thread-safe, may be called from background threads.
 [[nodiscard]] bool IsPrimeAndGood(bytes::const_span primeBytes, int g);
 [[nodiscard]] bool IsGoodModExpFirst(
 	const openssl::BigNum &modexp,
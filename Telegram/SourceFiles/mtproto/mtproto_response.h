@@ -54,8 +54,79 @@ inline bool IsDefaultHandledError(const Error &error) {
 	return IsTemporaryError(error);
 }
 
+// Ref-counted read-only view of a received reply.
+//
+// Either owns a separate mtpBuffer or shares the decrypted packet storage
+// it was received in, so that large rpc_result-s (like file parts) don't
+// have to be copied out of the packet before being parsed.
+class ResponseBuffer final {
+public:
+	ResponseBuffer() = default;
+	ResponseBuffer(mtpBuffer buffer) // Not explicit.
+	: _buffer(std::move(buffer))
+	, _size(_buffer.size()) {
+	}
+	ResponseBuffer(
+		QByteArray storage,
+		const mtpPrime *from,
+		const mtpPrime *till)
+	: _storage(std::move(storage))
+	, _offset(from - reinterpret_cast<const mtpPrime*>(_storage.constData()))
+	, _size(till - from) {
+		Expects(_offset >= 0);
+		Expects(_size >= 0);
+		Expects((_offset + _size) * sizeof(mtpPrime) <= _storage.size());
+	}
+
+	[[nodiscard]] const mtpPrime *constData() const {
+		return (_storage.isNull()
+			? _buffer.constData()
+			: reinterpret_cast<const mtpPrime*>(_storage.constData()))
+			+ _offset;
+	}
+	[[nodiscard]] const mtpPrime *data() const {
+		return constData();
+	}
+	[[nodiscard]] const mtpPrime *begin() const {
+		return constData();
+	}
+	[[nodiscard]] const mtpPrime *end() const {
+		return constData() + _size;
+	}
+	[[nodiscard]] int size() const {
+		return _size;
+	}
+	[[nodiscard]] bool isEmpty() const {
+		return !_size;
+	}
+	[[nodiscard]] bool empty() const {
+		return !_size;
+	}
+	[[nodiscard]] mtpPrime operator[](int index) const {
+		Expects(index >= 0 && index < _size);
+
+		return constData()[index];
+	}
+
+	[[nodiscard]] mtpBuffer toBuffer() const {
+		if (_storage.isNull()) {
+			return _buffer;
+		}
+		auto result = mtpBuffer(_size);
+		memcpy(result.data(), constData(), _size * sizeof(mtpPrime));
+		return result;
+	}
+
+private:
+	mtpBuffer _buffer;
+	QByteArray _storage;
+	int _offset = 0;
+	int _size = 0;
+
+};
+
 struct Response {
-	mtpBuffer reply;
+	ResponseBuffer reply;
 	mtpMsgId outerMsgId = 0;
 	mtpRequestId requestId = 0;
 };
@@ -45,6 +45,15 @@ class Sender {
 				auto onstack = std::move(handler);
 				sender->senderRequestHandled(response.requestId);
 
+				if constexpr (IsCallable<Handler>) {
+					// The result is not used, don't materialize it.
+					if (response.reply.isEmpty()) {
+						return false;
+					} else if (onstack) {
+						onstack();
+					}
+					return true;
+				}
 				auto result = Result();
 				auto from = response.reply.constData();
 				if (!result.read(from, from + response.reply.size())) {
@@ -16,6 +16,48 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace MTP {
 namespace details {
+namespace {
+
+// Small background requests wait a little for others to share a container.
+constexpr auto kCoalesceMaxInts = 256;
+constexpr auto kCoalesceDefaultWait = crl::time(4);
+constexpr auto kCoalesceMinWait = crl::time(2);
+constexpr auto kCoalesceMaxWait = crl::time(16);
+constexpr auto kCoalesceResponseTimeShare = 16;
+
+[[nodiscard]] bool IsCoalescableRequest(const SerializedRequest &request) {
+	constexpr auto kBody = SerializedRequest::kMessageBodyPosition;
+	if (request->size() <= kBody || request->size() > kCoalesceMaxInts) {
+		return false;
+	}
+	switch (mtpTypeId((*request)[kBody])) {
+	case mtpc_messages_getMessagesViews:
+	case mtpc_messages_readHistory:
+	case mtpc_channels_readHistory:
+	case mtpc_messages_readMessageContents:
+	case mtpc_channels_readMessageContents:
+	case mtpc_messages_readMentions:
+	case mtpc_messages_setTyping:
+	case mtpc_messages_getMessageReadParticipants:
+	case mtpc_messages_getOnlines:
+	case mtpc_messages_getPollResults:
+	case mtpc_account_updateStatus:
+		return true;
+	}
+	return false;
+}
+
+// A small share of the round trip is not noticeable, so wait that long.
+[[nodiscard]] crl::time CoalesceWait(crl::time responseTime) {
+	return responseTime
+		? std::clamp(
+			responseTime / kCoalesceResponseTimeShare,
+			kCoalesceMinWait,
+			kCoalesceMaxWait)
+		: kCoalesceDefaultWait;
+}
+
+} // namespace
 
 SessionOptions::SessionOptions(
 	const QString &systemLangCode,
@@ -417,6 +459,24 @@ QString Session::transport() const {
 	return _private ? _private->transport() : QString();
 }
 
+SessionStats Session::stats() const {
+	auto result = SessionStats{
+		.shiftedDcId = _shiftedDcId,
+		.transport = transport(),
+		.state = getState(),
+	};
+	{
+		QReadLocker locker(_data->toSendMutex());
+		result.sendQueue = int(_data->toSendMap().size());
+	}
+	{
+		QReadLocker locker(_data->haveSentMutex());
+		result.inFlight = int(_data->haveSentMap().size());
+	}
+	_data->stats().fill(result);
+	return result;
+}
+
 void Session::sendPrepared(
 		const SerializedRequest &request,
 		crl::time msCanWait) {
@@ -431,12 +491,22 @@ void Session::sendPrepared(
 
 	DEBUG_LOG(("MTP Info: added, requestId %1").arg(request->requestId));
 	if (msCanWait >= 0) {
+		const auto wait = msCanWait ? msCanWait : coalesceWait(request);
 		InvokeQueued(this, [=] {
-			sendAnything(msCanWait);
+			sendAnything(wait);
 		});
 	}
 }
 
+crl::time Session::coalesceWait(const SerializedRequest &request) const {
+	if (isDownloadDcId(_shiftedDcId)
+		|| isUploadDcId(_shiftedDcId)
+		|| !IsCoalescableRequest(request)) {
+		return 0;
+	}
+	return CoalesceWait(_data->stats().smoothedResponseTime());
+}
+
 CreatingKeyType Session::acquireKeyCreation(DcType type) {
 	Expects(_myKeyCreation == CreatingKeyType::None);
 
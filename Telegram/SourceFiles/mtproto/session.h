@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtproto_response.h"
 #include "mtproto/mtproto_proxy_data.h"
 #include "mtproto/details/mtproto_serialized_request.h"
+#include "mtproto/details/mtproto_session_stats.h"
 
 #include <QtCore/QTimer>
 
@@ -87,6 +88,9 @@ public:
 	std::vector<Response> &haveReceivedMessages() {
 		return _receivedMessages;
 	}
+	[[nodiscard]] SessionStatsCounter &stats() {
+		return _stats;
+	}
 
 	// SessionPrivate -> Session interface.
 	void queueTryToReceive();
@@ -128,6 +132,8 @@ private:
 	std::vector<Response> _receivedMessages; // list of responses / updates that should be processed in the main thread
 	QReadWriteLock _haveReceivedLock;
 
+	SessionStatsCounter _stats;
+
 };
 
 class Session final : public QObject {
@@ -175,6 +181,7 @@ public:
 	int requestState(mtpRequestId requestId) const;
 	int getState() const;
 	QString transport() const;
+	[[nodiscard]] SessionStats stats() const;
 
 	void tryToReceive();
 	void needToResumeAndSend();
@@ -186,6 +193,9 @@ private:
 	void watchDcKeyChanges();
 	void watchDcOptionsChanges();
 
+	[[nodiscard]] crl::time coalesceWait(
+		const SerializedRequest &request) const;
+
 	void killConnection();
 
 	[[nodiscard]] bool releaseGenericKeyCreationOnDone(
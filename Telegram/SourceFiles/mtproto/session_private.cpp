@@ -8,9 +8,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/session_private.h"
 
 #include "mtproto/details/mtproto_bound_key_creator.h"
+#include "mtproto/details/mtproto_buffer_pool.h"
 #include "mtproto/details/mtproto_dcenter.h"
 #include "mtproto/details/mtproto_dump_to_text.h"
 #include "mtproto/details/mtproto_rsa_public_key.h"
+#include "mtproto/details/mtproto_traffic_capture.h"
 #include "mtproto/session.h"
 #include "mtproto/mtproto_response.h"
 #include "mtproto/mtproto_dc_options.h"
@@ -23,6 +25,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/platform/base_platform_info.h"
 #include "zlib.h"
 
+#include <crl/crl_async.h>
+
 namespace MTP {
 namespace details {
 namespace {
@@ -44,6 +48,12 @@ constexpr auto kKeyOldEnoughForDestroy = 60 * crl::time(1000);
 constexpr auto kSentContainerLives = 600 * crl::time(1000);
 constexpr auto kFastRequestDuration = crl::time(500);
 
+// The endpoint that won the last connection race of a DC is preferred
+// by all sessions to that DC, so it doesn't wait for a better one.
+// Endpoints that keep failing are never waited for.
+constexpr auto kPreferredEndpointPriority = 100;
+constexpr auto kFailingEndpointPriority = -1;
+
 // If we can't connect for this time we will ask _instance to update config.
 constexpr auto kRequestConfigTimeout = 8 * crl::time(1000);
 
@@ -60,6 +70,9 @@ constexpr auto kSendStateRequestWaiting = crl::time(1000);
 // How much time to wait for some more requests, when sending msg acks.
 constexpr auto kAckSendWaiting = 10 * crl::time(1000);
 
+// Smaller packets are decrypted right in the session thread.
+constexpr auto kAsyncDecryptSize = 16 * 1024;
+
 auto SyncTimeRequestDuration = kFastRequestDuration;
 
 using namespace details;
@@ -138,8 +151,92 @@ void WrapInvokeAfter(
 	return different;
 }
 
+constexpr auto kExternalHeaderIntsCount = 6U; // 2 auth_key_id, 4 msg_key
+constexpr auto kEncryptedHeaderIntsCount = 8U; // 2 salt, 2 session, 2 msg_id, 1 seq_no, 1 length
+constexpr auto kMinimalEncryptedIntsCount = kEncryptedHeaderIntsCount + 4U; // + 1 data + 3 padding
+constexpr auto kMinimalIntsCount = kExternalHeaderIntsCount + kMinimalEncryptedIntsCount;
+
+// Checks everything that doesn't depend on the session state,
+// so that it can be done outside of the session thread.
+[[nodiscard]] QByteArray DecryptReceived(
+		const mtpBuffer &intsBuffer,
+		const AuthKeyPtr &encryptionKey,
+		uint64 keyId) {
+	auto intsCount = uint32(intsBuffer.size());
+	auto ints = intsBuffer.constData();
+	if ((intsCount < kMinimalIntsCount) || (intsCount > kMaxMessageLength / kIntSize)) {
+		LOG(("TCP Error: bad message received, len %1").arg(intsCount * kIntSize));
+		TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(ints, intsCount * kIntSize).str()));
+
+		return QByteArray();
+	}
+	if (keyId != *(uint64*)ints) {
+		LOG(("TCP Error: bad auth_key_id %1 instead of %2 received").arg(keyId).arg(*(uint64*)ints));
+		TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(ints, intsCount * kIntSize).str()));
+
+		return QByteArray();
+	}
+
+	constexpr auto kMinPaddingSize = 12U;
+	constexpr auto kMaxPaddingSize = 1024U;
+
+	auto encryptedInts = ints + kExternalHeaderIntsCount;
+	auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
+	auto encryptedBytesCount = encryptedIntsCount * kIntSize;
+	auto decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
+	auto msgKey = *(MTPint128*)(ints + 2);
+
+	aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, encryptionKey, msgKey);
+
+	auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
+	auto messageLength = *(uint32*)&decryptedInts[7];
+	auto fullDataLength = kEncryptedHeaderIntsCount * kIntSize + messageLength; // Without padding.
+
+	// Can underflow, but it is an unsigned type, so we just check the range later.
+	auto paddingSize = static_cast<uint32>(encryptedBytesCount) - static_cast<uint32>(fullDataLength);
+
+	std::array<uchar, 32> sha256Buffer = { { 0 } };
+
+	SHA256_CTX msgKeyLargeContext;
+	SHA256_Init(&msgKeyLargeContext);
+	SHA256_Update(&msgKeyLargeContext, encryptionKey->partForMsgKey(false), 32);
+	SHA256_Update(&msgKeyLargeContext, decryptedInts, encryptedBytesCount);
+	SHA256_Final(sha256Buffer.data(), &msgKeyLargeContext);
+
+	constexpr auto kMsgKeyShift = 8U;
+	if (ConstTimeIsDifferent(&msgKey, sha256Buffer.data() + kMsgKeyShift, sizeof(msgKey))) {
+		LOG(("TCP Error: bad SHA256 hash after aesDecrypt in message"));
+		TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+
+		return QByteArray();
+	}
+
+	if ((messageLength > kMaxMessageLength)
+		|| (messageLength & 0x03)
+		|| (paddingSize < kMinPaddingSize)
+		|| (paddingSize > kMaxPaddingSize)) {
+		LOG(("TCP Error: bad msg_len received %1, data size: %2").arg(messageLength).arg(encryptedBytesCount));
+		TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+
+		return QByteArray();
+	}
+	return decryptedBuffer;
+}
+
 } // namespace
 
+struct SessionPrivate::ReceivedPacket {
+	mtpBuffer encrypted;
+	QByteArray decrypted; // Empty if the packet is bad.
+	std::atomic<bool> ready = false;
+};
+
+// Lets the pool threads post results while the session is alive.
+struct SessionPrivate::ReceiveGuard {
+	QMutex mutex;
+	SessionPrivate *session = nullptr;
+};
+
 SessionPrivate::SessionPrivate(
 	not_null<Instance*> instance,
 	not_null<QThread*> thread,
@@ -161,9 +258,12 @@ SessionPrivate::SessionPrivate(
 , _pingSender(thread, [=] { sendPingByTimer(); })
 , _checkSentRequestsTimer(thread, [=] { checkSentRequests(); })
 , _clearOldContainersTimer(thread, [=] { clearOldContainers(); })
-, _sessionData(std::move(data)) {
+, _sessionData(std::move(data))
+, _receiveGuard(std::make_shared<ReceiveGuard>()) {
 	Expects(_shiftedDcId != 0);
 
+	_receiveGuard->session = this;
+
 	moveToThread(thread);
 
 	InvokeQueued(this, [=] {
@@ -173,6 +273,10 @@ SessionPrivate::SessionPrivate(
 }
 
 SessionPrivate::~SessionPrivate() {
+	{
+		QMutexLocker lock(&_receiveGuard->mutex);
+		_receiveGuard->session = nullptr;
+	}
 	releaseKeyCreationOnFail();
 	doDisconnect();
 
@@ -187,9 +291,24 @@ void SessionPrivate::appendTestConnection(
 		const bytes::vector &protocolSecret) {
 	QWriteLocker lock(&_stateMutex);
 
-	const auto priority = (qthelp::is_ipv6(ip) ? 0 : 1)
-		+ (protocol == DcOptions::Variants::Tcp ? 1 : 0)
-		+ (protocolSecret.empty() ? 0 : 1);
+	// Connections through a proxy don't tell anything about endpoints.
+	const auto endpoint = ip.isEmpty()
+		? QString()
+		: QString("%1:%2:%3"
+		).arg(int(protocol)
+		).arg(ip
+		).arg(port);
+	const auto state = _instance->dcOptions().endpointState(
+		BareDcId(_shiftedDcId),
+		endpoint);
+	using EndpointState = DcOptions::EndpointState;
+	const auto priority = (state == EndpointState::Preferred)
+		? kPreferredEndpointPriority
+		: (state == EndpointState::Failing)
+		? kFailingEndpointPriority
+		: ((qthelp::is_ipv6(ip) ? 0 : 1)
+			+ (protocol == DcOptions::Variants::Tcp ? 1 : 0)
+			+ (protocolSecret.empty() ? 0 : 1));
 	_testConnections.push_back({
 		AbstractConnection::Create(
 			_instance,
@@ -197,7 +316,8 @@ void SessionPrivate::appendTestConnection(
 			thread(),
 			protocolSecret,
 			_options->proxy),
-		priority
+		priority,
+		endpoint,
 	});
 	const auto weak = _testConnections.back().data.get();
 	connect(weak, &AbstractConnection::error, [=](int errorCode) {
@@ -328,6 +448,7 @@ void SessionPrivate::destroyAllConnections() {
 	_waitForReceivedTimer.cancel();
 	_waitForConnectedTimer.cancel();
 	_testConnections.clear();
+	_receivedPackets.clear();
 	_connection = nullptr;
 }
 
@@ -455,18 +576,37 @@ mtpMsgId SessionPrivate::prepareToSend(
 			_resendingIds.erase(i);
 		}
 
-		return (forceNewMsgId || msgId > currentLastId)
+		const auto result = (forceNewMsgId || msgId > currentLastId)
 			? replaceMsgId(request, currentLastId)
 			: msgId;
+		captureSent(request, result);
+		return result;
 	}
 	request.setMsgId(currentLastId);
 	request.setSeqNo(nextRequestSeqNumber(request.needAck()));
 	if (request->requestId) {
 		MTP_LOG(_shiftedDcId, ("[r%1] msg_id 0 -> %2").arg(request->requestId).arg(currentLastId));
 	}
+	captureSent(request, currentLastId);
 	return currentLastId;
 }
 
+void SessionPrivate::captureSent(
+		const SerializedRequest &request,
+		mtpMsgId msgId) const {
+	if (!request->requestId || !TrafficCaptureEnabled()) {
+		return;
+	}
+	CaptureSent({
+		.shiftedDcId = _shiftedDcId,
+		.sessionId = _sessionId,
+		.msgId = msgId,
+		.type = mtpTypeId(request->constData()[8]),
+		.size = uint32(tl::count_length(request)),
+		.payload = request->constData() + 8,
+	});
+}
+
 mtpMsgId SessionPrivate::replaceMsgId(SerializedRequest &request, mtpMsgId newId) {
 	Expects(request->size() > 8);
 
@@ -701,16 +841,14 @@ void SessionPrivate::tryToSend() {
 	bool needAnyResponse = false;
 	SerializedRequest toSendRequest;
 	{
-		QWriteLocker locker1(_sessionData->toSendMutex());
-
 		auto scheduleCheckSentRequests = false;
 
-		auto toSendDummy = base::flat_map<mtpRequestId, SerializedRequest>();
-		auto &toSend = sendAll
-			? _sessionData->toSendMap()
-			: toSendDummy;
-		if (!sendAll) {
-			locker1.unlock();
+		// Take the queue out right away, so that new requests from other
+		// threads don't wait while we pack the container.
+		auto toSend = base::flat_map<mtpRequestId, SerializedRequest>();
+		if (sendAll) {
+			QWriteLocker locker(_sessionData->toSendMutex());
+			toSend = base::take(_sessionData->toSendMap());
 		}
 
 		uint32 toSendCount = toSend.size();
@@ -740,10 +878,7 @@ void SessionPrivate::tryToSend() {
 			: toSend.begin()->second;
 		if (toSendCount == 1 && !first->forceSendInContainer) {
 			toSendRequest = first;
-			if (sendAll) {
-				toSend.clear();
-				locker1.unlock();
-			}
+			toSend.clear();
 
 			const auto msgId = prepareToSend(
 				toSendRequest,
@@ -830,6 +965,7 @@ void SessionPrivate::tryToSend() {
 				containerSize + 3 * toSend.size());
 			toSendRequest->push_back(mtpc_msg_container);
 			toSendRequest->push_back(toSendCount);
+			_sessionData->stats().containerSent(toSendCount);
 
 			// check for a valid container
 			auto bigMsgId = base::unixtime::mtproto_msg_id();
@@ -1097,6 +1233,7 @@ void SessionPrivate::restart() {
 }
 
 void SessionPrivate::onSentSome(uint64 size) {
+	_sessionData->stats().sent(int64(size));
 	if (!_waitForReceivedTimer.isActive()) {
 		auto remain = static_cast<uint64>(_waitForReceived);
 		if (!_oldConnection) {
@@ -1111,7 +1248,7 @@ void SessionPrivate::onSentSome(uint64 size) {
 			}
 		}
 		if (isUploadDcId(_shiftedDcId)) {
-			remain *= kUploadSessionsCount;
+			remain *= kStartUploadSessionsCount;
 		}
 		_waitForReceivedTimer.callOnce(remain);
 	}
@@ -1219,6 +1356,11 @@ void SessionPrivate::waitBetterFailed() {
 
 void SessionPrivate::connectingTimedOut() {
 	for (const auto &connection : _testConnections) {
+		if (!connection.data->isConnected()) {
+			_instance->dcOptions().endpointFailed(
+				BareDcId(_shiftedDcId),
+				connection.endpoint);
+		}
 		connection.data->timedOut();
 	}
 	doDisconnect();
@@ -1241,175 +1383,170 @@ void SessionPrivate::handleReceived() {
 	onReceivedSome();
 
 	while (!_connection->received().empty()) {
-		auto intsBuffer = std::move(_connection->received().front());
+		const auto packet = std::make_shared<ReceivedPacket>();
+		packet->encrypted = std::move(_connection->received().front());
 		_connection->received().pop_front();
+		_receivedPackets.push_back(packet);
 
-		constexpr auto kExternalHeaderIntsCount = 6U; // 2 auth_key_id, 4 msg_key
-		constexpr auto kEncryptedHeaderIntsCount = 8U; // 2 salt, 2 session, 2 msg_id, 1 seq_no, 1 length
-		constexpr auto kMinimalEncryptedIntsCount = kEncryptedHeaderIntsCount + 4U; // + 1 data + 3 padding
-		constexpr auto kMinimalIntsCount = kExternalHeaderIntsCount + kMinimalEncryptedIntsCount;
-		auto intsCount = uint32(intsBuffer.size());
-		auto ints = intsBuffer.constData();
-		if ((intsCount < kMinimalIntsCount) || (intsCount > kMaxMessageLength / kIntSize)) {
-			LOG(("TCP Error: bad message received, len %1").arg(intsCount * kIntSize));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(ints, intsCount * kIntSize).str()));
-
-			return restart();
+		const auto size = packet->encrypted.size() * kIntSize;
+		_sessionData->stats().received(size);
+		if (size < kAsyncDecryptSize) {
+			packet->decrypted = DecryptReceived(
+				packet->encrypted,
+				_encryptionKey,
+				_keyId);
+			packet->ready = true;
+			continue;
 		}
-		if (_keyId != *(uint64*)ints) {
-			LOG(("TCP Error: bad auth_key_id %1 instead of %2 received").arg(_keyId).arg(*(uint64*)ints));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(ints, intsCount * kIntSize).str()));
+		crl::async([
+			=,
+			guard = _receiveGuard,
+			key = _encryptionKey,
+			keyId = _keyId
+		] {
+			packet->decrypted = DecryptReceived(packet->encrypted, key, keyId);
+			packet->ready = true;
+
+			QMutexLocker lock(&guard->mutex);
+			if (const auto session = guard->session) {
+				InvokeQueued(session, [=] { session->handleDecrypted(); });
+			}
+		});
+	}
+	handleDecrypted();
+}
 
-			return restart();
+void SessionPrivate::handleDecrypted() {
+	auto handled = false;
+	while (!_receivedPackets.empty() && _receivedPackets.front()->ready) {
+		const auto packet = std::move(_receivedPackets.front());
+		_receivedPackets.pop_front();
+		handled = true;
+		ReleaseBuffer(std::move(packet->encrypted));
+		if (!handleOneDecrypted(base::take(packet->decrypted))) {
+			return;
 		}
+	}
+	if (handled && _connection && _connection->needHttpWait()) {
+		_sessionData->queueSendAnything();
+	}
+}
 
-		constexpr auto kMinPaddingSize = 12U;
-		constexpr auto kMaxPaddingSize = 1024U;
-
-		auto encryptedInts = ints + kExternalHeaderIntsCount;
-		auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
-		auto encryptedBytesCount = encryptedIntsCount * kIntSize;
-		auto decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
-		auto msgKey = *(MTPint128*)(ints + 2);
-
-		aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, _encryptionKey, msgKey);
-
-		auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
-		auto serverSalt = *(uint64*)&decryptedInts[0];
-		auto session = *(uint64*)&decryptedInts[2];
-		auto msgId = *(uint64*)&decryptedInts[4];
-		auto seqNo = *(uint32*)&decryptedInts[6];
-		auto needAck = ((seqNo & 0x01) != 0);
-		auto messageLength = *(uint32*)&decryptedInts[7];
-		auto fullDataLength = kEncryptedHeaderIntsCount * kIntSize + messageLength; // Without padding.
-
-		// Can underflow, but it is an unsigned type, so we just check the range later.
-		auto paddingSize = static_cast<uint32>(encryptedBytesCount) - static_cast<uint32>(fullDataLength);
-
-		std::array<uchar, 32> sha256Buffer = { { 0 } };
-
-		SHA256_CTX msgKeyLargeContext;
-		SHA256_Init(&msgKeyLargeContext);
-		SHA256_Update(&msgKeyLargeContext, _encryptionKey->partForMsgKey(false), 32);
-		SHA256_Update(&msgKeyLargeContext, decryptedInts, encryptedBytesCount);
-		SHA256_Final(sha256Buffer.data(), &msgKeyLargeContext);
+bool SessionPrivate::handleOneDecrypted(QByteArray decryptedBuffer) {
+	Expects(_encryptionKey != nullptr);
 
-		constexpr auto kMsgKeyShift = 8U;
-		if (ConstTimeIsDifferent(&msgKey, sha256Buffer.data() + kMsgKeyShift, sizeof(msgKey))) {
-			LOG(("TCP Error: bad SHA256 hash after aesDecrypt in message"));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+	if (decryptedBuffer.isEmpty()) {
+		restart();
+		return false;
+	}
+	auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
+	auto serverSalt = *(uint64*)&decryptedInts[0];
+	auto session = *(uint64*)&decryptedInts[2];
+	auto msgId = *(uint64*)&decryptedInts[4];
+	auto seqNo = *(uint32*)&decryptedInts[6];
+	auto needAck = ((seqNo & 0x01) != 0);
+	auto messageLength = *(uint32*)&decryptedInts[7];
+	auto fullDataLength = kEncryptedHeaderIntsCount * kIntSize + messageLength; // Without padding.
 
-			return restart();
-		}
+	TCP_LOG(("TCP Info: decrypted message %1,%2,%3 is %4 len").arg(msgId).arg(seqNo).arg(Logs::b(needAck)).arg(fullDataLength));
 
-		if ((messageLength > kMaxMessageLength)
-			|| (messageLength & 0x03)
-			|| (paddingSize < kMinPaddingSize)
-			|| (paddingSize > kMaxPaddingSize)) {
-			LOG(("TCP Error: bad msg_len received %1, data size: %2").arg(messageLength).arg(encryptedBytesCount));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+	if (session != _sessionId) {
+		LOG(("MTP Error: bad server session received"));
+		TCP_LOG(("MTP Error: bad server session %1 instead of %2 in message received").arg(session).arg(_sessionId));
 
-			return restart();
-		}
+		restart();
+		return false;
+	}
 
-		TCP_LOG(("TCP Info: decrypted message %1,%2,%3 is %4 len").arg(msgId).arg(seqNo).arg(Logs::b(needAck)).arg(fullDataLength));
+	const auto serverTime = int32(msgId >> 32);
+	const auto isReply = ((msgId & 0x03) == 1);
+	if (!isReply && ((msgId & 0x03) != 3)) {
+		LOG(("MTP Error: bad msg_id %1 in message received").arg(msgId));
 
-		if (session != _sessionId) {
-			LOG(("MTP Error: bad server session received"));
-			TCP_LOG(("MTP Error: bad server session %1 instead of %2 in message received").arg(session).arg(_sessionId));
+		restart();
+		return false;
+	}
 
-			return restart();
-		}
+	const auto clientTime = base::unixtime::now();
+	const auto badTime = (serverTime > clientTime + 60)
+		|| (serverTime + 300 < clientTime);
+	if (badTime) {
+		DEBUG_LOG(("MTP Info: bad server time from msg_id: %1, my time: %2").arg(serverTime).arg(clientTime));
+	}
 
-		const auto serverTime = int32(msgId >> 32);
-		const auto isReply = ((msgId & 0x03) == 1);
-		if (!isReply && ((msgId & 0x03) != 3)) {
-			LOG(("MTP Error: bad msg_id %1 in message received").arg(msgId));
+	bool wasConnected = (getState() == ConnectedState);
+	if (serverSalt != _sessionSalt) {
+		if (!badTime) {
+			DEBUG_LOG(("MTP Info: other salt received... received: %1, my salt: %2, updating...").arg(serverSalt).arg(_sessionSalt));
+			_sessionSalt = serverSalt;
 
-			return restart();
+			if (setState(ConnectedState, ConnectingState)) {
+				resendAll();
+			}
+		} else {
+			DEBUG_LOG(("MTP Info: other salt received... received: %1, my salt: %2").arg(serverSalt).arg(_sessionSalt));
 		}
+	} else {
+		serverSalt = 0; // dont pass to handle method, so not to lock in setSalt()
+	}
 
-		const auto clientTime = base::unixtime::now();
-		const auto badTime = (serverTime > clientTime + 60)
-			|| (serverTime + 300 < clientTime);
-		if (badTime) {
-			DEBUG_LOG(("MTP Info: bad server time from msg_id: %1, my time: %2").arg(serverTime).arg(clientTime));
-		}
+	if (needAck) _ackRequestData.push_back(MTP_long(msgId));
 
-		bool wasConnected = (getState() == ConnectedState);
-		if (serverSalt != _sessionSalt) {
-			if (!badTime) {
-				DEBUG_LOG(("MTP Info: other salt received... received: %1, my salt: %2, updating...").arg(serverSalt).arg(_sessionSalt));
-				_sessionSalt = serverSalt;
+	auto res = HandleResult::Success; // if no need to handle, then succeed
+	auto from = decryptedInts + kEncryptedHeaderIntsCount;
+	auto end = from + (messageLength / kIntSize);
+	auto sfrom = decryptedInts + 4U; // msg_id + seq_no + length + message
+	MTP_LOG(_shiftedDcId, ("Recv: ")
+		+ DumpToText(sfrom, end)
+		+ QString(" (protocolDcId:%1,key:%2)"
+		).arg(getProtocolDcId()
+		).arg(_encryptionKey->keyId()));
 
-				if (setState(ConnectedState, ConnectingState)) {
-					resendAll();
-				}
-			} else {
-				DEBUG_LOG(("MTP Info: other salt received... received: %1, my salt: %2").arg(serverSalt).arg(_sessionSalt));
-			}
-		} else {
-			serverSalt = 0; // dont pass to handle method, so not to lock in setSalt()
-		}
-
-		if (needAck) _ackRequestData.push_back(MTP_long(msgId));
-
-		auto res = HandleResult::Success; // if no need to handle, then succeed
-		auto from = decryptedInts + kEncryptedHeaderIntsCount;
-		auto end = from + (messageLength / kIntSize);
-		auto sfrom = decryptedInts + 4U; // msg_id + seq_no + length + message
-		MTP_LOG(_shiftedDcId, ("Recv: ")
-			+ DumpToText(sfrom, end)
-			+ QString(" (protocolDcId:%1,key:%2)"
-			).arg(getProtocolDcId()
-			).arg(_encryptionKey->keyId()));
-
-		if (_receivedMessageIds.registerMsgId(msgId, needAck)) {
-			res = handleOneReceived(from, end, msgId, {
-				.outerMsgId = msgId,
-				.serverSalt = serverSalt,
-				.serverTime = serverTime,
-				.badTime = badTime,
-			});
-		}
-		_receivedMessageIds.shrink();
+	if (_receivedMessageIds.registerMsgId(msgId, needAck)) {
+		res = handleOneReceived(from, end, msgId, {
+			.outerMsgId = msgId,
+			.serverSalt = serverSalt,
+			.serverTime = serverTime,
+			.badTime = badTime,
+			.storage = decryptedBuffer,
+		});
+	}
+	_receivedMessageIds.shrink();
 
-		// send acks
-		if (const auto toAckSize = _ackRequestData.size()) {
-			DEBUG_LOG(("MTP Info: will send %1 acks, ids: %2").arg(toAckSize).arg(LogIdsVector(_ackRequestData)));
-			_sessionData->queueSendAnything(kAckSendWaiting);
-		}
+	// send acks
+	if (const auto toAckSize = _ackRequestData.size()) {
+		DEBUG_LOG(("MTP Info: will send %1 acks, ids: %2").arg(toAckSize).arg(LogIdsVector(_ackRequestData)));
+		_sessionData->queueSendAnything(kAckSendWaiting);
+	}
 
-		auto lock = QReadLocker(_sessionData->haveReceivedMutex());
-		const auto tryToReceive = !_sessionData->haveReceivedMessages().empty();
-		lock.unlock();
+	auto lock = QReadLocker(_sessionData->haveReceivedMutex());
+	const auto tryToReceive = !_sessionData->haveReceivedMessages().empty();
+	lock.unlock();
 
-		if (tryToReceive) {
-			DEBUG_LOG(("MTP Info: queueTryToReceive() - need to parse in another thread, %1 messages.").arg(_sessionData->haveReceivedMessages().size()));
-			_sessionData->queueTryToReceive();
-		}
+	if (tryToReceive) {
+		DEBUG_LOG(("MTP Info: queueTryToReceive() - need to parse in another thread, %1 messages.").arg(_sessionData->haveReceivedMessages().size()));
+		_sessionData->queueTryToReceive();
+	}
 
-		if (res != HandleResult::Success && res != HandleResult::Ignored) {
-			if (res == HandleResult::DestroyTemporaryKey) {
-				destroyTemporaryKey();
-			} else if (res == HandleResult::ResetSession) {
-				_needSessionReset = true;
-			}
-			return restart();
+	if (res != HandleResult::Success && res != HandleResult::Ignored) {
+		if (res == HandleResult::DestroyTemporaryKey) {
+			destroyTemporaryKey();
+		} else if (res == HandleResult::ResetSession) {
+			_needSessionReset = true;
 		}
-		_retryTimeout = 1; // reset restart() timer
+		restart();
+		return false;
+	}
+	_retryTimeout = 1; // reset restart() timer
 
-		_startedConnectingAt = crl::time(0);
+	_startedConnectingAt = crl::time(0);
 
-		if (!wasConnected) {
-			if (getState() == ConnectedState) {
-				_sessionData->queueNeedToResumeAndSend();
-			}
+	if (!wasConnected) {
+		if (getState() == ConnectedState) {
+			_sessionData->queueNeedToResumeAndSend();
 		}
 	}
-	if (_connection->needHttpWait()) {
-		_sessionData->queueSendAnything();
-	}
+	return true;
 }
 
 SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
@@ -1427,6 +1564,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		if (response.empty()) {
 			return HandleResult::RestartConnection;
 		}
+		info.storage = QByteArray();
 		return handleOneReceived(response.data(), response.data() + response.size(), msgId, info);
 	}
 
@@ -1765,7 +1903,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		if (from + 3 > end) {
 			return HandleResult::ParseError;
 		}
-		auto response = mtpBuffer();
+		auto response = ResponseBuffer();
 
 		MTPlong reqMsgId;
 		if (!reqMsgId.read(++from, end)) {
@@ -1784,6 +1922,15 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 				return HandleResult::Ignored;
 			}
 		}
+		{
+			QReadLocker locker(_sessionData->haveSentMutex());
+			const auto &haveSent = _sessionData->haveSentMap();
+			const auto i = haveSent.find(requestMsgId);
+			if (i != haveSent.end() && i->second->lastSentTime) {
+				_sessionData->stats().responseReceived(
+					crl::now() - i->second->lastSentTime);
+			}
+		}
 
 		mtpTypeId typeId = from[0];
 		if (typeId == mtpc_gzip_packed) {
@@ -1793,12 +1940,27 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 				return HandleResult::RestartConnection;
 			}
 			typeId = response[0];
+		} else if (!info.storage.isNull()) {
+			// Share the decrypted packet instead of copying the reply.
+			response = ResponseBuffer(info.storage, from, end);
 		} else {
-			response.resize(end - from);
-			memcpy(response.data(), from, (end - from) * sizeof(mtpPrime));
+			auto copy = mtpBuffer(end - from);
+			memcpy(copy.data(), from, (end - from) * sizeof(mtpPrime));
+			response = std::move(copy);
+		}
+		if (TrafficCaptureEnabled()) {
+			CaptureReceived({
+				.shiftedDcId = _shiftedDcId,
+				.sessionId = _sessionId,
+				.msgId = msgId,
+				.requestMsgId = requestMsgId,
+				.type = typeId,
+				.size = uint32(response.size() * sizeof(mtpPrime)),
+				.payload = response.data(),
+			});
 		}
 		if (typeId == mtpc_rpc_error) {
-			if (IsDestroyedTemporaryKeyError(response)) {
+			if (IsDestroyedTemporaryKeyError(response.toBuffer())) {
 				return HandleResult::DestroyTemporaryKey;
 			}
 			// An error could be some RPC_CALL_FAIL or other error inside
@@ -1934,13 +2096,13 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 
 SessionPrivate::HandleResult SessionPrivate::handleBindResponse(
 		mtpMsgId requestMsgId,
-		const mtpBuffer &response) {
+		const ResponseBuffer &response) {
 	if (!_keyCreator || !_bindMsgId || _bindMsgId != requestMsgId) {
 		return HandleResult::Ignored;
 	}
 	_bindMsgId = 0;
 
-	const auto result = _keyCreator->handleBindResponse(response);
+	const auto result = _keyCreator->handleBindResponse(response.toBuffer());
 	switch (result) {
 	case DcKeyBindState::Success:
 		if (!_sessionData->releaseKeyCreationOnDone(
@@ -2219,6 +2381,7 @@ void SessionPrivate::resend(mtpMsgId msgId, crl::time msCanWait) {
 	auto request = i->second;
 	haveSent.erase(i);
 	lock.unlock();
+	_sessionData->stats().resent();
 
 	request->lastSentTime = crl::now();
 	request->forceSendInContainer = true;
@@ -2233,6 +2396,7 @@ void SessionPrivate::resendAll() {
 	auto lock = QWriteLocker(_sessionData->haveSentMutex());
 	auto haveSent = base::take(_sessionData->haveSentMap());
 	lock.unlock();
+	_sessionData->stats().resent(int(haveSent.size()));
 	{
 		auto lock = QWriteLocker(_sessionData->toSendMutex());
 		auto &toSend = _sessionData->toSendMap();
@@ -2278,6 +2442,7 @@ void SessionPrivate::onConnected(
 	} else {
 		DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
 		_waitForBetterTimer.cancel();
+		rememberConnected(*i);
 		_connection = std::move(i->data);
 		_testConnections.clear();
 		checkAuthKey();
@@ -2314,12 +2479,20 @@ void SessionPrivate::confirmBestConnection() {
 	DEBUG_LOG(("MTP Info: can't connect through better, using %1."
 		).arg(i->data->tag()));
 
+	rememberConnected(*i);
 	_connection = std::move(i->data);
 	_testConnections.clear();
 
 	checkAuthKey();
 }
 
+void SessionPrivate::rememberConnected(const TestConnection &connection) {
+	_instance->dcOptions().endpointConnected(
+		BareDcId(_shiftedDcId),
+		connection.endpoint,
+		connection.data->pingTime());
+}
+
 void SessionPrivate::removeTestConnection(
 		not_null<AbstractConnection*> connection) {
 	_testConnections.erase(
@@ -2552,6 +2725,15 @@ void SessionPrivate::onError(
 			instance->badConfigurationError();
 		});
 	}
+	const auto i = ranges::find(
+		_testConnections,
+		connection.get(),
+		[](const TestConnection &test) { return test.data.get(); });
+	if (i != end(_testConnections) && !connection->isConnected()) {
+		_instance->dcOptions().endpointFailed(
+			BareDcId(_shiftedDcId),
+			i->endpoint);
+	}
 	removeTestConnection(connection);
 
 	if (_testConnections.empty()) {
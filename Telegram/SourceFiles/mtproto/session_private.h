@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_serialized_request.h"
 #include "mtproto/mtproto_auth_key.h"
 #include "mtproto/mtproto_dc_options.h"
+#include "mtproto/mtproto_response.h"
 #include "mtproto/connection_abstract.h"
 #include "mtproto/facade.h"
 #include "base/timer.h"
@@ -56,11 +57,14 @@ private:
 	struct TestConnection {
 		ConnectionPointer data;
 		int priority = 0;
+		QString endpoint;
 	};
 	struct SentContainer {
 		crl::time sent = 0;
 		std::vector<mtpMsgId> messages;
 	};
+	struct ReceivedPacket;
+	struct ReceiveGuard;
 	enum class HandleResult {
 		Success,
 		Ignored,
@@ -85,6 +89,8 @@ private:
 	void onReceivedSome();
 
 	void handleReceived();
+	void handleDecrypted();
+	[[nodiscard]] bool handleOneDecrypted(QByteArray decryptedBuffer);
 
 	void retryByTimer();
 	void waitConnectedFailed();
@@ -96,6 +102,7 @@ private:
 
 	void confirmBestConnection();
 	void removeTestConnection(not_null<AbstractConnection*> connection);
+	void rememberConnected(const TestConnection &connection);
 	[[nodiscard]] int16 getProtocolDcId() const;
 
 	void checkSentRequests();
@@ -110,6 +117,7 @@ private:
 		SerializedRequest &request,
 		mtpMsgId currentLastId,
 		bool forceNewMsgId);
+	void captureSent(const SerializedRequest &request, mtpMsgId msgId) const;
 	mtpMsgId replaceMsgId(
 		SerializedRequest &request,
 		mtpMsgId newId);
@@ -124,6 +132,9 @@ private:
 		uint64 serverSalt = 0;
 		int32 serverTime = 0;
 		bool badTime = false;
+
+		// Decrypted packet storage, if 'from' / 'end' point inside it.
+		QByteArray storage;
 	};
 	[[nodiscard]] HandleResult handleOneReceived(
 		const mtpPrime *from,
@@ -132,7 +143,7 @@ private:
 		OuterInfo info);
 	[[nodiscard]] HandleResult handleBindResponse(
 		mtpMsgId requestMsgId,
-		const mtpBuffer &response);
+		const ResponseBuffer &response);
 	mtpBuffer ungzip(const mtpPrime *from, const mtpPrime *end) const;
 	void handleMsgsStates(const QVector<MTPlong> &ids, const QByteArray &states);
 
@@ -225,6 +236,10 @@ private:
 	uint32 _messagesCounter = 0;
 	bool _sessionMarkedAsStarted = false;
 
+	// Packets are decrypted in the thread pool, but handled here in order.
+	std::deque<std::shared_ptr<ReceivedPacket>> _receivedPackets;
+	const std::shared_ptr<ReceiveGuard> _receiveGuard;
+
 	QVector<MTPlong> _ackRequestData;
 	QVector<MTPlong> _resendRequestData;
 	base::flat_set<mtpMsgId> _stateRequestData;
@@ -1820,16 +1820,34 @@ void FormController::loadFile(File &file) {
 
 void FormController::fileLoadDone(FileKey key, const QByteArray &bytes) {
 	if (const auto [value, file] = findFile(key); file != nullptr) {
-		const auto decrypted = DecryptData(
-			bytes::make_span(bytes),
-			file->hash,
-			file->secret);
-		if (decrypted.empty()) {
-			fileLoadFail(key);
-			return;
-		}
+		// Scans are large, so they're decrypted and decoded in parallel
+		// and each one is shown as soon as it is ready.
+		crl::async([
+			=,
+			weak = base::make_weak(this),
+			hash = file->hash,
+			secret = file->secret
+		] {
+			const auto decrypted = DecryptData(
+				bytes::make_span(bytes),
+				hash,
+				secret);
+			auto image = decrypted.empty()
+				? QImage()
+				: ReadImage(gsl::make_span(decrypted));
+			crl::on_main(weak, [=, image = std::move(image)]() mutable {
+				fileDecrypted(key, std::move(image));
+			});
+		});
+	}
+}
+
+void FormController::fileDecrypted(FileKey key, QImage &&image) {
+	if (image.isNull()) {
+		fileLoadFail(key);
+	} else if (const auto [value, file] = findFile(key); file != nullptr) {
 		file->downloadStatus.set(LoadStatus::Status::Done);
-		file->image = ReadImage(gsl::make_span(decrypted));
+		file->image = std::move(image);
 		if (const auto fileInEdit = findEditFile(key)) {
 			fileInEdit->fields.image = file->image;
 			fileInEdit->fields.downloadStatus = file->downloadStatus;
@@ -36,6 +36,10 @@ constexpr auto kObjectPath = "/org/freedesktop/Notifications"_cs;
 constexpr auto kInterface = kService;
 constexpr auto kPropertiesInterface = "org.freedesktop.DBus.Properties"_cs;
 
+// A hung notification daemon must not keep our calls pending forever.
+constexpr auto kCallTimeout = 5000;
+constexpr auto kMaxNotifyCallsInFlight = 16;
+
 using namespace base::Platform;
 
 struct ServerInformation {
@@ -47,6 +51,9 @@ struct ServerInformation {
 
 bool ServiceRegistered = false;
 bool InhibitionSupported = false;
+bool CurrentInhibited = false;
+bool InhibitedRequested = false;
+int NotifyCallsInFlight = 0;
 std::optional<ServerInformation> CurrentServerInformation;
 QStringList CurrentCapabilities;
 
@@ -206,7 +213,8 @@ void GetServerInformation(
 
 				crl::on_main([=] { callback(std::nullopt); });
 			},
-			std::string(kService));
+			std::string(kService),
+			kCallTimeout);
 
 			return;
 	} catch (const Glib::Error &e) {
@@ -253,7 +261,8 @@ void GetCapabilities(Fn<void(const QStringList &)> callback) {
 
 				crl::on_main([=] { callback({}); });
 			},
-			std::string(kService));
+			std::string(kService),
+			kCallTimeout);
 
 			return;
 	} catch (const Glib::Error &e) {
@@ -301,7 +310,8 @@ void GetInhibitionSupported(Fn<void(bool)> callback) {
 
 				crl::on_main([=] { callback(false); });
 			},
-			std::string(kService));
+			std::string(kService),
+			kCallTimeout);
 
 			return;
 	} catch (const Glib::Error &e) {
@@ -312,6 +322,58 @@ void GetInhibitionSupported(Fn<void(bool)> callback) {
 	crl::on_main([=] { callback(false); });
 }
 
+void RequestInhibited() {
+	if (InhibitedRequested) {
+		return;
+	}
+	InhibitedRequested = true;
+
+	// a hack for snap's activation restriction
+	StartServiceAsync([] {
+		try {
+			const auto connection = Gio::DBus::Connection::get_sync(
+				Gio::DBus::BusType::BUS_TYPE_SESSION);
+
+			connection->call(
+				std::string(kObjectPath),
+				std::string(kPropertiesInterface),
+				"Get",
+				MakeGlibVariant(std::tuple{
+					Glib::ustring(std::string(kInterface)),
+					Glib::ustring("Inhibited"),
+				}),
+				[=](const Glib::RefPtr<Gio::AsyncResult> &result) {
+					auto inhibited = std::optional<bool>();
+					try {
+						auto reply = connection->call_finish(result);
+						inhibited = GlibVariantCast<bool>(
+							GlibVariantCast<Glib::VariantBase>(
+								reply.get_child(0)));
+					} catch (const Glib::Error &e) {
+						LOG(("Native Notification Error: %1").arg(
+							QString::fromStdString(e.what())));
+					} catch (const std::exception &e) {
+						LOG(("Native Notification Error: %1").arg(
+							QString::fromStdString(e.what())));
+					}
+					crl::on_main([=] {
+						InhibitedRequested = false;
+						if (inhibited) {
+							CurrentInhibited = *inhibited;
+						}
+					});
+				},
+				std::string(kService),
+				kCallTimeout);
+			return;
+		} catch (const Glib::Error &e) {
+			LOG(("Native Notification Error: %1").arg(
+				QString::fromStdString(e.what())));
+		}
+		InhibitedRequested = false;
+	});
+}
+
 bool Inhibited() {
 	if (!Supported()
 		|| !CurrentCapabilities.contains(qsl("inhibitions"))
@@ -319,36 +381,9 @@ bool Inhibited() {
 		return false;
 	}
 
-	try {
-		const auto connection = Gio::DBus::Connection::get_sync(
-			Gio::DBus::BusType::BUS_TYPE_SESSION);
-
-		// a hack for snap's activation restriction
-		DBus::StartServiceByName(
-			connection,
-			std::string(kService));
-
-		auto reply = connection->call_sync(
-			std::string(kObjectPath),
-			std::string(kPropertiesInterface),
-			"Get",
-			MakeGlibVariant(std::tuple{
-				Glib::ustring(std::string(kInterface)),
-				Glib::ustring("Inhibited"),
-			}),
-			std::string(kService));
-
-		return GlibVariantCast<bool>(
-			GlibVariantCast<Glib::VariantBase>(reply.get_child(0)));
-	} catch (const Glib::Error &e) {
-		LOG(("Native Notification Error: %1").arg(
-			QString::fromStdString(e.what())));
-	} catch (const std::exception &e) {
-		LOG(("Native Notification Error: %1").arg(
-			QString::fromStdString(e.what())));
-	}
-
-	return false;
+	// The last known value is used, the daemon is asked in background.
+	RequestInhibited();
+	return CurrentInhibited;
 }
 
 bool IsQualifiedDaemon() {
@@ -420,6 +455,8 @@ public:
 	void setImage(const QString &imagePath);
 
 private:
+	void notify();
+
 	const not_null<Manager*> _manager;
 	NotificationId _id;
 
@@ -429,6 +466,7 @@ private:
 	std::vector<Glib::ustring> _actions;
 	std::map<Glib::ustring, Glib::VariantBase> _hints;
 	Glib::ustring _imageKey;
+	QString _imagePath;
 
 	uint _notificationId = 0;
 	uint _actionInvokedSignalId = 0;
@@ -609,9 +647,49 @@ NotificationData::~NotificationData() {
 }
 
 void NotificationData::show() {
+	if (_imagePath.isEmpty()) {
+		notify();
+		return;
+	}
+
+	// Decode the userpic hint off the main thread.
+	const auto weak = base::make_weak(this);
+	crl::async([=, path = base::take(_imagePath)] {
+		auto image = QImage(path).convertToFormat(QImage::Format_RGBA8888);
+		crl::on_main(weak, [=, image = std::move(image)] {
+			if (!image.isNull()) {
+				_hints[_imageKey] = MakeGlibVariant(std::tuple{
+					image.width(),
+					image.height(),
+					int(image.bytesPerLine()),
+					true,
+					8,
+					4,
+					std::vector<uchar>(
+						image.constBits(),
+						image.constBits() + image.sizeInBytes()),
+				});
+			}
+			notify();
+		});
+	});
+}
+
+void NotificationData::notify() {
+	if (NotifyCallsInFlight >= kMaxNotifyCallsInFlight) {
+		LOG(("Native Notification Error: too many pending calls."));
+		_manager->clearNotification(_id);
+		return;
+	}
+	++NotifyCallsInFlight;
+
 	// a hack for snap's activation restriction
 	const auto weak = base::make_weak(this);
-	StartServiceAsync(crl::guard(weak, [=] {
+	StartServiceAsync([=] {
+		if (!weak) {
+			--NotifyCallsInFlight;
+			return;
+		}
 		const auto iconName = _imageKey.empty()
 			|| _hints.find(_imageKey) == end(_hints)
 				? Glib::ustring(GetIconName().toStdString())
@@ -633,6 +711,9 @@ void NotificationData::show() {
 				-1,
 			}),
 			[=](const Glib::RefPtr<Gio::AsyncResult> &result) {
+				crl::on_main([] {
+					--NotifyCallsInFlight;
+				});
 				try {
 					auto reply = connection->call_finish(result);
 					const auto notificationId = GlibVariantCast<uint>(
@@ -652,8 +733,9 @@ void NotificationData::show() {
 					_manager->clearNotification(_id);
 				});
 			},
-			std::string(kService));
-	}));
+			std::string(kService),
+			kCallTimeout);
+	});
 }
 
 void NotificationData::close() {
@@ -665,7 +747,8 @@ void NotificationData::close() {
 			_notificationId,
 		}),
 		{},
-		std::string(kService));
+		std::string(kService),
+		kCallTimeout);
 	_manager->clearNotification(_id);
 }
 
@@ -673,25 +756,7 @@ void NotificationData::setImage(const QString &imagePath) {
 	if (imagePath.isEmpty() || _imageKey.empty()) {
 		return;
 	}
-
-	const auto image = QImage(imagePath)
-		.convertToFormat(QImage::Format_RGBA8888);
-
-	if (image.isNull()) {
-		return;
-	}
-
-	_hints[_imageKey] = MakeGlibVariant(std::tuple{
-		image.width(),
-		image.height(),
-		int(image.bytesPerLine()),
-		true,
-		8,
-		4,
-		std::vector<uchar>(
-			image.constBits(),
-			image.constBits() + image.sizeInBytes()),
-	});
+	_imagePath = imagePath;
 }
 
 void NotificationData::notificationClosed(uint id, uint reason) {
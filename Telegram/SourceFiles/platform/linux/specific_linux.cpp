@@ -552,6 +552,60 @@ std::optional<bool> IsDarkMode() {
 	return result;
 }
 
+int64 PhysicalMemorySize() {
+	const auto pages = sysconf(_SC_PHYS_PAGES);
+	const auto pageSize = sysconf(_SC_PAGESIZE);
+	return (pages > 0 && pageSize > 0) ? (int64(pages) * pageSize) : 0;
+}
+
+QString AllocatorStats() {
+	// Statistics are cached by jemalloc until the epoch is advanced.
+	auto epoch = uint64(1);
+	mallctl("epoch", nullptr, nullptr, &epoch, sizeof(epoch));
+
+	auto result = QStringList();
+	for (const auto name : {
+		"stats.allocated",
+		"stats.active",
+		"stats.resident",
+		"stats.mapped",
+		"stats.retained",
+	}) {
+		auto value = size_t(0);
+		auto size = sizeof(value);
+		if (!mallctl(name, &value, &size, nullptr, 0)) {
+			result.push_back(u"%1: %2 MB"_q
+				.arg(QString::fromLatin1(name))
+				.arg(value / (1024 * 1024)));
+		}
+	}
+	return result.join('\n');
+}
+
+void UseMediaAllocatorArena() {
+	static const auto arena = [] {
+		auto result = unsigned(0);
+		auto size = sizeof(result);
+		if (mallctl("arenas.create", &result, &size, nullptr, 0)) {
+			LOG(("Allocator Error: Could not create media arena."));
+			return std::optional<unsigned>();
+		}
+		return std::make_optional(result);
+	}();
+	if (arena) {
+		auto value = *arena;
+		mallctl("thread.arena", nullptr, nullptr, &value, sizeof(value));
+	}
+}
+
+void PurgeAllocatorCaches() {
+#ifdef MALLCTL_ARENAS_ALL
+	const auto name = "arena." + QByteArray::number(MALLCTL_ARENAS_ALL)
+		+ ".purge";
+	mallctl(name.constData(), nullptr, nullptr, nullptr, 0);
+#endif // MALLCTL_ARENAS_ALL
+}
+
 bool AutostartSupported() {
 	// snap sandbox doesn't allow creating files
 	// in folders with names started with a dot
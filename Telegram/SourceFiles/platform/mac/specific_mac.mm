@@ -27,6 +27,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <cstdlib>
 #include <execinfo.h>
 #include <sys/xattr.h>
+#include <sys/sysctl.h>
 
 #include <Cocoa/Cocoa.h>
 #include <CoreFoundation/CFURL.h>
@@ -104,6 +105,25 @@ std::optional<bool> IsDarkMode() {
 		: std::nullopt;
 }
 
+int64 PhysicalMemorySize() {
+	auto result = uint64(0);
+	auto size = sizeof(result);
+	if (sysctlbyname("hw.memsize", &result, &size, nullptr, 0) != 0) {
+		return 0;
+	}
+	return int64(result);
+}
+
+QString AllocatorStats() {
+	return QString();
+}
+
+void UseMediaAllocatorArena() {
+}
+
+void PurgeAllocatorCaches() {
+}
+
 void WriteCrashDumpDetails() {
 #ifndef DESKTOP_APP_DISABLE_CRASH_REPORTS
 	double v = objc_appkitVersion();
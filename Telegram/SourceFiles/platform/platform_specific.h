@@ -44,6 +44,19 @@ void WriteCrashDumpDetails();
 	return IsDarkMode().has_value();
 }
 
+// Total physical memory in bytes, zero if it could not be detected.
+[[nodiscard]] int64 PhysicalMemorySize();
+
+// Human readable allocator statistics, empty if not available.
+[[nodiscard]] QString AllocatorStats();
+
+// Makes the calling thread allocate from an arena shared by media workers,
+// so that decoded frames and packets don't fragment the main arenas.
+void UseMediaAllocatorArena();
+
+// Returns unused allocator memory to the system, called when idle.
+void PurgeAllocatorCaches();
+
 namespace ThirdParty {
 
 void start();
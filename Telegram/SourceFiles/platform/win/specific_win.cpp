@@ -327,6 +327,25 @@ std::optional<bool> IsDarkMode() {
 	return (value == 0);
 }
 
+int64 PhysicalMemorySize() {
+	auto status = MEMORYSTATUSEX();
+	status.dwLength = sizeof(status);
+	if (!GlobalMemoryStatusEx(&status)) {
+		return 0;
+	}
+	return int64(status.ullTotalPhys);
+}
+
+QString AllocatorStats() {
+	return QString();
+}
+
+void UseMediaAllocatorArena() {
+}
+
+void PurgeAllocatorCaches() {
+}
+
 bool AutostartSupported() {
 	return !IsWindowsStoreBuild();
 }
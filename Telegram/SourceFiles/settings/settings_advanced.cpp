@@ -46,6 +46,62 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #endif // !TDESKTOP_DISABLE_SPELLCHECK
 
 namespace Settings {
+namespace {
+
+void SetupSpeedLimit(
+		not_null<Window::Controller*> controller,
+		not_null<Ui::VerticalLayout*> container,
+		rpl::producer<QString> title,
+		Fn<int64()> current,
+		Fn<void(int64)> save) {
+	constexpr auto kKilobyte = int64(1024);
+	const auto limits = std::vector<int64>{
+		0,
+		128 * kKilobyte,
+		512 * kKilobyte,
+		1024 * kKilobyte,
+		4096 * kKilobyte,
+	};
+	const auto options = ranges::views::all(
+		limits
+	) | ranges::views::transform([](int64 limit) {
+		return limit
+			? tr::lng_settings_speed_limit_value(
+				tr::now,
+				lt_speed,
+				Ui::FormatSizeText(limit))
+			: tr::lng_settings_speed_limit_none(tr::now);
+	}) | ranges::to_vector;
+	const auto indexOf = [=](int64 limit) {
+		const auto i = ranges::find(limits, limit);
+		return (i != end(limits)) ? int(i - begin(limits)) : 0;
+	};
+	const auto chosen = std::make_shared<rpl::variable<int>>(
+		indexOf(current()));
+	const auto button = AddButtonWithLabel(
+		container,
+		rpl::duplicate(title),
+		chosen->value() | rpl::map([=](int index) {
+			return options[index];
+		}),
+		st::settingsButton);
+	button->addClickHandler([=] {
+		controller->show(Box([=](not_null<Ui::GenericBox*> box) {
+			SingleChoiceBox(box, {
+				.title = rpl::duplicate(title),
+				.options = options,
+				.initialSelection = chosen->current(),
+				.callback = [=](int index) {
+					*chosen = index;
+					save(limits[index]);
+					Core::App().saveSettingsDelayed();
+				},
+			});
+		}));
+	});
+}
+
+} // namespace
 
 void SetupConnectionType(
 		not_null<Window::Controller*> controller,
@@ -75,6 +131,34 @@ void SetupConnectionType(
 	button->addClickHandler([=] {
 		controller->show(ProxiesBoxController::CreateOwningBox(account));
 	});
+
+	const auto settings = &Core::App().settings();
+	AddButton(
+		container,
+		tr::lng_settings_fewer_download_connections(),
+		st::settingsButton
+	)->toggleOn(
+		rpl::single(settings->fewerDownloadConnections())
+	)->toggledValue(
+	) | rpl::filter([=](bool enabled) {
+		return (enabled != settings->fewerDownloadConnections());
+	}) | rpl::start_with_next([=](bool enabled) {
+		settings->setFewerDownloadConnections(enabled);
+		Core::App().saveSettingsDelayed();
+	}, container->lifetime());
+
+	SetupSpeedLimit(
+		controller,
+		container,
+		tr::lng_settings_download_speed_limit(),
+		[=] { return settings->downloadSpeedLimit(); },
+		[=](int64 limit) { settings->setDownloadSpeedLimit(limit); });
+	SetupSpeedLimit(
+		controller,
+		container,
+		tr::lng_settings_upload_speed_limit(),
+		[=] { return settings->uploadSpeedLimit(); },
+		[=](int64 limit) { settings->setUploadSpeedLimit(limit); });
 }
 
 bool HasUpdate() {
@@ -539,6 +623,23 @@ void SetupAnimations(not_null<Ui::VerticalLayout*> container) {
 	}, container->lifetime());
 }
 
+void SetupHardwareAcceleration(not_null<Ui::VerticalLayout*> container) {
+	const auto settings = &Core::App().settings();
+	AddButton(
+		container,
+		tr::lng_settings_enable_hwaccel(),
+		st::settingsButton
+	)->toggleOn(
+		rpl::single(settings->hardwareAcceleratedVideo())
+	)->toggledValue(
+	) | rpl::filter([=](bool enabled) {
+		return (enabled != settings->hardwareAcceleratedVideo());
+	}) | rpl::start_with_next([=](bool enabled) {
+		settings->setHardwareAcceleratedVideo(enabled);
+		Core::App().saveSettingsDelayed();
+	}, container->lifetime());
+}
+
 #ifdef Q_OS_WIN
 void SetupANGLE(
 		not_null<Window::SessionController*> controller,
@@ -650,6 +751,7 @@ void SetupPerformance(
 		not_null<Window::SessionController*> controller,
 		not_null<Ui::VerticalLayout*> container) {
 	SetupAnimations(container);
+	SetupHardwareAcceleration(container);
 #ifdef Q_OS_WIN
 	SetupANGLE(controller, container);
 #else // Q_OS_WIN
@@ -26,6 +26,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/chat/attach/attach_extensions.h"
 #include "ui/chat/chat_theme.h"
 #include "ui/layers/generic_box.h"
+#include "ui/boxes/single_choice_box.h"
+#include "ui/text/format_values.h"
 #include "ui/effects/radial_animation.h"
 #include "ui/style/style_palette_colorizer.h"
 #include "ui/toast/toast.h"
@@ -369,6 +371,53 @@ void ColorsPalette::updateInnerGeometry() {
 	inner->resize(inner->width(), y + size);
 }
 
+void SetupOfflinePreload(
+		not_null<Window::SessionController*> controller,
+		not_null<Ui::VerticalLayout*> container) {
+	constexpr auto kMegabyte = int64(1024 * 1024);
+	const auto limits = std::vector<int64>{
+		0,
+		100 * kMegabyte,
+		500 * kMegabyte,
+		2048 * kMegabyte,
+	};
+	const auto options = ranges::views::all(
+		limits
+	) | ranges::views::transform([](int64 limit) {
+		return limit
+			? tr::lng_media_offline_preload_limit(
+				tr::now,
+				lt_size,
+				Ui::FormatSizeText(limit))
+			: tr::lng_media_offline_preload_off(tr::now);
+	}) | ranges::to_vector;
+	const auto settings = &Core::App().settings();
+	const auto i = ranges::find(limits, settings->offlinePreloadLimit());
+	const auto chosen = std::make_shared<rpl::variable<int>>(
+		(i != end(limits)) ? int(i - begin(limits)) : 0);
+	AddButtonWithLabel(
+		container,
+		tr::lng_media_offline_preload(),
+		chosen->value() | rpl::map([=](int index) {
+			return options[index];
+		}),
+		st::settingsButton
+	)->addClickHandler([=] {
+		controller->show(Box([=](not_null<Ui::GenericBox*> box) {
+			SingleChoiceBox(box, {
+				.title = tr::lng_media_offline_preload(),
+				.options = options,
+				.initialSelection = chosen->current(),
+				.callback = [=](int index) {
+					*chosen = index;
+					settings->setOfflinePreloadLimit(limits[index]);
+					Core::App().saveSettingsDelayed();
+				},
+			});
+		}));
+	});
+}
+
 } // namespace
 
 class BackgroundRow : public Ui::RpWidget {
@@ -932,6 +981,8 @@ void SetupAutoDownload(
 	add(tr::lng_media_auto_in_groups(), Source::Group);
 	add(tr::lng_media_auto_in_channels(), Source::Channel);
 
+	SetupOfflinePreload(controller, container);
+
 	AddSkip(container, st::settingsCheckboxesSkip);
 }
 
@@ -12,33 +12,226 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 #include "mainwindow.h"
 #include "data/data_session.h"
+#include "data/data_changes.h"
 #include "data/data_cloud_themes.h"
+#include "history/history.h"
+#include "dialogs/dialogs_inner_widget.h"
 #include "main/main_session.h"
 #include "main/main_account.h"
 #include "main/main_domain.h"
 #include "ui/boxes/confirm_box.h"
+#include "lang/lang_keys.h"
+#include "ui/layers/generic_box.h"
+#include "ui/widgets/labels.h"
 #include "lang/lang_cloud_manager.h"
 #include "lang/lang_instance.h"
 #include "core/application.h"
 #include "mtproto/mtp_instance.h"
 #include "mtproto/mtproto_dc_options.h"
+#include "mtproto/details/mtproto_network_simulator.h"
+#include "mtproto/details/mtproto_traffic_capture.h"
 #include "core/file_utilities.h"
 #include "core/update_checker.h"
+#include "core/frame_monitor.h"
+#include "core/memory_accounting.h"
 #include "window/themes/window_theme.h"
 #include "window/themes/window_theme_editor.h"
 #include "window/window_session_controller.h"
 #include "media/audio/media_audio_track.h"
 #include "settings/settings_common.h"
 #include "api/api_updates.h"
+#include "apiwrap.h"
+#include "storage/file_download.h"
+#include "storage/cache/storage_cache_database.h"
 #include "base/qt_adapters.h"
+#include "base/timer.h"
+#include "styles/style_layers.h"
 
 #include "zlib.h"
 
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
 namespace Settings {
 namespace {
 
 using SessionController = Window::SessionController;
 
+constexpr auto kNetworkStatsRefreshPeriod = crl::time(1000);
+constexpr auto kNetworkStatsDumpPeriod = 10 * crl::time(1000);
+
+void ToggleTrafficCapture(MTP::details::CapturePayload payload) {
+	using namespace MTP::details;
+	if (TrafficCaptureEnabled()) {
+		StopTrafficCapture();
+		Ui::Toast::Show("Network capture stopped.");
+		return;
+	}
+	StartTrafficCapture(cWorkingDir() + "mtp_capture.bin", payload);
+	Ui::Toast::Show(TrafficCaptureEnabled()
+		? "Network capture is written to 'mtp_capture.bin'."
+		: "Could not start network capture.");
+}
+
+// Reads 'network_simulation.json' from the working directory:
+// { "all": { "latency": 300, "jitter": 100, "bandwidth": 64,
+//   "loss": 0.02, "reset": 0.001 }, "4": { ... } }
+// where "bandwidth" is in kilobytes per second.
+void ToggleNetworkSimulation() {
+	using namespace MTP::details;
+	if (NetworkSimulationEnabled()) {
+		SetNetworkConditions({});
+		Ui::Toast::Show("Network simulation disabled.");
+		return;
+	}
+	auto file = QFile(cWorkingDir() + "network_simulation.json");
+	if (!file.open(QIODevice::ReadOnly)) {
+		Ui::Toast::Show("Could not open 'network_simulation.json'.");
+		return;
+	}
+	auto error = QJsonParseError{ 0, QJsonParseError::NoError };
+	const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+	if (error.error != QJsonParseError::NoError || !document.isObject()) {
+		Ui::Toast::Show("Bad 'network_simulation.json'.");
+		return;
+	}
+	auto conditions = base::flat_map<int, NetworkConditions>();
+	const auto object = document.object();
+	for (auto i = object.begin(); i != object.end(); ++i) {
+		const auto dcId = (i.key() == u"all"_q) ? 0 : i.key().toInt();
+		if ((dcId <= 0 && i.key() != u"all"_q) || !i.value().isObject()) {
+			continue;
+		}
+		const auto values = i.value().toObject();
+		conditions.emplace(dcId, NetworkConditions{
+			.latency = crl::time(values.value("latency").toInt()),
+			.jitter = crl::time(values.value("jitter").toInt()),
+			.bandwidth = int64(values.value("bandwidth").toInt()) * 1024,
+			.loss = values.value("loss").toDouble(),
+			.reset = values.value("reset").toDouble(),
+		});
+	}
+	SetNetworkConditions(std::move(conditions));
+	Ui::Toast::Show(NetworkSimulationEnabled()
+		? "Network simulation enabled for new connections."
+		: "No conditions in 'network_simulation.json'.");
+}
+
+constexpr auto kMemoryStatsRefreshPeriod = crl::time(1000);
+constexpr auto kCacheStatsRefreshPeriod = crl::time(1000);
+
+void NetworkStatsBox(
+		not_null<Ui::GenericBox*> box,
+		base::weak_ptr<Main::Account> weak) {
+	const auto text = [=] {
+		auto result = QStringList();
+		if (const auto account = weak.get()) {
+			for (const auto &stats : account->mtp().sessionsStats()) {
+				result.push_back(MTP::SessionStatsText(stats));
+			}
+		}
+		return result.join(u"\n\n"_q);
+	};
+	box->setTitle(rpl::single(u"Network Statistics"_q));
+	box->setWidth(st::boxWideWidth);
+	const auto label = box->addRow(
+		object_ptr<Ui::FlatLabel>(box, text(), st::boxLabel));
+	label->setSelectable(true);
+	const auto timer = box->lifetime().make_state<base::Timer>([=] {
+		label->setText(text());
+	});
+	timer->callEach(kNetworkStatsRefreshPeriod);
+	box->addButton(tr::lng_close(), [=] { box->closeBox(); });
+}
+
+void MemoryStatsBox(not_null<Ui::GenericBox*> box) {
+	const auto text = [] {
+		auto result = QStringList();
+		for (const auto &entry : Core::MemoryAccounting::Collect()) {
+			result.push_back(u"%1: %2 KB"_q
+				.arg(entry.name)
+				.arg(entry.bytes / 1024));
+		}
+		const auto allocator = Platform::AllocatorStats();
+		if (!allocator.isEmpty()) {
+			result.push_back(QString());
+			result.push_back(allocator);
+		}
+		return result.join('\n');
+	};
+	box->setTitle(rpl::single(u"Memory Statistics"_q));
+	box->setWidth(st::boxWideWidth);
+	const auto label = box->addRow(
+		object_ptr<Ui::FlatLabel>(box, text(), st::boxLabel));
+	label->setSelectable(true);
+	const auto timer = box->lifetime().make_state<base::Timer>([=] {
+		label->setText(text());
+	});
+	timer->callEach(kMemoryStatsRefreshPeriod);
+	box->addButton(tr::lng_close(), [=] { box->closeBox(); });
+}
+
+void CacheStatsBox(
+		not_null<Ui::GenericBox*> box,
+		not_null<Main::Session*> session) {
+	using Database = Storage::Cache::Database;
+	const auto tags = std::array<std::pair<uint8, const char*>, 7>{ {
+		{ Data::kImageCacheTag, "Images" },
+		{ Data::kStickerCacheTag, "Stickers" },
+		{ Data::kVoiceMessageCacheTag, "Voice messages" },
+		{ Data::kVideoMessageCacheTag, "Video messages" },
+		{ Data::kAnimationCacheTag, "Animations" },
+		{ Data::kMessagesCacheTag, "Messages" },
+		{ Data::kFullPeerCacheTag, "Full peers" },
+	} };
+	const auto stats = box->lifetime().make_state<Database::Stats>();
+	const auto statsBig = box->lifetime().make_state<Database::Stats>();
+	const auto text = [=] {
+		auto result = QStringList();
+		for (const auto &[tag, name] : tags) {
+			const auto reads = Storage::CacheReadStatsByTag(tag);
+			const auto total = reads.hits + reads.misses;
+			const auto i = stats->tagged.find(tag);
+			const auto stored = (i != end(stats->tagged))
+				? i->second
+				: Database::TaggedSummary();
+			result.push_back(u"%1: %2 entries, %3 KB stored, "
+				"%4 / %5 reads hit (%6%), %7 KB read"_q
+				.arg(QString::fromLatin1(name))
+				.arg(stored.count)
+				.arg(stored.totalSize / 1024)
+				.arg(reads.hits)
+				.arg(total)
+				.arg(total ? (reads.hits * 100 / total) : 0)
+				.arg(reads.bytes / 1024));
+		}
+		result.push_back(u"Media cache: %1 entries, %2 KB stored"_q
+			.arg(statsBig->full.count)
+			.arg(statsBig->full.totalSize / 1024));
+		return result.join('\n');
+	};
+	box->setTitle(rpl::single(u"Cache Statistics"_q));
+	box->setWidth(st::boxWideWidth);
+	const auto label = box->addRow(
+		object_ptr<Ui::FlatLabel>(box, text(), st::boxLabel));
+	label->setSelectable(true);
+	rpl::combine(
+		session->data().cache().statsOnMain(),
+		session->data().cacheBigFile().statsOnMain()
+	) | rpl::start_with_next([=](
+			Database::Stats &&updated,
+			Database::Stats &&updatedBig) {
+		*stats = std::move(updated);
+		*statsBig = std::move(updatedBig);
+		label->setText(text());
+	}, box->lifetime());
+	const auto timer = box->lifetime().make_state<base::Timer>([=] {
+		label->setText(text());
+	});
+	timer->callEach(kCacheStatsRefreshPeriod);
+	box->addButton(tr::lng_close(), [=] { box->closeBox(); });
+}
+
 [[nodiscard]] QByteArray UnpackRawGzip(const QByteArray &bytes) {
 	z_stream stream;
 	stream.zalloc = nullptr;
@@ -81,6 +274,105 @@ auto GenerateCodes() {
 			Core::App().switchDebugMode();
 		}));
 	});
+	codes.emplace(qsl("framehud"), [](SessionController *window) {
+		Core::FrameMonitor::Toggle();
+	});
+	codes.emplace(qsl("netstats"), [](SessionController *window) {
+		if (window) {
+			window->show(Box(
+				NetworkStatsBox,
+				base::make_weak(&window->session().account())));
+		}
+	});
+	codes.emplace(qsl("netstatsdump"), [](SessionController *window) {
+		if (!window) {
+			return;
+		}
+		auto &mtp = window->session().account().mtp();
+		const auto enable = mtp.statsDumpPath().isEmpty();
+		mtp.setStatsDumpPath(
+			enable ? (cWorkingDir() + "netstats.txt") : QString(),
+			kNetworkStatsDumpPeriod);
+		Ui::Toast::Show(enable
+			? "Network statistics are written to 'netstats.txt'."
+			: "Network statistics dumping stopped.");
+	});
+	codes.emplace(qsl("mtpcapture"), [](SessionController *window) {
+		ToggleTrafficCapture(MTP::details::CapturePayload::Redacted);
+	});
+	codes.emplace(qsl("mtpcapturefull"), [](SessionController *window) {
+		ToggleTrafficCapture(MTP::details::CapturePayload::Full);
+	});
+	codes.emplace(qsl("netsimulate"), [](SessionController *window) {
+		ToggleNetworkSimulation();
+	});
+	codes.emplace(qsl("historymemory"), [](SessionController *window) {
+		if (!window) {
+			return;
+		}
+		auto histories = 0;
+		auto total = HistoryMemoryStats();
+		const auto owner = &window->session().data();
+		const auto count = [&](not_null<PeerData*> peer) {
+			if (const auto history = owner->historyLoaded(peer)) {
+				const auto stats = history->memoryStats();
+				if (stats.items) {
+					++histories;
+					total.items += stats.items;
+					total.views += stats.views;
+					total.bytes += stats.bytes;
+				}
+			}
+		};
+		owner->enumerateUsers(count);
+		owner->enumerateGroups(count);
+		owner->enumerateChannels(count);
+		const auto text = QString("%1 messages in %2 chats, %3 views, "
+			"%4 KB (%5 B per message)."
+		).arg(total.items
+		).arg(histories
+		).arg(total.views
+		).arg(total.bytes / 1024
+		).arg(total.items ? (total.bytes / total.items) : 0);
+		LOG(("History Memory: %1").arg(text));
+		Ui::Toast::Show(text);
+	});
+	codes.emplace(qsl("memorystats"), [](SessionController *window) {
+		if (window) {
+			window->show(Box(MemoryStatsBox));
+		}
+	});
+	codes.emplace(qsl("cachestats"), [](SessionController *window) {
+		if (window) {
+			window->show(Box(CacheStatsBox, &window->session()));
+		}
+	});
+	codes.emplace(qsl("changesstats"), [](SessionController *window) {
+		if (!window) {
+			return;
+		}
+		const auto stats = window->session().changes().stats();
+		const auto text = QString("%1 change events, %2 merged, "
+			"%3 delivered."
+		).arg(stats.updates
+		).arg(stats.merged
+		).arg(stats.delivered);
+		LOG(("Changes Stats: %1").arg(text));
+		Ui::Toast::Show(text);
+	});
+	codes.emplace(qsl("changescoalesce"), [](SessionController *window) {
+		if (!window) {
+			return;
+		}
+		static auto enabled = false;
+		enabled = !enabled;
+		constexpr auto kFrameInterval = crl::time(16);
+		window->session().changes().setCoalesceInterval(
+			enabled ? kFrameInterval : 0);
+		Ui::Toast::Show(enabled
+			? "Change events are sent once per frame."
+			: "Change events are sent on each event loop iteration.");
+	});
 	codes.emplace(qsl("viewlogs"), [](SessionController *window) {
 		File::ShowInFolder(cWorkingDir() + "log.txt");
 	});
@@ -282,6 +574,45 @@ auto GenerateCodes() {
 		Data::CloudThemes::SetTestingColors(now);
 		Ui::Toast::Show(now ? "Testing chat theme colors!" : "Not testing..");
 	});
+	codes.emplace(qsl("animstats"), [](SessionController *window) {
+		if (!window) {
+			return;
+		}
+		const auto count = window->activeAnimationsCount();
+		LOG(("Animations: %1 active in the last second.").arg(count));
+		Ui::Toast::Show(QString("Active animations: %1").arg(count));
+	});
+	codes.emplace(qsl("dialogspaint"), [](SessionController *window) {
+		const auto enabled = Dialogs::TogglePaintStats();
+		Ui::Toast::Show(enabled
+			? "Chats list paint stats are logged."
+			: "Chats list paint stats are disabled.");
+	});
+
+	codes.emplace(qsl("processstats"), [](SessionController *window) {
+		const auto enabled = Data::ToggleProcessStats();
+		Ui::Toast::Show(enabled
+			? "Data processing stats are logged."
+			: "Data processing stats are disabled.");
+	});
+
+	codes.emplace(qsl("requeststats"), [](SessionController *window) {
+		if (!window) {
+			return;
+		}
+		const auto &api = window->session().api();
+		const auto format = [](const ApiWrap::PeerRequestsStats &stats) {
+			return QString("%1 sent, %2 shared, %3 cached"
+			).arg(stats.sent
+			).arg(stats.shared
+			).arg(stats.cached);
+		};
+		const auto text = QString("Full peer: %1. Peer: %2."
+		).arg(format(api.fullPeerRequestsStats())
+		).arg(format(api.peerRequestsStats()));
+		LOG(("Request Stats: %1").arg(text));
+		Ui::Toast::Show(text);
+	});
 
 	return codes;
 }
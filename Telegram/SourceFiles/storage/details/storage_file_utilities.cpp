@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/platform/base_platform_file_utilities.h"
 #include "base/openssl_help.h"
 #include "base/random.h"
+#include "base/timer.h"
 
 #include <crl/crl_object_on_thread.h>
 #include <QtCore/QtEndian>
@@ -25,6 +26,10 @@ constexpr auto TdfMagicLen = int(sizeof(TdfMagic));
 
 constexpr auto kStrongIterationsCount = 100'000;
 
+// Bursts of writes of the same file are coalesced on the main thread
+// and sent to the writing thread together after this delay.
+constexpr auto kWriteBatchDelay = crl::time(300);
+
 struct WriteEntry {
 	QString basePath;
 	QString base;
@@ -32,13 +37,22 @@ struct WriteEntry {
 	QByteArray md5;
 };
 
+struct JournalEntry {
+	QString basePath;
+	QString path;
+	QByteArray record;
+};
+
 class WriteManager final {
 public:
 	explicit WriteManager(crl::weak_on_thread<WriteManager> weak);
 
 	void write(WriteEntry &&entry);
+	void write(std::vector<WriteEntry> &&entries);
 	void writeSync(WriteEntry &&entry);
 	void writeSyncAll();
+	void append(JournalEntry &&entry);
+	void clearJournal(const QString &path);
 
 private:
 	void scheduleWrite();
@@ -63,11 +77,19 @@ class AsyncWriteManager final {
 public:
 	void write(WriteEntry &&entry);
 	void writeSync(WriteEntry &&entry);
+	void append(JournalEntry &&entry);
+	void clearJournal(const QString &path);
 	void sync();
+	void syncPending(const QString &base);
 	void stop();
 
 private:
+	void ensureManager();
+	void sendPending();
+
 	std::optional<crl::object_on_thread<WriteManager>> _manager;
+	std::vector<WriteEntry> _pending;
+	std::optional<base::Timer> _pendingTimer;
 	bool _finished = false;
 
 };
@@ -86,6 +108,21 @@ void WriteManager::write(WriteEntry &&entry) {
 	scheduleWrite();
 }
 
+void WriteManager::write(std::vector<WriteEntry> &&entries) {
+	for (auto &entry : entries) {
+		const auto i = ranges::find(
+			_scheduled,
+			entry.base,
+			&WriteEntry::base);
+		if (i == end(_scheduled)) {
+			_scheduled.push_back(std::move(entry));
+		} else {
+			*i = std::move(entry);
+		}
+	}
+	scheduleWrite();
+}
+
 void WriteManager::writeSync(WriteEntry &&entry) {
 	const auto i = ranges::find(_scheduled, entry.base, &WriteEntry::base);
 	if (i != end(_scheduled)) {
@@ -140,6 +177,32 @@ void WriteManager::writeSyncAll() {
 	}
 }
 
+void WriteManager::append(JournalEntry &&entry) {
+	QFile file(entry.path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		if (!QDir().mkpath(entry.basePath)
+			|| !file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+			LOG(("Storage Error: Could not open '%1' for appending."
+				).arg(entry.path));
+			return;
+		}
+	}
+	if (!file.size()) {
+		file.write(TdfMagic, TdfMagicLen);
+		const auto version = qint32(AppVersion);
+		file.write((const char*)&version, sizeof(version));
+	}
+	const auto size = qToLittleEndian(quint32(entry.record.size()));
+	file.write((const char*)&size, sizeof(size));
+	file.write(entry.record);
+}
+
+void WriteManager::clearJournal(const QString &path) {
+	// The snapshot replacing the journal may still be scheduled.
+	writeSyncAll();
+	QFile::remove(path);
+}
+
 bool WriteManager::writeOneScheduledNow() {
 	if (_scheduled.empty()) {
 		return false;
@@ -196,29 +259,80 @@ void WriteManager::writeScheduled() {
 	}
 }
 
+void AsyncWriteManager::ensureManager() {
+	if (!_manager) {
+		_manager.emplace();
+	}
+}
+
 void AsyncWriteManager::write(WriteEntry &&entry) {
 	Expects(!_finished);
 
-	if (!_manager) {
-		_manager.emplace();
+	const auto i = ranges::find(_pending, entry.base, &WriteEntry::base);
+	if (i == end(_pending)) {
+		_pending.push_back(std::move(entry));
+	} else {
+		*i = std::move(entry);
 	}
-	_manager->with([entry = std::move(entry)](WriteManager &manager) mutable {
-		manager.write(std::move(entry));
+	if (!_pendingTimer) {
+		_pendingTimer.emplace([=] { sendPending(); });
+	}
+	if (!_pendingTimer->isActive()) {
+		_pendingTimer->callOnce(kWriteBatchDelay);
+	}
+}
+
+void AsyncWriteManager::sendPending() {
+	if (_pendingTimer) {
+		_pendingTimer->cancel();
+	}
+	if (_pending.empty()) {
+		return;
+	}
+	ensureManager();
+	_manager->with([entries = base::take(_pending)](
+			WriteManager &manager) mutable {
+		manager.write(std::move(entries));
 	});
 }
 
 void AsyncWriteManager::writeSync(WriteEntry &&entry) {
 	Expects(!_finished);
 
-	if (!_manager) {
-		_manager.emplace();
+	const auto i = ranges::find(_pending, entry.base, &WriteEntry::base);
+	if (i != end(_pending)) {
+		_pending.erase(i);
 	}
+	ensureManager();
 	_manager->with_sync([&](WriteManager &manager) {
 		manager.writeSync(std::move(entry));
 	});
 }
 
+void AsyncWriteManager::append(JournalEntry &&entry) {
+	Expects(!_finished);
+
+	// Keep journal records ordered after the snapshots written before.
+	sendPending();
+	ensureManager();
+	_manager->with([entry = std::move(entry)](WriteManager &manager) mutable {
+		manager.append(std::move(entry));
+	});
+}
+
+void AsyncWriteManager::clearJournal(const QString &path) {
+	sendPending();
+	if (_manager) {
+		_manager->with([=](WriteManager &manager) {
+			manager.clearJournal(path);
+		});
+	} else {
+		QFile::remove(path);
+	}
+}
+
 void AsyncWriteManager::sync() {
+	sendPending();
 	if (_manager) {
 		_manager->with_sync([](WriteManager &manager) {
 			manager.writeSyncAll();
@@ -226,11 +340,16 @@ void AsyncWriteManager::sync() {
 	}
 }
 
-void AsyncWriteManager::stop() {
-	if (_manager) {
+void AsyncWriteManager::syncPending(const QString &base) {
+	if (ranges::contains(_pending, base, &WriteEntry::base)) {
 		sync();
-		_manager.reset();
 	}
+}
+
+void AsyncWriteManager::stop() {
+	sync();
+	_manager.reset();
+	_pendingTimer.reset();
 	_finished = true;
 }
 
@@ -477,6 +596,9 @@ bool ReadFile(
 		const QString &basePath) {
 	const auto base = basePath + name;
 
+	// Don't read an older version of a file still waiting to be written.
+	Manager.syncPending(base);
+
 	// detect order of read attempts
 	QString toTry[2];
 	const auto modern = base + 's';
@@ -657,6 +779,54 @@ bool ReadEncryptedFile(
 	return true;
 }
 
+void AppendJournal(
+		const QString &name,
+		const QString &basePath,
+		const QByteArray &record) {
+	Manager.append({
+		.basePath = basePath,
+		.path = basePath + name + 'j',
+		.record = record,
+	});
+}
+
+void ClearJournal(const QString &name, const QString &basePath) {
+	Manager.clearJournal(basePath + name + 'j');
+}
+
+std::vector<QByteArray> ReadJournal(
+		const QString &name,
+		const QString &basePath) {
+	QFile f(basePath + name + 'j');
+	if (!f.open(QIODevice::ReadOnly)) {
+		return {};
+	}
+	char magic[TdfMagicLen];
+	qint32 version = 0;
+	if (f.read(magic, TdfMagicLen) != TdfMagicLen
+		|| memcmp(magic, TdfMagic, TdfMagicLen)
+		|| f.read((char*)&version, sizeof(version)) != sizeof(version)
+		|| version > AppVersion) {
+		DEBUG_LOG(("App Info: bad journal header in '%1'").arg(name));
+		return {};
+	}
+	const auto bytes = f.readAll();
+	auto result = std::vector<QByteArray>();
+	auto offset = 0;
+	while (bytes.size() - offset >= int(sizeof(quint32))) {
+		const auto size = qFromLittleEndian<quint32>(
+			bytes.constData() + offset);
+		offset += sizeof(quint32);
+		if (size > quint32(bytes.size() - offset)) {
+			// The last record was not written completely.
+			break;
+		}
+		result.push_back(bytes.mid(offset, size));
+		offset += size;
+	}
+	return result;
+}
+
 bool ReadEncryptedFile(
 		FileReadDescriptor &result,
 		const FileKey &fkey,
@@ -106,6 +106,17 @@ bool ReadEncryptedFile(
 	const QString &basePath,
 	const MTP::AuthKeyPtr &key);
 
+// Journal records are appended in the same background thread that writes
+// the files, so clearing a journal after writing a snapshot is ordered.
+void AppendJournal(
+	const QString &name,
+	const QString &basePath,
+	const QByteArray &record);
+void ClearJournal(const QString &name, const QString &basePath);
+[[nodiscard]] std::vector<QByteArray> ReadJournal(
+	const QString &name,
+	const QString &basePath);
+
 void Sync();
 void Finish();
 
@@ -11,6 +11,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtproto_auth_key.h"
 #include "mtproto/mtproto_response.h"
 #include "main/main_session.h"
+#include "core/application.h"
+#include "core/core_settings.h"
+#include "storage/storage_transfer_shaper.h"
 #include "apiwrap.h"
 #include "base/openssl_help.h"
 
@@ -20,8 +23,23 @@ namespace {
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
 constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
 constexpr auto kMaxWaitedInSession = 16 * kDownloadPartSize;
+constexpr auto kMaxEstimatedWaitedInSession = 64 * kDownloadPartSize;
 constexpr auto kStartSessionsCount = 1;
 constexpr auto kMaxSessionsCount = 8;
+constexpr auto kBlockedSessionAmount = kMaxEstimatedWaitedInSession
+	* kMaxSessionsCount;
+
+// With fewer download connections the same total window is spread over
+// less sessions, each of them keeping a deeper pipeline of requests.
+constexpr auto kFewSessionsCount = 2;
+constexpr auto kFewMaxEstimatedWaitedInSession = kBlockedSessionAmount
+	/ kFewSessionsCount;
+
+// Lane weights, in percents of a session window that the lane may fill.
+// Streaming (priority > 0) may fill it all, visible media (priority 0)
+// and background loads (priority < 0) leave room for higher lanes.
+constexpr auto kVisibleLanePercent = 75;
+constexpr auto kBackgroundLanePercent = 50;
 constexpr auto kMaxTrackedSessionRemoves = 64;
 constexpr auto kRetryAddSessionTimeout = 8 * crl::time(1000);
 constexpr auto kRetryAddSessionSuccesses = 3;
@@ -30,6 +48,44 @@ constexpr auto kMaxTrackedSuccesses = kRetryAddSessionSuccesses
 constexpr auto kRemoveSessionAfterTimeouts = 4;
 constexpr auto kResetDownloadPrioritiesTimeout = crl::time(200);
 constexpr auto kBadRequestDurationThreshold = 8 * crl::time(1000);
+constexpr auto kCdnHashesPrefetchAhead = 16 * kDownloadPartSize;
+
+// Bandwidth-delay estimation, see DcBandwidthData.
+constexpr auto kMinRttWindow = 10 * crl::time(1000);
+constexpr auto kMaxBandwidthWindow = 10 * crl::time(1000);
+constexpr auto kMinBandwidthSampleInterval = crl::time(1);
+constexpr auto kWindowGainPercent = 200;
+
+[[nodiscard]] QByteArray DecryptCdnPart(
+		const QByteArray &encryptionKey,
+		const QByteArray &encryptionIV,
+		int offset,
+		const QByteArray &encrypted) {
+	auto key = bytes::make_span(encryptionKey);
+	auto iv = bytes::make_span(encryptionIV);
+	Expects(key.size() == MTP::CTRState::KeySize);
+	Expects(iv.size() == MTP::CTRState::IvecSize);
+
+	auto state = MTP::CTRState();
+	auto ivec = bytes::make_span(state.ivec);
+	std::copy(iv.begin(), iv.end(), ivec.begin());
+
+	auto counterOffset = static_cast<uint32>(offset) >> 4;
+	state.ivec[15] = static_cast<uchar>(counterOffset & 0xFF);
+	state.ivec[14] = static_cast<uchar>((counterOffset >> 8) & 0xFF);
+	state.ivec[13] = static_cast<uchar>((counterOffset >> 16) & 0xFF);
+	state.ivec[12] = static_cast<uchar>((counterOffset >> 24) & 0xFF);
+
+	// Decrypt straight into a new buffer, without detaching the
+	// received bytes first and decrypting them in place.
+	auto decrypted = QByteArray(encrypted.size(), Qt::Uninitialized);
+	MTP::aesCtrEncrypt(
+		bytes::make_span(encrypted),
+		bytes::make_detached_span(decrypted),
+		key.data(),
+		&state);
+	return decrypted;
+}
 
 // Each (session remove by timeouts) we wait for time:
 // kRetryAddSessionTimeout * max(removesCount, kMaxTrackedSessionRemoves)
@@ -80,8 +136,9 @@ bool DownloadManagerMtproto::Queue::empty() const {
 	return _tasks.empty();
 }
 
-auto DownloadManagerMtproto::Queue::nextTask(bool onlyHighestPriority) const
--> Task* {
+auto DownloadManagerMtproto::Queue::nextTask(
+		bool onlyHighestPriority,
+		int minPriority) const -> Task* {
 	if (_tasks.empty()) {
 		return nullptr;
 	}
@@ -89,9 +146,12 @@ auto DownloadManagerMtproto::Queue::nextTask(bool onlyHighestPriority) const
 	const auto notHighestPriority = [&](const Enqueued &enqueued) {
 		return (enqueued.priority != highestPriority);
 	};
+	const auto belowMinPriority = [&](const Enqueued &enqueued) {
+		return (enqueued.priority < minPriority);
+	};
 	const auto till = (onlyHighestPriority && highestPriority > 0)
 		? ranges::find_if(_tasks, notHighestPriority)
-		: end(_tasks);
+		: ranges::find_if(_tasks, belowMinPriority);
 	const auto readyToRequest = [&](const Enqueued &enqueued) {
 		return enqueued.task->readyToRequest();
 	};
@@ -115,10 +175,19 @@ DownloadManagerMtproto::DcBalanceData::DcBalanceData()
 : sessions(kStartSessionsCount) {
 }
 
+bool DownloadManagerMtproto::DcBandwidthData::valid() const {
+	return (minRtt > 0) && (maxBandwidth > 0);
+}
+
+int64 DownloadManagerMtproto::DcBandwidthData::bandwidthDelayProduct() const {
+	return valid() ? (maxBandwidth * minRtt / crl::time(1000)) : 0;
+}
+
 DownloadManagerMtproto::DownloadManagerMtproto(not_null<ApiWrap*> api)
 : _api(api)
 , _resetGenerationTimer([=] { resetGeneration(); })
-, _killSessionsTimer([=] { killSessions(); }) {
+, _killSessionsTimer([=] { killSessions(); })
+, _shaperTimer([=] { checkSendNext(); }) {
 	_api->instance().restartsByTimeout(
 	) | rpl::filter([](MTP::ShiftedDcId shiftedDcId) {
 		return MTP::isDownloadDcId(shiftedDcId);
@@ -182,9 +251,16 @@ bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 		const auto proj = [](const DcSessionBalanceData &data) {
 			return (data.requested < data.maxWaitedAmount)
 				? data.requested
-				: kMaxWaitedInSession;
+				: kBlockedSessionAmount;
 		};
-		const auto j = ranges::min_element(sessions, ranges::less(), proj);
+		// Sessions above the limit (after the mode was switched) only
+		// finish what they have and are killed together with the others.
+		const auto usable = ranges::make_subrange(
+			begin(sessions),
+			begin(sessions) + std::min(
+				int(sessions.size()),
+				MaxSessionsCount()));
+		const auto j = ranges::min_element(usable, ranges::less(), proj);
 		return (j->requested + kDownloadPartSize <= j->maxWaitedAmount)
 			? (j - begin(sessions))
 			: -1;
@@ -192,10 +268,30 @@ bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 	if (bestIndex < 0) {
 		return false;
 	}
+	auto &shaper = DownloadShaper();
+	shaper.setRate(Core::App().settings().downloadSpeedLimit());
+	const auto scheduleShaped = [&](crl::time delay) {
+		if (!_shaperTimer.isActive()) {
+			_shaperTimer.callOnce(delay);
+		}
+	};
+	if (const auto delay = shaper.delay(false)) {
+		scheduleShaped(delay);
+		return false;
+	}
+
+	// Background parts (priority < 0) wait for a half full bucket.
+	const auto backgroundDelay = shaper.delay(true);
 	const auto onlyHighestPriority = (balanceData.totalRequested > 0);
-	if (const auto task = queue.nextTask(onlyHighestPriority)) {
+	const auto minPriority = backgroundDelay
+		? std::max(MinLanePriority(sessions[bestIndex]), 0)
+		: MinLanePriority(sessions[bestIndex]);
+	if (const auto task = queue.nextTask(onlyHighestPriority, minPriority)) {
+		shaper.consume(kDownloadPartSize);
 		task->loadPart(bestIndex);
 		return true;
+	} else if (backgroundDelay && !queue.empty()) {
+		scheduleShaped(backgroundDelay);
 	}
 	return false;
 }
@@ -224,11 +320,111 @@ int DownloadManagerMtproto::changeRequestedAmount(
 	return result;
 }
 
+auto DownloadManagerMtproto::deliveryMark(MTP::DcId dcId) const
+-> DeliveryMark {
+	const auto i = _balanceData.find(dcId);
+	Assert(i != end(_balanceData));
+	const auto &bandwidth = i->second.bandwidth;
+	return { bandwidth.delivered, bandwidth.deliveredTime };
+}
+
+void DownloadManagerMtproto::updateBandwidth(
+		MTP::DcId dcId,
+		DcBalanceData &dc,
+		crl::time timeAtRequestStart,
+		DeliveryMark markAtRequestStart) {
+	auto &bandwidth = dc.bandwidth;
+	const auto now = crl::now();
+	bandwidth.delivered += kDownloadPartSize;
+	bandwidth.deliveredTime = now;
+
+	const auto rtt = (now - timeAtRequestStart);
+	if (rtt > 0
+		&& (!bandwidth.minRtt
+			|| rtt <= bandwidth.minRtt
+			|| now - bandwidth.minRttStamp > kMinRttWindow)) {
+		bandwidth.minRtt = rtt;
+		bandwidth.minRttStamp = now;
+	}
+
+	// Delivery rate sample is the amount delivered while this request
+	// was in flight, divided by the longer of send and ack intervals.
+	const auto sendElapsed = rtt;
+	const auto ackElapsed = markAtRequestStart.deliveredTime
+		? (now - markAtRequestStart.deliveredTime)
+		: rtt;
+	const auto interval = std::max(sendElapsed, ackElapsed);
+	if (interval < kMinBandwidthSampleInterval) {
+		return;
+	}
+	const auto amount = bandwidth.delivered - markAtRequestStart.delivered;
+	const auto rate = amount * crl::time(1000) / interval;
+	if (rate >= bandwidth.maxBandwidth
+		|| now - bandwidth.maxBandwidthStamp > kMaxBandwidthWindow) {
+		bandwidth.maxBandwidth = rate;
+		bandwidth.maxBandwidthStamp = now;
+	}
+	_bandwidthEstimateUpdates.fire_copy(dcId);
+}
+
+int DownloadManagerMtproto::MaxWaitedInSession(const DcBalanceData &dc) {
+	if (!dc.bandwidth.valid()) {
+		return kMaxWaitedInSession;
+	}
+	const auto target = dc.bandwidth.bandwidthDelayProduct()
+		* kWindowGainPercent
+		/ 100;
+	const auto perSession = target / int64(dc.sessions.size());
+	const auto parts = (perSession + kDownloadPartSize - 1)
+		/ kDownloadPartSize;
+	return int(std::clamp(
+		parts * kDownloadPartSize,
+		int64(kStartWaitedInSession),
+		int64(Core::App().settings().fewerDownloadConnections()
+			? kFewMaxEstimatedWaitedInSession
+			: kMaxEstimatedWaitedInSession)));
+}
+
+bool DownloadManagerMtproto::NeedMoreSessions(const DcBalanceData &dc) {
+	if (!dc.bandwidth.valid()) {
+		return true;
+	}
+
+	// Only add sessions if the estimated window doesn't fit the
+	// sessions we already have, otherwise they'll just share the pipe.
+	const auto target = dc.bandwidth.bandwidthDelayProduct()
+		* kWindowGainPercent
+		/ 100;
+	return (target > int64(dc.sessions.size()) * kMaxWaitedInSession);
+}
+
+int DownloadManagerMtproto::MaxSessionsCount() {
+	return Core::App().settings().fewerDownloadConnections()
+		? kFewSessionsCount
+		: kMaxSessionsCount;
+}
+
+int DownloadManagerMtproto::MinLanePriority(
+		const DcSessionBalanceData &session) {
+	if (!Core::App().settings().fewerDownloadConnections()) {
+		return std::numeric_limits<int>::min();
+	}
+	const auto filled = int64(session.requested + kDownloadPartSize) * 100;
+	const auto window = int64(session.maxWaitedAmount);
+	if (filled <= window * kBackgroundLanePercent) {
+		return std::numeric_limits<int>::min();
+	} else if (filled <= window * kVisibleLanePercent) {
+		return 0;
+	}
+	return 1;
+}
+
 void DownloadManagerMtproto::requestSucceeded(
 		MTP::DcId dcId,
 		int index,
 		int amountAtRequestStart,
-		crl::time timeAtRequestStart) {
+		crl::time timeAtRequestStart,
+		DeliveryMark markAtRequestStart) {
 	using namespace rpl::mappers;
 
 	const auto i = _balanceData.find(dcId);
@@ -236,6 +432,7 @@ void DownloadManagerMtproto::requestSucceeded(
 	auto &dc = i->second;
 	Assert(index < dc.sessions.size());
 	auto &data = dc.sessions[index];
+	updateBandwidth(dcId, dc, timeAtRequestStart, markAtRequestStart);
 	const auto overloaded = (timeAtRequestStart <= dc.lastSessionRemove)
 		|| (amountAtRequestStart > data.maxWaitedAmount);
 	const auto parts = amountAtRequestStart / kDownloadPartSize;
@@ -257,15 +454,22 @@ void DownloadManagerMtproto::requestSucceeded(
 		});
 		return;
 	}
+	const auto maxWaited = MaxWaitedInSession(dc);
 	if (amountAtRequestStart == data.maxWaitedAmount
-		&& data.maxWaitedAmount < kMaxWaitedInSession) {
+		&& data.maxWaitedAmount < maxWaited) {
 		data.maxWaitedAmount = std::min(
 			data.maxWaitedAmount + kDownloadPartSize,
-			kMaxWaitedInSession);
+			maxWaited);
 		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3."
 			).arg(dcId
 			).arg(index
 			).arg(data.maxWaitedAmount));
+	} else if (data.maxWaitedAmount > maxWaited) {
+		data.maxWaitedAmount = maxWaited;
+		DEBUG_LOG(("Download (%1,%2) decreased max waited amount %3."
+			).arg(dcId
+			).arg(index
+			).arg(data.maxWaitedAmount));
 	}
 	data.successes = std::min(data.successes + 1, kMaxTrackedSuccesses);
 	const auto notEnough = ranges::any_of(
@@ -281,7 +485,8 @@ void DownloadManagerMtproto::requestSucceeded(
 	if (dc.timeouts > 0) {
 		--dc.timeouts;
 		return;
-	} else if (dc.sessions.size() == kMaxSessionsCount) {
+	} else if (dc.sessions.size() >= MaxSessionsCount()
+		|| !NeedMoreSessions(dc)) {
 		return;
 	}
 	const auto now = crl::now();
@@ -290,10 +495,45 @@ void DownloadManagerMtproto::requestSucceeded(
 		return;
 	}
 	dc.sessions.emplace_back();
-	DEBUG_LOG(("Download (%1,%2) adding, now sessions: %3"
+	DEBUG_LOG(("Download (%1,%2) adding, now sessions: %3, "
+		"rtt: %4, bandwidth: %5"
 		).arg(dcId
 		).arg(dc.sessions.size() - 1
-		).arg(dc.sessions.size()));
+		).arg(dc.sessions.size()
+		).arg(dc.bandwidth.minRtt
+		).arg(dc.bandwidth.maxBandwidth));
+}
+
+auto DownloadManagerMtproto::bandwidthEstimate(MTP::DcId dcId) const
+-> BandwidthEstimate {
+	const auto i = _balanceData.find(dcId);
+	if (i == end(_balanceData)) {
+		return {};
+	}
+	const auto &dc = i->second;
+	return {
+		.minRtt = dc.bandwidth.minRtt,
+		.bytesPerSecond = dc.bandwidth.maxBandwidth,
+		.bandwidthDelayProduct = dc.bandwidth.bandwidthDelayProduct(),
+		.maxWaitedInSession = MaxWaitedInSession(dc),
+		.sessionsCount = int(dc.sessions.size()),
+		.totalRequested = dc.totalRequested,
+	};
+}
+
+auto DownloadManagerMtproto::bandwidthEstimates() const
+-> base::flat_map<MTP::DcId, BandwidthEstimate> {
+	auto result = base::flat_map<MTP::DcId, BandwidthEstimate>();
+	result.reserve(_balanceData.size());
+	for (const auto &[dcId, dc] : _balanceData) {
+		result.emplace(dcId, bandwidthEstimate(dcId));
+	}
+	return result;
+}
+
+rpl::producer<MTP::DcId> DownloadManagerMtproto::bandwidthEstimateUpdates(
+) const {
+	return _bandwidthEstimateUpdates.events();
 }
 
 int DownloadManagerMtproto::chooseSessionIndex(MTP::DcId dcId) const {
@@ -348,9 +588,9 @@ void DownloadManagerMtproto::removeSession(MTP::DcId dcId) {
 	auto &session = dc.sessions.back();
 
 	// Make sure we don't send anything to that session while redirecting.
-	session.requested += kMaxWaitedInSession * kMaxSessionsCount;
+	session.requested += kBlockedSessionAmount;
 	queue.removeSession(index);
-	Assert(session.requested == kMaxWaitedInSession * kMaxSessionsCount);
+	Assert(session.requested == kBlockedSessionAmount);
 
 	dc.sessions.pop_back();
 	api().instance().killSession(MTP::downloadDcId(dcId, index));
@@ -399,7 +639,9 @@ void DownloadManagerMtproto::killSessions(MTP::DcId dcId) {
 		auto &dc = i->second;
 		Assert(dc.totalRequested == 0);
 		auto sessions = base::take(dc.sessions);
+		auto bandwidth = base::take(dc.bandwidth);
 		dc = DcBalanceData();
+		dc.bandwidth = bandwidth;
 		for (auto j = 0; j != int(sessions.size()); ++j) {
 			Assert(sessions[j].requested == 0);
 			sessions[j] = DcSessionBalanceData();
@@ -581,7 +823,9 @@ void DownloadMtprotoTask::makeRequest(const RequestData &requestData) {
 }
 
 void DownloadMtprotoTask::requestMoreCdnFileHashes() {
-	if (_cdnHashesRequestId || _cdnUncheckedParts.empty()) {
+	if (_cdnHashesRequestId
+		|| _cdnHashesPrefetchRequestId
+		|| _cdnUncheckedParts.empty()) {
 		return;
 	}
 
@@ -657,50 +901,114 @@ void DownloadMtprotoTask::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequ
 		const auto requestData = finishSentRequest(
 			requestId,
 			FinishRequestReason::Success);
-		const auto owner = _owner;
-		const auto dcId = this->dcId();
-		const auto guard = gsl::finally([=] {
-			// 'this' may be deleted at this point.
-			owner->checkSendNextAfterSuccess(dcId);
-		});
+		decryptCdnPart(requestData, data.vbytes().v);
+		prefetchCdnFileHashes(requestData.offset);
+		_owner->checkSendNextAfterSuccess(dcId());
+	});
+}
 
-		auto key = bytes::make_span(_cdnEncryptionKey);
-		auto iv = bytes::make_span(_cdnEncryptionIV);
-		Expects(key.size() == MTP::CTRState::KeySize);
-		Expects(iv.size() == MTP::CTRState::IvecSize);
+void DownloadMtprotoTask::decryptCdnPart(
+		const RequestData &requestData,
+		const QByteArray &encrypted) {
+	// Both decryption and hash check are done in the thread pool,
+	// the part is tracked in _cdnDecryptingParts till it comes back.
+	const auto i = _cdnFileHashes.find(requestData.offset);
+	const auto hash = (i != end(_cdnFileHashes))
+		? i->second.hash
+		: QByteArray();
+	_cdnDecryptingParts.emplace(requestData.offset);
+	crl::async([
+		=,
+		weak = base::make_weak(this),
+		key = _cdnEncryptionKey,
+		iv = _cdnEncryptionIV
+	] {
+		auto decrypted = DecryptCdnPart(
+			key,
+			iv,
+			requestData.offset,
+			encrypted);
+		const auto check = hash.isEmpty()
+			? CheckCdnHashResult::NoHash
+			: bytes::compare(
+				openssl::Sha256(bytes::make_span(decrypted)),
+				bytes::make_span(hash))
+			? CheckCdnHashResult::Invalid
+			: CheckCdnHashResult::Good;
+		crl::on_main(weak, [=, decrypted = std::move(decrypted)] {
+			cdnPartDecrypted(requestData, decrypted, check);
+		});
+	});
+}
 
-		auto state = MTP::CTRState();
-		auto ivec = bytes::make_span(state.ivec);
-		std::copy(iv.begin(), iv.end(), ivec.begin());
+void DownloadMtprotoTask::cdnPartDecrypted(
+		const RequestData &requestData,
+		const QByteArray &decrypted,
+		CheckCdnHashResult check) {
+	if (!_cdnDecryptingParts.remove(requestData.offset)) {
+		return;
+	} else if (check == CheckCdnHashResult::NoHash) {
+		// The hash could have arrived while the part was decrypted.
+		check = checkCdnFileHash(
+			requestData.offset,
+			bytes::make_span(decrypted));
+	}
+	switch (check) {
+	case CheckCdnHashResult::NoHash: {
+		_cdnUncheckedParts.emplace(requestData, decrypted);
+		requestMoreCdnFileHashes();
+	} return;
+
+	case CheckCdnHashResult::Invalid: {
+		LOG(("API Error: Wrong cdnFileHash for offset %1."
+			).arg(requestData.offset));
+		cancelOnFail();
+	} return;
 
-		auto counterOffset = static_cast<uint32>(requestData.offset) >> 4;
-		state.ivec[15] = static_cast<uchar>(counterOffset & 0xFF);
-		state.ivec[14] = static_cast<uchar>((counterOffset >> 8) & 0xFF);
-		state.ivec[13] = static_cast<uchar>((counterOffset >> 16) & 0xFF);
-		state.ivec[12] = static_cast<uchar>((counterOffset >> 24) & 0xFF);
+	case CheckCdnHashResult::Good: {
+		const auto owner = _owner;
+		const auto dcId = this->dcId();
+		partLoaded(requestData.offset, decrypted);
 
-		auto decryptInPlace = data.vbytes().v;
-		auto buffer = bytes::make_detached_span(decryptInPlace);
-		MTP::aesCtrEncrypt(buffer, key.data(), &state);
+		// 'this' may be deleted at this point.
+		owner->checkSendNextAfterSuccess(dcId);
+	} return;
+	}
+	Unexpected("Result of checkCdnFileHash()");
+}
 
-		switch (checkCdnFileHash(requestData.offset, buffer)) {
-		case CheckCdnHashResult::NoHash: {
-			_cdnUncheckedParts.emplace(requestData, decryptInPlace);
+void DownloadMtprotoTask::prefetchCdnFileHashes(int offset) {
+	if (_cdnHashesRequestId
+		|| _cdnHashesPrefetchRequestId
+		|| _cdnFileHashes.empty()) {
+		return;
+	}
+	const auto &[last, hash] = _cdnFileHashes.back();
+	const auto known = last + hash.limit;
+	if (known > offset + kCdnHashesPrefetchAhead
+		|| known <= _cdnHashesPrefetchedFrom) {
+		return;
+	}
+	_cdnHashesPrefetchedFrom = known;
+	_cdnHashesPrefetchRequestId = api().request(MTPupload_GetCdnFileHashes(
+		MTP_bytes(_cdnToken),
+		MTP_int(known)
+	)).done([=](const MTPVector<MTPFileHash> &result) {
+		_cdnHashesPrefetchRequestId = 0;
+		addCdnHashes(result.v);
+		if (feedCheckedCdnParts() != FeedCdnPartsResult::Stopped) {
 			requestMoreCdnFileHashes();
-		} return;
-
-		case CheckCdnHashResult::Invalid: {
-			LOG(("API Error: Wrong cdnFileHash for offset %1."
-				).arg(requestData.offset));
-			cancelOnFail();
-		} return;
-
-		case CheckCdnHashResult::Good: {
-			partLoaded(requestData.offset, decryptInPlace);
-		} return;
 		}
-		Unexpected("Result of checkCdnFileHash()");
-	});
+	}).fail([=] {
+		_cdnHashesPrefetchRequestId = 0;
+		requestMoreCdnFileHashes();
+	}).toDC(MTP::downloadDcId(dcId(), 0)).send();
+}
+
+void DownloadMtprotoTask::cancelCdnFileHashesPrefetch() {
+	if (const auto requestId = base::take(_cdnHashesPrefetchRequestId)) {
+		api().request(requestId).cancel();
+	}
 }
 
 DownloadMtprotoTask::CheckCdnHashResult DownloadMtprotoTask::checkCdnFileHash(
@@ -737,38 +1045,10 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 		requestId,
 		FinishRequestReason::Redirect);
 	addCdnHashes(result.v);
-	auto someMoreChecked = false;
-	for (auto i = _cdnUncheckedParts.begin(); i != _cdnUncheckedParts.cend();) {
-		const auto uncheckedData = i->first;
-		const auto uncheckedBytes = bytes::make_span(i->second);
-
-		switch (checkCdnFileHash(uncheckedData.offset, uncheckedBytes)) {
-		case CheckCdnHashResult::NoHash: {
-			++i;
-		} break;
-
-		case CheckCdnHashResult::Invalid: {
-			LOG(("API Error: Wrong cdnFileHash for offset %1."
-				).arg(uncheckedData.offset));
-			cancelOnFail();
-			return;
-		} break;
-
-		case CheckCdnHashResult::Good: {
-			someMoreChecked = true;
-			const auto goodOffset = uncheckedData.offset;
-			const auto goodBytes = std::move(i->second);
-			const auto weak = base::make_weak(this);
-			i = _cdnUncheckedParts.erase(i);
-			if (!feedPart(goodOffset, goodBytes) || !weak) {
-				return;
-			}
-		} break;
-
-		default: Unexpected("Result of checkCdnFileHash()");
-		}
-	}
-	if (!someMoreChecked) {
+	const auto fed = feedCheckedCdnParts();
+	if (fed == FeedCdnPartsResult::Stopped) {
+		return;
+	} else if (fed == FeedCdnPartsResult::None) {
 		LOG(("API Error: "
 			"Could not find cdnFileHash for offset %1 "
 			"after getCdnFileHashes request."
@@ -793,6 +1073,7 @@ void DownloadMtprotoTask::placeSentRequest(
 
 	i->second.requestedInSession = amount;
 	i->second.sent = crl::now();
+	i->second.mark = _owner->deliveryMark(dcId());
 
 	Ensures(ok1 && ok2);
 }
@@ -820,27 +1101,68 @@ auto DownloadMtprotoTask::finishSentRequest(
 			dcId(),
 			result.sessionIndex,
 			result.requestedInSession,
-			result.sent);
+			result.sent,
+			result.mark);
 	}
 
 	Ensures(ok);
 	return result;
 }
 
+auto DownloadMtprotoTask::feedCheckedCdnParts() -> FeedCdnPartsResult {
+	auto result = FeedCdnPartsResult::None;
+	for (auto i = _cdnUncheckedParts.begin(); i != _cdnUncheckedParts.cend();) {
+		const auto uncheckedData = i->first;
+		const auto uncheckedBytes = bytes::make_span(i->second);
+
+		switch (checkCdnFileHash(uncheckedData.offset, uncheckedBytes)) {
+		case CheckCdnHashResult::NoHash: {
+			++i;
+		} break;
+
+		case CheckCdnHashResult::Invalid: {
+			LOG(("API Error: Wrong cdnFileHash for offset %1."
+				).arg(uncheckedData.offset));
+			cancelOnFail();
+			return FeedCdnPartsResult::Stopped;
+		} break;
+
+		case CheckCdnHashResult::Good: {
+			result = FeedCdnPartsResult::Some;
+			const auto goodOffset = uncheckedData.offset;
+			const auto goodBytes = std::move(i->second);
+			const auto weak = base::make_weak(this);
+			i = _cdnUncheckedParts.erase(i);
+			if (!feedPart(goodOffset, goodBytes) || !weak) {
+				return FeedCdnPartsResult::Stopped;
+			}
+		} break;
+
+		default: Unexpected("Result of checkCdnFileHash()");
+		}
+	}
+	return result;
+}
+
 bool DownloadMtprotoTask::haveSentRequests() const {
-	return !_sentRequests.empty() || !_cdnUncheckedParts.empty();
+	return !_sentRequests.empty()
+		|| !_cdnUncheckedParts.empty()
+		|| !_cdnDecryptingParts.empty();
 }
 
 bool DownloadMtprotoTask::haveSentRequestForOffset(int offset) const {
 	return _requestByOffset.contains(offset)
-		|| _cdnUncheckedParts.contains({ offset, 0 });
+		|| _cdnUncheckedParts.contains({ offset, 0 })
+		|| _cdnDecryptingParts.contains(offset);
 }
 
 void DownloadMtprotoTask::cancelAllRequests() {
 	while (!_sentRequests.empty()) {
 		cancelRequest(_sentRequests.begin()->first);
 	}
+	cancelCdnFileHashesPrefetch();
 	_cdnUncheckedParts.clear();
+	_cdnDecryptingParts.clear();
 }
 
 void DownloadMtprotoTask::cancelRequestForOffset(int offset) {
@@ -849,6 +1171,7 @@ void DownloadMtprotoTask::cancelRequestForOffset(int offset) {
 		cancelRequest(i->second);
 	}
 	_cdnUncheckedParts.remove({ offset, 0 });
+	_cdnDecryptingParts.remove(offset);
 }
 
 void DownloadMtprotoTask::cancelRequest(mtpRequestId requestId) {
@@ -980,6 +1303,10 @@ void DownloadMtprotoTask::changeCDNParams(
 	_cdnEncryptionKey = encryptionKey;
 	_cdnEncryptionIV = encryptionIV;
 	addCdnHashes(hashes);
+	if (resendAllRequests) {
+		cancelCdnFileHashesPrefetch();
+		_cdnHashesPrefetchedFrom = -1;
+	}
 
 	if (resendAllRequests && !_sentRequests.empty()) {
 		auto resendRequests = std::vector<RequestData>();
@@ -25,12 +25,33 @@ namespace Storage {
 // fixed part size download for hash checking.
 constexpr auto kDownloadPartSize = 128 * 1024;
 
+// Prefetched files are queued together with the previous generation,
+// so everything requested for display in the current one goes first.
+constexpr auto kDownloadPrefetchPriority = -1;
+
 class DownloadMtprotoTask;
 
 class DownloadManagerMtproto final : public base::has_weak_ptr {
 public:
 	using Task = DownloadMtprotoTask;
 
+	struct BandwidthEstimate {
+		crl::time minRtt = 0;
+		int64 bytesPerSecond = 0;
+		int64 bandwidthDelayProduct = 0;
+		int maxWaitedInSession = 0;
+		int sessionsCount = 0;
+		int totalRequested = 0;
+
+		[[nodiscard]] bool valid() const {
+			return (minRtt > 0) && (bytesPerSecond > 0);
+		}
+	};
+	struct DeliveryMark {
+		int64 delivered = 0;
+		crl::time deliveredTime = 0;
+	};
+
 	explicit DownloadManagerMtproto(not_null<ApiWrap*> api);
 	~DownloadManagerMtproto();
 
@@ -49,14 +70,21 @@ public:
 	}
 
 	int changeRequestedAmount(MTP::DcId dcId, int index, int delta);
+	[[nodiscard]] DeliveryMark deliveryMark(MTP::DcId dcId) const;
 	void requestSucceeded(
 		MTP::DcId dcId,
 		int index,
 		int amountAtRequestStart,
-		crl::time timeAtRequestStart);
+		crl::time timeAtRequestStart,
+		DeliveryMark markAtRequestStart);
 	void checkSendNextAfterSuccess(MTP::DcId dcId);
 	[[nodiscard]] int chooseSessionIndex(MTP::DcId dcId) const;
 
+	[[nodiscard]] BandwidthEstimate bandwidthEstimate(MTP::DcId dcId) const;
+	[[nodiscard]] auto bandwidthEstimates() const
+		-> base::flat_map<MTP::DcId, BandwidthEstimate>;
+	[[nodiscard]] rpl::producer<MTP::DcId> bandwidthEstimateUpdates() const;
+
 private:
 	class Queue final {
 	public:
@@ -64,7 +92,9 @@ private:
 		void remove(not_null<Task*> task);
 		void resetGeneration();
 		[[nodiscard]] bool empty() const;
-		[[nodiscard]] Task *nextTask(bool onlyHighestPriority) const;
+		[[nodiscard]] Task *nextTask(
+			bool onlyHighestPriority,
+			int minPriority = std::numeric_limits<int>::min()) const;
 		void removeSession(int index);
 
 	private:
@@ -82,10 +112,24 @@ private:
 		int successes = 0; // Since last timeout in this dc in any session.
 		int maxWaitedAmount = 0;
 	};
+	// BBR-like windowed max-bandwidth / min-rtt filters for one dc.
+	struct DcBandwidthData {
+		int64 delivered = 0;
+		crl::time deliveredTime = 0;
+
+		crl::time minRtt = 0;
+		crl::time minRttStamp = 0;
+		int64 maxBandwidth = 0; // Bytes per second.
+		crl::time maxBandwidthStamp = 0;
+
+		[[nodiscard]] bool valid() const;
+		[[nodiscard]] int64 bandwidthDelayProduct() const;
+	};
 	struct DcBalanceData {
 		DcBalanceData();
 
 		std::vector<DcSessionBalanceData> sessions;
+		DcBandwidthData bandwidth;
 		crl::time lastSessionRemove = 0;
 		int sessionRemoveIndex = 0;
 		int sessionRemoveTimes = 0;
@@ -106,9 +150,21 @@ private:
 	void sessionTimedOut(MTP::DcId dcId, int index);
 	void removeSession(MTP::DcId dcId);
 
+	void updateBandwidth(
+		MTP::DcId dcId,
+		DcBalanceData &dc,
+		crl::time timeAtRequestStart,
+		DeliveryMark markAtRequestStart);
+	[[nodiscard]] static int MaxWaitedInSession(const DcBalanceData &dc);
+	[[nodiscard]] static bool NeedMoreSessions(const DcBalanceData &dc);
+	[[nodiscard]] static int MaxSessionsCount();
+	[[nodiscard]] static int MinLanePriority(
+		const DcSessionBalanceData &session);
+
 	const not_null<ApiWrap*> _api;
 
 	rpl::event_stream<> _taskFinished;
+	rpl::event_stream<MTP::DcId> _bandwidthEstimateUpdates;
 
 	base::flat_map<MTP::DcId, DcBalanceData> _balanceData;
 	base::Timer _resetGenerationTimer;
@@ -116,6 +172,8 @@ private:
 	base::flat_map<MTP::DcId, crl::time> _killSessionsWhen;
 	base::Timer _killSessionsTimer;
 
+	base::Timer _shaperTimer;
+
 	base::flat_map<MTP::DcId, Queue> _queues;
 	rpl::lifetime _lifetime;
 
@@ -173,6 +231,7 @@ private:
 		mutable int sessionIndex = 0;
 		int requestedInSession = 0;
 		crl::time sent = 0;
+		DownloadManagerMtproto::DeliveryMark mark;
 
 		inline bool operator<(const RequestData &other) const {
 			return offset < other.offset;
@@ -194,6 +253,11 @@ private:
 		Redirect,
 		Cancel,
 	};
+	enum class FeedCdnPartsResult {
+		None,
+		Some,
+		Stopped,
+	};
 
 	// Called only if readyToRequest() == true.
 	[[nodiscard]] virtual int takeNextRequestOffset() = 0;
@@ -219,6 +283,16 @@ private:
 	void getCdnFileHashesDone(
 		const MTPVector<MTPFileHash> &result,
 		mtpRequestId requestId);
+	void prefetchCdnFileHashes(int offset);
+	void cancelCdnFileHashesPrefetch();
+	[[nodiscard]] FeedCdnPartsResult feedCheckedCdnParts();
+	void decryptCdnPart(
+		const RequestData &requestData,
+		const QByteArray &encrypted);
+	void cdnPartDecrypted(
+		const RequestData &requestData,
+		const QByteArray &decrypted,
+		CheckCdnHashResult check);
 
 	void partLoaded(int offset, const QByteArray &bytes);
 
@@ -269,6 +343,9 @@ private:
 	base::flat_map<int, CdnFileHash> _cdnFileHashes;
 	base::flat_map<RequestData, QByteArray> _cdnUncheckedParts;
 	mtpRequestId _cdnHashesRequestId = 0;
+	mtpRequestId _cdnHashesPrefetchRequestId = 0;
+	int _cdnHashesPrefetchedFrom = -1;
+	base::flat_set<int> _cdnDecryptingParts;
 
 };
 
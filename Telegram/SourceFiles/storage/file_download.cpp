@@ -25,6 +25,27 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace {
 
+struct AtomicCacheReadStats {
+	std::atomic<int64> hits = 0;
+	std::atomic<int64> misses = 0;
+	std::atomic<int64> bytes = 0;
+};
+
+[[nodiscard]] AtomicCacheReadStats &CacheReadStatsRef(uint8 tag) {
+	static auto result = std::array<AtomicCacheReadStats, 256>();
+	return result[tag];
+}
+
+void RecordCacheRead(uint8 tag, const QByteArray &value) {
+	auto &stats = CacheReadStatsRef(tag);
+	if (value.isEmpty()) {
+		++stats.misses;
+	} else {
+		++stats.hits;
+		stats.bytes += value.size();
+	}
+}
+
 class FromMemoryLoader final : public FileLoader {
 public:
 	FromMemoryLoader(
@@ -201,6 +222,20 @@ void FileLoader::increaseLoadSize(int size, bool autoLoading) {
 	_autoLoading = autoLoading;
 }
 
+void FileLoader::setPrefetch() {
+	_prefetch = true;
+}
+
+void FileLoader::raisePriority() {
+	if (!_prefetch) {
+		return;
+	}
+	_prefetch = false;
+	if (!_finished) {
+		raisePriorityHook();
+	}
+}
+
 void FileLoader::notifyAboutProgress() {
 	_updates.fire({});
 }
@@ -280,8 +315,12 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 				std::move(image));
 		});
 	};
-	_session->data().cache().get(key, [=, callback = std::move(done)](
-			QByteArray &&value) mutable {
+	_session->data().cache().get(key, [
+		=,
+		tag = _cacheTag,
+		callback = std::move(done)
+	](QByteArray &&value) mutable {
+		RecordCacheRead(tag, value);
 		if (readImage && !value.startsWith("partial:")) {
 			crl::async([
 				value = std::move(value),
@@ -382,7 +421,12 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 		}
 		return true;
 	}
-	_data.reserve(offset + buffer.size());
+	const auto till = offset + int(buffer.size());
+	if (till > _data.capacity()) {
+		// Reserving the exact size for each part reallocates and copies
+		// the whole buffer every time, reserve the expected size at once.
+		_data.reserve(std::max({ till, _loadSize, int(_data.capacity()) * 2 }));
+	}
 	if (offset > _data.size()) {
 		_skippedBytes += offset - _data.size();
 		_data.resize(offset);
@@ -473,6 +517,15 @@ bool FileLoader::finalizeResult() {
 	return true;
 }
 
+CacheReadStats CacheReadStatsByTag(uint8 tag) {
+	const auto &stats = CacheReadStatsRef(tag);
+	return {
+		.hits = stats.hits.load(),
+		.misses = stats.misses.load(),
+		.bytes = stats.bytes.load(),
+	};
+}
+
 std::unique_ptr<FileLoader> CreateFileLoader(
 		not_null<Main::Session*> session,
 		const DownloadLocation &location,
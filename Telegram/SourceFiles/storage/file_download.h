@@ -103,6 +103,14 @@ public:
 	void start();
 	void cancel();
 
+	// Prefetch loaders stay behind the ones requested for display
+	// until they are requested for display themselves.
+	void setPrefetch();
+	void raisePriority();
+	[[nodiscard]] bool prefetch() const {
+		return _prefetch;
+	}
+
 	[[nodiscard]] bool loadingLocal() const {
 		return (_localStatus == LocalStatus::Loading);
 	}
@@ -143,6 +151,8 @@ protected:
 	virtual void startLoadingWithPartial(const QByteArray &data) {
 		startLoading();
 	}
+	virtual void raisePriorityHook() {
+	}
 
 	void cancel(bool failed);
 
@@ -155,6 +165,7 @@ protected:
 	const not_null<Main::Session*> _session;
 
 	bool _autoLoading = false;
+	bool _prefetch = false;
 	uint8 _cacheTag = 0;
 	bool _finished = false;
 	bool _cancelled = false;
@@ -183,6 +194,15 @@ protected:
 
 };
 
+struct CacheReadStats {
+	int64 hits = 0;
+	int64 misses = 0;
+	int64 bytes = 0;
+};
+
+// Any thread. Reads of the file loaders from the local cache by cache tag.
+[[nodiscard]] CacheReadStats CacheReadStatsByTag(uint8 tag);
+
 [[nodiscard]] std::unique_ptr<FileLoader> CreateFileLoader(
 	not_null<Main::Session*> session,
 	const DownloadLocation &location,
@@ -129,6 +129,7 @@ bool mtpFileLoader::feedPart(int offset, const QByteArray &bytes) {
 	const auto finished = !haveSentRequests()
 		&& (_lastComplete || (_fullSize && _nextRequestOffset >= _loadSize));
 	if (finished) {
+		_queued = false;
 		removeFromQueue();
 		if (!finalizeResult()) {
 			return false;
@@ -157,7 +158,8 @@ bool mtpFileLoader::setWebFileSizeHook(int size) {
 }
 
 void mtpFileLoader::startLoading() {
-	addToQueue();
+	_queued = true;
+	addToQueue(_prefetch ? Storage::kDownloadPrefetchPriority : 0);
 }
 
 void mtpFileLoader::startLoadingWithPartial(const QByteArray &data) {
@@ -177,6 +179,12 @@ void mtpFileLoader::cancelHook() {
 	cancelAllRequests();
 }
 
+void mtpFileLoader::raisePriorityHook() {
+	if (_queued) {
+		addToQueue();
+	}
+}
+
 Storage::Cache::Key mtpFileLoader::cacheKey() const {
 	return v::match(location().data, [&](const WebFileLocation &location) {
 		return Data::WebDocumentCacheKey(location);
@@ -53,6 +53,7 @@ private:
 	void startLoading() override;
 	void startLoadingWithPartial(const QByteArray &data) override;
 	void cancelHook() override;
+	void raisePriorityHook() override;
 
 	bool readyToRequest() const override;
 	int takeNextRequestOffset() override;
@@ -60,6 +61,7 @@ private:
 	void cancelOnFail() override;
 	bool setWebFileSizeHook(int size) override;
 
+	bool _queued = false;
 	bool _lastComplete = false;
 	int32 _nextRequestOffset = 0;
 
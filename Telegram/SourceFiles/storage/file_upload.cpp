@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_send_progress.h"
 #include "storage/localimageloader.h"
 #include "storage/file_download.h"
+#include "storage/storage_transfer_shaper.h"
 #include "data/data_document.h"
 #include "data/data_document_media.h"
 #include "data/data_photo.h"
@@ -20,14 +21,26 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "core/file_location.h"
 #include "core/mime_type.h"
+#include "core/application.h"
+#include "core/core_settings.h"
 #include "main/main_session.h"
+#include "base/binary_guard.h"
 #include "apiwrap.h"
 
+#include <QtCore/QFile>
+
 namespace Storage {
 namespace {
 
-// max 512kb uploaded at the same time in each session
-constexpr auto kMaxUploadFileParallelSize = MTP::kUploadSessionsCount * 512 * 1024;
+// max 2mb uploaded at the same time in each session
+constexpr auto kMaxUploadSessionParallelSize = 4 * 512 * 1024;
+
+// Add one more upload session each time that many parts were uploaded
+// while all current sessions had their parallel size limit reached.
+constexpr auto kAddSessionAfterSuccesses = 16;
+
+// How many document parts we read from disk ahead on a worker thread.
+constexpr auto kReadAheadPartsCount = 8;
 
 constexpr auto kDocumentMaxPartsCount = 4000;
 
@@ -75,14 +88,24 @@ struct Uploader::File {
 	uint64 thumbId() const;
 	const QString &filename() const;
 
-	HashMd5 md5Hash;
+	// Parts read from disk are hashed right after reading, off main thread.
+	std::shared_ptr<HashMd5> md5Hash = std::make_shared<HashMd5>();
 
-	std::unique_ptr<QFile> docFile;
+	std::shared_ptr<QFile> docFile;
+	std::deque<QByteArray> docReadParts;
+	base::binary_guard docReading;
+	int32 docRequestedReadParts = 0;
 	int32 docSentParts = 0;
 	int32 docSize = 0;
 	int32 docPartSize = 0;
 	int32 docPartsCount = 0;
 
+	// Requests of this file that are sent and not yet answered.
+	int32 requestsInFlight = 0;
+	int32 docRequestsInFlight = 0;
+
+	[[nodiscard]] bool partsSent() const;
+
 };
 
 Uploader::File::File(const SendMediaReady &media) : media(media) {
@@ -136,6 +159,16 @@ bool Uploader::File::setPartSize(uint32 partSize) {
 	return (docPartsCount <= kDocumentMaxPartsCount);
 }
 
+bool Uploader::File::partsSent() const {
+	const auto &parts = file
+		? ((type() == SendMediaType::Photo
+			|| type() == SendMediaType::Secure)
+			? file->fileparts
+			: file->thumbparts)
+		: media.parts;
+	return parts.isEmpty() && (docSentParts >= docPartsCount);
+}
+
 uint64 Uploader::File::id() const {
 	return file ? file->id : media.id;
 }
@@ -157,6 +190,13 @@ Uploader::Uploader(not_null<ApiWrap*> api)
 , _nextTimer([=] { sendNext(); })
 , _stopSessionsTimer([=] { stopSessions(); }) {
 	const auto session = &_api->session();
+	_api->instance().restartsByTimeout(
+	) | rpl::filter([](MTP::ShiftedDcId shiftedDcId) {
+		return MTP::isUploadDcId(shiftedDcId);
+	}) | rpl::start_with_next([=](MTP::ShiftedDcId shiftedDcId) {
+		sessionTimedOut(
+			MTP::GetDcIdShift(shiftedDcId) - MTP::kBaseUploadDcShift);
+	}, _lifetime);
 	photoReady(
 	) | rpl::start_with_next([=](const UploadedPhoto &data) {
 		if (data.edit) {
@@ -361,9 +401,11 @@ void Uploader::upload(
 	sendNext();
 }
 
-void Uploader::currentFailed() {
-	auto j = queue.find(uploadingId);
+void Uploader::failed(const FullMsgId &msgId) {
+	auto docPartSize = 0;
+	auto j = queue.find(msgId);
 	if (j != queue.end()) {
+		docPartSize = j->second.docPartSize;
 		if (j->second.type() == SendMediaType::Photo) {
 			_photoFailed.fire_copy(j->first);
 		} else if (j->second.type() == SendMediaType::File
@@ -377,19 +419,39 @@ void Uploader::currentFailed() {
 		} else if (j->second.type() == SendMediaType::Secure) {
 			_secureFailed.fire_copy(j->first);
 		} else {
-			Unexpected("Type in Uploader::currentFailed.");
+			Unexpected("Type in Uploader::failed.");
 		}
 		queue.erase(j);
 	}
 
-	requestsSent.clear();
-	docRequestsSent.clear();
-	dcMap.clear();
-	uploadingId = FullMsgId();
-	sentSize = 0;
-	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
-		sentSizes[i] = 0;
+	// Other files may still have their parts in flight.
+	for (auto i = begin(requestOwners); i != end(requestOwners);) {
+		if (i->second != msgId) {
+			++i;
+			continue;
+		}
+		const auto requestId = i->first;
+		_api->request(requestId).cancel();
+		auto size = uint32(docPartSize);
+		if (const auto k = requestsSent.find(requestId)
+			; k != end(requestsSent)) {
+			size = k->second.size();
+			requestsSent.erase(k);
+		} else {
+			docRequestsSent.remove(requestId);
+		}
+		if (const auto k = dcMap.find(requestId); k != end(dcMap)) {
+			sentSize -= size;
+			sentSizes[k->second] -= size;
+			dcMap.erase(k);
+		}
+		i = requestOwners.erase(i);
+	}
+	if (uploadingId == msgId) {
+		uploadingId = FullMsgId();
 	}
+	_windowFull = false;
+	_successesInFullWindow = 0;
 
 	sendNext();
 }
@@ -398,24 +460,132 @@ void Uploader::stopSessions() {
 	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
 		_api->instance().stopSession(MTP::uploadDcId(i));
 	}
+	_sessionsCount = MTP::kStartUploadSessionsCount;
+	_successesInFullWindow = 0;
 }
 
-void Uploader::sendNext() {
-	if (sentSize >= kMaxUploadFileParallelSize || _pausedId.msg) {
+void Uploader::sessionTimedOut(int index) {
+	if (index < 0
+		|| index >= _sessionsCount
+		|| _sessionsCount <= MTP::kStartUploadSessionsCount) {
 		return;
 	}
 
+	// Requests already sent to the removed sessions will finish there.
+	--_sessionsCount;
+	_successesInFullWindow = 0;
+	DEBUG_LOG(("Upload session %1 timed-out, now sessions: %2"
+		).arg(index
+		).arg(_sessionsCount));
+}
+
+uint32 Uploader::maxParallelSize() const {
+	return uint32(_sessionsCount) * kMaxUploadSessionParallelSize;
+}
+
+void Uploader::readAheadParts(not_null<File*> file) {
+	if (file->docReading) {
+		return;
+	}
+	const auto left = file->docPartsCount - file->docRequestedReadParts;
+	const auto count = std::min(
+		left,
+		kReadAheadPartsCount - int(file->docReadParts.size()));
+	if (count <= 0) {
+		return;
+	}
+	file->docRequestedReadParts += count;
+	crl::async([
+		=,
+		msgId = uploadingId,
+		docFile = file->docFile,
+		partSize = file->docPartSize,
+		md5Hash = ((file->docSize <= kUseBigFilesFrom)
+			? file->md5Hash
+			: nullptr),
+		guard = file->docReading.make_guard()
+	]() mutable {
+		auto parts = std::vector<QByteArray>();
+		parts.reserve(count);
+		auto failed = false;
+		for (auto i = 0; i != count; ++i) {
+			parts.push_back(docFile->read(partSize));
+			if (parts.back().isEmpty()) {
+				failed = true;
+				break;
+			} else if (md5Hash) {
+				md5Hash->feed(parts.back().constData(), parts.back().size());
+			}
+		}
+		crl::on_main(std::move(guard), [
+			=,
+			parts = std::move(parts)
+		]() mutable {
+			partsRead(msgId, std::move(parts), failed);
+		});
+	});
+}
+
+void Uploader::partsRead(
+		const FullMsgId &msgId,
+		std::vector<QByteArray> &&parts,
+		bool failed) {
+	const auto i = queue.find(msgId);
+	Assert(i != end(queue));
+
+	auto &file = i->second;
+	file.docReading = base::binary_guard();
+	if (failed) {
+		if (uploadingId == msgId) {
+			failed(msgId);
+		}
+		return;
+	}
+	for (auto &part : parts) {
+		file.docReadParts.push_back(std::move(part));
+	}
+	sendNext();
+}
+
+void Uploader::sendNext() {
+	auto sent = false;
+	while (sendNextPart()) {
+		sent = true;
+	}
+	if (const auto delay = base::take(_shaperDelay)) {
+		_nextTimer.callOnce(sent
+			? std::min(delay, kUploadRequestInterval)
+			: delay);
+	} else if (sent) {
+		_nextTimer.callOnce(kUploadRequestInterval);
+	}
+}
+
+bool Uploader::sendNextPart() {
+	if (_pausedId.msg) {
+		return false;
+	} else if (sentSize >= maxParallelSize()) {
+		_windowFull = true;
+		return false;
+	}
+
 	const auto stopping = _stopSessionsTimer.isActive();
 	if (queue.empty()) {
 		if (!stopping) {
 			_stopSessionsTimer.callOnce(kKillSessionTimeout);
 		}
-		return;
+		return false;
 	}
 
 	if (stopping) {
 		_stopSessionsTimer.cancel();
 	}
+	auto &shaper = UploadShaper();
+	shaper.setRate(Core::App().settings().uploadSpeedLimit());
+	if (const auto delay = shaper.delay(false)) {
+		_shaperDelay = delay;
+		return false;
+	}
 	auto i = uploadingId.msg ? queue.find(uploadingId) : queue.begin();
 	if (!uploadingId.msg) {
 		uploadingId = i->first;
@@ -426,11 +596,15 @@ void Uploader::sendNext() {
 	auto &uploadingData = i->second;
 
 	auto todc = 0;
-	for (auto dc = 1; dc != MTP::kUploadSessionsCount; ++dc) {
+	for (auto dc = 1; dc != _sessionsCount; ++dc) {
 		if (sentSizes[dc] < sentSizes[todc]) {
 			todc = dc;
 		}
 	}
+	if (sentSizes[todc] >= kMaxUploadSessionParallelSize) {
+		_windowFull = true;
+		return false;
+	}
 
 	auto &parts = uploadingData.file
 		? ((uploadingData.type() == SendMediaType::Photo
@@ -446,87 +620,22 @@ void Uploader::sendNext() {
 		: uploadingData.media.thumbId;
 	if (parts.isEmpty()) {
 		if (uploadingData.docSentParts >= uploadingData.docPartsCount) {
-			if (requestsSent.empty() && docRequestsSent.empty()) {
-				const auto options = uploadingData.file
-					? uploadingData.file->to.options
-					: Api::SendOptions();
-				const auto edit = uploadingData.file &&
-					uploadingData.file->to.replaceMediaOf;
-				const auto attachedStickers = uploadingData.file
-					? uploadingData.file->attachedStickers
-					: std::vector<MTPInputDocument>();
-				if (uploadingData.type() == SendMediaType::Photo) {
-					auto photoFilename = uploadingData.filename();
-					if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
-						// Server has some extensions checking for inputMediaUploadedPhoto,
-						// so force the extension to be .jpg anyway. It doesn't matter,
-						// because the filename from inputFile is not used anywhere.
-						photoFilename += qstr(".jpg");
-					}
-					const auto md5 = uploadingData.file
-						? uploadingData.file->filemd5
-						: uploadingData.media.jpeg_md5;
-					const auto file = MTP_inputFile(
-						MTP_long(uploadingData.id()),
-						MTP_int(uploadingData.partsCount),
-						MTP_string(photoFilename),
-						MTP_bytes(md5));
-					_photoReady.fire({
-						uploadingId,
-						options,
-						file,
-						edit,
-						attachedStickers });
-				} else if (uploadingData.type() == SendMediaType::File
-					|| uploadingData.type() == SendMediaType::ThemeFile
-					|| uploadingData.type() == SendMediaType::Audio) {
-					QByteArray docMd5(32, Qt::Uninitialized);
-					hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
-
-					const auto file = (uploadingData.docSize > kUseBigFilesFrom)
-						? MTP_inputFileBig(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()))
-						: MTP_inputFile(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()),
-							MTP_bytes(docMd5));
-					const auto thumb = [&]() -> std::optional<MTPInputFile> {
-						if (!uploadingData.partsCount) {
-							return std::nullopt;
-						}
-						const auto thumbFilename = uploadingData.file
-							? uploadingData.file->thumbname
-							: (qsl("thumb.") + uploadingData.media.thumbExt);
-						const auto thumbMd5 = uploadingData.file
-							? uploadingData.file->thumbmd5
-							: uploadingData.media.jpeg_md5;
-						return MTP_inputFile(
-							MTP_long(uploadingData.thumbId()),
-							MTP_int(uploadingData.partsCount),
-							MTP_string(thumbFilename),
-							MTP_bytes(thumbMd5));
-					}();
-					_documentReady.fire({
-						uploadingId,
-						options,
-						file,
-						thumb,
-						edit,
-						attachedStickers });
-				} else if (uploadingData.type() == SendMediaType::Secure) {
-					_secureReady.fire({
-						uploadingId,
-						uploadingData.id(),
-						uploadingData.partsCount });
-				}
-				queue.erase(uploadingId);
+			if (!uploadingData.requestsInFlight) {
+				finishFile(uploadingId);
 				uploadingId = FullMsgId();
 				sendNext();
+				return false;
 			}
-			return;
+
+			// Only answers are awaited for this file, so the window is used
+			// by the next file meanwhile, for example the next album item.
+			for (const auto &[fullId, file] : queue) {
+				if (!file.partsSent()) {
+					uploadingId = fullId;
+					return true;
+				}
+			}
+			return false;
 		}
 
 		auto &content = uploadingData.file
@@ -538,16 +647,19 @@ void Uploader::sendNext() {
 				const auto filepath = uploadingData.file
 					? uploadingData.file->filepath
 					: uploadingData.media.file;
-				uploadingData.docFile = std::make_unique<QFile>(filepath);
+				uploadingData.docFile = std::make_shared<QFile>(filepath);
 				if (!uploadingData.docFile->open(QIODevice::ReadOnly)) {
-					currentFailed();
-					return;
+					failed(uploadingId);
+					return false;
 				}
 			}
-			toSend = uploadingData.docFile->read(uploadingData.docPartSize);
-			if (uploadingData.docSize <= kUseBigFilesFrom) {
-				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
+			if (uploadingData.docReadParts.empty()) {
+				readAheadParts(&uploadingData);
+				return false;
 			}
+			toSend = std::move(uploadingData.docReadParts.front());
+			uploadingData.docReadParts.pop_front();
+			readAheadParts(&uploadingData);
 		} else {
 			const auto offset = uploadingData.docSentParts
 				* uploadingData.docPartSize;
@@ -556,14 +668,14 @@ void Uploader::sendNext() {
 				|| uploadingData.type() == SendMediaType::ThemeFile
 				|| uploadingData.type() == SendMediaType::Audio)
 				&& uploadingData.docSentParts <= kUseBigFilesFrom) {
-				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
+				uploadingData.md5Hash->feed(toSend.constData(), toSend.size());
 			}
 		}
 		if ((toSend.size() > uploadingData.docPartSize)
 			|| ((toSend.size() < uploadingData.docPartSize
 				&& uploadingData.docSentParts + 1 != uploadingData.docPartsCount))) {
-			currentFailed();
-			return;
+			failed(uploadingId);
+			return false;
 		}
 		mtpRequestId requestId;
 		if (uploadingData.docSize > kUseBigFilesFrom) {
@@ -589,9 +701,13 @@ void Uploader::sendNext() {
 			}).toDC(MTP::uploadDcId(todc)).send();
 		}
 		docRequestsSent.emplace(requestId, uploadingData.docSentParts);
+		requestOwners.emplace(requestId, uploadingId);
 		dcMap.emplace(requestId, todc);
+		++uploadingData.requestsInFlight;
+		++uploadingData.docRequestsInFlight;
 		sentSize += uploadingData.docPartSize;
 		sentSizes[todc] += uploadingData.docPartSize;
+		shaper.consume(uploadingData.docPartSize);
 
 		uploadingData.docSentParts++;
 	} else {
@@ -607,21 +723,108 @@ void Uploader::sendNext() {
 			partFailed(error, requestId);
 		}).toDC(MTP::uploadDcId(todc)).send();
 		requestsSent.emplace(requestId, part.value());
+		requestOwners.emplace(requestId, uploadingId);
 		dcMap.emplace(requestId, todc);
+		++uploadingData.requestsInFlight;
 		sentSize += part.value().size();
 		sentSizes[todc] += part.value().size();
+		shaper.consume(part.value().size());
 
 		parts.erase(part);
 	}
-	_nextTimer.callOnce(kUploadRequestInterval);
+	return true;
+}
+
+void Uploader::finishFile(const FullMsgId &msgId) {
+	const auto i = queue.find(msgId);
+	Assert(i != end(queue));
+
+	auto &data = i->second;
+	const auto options = data.file
+		? data.file->to.options
+		: Api::SendOptions();
+	const auto edit = data.file && data.file->to.replaceMediaOf;
+	const auto attachedStickers = data.file
+		? data.file->attachedStickers
+		: std::vector<MTPInputDocument>();
+	if (data.type() == SendMediaType::Photo) {
+		auto photoFilename = data.filename();
+		if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
+			// Server has some extensions checking for inputMediaUploadedPhoto,
+			// so force the extension to be .jpg anyway. It doesn't matter,
+			// because the filename from inputFile is not used anywhere.
+			photoFilename += qstr(".jpg");
+		}
+		const auto md5 = data.file
+			? data.file->filemd5
+			: data.media.jpeg_md5;
+		const auto file = MTP_inputFile(
+			MTP_long(data.id()),
+			MTP_int(data.partsCount),
+			MTP_string(photoFilename),
+			MTP_bytes(md5));
+		_photoReady.fire({
+			msgId,
+			options,
+			file,
+			edit,
+			attachedStickers });
+	} else if (data.type() == SendMediaType::File
+		|| data.type() == SendMediaType::ThemeFile
+		|| data.type() == SendMediaType::Audio) {
+		QByteArray docMd5(32, Qt::Uninitialized);
+		hashMd5Hex(data.md5Hash->result(), docMd5.data());
+
+		const auto file = (data.docSize > kUseBigFilesFrom)
+			? MTP_inputFileBig(
+				MTP_long(data.id()),
+				MTP_int(data.docPartsCount),
+				MTP_string(data.filename()))
+			: MTP_inputFile(
+				MTP_long(data.id()),
+				MTP_int(data.docPartsCount),
+				MTP_string(data.filename()),
+				MTP_bytes(docMd5));
+		const auto thumb = [&]() -> std::optional<MTPInputFile> {
+			if (!data.partsCount) {
+				return std::nullopt;
+			}
+			const auto thumbFilename = data.file
+				? data.file->thumbname
+				: (qsl("thumb.") + data.media.thumbExt);
+			const auto thumbMd5 = data.file
+				? data.file->thumbmd5
+				: data.media.jpeg_md5;
+			return MTP_inputFile(
+				MTP_long(data.thumbId()),
+				MTP_int(data.partsCount),
+				MTP_string(thumbFilename),
+				MTP_bytes(thumbMd5));
+		}();
+		_documentReady.fire({
+			msgId,
+			options,
+			file,
+			thumb,
+			edit,
+			attachedStickers });
+	} else if (data.type() == SendMediaType::Secure) {
+		_secureReady.fire({
+			msgId,
+			data.id(),
+			data.partsCount });
+	}
+	queue.erase(i);
 }
 
 void Uploader::cancel(const FullMsgId &msgId) {
 	uploaded.erase(msgId);
-	if (uploadingId == msgId) {
-		currentFailed();
-	} else {
-		queue.erase(msgId);
+	const auto i = queue.find(msgId);
+	if (uploadingId == msgId
+		|| (i != end(queue) && i->second.requestsInFlight > 0)) {
+		failed(msgId);
+	} else if (i != end(queue)) {
+		queue.erase(i);
 	}
 }
 
@@ -648,12 +851,16 @@ void Uploader::clear() {
 		_api->request(requestData.first).cancel();
 	}
 	docRequestsSent.clear();
+	requestOwners.clear();
 	dcMap.clear();
 	sentSize = 0;
 	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
 		_api->instance().stopSession(MTP::uploadDcId(i));
 		sentSizes[i] = 0;
 	}
+	_sessionsCount = MTP::kStartUploadSessionsCount;
+	_successesInFullWindow = 0;
+	_windowFull = false;
 	_stopSessionsTimer.cancel();
 }
 
@@ -663,32 +870,46 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 	if (i == requestsSent.cend()) {
 		j = docRequestsSent.find(requestId);
 	}
-	if (i != requestsSent.cend() || j != docRequestsSent.cend()) {
-		if (mtpIsFalse(result)) { // failed to upload current file
-			currentFailed();
+	const auto owner = requestOwners.find(requestId);
+	if (owner != end(requestOwners)
+		&& (i != requestsSent.cend() || j != docRequestsSent.cend())) {
+		const auto ownerId = owner->second;
+		if (mtpIsFalse(result)) { // failed to upload this file
+			failed(ownerId);
 			return;
 		} else {
 			auto dcIt = dcMap.find(requestId);
 			if (dcIt == dcMap.cend()) { // must not happen
-				currentFailed();
+				failed(ownerId);
 				return;
 			}
 			auto dc = dcIt->second;
 			dcMap.erase(dcIt);
+			requestOwners.erase(owner);
 
 			int32 sentPartSize = 0;
-			auto k = queue.find(uploadingId);
+			auto k = queue.find(ownerId);
 			Assert(k != queue.cend());
 			auto &[fullId, file] = *k;
+			--file.requestsInFlight;
 			if (i != requestsSent.cend()) {
 				sentPartSize = i->second.size();
 				requestsSent.erase(i);
 			} else {
 				sentPartSize = file.docPartSize;
 				docRequestsSent.erase(j);
+				--file.docRequestsInFlight;
 			}
 			sentSize -= sentPartSize;
 			sentSizes[dc] -= sentPartSize;
+			if (base::take(_windowFull)
+				&& ++_successesInFullWindow >= kAddSessionAfterSuccesses
+				&& _sessionsCount < MTP::kUploadSessionsCount) {
+				_successesInFullWindow = 0;
+				++_sessionsCount;
+				DEBUG_LOG(("Upload adding session, now sessions: %1"
+					).arg(_sessionsCount));
+			}
 			if (file.type() == SendMediaType::Photo) {
 				file.fileSentSize += sentPartSize;
 				const auto photo = session().data().photo(file.id());
@@ -703,7 +924,7 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 				const auto document = session().data().document(file.id());
 				if (document->uploading()) {
 					const auto doneParts = file.docSentParts
-						- int(docRequestsSent.size());
+						- file.docRequestsInFlight;
 					document->uploadingData->offset = std::min(
 						document->uploadingData->size,
 						doneParts * file.docPartSize);
@@ -716,6 +937,11 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 					file.fileSentSize,
 					file.file->partssize });
 			}
+			if (fullId != uploadingId
+				&& !file.requestsInFlight
+				&& file.partsSent()) {
+				finishFile(ownerId);
+			}
 		}
 	}
 
@@ -723,10 +949,12 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 }
 
 void Uploader::partFailed(const MTP::Error &error, mtpRequestId requestId) {
-	// failed to upload current file
-	if ((requestsSent.find(requestId) != requestsSent.cend())
-		|| (docRequestsSent.find(requestId) != docRequestsSent.cend())) {
-		currentFailed();
+	// failed to upload the file this part belongs to
+	const auto owner = requestOwners.find(requestId);
+	if (owner != end(requestOwners)
+		&& ((requestsSent.find(requestId) != requestsSent.cend())
+			|| (docRequestsSent.find(requestId) != docRequestsSent.cend()))) {
+		failed(owner->second);
 	}
 	sendNext();
 }
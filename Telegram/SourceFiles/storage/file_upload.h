@@ -110,6 +110,15 @@ public:
 private:
 	struct File;
 
+	[[nodiscard]] bool sendNextPart();
+	[[nodiscard]] uint32 maxParallelSize() const;
+	void readAheadParts(not_null<File*> file);
+	void partsRead(
+		const FullMsgId &msgId,
+		std::vector<QByteArray> &&parts,
+		bool failed);
+	void sessionTimedOut(int index);
+
 	void partLoaded(const MTPBool &result, mtpRequestId requestId);
 	void partFailed(const MTP::Error &error, mtpRequestId requestId);
 
@@ -118,7 +127,8 @@ private:
 	void processDocumentProgress(const FullMsgId &msgId);
 	void processDocumentFailed(const FullMsgId &msgId);
 
-	void currentFailed();
+	void finishFile(const FullMsgId &msgId);
+	void failed(const FullMsgId &msgId);
 
 	void sendProgressUpdate(
 		not_null<HistoryItem*> item,
@@ -129,8 +139,13 @@ private:
 	base::flat_map<mtpRequestId, QByteArray> requestsSent;
 	base::flat_map<mtpRequestId, int32> docRequestsSent;
 	base::flat_map<mtpRequestId, int32> dcMap;
+	base::flat_map<mtpRequestId, FullMsgId> requestOwners;
 	uint32 sentSize = 0;
 	uint32 sentSizes[MTP::kUploadSessionsCount] = { 0 };
+	int _sessionsCount = MTP::kStartUploadSessionsCount;
+	int _successesInFullWindow = 0;
+	bool _windowFull = false;
+	crl::time _shaperDelay = 0;
 
 	FullMsgId uploadingId;
 	FullMsgId _pausedId;
@@ -33,6 +33,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 
 #include <QtCore/QBuffer>
+#include <QtGui/QImageReader>
 #include <QtGui/QImageWriter>
 #include <QtGui/QColorSpace>
 
@@ -42,6 +43,11 @@ constexpr auto kThumbnailQuality = 87;
 constexpr auto kThumbnailSize = 320;
 constexpr auto kPhotoUploadPartSize = 32 * 1024;
 
+// Images are never decoded smaller than that, it is the largest side
+// we can send the photo with, so the sent result doesn't change.
+constexpr auto kReducedDecodeMinSide = 2560;
+constexpr auto kReducedDecodeMaxDivider = 8;
+
 using Ui::ValidateThumbDimensions;
 
 struct PreparedFileThumbnail {
@@ -52,6 +58,71 @@ struct PreparedFileThumbnail {
 	MTPPhotoSize mtpSize = MTP_photoSizeEmpty(MTP_string());
 };
 
+struct ReducedImage {
+	QImage image;
+	QSize original;
+};
+
+// Only for codecs that decode straight to a smaller size, like JPEG
+// with DCT scaling or WebP, otherwise use full Images::Read.
+[[nodiscard]] std::optional<ReducedImage> ReadReducedImage(
+		const QString &filepath,
+		const QByteArray &content) {
+	auto file = QFile(filepath);
+	auto buffer = QBuffer();
+	auto reader = QImageReader();
+	if (!content.isEmpty()) {
+		if (content.size() > Images::kReadBytesLimit) {
+			return std::nullopt;
+		}
+		buffer.setData(content);
+		if (!buffer.open(QIODevice::ReadOnly)) {
+			return std::nullopt;
+		}
+		reader.setDevice(&buffer);
+	} else if (filepath.isEmpty()
+		|| file.size() > Images::kReadBytesLimit
+		|| !file.open(QIODevice::ReadOnly)) {
+		return std::nullopt;
+	} else {
+		reader.setDevice(&file);
+	}
+	reader.setDecideFormatFromContent(true);
+	reader.setAutoTransform(true);
+	if (!reader.canRead()
+		|| !reader.supportsOption(QImageIOHandler::ScaledSize)
+		|| (reader.supportsAnimation() && reader.imageCount() > 1)) {
+		return std::nullopt;
+	}
+	const auto size = reader.size();
+	const auto side = std::max(size.width(), size.height());
+	if (size.isEmpty() || side < 2 * kReducedDecodeMinSide) {
+		return std::nullopt;
+	}
+	auto divider = 2;
+	while (divider < kReducedDecodeMaxDivider
+		&& side / (divider * 2) >= kReducedDecodeMinSide) {
+		divider *= 2;
+	}
+
+	// Power of two dividers with rounding up give exactly the size
+	// libjpeg produces with DCT scaling, so no additional resampling.
+	reader.setScaledSize({
+		(size.width() + divider - 1) / divider,
+		(size.height() + divider - 1) / divider,
+	});
+	auto image = reader.read();
+	if (image.isNull()) {
+		return std::nullopt;
+	}
+	const auto rotated = (reader.transformation()
+		& QImageIOHandler::TransformationRotate90);
+	return ReducedImage{
+		.image = std::move(image),
+		.original = rotated ? size.transposed() : size,
+	};
+}
+
 PreparedFileThumbnail PrepareFileThumbnail(QImage &&original) {
 	const auto width = original.width();
 	const auto height = original.height();
@@ -239,7 +310,8 @@ SendMediaReady::SendMediaReady(
 	}
 }
 
-TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
+TaskQueue::TaskQueue(crl::time stopTimeoutMs, int parallel)
+: _parallel(std::max(parallel, 1)) {
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -250,17 +322,22 @@ TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
 
 TaskId TaskQueue::addTask(std::unique_ptr<Task> &&task) {
 	const auto result = task->id();
+	_added.push_back({ result, ++_batchIdCounter });
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		_tasksToProcess.push_back(std::move(task));
 	}
 
-	wakeThread();
+	wakeThreads();
 
 	return result;
 }
 
 void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
+	const auto batchId = ++_batchIdCounter;
+	for (const auto &task : tasks) {
+		_added.push_back({ task->id(), batchId });
+	}
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		for (auto &task : tasks) {
@@ -268,25 +345,43 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 		}
 	}
 
-	wakeThread();
+	wakeThreads();
 }
 
-void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
+void TaskQueue::wakeThreads() {
+	if (_threads.empty()) {
+		for (auto i = 0; i != _parallel; ++i) {
+			const auto thread = new QThread();
+			const auto worker = new TaskQueueWorker(this);
+			worker->moveToThread(thread);
 
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
+			connect(this, SIGNAL(taskAdded()), worker, SLOT(onTaskAdded()));
+			connect(worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
 
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
-
-		_thread->start();
+			thread->start();
+			_threads.push_back(thread);
+			_workers.push_back(worker);
+		}
 	}
 	if (_stopTimer) _stopTimer->stop();
 	taskAdded();
 }
 
+std::unique_ptr<Task> TaskQueue::takeTaskToProcess() {
+	if (_tasksToProcess.empty()) {
+		return nullptr;
+	}
+	// The first of the cheapest tasks, so equal ones keep their order.
+	const auto i = ranges::min_element(
+		_tasksToProcess,
+		ranges::less(),
+		[](const std::unique_ptr<Task> &task) { return task->cost(); });
+	auto result = std::move(*i);
+	_tasksToProcess.erase(i);
+	_tasksInProcessIds.push_back(result->id());
+	return result;
+}
+
 void TaskQueue::cancelTask(TaskId id) {
 	const auto removeFrom = [&](std::deque<std::unique_ptr<Task>> &queue) {
 		const auto proj = [](const std::unique_ptr<Task> &task) {
@@ -300,12 +395,22 @@ void TaskQueue::cancelTask(TaskId id) {
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
-		}
+		_tasksInProcessIds.erase(
+			ranges::remove(_tasksInProcessIds, id),
+			end(_tasksInProcessIds));
+	}
+	{
+		QMutexLocker lock(&_tasksToFinishMutex);
+		removeFrom(_tasksToFinish);
+	}
+	_processed.remove(id);
+	const auto i = ranges::find(_added, id, &Added::id);
+	if (i != end(_added)) {
+		_added.erase(i);
+
+		// Later tasks of the same batch could wait for this one.
+		finishReady();
 	}
-	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
 }
 
 void TaskQueue::onTaskProcessed() {
@@ -317,29 +422,63 @@ void TaskQueue::onTaskProcessed() {
 			task = std::move(_tasksToFinish.front());
 			_tasksToFinish.pop_front();
 		}
-		task->finish();
+		const auto id = task->id();
+		_processed.emplace(id, std::move(task));
 	} while (true);
 
+	finishReady();
+
 	if (_stopTimer) {
 		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		if (_tasksToProcess.empty() && _tasksInProcessIds.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
+void TaskQueue::finishReady() {
+	auto blocked = base::flat_set<uint64>();
+	auto ready = std::vector<std::unique_ptr<Task>>();
+	for (auto i = begin(_added); i != end(_added);) {
+		const auto j = blocked.contains(i->batchId)
+			? end(_processed)
+			: _processed.find(i->id);
+		if (j != end(_processed)) {
+			ready.push_back(std::move(j->second));
+			_processed.erase(j);
+			i = _added.erase(i);
+		} else {
+			blocked.emplace(i->batchId);
+			++i;
+		}
+	}
+	for (const auto &task : ready) {
+		task->finish();
+	}
+}
+
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
+	for (const auto thread : _threads) {
+		thread->requestInterruption();
+		thread->quit();
+	}
+	if (!_threads.empty()) {
 		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+	}
+	for (const auto thread : _threads) {
+		thread->wait();
+	}
+	for (const auto worker : base::take(_workers)) {
+		delete worker;
+	}
+	for (const auto thread : base::take(_threads)) {
+		delete thread;
 	}
 	_tasksToProcess.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
+	_tasksInProcessIds.clear();
+	_processed.clear();
+	_added.clear();
 }
 
 TaskQueue::~TaskQueue() {
@@ -353,14 +492,11 @@ void TaskQueueWorker::onTaskAdded() {
 
 	bool someTasksLeft = false;
 	do {
+		someTasksLeft = false;
 		auto task = std::unique_ptr<Task>();
 		{
 			QMutexLocker lock(&_queue->_tasksToProcessMutex);
-			if (!_queue->_tasksToProcess.empty()) {
-				task = std::move(_queue->_tasksToProcess.front());
-				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
-			}
+			task = _queue->takeTaskToProcess();
 		}
 
 		if (task) {
@@ -368,9 +504,11 @@ void TaskQueueWorker::onTaskAdded() {
 			bool emitTaskProcessed = false;
 			{
 				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
+				auto &ids = _queue->_tasksInProcessIds;
+				someTasksLeft = !_queue->_tasksToProcess.empty();
+				const auto i = ranges::find(ids, task->id());
+				if (i != end(ids)) {
+					ids.erase(i);
 
 					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
 					emitTaskProcessed = _queue->_tasksToFinish.empty();
@@ -492,6 +630,10 @@ FileLoadTask::FileLoadTask(
 , _caption(caption) {
 	Expects(to.options.scheduled
 		|| (to.replaceMediaOf == 0 || IsServerMsgId(to.replaceMediaOf)));
+
+	_cost = _content.isEmpty()
+		? QFileInfo(_filepath).size()
+		: _content.size();
 }
 
 FileLoadTask::FileLoadTask(
@@ -628,6 +770,7 @@ bool FileLoadTask::CheckForImage(
 		const QString &filepath,
 		const QByteArray &content,
 		std::unique_ptr<Ui::PreparedFileInformation> &result) {
+	auto original = QSize();
 	auto read = [&] {
 		if (filepath.endsWith(qstr(".tgs"), Qt::CaseInsensitive)) {
 			auto image = Lottie::ReadThumbnail(
@@ -640,13 +783,23 @@ bool FileLoadTask::CheckForImage(
 				.image = std::move(image),
 				.animated = success,
 			};
+		} else if (auto reduced = ReadReducedImage(filepath, content)) {
+			original = reduced->original;
+			return Images::ReadResult{
+				.image = std::move(reduced->image),
+			};
 		}
 		return Images::Read({
 			.path = filepath,
 			.content = content,
 		});
 	}();
-	return FillImageInformation(std::move(read.image), read.animated, result);
+	if (!FillImageInformation(std::move(read.image), read.animated, result)) {
+		return false;
+	}
+	v::get<Ui::PreparedFileInformation::Image>(
+		result->media).original = original;
+	return true;
 }
 
 bool FileLoadTask::FillImageInformation(
@@ -684,6 +837,7 @@ void FileLoadTask::process(Args &&args) {
 	auto isSticker = false;
 
 	auto fullimage = QImage();
+	auto fullimageOriginal = QSize();
 	auto info = _filepath.isEmpty() ? QFileInfo() : QFileInfo(_filepath);
 	if (info.exists()) {
 		if (info.isDir()) {
@@ -705,6 +859,7 @@ void FileLoadTask::process(Args &&args) {
 		if (auto image = std::get_if<Ui::PreparedFileInformation::Image>(
 				&_information->media)) {
 			fullimage = base::take(image->data);
+			fullimageOriginal = image->original;
 			if (!Core::IsMimeSticker(filemime)) {
 				fullimage = Images::prepareOpaque(std::move(fullimage));
 			}
@@ -720,6 +875,7 @@ void FileLoadTask::process(Args &&args) {
 				if (auto image = std::get_if<Ui::PreparedFileInformation::Image>(
 						&_information->media)) {
 					fullimage = base::take(image->data);
+					fullimageOriginal = image->original;
 				}
 			}
 			const auto mimeType = Core::MimeTypeForData(_content);
@@ -834,7 +990,12 @@ void FileLoadTask::process(Args &&args) {
 
 	if (!fullimage.isNull() && fullimage.width() > 0 && !isSong && !isVideo && !isVoice) {
 		auto w = fullimage.width(), h = fullimage.height();
-		attributes.push_back(MTP_documentAttributeImageSize(MTP_int(w), MTP_int(h)));
+		const auto original = fullimageOriginal.isValid()
+			? fullimageOriginal
+			: fullimage.size();
+		attributes.push_back(MTP_documentAttributeImageSize(
+			MTP_int(original.width()),
+			MTP_int(original.height())));
 
 		if (ValidateThumbDimensions(w, h)) {
 			isSticker = Core::IsMimeSticker(filemime)
@@ -106,6 +106,11 @@ public:
 	virtual void finish() = 0; // is executed in the same as TaskQueue thread
 	virtual ~Task() = default;
 
+	// Of the waiting tasks the cheapest one is processed first.
+	[[nodiscard]] virtual int64 cost() const {
+		return 0;
+	}
+
 	TaskId id() const {
 		return static_cast<TaskId>(const_cast<Task*>(this));
 	}
@@ -117,7 +122,11 @@ class TaskQueue : public QObject {
 	Q_OBJECT
 
 public:
-	explicit TaskQueue(crl::time stopTimeoutMs = 0); // <= 0 - never stop worker
+	// stopTimeoutMs <= 0 - never stop workers.
+	// Up to 'parallel' tasks are processed at once, each by its own worker.
+	// Tasks added by one addTasks() call are finished in the order they
+	// were added, other tasks are finished as soon as they're processed.
+	explicit TaskQueue(crl::time stopTimeoutMs = 0, int parallel = 1);
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
@@ -135,14 +144,30 @@ public Q_SLOTS:
 private:
 	friend class TaskQueueWorker;
 
-	void wakeThread();
+	struct Added {
+		TaskId id = TaskId();
+		uint64 batchId = 0;
+	};
+
+	void wakeThreads();
+	void finishReady();
+
+	// Should be called with _tasksToProcessMutex locked.
+	[[nodiscard]] std::unique_ptr<Task> takeTaskToProcess();
 
 	std::deque<std::unique_ptr<Task>> _tasksToProcess;
 	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
+	std::vector<TaskId> _tasksInProcessIds;
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
+
+	// Accessed only from the TaskQueue thread.
+	std::vector<Added> _added;
+	base::flat_map<TaskId, std::unique_ptr<Task>> _processed;
+	uint64 _batchIdCounter = 0;
+
+	int _parallel = 1;
+	std::vector<QThread*> _threads;
+	std::vector<TaskQueueWorker*> _workers;
 	QTimer *_stopTimer = nullptr;
 
 };
@@ -297,6 +322,9 @@ public:
 		process({});
 	}
 	void finish() override;
+	int64 cost() const override {
+		return _cost;
+	}
 
 	FileLoadResult *peekResult() const;
 
@@ -334,5 +362,6 @@ private:
 	TextWithTags _caption;
 
 	std::shared_ptr<FileLoadResult> _result;
+	int64 _cost = 0;
 
 };
@@ -81,45 +81,22 @@ DocumentData *Document::readFromStreamHelper(
 	stream >> width >> height;
 	stream >> type;
 
-	QVector<MTPDocumentAttribute> attributes;
-	if (!name.isEmpty()) {
-		attributes.push_back(MTP_documentAttributeFilename(MTP_string(name)));
-	}
-
+	QString alt;
+	qint32 typeOfSet = StickerSetTypeEmpty;
 	qint32 duration = -1;
 	if (type == StickerDocument) {
-		QString alt;
-		qint32 typeOfSet;
 		stream >> alt >> typeOfSet;
-		if (typeOfSet == StickerSetTypeEmpty) {
-			attributes.push_back(MTP_documentAttributeSticker(MTP_flags(0), MTP_string(alt), MTP_inputStickerSetEmpty(), MTPMaskCoords()));
-		} else if (info) {
-			if (info->setId == Data::Stickers::DefaultSetId
+		if (typeOfSet != StickerSetTypeEmpty
+			&& info
+			&& (info->setId == Data::Stickers::DefaultSetId
 				|| info->setId == Data::Stickers::CloudRecentSetId
 				|| info->setId == Data::Stickers::CloudRecentAttachedSetId
 				|| info->setId == Data::Stickers::FavedSetId
-				|| info->setId == Data::Stickers::CustomSetId) {
-				typeOfSet = StickerSetTypeEmpty;
-			}
-
-			switch (typeOfSet) {
-			case StickerSetTypeID: {
-				attributes.push_back(MTP_documentAttributeSticker(MTP_flags(0), MTP_string(alt), MTP_inputStickerSetID(MTP_long(info->setId), MTP_long(info->accessHash)), MTPMaskCoords()));
-			} break;
-			case StickerSetTypeShortName: {
-				attributes.push_back(MTP_documentAttributeSticker(MTP_flags(0), MTP_string(alt), MTP_inputStickerSetShortName(MTP_string(info->shortName)), MTPMaskCoords()));
-			} break;
-			case StickerSetTypeEmpty:
-			default: {
-				attributes.push_back(MTP_documentAttributeSticker(MTP_flags(0), MTP_string(alt), MTP_inputStickerSetEmpty(), MTPMaskCoords()));
-			} break;
-			}
+				|| info->setId == Data::Stickers::CustomSetId)) {
+			typeOfSet = StickerSetTypeEmpty;
 		}
 	} else {
 		stream >> duration;
-		if (type == AnimatedDocument) {
-			attributes.push_back(MTP_documentAttributeAnimated());
-		}
 	}
 	std::optional<ImageLocation> videoThumb;
 	qint32 thumbnailByteSize = 0, videoThumbnailByteSize = 0;
@@ -136,17 +113,6 @@ DocumentData *Document::readFromStreamHelper(
 	} else {
 		videoThumb = ImageLocation();
 	}
-	if (width > 0 && height > 0) {
-		if (duration >= 0) {
-			auto flags = MTPDdocumentAttributeVideo::Flags(0);
-			if (type == RoundVideoDocument) {
-				flags |= MTPDdocumentAttributeVideo::Flag::f_round_message;
-			}
-			attributes.push_back(MTP_documentAttributeVideo(MTP_flags(flags), MTP_int(duration), MTP_int(width), MTP_int(height)));
-		} else {
-			attributes.push_back(MTP_documentAttributeImageSize(MTP_int(width), MTP_int(height)));
-		}
-	}
 
 	const auto storage = std::get_if<StorageFileLocation>(
 		&thumb->file().data);
@@ -161,6 +127,56 @@ DocumentData *Document::readFromStreamHelper(
 		// size letter ('s' or 'm') is lost, it was not saved in legacy.
 		return nullptr;
 	}
+
+	// The same document is often stored in several lists, like installed,
+	// recent and faved stickers, don't rebuild it from the attributes.
+	if (const auto existing = session->data().documentLoaded(id)) {
+		const auto sticker = existing->sticker();
+		if (existing->date == date
+			&& existing->type == DocumentType(type)
+			&& (type != StickerDocument
+				|| (sticker
+					&& (typeOfSet == StickerSetTypeEmpty
+						|| !info
+						|| sticker->set)))) {
+			return existing;
+		}
+	}
+
+	QVector<MTPDocumentAttribute> attributes;
+	if (!name.isEmpty()) {
+		attributes.push_back(MTP_documentAttributeFilename(MTP_string(name)));
+	}
+	if (type == StickerDocument) {
+		if (typeOfSet == StickerSetTypeEmpty) {
+			attributes.push_back(MTP_documentAttributeSticker(MTP_flags(0), MTP_string(alt), MTP_inputStickerSetEmpty(), MTPMaskCoords()));
+		} else if (info) {
+			switch (typeOfSet) {
+			case StickerSetTypeID: {
+				attributes.push_back(MTP_documentAttributeSticker(MTP_flags(0), MTP_string(alt), MTP_inputStickerSetID(MTP_long(info->setId), MTP_long(info->accessHash)), MTPMaskCoords()));
+			} break;
+			case StickerSetTypeShortName: {
+				attributes.push_back(MTP_documentAttributeSticker(MTP_flags(0), MTP_string(alt), MTP_inputStickerSetShortName(MTP_string(info->shortName)), MTPMaskCoords()));
+			} break;
+			default: {
+				attributes.push_back(MTP_documentAttributeSticker(MTP_flags(0), MTP_string(alt), MTP_inputStickerSetEmpty(), MTPMaskCoords()));
+			} break;
+			}
+		}
+	} else if (type == AnimatedDocument) {
+		attributes.push_back(MTP_documentAttributeAnimated());
+	}
+	if (width > 0 && height > 0) {
+		if (duration >= 0) {
+			auto flags = MTPDdocumentAttributeVideo::Flags(0);
+			if (type == RoundVideoDocument) {
+				flags |= MTPDdocumentAttributeVideo::Flag::f_round_message;
+			}
+			attributes.push_back(MTP_documentAttributeVideo(MTP_flags(flags), MTP_int(duration), MTP_int(width), MTP_int(height)));
+		} else {
+			attributes.push_back(MTP_documentAttributeImageSize(MTP_int(width), MTP_int(height)));
+		}
+	}
 	return session->data().document(
 		id,
 		access,
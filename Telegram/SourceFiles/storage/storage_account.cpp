@@ -25,6 +25,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "core/application.h"
 #include "core/file_location.h"
+#include "core/startup_phases.h"
 #include "data/stickers/data_stickers.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
@@ -40,6 +41,10 @@ using namespace details;
 using Database = Cache::Database;
 
 constexpr auto kDelayedWriteTimeout = crl::time(1000);
+constexpr auto kMinLocationsJournalSize = 64 * 1024;
+
+// Prune stale entries not right after each write, but once it settles.
+constexpr auto kCachePruneTimeout = 60 * crl::time(1000);
 
 constexpr auto kStickersVersionTag = quint32(-1);
 constexpr auto kStickersSerializeVersion = 2;
@@ -119,8 +124,141 @@ auto EmptyMessageDraftSources()
 	return cWorkingDir() + qsl("tdata/tdld/");
 }
 
+struct LocationsData {
+	QMultiMap<MediaKey, Core::FileLocation> locations;
+	QMap<QString, QPair<MediaKey, Core::FileLocation>> pairs;
+	QMap<MediaKey, MediaKey> aliases;
+	std::vector<FileKey> obsoleteKeys;
+	int snapshotSize = 0;
+	int journalSize = 0;
+};
+
+bool ReadLocationsSnapshot(
+		LocationsData &result,
+		FileKey fileKey,
+		const QString &basePath,
+		const MTP::AuthKeyPtr &localKey) {
+	FileReadDescriptor locations;
+	if (!ReadEncryptedFile(locations, fileKey, basePath, localKey)) {
+		return false;
+	}
+	result.snapshotSize = locations.data.size();
+
+	bool endMarkFound = false;
+	while (!locations.stream.atEnd()) {
+		quint64 first, second;
+		QByteArray bookmark;
+		Core::FileLocation loc;
+		quint32 legacyTypeField = 0;
+		locations.stream >> first >> second >> legacyTypeField >> loc.fname;
+		if (locations.version > 9013) {
+			locations.stream >> bookmark;
+		}
+		locations.stream >> loc.modified >> loc.size;
+		loc.setBookmark(bookmark);
+
+		if (!first && !second && !legacyTypeField && loc.fname.isEmpty() && !loc.size) { // end mark
+			endMarkFound = true;
+			break;
+		}
+
+		MediaKey key(first, second);
+
+		result.locations.insert(key, loc);
+		if (!loc.inMediaCache()) {
+			result.pairs.insert(loc.fname, { key, loc });
+		}
+	}
+
+	if (endMarkFound) {
+		quint32 cnt;
+		locations.stream >> cnt;
+		for (quint32 i = 0; i < cnt; ++i) {
+			quint64 kfirst, ksecond, vfirst, vsecond;
+			locations.stream >> kfirst >> ksecond >> vfirst >> vsecond;
+			result.aliases.insert(MediaKey(kfirst, ksecond), MediaKey(vfirst, vsecond));
+		}
+
+		if (!locations.stream.atEnd()) {
+			quint32 webLocationsCount;
+			locations.stream >> webLocationsCount;
+			for (quint32 i = 0; i < webLocationsCount; ++i) {
+				QString url;
+				quint64 key;
+				qint32 size;
+				locations.stream >> url >> key >> size;
+				result.obsoleteKeys.push_back(key);
+			}
+		}
+	}
+	return true;
+}
+
+void ReadLocationsJournal(
+		LocationsData &result,
+		FileKey fileKey,
+		const QString &basePath,
+		const MTP::AuthKeyPtr &localKey) {
+	const auto records = ReadJournal(ToFilePart(fileKey), basePath);
+	if (records.empty()) {
+		return;
+	}
+	for (const auto &record : records) {
+		EncryptedDescriptor data;
+		if (!DecryptLocal(data, record, localKey)) {
+			break;
+		}
+		quint32 count = 0;
+		data.stream >> count;
+		for (quint32 i = 0; i != count; ++i) {
+			quint64 first = 0, second = 0;
+			quint32 locationsCount = 0;
+			data.stream >> first >> second >> locationsCount;
+			const auto key = MediaKey(first, second);
+			auto locations = std::vector<Core::FileLocation>();
+			for (quint32 j = 0; j != locationsCount; ++j) {
+				QByteArray bookmark;
+				Core::FileLocation loc;
+				data.stream >> loc.fname >> bookmark >> loc.modified >> loc.size;
+				loc.setBookmark(bookmark);
+				locations.push_back(std::move(loc));
+			}
+			result.locations.remove(key);
+
+			// QMultiMap::find() returns the latest inserted value first.
+			for (const auto &loc : ranges::views::reverse(locations)) {
+				result.locations.insert(key, loc);
+			}
+		}
+		data.stream >> count;
+		for (quint32 i = 0; i != count; ++i) {
+			quint64 kfirst, ksecond, vfirst, vsecond;
+			data.stream >> kfirst >> ksecond >> vfirst >> vsecond;
+			result.aliases.insert(MediaKey(kfirst, ksecond), MediaKey(vfirst, vsecond));
+		}
+		if (!CheckStreamStatus(data.stream)) {
+			break;
+		}
+		result.journalSize += record.size();
+	}
+
+	result.pairs.clear();
+	const auto &locations = result.locations;
+	for (auto i = locations.cbegin(), e = locations.cend(); i != e; ++i) {
+		if (!i.value().inMediaCache()) {
+			result.pairs.insert(i.value().fname, { i.key(), i.value() });
+		}
+	}
+}
+
 } // namespace
 
+struct Account::LocationsRead {
+	LocationsData data;
+	crl::semaphore ready;
+	bool failed = false;
+};
+
 Account::Account(not_null<Main::Account*> owner, const QString &dataName)
 : _owner(owner)
 , _dataName(dataName)
@@ -133,10 +271,13 @@ Account::Account(not_null<Main::Account*> owner, const QString &dataName)
 , _cacheTotalTimeLimit(Database::Settings().totalTimeLimit)
 , _cacheBigFileTotalTimeLimit(Database::Settings().totalTimeLimit)
 , _writeMapTimer([=] { writeMap(); })
-, _writeLocationsTimer([=] { writeLocations(); }) {
+, _writeLocationsTimer([=] { writeLocations(); })
+, _writeStickersTimer([=] { writePendingStickers(); })
+, _writeDraftsTimer([=] { writePendingDraftFiles(); }) {
 }
 
 Account::~Account() {
+	writePendingDraftFiles();
 	if (_localKey && _mapChanged) {
 		writeMap();
 	}
@@ -160,6 +301,7 @@ StartResult Account::legacyStart(const QByteArray &passcode) {
 std::unique_ptr<MTP::Config> Account::start(MTP::AuthKeyPtr localKey) {
 	Expects(localKey != nullptr);
 
+	const auto phase = Core::StartupPhases::Phase("account_storage_start");
 	_localKey = std::move(localKey);
 	readMapWith(_localKey);
 	clearLegacyFiles();
@@ -229,6 +371,9 @@ base::flat_set<QString> Account::collectGoodNames() const {
 	for (const auto &value : keys) {
 		push(value);
 	}
+	if (_locationsKey) {
+		result.emplace(ToFilePart(_locationsKey) + 'j');
+	}
 	return result;
 }
 
@@ -578,6 +723,8 @@ void Account::writeMap() {
 
 void Account::reset() {
 	auto names = collectGoodNames();
+	_draftFileWrites.clear();
+	_writeDraftsTimer.cancel();
 	_draftsMap.clear();
 	_draftCursorsMap.clear();
 	_draftsNotReadMap.clear();
@@ -598,6 +745,12 @@ void Account::reset() {
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
 	_fileLocationAliases.clear();
+	_fileLocationsChanged.clear();
+	_fileLocationAliasesChanged.clear();
+	_locationsSnapshotSize = _locationsJournalSize = 0;
+	_locationsRead = nullptr;
+	_stickersChanged = StickersWrites();
+	_writeStickersTimer.cancel();
 	_cacheTotalSizeLimit = Database::Settings().totalSizeLimit;
 	_cacheTotalTimeLimit = Database::Settings().totalTimeLimit;
 	_cacheBigFileTotalSizeLimit = Database::Settings().totalSizeLimit;
@@ -624,15 +777,37 @@ void Account::reset() {
 
 void Account::writeLocations() {
 	_writeLocationsTimer.cancel();
+	finishReadingLocations();
 	if (!_locationsChanged) {
 		return;
 	}
 	_locationsChanged = false;
 
+	// Every downloaded file changes the locations, so instead of rewriting
+	// all of them we append the changed ones to a journal and rewrite the
+	// snapshot only when the journal grows bigger than the snapshot itself.
+	const auto compact = _fileLocations.isEmpty()
+		|| !_locationsKey
+		|| (_locationsJournalSize
+			> std::max(_locationsSnapshotSize, kMinLocationsJournalSize));
+	if (compact) {
+		writeLocationsSnapshot();
+	} else {
+		writeLocationsJournal();
+	}
+}
+
+void Account::writeLocationsSnapshot() {
+	_fileLocationsChanged.clear();
+	_fileLocationAliasesChanged.clear();
+	_locationsJournalSize = 0;
+
 	if (_fileLocations.isEmpty()) {
 		if (_locationsKey) {
 			ClearKey(_locationsKey, _basePath);
+			ClearJournal(ToFilePart(_locationsKey), _basePath);
 			_locationsKey = 0;
+			_locationsSnapshotSize = 0;
 			writeMapDelayed();
 		}
 	} else {
@@ -686,11 +861,66 @@ void Account::writeLocations() {
 			data.stream << quint64(i.key().first) << quint64(i.key().second) << quint64(i.value().first) << quint64(i.value().second);
 		}
 
-		FileWriteDescriptor file(_locationsKey, _basePath);
-		file.writeEncrypted(data, _localKey);
+		_locationsSnapshotSize = data.data.size();
+		{
+			FileWriteDescriptor file(_locationsKey, _basePath);
+			file.writeEncrypted(data, _localKey);
+		}
+		ClearJournal(ToFilePart(_locationsKey), _basePath);
+	}
+}
+
+void Account::writeLocationsJournal() {
+	if (_fileLocationsChanged.empty() && _fileLocationAliasesChanged.empty()) {
+		return;
+	}
+	quint32 size = sizeof(quint32) * 2;
+	for (const auto &key : _fileLocationsChanged) {
+		size += sizeof(quint64) * 2 + sizeof(quint32);
+		for (auto i = _fileLocations.find(key), e = _fileLocations.end(); (i != e) && (i.key() == key); ++i) {
+			size += Serialize::stringSize(i.value().name())
+				+ Serialize::bytearraySize(i.value().bookmark())
+				+ Serialize::dateTimeSize()
+				+ sizeof(quint32);
+		}
+	}
+	size += _fileLocationAliasesChanged.size() * sizeof(quint64) * 4;
+
+	EncryptedDescriptor data(size);
+	data.stream << quint32(_fileLocationsChanged.size());
+	for (const auto &key : base::take(_fileLocationsChanged)) {
+		auto locations = std::vector<Core::FileLocation>();
+		for (auto i = _fileLocations.find(key), e = _fileLocations.end(); (i != e) && (i.key() == key); ++i) {
+			locations.push_back(i.value());
+		}
+		data.stream
+			<< quint64(key.first)
+			<< quint64(key.second)
+			<< quint32(locations.size());
+		for (const auto &location : locations) {
+			data.stream
+				<< location.name()
+				<< location.bookmark()
+				<< location.modified
+				<< quint32(location.size);
+		}
+	}
+	data.stream << quint32(_fileLocationAliasesChanged.size());
+	for (const auto &key : base::take(_fileLocationAliasesChanged)) {
+		const auto value = _fileLocationAliases.value(key);
+		data.stream
+			<< quint64(key.first)
+			<< quint64(key.second)
+			<< quint64(value.first)
+			<< quint64(value.second);
 	}
+
+	const auto record = PrepareEncrypted(data, _localKey);
+	_locationsJournalSize += record.size();
+	AppendJournal(ToFilePart(_locationsKey), _basePath, record);
 }
 
+
 void Account::writeLocationsQueued() {
 	_locationsChanged = true;
 	crl::on_main(_owner, [=] {
@@ -704,61 +934,49 @@ void Account::writeLocationsDelayed() {
 }
 
 void Account::readLocations() {
-	FileReadDescriptor locations;
-	if (!ReadEncryptedFile(locations, _locationsKey, _basePath, _localKey)) {
+	Expects(_locationsKey != 0);
+
+	// Big locations maps take a while to decrypt and parse, so we do it
+	// in the background and wait for the result only if it is required
+	// before it arrives.
+	const auto read = std::make_shared<LocationsRead>();
+	_locationsRead = read;
+	crl::async([=, key = _locationsKey, base = _basePath, local = _localKey] {
+		read->failed = !ReadLocationsSnapshot(read->data, key, base, local);
+		if (!read->failed) {
+			ReadLocationsJournal(read->data, key, base, local);
+		}
+		read->ready.release();
+		crl::on_main(_owner, [=] {
+			if (_locationsRead == read) {
+				finishReadingLocations();
+			}
+		});
+	});
+}
+
+void Account::finishReadingLocations() {
+	const auto read = base::take(_locationsRead);
+	if (!read) {
+		return;
+	}
+	read->ready.acquire();
+	if (read->failed) {
 		ClearKey(_locationsKey, _basePath);
+		ClearJournal(ToFilePart(_locationsKey), _basePath);
 		_locationsKey = 0;
 		writeMapDelayed();
 		return;
 	}
-
-	bool endMarkFound = false;
-	while (!locations.stream.atEnd()) {
-		quint64 first, second;
-		QByteArray bookmark;
-		Core::FileLocation loc;
-		quint32 legacyTypeField = 0;
-		locations.stream >> first >> second >> legacyTypeField >> loc.fname;
-		if (locations.version > 9013) {
-			locations.stream >> bookmark;
-		}
-		locations.stream >> loc.modified >> loc.size;
-		loc.setBookmark(bookmark);
-
-		if (!first && !second && !legacyTypeField && loc.fname.isEmpty() && !loc.size) { // end mark
-			endMarkFound = true;
-			break;
-		}
-
-		MediaKey key(first, second);
-
-		_fileLocations.insert(key, loc);
-		if (!loc.inMediaCache()) {
-			_fileLocationPairs.insert(loc.fname, { key, loc });
-		}
-	}
-
-	if (endMarkFound) {
-		quint32 cnt;
-		locations.stream >> cnt;
-		for (quint32 i = 0; i < cnt; ++i) {
-			quint64 kfirst, ksecond, vfirst, vsecond;
-			locations.stream >> kfirst >> ksecond >> vfirst >> vsecond;
-			_fileLocationAliases.insert(MediaKey(kfirst, ksecond), MediaKey(vfirst, vsecond));
-		}
-
-		if (!locations.stream.atEnd()) {
-			quint32 webLocationsCount;
-			locations.stream >> webLocationsCount;
-			for (quint32 i = 0; i < webLocationsCount; ++i) {
-				QString url;
-				quint64 key;
-				qint32 size;
-				locations.stream >> url >> key >> size;
-				ClearKey(key, _basePath);
-			}
-		}
+	auto &data = read->data;
+	for (const auto key : data.obsoleteKeys) {
+		ClearKey(key, _basePath);
 	}
+	_fileLocations = std::move(data.locations);
+	_fileLocationPairs = std::move(data.pairs);
+	_fileLocationAliases = std::move(data.aliases);
+	_locationsSnapshotSize = data.snapshotSize;
+	_locationsJournalSize = data.journalSize;
 }
 
 void Account::writeSessionSettings() {
@@ -1048,6 +1266,7 @@ void Account::writeDrafts(not_null<History*> history) {
 	if (!count) {
 		auto i = _draftsMap.find(peerId);
 		if (i != _draftsMap.cend()) {
+			_draftFileWrites.remove(i->second);
 			ClearKey(i->second, _basePath);
 			_draftsMap.erase(i);
 			writeMapDelayed();
@@ -1082,8 +1301,8 @@ void Account::writeDrafts(not_null<History*> history) {
 		sources,
 		sizeCallback);
 
-	EncryptedDescriptor data(size);
-	data.stream
+	auto data = std::make_unique<EncryptedDescriptor>(size);
+	data->stream
 		<< quint64(kMultiDraftTag)
 		<< SerializePeerId(peerId)
 		<< quint32(count);
@@ -1094,7 +1313,7 @@ void Account::writeDrafts(not_null<History*> history) {
 			const TextWithTags &text,
 			Data::PreviewState previewState,
 			auto&&) { // cursor
-		data.stream
+		data->stream
 			<< key.serialize()
 			<< text.text
 			<< TextUtilities::SerializeTags(text.tags)
@@ -1108,8 +1327,7 @@ void Account::writeDrafts(not_null<History*> history) {
 		sources,
 		writeCallback);
 
-	FileWriteDescriptor file(i->second, _basePath);
-	file.writeEncrypted(data, _localKey);
+	writeDraftFileDelayed(i->second, std::move(data));
 
 	_draftsNotReadMap.remove(peerId);
 }
@@ -1147,8 +1365,8 @@ void Account::writeDraftCursors(not_null<History*> history) {
 		+ sizeof(quint32)
 		+ (sizeof(qint64) + sizeof(qint32) * 3) * count);
 
-	EncryptedDescriptor data(size);
-	data.stream
+	auto data = std::make_unique<EncryptedDescriptor>(size);
+	data->stream
 		<< quint64(kMultiDraftCursorsTag)
 		<< SerializePeerId(peerId)
 		<< quint32(count);
@@ -1159,7 +1377,7 @@ void Account::writeDraftCursors(not_null<History*> history) {
 			auto&&, // text
 			Data::PreviewState,
 			const MessageCursor &cursor) { // cursor
-		data.stream
+		data->stream
 			<< key.serialize()
 			<< qint32(cursor.position)
 			<< qint32(cursor.anchor)
@@ -1172,13 +1390,34 @@ void Account::writeDraftCursors(not_null<History*> history) {
 		sources,
 		writeCallback);
 
-	FileWriteDescriptor file(i->second, _basePath);
-	file.writeEncrypted(data, _localKey);
+	writeDraftFileDelayed(i->second, std::move(data));
+}
+
+void Account::writeDraftFileDelayed(
+		FileKey key,
+		std::unique_ptr<EncryptedDescriptor> data) {
+	_draftFileWrites[key] = std::move(data);
+	if (!_writeDraftsTimer.isActive()) {
+		_writeDraftsTimer.callOnce(kDelayedWriteTimeout);
+	}
+}
+
+void Account::writePendingDraftFiles() {
+	_writeDraftsTimer.cancel();
+	if (!_localKey) {
+		_draftFileWrites.clear();
+		return;
+	}
+	for (const auto &[key, data] : base::take(_draftFileWrites)) {
+		FileWriteDescriptor file(key, _basePath);
+		file.writeEncrypted(*data, _localKey);
+	}
 }
 
 void Account::clearDraftCursors(PeerId peerId) {
 	const auto i = _draftCursorsMap.find(peerId);
 	if (i != _draftCursorsMap.cend()) {
+		_draftFileWrites.remove(i->second);
 		ClearKey(i->second, _basePath);
 		_draftCursorsMap.erase(i);
 		writeMapDelayed();
@@ -1436,6 +1675,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 	if (local.fname.isEmpty()) {
 		return;
 	}
+	finishReadingLocations();
 	if (!local.inMediaCache()) {
 		const auto aliasIt = _fileLocationAliases.constFind(location);
 		if (aliasIt != _fileLocationAliases.cend()) {
@@ -1447,6 +1687,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 			if (i.value().second == local) {
 				if (i.value().first != location) {
 					_fileLocationAliases.insert(location, i.value().first);
+					_fileLocationAliasesChanged.emplace(location);
 					writeLocationsQueued();
 				}
 				return;
@@ -1458,6 +1699,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 						break;
 					}
 				}
+				_fileLocationsChanged.emplace(i.value().first);
 				_fileLocationPairs.erase(i);
 			}
 		}
@@ -1471,10 +1713,12 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 		}
 	}
 	_fileLocations.insert(location, local);
+	_fileLocationsChanged.emplace(location);
 	writeLocationsQueued();
 }
 
 void Account::removeFileLocation(MediaKey location) {
+	finishReadingLocations();
 	auto i = _fileLocations.find(location);
 	if (i == _fileLocations.end()) {
 		return;
@@ -1482,10 +1726,12 @@ void Account::removeFileLocation(MediaKey location) {
 	while (i != _fileLocations.end() && (i.key() == location)) {
 		i = _fileLocations.erase(i);
 	}
+	_fileLocationsChanged.emplace(location);
 	writeLocationsQueued();
 }
 
 Core::FileLocation Account::readFileLocation(MediaKey location) {
+	finishReadingLocations();
 	const auto aliasIt = _fileLocationAliases.constFind(location);
 	if (aliasIt != _fileLocationAliases.cend()) {
 		location = aliasIt.value();
@@ -1495,6 +1741,7 @@ Core::FileLocation Account::readFileLocation(MediaKey location) {
 		if (!i.value().inMediaCache() && !i.value().check()) {
 			_fileLocationPairs.remove(i.value().fname);
 			i = _fileLocations.erase(i);
+			_fileLocationsChanged.emplace(location);
 			writeLocationsDelayed();
 			continue;
 		}
@@ -1525,6 +1772,7 @@ Cache::Database::Settings Account::cacheSettings() const {
 	result.totalSizeLimit = _cacheTotalSizeLimit;
 	result.totalTimeLimit = _cacheTotalTimeLimit;
 	result.maxDataSize = kMaxFileInMemory;
+	result.pruneTimeout = kCachePruneTimeout;
 	return result;
 }
 
@@ -1561,6 +1809,7 @@ Cache::Database::Settings Account::cacheBigFileSettings() const {
 	result.totalSizeLimit = _cacheBigFileTotalSizeLimit;
 	result.totalTimeLimit = _cacheBigFileTotalTimeLimit;
 	result.maxDataSize = kMaxFileInMemory;
+	result.pruneTimeout = kCachePruneTimeout;
 	return result;
 }
 
@@ -1944,6 +2193,75 @@ void Account::readStickerSets(
 }
 
 void Account::writeInstalledStickers() {
+	writeStickersDelayed(StickersWrite::Installed);
+}
+
+void Account::writeFeaturedStickers() {
+	writeStickersDelayed(StickersWrite::Featured);
+}
+
+void Account::writeRecentStickers() {
+	writeStickersDelayed(StickersWrite::Recent);
+}
+
+void Account::writeFavedStickers() {
+	writeStickersDelayed(StickersWrite::Faved);
+}
+
+void Account::writeArchivedStickers() {
+	writeStickersDelayed(StickersWrite::Archived);
+}
+
+void Account::writeArchivedMasks() {
+	writeStickersDelayed(StickersWrite::ArchivedMasks);
+}
+
+void Account::writeInstalledMasks() {
+	writeStickersDelayed(StickersWrite::InstalledMasks);
+}
+
+void Account::writeRecentMasks() {
+	writeStickersDelayed(StickersWrite::RecentMasks);
+}
+
+void Account::writeStickersDelayed(StickersWrite what) {
+	_stickersChanged |= what;
+	_writeStickersTimer.callOnce(kDelayedWriteTimeout);
+}
+
+void Account::writePendingStickers() {
+	_writeStickersTimer.cancel();
+	const auto changed = base::take(_stickersChanged);
+	if (!changed || !_localKey || !_owner->sessionExists()) {
+		return;
+	}
+	if (changed & StickersWrite::Installed) {
+		writeInstalledStickersNow();
+	}
+	if (changed & StickersWrite::Featured) {
+		writeFeaturedStickersNow();
+	}
+	if (changed & StickersWrite::Recent) {
+		writeRecentStickersNow();
+	}
+	if (changed & StickersWrite::Faved) {
+		writeFavedStickersNow();
+	}
+	if (changed & StickersWrite::Archived) {
+		writeArchivedStickersNow();
+	}
+	if (changed & StickersWrite::ArchivedMasks) {
+		writeArchivedMasksNow();
+	}
+	if (changed & StickersWrite::InstalledMasks) {
+		writeInstalledMasksNow();
+	}
+	if (changed & StickersWrite::RecentMasks) {
+		writeRecentMasksNow();
+	}
+}
+
+void Account::writeInstalledStickersNow() {
 	using SetFlag = Data::StickersSetFlag;
 
 	writeStickerSets(_installedStickersKey, [](const Data::StickersSet &set) {
@@ -1971,7 +2289,7 @@ void Account::writeInstalledStickers() {
 	}, _owner->session().data().stickers().setsOrder());
 }
 
-void Account::writeFeaturedStickers() {
+void Account::writeFeaturedStickersNow() {
 	using SetFlag = Data::StickersSetFlag;
 
 	writeStickerSets(_featuredStickersKey, [](const Data::StickersSet &set) {
@@ -1993,7 +2311,7 @@ void Account::writeFeaturedStickers() {
 	}, _owner->session().data().stickers().featuredSetsOrder());
 }
 
-void Account::writeRecentStickers() {
+void Account::writeRecentStickersNow() {
 	writeStickerSets(_recentStickersKey, [](const Data::StickersSet &set) {
 		if (set.id != Data::Stickers::CloudRecentSetId
 			|| set.stickers.isEmpty()) {
@@ -2003,7 +2321,7 @@ void Account::writeRecentStickers() {
 	}, Data::StickersSetsOrder());
 }
 
-void Account::writeFavedStickers() {
+void Account::writeFavedStickersNow() {
 	writeStickerSets(_favedStickersKey, [](const Data::StickersSet &set) {
 		if (set.id != Data::Stickers::FavedSetId || set.stickers.isEmpty()) {
 			return StickerSetCheckResult::Skip;
@@ -2012,7 +2330,7 @@ void Account::writeFavedStickers() {
 	}, Data::StickersSetsOrder());
 }
 
-void Account::writeArchivedStickers() {
+void Account::writeArchivedStickersNow() {
 	using SetFlag = Data::StickersSetFlag;
 
 	writeStickerSets(_archivedStickersKey, [](const Data::StickersSet &set) {
@@ -2027,10 +2345,10 @@ void Account::writeArchivedStickers() {
 	}, _owner->session().data().stickers().archivedSetsOrder());
 }
 
-void Account::writeArchivedMasks() {
+void Account::writeArchivedMasksNow() {
 	using SetFlag = Data::StickersSetFlag;
 
-	writeStickerSets(_archivedStickersKey, [](const Data::StickersSet &set) {
+	writeStickerSets(_archivedMasksKey, [](const Data::StickersSet &set) {
 		if (!(set.flags & SetFlag::Masks)) {
 			return StickerSetCheckResult::Skip;
 		}
@@ -2041,7 +2359,7 @@ void Account::writeArchivedMasks() {
 	}, _owner->session().data().stickers().archivedMaskSetsOrder());
 }
 
-void Account::writeInstalledMasks() {
+void Account::writeInstalledMasksNow() {
 	using SetFlag = Data::StickersSetFlag;
 
 	writeStickerSets(_installedMasksKey, [](const Data::StickersSet &set) {
@@ -2052,7 +2370,7 @@ void Account::writeInstalledMasks() {
 	}, _owner->session().data().stickers().maskSetsOrder());
 }
 
-void Account::writeRecentMasks() {
+void Account::writeRecentMasksNow() {
 	writeStickerSets(_recentMasksKey, [](const Data::StickersSet &set) {
 		if (set.id != Data::Stickers::CloudRecentAttachedSetId
 			|| set.stickers.isEmpty()) {
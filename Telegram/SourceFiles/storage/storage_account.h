@@ -42,6 +42,7 @@ namespace Storage {
 namespace details {
 struct ReadSettingsContext;
 struct FileReadDescriptor;
+struct EncryptedDescriptor;
 } // namespace details
 
 class EncryptionKey;
@@ -130,6 +131,7 @@ public:
 	void writeRecentMasks();
 	void readInstalledMasks();
 	void readRecentMasks();
+	void writePendingStickers();
 
 	void writeRecentHashtagsAndBots();
 	void readRecentHashtagsAndBots();
@@ -190,8 +192,20 @@ private:
 	void writeMapQueued();
 	void writeMap();
 
+	// Draft files are written in batches, only the last data is kept
+	// for each file if it was changed a few times in between.
+	void writeDraftFileDelayed(
+		FileKey key,
+		std::unique_ptr<details::EncryptedDescriptor> data);
+	void writePendingDraftFiles();
+
+	struct LocationsRead;
+
 	void readLocations();
+	void finishReadingLocations();
 	void writeLocations();
+	void writeLocationsSnapshot();
+	void writeLocationsJournal();
 	void writeLocationsQueued();
 	void writeLocationsDelayed();
 
@@ -215,6 +229,29 @@ private:
 		details::FileReadDescriptor &draft,
 		quint64 draftPeerSerialized);
 
+	enum class StickersWrite : uchar {
+		Installed = (1 << 0),
+		Featured = (1 << 1),
+		Recent = (1 << 2),
+		Faved = (1 << 3),
+		Archived = (1 << 4),
+		ArchivedMasks = (1 << 5),
+		InstalledMasks = (1 << 6),
+		RecentMasks = (1 << 7),
+	};
+	friend inline constexpr bool is_flag_type(StickersWrite) { return true; };
+	using StickersWrites = base::flags<StickersWrite>;
+
+	void writeStickersDelayed(StickersWrite what);
+	void writeInstalledStickersNow();
+	void writeFeaturedStickersNow();
+	void writeRecentStickersNow();
+	void writeFavedStickersNow();
+	void writeArchivedStickersNow();
+	void writeArchivedMasksNow();
+	void writeInstalledMasksNow();
+	void writeRecentMasksNow();
+
 	void writeStickerSet(
 		QDataStream &stream,
 		const Data::StickersSet &set);
@@ -255,6 +292,11 @@ private:
 	QMultiMap<MediaKey, Core::FileLocation> _fileLocations;
 	QMap<QString, QPair<MediaKey, Core::FileLocation>> _fileLocationPairs;
 	QMap<MediaKey, MediaKey> _fileLocationAliases;
+	base::flat_set<MediaKey> _fileLocationsChanged;
+	base::flat_set<MediaKey> _fileLocationAliasesChanged;
+	int _locationsSnapshotSize = 0;
+	int _locationsJournalSize = 0;
+	std::shared_ptr<LocationsRead> _locationsRead;
 
 	FileKey _locationsKey = 0;
 	FileKey _trustedBotsKey = 0;
@@ -288,8 +330,14 @@ private:
 
 	base::Timer _writeMapTimer;
 	base::Timer _writeLocationsTimer;
+	base::Timer _writeStickersTimer;
+	base::Timer _writeDraftsTimer;
+	base::flat_map<
+		FileKey,
+		std::unique_ptr<details::EncryptedDescriptor>> _draftFileWrites;
 	bool _mapChanged = false;
 	bool _locationsChanged = false;
+	StickersWrites _stickersChanged;
 
 };
 
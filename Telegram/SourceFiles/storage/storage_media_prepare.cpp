@@ -59,11 +59,10 @@ bool ValidVideoForAlbum(const PreparedFileInformation::Video &video) {
 	return Ui::ValidateThumbDimensions(width, height);
 }
 
-QSize PrepareShownDimensions(const QImage &preview) {
+QSize PrepareShownDimensions(QSize result) {
 	constexpr auto kMaxWidth = 1280;
 	constexpr auto kMaxHeight = 1280;
 
-	const auto result = preview.size();
 	return (result.width() > kMaxWidth || result.height() > kMaxHeight)
 		? result.scaled(kMaxWidth, kMaxHeight, Qt::KeepAspectRatio)
 		: result;
@@ -305,7 +304,8 @@ void PrepareDetails(PreparedFile &file, int previewWidth) {
 			&file.information->media)) {
 		if (ValidVideoForAlbum(*video)) {
 			auto blurred = Images::prepareBlur(Images::prepareOpaque(video->thumbnail));
-			file.shownDimensions = PrepareShownDimensions(video->thumbnail);
+			file.shownDimensions = PrepareShownDimensions(
+				video->thumbnail.size());
 			file.preview = std::move(blurred).scaledToWidth(
 				previewWidth * cIntRetinaFactor(),
 				Qt::SmoothTransformation);
@@ -324,15 +324,21 @@ void UpdateImageDetails(PreparedFile &file, int previewWidth) {
 		return;
 	}
 	Assert(!image->data.isNull());
-	auto preview = image->modifications
-		? Editor::ImageModified(image->data, image->modifications)
-		: image->data;
-	Assert(!preview.isNull());
-	file.shownDimensions = PrepareShownDimensions(preview);
+	const auto size = Editor::ImageModifiedSize(
+		image->data.size(),
+		image->modifications);
+	file.shownDimensions = PrepareShownDimensions(size);
 	const auto toWidth = std::min(
 		previewWidth,
-		style::ConvertScale(preview.width())
+		style::ConvertScale(size.width())
 	) * cIntRetinaFactor();
+	auto preview = image->modifications
+		? Editor::ImageModifiedPreview(
+			image->data,
+			image->modifications,
+			toWidth)
+		: image->data;
+	Assert(!preview.isNull());
 	const auto scaled = preview.scaledToWidth(
 		toWidth,
 		Qt::SmoothTransformation);
@@ -364,6 +370,7 @@ bool ApplyModifications(PreparedList &list) {
 		image->data = Editor::ImageModified(
 			std::move(image->data),
 			image->modifications);
+		image->original = QSize();
 	}
 	return applied;
 }
@@ -0,0 +1,59 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/storage_transfer_shaper.h"
+
+namespace Storage {
+
+void TransferShaper::setRate(int64 bytesPerSecond) {
+	if (_rate == bytesPerSecond) {
+		return;
+	}
+	const auto wasLimited = limited();
+	_rate = bytesPerSecond;
+	_tokens = wasLimited ? std::min(_tokens, _rate) : _rate;
+	_updated = crl::now();
+}
+
+crl::time TransferShaper::delay(bool background) {
+	if (!limited()) {
+		return 0;
+	}
+	refill(crl::now());
+	const auto threshold = background ? (_rate / 2) : 0;
+	if (_tokens > threshold) {
+		return 0;
+	}
+	return (threshold - _tokens + 1) * crl::time(1000) / _rate + 1;
+}
+
+void TransferShaper::consume(int64 amount) {
+	if (limited()) {
+		_tokens -= amount;
+	}
+}
+
+void TransferShaper::refill(crl::time now) {
+	const auto elapsed = now - _updated;
+	if (elapsed <= 0) {
+		return;
+	}
+	_tokens = std::min(_tokens + _rate * elapsed / crl::time(1000), _rate);
+	_updated = now;
+}
+
+TransferShaper &DownloadShaper() {
+	static auto result = TransferShaper();
+	return result;
+}
+
+TransferShaper &UploadShaper() {
+	static auto result = TransferShaper();
+	return result;
+}
+
+} // namespace Storage
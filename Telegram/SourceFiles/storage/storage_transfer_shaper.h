@@ -0,0 +1,40 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Storage {
+
+// Token bucket with one second of burst, shared by all the accounts.
+// The bucket may go into debt, so parts of any size can be sent once
+// there are some tokens and the debt is paid before the next part.
+class TransferShaper final {
+public:
+	// Zero bytes per second means no limit.
+	void setRate(int64 bytesPerSecond);
+	[[nodiscard]] bool limited() const {
+		return (_rate > 0);
+	}
+
+	// Background transfers wait for a half full bucket, so interactive
+	// ones, waiting only for a non-empty bucket, always go first.
+	[[nodiscard]] crl::time delay(bool background);
+	void consume(int64 amount);
+
+private:
+	void refill(crl::time now);
+
+	int64 _rate = 0;
+	int64 _tokens = 0;
+	crl::time _updated = 0;
+
+};
+
+[[nodiscard]] TransferShaper &DownloadShaper();
+[[nodiscard]] TransferShaper &UploadShaper();
+
+} // namespace Storage
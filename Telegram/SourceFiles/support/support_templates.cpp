@@ -53,6 +53,15 @@ QString NormalizeKey(const QString &query) {
 	return TextUtilities::RemoveAccents(query.trimmed().toLower());
 }
 
+// Everything matching the 'now' words matched the 'was' words as well.
+bool NarrowsQuery(const QStringList &was, const QStringList &now) {
+	return !was.isEmpty() && ranges::all_of(was, [&](const QString &word) {
+		return ranges::any_of(now, [&](const QString &other) {
+			return other.startsWith(word);
+		});
+	});
+}
+
 struct FileResult {
 	TemplatesFile result;
 	QStringList errors;
@@ -275,6 +284,7 @@ TemplatesIndex ComputeIndex(const TemplatesData &data) {
 	using Term = TemplatesIndex::Term;
 
 	auto uniqueFirst = std::map<QChar, base::flat_set<Id>>();
+	auto uniqueFirstTwo = std::map<QString, base::flat_set<Id>>();
 	auto uniqueFull = std::map<Id, base::flat_set<Term>>();
 	const auto pushString = [&](
 			const Id &id,
@@ -283,6 +293,9 @@ TemplatesIndex ComputeIndex(const TemplatesData &data) {
 		const auto list = TextUtilities::PrepareSearchWords(string);
 		for (const auto &word : list) {
 			uniqueFirst[word[0]].emplace(id);
+			if (word.size() > 1) {
+				uniqueFirstTwo[word.mid(0, 2)].emplace(id);
+			}
 			uniqueFull[id].emplace(std::make_pair(word, weight));
 		}
 	};
@@ -301,6 +314,9 @@ TemplatesIndex ComputeIndex(const TemplatesData &data) {
 	for (const auto &[ch, unique] : uniqueFirst) {
 		result.first.emplace(ch, unique | ranges::to_vector);
 	}
+	for (const auto &[prefix, unique] : uniqueFirstTwo) {
+		result.firstTwo.emplace(prefix, unique | ranges::to_vector);
+	}
 	for (const auto &[id, unique] : uniqueFull) {
 		result.full.emplace(id, unique | ranges::to_vector);
 	}
@@ -323,23 +339,27 @@ void ReplaceFileIndex(
 	}
 
 	using Id = TemplatesIndex::Id;
-	for (auto &[ch, list] : result.first) {
-		auto i = ranges::lower_bound(
-			list,
-			std::make_pair(path, QString()));
-		auto j = std::find_if(i, end(list), [&](const Id &id) {
-			return id.first != path;
-		});
-		list.erase(i, j);
-	}
-	for (auto &[ch, list] : source.first) {
-		auto &to = result.first[ch];
-		to.insert(
-			end(to),
-			std::make_move_iterator(begin(list)),
-			std::make_move_iterator(end(list)));
-		ranges::sort(to);
-	}
+	const auto replace = [&](auto &result, auto &source) {
+		for (auto &[key, list] : result) {
+			auto i = ranges::lower_bound(
+				list,
+				std::make_pair(path, QString()));
+			auto j = std::find_if(i, end(list), [&](const Id &id) {
+				return id.first != path;
+			});
+			list.erase(i, j);
+		}
+		for (auto &[key, list] : source) {
+			auto &to = result[key];
+			to.insert(
+				end(to),
+				std::make_move_iterator(begin(list)),
+				std::make_move_iterator(end(list)));
+			ranges::sort(to);
+		}
+	};
+	replace(result.first, source.first);
+	replace(result.firstTwo, source.firstTwo);
 }
 
 void MoveKeys(TemplatesFile &to, const TemplatesFile &from) {
@@ -492,6 +512,7 @@ void Templates::load() {
 		]() mutable {
 			setData(std::move(result.result));
 			_index = std::move(result.index);
+			_lastQuery = LastQuery();
 			_errors.fire(std::move(result.errors));
 			crl::on_main(this, [=] {
 				if (base::take(_reloadAfterRead)) {
@@ -580,7 +601,8 @@ void Templates::updateRequestFinished(QNetworkReply *reply) {
 			auto &existing = _data.files.at(path);
 			auto &parsed = one.files.at(path);
 			MoveKeys(parsed, existing);
-			ReplaceFileIndex(_index, ComputeIndex(one), path);
+			ReplaceFileIndex(_index, std::move(index), path);
+			_lastQuery = LastQuery();
 			if (!errors.isEmpty()) {
 				_errors.fire(std::move(errors));
 			}
@@ -665,21 +687,38 @@ auto Templates::matchFromEnd(QString query) const
 Templates::~Templates() = default;
 
 auto Templates::query(const QString &text) const -> std::vector<Question> {
+	using Id = TemplatesIndex::Id;
+	using Term = TemplatesIndex::Term;
+
 	const auto words = TextUtilities::PrepareSearchWords(text);
-	const auto questions = [&](const QString &word) {
+	const auto questions = [&](
+			const QString &word) -> const std::vector<Id>* {
+		if (word.size() > 1) {
+			const auto i = _index.firstTwo.find(word.mid(0, 2));
+			return (i == end(_index.firstTwo)) ? nullptr : &i->second;
+		}
 		const auto i = _index.first.find(word[0]);
-		return (i == end(_index.first)) ? 0 : i->second.size();
+		return (i == end(_index.first)) ? nullptr : &i->second;
 	};
-	const auto best = ranges::min_element(words, std::less<>(), questions);
-	if (best == std::end(words)) {
-		return {};
+	const std::vector<Id> *narrowed = nullptr;
+	for (const auto &word : words) {
+		const auto list = questions(word);
+		if (!list) {
+			_lastQuery = LastQuery{ .words = words };
+			return {};
+		} else if (!narrowed || list->size() < narrowed->size()) {
+			narrowed = list;
+		}
 	}
-	const auto narrowed = _index.first.find((*best)[0]);
-	if (narrowed == end(_index.first)) {
+	if (!narrowed) {
 		return {};
 	}
-	using Id = TemplatesIndex::Id;
-	using Term = TemplatesIndex::Term;
+
+	// While the query is being typed each result is a part of the last one.
+	if (NarrowsQuery(_lastQuery.words, words)
+		&& _lastQuery.matched.size() < narrowed->size()) {
+		narrowed = &_lastQuery.matched;
+	}
 	const auto questionById = [&](const Id &id) {
 		return _data.files.at(id.first).questions.at(id.second);
 	};
@@ -730,11 +769,21 @@ auto Templates::query(const QString &text) const -> std::vector<Question> {
 			return (a.first.second < b.first.second);
 		}
 	};
-	const auto good = narrowed->second | ranges::views::transform(
+	auto good = *narrowed | ranges::views::transform(
 		pairById
 	) | ranges::views::filter([](const Pair &pair) {
 		return pair.second > 0;
-	}) | ranges::to_vector | ranges::actions::stable_sort(sorter);
+	}) | ranges::to_vector;
+	_lastQuery = LastQuery{
+		.words = words,
+		.matched = good | ranges::views::transform(
+			&Pair::first
+		) | ranges::to_vector,
+	};
+
+	// All ids are different, so the order is the same as a stable sort.
+	const auto limit = std::min(int(good.size()), kQueryLimit);
+	ranges::partial_sort(good, begin(good) + limit, sorter);
 	return good | ranges::views::transform([&](const Pair &pair) {
 		return questionById(pair.first);
 	}) | ranges::views::take(kQueryLimit) | ranges::to_vector;
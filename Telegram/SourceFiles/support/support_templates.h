@@ -39,6 +39,7 @@ struct TemplatesIndex {
 	using Term = std::pair<QString, int>; // search term, weight
 
 	std::map<QChar, std::vector<Id>> first;
+	std::map<QString, std::vector<Id>> firstTwo; // For longer words.
 	std::map<Id, std::vector<Term>> full;
 };
 
@@ -71,6 +72,10 @@ public:
 
 private:
 	struct Updates;
+	struct LastQuery {
+		QStringList words;
+		std::vector<details::TemplatesIndex::Id> matched;
+	};
 
 	void load();
 	void update();
@@ -83,6 +88,7 @@ private:
 
 	details::TemplatesData _data;
 	details::TemplatesIndex _index;
+	mutable LastQuery _lastQuery;
 	rpl::event_stream<QStringList> _errors;
 	base::binary_guard _reading;
 	bool _reloadAfterRead = false;
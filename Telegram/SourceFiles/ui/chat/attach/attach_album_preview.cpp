@@ -25,12 +25,13 @@ constexpr auto kDragDuration = crl::time(200);
 AlbumPreview::AlbumPreview(
 	QWidget *parent,
 	gsl::span<Ui::PreparedFile> items,
-	SendFilesWay way)
+	SendFilesWay way,
+	std::shared_ptr<AlbumThumbnailCache> cache)
 : RpWidget(parent)
 , _sendWay(way)
 , _dragTimer([=] { switchToDrag(); }) {
 	setMouseTracking(true);
-	prepareThumbs(items);
+	prepareThumbs(items, std::move(cache));
 	updateSize();
 	updateFileRows();
 }
@@ -91,7 +92,9 @@ std::vector<int> AlbumPreview::defaultOrder(int count) const {
 	return ranges::views::ints(0, count) | ranges::to_vector;
 }
 
-void AlbumPreview::prepareThumbs(gsl::span<Ui::PreparedFile> items) {
+void AlbumPreview::prepareThumbs(
+		gsl::span<Ui::PreparedFile> items,
+		std::shared_ptr<AlbumThumbnailCache> cache) {
 	_order = defaultOrder(items.size());
 	_itemsShownDimensions = ranges::views::all(
 		_order
@@ -101,12 +104,15 @@ void AlbumPreview::prepareThumbs(gsl::span<Ui::PreparedFile> items) {
 
 	const auto count = int(_order.size());
 	const auto layout = generateOrderedLayout();
+	const auto repaint = crl::guard(this, [=] { update(); });
 	_thumbs.reserve(count);
 	for (auto i = 0; i != count; ++i) {
 		_thumbs.push_back(std::make_unique<AlbumThumbnail>(
 			items[i],
 			layout[i],
 			this,
+			cache,
+			repaint,
 			[=] { changeThumbByIndex(thumbIndex(thumbUnderCursor())); },
 			[=] { deleteThumbByIndex(thumbIndex(thumbUnderCursor())); }));
 	}
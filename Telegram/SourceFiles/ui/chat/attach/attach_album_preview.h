@@ -16,13 +16,15 @@ namespace Ui {
 struct PreparedFile;
 struct GroupMediaLayout;
 class AlbumThumbnail;
+class AlbumThumbnailCache;
 
 class AlbumPreview final : public RpWidget {
 public:
 	AlbumPreview(
 		QWidget *parent,
 		gsl::span<Ui::PreparedFile> items,
-		SendFilesWay way);
+		SendFilesWay way,
+		std::shared_ptr<AlbumThumbnailCache> cache);
 	~AlbumPreview();
 
 	void setSendWay(SendFilesWay way);
@@ -49,7 +51,9 @@ private:
 		const std::vector<GroupMediaLayout> &layout) const;
 	std::vector<GroupMediaLayout> generateOrderedLayout() const;
 	std::vector<int> defaultOrder(int count = -1) const;
-	void prepareThumbs(gsl::span<Ui::PreparedFile> items);
+	void prepareThumbs(
+		gsl::span<Ui::PreparedFile> items,
+		std::shared_ptr<AlbumThumbnailCache> cache);
 	void updateSizeAnimated(const std::vector<GroupMediaLayout> &layout);
 	void updateSize();
 	void updateFileRows();
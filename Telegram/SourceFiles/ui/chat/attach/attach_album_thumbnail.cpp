@@ -20,18 +20,71 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Ui {
 
+QImage AlbumThumbnailCache::prepare(
+		Kind kind,
+		const Request &request,
+		Fn<void()> ready) {
+	const auto key = Key{ request.original.cacheKey(), kind };
+	auto &entry = _entries[key];
+	if (entry.request != request) {
+		entry.request = request;
+		entry.image = QImage();
+		start(key, request);
+	} else if (!entry.image.isNull()) {
+		return entry.image;
+	}
+	if (ready) {
+		entry.waiting.push_back(std::move(ready));
+	}
+	return QImage();
+}
+
+void AlbumThumbnailCache::start(Key key, const Request &request) {
+	crl::async([=, weak = base::make_weak(this)] {
+		auto image = Images::prepare(
+			request.original,
+			request.size.width(),
+			request.size.height(),
+			request.options,
+			request.outer.width(),
+			request.outer.height());
+		crl::on_main(weak, [=, image = std::move(image)]() mutable {
+			done(key, request, std::move(image));
+		});
+	});
+}
+
+void AlbumThumbnailCache::done(
+		Key key,
+		const Request &request,
+		QImage image) {
+	const auto i = _entries.find(key);
+	if (i == end(_entries) || i->second.request != request) {
+		return;
+	}
+	i->second.image = std::move(image);
+	for (const auto &callback : base::take(i->second.waiting)) {
+		callback();
+	}
+}
+
 AlbumThumbnail::AlbumThumbnail(
 	const PreparedFile &file,
 	const GroupMediaLayout &layout,
 	QWidget *parent,
+	std::shared_ptr<AlbumThumbnailCache> cache,
+	Fn<void()> repaint,
 	Fn<void()> editCallback,
 	Fn<void()> deleteCallback)
 : _layout(layout)
 , _fullPreview(file.preview)
 , _shrinkSize(int(std::ceil(st::historyMessageRadius / 1.4)))
 , _isPhoto(file.type == PreparedFile::Type::Photo)
-, _isVideo(file.type == PreparedFile::Type::Video) {
+, _isVideo(file.type == PreparedFile::Type::Video)
+, _cache(std::move(cache))
+, _repaint(std::move(repaint)) {
 	Expects(!_fullPreview.isNull());
+	Expects(_cache != nullptr);
 
 	moveToLayout(layout);
 
@@ -44,27 +97,24 @@ AlbumThumbnail::AlbumThumbnail(
 	const auto imageHeight = std::max(
 		previewHeight / style::DevicePixelRatio(),
 		st::minPhotoSize);
-	_photo = PixmapFromImage(Images::prepare(
-		_fullPreview,
-		previewWidth,
-		previewHeight,
-		Option::RoundedLarge | Option::RoundedAll,
-		imageWidth,
-		imageHeight));
+	setRequest(_photo, {
+		.original = _fullPreview,
+		.size = { previewWidth, previewHeight },
+		.options = Option::RoundedLarge | Option::RoundedAll,
+		.outer = { imageWidth, imageHeight },
+	});
 
 	const auto &st = st::attachPreviewThumbLayout;
 	const auto idealSize = st.thumbSize * style::DevicePixelRatio();
 	const auto fileThumbSize = (previewWidth > previewHeight)
 		? QSize(previewWidth * idealSize / previewHeight, idealSize)
 		: QSize(idealSize, previewHeight * idealSize / previewWidth);
-	_fileThumb = PixmapFromImage(Images::prepare(
-		_fullPreview,
-		fileThumbSize.width(),
-		fileThumbSize.height(),
-		Option::RoundedSmall | Option::RoundedAll,
-		st.thumbSize,
-		st.thumbSize
-	));
+	setRequest(_fileThumb, {
+		.original = _fullPreview,
+		.size = fileThumbSize,
+		.options = Option::RoundedSmall | Option::RoundedAll,
+		.outer = { st.thumbSize, st.thumbSize },
+	});
 
 	const auto availableFileWidth = st::sendMediaPreviewSize
 		- st.thumbSize
@@ -165,17 +215,60 @@ void AlbumThumbnail::moveToLayout(const GroupMediaLayout &layout) {
 	const auto pixWidth = pixSize.width() * style::DevicePixelRatio();
 	const auto pixHeight = pixSize.height() * style::DevicePixelRatio();
 
-	_albumImage = PixmapFromImage(Images::prepare(
-		_fullPreview,
-		pixWidth,
-		pixHeight,
-		options,
-		width,
-		height));
+	setRequest(_albumImage, {
+		.original = _fullPreview,
+		.size = { pixWidth, pixHeight },
+		.options = options,
+		.outer = { width, height },
+	});
+}
+
+void AlbumThumbnail::setRequest(
+		PreparedImage &image,
+		AlbumThumbnailCache::Request request) {
+	if (image.request == request) {
+		return;
+	}
+	// Keep the previous pixmap to draw it scaled until the new is ready.
+	image.request = std::move(request);
+	image.valid = image.requested = false;
+}
+
+void AlbumThumbnail::validate(Kind kind, PreparedImage &image) {
+	if (image.valid) {
+		return;
+	}
+	auto prepared = _cache->prepare(
+		kind,
+		image.request,
+		image.requested ? Fn<void()>() : _repaint);
+	image.requested = true;
+	if (!prepared.isNull()) {
+		image.pixmap = PixmapFromImage(std::move(prepared));
+		image.valid = true;
+	}
+}
+
+void AlbumThumbnail::paintPrepared(
+		Painter &p,
+		const PreparedImage &image,
+		QRect to,
+		int radius) const {
+	if (image.valid) {
+		p.drawPixmap(to.topLeft(), image.pixmap);
+	} else if (!image.pixmap.isNull()) {
+		PainterHighQualityEnabler hq(p);
+		p.drawPixmap(to, image.pixmap);
+	} else {
+		PainterHighQualityEnabler hq(p);
+		p.setPen(Qt::NoPen);
+		p.setBrush(st::imageBg);
+		p.drawRoundedRect(to, radius, radius);
+	}
 }
 
 int AlbumThumbnail::photoHeight() const {
-	return _photo.height() / style::DevicePixelRatio();
+	return _photo.request.outer.height();
 }
 
 void AlbumThumbnail::paintInAlbum(
@@ -201,7 +294,12 @@ void AlbumThumbnail::paintInAlbum(
 			drawSimpleFrame(p, to, size);
 		}
 	} else {
-		p.drawPixmap(x, y, _albumImage);
+		validate(Kind::Album, _albumImage);
+		paintPrepared(
+			p,
+			_albumImage,
+			QRect({ x, y }, geometry.size()),
+			st::historyMessageRadius);
 	}
 	if (_isVideo) {
 		const auto innerSize = st::msgFileLayout.thumbSize;
@@ -373,12 +471,18 @@ void AlbumThumbnail::drawSimpleFrame(Painter &p, QRect to, QSize size) const {
 }
 
 void AlbumThumbnail::paintPhoto(Painter &p, int left, int top, int outerWidth) {
-	const auto size = _photo.size() / style::DevicePixelRatio();
-	p.drawPixmapLeft(
-		left + (st::sendMediaPreviewSize - size.width()) / 2,
-		top,
-		outerWidth,
-		_photo);
+	const auto size = _photo.request.outer;
+	validate(Kind::Photo, _photo);
+	paintPrepared(
+		p,
+		_photo,
+		style::rtlrect(
+			left + (st::sendMediaPreviewSize - size.width()) / 2,
+			top,
+			size.width(),
+			size.height(),
+			outerWidth),
+		st::historyMessageRadius);
 
 	const auto topLeft = QPoint{ left, top };
 
@@ -399,7 +503,12 @@ void AlbumThumbnail::paintFile(
 	const auto &st = st::attachPreviewThumbLayout;
 	const auto textLeft = left + st.thumbSize + st.padding.right();
 
-	p.drawPixmap(left, top, _fileThumb);
+	validate(Kind::File, _fileThumb);
+	paintPrepared(
+		p,
+		_fileThumb,
+		QRect(QPoint(left, top), _fileThumb.request.outer),
+		st::roundRadiusSmall);
 	p.setFont(st::semiboldFont);
 	p.setPen(st::historyFileNameInFg);
 	p.drawTextLeft(
@@ -417,9 +526,7 @@ void AlbumThumbnail::paintFile(
 		_status,
 		_statusWidth);
 
-	_lastRectOfModify = QRect(
-		QPoint(left, top),
-		_fileThumb.size() / style::DevicePixelRatio());
+	_lastRectOfModify = QRect(QPoint(left, top), _fileThumb.request.outer);
 }
 
 bool AlbumThumbnail::containsPoint(QPoint position) const {
@@ -12,19 +12,76 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/animations.h"
 #include "ui/grouped_layout.h"
 #include "ui/round_rect.h"
+#include "ui/image/image_prepare.h"
 #include "base/object_ptr.h"
+#include "base/weak_ptr.h"
+#include "base/flat_map.h"
 
 namespace Ui {
 
 struct PreparedFile;
 class IconButton;
 
+// Scaled and rounded thumbnails are prepared in the background and kept
+// for each original preview, so re-creating the previews after a layout
+// change (like toggling the grouping) doesn't prepare them again.
+class AlbumThumbnailCache final : public base::has_weak_ptr {
+public:
+	enum class Kind {
+		Album,
+		Photo,
+		File,
+	};
+	struct Request {
+		QImage original;
+		QSize size;
+		Images::Options options;
+		QSize outer;
+
+		friend inline bool operator==(
+				const Request &a,
+				const Request &b) {
+			return (a.original.cacheKey() == b.original.cacheKey())
+				&& (a.size == b.size)
+				&& (a.options == b.options)
+				&& (a.outer == b.outer);
+		}
+		friend inline bool operator!=(
+				const Request &a,
+				const Request &b) {
+			return !(a == b);
+		}
+	};
+
+	// Returns a null image if it is not ready yet, then calls ready().
+	[[nodiscard]] QImage prepare(
+		Kind kind,
+		const Request &request,
+		Fn<void()> ready);
+
+private:
+	using Key = std::pair<qint64, Kind>;
+	struct Entry {
+		Request request;
+		QImage image;
+		std::vector<Fn<void()>> waiting;
+	};
+
+	void start(Key key, const Request &request);
+	void done(Key key, const Request &request, QImage image);
+
+	base::flat_map<Key, Entry> _entries;
+
+};
+
 class AlbumThumbnail final {
 public:
 	AlbumThumbnail(
 		const PreparedFile &file,
 		const GroupMediaLayout &layout,
 		QWidget *parent,
+		std::shared_ptr<AlbumThumbnailCache> cache,
+		Fn<void()> repaint,
 		Fn<void()> editCallback,
 		Fn<void()> deleteCallback);
 
@@ -58,6 +115,24 @@ public:
 	static constexpr auto kShrinkDuration = crl::time(150);
 
 private:
+	using Kind = AlbumThumbnailCache::Kind;
+	struct PreparedImage {
+		AlbumThumbnailCache::Request request;
+		QPixmap pixmap;
+		bool valid = false;
+		bool requested = false;
+	};
+
+	void setRequest(
+		PreparedImage &image,
+		AlbumThumbnailCache::Request request);
+	void validate(Kind kind, PreparedImage &image);
+	void paintPrepared(
+		Painter &p,
+		const PreparedImage &image,
+		QRect to,
+		int radius) const;
+
 	QRect countRealGeometry() const;
 	QRect countCurrentGeometry(float64 progress) const;
 	void prepareCache(QSize size, int shrink);
@@ -74,12 +149,14 @@ private:
 	const int _shrinkSize;
 	const bool _isPhoto;
 	const bool _isVideo;
-	QPixmap _albumImage;
+	const std::shared_ptr<AlbumThumbnailCache> _cache;
+	const Fn<void()> _repaint;
+	PreparedImage _albumImage;
 	QImage _albumCache;
 	QPoint _albumPosition;
 	RectParts _albumCorners = RectPart::None;
-	QPixmap _photo;
-	QPixmap _fileThumb;
+	PreparedImage _photo;
+	PreparedImage _fileThumb;
 	QString _name;
 	QString _status;
 	int _nameWidth = 0;
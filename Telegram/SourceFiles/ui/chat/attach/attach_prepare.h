@@ -20,6 +20,7 @@ class SendFilesWay;
 struct PreparedFileInformation {
 	struct Image {
 		QImage data;
+		QSize original; // Valid if data was decoded at a reduced scale.
 		bool animated = false;
 		Editor::PhotoModifications modifications;
 	};
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/chat/attach/attach_prepare.h"
 #include "core/mime_type.h"
 #include "lottie/lottie_single_player.h"
+#include "styles/style_boxes.h"
 
 namespace Ui {
 
@@ -24,7 +25,10 @@ SingleMediaPreview *SingleMediaPreview::Create(
 	bool animationPreview = false;
 	if (const auto image = std::get_if<PreparedFileInformation::Image>(
 			&file.information->media)) {
-		preview = Editor::ImageModified(image->data, image->modifications);
+		preview = Editor::ImageModifiedPreview(
+			image->data,
+			image->modifications,
+			st::sendMediaPreviewSize * style::DevicePixelRatio());
 		animated = animationPreview = image->animated;
 	} else if (const auto video = std::get_if<PreparedFileInformation::Video>(
 			&file.information->media)) {
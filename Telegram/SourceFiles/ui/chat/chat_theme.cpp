@@ -24,6 +24,7 @@ constexpr auto kMaxChatEntryHistorySize = 50;
 constexpr auto kCacheBackgroundTimeout = 1 * crl::time(1000);
 constexpr auto kCacheBackgroundFastTimeout = crl::time(200);
 constexpr auto kBackgroundFadeDuration = crl::time(200);
+constexpr auto kMaxCachedBackgrounds = 3;
 constexpr auto kMinimumTiledSize = 512;
 constexpr auto kMaxSize = 2960;
 constexpr auto kMaxContrastValue = 21.;
@@ -410,6 +411,7 @@ void ChatTheme::setBackground(ChatThemeBackground &&background) {
 	_mutableBackground = std::move(background);
 	_backgroundState = {};
 	_backgroundNext = {};
+	_backgroundCache.clear();
 	_backgroundFade.stop();
 	if (_cacheBackgroundTimer) {
 		_cacheBackgroundTimer->cancel();
@@ -421,6 +423,7 @@ void ChatTheme::updateBackgroundImageFrom(ChatThemeBackground &&background) {
 	_mutableBackground.prepared = std::move(background.prepared);
 	_mutableBackground.preparedForTiled = std::move(
 		background.preparedForTiled);
+	_backgroundCache.clear();
 	if (!_backgroundState.now.pixmap.isNull()) {
 		if (_cacheBackgroundTimer) {
 			_cacheBackgroundTimer->cancel();
@@ -457,6 +460,7 @@ void ChatTheme::setBubblesBackground(QImage image) {
 		_bubblesBackgroundPattern = PrepareBubblePattern(palette());
 	}
 	_bubblesBackgroundPattern->pixmap = _bubblesBackground.pixmap;
+	_bubblesBackgroundPattern->image = _bubblesBackground.pixmap.toImage();
 	_repaintBackgroundRequests.fire({});
 }
 
@@ -492,12 +496,26 @@ const BackgroundState &ChatTheme::backgroundState(QSize area) {
 		_cacheBackgroundTimer.emplace([=] { cacheBackground(); });
 	}
 	_backgroundState.shown = _backgroundFade.value(1.);
-	if (_backgroundState.now.pixmap.isNull()
+	const auto request = (_backgroundState.now.area != area)
+		? cacheBackgroundRequest(area)
+		: CacheBackgroundRequest();
+	if (const auto found = lookupCachedBackground(request)) {
+		// Switching back to a recently used size, like after toggling
+		// a column or maximizing the window, doesn't render it again.
+		auto cached = base::duplicate(*found);
+		rememberCachedBackground(request, cached);
+		_cacheBackgroundArea = area;
+		setCachedBackground(std::move(cached));
+		_cacheBackgroundTimer->cancel();
+	} else if (_backgroundState.now.pixmap.isNull()
 		&& !background().gradientForFill.isNull()) {
 		// We don't support direct painting of patterned gradients.
 		// So we need to sync-generate cache image here.
 		_cacheBackgroundArea = area;
-		setCachedBackground(CacheBackground(cacheBackgroundRequest(area)));
+		const auto generate = cacheBackgroundRequest(area);
+		auto cached = CachedBackground(CacheBackground(generate));
+		rememberCachedBackground(generate, cached);
+		setCachedBackground(std::move(cached));
 		_cacheBackgroundTimer->cancel();
 	} else if (_backgroundState.now.area != area) {
 		if (_cacheBackgroundArea != area
@@ -606,18 +624,50 @@ void ChatTheme::cacheBackgroundAsync(
 				done(std::move(result));
 			} else if (const auto request = cacheBackgroundRequest(
 					_cacheBackgroundArea)) {
-				if (_backgroundCachingRequest != request) {
+				if (lookupCachedBackground(request)) {
+					// Already shown from the recently used sizes.
+					_backgroundCachingRequest = {};
+				} else if (_backgroundCachingRequest != request) {
 					cacheBackgroundAsync(request);
 				} else {
+					auto cached = CachedBackground(std::move(result));
+					rememberCachedBackground(request, cached);
 					_backgroundCachingRequest = {};
-					setCachedBackground(std::move(result));
+					setCachedBackground(std::move(cached));
 				}
 			}
 		});
 	});
 }
 
-void ChatTheme::setCachedBackground(CacheBackgroundResult &&cached) {
+void ChatTheme::rememberCachedBackground(
+		const CacheBackgroundRequest &request,
+		const CachedBackground &cached) {
+	const auto i = ranges::find(
+		_backgroundCache,
+		request,
+		&std::pair<CacheBackgroundRequest, CachedBackground>::first);
+	if (i != end(_backgroundCache)) {
+		_backgroundCache.erase(i);
+	} else if (int(_backgroundCache.size()) >= kMaxCachedBackgrounds) {
+		_backgroundCache.pop_back();
+	}
+	_backgroundCache.emplace(begin(_backgroundCache), request, cached);
+}
+
+const CachedBackground *ChatTheme::lookupCachedBackground(
+		const CacheBackgroundRequest &request) const {
+	if (!request) {
+		return nullptr;
+	}
+	const auto i = ranges::find(
+		_backgroundCache,
+		request,
+		&std::pair<CacheBackgroundRequest, CachedBackground>::first);
+	return (i != end(_backgroundCache)) ? &i->second : nullptr;
+}
+
+void ChatTheme::setCachedBackground(CachedBackground &&cached) {
 	_backgroundNext = {};
 
 	if (background().gradientForFill.isNull()
@@ -698,6 +748,8 @@ void ChatTheme::cacheBubblesAsync(
 					_bubblesBackground = std::move(result);
 					_bubblesBackgroundPattern->pixmap
 						= _bubblesBackground.pixmap;
+					_bubblesBackgroundPattern->image
+						= _bubblesBackground.pixmap.toImage();
 				}
 			}
 		});
@@ -715,6 +767,8 @@ void ChatTheme::rotateComplexGradientBackground() {
 			_mutableBackground.gradientForFill
 				= std::move(_backgroundNext.gradient);
 		}
+		// The rotation is not a part of the cache key.
+		_backgroundCache.clear();
 		setCachedBackground(base::take(_backgroundNext));
 	}
 }
@@ -179,7 +179,12 @@ private:
 	void cacheBackgroundAsync(
 		const CacheBackgroundRequest &request,
 		Fn<void(CacheBackgroundResult&&)> done = nullptr);
-	void setCachedBackground(CacheBackgroundResult &&cached);
+	void setCachedBackground(CachedBackground &&cached);
+	void rememberCachedBackground(
+		const CacheBackgroundRequest &request,
+		const CachedBackground &cached);
+	[[nodiscard]] const CachedBackground *lookupCachedBackground(
+		const CacheBackgroundRequest &request) const;
 	[[nodiscard]] CacheBackgroundRequest cacheBackgroundRequest(
 		QSize area,
 		int addRotation = 0) const;
@@ -207,6 +212,9 @@ private:
 	Animations::Simple _backgroundFade;
 	CacheBackgroundRequest _backgroundCachingRequest;
 	CacheBackgroundResult _backgroundNext;
+	std::vector<std::pair<
+		CacheBackgroundRequest,
+		CachedBackground>> _backgroundCache;
 	QSize _cacheBackgroundArea;
 	crl::time _lastBackgroundAreaChangeTime = 0;
 	std::optional<base::Timer> _cacheBackgroundTimer;
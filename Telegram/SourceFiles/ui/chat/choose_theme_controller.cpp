@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_cloud_themes.h"
 #include "data/data_document.h"
 #include "data/data_document_media.h"
+#include "storage/cache/storage_cache_database.h"
 #include "lang/lang_keys.h"
 #include "apiwrap.h"
 #include "styles/style_widgets.h"
@@ -29,22 +30,42 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "styles/style_settings.h"
 #include "styles/style_window.h"
 
+#include <QtCore/QBuffer>
 #include <QtWidgets/QApplication>
+#include <xxhash.h>
 
 namespace Ui {
 namespace {
 
 constexpr auto kDisableElement = "disable"_cs;
+constexpr auto kPreviewCacheVersion = 1;
+
+// Everything a preview is rendered from, so that it can be rendered
+// on a worker thread and cached by the content hash.
+struct PreviewData {
+	QImage pattern;
+	QImage bubblesPattern;
+	std::vector<QColor> colors;
+	QColor outBg;
+	QColor inBg;
+	float64 patternOpacity = 1.;
+	int gradientRotation = 0;
+	bool waitingForNegativePattern = false;
+};
 
-[[nodiscard]] QImage GeneratePreview(not_null<Ui::ChatTheme*> theme) {
+[[nodiscard]] PreviewData PreparePreviewData(
+		not_null<Ui::ChatTheme*> theme) {
 	const auto &background = theme->background();
-	const auto &colors = background.colors;
 	const auto size = st::settingsThemePreviewSize;
-	auto prepared = background.prepared;
-	const auto paintPattern = [&](QPainter &p, bool inverted) {
-		if (prepared.isNull()) {
-			return;
-		}
+	auto result = PreviewData{
+		.colors = background.colors,
+		.outBg = theme->palette()->msgOutBg()->c,
+		.inBg = theme->palette()->msgInBg()->c,
+		.patternOpacity = background.patternOpacity,
+		.gradientRotation = background.gradientRotation,
+		.waitingForNegativePattern = background.waitingForNegativePattern(),
+	};
+	if (const auto &prepared = background.prepared; !prepared.isNull()) {
 		const auto w = prepared.width();
 		const auto h = prepared.height();
 		const auto scaled = size.scaled(
@@ -57,30 +78,74 @@ constexpr auto kDisableElement = "disable"_cs;
 		const auto good = QSize(
 			std::max(use.width(), 1),
 			std::max(use.height(), 1));
-		auto small = prepared.copy(QRect(
+		result.pattern = prepared.copy(QRect(
 			QPoint(
 				(w - good.width()) / 2,
 				(h - good.height()) / 2),
 			good));
-		if (inverted) {
-			small = Ui::InvertPatternImage(std::move(small));
+	}
+	if (const auto pattern = theme->bubblesBackgroundPattern()) {
+		result.bubblesPattern = pattern->pixmap.toImage();
+	}
+	return result;
+}
+
+[[nodiscard]] uint64 ComputePreviewHash(const PreviewData &data) {
+	auto values = std::vector<int64>{
+		kPreviewCacheVersion,
+		style::DevicePixelRatio(),
+		st::settingsThemePreviewSize.width(),
+		st::settingsThemePreviewSize.height(),
+		data.outBg.rgba(),
+		data.inBg.rgba(),
+		int64(data.patternOpacity * 1000.),
+		data.gradientRotation,
+		data.waitingForNegativePattern ? 1 : 0,
+	};
+	for (const auto &color : data.colors) {
+		values.push_back(color.rgba());
+	}
+	auto result = XXH64(
+		values.data(),
+		values.size() * sizeof(values.front()),
+		0);
+	const auto hashImage = [&](const QImage &image) {
+		const auto size = std::array{ image.width(), image.height() };
+		result = XXH64(size.data(), sizeof(size), result);
+		if (!image.isNull()) {
+			result = XXH64(image.constBits(), image.sizeInBytes(), result);
+		}
+	};
+	hashImage(data.pattern);
+	hashImage(data.bubblesPattern);
+	return result;
+}
+
+[[nodiscard]] QImage GeneratePreview(const PreviewData &data) {
+	const auto &colors = data.colors;
+	const auto size = st::settingsThemePreviewSize;
+	const auto paintPattern = [&](QPainter &p, bool inverted) {
+		if (data.pattern.isNull()) {
+			return;
 		}
 		p.drawImage(
 			QRect(QPoint(), size * style::DevicePixelRatio()),
-			small);
+			(inverted
+				? Ui::InvertPatternImage(data.pattern)
+				: data.pattern));
 	};
 	const auto fullsize = size * style::DevicePixelRatio();
-	auto result = background.waitingForNegativePattern()
+	auto result = data.waitingForNegativePattern
 		? QImage(
 			fullsize,
 			QImage::Format_ARGB32_Premultiplied)
 		: Ui::GenerateBackgroundImage(
 			fullsize,
 			colors.empty() ? std::vector{ 1, QColor(0, 0, 0) } : colors,
-			background.gradientRotation,
-			background.patternOpacity,
+			data.gradientRotation,
+			data.patternOpacity,
 			paintPattern);
-	if (background.waitingForNegativePattern()) {
+	if (data.waitingForNegativePattern) {
 		result.fill(Qt::black);
 	}
 	result.setDevicePixelRatio(style::DevicePixelRatio());
@@ -102,8 +167,8 @@ constexpr auto kDisableElement = "disable"_cs;
 
 		PainterHighQualityEnabler hq(p);
 		p.setPen(Qt::NoPen);
-		if (const auto pattern = theme->bubblesBackgroundPattern()) {
-			auto bubble = pattern->pixmap.toImage().scaled(
+		if (!data.bubblesPattern.isNull()) {
+			auto bubble = data.bubblesPattern.scaled(
 				sent.size() * style::DevicePixelRatio(),
 				Qt::IgnoreAspectRatio,
 				Qt::SmoothTransformation
@@ -112,16 +177,45 @@ constexpr auto kDisableElement = "disable"_cs;
 			Images::prepareRound(bubble, corners);
 			p.drawImage(sent, bubble);
 		} else {
-			p.setBrush(theme->palette()->msgOutBg()->c);
+			p.setBrush(data.outBg);
 			p.drawRoundedRect(sent, radius, radius);
 		}
-		p.setBrush(theme->palette()->msgInBg()->c);
+		p.setBrush(data.inBg);
 		p.drawRoundedRect(received, radius, radius);
 	}
 	Images::prepareRound(result, ImageRoundRadius::Large);
 	return result;
 }
 
+[[nodiscard]] QImage GeneratePlaceholderPreview(const PreviewData &data) {
+	auto result = QImage(
+		st::settingsThemePreviewSize * style::DevicePixelRatio(),
+		QImage::Format_ARGB32_Premultiplied);
+	result.fill(data.colors.empty() ? QColor(0, 0, 0) : data.colors.front());
+	result.setDevicePixelRatio(style::DevicePixelRatio());
+	Images::prepareRound(result, ImageRoundRadius::Large);
+	return result;
+}
+
+[[nodiscard]] QByteArray SerializePreview(const QImage &preview) {
+	auto result = QByteArray();
+	auto buffer = QBuffer(&result);
+	preview.save(&buffer, "PNG");
+	return result;
+}
+
+[[nodiscard]] QImage ParsePreview(const QByteArray &bytes) {
+	auto result = QImage::fromData(bytes, "PNG");
+	if (result.size()
+		!= st::settingsThemePreviewSize * style::DevicePixelRatio()) {
+		return QImage();
+	}
+	result = std::move(result).convertToFormat(
+		QImage::Format_ARGB32_Premultiplied);
+	result.setDevicePixelRatio(style::DevicePixelRatio());
+	return result;
+}
+
 [[nodiscard]] QImage GenerateEmptyPreview() {
 	auto result = QImage(
 		st::settingsThemePreviewSize * style::DevicePixelRatio(),
@@ -153,6 +247,7 @@ struct ChooseThemeController::Entry {
 	QImage preview;
 	EmojiPtr emoji = nullptr;
 	QRect geometry;
+	uint64 previewRequestId = 0;
 	bool chosen = false;
 };
 
@@ -282,6 +377,57 @@ void ChooseThemeController::initButtons() {
 	});
 }
 
+void ChooseThemeController::requestPreview(Entry &entry) {
+	Expects(entry.theme != nullptr);
+
+	auto data = PreparePreviewData(entry.theme.get());
+	if (entry.preview.isNull()) {
+		entry.preview = GeneratePlaceholderPreview(data);
+		_inner->update();
+	}
+	const auto key = entry.key;
+	const auto requestId = entry.previewRequestId = ++_previewRequestId;
+	const auto apply = [=](QImage preview) {
+		const auto i = ranges::find(_entries, key, &Entry::key);
+		if (i == end(_entries) || i->previewRequestId != requestId) {
+			return;
+		}
+		i->preview = std::move(preview);
+		_inner->update();
+	};
+	const auto weak = Ui::MakeWeak(_inner.get());
+	const auto session = &_controller->session();
+	const auto generate = [=](PreviewData data, uint64 hash) {
+		auto preview = GeneratePreview(data);
+		auto bytes = SerializePreview(preview);
+		crl::on_main(weak, [=, bytes = std::move(bytes)]() mutable {
+			session->data().cache().put(
+				Data::ThemePreviewCacheKey(hash),
+				Storage::Cache::Database::TaggedValue(
+					std::move(bytes),
+					Data::kThemePreviewCacheTag));
+			apply(preview);
+		});
+	};
+	crl::async([=, data = std::move(data)] {
+		const auto hash = ComputePreviewHash(data);
+		crl::on_main(weak, [=] {
+			session->data().cache().get(
+				Data::ThemePreviewCacheKey(hash),
+				[=](QByteArray &&value) {
+					auto cached = ParsePreview(value);
+					if (cached.isNull()) {
+						crl::async([=] { generate(data, hash); });
+						return;
+					}
+					crl::on_main(weak, [=, cached = std::move(cached)] {
+						apply(cached);
+					});
+				});
+		});
+	});
+}
+
 void ChooseThemeController::paintEntry(QPainter &p, const Entry &entry) {
 	const auto geometry = entry.geometry;
 	p.drawImage(geometry, entry.preview);
@@ -549,7 +695,7 @@ void ChooseThemeController::fill(
 				}
 				const auto theme = data.get();
 				i->theme = std::move(data);
-				i->preview = GeneratePreview(theme);
+				requestPreview(*i);
 				if (_chosen == i->emoji->text()) {
 					_controller->overridePeerTheme(_peer, i->theme);
 				}
@@ -576,8 +722,7 @@ void ChooseThemeController::fill(
 					if (i == end(_entries)) {
 						return;
 					}
-					i->preview = GeneratePreview(theme);
-					_inner->update();
+					requestPreview(*i);
 				}, _cachingLifetime);
 			}, _cachingLifetime);
 			x += single.width() + skip;
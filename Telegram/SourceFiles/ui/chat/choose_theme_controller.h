@@ -52,6 +52,7 @@ private:
 	void close();
 
 	void clearCurrentBackgroundState();
+	void requestPreview(Entry &entry);
 	void paintEntry(QPainter &p, const Entry &entry);
 	void applyInitialInnerLeft();
 	void updateInnerLeft(int now);
@@ -72,6 +73,7 @@ private:
 	std::optional<QPoint> _pressPosition;
 	std::optional<QPoint> _dragStartPosition;
 	int _dragStartInnerLeft = 0;
+	uint64 _previewRequestId = 0;
 	bool _initialInnerLeftApplied = false;
 
 	rpl::variable<bool> _shouldBeShown = false;
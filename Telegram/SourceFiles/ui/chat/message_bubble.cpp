@@ -15,6 +15,60 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Ui {
 namespace {
 
+[[nodiscard]] inline uint32 MultiplyPixel(uint32 pixel, uint32 alpha) {
+	auto rb = (pixel & 0x00FF00FFU) * alpha;
+	rb = ((rb + ((rb >> 8) & 0x00FF00FFU) + 0x00800080U) >> 8) & 0x00FF00FFU;
+	auto ag = ((pixel >> 8) & 0x00FF00FFU) * alpha;
+	ag = (ag + ((ag >> 8) & 0x00FF00FFU) + 0x00800080U) & 0xFF00FF00U;
+	return rb | ag;
+}
+
+// Same as painting the pattern over the mask with SourceIn composition,
+// but without creating a painter for each corner and tail of each bubble.
+bool ComposeMaskedPattern(
+		const QImage &image,
+		const QRect &viewport,
+		const QRect &target,
+		const QImage &mask,
+		QImage &cache) {
+	const auto factor = int(mask.devicePixelRatio());
+	if (image.format() != QImage::Format_ARGB32_Premultiplied
+		|| int(image.devicePixelRatio()) != factor
+		|| viewport.size() * factor != image.size()) {
+		return false;
+	}
+	const auto from = QRect(
+		(target.topLeft() - viewport.topLeft()) * factor,
+		mask.size());
+	if (!QRect(QPoint(), image.size()).contains(from)) {
+		return false;
+	}
+	if (cache.size() != mask.size()) {
+		cache = QImage(
+			mask.size(),
+			QImage::Format_ARGB32_Premultiplied);
+	}
+	cache.setDevicePixelRatio(mask.devicePixelRatio());
+	Assert(cache.bytesPerLine() == cache.width() * 4);
+
+	const auto width = mask.width();
+	const auto imagePerLine = image.bytesPerLine() / 4;
+	auto source = reinterpret_cast<const uint32*>(image.constBits())
+		+ from.y() * imagePerLine
+		+ from.x();
+	auto alpha = reinterpret_cast<const uint32*>(mask.constBits());
+	auto result = reinterpret_cast<uint32*>(cache.bits());
+	for (auto y = 0, height = mask.height(); y != height; ++y) {
+		for (auto x = 0; x != width; ++x) {
+			result[x] = MultiplyPixel(source[x], alpha[x] >> 24);
+		}
+		source += imagePerLine;
+		alpha += width;
+		result += width;
+	}
+	return true;
+}
+
 template <
 	typename FillBg, // fillBg(QRect rect)
 	typename FillSh, // fillSh(QRect rect)
@@ -112,11 +166,26 @@ void PaintPatternBubble(Painter &p, const SimpleBubble &args) {
 			int y,
 			const QImage &mask,
 			QImage &cache) {
+		Expects(mask.bytesPerLine() == mask.width() * 4);
+		Expects(mask.format() == QImage::Format_ARGB32_Premultiplied);
+
+		const auto target = QRect(
+			QPoint(x, y),
+			mask.size() / int(mask.devicePixelRatio()));
+		if (ComposeMaskedPattern(
+				pattern->image,
+				args.patternViewport,
+				target,
+				mask,
+				cache)) {
+			p.drawImage(target, cache);
+			return;
+		}
 		PaintPatternBubblePart(
 			p,
 			args.patternViewport,
 			pattern->pixmap,
-			QRect(QPoint(x, y), mask.size() / int(mask.devicePixelRatio())),
+			target,
 			mask,
 			cache);
 	};
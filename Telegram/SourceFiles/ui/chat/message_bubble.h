@@ -23,6 +23,7 @@ struct BubbleSelectionInterval {
 
 struct BubblePattern {
 	QPixmap pixmap;
+	QImage image; // Shares the pixmap data, used to compose masked parts.
 	std::array<QImage, 4> corners;
 	QImage tailLeft;
 	QImage tailRight;
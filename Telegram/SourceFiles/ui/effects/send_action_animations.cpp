@@ -20,6 +20,8 @@ constexpr int kRecordArcsCount = 4;
 constexpr int kUploadArrowsCount = 3;
 constexpr auto kSpeakingDuration = 3200;
 constexpr auto kSpeakingFadeDuration = 400;
+constexpr auto kSpriteFrameDuration = crl::time(33);
+constexpr auto kSpriteCacheLimit = 16;
 
 } // namespace
 
@@ -83,9 +85,75 @@ using ImplementationsMap = QMap<
 	const SendActionAnimation::Impl::MetaData*>;
 NeverFreedPointer<ImplementationsMap> Implementations;
 
-class TypingAnimation : public SendActionAnimation::Impl {
+[[nodiscard]] std::vector<QImage> &Sprites(
+		const SendActionAnimation::Impl::MetaData *meta,
+		const QColor &color) {
+	using Key = std::pair<
+		const SendActionAnimation::Impl::MetaData*,
+		QRgb>;
+	static auto Cache = base::flat_map<Key, std::vector<QImage>>();
+	const auto key = Key(meta, color.rgba());
+	if (Cache.size() >= kSpriteCacheLimit && !Cache.contains(key)) {
+		Cache.clear();
+	}
+	return Cache[key];
+}
+
+// Animations that depend only on the frame time are rendered once per
+// style and color into a strip of sprites, quantized to the repaint rate.
+class CachedAnimation : public SendActionAnimation::Impl {
+public:
+	using Impl::Impl;
+
+	void paint(
+		Painter &p,
+		style::color color,
+		int x,
+		int y,
+		int outerWidth,
+		crl::time now) override final;
+
+protected:
+	virtual void paintFrame(
+		Painter &p,
+		style::color color,
+		int x,
+		int y,
+		crl::time frameMs) = 0;
+
+};
+
+void CachedAnimation::paint(
+		Painter &p,
+		style::color color,
+		int x,
+		int y,
+		int outerWidth,
+		crl::time now) {
+	const auto index = int(frameTime(now) / kSpriteFrameDuration);
+	auto &frames = Sprites(metaData(), color->c);
+	if (index >= int(frames.size())) {
+		frames.resize(index + 1);
+	}
+	const auto padding = style::ConvertScale(2);
+	const auto half = width();
+	auto &sprite = frames[index];
+	if (sprite.isNull()) {
+		const auto ratio = style::DevicePixelRatio();
+		sprite = QImage(
+			QSize(width() + 2 * padding, 2 * half) * ratio,
+			QImage::Format_ARGB32_Premultiplied);
+		sprite.setDevicePixelRatio(ratio);
+		sprite.fill(Qt::transparent);
+		auto q = Painter(&sprite);
+		paintFrame(q, color, padding, half, index * kSpriteFrameDuration);
+	}
+	p.drawImage(x - padding, y - half, sprite);
+}
+
+class TypingAnimation : public CachedAnimation {
 public:
-	TypingAnimation() : Impl(st::historySendActionTypingDuration) {
+	TypingAnimation() : CachedAnimation(st::historySendActionTypingDuration) {
 	}
 
 	static const MetaData kMeta;
@@ -101,13 +169,12 @@ public:
 			+ kTypingDotsCount * st::historySendActionTypingDelta;
 	}
 
-	void paint(
+	void paintFrame(
 		Painter &p,
 		style::color color,
 		int x,
 		int y,
-		int outerWidth,
-		crl::time now) override;
+		crl::time frameMs) override;
 
 };
 
@@ -116,17 +183,15 @@ const TypingAnimation::MetaData TypingAnimation::kMeta = {
 	&TypingAnimation::create,
 };
 
-void TypingAnimation::paint(
+void TypingAnimation::paintFrame(
 		Painter &p,
 		style::color color,
 		int x,
 		int y,
-		int outerWidth,
-		crl::time now) {
+		crl::time frameMs) {
 	PainterHighQualityEnabler hq(p);
 	p.setPen(Qt::NoPen);
 	p.setBrush(color);
-	auto frameMs = frameTime(now);
 	auto position = QPointF(x + 0.5, y - 0.5)
 		+ st::historySendActionTypingPosition;
 	for (auto i = 0; i != kTypingDotsCount; ++i) {
@@ -158,9 +223,9 @@ void TypingAnimation::paint(
 	}
 }
 
-class RecordAnimation : public SendActionAnimation::Impl {
+class RecordAnimation : public CachedAnimation {
 public:
-	RecordAnimation() : Impl(st::historySendActionRecordDuration) {
+	RecordAnimation() : CachedAnimation(st::historySendActionRecordDuration) {
 	}
 
 	static const MetaData kMeta;
@@ -176,13 +241,12 @@ public:
 			+ (kRecordArcsCount + 1) * st::historySendActionRecordDelta;
 	}
 
-	void paint(
+	void paintFrame(
 		Painter &p,
 		style::color color,
 		int x,
 		int y,
-		int outerWidth,
-		crl::time now) override;
+		crl::time frameMs) override;
 
 };
 
@@ -191,15 +255,13 @@ const RecordAnimation::MetaData RecordAnimation::kMeta = {
 	&RecordAnimation::create,
 };
 
-void RecordAnimation::paint(
+void RecordAnimation::paintFrame(
 		Painter &p,
 		style::color color,
 		int x,
 		int y,
-		int outerWidth,
-		crl::time now) {
+		crl::time frameMs) {
 	PainterHighQualityEnabler hq(p);
-	const auto frameMs = frameTime(now);
 	auto pen = color->p;
 	pen.setWidth(st::historySendActionRecordStrokeNumerator
 		/ st::historySendActionRecordDenominator);
@@ -224,9 +286,9 @@ void RecordAnimation::paint(
 	p.setOpacity(1.);
 }
 
-class UploadAnimation : public SendActionAnimation::Impl {
+class UploadAnimation : public CachedAnimation {
 public:
-	UploadAnimation() : Impl(st::historySendActionUploadDuration) {
+	UploadAnimation() : CachedAnimation(st::historySendActionUploadDuration) {
 	}
 
 	static const MetaData kMeta;
@@ -242,13 +304,12 @@ public:
 			+ (kUploadArrowsCount + 1) * st::historySendActionUploadDelta;
 	}
 
-	void paint(
+	void paintFrame(
 		Painter &p,
 		style::color color,
 		int x,
 		int y,
-		int outerWidth,
-		crl::time now) override;
+		crl::time frameMs) override;
 
 };
 
@@ -257,15 +318,13 @@ const UploadAnimation::MetaData UploadAnimation::kMeta = {
 	&UploadAnimation::create,
 };
 
-void UploadAnimation::paint(
+void UploadAnimation::paintFrame(
 		Painter &p,
 		style::color color,
 		int x,
 		int y,
-		int outerWidth,
-		crl::time now) {
+		crl::time frameMs) {
 	PainterHighQualityEnabler hq(p);
-	const auto frameMs = frameTime(now);
 	auto pen = color->p;
 	pen.setWidth(st::historySendActionUploadStrokeNumerator
 		/ st::historySendActionUploadDenominator);
@@ -17,6 +17,8 @@ using namespace Images;
 namespace Images {
 namespace {
 
+constexpr auto kDefaultPixmapCacheLimit = int64(128 * 1024 * 1024);
+
 [[nodiscard]] uint64 PixKey(int width, int height, Options options) {
 	return static_cast<uint64>(width)
 		| (static_cast<uint64>(height) << 24)
@@ -27,8 +29,133 @@ namespace {
 	return PixKey(0, 0, options);
 }
 
+[[nodiscard]] Options SingleOptions(
+		Options options,
+		ImageRoundRadius radius,
+		RectParts corners,
+		bool colored) {
+	const auto cornerOptions = [](RectParts corners) {
+		return (corners & RectPart::TopLeft ? Option::RoundedTopLeft : Option::None)
+			| (corners & RectPart::TopRight ? Option::RoundedTopRight : Option::None)
+			| (corners & RectPart::BottomLeft ? Option::RoundedBottomLeft : Option::None)
+			| (corners & RectPart::BottomRight ? Option::RoundedBottomRight : Option::None);
+	};
+	if (radius == ImageRoundRadius::Large) {
+		options |= Option::RoundedLarge | cornerOptions(corners);
+	} else if (radius == ImageRoundRadius::Small) {
+		options |= Option::RoundedSmall | cornerOptions(corners);
+	} else if (radius == ImageRoundRadius::Ellipse) {
+		options |= Option::Circled | cornerOptions(corners);
+	}
+	if (colored) {
+		options |= Option::Colored;
+	}
+	return options;
+}
+
+[[nodiscard]] int64 PixmapBytes(const QPixmap &pixmap) {
+	return int64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
 } // namespace
 
+class PixmapCache final {
+public:
+	[[nodiscard]] static PixmapCache &Instance();
+
+	[[nodiscard]] CachedPixmapPosition add(
+		not_null<const Image*> image,
+		uint64 key,
+		int64 bytes);
+	void touch(CachedPixmapPosition position);
+	void remove(CachedPixmapPosition position);
+
+	void hit();
+	void miss();
+
+	void setLimit(int64 bytes);
+	[[nodiscard]] PixmapCacheStats stats() const;
+
+private:
+	void checkLimit();
+	void trim();
+
+	std::list<CachedPixmapKey> _list;
+	PixmapCacheStats _stats = { .limit = kDefaultPixmapCacheLimit };
+	bool _trimScheduled = false;
+
+};
+
+PixmapCache &PixmapCache::Instance() {
+	// Never destroyed, because static images may outlive it otherwise.
+	static const auto result = new PixmapCache();
+	return *result;
+}
+
+CachedPixmapPosition PixmapCache::add(
+		not_null<const Image*> image,
+		uint64 key,
+		int64 bytes) {
+	_stats.bytes += bytes;
+	checkLimit();
+	return _list.insert(end(_list), { image, key, bytes });
+}
+
+void PixmapCache::touch(CachedPixmapPosition position) {
+	_list.splice(end(_list), _list, position);
+}
+
+void PixmapCache::remove(CachedPixmapPosition position) {
+	_stats.bytes -= position->bytes;
+	_list.erase(position);
+}
+
+void PixmapCache::hit() {
+	++_stats.hits;
+}
+
+void PixmapCache::miss() {
+	++_stats.misses;
+}
+
+void PixmapCache::setLimit(int64 bytes) {
+	_stats.limit = bytes;
+	checkLimit();
+}
+
+PixmapCacheStats PixmapCache::stats() const {
+	return _stats;
+}
+
+void PixmapCache::checkLimit() {
+	if (_stats.bytes <= _stats.limit || _trimScheduled) {
+		return;
+	}
+	// Callers hold references returned by pix*() while painting,
+	// so pixmaps are dropped only after the current call stack unwinds.
+	_trimScheduled = true;
+	crl::on_main([=] {
+		_trimScheduled = false;
+		trim();
+	});
+}
+
+void PixmapCache::trim() {
+	while (_stats.bytes > _stats.limit && !_list.empty()) {
+		const auto entry = _list.front();
+		entry.image->evictCached(entry.key);
+		++_stats.evicted;
+	}
+}
+
+void SetPixmapCacheLimit(int64 bytes) {
+	PixmapCache::Instance().setLimit(bytes);
+}
+
+PixmapCacheStats GetPixmapCacheStats() {
+	return PixmapCache::Instance().stats();
+}
+
 QByteArray ExpandInlineBytes(const QByteArray &bytes) {
 	if (bytes.size() < 3 || bytes[0] != '\x01') {
 		return QByteArray();
@@ -298,6 +425,17 @@ Image::Image(QImage &&data)
 	Expects(!_data.isNull());
 }
 
+Image::Image(const Image &other)
+: _data(other._data) {
+}
+
+Image::~Image() {
+	auto &cache = PixmapCache::Instance();
+	for (const auto &[key, cached] : _cache) {
+		cache.remove(cached.position);
+	}
+}
+
 not_null<Image*> Image::Empty() {
 	static auto result = Image([] {
 		const auto factor = cIntRetinaFactor();
@@ -338,14 +476,13 @@ const QPixmap &Image::pix(int w, int h) const {
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::None;
-	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = PixKey(w, h, options);
+	if (const auto result = findCached(k)) {
+		return *result;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
 }
 
 const QPixmap &Image::pixRounded(
@@ -373,14 +510,13 @@ const QPixmap &Image::pixRounded(
 	} else if (radius == ImageRoundRadius::Ellipse) {
 		options |= Option::Circled | cornerOptions(corners);
 	}
-	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = PixKey(w, h, options);
+	if (const auto result = findCached(k)) {
+		return *result;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
 }
 
 const QPixmap &Image::pixCircled(int w, int h) const {
@@ -391,14 +527,13 @@ const QPixmap &Image::pixCircled(int w, int h) const {
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::Circled;
-	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = PixKey(w, h, options);
+	if (const auto result = findCached(k)) {
+		return *result;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredCircled(int w, int h) const {
@@ -409,14 +544,13 @@ const QPixmap &Image::pixBlurredCircled(int w, int h) const {
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::Circled | Option::Blurred;
-	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = PixKey(w, h, options);
+	if (const auto result = findCached(k)) {
+		return *result;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurred(int w, int h) const {
@@ -427,14 +561,13 @@ const QPixmap &Image::pixBlurred(int w, int h) const {
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::Blurred;
-	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixNoCache(w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = PixKey(w, h, options);
+	if (const auto result = findCached(k)) {
+		return *result;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
 }
 
 const QPixmap &Image::pixColored(style::color add, int w, int h) const {
@@ -445,14 +578,13 @@ const QPixmap &Image::pixColored(style::color add, int w, int h) const {
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::Colored;
-	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixColoredNoCache(add, w, h, true);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = PixKey(w, h, options);
+	if (const auto result = findCached(k)) {
+		return *result;
 	}
-	return i->second;
+	auto p = pixColoredNoCache(add, w, h, true);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredColored(
@@ -466,14 +598,13 @@ const QPixmap &Image::pixBlurredColored(
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Blurred | Option::Smooth | Option::Colored;
-	auto k = PixKey(w, h, options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend()) {
-		auto p = pixBlurredColoredNoCache(add, w, h);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = PixKey(w, h, options);
+	if (const auto result = findCached(k)) {
+		return *result;
 	}
-	return i->second;
+	auto p = pixBlurredColoredNoCache(add, w, h);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
 }
 
 const QPixmap &Image::pixSingle(
@@ -491,32 +622,20 @@ const QPixmap &Image::pixSingle(
 		h *= cIntRetinaFactor();
 	}
 
-	auto options = Option::Smooth | Option::None;
-	auto cornerOptions = [](RectParts corners) {
-		return (corners & RectPart::TopLeft ? Option::RoundedTopLeft : Option::None)
-			| (corners & RectPart::TopRight ? Option::RoundedTopRight : Option::None)
-			| (corners & RectPart::BottomLeft ? Option::RoundedBottomLeft : Option::None)
-			| (corners & RectPart::BottomRight ? Option::RoundedBottomRight : Option::None);
-	};
-	if (radius == ImageRoundRadius::Large) {
-		options |= Option::RoundedLarge | cornerOptions(corners);
-	} else if (radius == ImageRoundRadius::Small) {
-		options |= Option::RoundedSmall | cornerOptions(corners);
-	} else if (radius == ImageRoundRadius::Ellipse) {
-		options |= Option::Circled | cornerOptions(corners);
-	}
-	if (colored) {
-		options |= Option::Colored;
-	}
+	const auto options = SingleOptions(
+		Option::Smooth | Option::None,
+		radius,
+		corners,
+		colored != nullptr);
 
-	auto k = SinglePixKey(options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend() || i->second.width() != (outerw * cIntRetinaFactor()) || i->second.height() != (outerh * cIntRetinaFactor())) {
-		auto p = pixNoCache(w, h, options, outerw, outerh, colored);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = SinglePixKey(options);
+	const auto size = QSize(outerw, outerh) * cIntRetinaFactor();
+	if (const auto result = findCached(k, size)) {
+		return *result;
 	}
-	return i->second;
+	auto p = pixNoCache(w, h, options, outerw, outerh, colored);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredSingle(
@@ -534,32 +653,118 @@ const QPixmap &Image::pixBlurredSingle(
 		h *= cIntRetinaFactor();
 	}
 
-	auto options = Option::Smooth | Option::Blurred;
-	auto cornerOptions = [](RectParts corners) {
-		return (corners & RectPart::TopLeft ? Option::RoundedTopLeft : Option::None)
-			| (corners & RectPart::TopRight ? Option::RoundedTopRight : Option::None)
-			| (corners & RectPart::BottomLeft ? Option::RoundedBottomLeft : Option::None)
-			| (corners & RectPart::BottomRight ? Option::RoundedBottomRight : Option::None);
-	};
-	if (radius == ImageRoundRadius::Large) {
-		options |= Option::RoundedLarge | cornerOptions(corners);
-	} else if (radius == ImageRoundRadius::Small) {
-		options |= Option::RoundedSmall | cornerOptions(corners);
-	} else if (radius == ImageRoundRadius::Ellipse) {
-		options |= Option::Circled | cornerOptions(corners);
+	const auto options = SingleOptions(
+		Option::Smooth | Option::Blurred,
+		radius,
+		corners,
+		colored != nullptr);
+
+	const auto k = SinglePixKey(options);
+	const auto size = QSize(outerw, outerh) * cIntRetinaFactor();
+	if (const auto result = findCached(k, size)) {
+		return *result;
 	}
-	if (colored) {
-		options |= Option::Colored;
+	auto p = pixNoCache(w, h, options, outerw, outerh, colored);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return storeCached(k, std::move(p));
+}
+
+const QPixmap *Image::pixSingleAsync(
+		Fn<void()> ready,
+		int w,
+		int h,
+		int outerw,
+		int outerh,
+		ImageRoundRadius radius,
+		RectParts corners) const {
+	if (w <= 0 || !width() || !height()) {
+		w = width() * cIntRetinaFactor();
+	} else {
+		w *= cIntRetinaFactor();
+		h *= cIntRetinaFactor();
 	}
+	const auto options = SingleOptions(
+		Option::Smooth | Option::None,
+		radius,
+		corners,
+		false);
 
-	auto k = SinglePixKey(options);
-	auto i = _cache.find(k);
-	if (i == _cache.cend() || i->second.width() != (outerw * cIntRetinaFactor()) || i->second.height() != (outerh * cIntRetinaFactor())) {
-		auto p = pixNoCache(w, h, options, outerw, outerh, colored);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _cache.emplace_or_assign(k, p).first;
+	const auto k = SinglePixKey(options);
+	const auto size = QSize(outerw, outerh) * cIntRetinaFactor();
+	if (const auto result = findCached(k, size)) {
+		return result;
+	}
+	auto &waiting = _preparing[k];
+	waiting.push_back(std::move(ready));
+	if (waiting.size() == 1) {
+		prepareAsync(k, w, h, options, outerw, outerh);
 	}
-	return i->second;
+	return nullptr;
+}
+
+void Image::prepareAsync(
+		uint64 key,
+		int w,
+		int h,
+		Options options,
+		int outerw,
+		int outerh) const {
+	const auto weak = base::make_weak(this);
+	crl::async([=, data = _data] {
+		if (!weak) {
+			return;
+		}
+		auto image = prepare(data, w, h, options, outerw, outerh, nullptr);
+		crl::on_main(weak, [=, image = std::move(image)]() mutable {
+			auto p = Ui::PixmapFromImage(std::move(image));
+			p.setDevicePixelRatio(cRetinaFactor());
+			storeCached(key, std::move(p));
+
+			const auto i = _preparing.find(key);
+			if (i == _preparing.end()) {
+				return;
+			}
+			const auto callbacks = std::move(i->second);
+			_preparing.erase(i);
+			for (const auto &callback : callbacks) {
+				callback();
+			}
+		});
+	});
+}
+
+const QPixmap *Image::findCached(uint64 key, QSize size) const {
+	auto &cache = PixmapCache::Instance();
+	const auto i = _cache.find(key);
+	if (i == _cache.end()
+		|| (!size.isEmpty() && i->second.pixmap.size() != size)) {
+		cache.miss();
+		return nullptr;
+	}
+	cache.hit();
+	cache.touch(i->second.position);
+	return &i->second.pixmap;
+}
+
+const QPixmap &Image::storeCached(uint64 key, QPixmap &&pixmap) const {
+	auto &cache = PixmapCache::Instance();
+	const auto i = _cache.find(key);
+	if (i != _cache.end()) {
+		cache.remove(i->second.position);
+	}
+	const auto position = cache.add(this, key, PixmapBytes(pixmap));
+	return _cache.emplace_or_assign(
+		key,
+		CachedPixmap{ std::move(pixmap), position }
+	).first->second.pixmap;
+}
+
+void Image::evictCached(uint64 key) const {
+	const auto i = _cache.find(key);
+	Assert(i != _cache.end());
+
+	PixmapCache::Instance().remove(i->second.position);
+	_cache.erase(i);
 }
 
 QPixmap Image::pixNoCache(
@@ -8,8 +8,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "ui/image/image_prepare.h"
+#include "base/weak_ptr.h"
+
+#include <list>
 
 class QPainterPath;
+class Image;
 
 namespace Images {
 
@@ -17,13 +21,37 @@ namespace Images {
 [[nodiscard]] QImage FromInlineBytes(const QByteArray &bytes);
 [[nodiscard]] QPainterPath PathFromInlineBytes(const QByteArray &bytes);
 
+// Scaled variants returned by Image::pix*() of all images share one
+// memory budget, least recently used ones are dropped above the limit.
+struct PixmapCacheStats {
+	int64 bytes = 0;
+	int64 limit = 0;
+	int64 hits = 0;
+	int64 misses = 0;
+	int64 evicted = 0;
+};
+
+void SetPixmapCacheLimit(int64 bytes);
+[[nodiscard]] PixmapCacheStats GetPixmapCacheStats();
+
+class PixmapCache;
+
+struct CachedPixmapKey {
+	not_null<const Image*> image;
+	uint64 key = 0;
+	int64 bytes = 0;
+};
+using CachedPixmapPosition = std::list<CachedPixmapKey>::iterator;
+
 } // namespace Images
 
-class Image final {
+class Image final : public base::has_weak_ptr {
 public:
 	explicit Image(const QString &path);
 	explicit Image(const QByteArray &content);
 	explicit Image(QImage &&data);
+	Image(const Image &other);
+	~Image();
 
 	[[nodiscard]] static not_null<Image*> Empty(); // 1x1 transparent
 	[[nodiscard]] static not_null<Image*> BlankMedia(); // 1x1 black
@@ -72,6 +100,18 @@ public:
 		ImageRoundRadius radius,
 		RectParts corners = RectPart::AllCorners,
 		const style::color *colored = nullptr) const;
+
+	// Returns nullptr and prepares the variant in the background if it is
+	// not cached, 'ready' is called on main when it is. The caller paints
+	// some lower quality image meanwhile. Same requests are coalesced.
+	[[nodiscard]] const QPixmap *pixSingleAsync(
+		Fn<void()> ready,
+		int w,
+		int h,
+		int outerw,
+		int outerh,
+		ImageRoundRadius radius,
+		RectParts corners = RectPart::AllCorners) const;
 	[[nodiscard]] const QPixmap &pixCircled(int w = 0, int h = 0) const;
 	[[nodiscard]] const QPixmap &pixBlurredCircled(int w = 0, int h = 0) const;
 	[[nodiscard]] QPixmap pixNoCache(
@@ -92,7 +132,28 @@ public:
 		int h = 0) const;
 
 private:
+	friend class Images::PixmapCache;
+
+	struct CachedPixmap {
+		QPixmap pixmap;
+		Images::CachedPixmapPosition position;
+	};
+
+	[[nodiscard]] const QPixmap *findCached(
+		uint64 key,
+		QSize size = QSize()) const;
+	const QPixmap &storeCached(uint64 key, QPixmap &&pixmap) const;
+	void evictCached(uint64 key) const;
+	void prepareAsync(
+		uint64 key,
+		int w,
+		int h,
+		Images::Options options,
+		int outerw,
+		int outerh) const;
+
 	const QImage _data;
-	mutable base::flat_map<uint64, QPixmap> _cache;
+	mutable base::flat_map<uint64, CachedPixmap> _cache;
+	mutable base::flat_map<uint64, std::vector<Fn<void()>>> _preparing;
 
 };
@@ -0,0 +1,116 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "ui/image/image_cold_cache.h"
+
+#include <lz4.h>
+
+namespace Images {
+namespace {
+
+constexpr auto kColdCacheLimit = int64(32 * 1024 * 1024);
+constexpr auto kMaxColdImageBytes = 4 * 1024 * 1024;
+
+struct ColdImage {
+	ColdKey key;
+	QSize size;
+	QImage::Format format = QImage::Format_Invalid;
+	int bytesPerLine = 0;
+	QByteArray compressed;
+};
+
+class ColdCache final {
+public:
+	void put(ColdKey key, const QImage &image);
+	[[nodiscard]] QImage take(ColdKey key);
+
+private:
+	void remove(ColdKey key);
+
+	std::list<ColdImage> _list; // Most recently put go first.
+	base::flat_map<ColdKey, std::list<ColdImage>::iterator> _index;
+	int64 _bytes = 0;
+
+};
+
+void ColdCache::put(ColdKey key, const QImage &image) {
+	remove(key);
+
+	const auto bytes = int(image.sizeInBytes());
+	if (image.isNull() || bytes > kMaxColdImageBytes) {
+		return;
+	}
+	auto compressed = QByteArray(LZ4_compressBound(bytes), Qt::Uninitialized);
+	const auto size = LZ4_compress_default(
+		reinterpret_cast<const char*>(image.constBits()),
+		compressed.data(),
+		bytes,
+		compressed.size());
+	if (size <= 0) {
+		return;
+	}
+	compressed.resize(size);
+	compressed.squeeze();
+
+	_bytes += size;
+	_list.push_front({
+		.key = key,
+		.size = image.size(),
+		.format = image.format(),
+		.bytesPerLine = int(image.bytesPerLine()),
+		.compressed = std::move(compressed),
+	});
+	_index.emplace(key, _list.begin());
+	while (_bytes > kColdCacheLimit) {
+		remove(_list.back().key);
+	}
+}
+
+QImage ColdCache::take(ColdKey key) {
+	const auto i = _index.find(key);
+	if (i == end(_index)) {
+		return QImage();
+	}
+	const auto &entry = *i->second;
+	auto result = QImage(entry.size, entry.format);
+	const auto bytes = int(result.sizeInBytes());
+	const auto restored = (result.bytesPerLine() == entry.bytesPerLine)
+		&& (LZ4_decompress_safe(
+			entry.compressed.constData(),
+			reinterpret_cast<char*>(result.bits()),
+			entry.compressed.size(),
+			bytes) == bytes);
+	remove(key);
+	return restored ? result : QImage();
+}
+
+void ColdCache::remove(ColdKey key) {
+	const auto i = _index.find(key);
+	if (i == end(_index)) {
+		return;
+	}
+	_bytes -= i->second->compressed.size();
+	_list.erase(i->second);
+	_index.erase(i);
+}
+
+[[nodiscard]] ColdCache &Instance() {
+	static auto result = ColdCache();
+	return result;
+}
+
+} // namespace
+
+void PutCold(ColdKey key, const QImage &image) {
+	Instance().put(key, image);
+}
+
+QImage TakeCold(ColdKey key) {
+	return Instance().take(key);
+}
+
+} // namespace Images
@@ -0,0 +1,29 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Images {
+
+// Images dropped from memory are kept LZ4-compressed for a while, so that
+// they can be restored without reading the cache or downloading them.
+//
+// Main thread only.
+struct ColdKey {
+	uint64 owner = 0;
+	uint64 id = 0;
+
+};
+
+inline bool operator<(const ColdKey &a, const ColdKey &b) {
+	return std::tie(a.owner, a.id) < std::tie(b.owner, b.id);
+}
+
+void PutCold(ColdKey key, const QImage &image);
+[[nodiscard]] QImage TakeCold(ColdKey key);
+
+} // namespace Images
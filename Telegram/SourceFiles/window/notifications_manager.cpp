@@ -41,6 +41,10 @@ namespace {
 constexpr auto kMinimalAlertDelay = crl::time(500);
 constexpr auto kWaitingForAllGroupedDelay = crl::time(1000);
 
+// Bursts over this rate collapse to the last message of each chat.
+constexpr auto kMaxShownInPeriod = 3;
+constexpr auto kShownPeriod = crl::time(1000);
+
 #ifdef Q_OS_MAC
 constexpr auto kSystemAlertDuration = crl::time(1000);
 #else // !Q_OS_MAC
@@ -327,6 +331,7 @@ void System::showGrouped() {
 		if (const auto lastItem = session->data().message(_lastHistoryItemId)) {
 			_waitForAllGroupedTimer.cancel();
 			_manager->showNotification(lastItem, _lastForwardedCount);
+			notificationShown(crl::now());
 			_lastForwardedCount = 0;
 			_lastHistoryItemId = FullMsgId();
 			_lastHistorySessionId = 0;
@@ -456,6 +461,15 @@ void System::showNext() {
 				}
 				_waitTimer.callOnce(next - ms);
 				break;
+			} else if (const auto delay = throttleDelay(ms)) {
+				collapseWaiters();
+				if (nextAlert && nextAlert < ms + delay) {
+					_waitTimer.callOnce(nextAlert - ms);
+					nextAlert = 0;
+				} else {
+					_waitTimer.callOnce(delay);
+				}
+				break;
 			} else {
 				const auto isForwarded = notifyItem->Has<HistoryMessageForwarded>();
 				const auto isAlbum = notifyItem->groupId();
@@ -541,6 +555,7 @@ void System::showNext() {
 					// to show the previous notification.
 					showGrouped();
 					_manager->showNotification(notifyItem, forwardedCount);
+					notificationShown(ms);
 				}
 
 				if (!history->hasNotification()) {
@@ -558,6 +573,29 @@ void System::showNext() {
 	}
 }
 
+void System::notificationShown(crl::time when) {
+	_shownAt.push_back(when);
+	while (int(_shownAt.size()) > kMaxShownInPeriod) {
+		_shownAt.pop_front();
+	}
+}
+
+crl::time System::throttleDelay(crl::time now) {
+	while (!_shownAt.empty() && _shownAt.front() + kShownPeriod <= now) {
+		_shownAt.pop_front();
+	}
+	return (int(_shownAt.size()) < kMaxShownInPeriod)
+		? 0
+		: (_shownAt.front() + kShownPeriod - now);
+}
+
+void System::collapseWaiters() {
+	// The waiters are synced with the current notifications in showNext.
+	for (const auto &[history, waiter] : _waiters) {
+		history->skipNotificationsTillLast();
+	}
+}
+
 void System::ensureSoundCreated() {
 	if (_soundTrack) {
 		return;
@@ -122,6 +122,9 @@ private:
 	void showNext();
 	void showGrouped();
 	void ensureSoundCreated();
+	void notificationShown(crl::time when);
+	[[nodiscard]] crl::time throttleDelay(crl::time now);
+	void collapseWaiters();
 
 	base::flat_map<
 		not_null<History*>,
@@ -140,6 +143,8 @@ private:
 
 	std::unique_ptr<Media::Audio::Track> _soundTrack;
 
+	std::deque<crl::time> _shownAt;
+
 	int _lastForwardedCount = 0;
 	uint64 _lastHistorySessionId = 0;
 	FullMsgId _lastHistoryItemId;
@@ -400,6 +400,35 @@ bool InitializeFromCache(
 	return true;
 }
 
+bool LoadFromCache(
+		const QByteArray &content,
+		const Cached &cache,
+		not_null<Instance*> out) {
+	if (cache.colors.isEmpty()
+		|| cache.paletteChecksum != style::palette::Checksum()
+		|| (cache.contentChecksum
+			!= base::crc32(content.constData(), content.size()))) {
+		return false;
+	}
+
+	auto background = QImage();
+	if (!cache.background.isEmpty()) {
+		QDataStream stream(cache.background);
+		QImageReader reader(stream.device());
+		reader.setAutoTransform(true);
+		if (!reader.read(&background) || background.isNull()) {
+			return false;
+		}
+	}
+	if (!out->palette.load(cache.colors)) {
+		return false;
+	}
+	if (!background.isNull()) {
+		applyBackground(std::move(background), cache.tiled, out);
+	}
+	return true;
+}
+
 [[nodiscard]] std::optional<QByteArray> ReadEditingPalette() {
 	auto file = QFile(EditingPalettePath());
 	return file.open(QIODevice::ReadOnly)
@@ -1165,7 +1194,14 @@ void ChatBackground::reapplyWithNightMode(
 		auto preview = std::make_unique<Preview>();
 		preview->object = std::move(read.object);
 		preview->instance.cached = std::move(read.cache);
-		const auto loaded = LoadTheme(
+
+		// Switching day / night on schedule shouldn't unpack the theme
+		// and decode its background again when the saved cache is valid.
+		const auto loaded = LoadFromCache(
+			preview->object.content,
+			preview->instance.cached,
+			&preview->instance
+		) || LoadTheme(
 			preview->object.content,
 			ColorizerForTheme(path),
 			std::nullopt,
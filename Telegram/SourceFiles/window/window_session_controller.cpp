@@ -72,11 +72,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "styles/style_layers.h" // st::boxLabel
 #include "styles/style_chat.h" // st::historyMessageRadius
 
+#include <QtGui/QWindow>
+
 namespace Window {
 namespace {
 
 constexpr auto kCustomThemesInMemory = 5;
 constexpr auto kMaxChatEntryHistorySize = 50;
+constexpr auto kActiveAnimationTimeout = crl::time(1000);
 constexpr auto kDayBaseFile = ":/gui/day-custom-base.tdesktop-theme"_cs;
 constexpr auto kNightBaseFile = ":/gui/night-custom-base.tdesktop-theme"_cs;
 
@@ -869,6 +872,45 @@ bool SessionController::isGifPausedAtLeastFor(GifPauseReason reason) const {
 	return (static_cast<int>(_gifPauseReasons) >= 2 * static_cast<int>(reason)) || !widget()->isActive();
 }
 
+bool SessionController::animationFrameAllowed(
+		not_null<const void*> player,
+		GifPauseReason reason) {
+	// Minimized or fully covered windows are not exposed,
+	// while still could be reported as active on some platforms.
+	const auto handle = widget()->windowHandle();
+	if (isGifPausedAtLeastFor(reason)
+		|| widget()->isMinimized()
+		|| (handle && !handle->isExposed())) {
+		_animatedPlayers.remove(player);
+		return false;
+	}
+	const auto now = crl::now();
+	const auto i = _animatedPlayers.find(player);
+	if (i != end(_animatedPlayers)) {
+		i->second = now;
+	} else {
+		// Destroyed players never unregister, so drop them from time to time.
+		removeInactiveAnimations(now);
+		_animatedPlayers.emplace(player, now);
+	}
+	return true;
+}
+
+int SessionController::activeAnimationsCount() {
+	removeInactiveAnimations(crl::now());
+	return int(_animatedPlayers.size());
+}
+
+void SessionController::removeInactiveAnimations(crl::time now) {
+	for (auto i = begin(_animatedPlayers); i != end(_animatedPlayers);) {
+		if (now - i->second > kActiveAnimationTimeout) {
+			i = _animatedPlayers.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
 void SessionController::floatPlayerAreaUpdated() {
 	if (const auto main = widget()->sessionContent()) {
 		main->floatPlayerAreaUpdated();
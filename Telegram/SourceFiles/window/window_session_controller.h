@@ -305,6 +305,14 @@ public:
 		return _gifPauseLevelChanged.events();
 	}
 	bool isGifPausedAtLeastFor(GifPauseReason reason) const;
+
+	// Animated players ask here before marking a painted frame as shown,
+	// so that pausing is decided in one place and active ones are counted.
+	[[nodiscard]] bool animationFrameAllowed(
+		not_null<const void*> player,
+		GifPauseReason reason);
+	[[nodiscard]] int activeAnimationsCount();
+
 	void floatPlayerAreaUpdated();
 
 	struct ColumnLayout {
@@ -462,6 +470,7 @@ private:
 	void refreshFiltersMenu();
 	void checkOpenedFilter();
 	void suggestArchiveAndMute();
+	void removeInactiveAnimations(crl::time now);
 
 	int minimalThreeColumnWidth() const;
 	int countDialogsWidthFromRatio(int bodyWidth) const;
@@ -499,6 +508,7 @@ private:
 
 	GifPauseReasons _gifPauseReasons = 0;
 	rpl::event_stream<> _gifPauseLevelChanged;
+	base::flat_map<not_null<const void*>, crl::time> _animatedPlayers;
 
 	// Depends on _gifPause*.
 	const std::unique_ptr<ChatHelpers::TabbedSelector> _tabbedSelector;
@@ -0,0 +1,103 @@
+'''
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+'''
+# Prints per method latency histograms from a capture written
+# by the 'mtpcapture' debug code, usage:
+#
+#   mtp_capture_stats.py mtp_capture.bin.1 mtp_capture.bin
+
+import sys, os, re, struct
+
+scriptPath = os.path.dirname(os.path.realpath(__file__))
+tlPath = os.path.join(scriptPath, '..', 'Resources', 'tl')
+
+kMagic = 0x434D4454
+kVersion = 1
+kSent = 1
+kReceived = 2
+kRpcError = 0x2144ca19
+kHeader = struct.Struct('>II')
+kRecord = struct.Struct('>BqiQQQIII')
+kBuckets = [10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000]
+
+def finish(code):
+    sys.exit(code)
+
+def readNames():
+    result = {}
+    for name in ['mtproto.tl', 'api.tl']:
+        with open(os.path.join(tlPath, name), encoding='utf-8') as f:
+            for line in f:
+                match = re.match(r'^([a-zA-Z0-9_\.]+)#([0-9a-f]+) ', line)
+                if match:
+                    result[int(match.group(2), 16)] = match.group(1)
+    return result
+
+def readRecords(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if len(data) < kHeader.size:
+        return
+    magic, version = kHeader.unpack_from(data, 0)
+    if magic != kMagic or version != kVersion:
+        print('[ERROR] Bad capture file: ' + path)
+        finish(1)
+    offset = kHeader.size
+    while offset + kRecord.size <= len(data):
+        record = kRecord.unpack_from(data, offset)
+        offset += kRecord.size + record[8]
+        yield record
+
+def percentile(values, part):
+    return values[min(len(values) - 1, int(len(values) * part))]
+
+def histogram(values):
+    counts = [0] * (len(kBuckets) + 1)
+    for value in values:
+        index = 0
+        while index < len(kBuckets) and value >= kBuckets[index]:
+            index += 1
+        counts[index] += 1
+    return ' '.join(str(count) for count in counts)
+
+if len(sys.argv) < 2:
+    print('Usage: mtp_capture_stats.py <capture files in order>')
+    finish(1)
+
+names = readNames()
+sent = {}
+latencies = {}
+errors = {}
+for path in sys.argv[1:]:
+    for record in readRecords(path):
+        kind, time, dcId, session, msgId, requestMsgId, type, size, _ = record
+        if kind == kSent:
+            sent[(dcId, session, msgId)] = (time, type)
+        elif kind == kReceived:
+            request = sent.pop((dcId, session, requestMsgId), None)
+            if request is None:
+                continue
+            method = names.get(request[1], '0x%08x' % request[1])
+            latencies.setdefault(method, []).append(time - request[0])
+            if type == kRpcError:
+                errors[method] = errors.get(method, 0) + 1
+
+header = ' '.join('<' + str(bucket) for bucket in kBuckets) + ' more'
+print('method count errors p50 p90 p99 max | ms: ' + header)
+ordered = sorted(latencies.items(), key=lambda item: -len(item[1]))
+for method, values in ordered:
+    values.sort()
+    print('%s %d %d %d %d %d %d | %s' % (
+        method,
+        len(values),
+        errors.get(method, 0),
+        percentile(values, 0.5),
+        percentile(values, 0.9),
+        percentile(values, 0.99),
+        values[-1],
+        histogram(values)))
+print('unanswered %d' % len(sent))
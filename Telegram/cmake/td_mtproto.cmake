@@ -15,6 +15,8 @@ PRIVATE
     mtproto/details/mtproto_abstract_socket.h
     mtproto/details/mtproto_bound_key_creator.cpp
     mtproto/details/mtproto_bound_key_creator.h
+    mtproto/details/mtproto_buffer_pool.cpp
+    mtproto/details/mtproto_buffer_pool.h
     mtproto/details/mtproto_dc_key_binder.cpp
     mtproto/details/mtproto_dc_key_binder.h
     mtproto/details/mtproto_dc_key_creator.cpp
@@ -23,6 +25,8 @@ PRIVATE
     mtproto/details/mtproto_dcenter.h
     mtproto/details/mtproto_domain_resolver.cpp
     mtproto/details/mtproto_domain_resolver.h
+    mtproto/details/mtproto_network_simulator.cpp
+    mtproto/details/mtproto_network_simulator.h
     mtproto/details/mtproto_dump_to_text.cpp
     mtproto/details/mtproto_dump_to_text.h
     mtproto/details/mtproto_received_ids_manager.cpp
@@ -31,10 +35,14 @@ PRIVATE
     mtproto/details/mtproto_rsa_public_key.h
     mtproto/details/mtproto_serialized_request.cpp
     mtproto/details/mtproto_serialized_request.h
+    mtproto/details/mtproto_session_stats.cpp
+    mtproto/details/mtproto_session_stats.h
     mtproto/details/mtproto_tcp_socket.cpp
     mtproto/details/mtproto_tcp_socket.h
     mtproto/details/mtproto_tls_socket.cpp
     mtproto/details/mtproto_tls_socket.h
+    mtproto/details/mtproto_traffic_capture.cpp
+    mtproto/details/mtproto_traffic_capture.h
     mtproto/mtproto_auth_key.cpp
     mtproto/mtproto_auth_key.h
     mtproto/mtproto_concurrent_sender.cpp